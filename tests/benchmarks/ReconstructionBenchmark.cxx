@@ -0,0 +1,450 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+// Times the reconstruction methods of Tomviz on tilt series simulated from
+// standard phantoms, and measures how well they recover the phantoms, for
+// numbers that can be compared across versions:
+//
+//   tomvizBenchmarks --sizes 64,128 --output results.json
+//
+// Phantoms and noise are seeded, so every run reconstructs the same tilt
+// series. The fastest of --repeat runs of each method is reported, with the
+// Pearson correlation and the normalized RMS error of the reconstruction
+// against the phantom.
+
+#include "ParallelFor.h"
+#include "Phantom.h"
+#include "PythonUtilities.h"
+#include "TomographyReconstruction.h"
+#include "TomographyTiltSeries.h"
+#include "Variant.h"
+#include "tomvizConfig.h"
+
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkPointData.h>
+#include <vtkSmartPointer.h>
+
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringList>
+#include <QSysInfo>
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+using namespace tomviz;
+
+namespace {
+
+struct Method
+{
+  /// Name of the method, the name of its script for Python operators.
+  QString name;
+  /// Whether the method is a Python operator of the operator directory.
+  bool python;
+  std::vector<std::pair<QString, Variant>> arguments;
+  /// Argument set to the size of the reconstruction, if any.
+  QString sizeArgument;
+  /// Largest size the method is run at, 0 for any. The algebraic methods
+  /// build a dense projection matrix of size^3 * tilts values.
+  int maximumSize;
+};
+
+// Iteration counts are kept low so the suite runs in minutes, they are
+// fixed so runs can be compared.
+std::vector<Method> methods()
+{
+  return {
+    // The native back projection does not filter the projections, unlike
+    // Recon_WBP.
+    { "BP_cxx (unfiltered)", false, {}, "", 0 },
+    { "Recon_WBP", true, { { "filter", 1 }, { "interp", 0 } }, "Nrecon", 0 },
+    { "Recon_DFT", true, {}, "", 0 },
+    { "Recon_DFT_constraint",
+      true,
+      { { "Niter", 20 },
+        { "Niter_update_support", 10 },
+        { "supportSigma", 0.1 },
+        { "supportThreshold", 10.0 } },
+      "",
+      0 },
+    { "Recon_SIRT",
+      true,
+      { { "Niter", 10 }, { "stepSize", 0.0001 }, { "updateMethodIndex", 0 } },
+      "",
+      64 },
+    { "Recon_ART", true, { { "Niter", 1 } }, "", 64 },
+    { "Recon_TV_minimization", true, { { "Niter", 1 } }, "", 64 }
+  };
+}
+
+struct Accuracy
+{
+  double correlation = 0;
+  double error = 0;
+};
+
+// The voxel of a volume of size^3 that voxel (x, y, z) moves to under one
+// of the eight flips and transposes of the y-z plane.
+int64_t orient(int orientation, int size, int x, int y, int z)
+{
+  if (orientation & 1) {
+    y = size - 1 - y;
+  }
+  if (orientation & 2) {
+    z = size - 1 - z;
+  }
+  if (orientation & 4) {
+    std::swap(y, z);
+  }
+  return (static_cast<int64_t>(z) * size + y) * size + x;
+}
+
+// Compare the reconstruction to the phantom in the orientation of the y-z
+// plane they correlate best in, as the operators do not agree on the
+// handedness of the tilt. The error is the RMS error of the reconstruction
+// after the least squares fit of its scale and offset to the phantom,
+// relative to the RMS of the phantom.
+Accuracy accuracy(vtkImageData* phantom, vtkImageData* reconstruction)
+{
+  Accuracy best;
+  int dims[3];
+  int reconDims[3];
+  phantom->GetDimensions(dims);
+  reconstruction->GetDimensions(reconDims);
+  if (!std::equal(dims, dims + 3, reconDims)) {
+    best.correlation = std::nan("");
+    best.error = std::nan("");
+    return best;
+  }
+
+  const int size = dims[0];
+  auto p = static_cast<float*>(phantom->GetScalarPointer());
+  vtkDataArray* r = reconstruction->GetPointData()->GetScalars();
+  double sumP = 0;
+  double sumPP = 0;
+  for (int64_t i = 0; i < r->GetNumberOfValues(); ++i) {
+    sumP += p[i];
+    sumPP += static_cast<double>(p[i]) * p[i];
+  }
+
+  best.correlation = -2;
+  const double n = static_cast<double>(r->GetNumberOfValues());
+  for (int orientation = 0; orientation < 8; ++orientation) {
+    double sumR = 0;
+    double sumRR = 0;
+    double sumPR = 0;
+    for (int z = 0; z < size; ++z) {
+      for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+          const double value = r->GetComponent(
+            (static_cast<int64_t>(z) * size + y) * size + x, 0);
+          sumR += value;
+          sumRR += value * value;
+          sumPR += value * p[orient(orientation, size, x, y, z)];
+        }
+      }
+    }
+    const double covariance = sumPR / n - sumP / n * sumR / n;
+    const double varianceP = sumPP / n - sumP / n * sumP / n;
+    const double varianceR = sumRR / n - sumR / n * sumR / n;
+    const double correlation =
+      varianceP > 0 && varianceR > 0
+        ? covariance / std::sqrt(varianceP * varianceR)
+        : 0;
+    if (correlation > best.correlation) {
+      best.correlation = correlation;
+      best.error = std::sqrt(varianceP * (1 - correlation * correlation) /
+                             (sumPP / n));
+    }
+  }
+  return best;
+}
+
+vtkSmartPointer<vtkImageData> runCxx(vtkImageData* tiltSeries, double& seconds)
+{
+  auto reconstruction = vtkSmartPointer<vtkImageData>::New();
+  QElapsedTimer timer;
+  timer.start();
+  TomographyReconstruction::weightedBackProjection3(tiltSeries,
+                                                    reconstruction);
+  seconds = timer.nsecsElapsed() / 1e9;
+  return reconstruction;
+}
+
+vtkSmartPointer<vtkImageData> runPython(const Method& method,
+                                        vtkImageData* tiltSeries, int size,
+                                        double& seconds)
+{
+  QFile file(QDir(TOMVIZ_OPERATOR_DIRECTORY).filePath(method.name + ".py"));
+  if (!file.open(QIODevice::ReadOnly)) {
+    std::cerr << "Unable to read " << file.fileName().toStdString()
+              << std::endl;
+    return nullptr;
+  }
+
+  // Operators may reconstruct into the tilt series.
+  auto data = vtkSmartPointer<vtkImageData>::New();
+  data->DeepCopy(tiltSeries);
+
+  Python python;
+  Python::Module module = python.import("reconstruction_benchmark");
+  if (!module.isValid()) {
+    std::cerr << "Unable to import reconstruction_benchmark." << std::endl;
+    return nullptr;
+  }
+  Python::Function load = module.findFunction("load");
+  Python::Function reconstruction = module.findFunction("reconstruction");
+
+  Python::Tuple loadArgs(2);
+  Python::Object label(method.name);
+  Python::Object script(QString(file.readAll()));
+  loadArgs.set(0, label);
+  loadArgs.set(1, script);
+  Python::Function transform;
+  transform = load.call(loadArgs);
+  if (!transform.isValid()) {
+    return nullptr;
+  }
+
+  Python::Object pyData = Python::VTK::GetObjectFromPointer(data);
+  Python::Tuple args(1);
+  args.set(0, pyData);
+  Python::Dict kwargs;
+  for (auto& argument : method.arguments) {
+    kwargs.set(argument.first, argument.second);
+  }
+  if (!method.sizeArgument.isEmpty()) {
+    kwargs.set(method.sizeArgument, Variant(size));
+  }
+
+  QElapsedTimer timer;
+  timer.start();
+  Python::Object result = transform.call(args, kwargs);
+  seconds = timer.nsecsElapsed() / 1e9;
+  if (!result.isValid()) {
+    return nullptr;
+  }
+
+  Python::Tuple resultArgs(2);
+  resultArgs.set(0, pyData);
+  resultArgs.set(1, result);
+  Python::Object output = reconstruction.call(resultArgs);
+  return vtkImageData::SafeDownCast(
+    Python::VTK::GetPointerFromObject(output, "vtkImageData"));
+}
+
+void printRow(const QJsonObject& row)
+{
+  std::cout << std::left << std::setw(13)
+            << row["phantom"].toString().toStdString() << std::right
+            << std::setw(5) << row["size"].toInt() << "  " << std::left
+            << std::setw(22) << row["method"].toString().toStdString()
+            << std::right << std::fixed;
+  if (row.contains("seconds")) {
+    std::cout << std::setprecision(3) << std::setw(10)
+              << row["seconds"].toDouble() << std::setprecision(2)
+              << std::setw(12) << row["voxelsPerSecond"].toDouble() / 1e6;
+  } else {
+    std::cout << std::setw(22) << row["status"].toString().toStdString();
+  }
+  if (row.contains("correlation")) {
+    std::cout << std::setprecision(4) << std::setw(9)
+              << row["correlation"].toDouble() << std::setw(9)
+              << row["error"].toDouble();
+  }
+  std::cout << std::endl;
+}
+
+QStringList list(const QString& value)
+{
+  return value.split(',', QString::SkipEmptyParts);
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+  QCoreApplication app(argc, argv);
+  QCommandLineParser parser;
+  parser.setApplicationDescription(
+    "Benchmark the reconstruction methods of Tomviz on simulated tilt "
+    "series.");
+  parser.addHelpOption();
+  parser.addOption(QCommandLineOption(
+    "sizes", "Sizes of the phantoms, comma separated.", "sizes", "64,128,256"));
+  parser.addOption(QCommandLineOption(
+    "phantoms", "Phantoms, comma separated, of shepp-logan and beads.",
+    "phantoms", "shepp-logan,beads"));
+  parser.addOption(QCommandLineOption(
+    "methods", "Methods to run, comma separated, all of them by default.",
+    "methods"));
+  parser.addOption(QCommandLineOption(
+    "tilt-range", "Tilts run from -range to range degrees.", "degrees", "70"));
+  parser.addOption(QCommandLineOption("tilt-step", "Degrees between tilts.",
+                                      "degrees", "2"));
+  parser.addOption(QCommandLineOption(
+    "counts", "Average counts per pixel of Poisson noise, 0 for none.",
+    "counts", "0"));
+  parser.addOption(
+    QCommandLineOption("seed", "Seed of the phantoms and noise.", "seed", "0"));
+  parser.addOption(QCommandLineOption(
+    "repeat", "Runs of each method, the fastest is reported.", "count", "1"));
+  parser.addOption(
+    QCommandLineOption("output", "File the results are written to as JSON.",
+                       "file"));
+  parser.process(app);
+
+  const double range = parser.value("tilt-range").toDouble();
+  const double step = parser.value("tilt-step").toDouble();
+  const double counts = parser.value("counts").toDouble();
+  const unsigned int seed = parser.value("seed").toUInt();
+  const int repeat = std::max(parser.value("repeat").toInt(), 1);
+  if (step <= 0) {
+    std::cerr << "Invalid --tilt-step." << std::endl;
+    return 1;
+  }
+  std::vector<double> angles;
+  for (double angle = -range; angle <= range + 1e-9; angle += step) {
+    angles.push_back(angle);
+  }
+
+  std::vector<Method> selected;
+  const QStringList names = list(parser.value("methods"));
+  for (auto& method : methods()) {
+    if (names.isEmpty() || names.contains(method.name)) {
+      selected.push_back(method);
+    }
+  }
+  bool python = false;
+  for (auto& method : selected) {
+    python = python || method.python;
+  }
+  if (python) {
+    Python::initialize();
+  }
+
+  std::cout << "Tomviz " << TOMVIZ_VERSION << TOMVIZ_VERSION_EXTRA << ", "
+            << angles.size() << " tilts, " << parallelThreadCount()
+            << " threads" << std::endl;
+
+  QJsonArray results;
+  foreach (const QString& phantomName, list(parser.value("phantoms"))) {
+    foreach (const QString& sizeValue, list(parser.value("sizes"))) {
+      const int size = sizeValue.toInt();
+      vtkSmartPointer<vtkImageData> phantom;
+      if (phantomName == "shepp-logan") {
+        phantom = Phantom::sheppLogan(size);
+      } else if (phantomName == "beads") {
+        phantom = Phantom::beads(size, 20, seed);
+      } else {
+        std::cerr << "Unknown phantom " << phantomName.toStdString()
+                  << std::endl;
+        return 1;
+      }
+      const double voxels = static_cast<double>(size) * size * size;
+
+      QJsonObject row;
+      row["phantom"] = phantomName;
+      row["size"] = size;
+      row["tilts"] = static_cast<int>(angles.size());
+
+      // The simulation is timed too, voxels per second counting every voxel
+      // of the phantom once per tilt.
+      QElapsedTimer timer;
+      timer.start();
+      auto tiltSeries =
+        TomographyTiltSeries::simulateTiltSeries(phantom, angles, size);
+      if (counts > 0) {
+        TomographyTiltSeries::addPoissonNoise(tiltSeries, counts, seed);
+      }
+      const double simulation = timer.nsecsElapsed() / 1e9;
+      QJsonObject simulationRow = row;
+      simulationRow["method"] = "simulation";
+      simulationRow["seconds"] = simulation;
+      simulationRow["voxelsPerSecond"] = voxels * angles.size() / simulation;
+      results.append(simulationRow);
+      printRow(simulationRow);
+
+      for (auto& method : selected) {
+        QJsonObject methodRow = row;
+        methodRow["method"] = method.name;
+        if (method.maximumSize > 0 && size > method.maximumSize) {
+          methodRow["status"] = "skipped";
+          results.append(methodRow);
+          printRow(methodRow);
+          continue;
+        }
+
+        double fastest = 0;
+        vtkSmartPointer<vtkImageData> reconstruction;
+        for (int i = 0; i < repeat; ++i) {
+          double seconds = 0;
+          reconstruction = method.python
+                             ? runPython(method, tiltSeries, size, seconds)
+                             : runCxx(tiltSeries, seconds);
+          if (!reconstruction) {
+            break;
+          }
+          fastest = i == 0 ? seconds : std::min(fastest, seconds);
+        }
+        if (!reconstruction) {
+          methodRow["status"] = "failed";
+          results.append(methodRow);
+          printRow(methodRow);
+          continue;
+        }
+
+        methodRow["status"] = "ok";
+        methodRow["seconds"] = fastest;
+        methodRow["voxelsPerSecond"] = voxels / fastest;
+        auto measured = accuracy(phantom, reconstruction);
+        if (!std::isnan(measured.correlation)) {
+          methodRow["correlation"] = measured.correlation;
+          methodRow["error"] = measured.error;
+        }
+        results.append(methodRow);
+        printRow(methodRow);
+      }
+    }
+  }
+
+  if (parser.isSet("output")) {
+    QJsonObject options;
+    options["tiltRange"] = range;
+    options["tiltStep"] = step;
+    options["counts"] = counts;
+    options["seed"] = static_cast<double>(seed);
+    options["repeat"] = repeat;
+
+    QJsonObject json;
+    json["version"] = QString(TOMVIZ_VERSION) + TOMVIZ_VERSION_EXTRA;
+    json["date"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    json["host"] = QSysInfo::machineHostName();
+    json["cpu"] = QSysInfo::currentCpuArchitecture();
+    json["threads"] = static_cast<int>(parallelThreadCount());
+    json["options"] = options;
+    json["results"] = results;
+
+    QFile file(parser.value("output"));
+    if (!file.open(QIODevice::WriteOnly) ||
+        file.write(QJsonDocument(json).toJson()) < 0) {
+      std::cerr << "Unable to write " << file.fileName().toStdString()
+                << std::endl;
+      return 1;
+    }
+  }
+  return 0;
+}
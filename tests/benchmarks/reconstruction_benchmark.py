@@ -0,0 +1,37 @@
+###############################################################################
+# This source file is part of the Tomviz project, https://tomviz.org/.
+# It is released under the 3-Clause BSD License, see "LICENSE".
+###############################################################################
+import types
+
+from tomviz._internal import find_transform_scalars
+
+
+class OperatorWrapper(object):
+    """Stands in for the application's wrapper of the operator, the
+    benchmark neither shows progress nor cancels."""
+    canceled = False
+    progress_maximum = 0
+    progress_value = 0
+    progress_message = ''
+    progress_data = None
+
+
+def load(label, script):
+    """Returns the transform function of the operator script."""
+    module = types.ModuleType(label)
+    exec(compile(script, label, 'exec'), module.__dict__)
+    transform = find_transform_scalars(module)
+    if hasattr(transform, '__self__'):
+        transform.__self__._operator_wrapper = OperatorWrapper()
+
+    return transform
+
+
+def reconstruction(dataset, result):
+    """Returns the reconstruction the transform returned as a child, or the
+    dataset for operators reconstructing in place."""
+    if isinstance(result, dict) and 'reconstruction' in result:
+        return result['reconstruction']
+
+    return dataset
@@ -0,0 +1,154 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <gtest/gtest.h>
+
+#include "BackgroundWriter.h"
+
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkUnsignedCharArray.h>
+
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include <thread>
+#include <vector>
+
+using namespace tomviz;
+
+namespace {
+
+vtkSmartPointer<vtkUnsignedCharArray> filledArray(unsigned char value)
+{
+  auto array = vtkSmartPointer<vtkUnsignedCharArray>::New();
+  array->SetNumberOfTuples(8 * 8 * 8);
+  array->FillValue(value);
+  return array;
+}
+
+// Writes the scalars a slice at a time.
+bool writeSlices(const QString& fileName, vtkImageData* data,
+                 const BackgroundWriter::Progress& progress)
+{
+  QFile file(fileName);
+  if (!file.open(QIODevice::WriteOnly)) {
+    return false;
+  }
+  auto values = static_cast<const char*>(
+    data->GetPointData()->GetScalars()->GetVoidPointer(0));
+  for (int z = 0; z < 8; ++z) {
+    if (file.write(values + z * 64, 64) != 64 || !progress((z + 1) / 8.0)) {
+      return false;
+    }
+  }
+  return true;
+}
+} // namespace
+
+TEST(BackgroundWriterTest, write)
+{
+  QTemporaryDir dir;
+  const QString fileName = dir.filePath("volume.raw");
+  vtkNew<vtkImageData> image;
+  image->SetDimensions(8, 8, 8);
+  image->GetPointData()->SetScalars(filledArray(7));
+
+  BackgroundWriter writer(fileName, image, &writeSlices);
+  EXPECT_EQ(writer.size(), 512);
+
+  // The data source replacing its arrays leaves the snapshot be.
+  image->GetPointData()->SetScalars(filledArray(9));
+
+  std::vector<int> percents;
+  QObject::connect(&writer, &BackgroundWriter::progressChanged,
+                   [&percents](int percent, double) {
+                     percents.push_back(percent);
+                   });
+  writer.start();
+  ASSERT_TRUE(writer.wait());
+
+  ASSERT_EQ(percents.size(), 8u);
+  EXPECT_EQ(percents.front(), 12);
+  EXPECT_EQ(percents.back(), 100);
+
+  QFile file(fileName);
+  ASSERT_TRUE(file.open(QIODevice::ReadOnly));
+  const QByteArray bytes = file.readAll();
+  EXPECT_EQ(bytes, QByteArray(512, 7));
+
+  // Nothing but the file is left in the directory.
+  EXPECT_EQ(QDir(dir.path()).entryList(QDir::Files | QDir::Hidden),
+            QStringList({ "volume.raw" }));
+}
+
+TEST(BackgroundWriterTest, cancel)
+{
+  QTemporaryDir dir;
+  const QString fileName = dir.filePath("volume.raw");
+  {
+    QFile file(fileName);
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.write("previous");
+  }
+  vtkNew<vtkImageData> image;
+  image->SetDimensions(8, 8, 8);
+  image->GetPointData()->SetScalars(filledArray(7));
+
+  // Writes part of the file, then waits to be canceled.
+  BackgroundWriter writer(
+    fileName, image,
+    [](const QString& name, vtkImageData*,
+       const BackgroundWriter::Progress& progress) {
+      QFile file(name);
+      if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+      }
+      file.write(QByteArray(64, 1));
+      while (progress(0.125)) {
+        std::this_thread::yield();
+      }
+      return true;
+    });
+  writer.start();
+  writer.cancel();
+  EXPECT_FALSE(writer.wait());
+  EXPECT_TRUE(writer.isCanceled());
+
+  // The previous file is kept and the partial one removed.
+  QFile file(fileName);
+  ASSERT_TRUE(file.open(QIODevice::ReadOnly));
+  EXPECT_EQ(file.readAll(), QByteArray("previous"));
+  EXPECT_EQ(QDir(dir.path()).entryList(QDir::Files | QDir::Hidden),
+            QStringList({ "volume.raw" }));
+}
+
+TEST(BackgroundWriterTest, sameFile)
+{
+  // Writers of the same file each write a partial file of their own, the
+  // file is then whole, written by one or the other.
+  QTemporaryDir dir;
+  const QString fileName = dir.filePath("volume.raw");
+  vtkNew<vtkImageData> first;
+  first->SetDimensions(8, 8, 8);
+  first->GetPointData()->SetScalars(filledArray(7));
+  vtkNew<vtkImageData> second;
+  second->SetDimensions(8, 8, 8);
+  second->GetPointData()->SetScalars(filledArray(9));
+
+  BackgroundWriter firstWriter(fileName, first, &writeSlices);
+  BackgroundWriter secondWriter(fileName, second, &writeSlices);
+  firstWriter.start();
+  secondWriter.start();
+  EXPECT_TRUE(firstWriter.wait());
+  EXPECT_TRUE(secondWriter.wait());
+
+  QFile file(fileName);
+  ASSERT_TRUE(file.open(QIODevice::ReadOnly));
+  const QByteArray bytes = file.readAll();
+  EXPECT_TRUE(bytes == QByteArray(512, 7) || bytes == QByteArray(512, 9));
+  EXPECT_EQ(QDir(dir.path()).entryList(QDir::Files | QDir::Hidden),
+            QStringList({ "volume.raw" }));
+}
@@ -0,0 +1,155 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <gtest/gtest.h>
+
+#include "BatchRender.h"
+#include "TomvizTest.h"
+
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPNGReader.h>
+#include <vtkPointData.h>
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QProcess>
+#include <QTemporaryDir>
+
+#include <memory>
+
+using namespace tomviz;
+
+namespace {
+
+QStringList arguments(const QStringList& extra)
+{
+  return QStringList({ "tomviz", "--batch-render", "state.tvsm", "--output",
+                       "frames" }) +
+         extra;
+}
+} // namespace
+
+TEST(BatchRenderTest, defaults)
+{
+  BatchRender::Options options;
+  QString error;
+  ASSERT_TRUE(BatchRender::parse(arguments({}), options, error));
+  EXPECT_EQ(options.stateFile, QString("state.tvsm"));
+  EXPECT_EQ(options.outputDirectory, QString("frames"));
+  EXPECT_EQ(options.path, BatchRender::Path::Orbit);
+  EXPECT_EQ(options.frames, 200);
+  EXPECT_EQ(options.firstFrame, 0);
+  EXPECT_EQ(options.lastFrame, 199);
+  EXPECT_EQ(options.width, 1920);
+  EXPECT_EQ(options.height, 1080);
+  EXPECT_EQ(options.format, QString("png"));
+}
+
+TEST(BatchRenderTest, options)
+{
+  BatchRender::Options options;
+  QString error;
+  ASSERT_TRUE(BatchRender::parse(
+    arguments({ "--path", "slices", "--frames", "50", "--first-frame", "25",
+                "--size", "640x480", "--format", "TIFF", "--encoders", "3" }),
+    options, error));
+  EXPECT_EQ(options.path, BatchRender::Path::Slices);
+  EXPECT_EQ(options.frames, 50);
+  EXPECT_EQ(options.firstFrame, 25);
+  EXPECT_EQ(options.lastFrame, 49);
+  EXPECT_EQ(options.width, 640);
+  EXPECT_EQ(options.height, 480);
+  EXPECT_EQ(options.format, QString("tif"));
+  EXPECT_EQ(options.encoders, 3);
+}
+
+TEST(BatchRenderTest, invalid)
+{
+  BatchRender::Options options;
+  QString error;
+  EXPECT_FALSE(BatchRender::parse({ "tomviz", "--batch-render", "state.tvsm" },
+                                  options, error));
+  EXPECT_FALSE(error.isEmpty());
+  EXPECT_FALSE(
+    BatchRender::parse(arguments({ "--path", "spiral" }), options, error));
+  EXPECT_FALSE(
+    BatchRender::parse(arguments({ "--size", "640" }), options, error));
+  EXPECT_FALSE(BatchRender::parse(arguments({ "--format", "gif" }), options,
+                                  error));
+  EXPECT_FALSE(BatchRender::parse(
+    arguments({ "--frames", "10", "--last-frame", "10" }), options, error));
+  EXPECT_FALSE(BatchRender::parse(
+    arguments({ "--first-frame", "5", "--last-frame", "4" }), options, error));
+}
+
+TEST(BatchRenderTest, frameFileName)
+{
+  BatchRender::Options options;
+  options.outputDirectory = "frames";
+  options.frames = 200;
+  EXPECT_EQ(BatchRender::frameFileName(options, 7),
+            QDir("frames").filePath("frame_0007.png"));
+  options.frames = 20000;
+  options.format = "jpg";
+  EXPECT_EQ(BatchRender::frameFileName(options, 7),
+            QDir("frames").filePath("frame_00007.jpg"));
+}
+
+TEST(BatchRenderTest, sweepIndex)
+{
+  // The first and last frames show the first and last slices.
+  EXPECT_EQ(BatchRender::sweepIndex(0, 100, 50), 0);
+  EXPECT_EQ(BatchRender::sweepIndex(99, 100, 50), 49);
+  EXPECT_EQ(BatchRender::sweepIndex(50, 101, 11), 5);
+  EXPECT_EQ(BatchRender::sweepIndex(3, 1, 50), 0);
+  EXPECT_EQ(BatchRender::sweepIndex(3, 10, 1), 0);
+}
+
+TEST(BatchRenderTest, contour)
+{
+  // The surface of the contour is extracted in the background as the state
+  // loads, the first frame shows it all the same.
+  std::unique_ptr<QCoreApplication> app;
+  int argc = 1;
+  char name[] = "BatchRenderTest";
+  char* argv[] = { name, nullptr };
+  if (!QCoreApplication::instance()) {
+    app.reset(new QCoreApplication(argc, argv));
+  }
+
+  QTemporaryDir dir;
+  QProcess tomviz;
+  tomviz.start(TOMVIZ_EXECUTABLE,
+               { "--batch-render",
+                 QString("%1/fixtures/contour.tvsm").arg(SOURCE_DIR),
+                 "--output", dir.path(), "--frames", "1", "--size", "64x64" });
+  ASSERT_TRUE(tomviz.waitForFinished(300000));
+  ASSERT_EQ(tomviz.exitStatus(), QProcess::NormalExit);
+  ASSERT_EQ(tomviz.exitCode(), 0)
+    << tomviz.readAllStandardError().toStdString();
+
+  vtkNew<vtkPNGReader> reader;
+  reader->SetFileName(dir.filePath("frame_0000.png").toLocal8Bit().data());
+  reader->Update();
+  auto frame = reader->GetOutput();
+  int dims[3];
+  frame->GetDimensions(dims);
+  ASSERT_EQ(dims[0], 64);
+  ASSERT_EQ(dims[1], 64);
+
+  // The sphere covers about a sixth of the frame, the rest is background.
+  auto pixels = frame->GetPointData()->GetScalars();
+  ASSERT_NE(pixels, nullptr);
+  int surface = 0;
+  for (vtkIdType i = 0; i < pixels->GetNumberOfTuples(); ++i) {
+    for (int c = 0; c < pixels->GetNumberOfComponents(); ++c) {
+      if (pixels->GetComponent(i, c) != pixels->GetComponent(0, c)) {
+        ++surface;
+        break;
+      }
+    }
+  }
+  EXPECT_GT(surface, 64 * 64 / 20);
+}
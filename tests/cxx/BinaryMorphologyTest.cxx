@@ -0,0 +1,324 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <gtest/gtest.h>
+
+#include "BinaryMorphology.h"
+#include "TomvizTest.h"
+#include "operators/BinaryMorphologyOperator.h"
+#include "operators/OperatorPython.h"
+
+#include <vtkFloatArray.h>
+#include <vtkImageData.h>
+#include <vtkPointData.h>
+#include <vtkSmartPointer.h>
+#include <vtkUnsignedCharArray.h>
+
+#include <QFile>
+#include <QMap>
+#include <QVariant>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace tomviz;
+using namespace tomviz::BinaryMorphology;
+
+namespace {
+
+bool inElement(StructuringElement element, int radius, int dx, int dy, int dz)
+{
+  switch (element) {
+    case StructuringElement::Box:
+      return true;
+    case StructuringElement::Ball:
+      return 4 * (dx * dx + dy * dy + dz * dz) <=
+             (2 * radius + 1) * (2 * radius + 1);
+    case StructuringElement::Cross:
+      return (dx != 0) + (dy != 0) + (dz != 0) <= 1;
+  }
+  return false;
+}
+
+// Straightforward implementation of ITK's binary dilate and erode filters,
+// the boundary is background for dilation and foreground for erosion.
+std::vector<unsigned char> reference(const std::vector<unsigned char>& input,
+                                     const int dims[3], bool dilation,
+                                     StructuringElement element, int radius,
+                                     unsigned char object,
+                                     unsigned char background)
+{
+  auto index = [&](int x, int y, int z) {
+    return (static_cast<size_t>(z) * dims[1] + y) * dims[0] + x;
+  };
+  std::vector<unsigned char> output(input);
+  for (int z = 0; z < dims[2]; ++z) {
+    for (int y = 0; y < dims[1]; ++y) {
+      for (int x = 0; x < dims[0]; ++x) {
+        bool hit = !dilation;
+        for (int dz = -radius; dz <= radius; ++dz) {
+          for (int dy = -radius; dy <= radius; ++dy) {
+            for (int dx = -radius; dx <= radius; ++dx) {
+              if (!inElement(element, radius, dx, dy, dz)) {
+                continue;
+              }
+              const int xx = x + dx, yy = y + dy, zz = z + dz;
+              const bool inside = xx >= 0 && yy >= 0 && zz >= 0 &&
+                                  xx < dims[0] && yy < dims[1] && zz < dims[2];
+              const bool foreground =
+                inside ? input[index(xx, yy, zz)] == object : !dilation;
+              hit = dilation ? hit || foreground : hit && foreground;
+            }
+          }
+        }
+        const size_t i = index(x, y, z);
+        if (dilation && hit) {
+          output[i] = object;
+        } else if (!dilation && !hit && input[i] == object) {
+          output[i] = background;
+        }
+      }
+    }
+  }
+  return output;
+}
+
+std::vector<unsigned char> randomLabels(const int dims[3], unsigned seed)
+{
+  std::mt19937 generator(seed);
+  std::uniform_int_distribution<int> distribution(0, 9);
+  std::vector<unsigned char> labels(
+    static_cast<size_t>(dims[0]) * dims[1] * dims[2]);
+  for (auto& label : labels) {
+    // Mostly objects, some background and a few voxels of another label.
+    const int v = distribution(generator);
+    label = v < 6 ? 1 : v < 9 ? 0 : 2;
+  }
+  return labels;
+}
+
+vtkSmartPointer<vtkImageData> labelImage(
+  const std::vector<unsigned char>& labels, const int dims[3])
+{
+  auto image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(dims[0], dims[1], dims[2]);
+  auto array = vtkSmartPointer<vtkUnsignedCharArray>::New();
+  array->SetName("labels");
+  array->SetNumberOfTuples(labels.size());
+  std::copy(labels.begin(), labels.end(), array->GetPointer(0));
+  image->GetPointData()->SetScalars(array);
+  return image;
+}
+
+const unsigned char* labelValues(vtkImageData* image)
+{
+  return static_cast<unsigned char*>(
+    image->GetPointData()->GetScalars()->GetVoidPointer(0));
+}
+
+QString readScript(const QString& name)
+{
+  QFile file(QString("%1/../../tomviz/python/%2").arg(SOURCE_DIR).arg(name));
+  if (!file.open(QIODevice::ReadOnly)) {
+    return QString();
+  }
+  return QString(file.readAll());
+}
+
+// The ITK based Python operator of each operation, as the menu used to add.
+struct PythonOperation
+{
+  Operation operation;
+  const char* script;
+};
+
+const PythonOperation PythonOperations[] = {
+  { Operation::Dilate, "BinaryDilate.py" },
+  { Operation::Erode, "BinaryErode.py" },
+  { Operation::Open, "BinaryOpen.py" },
+  { Operation::Close, "BinaryClose.py" }
+};
+
+// Run the Python operator, returning false if it could not run, typically
+// because ITK is not available.
+bool runPython(const PythonOperation& python, StructuringElement element,
+               int radius, vtkImageData* image)
+{
+  OperatorPython op;
+  op.setLabel(python.script);
+  op.setScript(readScript(python.script));
+  QMap<QString, QVariant> arguments;
+  arguments["structuring_element_id"] = static_cast<int>(element);
+  arguments["radius"] = radius;
+  arguments["object_label"] = 1;
+  arguments["background_label"] = 0;
+  op.setArguments(arguments);
+  return op.transform(image) == TransformResult::Complete;
+}
+} // namespace
+
+class BinaryMorphologyTest : public ::testing::Test
+{
+};
+
+TEST_F(BinaryMorphologyTest, matchesReference)
+{
+  const int dims[3] = { 70, 9, 11 };
+  const StructuringElement elements[] = { StructuringElement::Box,
+                                          StructuringElement::Ball,
+                                          StructuringElement::Cross };
+  const Operation operations[] = { Operation::Dilate, Operation::Erode,
+                                   Operation::Open, Operation::Close };
+  for (auto element : elements) {
+    for (int radius = 0; radius <= 3; ++radius) {
+      for (auto operation : operations) {
+        auto input = randomLabels(dims, radius * 7 + static_cast<int>(element));
+        std::vector<unsigned char> expected;
+        switch (operation) {
+          case Operation::Dilate:
+            expected = reference(input, dims, true, element, radius, 1, 0);
+            break;
+          case Operation::Erode:
+            expected = reference(input, dims, false, element, radius, 1, 0);
+            break;
+          case Operation::Open:
+            expected = reference(
+              reference(input, dims, false, element, radius, 1, 0), dims,
+              true, element, radius, 1, 0);
+            break;
+          case Operation::Close:
+            expected = reference(
+              reference(input, dims, true, element, radius, 1, 0), dims,
+              false, element, radius, 1, 0);
+            break;
+        }
+
+        auto output = input;
+        ASSERT_TRUE(apply(output.data(), dims, operation, element, radius,
+                          (unsigned char)1, (unsigned char)0));
+        ASSERT_TRUE(output == expected)
+          << "element " << static_cast<int>(element) << " radius " << radius
+          << " operation " << static_cast<int>(operation);
+      }
+    }
+  }
+}
+
+TEST_F(BinaryMorphologyTest, canceled)
+{
+  const int dims[3] = { 16, 16, 16 };
+  auto input = randomLabels(dims, 1);
+  auto output = input;
+  ASSERT_FALSE(apply(output.data(), dims, Operation::Close,
+                     StructuringElement::Ball, 2, (unsigned char)1,
+                     (unsigned char)0, []() { return true; }));
+  ASSERT_TRUE(output == input);
+}
+
+TEST_F(BinaryMorphologyTest, compactOutput)
+{
+  // A float label map comes out of the operator stored as bytes.
+  const int dims[3] = { 12, 10, 8 };
+  auto labels = randomLabels(dims, 3);
+  auto image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(dims[0], dims[1], dims[2]);
+  auto array = vtkSmartPointer<vtkFloatArray>::New();
+  array->SetName("labels");
+  array->SetNumberOfTuples(labels.size());
+  for (size_t i = 0; i < labels.size(); ++i) {
+    array->SetValue(i, labels[i]);
+  }
+  image->GetPointData()->SetScalars(array);
+
+  BinaryMorphologyOperator op(Operation::Dilate);
+  ASSERT_EQ(op.transform(image), TransformResult::Complete);
+  auto scalars = image->GetPointData()->GetScalars();
+  ASSERT_EQ(scalars->GetDataType(), VTK_UNSIGNED_CHAR);
+  ASSERT_STREQ(scalars->GetName(), "labels");
+  ASSERT_EQ(image->GetPointData()->GetNumberOfArrays(), 1);
+
+  apply(labels.data(), dims, Operation::Dilate, StructuringElement::Box, 1,
+        (unsigned char)1, (unsigned char)0);
+  auto values = static_cast<unsigned char*>(scalars->GetVoidPointer(0));
+  ASSERT_TRUE(std::equal(labels.begin(), labels.end(), values));
+}
+
+TEST_F(BinaryMorphologyTest, matchesPython)
+{
+  // Odd sizes, so the operators are checked against ITK's boundary handling
+  // away from any chunk size.
+  const int dims[3] = { 19, 14, 23 };
+  const auto labels = randomLabels(dims, 4);
+  const StructuringElement elements[] = { StructuringElement::Box,
+                                          StructuringElement::Ball,
+                                          StructuringElement::Cross };
+  for (const auto& python : PythonOperations) {
+    for (auto element : elements) {
+      for (int radius : { 1, 2 }) {
+        auto expected = labelImage(labels, dims);
+        if (!runPython(python, element, radius, expected)) {
+          std::cout << "Skipping " << python.script
+                    << ", the Python operator could not run." << std::endl;
+          return;
+        }
+
+        auto image = labelImage(labels, dims);
+        BinaryMorphologyOperator op(python.operation);
+        op.setStructuringElement(element);
+        op.setRadius(radius);
+        ASSERT_EQ(op.transform(image), TransformResult::Complete);
+        ASSERT_TRUE(std::equal(labelValues(image),
+                               labelValues(image) + labels.size(),
+                               labelValues(expected)))
+          << python.script << " element "
+          << static_cast<int>(element) << " radius " << radius;
+      }
+    }
+  }
+}
+
+// Throughput of the native and the ITK based Python operators on a 256^3
+// volume, run with --gtest_also_run_disabled_tests.
+TEST_F(BinaryMorphologyTest, DISABLED_benchmark)
+{
+  const int dims[3] = { 256, 256, 256 };
+  auto input = randomLabels(dims, 2);
+  const StructuringElement elements[] = { StructuringElement::Box,
+                                          StructuringElement::Ball,
+                                          StructuringElement::Cross };
+  const char* names[] = { "box", "ball", "cross" };
+  for (auto element : elements) {
+    for (int radius : { 1, 3, 5 }) {
+      auto output = input;
+      auto start = std::chrono::steady_clock::now();
+      apply(output.data(), dims, Operation::Open, element, radius,
+            (unsigned char)1, (unsigned char)0);
+      std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+      std::cout << "open " << names[static_cast<int>(element)] << " radius "
+                << radius << ": " << elapsed.count() << " s" << std::endl;
+    }
+  }
+  for (const auto& python : PythonOperations) {
+    for (bool native : { true, false }) {
+      auto image = labelImage(input, dims);
+      auto start = std::chrono::steady_clock::now();
+      if (native) {
+        BinaryMorphologyOperator op(python.operation);
+        op.setStructuringElement(StructuringElement::Ball);
+        op.setRadius(3);
+        ASSERT_EQ(op.transform(image), TransformResult::Complete);
+      } else if (!runPython(python, StructuringElement::Ball, 3, image)) {
+        continue;
+      }
+      std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+      std::cout << (native ? "native " : "python ") << python.script
+                << " ball radius 3: " << elapsed.count() << " s"
+                << std::endl;
+    }
+  }
+}
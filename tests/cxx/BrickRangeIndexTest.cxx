@@ -0,0 +1,163 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <gtest/gtest.h>
+
+#include "BrickRangeIndex.h"
+#include "TomvizTest.h"
+
+#include <array>
+#include <random>
+#include <vector>
+
+using namespace tomviz;
+
+namespace {
+
+std::vector<float> randomVolume(const int dims[3], unsigned seed)
+{
+  std::mt19937 generator(seed);
+  std::uniform_real_distribution<float> distribution(0.f, 1.f);
+  std::vector<float> values(static_cast<size_t>(dims[0]) * dims[1] * dims[2]);
+  for (auto& value : values) {
+    value = distribution(generator);
+  }
+  return values;
+}
+
+// Range of the points of the cells in [16 b, 16 (b + 1)) along each axis.
+void referenceRange(const std::vector<float>& values, const int dims[3],
+                    const int b[3], double range[2])
+{
+  range[0] = std::numeric_limits<double>::infinity();
+  range[1] = -range[0];
+  int first[3];
+  int last[3];
+  for (int i = 0; i < 3; ++i) {
+    first[i] = b[i] * BrickRangeIndex::BrickSize;
+    last[i] = std::min(first[i] + BrickRangeIndex::BrickSize, dims[i] - 1);
+  }
+  for (int z = first[2]; z <= last[2]; ++z) {
+    for (int y = first[1]; y <= last[1]; ++y) {
+      for (int x = first[0]; x <= last[0]; ++x) {
+        const double value =
+          values[(static_cast<size_t>(z) * dims[1] + y) * dims[0] + x];
+        if (std::isfinite(value)) {
+          range[0] = std::min(range[0], value);
+          range[1] = std::max(range[1], value);
+        }
+      }
+    }
+  }
+}
+} // namespace
+
+TEST(BrickRangeIndexTest, matchesReference)
+{
+  const int dims[3] = { 37, 16, 50 };
+  auto values = randomVolume(dims, 7);
+  values[1000] = std::numeric_limits<float>::quiet_NaN();
+
+  BrickRangeIndex index;
+  index.build(values.data(), 1, dims);
+  EXPECT_EQ(index.bricks()[0], 3);
+  EXPECT_EQ(index.bricks()[1], 1);
+  EXPECT_EQ(index.bricks()[2], 4);
+
+  double range[2] = { 1.0, 0.0 };
+  for (int k = 0; k < index.bricks()[2]; ++k) {
+    for (int j = 0; j < index.bricks()[1]; ++j) {
+      for (int i = 0; i < index.bricks()[0]; ++i) {
+        const int b[3] = { i, j, k };
+        double expected[2];
+        referenceRange(values, dims, b, expected);
+        const int64_t brick = index.brickId(i, j, k);
+        EXPECT_EQ(index.minimum(brick), expected[0]);
+        EXPECT_EQ(index.maximum(brick), expected[1]);
+        range[0] = std::min(range[0], expected[0]);
+        range[1] = std::max(range[1], expected[1]);
+      }
+    }
+  }
+  EXPECT_EQ(index.range()[0], range[0]);
+  EXPECT_EQ(index.range()[1], range[1]);
+}
+
+TEST(BrickRangeIndexTest, components)
+{
+  // Only the first component is indexed.
+  const int dims[3] = { 20, 20, 20 };
+  std::vector<short> values(2 * 20 * 20 * 20, 100);
+  for (size_t i = 0; i < values.size(); i += 2) {
+    values[i] = 3;
+  }
+  BrickRangeIndex index;
+  index.build(values.data(), 2, dims);
+  EXPECT_EQ(index.range()[0], 3.0);
+  EXPECT_EQ(index.range()[1], 3.0);
+}
+
+TEST(BrickRangeIndexTest, sparseQueries)
+{
+  // A small particle in an empty volume, only the bricks around it overlap
+  // any range above the background.
+  const int dims[3] = { 64, 64, 64 };
+  std::vector<unsigned char> values(64 * 64 * 64, 0);
+  for (int z = 30; z < 35; ++z) {
+    for (int y = 40; y < 44; ++y) {
+      for (int x = 2; x < 5; ++x) {
+        values[(z * 64 + y) * 64 + x] = 200;
+      }
+    }
+  }
+  BrickRangeIndex index;
+  index.build(values.data(), 1, dims);
+  EXPECT_EQ(index.numberOfBricks(), 64);
+
+  // z spans the points 30 to 34, which lie in brick layers 1 and 2 only.
+  auto bricks = index.bricksInRange(100, 255);
+  ASSERT_EQ(bricks.size(), 2u);
+  EXPECT_EQ(bricks[0], index.brickId(0, 2, 1));
+  EXPECT_EQ(bricks[1], index.brickId(0, 2, 2));
+  EXPECT_FALSE(index.layerInRange(0, 100, 255));
+  EXPECT_TRUE(index.layerInRange(1, 100, 255));
+  EXPECT_TRUE(index.layerInRange(2, 100, 255));
+  EXPECT_FALSE(index.layerInRange(3, 100, 255));
+
+  // One extent per brick row, the two bricks are in different layers.
+  auto extents = index.extentsInRange(100, 255);
+  ASSERT_EQ(extents.size(), 2u);
+  const std::array<int, 6> lower = { { 0, 16, 32, 48, 16, 32 } };
+  const std::array<int, 6> upper = { { 0, 16, 32, 48, 32, 48 } };
+  EXPECT_EQ(extents[0], lower);
+  EXPECT_EQ(extents[1], upper);
+
+  EXPECT_TRUE(index.extentsInRange(201, 255).empty());
+
+  // Neighboring bricks of a row share their extent.
+  extents = index.extentsInRange(0, 0);
+  ASSERT_EQ(extents.size(), 16u);
+  const std::array<int, 6> row = { { 0, 63, 0, 16, 0, 16 } };
+  EXPECT_EQ(extents[0], row);
+  EXPECT_EQ(index.bricksInRange(0, 0).size(), 64u);
+}
+
+TEST(BrickRangeIndexTest, singleSlice)
+{
+  const int dims[3] = { 40, 3, 1 };
+  std::vector<int> values(120);
+  for (int i = 0; i < 120; ++i) {
+    values[i] = i;
+  }
+  BrickRangeIndex index;
+  index.build(values.data(), 1, dims);
+  EXPECT_EQ(index.bricks()[0], 3);
+  EXPECT_EQ(index.bricks()[1], 1);
+  EXPECT_EQ(index.bricks()[2], 1);
+  // The bricks share the points on their boundaries.
+  EXPECT_EQ(index.minimum(0), 0.0);
+  EXPECT_EQ(index.maximum(0), 96.0);
+  EXPECT_EQ(index.minimum(1), 16.0);
+  EXPECT_EQ(index.maximum(2), 119.0);
+  EXPECT_TRUE(index.layerInRange(0, 50, 50));
+}
@@ -0,0 +1,118 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <gtest/gtest.h>
+
+#include "ComputeHistogram.h"
+#include "TomvizTest.h"
+
+#include <vtkFloatArray.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkUnsignedCharArray.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <random>
+
+using namespace tomviz;
+
+TEST(ComputeHistogramTest, allArrays)
+{
+  // Enough tuples for the blocks to be split across threads.
+  const vtkIdType numTuples = 300000;
+  std::mt19937 generator(7);
+  std::uniform_real_distribution<float> distribution(-5.0f, 20.0f);
+
+  vtkNew<vtkFloatArray> floats;
+  floats->SetNumberOfTuples(numTuples);
+  vtkNew<vtkUnsignedCharArray> bytes;
+  bytes->SetNumberOfTuples(numTuples);
+  vtkNew<vtkFloatArray> vectors;
+  vectors->SetNumberOfComponents(3);
+  vectors->SetNumberOfTuples(numTuples);
+  for (vtkIdType i = 0; i < numTuples; ++i) {
+    floats->SetValue(i, distribution(generator));
+    bytes->SetValue(i, static_cast<unsigned char>(i % 251));
+    for (int c = 0; c < 3; ++c) {
+      vectors->SetTypedComponent(i, c, distribution(generator));
+    }
+  }
+  floats->SetValue(42, std::numeric_limits<float>::quiet_NaN());
+
+  std::vector<vtkDataArray*> arrays = { floats.Get(), bytes.Get(),
+                                       vectors.Get() };
+  std::vector<std::array<double, 2>> ranges;
+  std::vector<std::vector<uint64_t>> pops;
+  std::vector<int> invalid;
+  CalculateHistograms(arrays, 256, ranges, pops, invalid);
+  ASSERT_EQ(ranges.size(), arrays.size());
+  EXPECT_EQ(invalid[0], 1);
+  EXPECT_EQ(invalid[1], 0);
+  EXPECT_EQ(invalid[2], 0);
+
+  // Each histogram matches the histogram of its array on its own.
+  for (size_t i = 0; i < arrays.size(); ++i) {
+    double range[2];
+    arrays[i]->GetFiniteRange(range, -1);
+    EXPECT_DOUBLE_EQ(ranges[i][0], range[0]);
+    EXPECT_DOUBLE_EQ(ranges[i][1], range[1]);
+
+    std::vector<uint64_t> expected(256, 0);
+    int expectedInvalid = 0;
+    const float inv = static_cast<float>(255 / (range[1] - range[0]));
+    switch (arrays[i]->GetDataType()) {
+      vtkTemplateMacro(CalculateHistogram(
+        static_cast<VTK_TT*>(arrays[i]->GetVoidPointer(0)), numTuples,
+        arrays[i]->GetNumberOfComponents(), static_cast<float>(range[0]),
+        static_cast<float>(range[1]), expected.data(), inv,
+        expectedInvalid));
+    }
+    EXPECT_EQ(pops[i], expected);
+    EXPECT_EQ(invalid[i], expectedInvalid);
+  }
+}
+
+TEST(ComputeHistogramTest, constantArray)
+{
+  vtkNew<vtkFloatArray> values;
+  values->SetNumberOfTuples(100);
+  values->FillValue(3.0f);
+
+  std::vector<vtkDataArray*> arrays = { values.Get() };
+  std::vector<std::array<double, 2>> ranges;
+  std::vector<std::vector<uint64_t>> pops;
+  std::vector<int> invalid;
+  CalculateHistograms(arrays, 256, ranges, pops, invalid);
+  EXPECT_EQ(ranges[0][0], 3.0);
+  EXPECT_EQ(ranges[0][1], 4.0);
+  EXPECT_EQ(pops[0][0], 100u);
+}
+
+TEST(ComputeHistogramTest, constantImage2D)
+{
+  vtkNew<vtkImageData> image;
+  image->SetDimensions(8, 8, 8);
+  image->AllocateScalars(VTK_FLOAT, 1);
+  auto values = static_cast<float*>(image->GetScalarPointer());
+  std::fill(values, values + 512, 3.0f);
+  GradientMagnitude gradient;
+  gradient.build(image.Get());
+
+  // A range of a single value puts every voxel in the first bin, with
+  // finite spacing.
+  vtkNew<vtkImageData> histogram;
+  histogram->SetDimensions(16, 16, 1);
+  histogram->AllocateScalars(VTK_DOUBLE, 1);
+  const double range[2] = { 3.0, 3.0 };
+  Calculate2DHistogram(values, 1, range, gradient, histogram.Get());
+  auto pops = static_cast<double*>(histogram->GetScalarPointer());
+  EXPECT_EQ(pops[0], 512.0);
+  EXPECT_EQ(std::accumulate(pops, pops + 256, 0.0), 512.0);
+  double spacing[3];
+  histogram->GetSpacing(spacing);
+  EXPECT_TRUE(std::isfinite(spacing[0]));
+  EXPECT_GT(spacing[0], 0.0);
+}
@@ -0,0 +1,170 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <gtest/gtest.h>
+
+#include "ConnectedComponents.h"
+#include "TomvizTest.h"
+
+#include <cmath>
+#include <vector>
+
+using namespace tomviz;
+
+class ConnectedComponentsTest : public ::testing::Test
+{
+};
+
+TEST_F(ConnectedComponentsTest, empty)
+{
+  const int dims[3] = { 4, 4, 4 };
+  std::vector<short> input(64, 0);
+  std::vector<uint32_t> labels(64, 7);
+  std::vector<ConnectedComponents::LabelMoments> moments;
+
+  auto n = ConnectedComponents::label(input.data(), dims, short(0),
+                                      labels.data(), &moments);
+  ASSERT_EQ(n, 0u);
+  ASSERT_TRUE(moments.empty());
+  for (auto label : labels) {
+    ASSERT_EQ(label, 0u);
+  }
+}
+
+TEST_F(ConnectedComponentsTest, orderedBySize)
+{
+  // A long bar along z crossing every slab, a single voxel and a 2x2x1 block.
+  const int dims[3] = { 8, 8, 32 };
+  std::vector<unsigned char> input(8 * 8 * 32, 0);
+  auto index = [&](int x, int y, int z) { return (z * 8 + y) * 8 + x; };
+  for (int z = 0; z < 32; ++z) {
+    input[index(1, 1, z)] = 1;
+  }
+  input[index(6, 6, 3)] = 2;
+  for (int y = 4; y < 6; ++y) {
+    for (int x = 4; x < 6; ++x) {
+      input[index(x, y, 20)] = 3;
+    }
+  }
+  // Diagonal neighbors are not face connected.
+  input[index(2, 2, 0)] = 1;
+
+  std::vector<uint32_t> labels(input.size());
+  std::vector<ConnectedComponents::LabelMoments> moments;
+  auto n = ConnectedComponents::label(input.data(), dims, (unsigned char)0,
+                                      labels.data(), &moments);
+  ASSERT_EQ(n, 4u);
+  ASSERT_EQ(moments.size(), 4u);
+
+  // The two single voxels come first, the one found last in the volume first.
+  ASSERT_EQ(labels[index(6, 6, 3)], 1u);
+  ASSERT_EQ(labels[index(2, 2, 0)], 2u);
+  ASSERT_EQ(labels[index(4, 4, 20)], 3u);
+  ASSERT_EQ(labels[index(5, 5, 20)], 3u);
+  for (int z = 0; z < 32; ++z) {
+    ASSERT_EQ(labels[index(1, 1, z)], 4u);
+  }
+  ASSERT_EQ(labels[index(0, 0, 0)], 0u);
+
+  const auto& bar = moments[3];
+  ASSERT_EQ(bar.count, 32u);
+  ASSERT_DOUBLE_EQ(bar.sum[0] / bar.count, 1.0);
+  ASSERT_DOUBLE_EQ(bar.sum[2] / bar.count, 15.5);
+  ASSERT_EQ(bar.min[2], 0);
+  ASSERT_EQ(bar.max[2], 31);
+
+  const auto& block = moments[2];
+  ASSERT_EQ(block.count, 4u);
+  ASSERT_DOUBLE_EQ(block.sum[0] / block.count, 4.5);
+  ASSERT_DOUBLE_EQ(block.sum[1] / block.count, 4.5);
+  ASSERT_EQ(block.min[0], 4);
+  ASSERT_EQ(block.max[1], 5);
+}
+
+TEST_F(ConnectedComponentsTest, mergedAcrossSlabs)
+{
+  // A U shape whose arms only meet at the top of the volume, so the arms get
+  // separate labels in the lower slabs and must be merged.
+  const int dims[3] = { 5, 1, 40 };
+  std::vector<float> input(5 * 40, 0.f);
+  for (int z = 0; z < 40; ++z) {
+    input[z * 5] = 1.f;
+    input[z * 5 + 4] = 1.f;
+  }
+  for (int x = 0; x < 5; ++x) {
+    input[39 * 5 + x] = 1.f;
+  }
+
+  std::vector<uint32_t> labels(input.size());
+  auto n = ConnectedComponents::label(input.data(), dims, 0.f, labels.data());
+  ASSERT_EQ(n, 1u);
+  ASSERT_EQ(labels[0], 1u);
+  ASSERT_EQ(labels[4], 1u);
+  ASSERT_EQ(labels[2], 0u);
+}
+
+TEST_F(ConnectedComponentsTest, measure)
+{
+  const int dims[3] = { 6, 4, 12 };
+  std::vector<int> input(6 * 4 * 12, 0);
+  auto index = [&](int x, int y, int z) { return (z * 4 + y) * 6 + x; };
+  // Label 3 is a single voxel touching a 2x1x1 bar of label 7, and label 7
+  // has a second, separate voxel in another slab.
+  input[index(0, 0, 0)] = 3;
+  input[index(1, 0, 0)] = 7;
+  input[index(2, 0, 0)] = 7;
+  input[index(4, 3, 11)] = 7;
+
+  auto objects = ConnectedComponents::measure(input.data(), dims);
+  ASSERT_EQ(objects.size(), 2u);
+  ASSERT_EQ(objects.count(3), 1u);
+  ASSERT_EQ(objects.count(7), 1u);
+
+  const auto& single = objects[3];
+  ASSERT_EQ(single.count, 1u);
+  ASSERT_EQ(single.faces[0], 2u);
+  ASSERT_EQ(single.faces[1], 2u);
+  ASSERT_EQ(single.faces[2], 2u);
+
+  // Faces shared with another label still count, faces within the bar don't.
+  const auto& pieces = objects[7];
+  ASSERT_EQ(pieces.count, 3u);
+  ASSERT_EQ(pieces.faces[0], 4u);
+  ASSERT_EQ(pieces.faces[1], 6u);
+  ASSERT_EQ(pieces.faces[2], 6u);
+  ASSERT_DOUBLE_EQ(pieces.sum[2], 11.0);
+  ASSERT_EQ(pieces.max[2], 11);
+}
+
+TEST_F(ConnectedComponentsTest, principalAxes)
+{
+  // A 1x3x9 block, longest along z and shortest along x, with a larger
+  // spacing along y that still leaves it longest along z.
+  const int dims[3] = { 4, 4, 10 };
+  std::vector<unsigned char> input(4 * 4 * 10, 0);
+  for (int z = 0; z < 9; ++z) {
+    for (int y = 0; y < 3; ++y) {
+      input[(z * 4 + y) * 4 + 2] = 1;
+    }
+  }
+  auto objects = ConnectedComponents::measure(input.data(), dims);
+  ASSERT_EQ(objects.size(), 1u);
+
+  const double origin[3] = { 1.0, 0.0, -1.0 };
+  const double spacing[3] = { 1.0, 2.0, 1.0 };
+  double center[3];
+  double axes[3][3];
+  ConnectedComponents::principalAxes(objects[1], origin, spacing, center,
+                                     axes);
+  ASSERT_DOUBLE_EQ(center[0], 3.0);
+  ASSERT_DOUBLE_EQ(center[1], 2.0);
+  ASSERT_DOUBLE_EQ(center[2], 3.0);
+
+  // Axes are unit vectors along z, y and x, up to their sign.
+  const int expected[3] = { 2, 1, 0 };
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      ASSERT_NEAR(std::abs(axes[i][j]), j == expected[i] ? 1.0 : 0.0, 1e-9);
+    }
+  }
+}
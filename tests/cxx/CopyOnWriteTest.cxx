@@ -0,0 +1,111 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <gtest/gtest.h>
+
+#include "CopyOnWrite.h"
+
+#include <vtkDoubleArray.h>
+#include <vtkFieldData.h>
+#include <vtkFloatArray.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+
+using namespace tomviz;
+
+namespace {
+
+vtkSmartPointer<vtkImageData> image()
+{
+  auto image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(8, 8, 8);
+  for (auto name : { "a", "b" }) {
+    vtkNew<vtkFloatArray> array;
+    array->SetName(name);
+    array->SetNumberOfTuples(512);
+    array->FillValue(1);
+    image->GetPointData()->AddArray(array.GetPointer());
+  }
+  image->GetPointData()->SetActiveScalars("b");
+
+  vtkNew<vtkDoubleArray> angles;
+  angles->SetName("tilt_angles");
+  angles->SetNumberOfTuples(8);
+  angles->FillValue(0);
+  image->GetFieldData()->AddArray(angles.GetPointer());
+  return image;
+}
+
+float* values(vtkImageData* image, const char* name)
+{
+  return static_cast<float*>(
+    image->GetPointData()->GetArray(name)->GetVoidPointer(0));
+}
+} // namespace
+
+TEST(CopyOnWriteTest, copy)
+{
+  auto original = image();
+  auto copy = CopyOnWrite::copy(original);
+
+  int dims[3];
+  copy->GetDimensions(dims);
+  EXPECT_EQ(dims[2], 8);
+  EXPECT_STREQ(copy->GetPointData()->GetScalars()->GetName(), "b");
+
+  // The values are shared, the arrays are not.
+  auto a = original->GetPointData()->GetArray("a");
+  auto copyA = copy->GetPointData()->GetArray("a");
+  EXPECT_NE(a, copyA);
+  EXPECT_EQ(values(original, "a"), values(copy, "a"));
+  EXPECT_TRUE(CopyOnWrite::isShared(a));
+  EXPECT_TRUE(CopyOnWrite::isShared(copyA));
+  copyA->SetName("renamed");
+  EXPECT_STREQ(a->GetName(), "a");
+
+  // The field data is copied.
+  auto angles = copy->GetFieldData()->GetArray("tilt_angles");
+  angles->SetTuple1(0, 45);
+  EXPECT_EQ(original->GetFieldData()->GetArray("tilt_angles")->GetTuple1(0),
+            0);
+}
+
+TEST(CopyOnWriteTest, detach)
+{
+  auto original = image();
+  auto copy = CopyOnWrite::copy(original);
+  auto snapshot = CopyOnWrite::copy(copy);
+
+  // Only the array written is copied, and only once.
+  auto scalars = copy->GetPointData()->GetScalars();
+  EXPECT_TRUE(CopyOnWrite::detach(scalars));
+  EXPECT_FALSE(CopyOnWrite::detach(scalars));
+  EXPECT_FALSE(CopyOnWrite::isShared(scalars));
+  EXPECT_EQ(values(original, "a"), values(copy, "a"));
+  EXPECT_NE(values(original, "b"), values(copy, "b"));
+  EXPECT_STREQ(scalars->GetName(), "b");
+
+  values(copy, "b")[7] = 3;
+  EXPECT_EQ(values(original, "b")[7], 1);
+  EXPECT_EQ(values(snapshot, "b")[7], 1);
+
+  // The original and the snapshot still share theirs.
+  EXPECT_EQ(values(original, "b"), values(snapshot, "b"));
+  EXPECT_TRUE(CopyOnWrite::isShared(original->GetPointData()->GetScalars()));
+}
+
+TEST(CopyOnWriteTest, released)
+{
+  auto original = image();
+  auto copy = CopyOnWrite::copy(original);
+  original = nullptr;
+
+  // Nothing shares the values anymore, writing needs no copy.
+  auto scalars = copy->GetPointData()->GetScalars();
+  EXPECT_FALSE(CopyOnWrite::isShared(scalars));
+  EXPECT_FALSE(CopyOnWrite::detach(scalars));
+
+  CopyOnWrite::detach(copy.GetPointer());
+  EXPECT_FALSE(CopyOnWrite::isShared(copy->GetPointData()->GetArray("a")));
+}
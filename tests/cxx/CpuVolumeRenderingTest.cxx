@@ -0,0 +1,128 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <gtest/gtest.h>
+
+#include "CpuVolumeRendering.h"
+#include "ParallelFor.h"
+#include "TomvizTest.h"
+
+#include <vtkCamera.h>
+#include <vtkColorTransferFunction.h>
+#include <vtkFixedPointVolumeRayCastMapper.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPiecewiseFunction.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderer.h>
+#include <vtkVolume.h>
+#include <vtkVolumeProperty.h>
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+using namespace tomviz;
+
+namespace {
+
+// Particles on a regular grid in an empty volume, like a sparse
+// reconstruction of nanoparticles.
+vtkSmartPointer<vtkImageData> particleImage(int size)
+{
+  auto image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(size, size, size);
+  image->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  auto data = static_cast<unsigned char*>(image->GetScalarPointer());
+  const int cell = 64;
+  const double radius = 12.0;
+  parallelFor(0, size, [&](int64_t begin, int64_t end) {
+    for (int64_t z = begin; z < end; ++z) {
+      for (int y = 0; y < size; ++y) {
+        unsigned char* row = data + (z * size + y) * size;
+        for (int x = 0; x < size; ++x) {
+          const double d[3] = { x % cell - cell / 2.0, y % cell - cell / 2.0,
+                                z % cell - cell / 2.0 };
+          const double r = std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+          row[x] = r < radius ? static_cast<unsigned char>(255 - 8 * r) : 0;
+        }
+      }
+    }
+  });
+  return image;
+}
+} // namespace
+
+TEST(CpuVolumeRenderingTest, setup)
+{
+  auto image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(8, 8, 8);
+  image->SetSpacing(0.5, 2.0, 1.0);
+  image->AllocateScalars(VTK_FLOAT, 1);
+
+  vtkNew<vtkFixedPointVolumeRayCastMapper> mapper;
+  CpuVolumeRendering::setup(mapper.GetPointer(), image);
+  EXPECT_EQ(mapper->GetInput(), image.GetPointer());
+  EXPECT_EQ(mapper->GetNumberOfThreads(),
+            static_cast<int>(parallelThreadCount()));
+  EXPECT_DOUBLE_EQ(mapper->GetSampleDistance(), 0.5);
+  EXPECT_DOUBLE_EQ(mapper->GetInteractiveSampleDistance(), 1.0);
+  EXPECT_TRUE(mapper->GetAutoAdjustSampleDistances());
+
+  EXPECT_TRUE(
+    CpuVolumeRendering::supportsBlendMode(vtkVolumeMapper::COMPOSITE_BLEND));
+  EXPECT_TRUE(CpuVolumeRendering::supportsBlendMode(
+    vtkVolumeMapper::MAXIMUM_INTENSITY_BLEND));
+  EXPECT_FALSE(
+    CpuVolumeRendering::supportsBlendMode(vtkVolumeMapper::ADDITIVE_BLEND));
+}
+
+// Frames per second of still and interactive renders of 512^3 and 1024^3
+// volumes, run with --gtest_also_run_disabled_tests.
+TEST(CpuVolumeRenderingTest, DISABLED_benchmark)
+{
+  for (int size : { 512, 1024 }) {
+    auto image = particleImage(size);
+
+    vtkNew<vtkFixedPointVolumeRayCastMapper> mapper;
+    CpuVolumeRendering::setup(mapper.GetPointer(), image);
+    vtkNew<vtkColorTransferFunction> color;
+    color->AddRGBPoint(0, 0, 0, 0);
+    color->AddRGBPoint(255, 1, 1, 1);
+    vtkNew<vtkPiecewiseFunction> opacity;
+    opacity->AddPoint(0, 0);
+    opacity->AddPoint(50, 0);
+    opacity->AddPoint(255, 1);
+    vtkNew<vtkVolumeProperty> property;
+    property->SetColor(color.GetPointer());
+    property->SetScalarOpacity(opacity.GetPointer());
+    property->SetInterpolationTypeToLinear();
+    property->ShadeOn();
+    vtkNew<vtkVolume> volume;
+    volume->SetMapper(mapper.GetPointer());
+    volume->SetProperty(property.GetPointer());
+
+    vtkNew<vtkRenderer> renderer;
+    renderer->AddVolume(volume.GetPointer());
+    vtkNew<vtkRenderWindow> window;
+    window->SetOffScreenRendering(1);
+    window->SetSize(800, 800);
+    window->AddRenderer(renderer.GetPointer());
+    renderer->ResetCamera();
+    window->Render();
+
+    const int frames = 20;
+    for (double rate : { 0.0001, 15.0 }) {
+      window->SetDesiredUpdateRate(rate);
+      auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < frames; ++i) {
+        renderer->GetActiveCamera()->Azimuth(360.0 / frames);
+        window->Render();
+      }
+      std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+      std::cout << size << "^3 " << (rate < 1.0 ? "still" : "interactive")
+                << ": " << frames / elapsed.count() << " fps" << std::endl;
+    }
+  }
+}
@@ -0,0 +1,110 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <gtest/gtest.h>
+
+#include "GradientMagnitude.h"
+#include "TomvizTest.h"
+
+#include <random>
+#include <vector>
+
+using namespace tomviz;
+
+namespace {
+
+std::vector<float> rampVolume(const int dims[3], const double slope[3])
+{
+  std::vector<float> values;
+  for (int z = 0; z < dims[2]; ++z) {
+    for (int y = 0; y < dims[1]; ++y) {
+      for (int x = 0; x < dims[0]; ++x) {
+        values.push_back(
+          static_cast<float>(slope[0] * x + slope[1] * y + slope[2] * z));
+      }
+    }
+  }
+  return values;
+}
+} // namespace
+
+TEST(GradientMagnitudeTest, ramp)
+{
+  // A linear ramp has the same gradient everywhere, boundaries included.
+  const int dims[3] = { 9, 7, 5 };
+  const double slope[3] = { 3.0, 0.0, 4.0 };
+  const double spacing[3] = { 1.0, 1.0, 1.0 };
+  auto values = rampVolume(dims, slope);
+
+  GradientMagnitude gradient;
+  gradient.build(values.data(), 1, dims, spacing);
+  ASSERT_EQ(gradient.size(), static_cast<int64_t>(values.size()));
+  for (int64_t i = 0; i < gradient.size(); ++i) {
+    EXPECT_NEAR(gradient.value(i), 5.0, 1e-5);
+  }
+  EXPECT_NEAR(gradient.maximum(), 5.0, 1e-5);
+  EXPECT_EQ(gradient.step(), 0.0);
+}
+
+TEST(GradientMagnitudeTest, spacing)
+{
+  // Differences are over the spacing relative to the average spacing.
+  const int dims[3] = { 6, 6, 6 };
+  const double slope[3] = { 2.0, 0.0, 0.0 };
+  const double spacing[3] = { 2.0, 0.5, 0.5 };
+  auto values = rampVolume(dims, slope);
+
+  GradientMagnitude gradient;
+  gradient.build(values.data(), 1, dims, spacing);
+  EXPECT_NEAR(gradient.value(100), 1.0, 1e-5);
+}
+
+TEST(GradientMagnitudeTest, quantized)
+{
+  const int dims[3] = { 20, 18, 16 };
+  std::vector<short> values(2 * 20 * 18 * 16);
+  std::mt19937 generator(3);
+  std::uniform_int_distribution<int> distribution(-1000, 1000);
+  for (auto& value : values) {
+    value = static_cast<short>(distribution(generator));
+  }
+  const double spacing[3] = { 1.0, 1.5, 2.0 };
+
+  GradientMagnitude reference;
+  reference.build(values.data(), 2, dims, spacing);
+  for (auto storage : { GradientMagnitude::Storage::UnsignedShort,
+                        GradientMagnitude::Storage::UnsignedChar }) {
+    GradientMagnitude gradient(storage);
+    gradient.build(values.data(), 2, dims, spacing);
+    EXPECT_EQ(gradient.maximum(), reference.maximum());
+    EXPECT_GT(gradient.step(), 0.0);
+    EXPECT_LT(gradient.memorySize(), reference.memorySize());
+    for (int64_t i = 0; i < gradient.size(); ++i) {
+      EXPECT_NEAR(gradient.value(i), reference.value(i),
+                  0.5 * gradient.step() + 1e-3);
+    }
+  }
+}
+
+TEST(GradientMagnitudeTest, histogram)
+{
+  const int dims[3] = { 16, 16, 16 };
+  const double slope[3] = { 1.0, 0.0, 0.0 };
+  const double spacing[3] = { 1.0, 1.0, 1.0 };
+  auto values = rampVolume(dims, slope);
+  values[8 * 256 + 8 * 16 + 8] = 100.f;
+
+  GradientMagnitude gradient;
+  gradient.build(values.data(), 1, dims, spacing);
+  std::vector<uint64_t> pops(4, 0);
+  gradient.histogram(4.0, 4, pops.data());
+
+  // The spike raises the gradient of its six neighbors past the maximum.
+  uint64_t total = 0;
+  for (auto pop : pops) {
+    total += pop;
+  }
+  EXPECT_EQ(total, 16u * 16 * 16);
+  EXPECT_EQ(pops[3], 6u);
+  EXPECT_EQ(pops[1], 16u * 16 * 16 - 6);
+}
@@ -0,0 +1,185 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <gtest/gtest.h>
+
+#include "ImageShift.h"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+using namespace tomviz;
+
+namespace {
+
+// Value of pixel (x, y) component c of a slice shifted by (dx, dy), pixels
+// shifted in from outside the slice are zero.
+template <typename T>
+T shiftedValue(const std::vector<T>& in, int nx, int ny, int nComps, int x,
+               int y, int c, int dx, int dy)
+{
+  const int sx = x - dx;
+  const int sy = y - dy;
+  if (sx < 0 || sx >= nx || sy < 0 || sy >= ny) {
+    return T(0);
+  }
+  return in[(static_cast<size_t>(sy) * nx + sx) * nComps + c];
+}
+
+// Bilinear sample of component c at (x - dx, y - dy), zero outside.
+double bilinearValue(const std::vector<float>& in, int nx, int ny,
+                     int nComps, int x, int y, int c, double dx, double dy)
+{
+  const double sx = x - dx;
+  const double sy = y - dy;
+  const int x0 = static_cast<int>(std::floor(sx));
+  const int y0 = static_cast<int>(std::floor(sy));
+  const double fx = sx - x0;
+  const double fy = sy - y0;
+  double value = 0;
+  for (int j = 0; j < 2; ++j) {
+    for (int i = 0; i < 2; ++i) {
+      const int px = x0 + i;
+      const int py = y0 + j;
+      if (px < 0 || px >= nx || py < 0 || py >= ny) {
+        continue;
+      }
+      const double w = (i ? fx : 1 - fx) * (j ? fy : 1 - fy);
+      value += w * in[(static_cast<size_t>(py) * nx + px) * nComps + c];
+    }
+  }
+  return value;
+}
+
+std::vector<float> ramp(size_t count)
+{
+  std::vector<float> values(count);
+  for (size_t i = 0; i < count; ++i) {
+    values[i] = static_cast<float>(1 + (i * 7) % 23);
+  }
+  return values;
+}
+} // namespace
+
+TEST(ImageShiftTest, shiftedRange)
+{
+  int begin, end;
+  shiftedRange(10, 3, begin, end);
+  EXPECT_EQ(begin, 3);
+  EXPECT_EQ(end, 10);
+  shiftedRange(10, -4, begin, end);
+  EXPECT_EQ(begin, 0);
+  EXPECT_EQ(end, 6);
+  // Shifted out entirely.
+  shiftedRange(10, 12, begin, end);
+  EXPECT_EQ(begin, end);
+  shiftedRange(10, -12, begin, end);
+  EXPECT_EQ(begin, end);
+}
+
+TEST(ImageShiftTest, integerShift)
+{
+  const int nx = 7, ny = 5;
+  for (int nComps = 1; nComps <= 3; ++nComps) {
+    std::vector<int16_t> in(nx * ny * nComps);
+    for (size_t i = 0; i < in.size(); ++i) {
+      in[i] = static_cast<int16_t>(i + 1);
+    }
+    std::vector<int16_t> out(in.size(), -1);
+    for (int dy = -6; dy <= 6; ++dy) {
+      for (int dx = -8; dx <= 8; ++dx) {
+        shiftSlice(in.data(), out.data(), nx, ny, nComps, dx, dy);
+        for (int y = 0; y < ny; ++y) {
+          for (int x = 0; x < nx; ++x) {
+            for (int c = 0; c < nComps; ++c) {
+              ASSERT_EQ(out[(y * nx + x) * nComps + c],
+                        shiftedValue(in, nx, ny, nComps, x, y, c, dx, dy))
+                << "shift " << dx << ", " << dy;
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(ImageShiftTest, bilinearShift)
+{
+  const int nx = 9, ny = 6;
+  for (int nComps = 1; nComps <= 2; ++nComps) {
+    const auto in = ramp(nx * ny * nComps);
+    std::vector<float> out(in.size());
+    const double shifts[] = { -2.75, -1.5, -0.25, 0.0, 0.4, 1.0, 2.6 };
+    for (double dy : shifts) {
+      for (double dx : shifts) {
+        shiftSliceBilinear(in.data(), out.data(), nx, ny, nComps, dx, dy);
+        for (int y = 0; y < ny; ++y) {
+          for (int x = 0; x < nx; ++x) {
+            for (int c = 0; c < nComps; ++c) {
+              ASSERT_NEAR(out[(y * nx + x) * nComps + c],
+                          bilinearValue(in, nx, ny, nComps, x, y, c, dx, dy),
+                          1e-4)
+                << "shift " << dx << ", " << dy;
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(ImageShiftTest, bilinearIntegral)
+{
+  // Integral types are rounded, integral offsets take the bulk copy path.
+  const int nx = 4, ny = 1;
+  std::vector<uint8_t> in = { 10, 20, 30, 40 };
+  std::vector<uint8_t> out(in.size());
+  shiftSliceBilinear(in.data(), out.data(), nx, ny, 1, 0.5, 0.0);
+  EXPECT_EQ(out[0], 5);
+  EXPECT_EQ(out[1], 15);
+  EXPECT_EQ(out[2], 25);
+  EXPECT_EQ(out[3], 35);
+
+  shiftSliceBilinear(in.data(), out.data(), nx, ny, 1, 2.0, 0.0);
+  EXPECT_EQ(out[0], 0);
+  EXPECT_EQ(out[1], 0);
+  EXPECT_EQ(out[2], 10);
+  EXPECT_EQ(out[3], 20);
+}
+
+TEST(ImageShiftTest, shiftSlices)
+{
+  const int dims[3] = { 8, 6, 11 };
+  const size_t sliceSize = static_cast<size_t>(dims[0]) * dims[1];
+  const auto in = ramp(sliceSize * dims[2]);
+  std::vector<int> offsets;
+  std::vector<double> subPixel;
+  for (int z = 0; z < dims[2]; ++z) {
+    offsets.push_back(z - 5);
+    offsets.push_back(2 - z % 4);
+    subPixel.push_back(0.3 * z - 1.6);
+    subPixel.push_back(z % 3 - 0.5);
+  }
+
+  // Every slice matches shifting it on its own.
+  std::vector<float> out(in.size());
+  std::vector<float> expected(sliceSize);
+  shiftSlices(in.data(), out.data(), dims, 1, offsets.data());
+  for (int z = 0; z < dims[2]; ++z) {
+    shiftSlice(in.data() + z * sliceSize, expected.data(), dims[0], dims[1],
+               1, offsets[2 * z], offsets[2 * z + 1]);
+    for (size_t i = 0; i < sliceSize; ++i) {
+      ASSERT_EQ(out[z * sliceSize + i], expected[i]);
+    }
+  }
+
+  shiftSlicesBilinear(in.data(), out.data(), dims, 1, subPixel.data());
+  for (int z = 0; z < dims[2]; ++z) {
+    shiftSliceBilinear(in.data() + z * sliceSize, expected.data(), dims[0],
+                       dims[1], 1, subPixel[2 * z], subPixel[2 * z + 1]);
+    for (size_t i = 0; i < sliceSize; ++i) {
+      ASSERT_EQ(out[z * sliceSize + i], expected[i]);
+    }
+  }
+}
@@ -0,0 +1,128 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <gtest/gtest.h>
+
+#include "ImageSlice.h"
+#include "TomvizTest.h"
+
+#include <vtkImageData.h>
+#include <vtkIntArray.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+
+using namespace tomviz;
+
+namespace {
+
+// Two components encoding the point index, so every slice is easy to check.
+vtkSmartPointer<vtkImageData> indexImage(int nx, int ny, int nz)
+{
+  auto image = vtkSmartPointer<vtkImageData>::New();
+  image->SetExtent(1, nx, 2, ny + 1, 3, nz + 2);
+  image->SetOrigin(0.5, 1.0, 1.5);
+  image->SetSpacing(1.0, 2.0, 3.0);
+  vtkNew<vtkIntArray> values;
+  values->SetName("values");
+  values->SetNumberOfComponents(2);
+  values->SetNumberOfTuples(static_cast<vtkIdType>(nx) * ny * nz);
+  for (vtkIdType i = 0; i < values->GetNumberOfTuples(); ++i) {
+    values->SetTypedComponent(i, 0, static_cast<int>(i));
+    values->SetTypedComponent(i, 1, static_cast<int>(-i));
+  }
+  image->GetPointData()->SetScalars(values);
+  return image;
+}
+} // namespace
+
+TEST(ImageSliceTest, extract)
+{
+  const int dims[3] = { 7, 5, 4 };
+  auto image = indexImage(dims[0], dims[1], dims[2]);
+  int imageExtent[6];
+  image->GetExtent(imageExtent);
+
+  for (int axis = 0; axis < 3; ++axis) {
+    const int index = dims[axis] / 2;
+    auto slice = ImageSlice::extract(image, axis, index);
+    ASSERT_NE(slice, nullptr);
+    EXPECT_EQ(ImageSlice::isView(slice), axis == 2);
+
+    int extent[6];
+    slice->GetExtent(extent);
+    for (int i = 0; i < 3; ++i) {
+      const int low =
+        i == axis ? imageExtent[2 * i] + index : imageExtent[2 * i];
+      const int high = i == axis ? low : imageExtent[2 * i + 1];
+      EXPECT_EQ(extent[2 * i], low);
+      EXPECT_EQ(extent[2 * i + 1], high);
+    }
+    EXPECT_EQ(slice->GetOrigin()[2], 1.5);
+    EXPECT_EQ(slice->GetSpacing()[1], 2.0);
+
+    auto scalars =
+      vtkIntArray::SafeDownCast(slice->GetPointData()->GetScalars());
+    ASSERT_NE(scalars, nullptr);
+    EXPECT_STREQ(scalars->GetName(), "values");
+    ASSERT_EQ(scalars->GetNumberOfComponents(), 2);
+    for (int z = extent[4]; z <= extent[5]; ++z) {
+      for (int y = extent[2]; y <= extent[3]; ++y) {
+        for (int x = extent[0]; x <= extent[1]; ++x) {
+          int ijk[3] = { x, y, z };
+          const vtkIdType expected = image->ComputePointId(ijk);
+          const vtkIdType i = slice->ComputePointId(ijk);
+          EXPECT_EQ(scalars->GetTypedComponent(i, 0), expected);
+          EXPECT_EQ(scalars->GetTypedComponent(i, 1), -expected);
+        }
+      }
+    }
+  }
+}
+
+TEST(ImageSliceTest, view)
+{
+  auto image = indexImage(8, 8, 8);
+  auto slice = ImageSlice::extract(image, 2, 3);
+  EXPECT_EQ(ImageSlice::memorySize(slice), 0u);
+
+  // The view keeps the image scalars alive after the image is gone.
+  image = nullptr;
+  auto scalars =
+    vtkIntArray::SafeDownCast(slice->GetPointData()->GetScalars());
+  EXPECT_EQ(scalars->GetTypedComponent(0, 0), 3 * 64);
+  EXPECT_EQ(scalars->GetTypedComponent(63, 0), 4 * 64 - 1);
+
+  EXPECT_GT(ImageSlice::memorySize(ImageSlice::extract(slice, 0, 1)), 0u);
+  EXPECT_EQ(ImageSlice::extract(slice, 3, 0), nullptr);
+}
+
+TEST(ImageSliceTest, cache)
+{
+  auto image = indexImage(64, 64, 64);
+  auto first = ImageSlice::extract(image, 0, 0);
+  const size_t size = ImageSlice::memorySize(first);
+
+  ImageSliceCache cache(3 * size);
+  cache.insert(0, 0, first);
+  cache.insert(0, 1, ImageSlice::extract(image, 0, 1));
+  cache.insert(0, 2, ImageSlice::extract(image, 0, 2));
+  EXPECT_EQ(cache.count(), 3);
+  EXPECT_EQ(cache.size(), 3 * size);
+
+  // A hit makes the first slice the most recently used, the second goes.
+  EXPECT_EQ(cache.find(0, 0), first);
+  cache.insert(1, 0, ImageSlice::extract(image, 1, 0));
+  EXPECT_EQ(cache.count(), 3);
+  EXPECT_TRUE(cache.contains(0, 0));
+  EXPECT_FALSE(cache.contains(0, 1));
+  EXPECT_TRUE(cache.contains(1, 0));
+  EXPECT_EQ(cache.find(0, 1), nullptr);
+
+  cache.setMaximumSize(size);
+  EXPECT_EQ(cache.count(), 1);
+  EXPECT_TRUE(cache.contains(1, 0));
+
+  cache.clear();
+  EXPECT_EQ(cache.count(), 0);
+  EXPECT_EQ(cache.size(), 0u);
+}
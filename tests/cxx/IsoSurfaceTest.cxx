@@ -0,0 +1,154 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <gtest/gtest.h>
+
+#include "BrickRangeIndex.h"
+#include "IsoSurface.h"
+#include "TomvizTest.h"
+
+#include <vtkFloatArray.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPolyData.h>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace tomviz;
+
+namespace {
+
+// Distance to the center of the image, the iso surfaces are spheres.
+vtkSmartPointer<vtkImageData> sphereImage(int size)
+{
+  auto image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(size, size, size);
+  vtkNew<vtkFloatArray> distance;
+  distance->SetName("distance");
+  distance->SetNumberOfTuples(static_cast<vtkIdType>(size) * size * size);
+  const double center = (size - 1) / 2.0;
+  vtkIdType i = 0;
+  for (int z = 0; z < size; ++z) {
+    for (int y = 0; y < size; ++y) {
+      for (int x = 0; x < size; ++x, ++i) {
+        distance->SetValue(
+          i, static_cast<float>(std::sqrt((x - center) * (x - center) +
+                                          (y - center) * (y - center) +
+                                          (z - center) * (z - center))));
+      }
+    }
+  }
+  image->GetPointData()->SetScalars(distance.GetPointer());
+  return image;
+}
+} // namespace
+
+TEST(IsoSurfaceTest, previewSampleRate)
+{
+  const int small[3] = { 64, 64, 64 };
+  EXPECT_EQ(IsoSurface::previewSampleRate(small), 1);
+
+  const int large[3] = { 512, 512, 512 };
+  const int rate = IsoSurface::previewSampleRate(large);
+  EXPECT_EQ(rate, 4);
+  EXPECT_EQ(IsoSurface::previewSampleRate(large, 1000), 52);
+
+  const int flat[3] = { 4096, 4096, 1 };
+  EXPECT_EQ(IsoSurface::previewSampleRate(flat), 3);
+}
+
+TEST(IsoSurfaceTest, extract)
+{
+  auto image = sphereImage(48);
+  auto full = IsoSurface::extract(image, "distance", 15.0);
+  ASSERT_NE(full.GetPointer(), nullptr);
+  EXPECT_GT(full->GetNumberOfPolys(), 0);
+  ASSERT_NE(full->GetPointData()->GetNormals(), nullptr);
+  ASSERT_NE(full->GetPointData()->GetScalars(), nullptr);
+
+  double bounds[6];
+  full->GetBounds(bounds);
+  EXPECT_NEAR(bounds[1] - bounds[0], 30.0, 0.5);
+
+  // The preview is the same sphere with fewer triangles.
+  auto preview = IsoSurface::extract(image, "distance", 15.0, 3);
+  EXPECT_GT(preview->GetNumberOfPolys(), 0);
+  EXPECT_LT(preview->GetNumberOfPolys(), full->GetNumberOfPolys());
+  preview->GetBounds(bounds);
+  EXPECT_NEAR(bounds[1] - bounds[0], 30.0, 3.0);
+
+  auto empty = IsoSurface::extract(image, "distance", 100.0);
+  EXPECT_EQ(empty->GetNumberOfPolys(), 0);
+}
+
+TEST(IsoSurfaceTest, brickIndex)
+{
+  auto image = sphereImage(48);
+  BrickRangeIndex index;
+  int dims[3];
+  image->GetDimensions(dims);
+  index.build(image->GetPointData()->GetScalars(), dims);
+
+  // The sphere crosses a row of three bricks and the four bricks around its
+  // middle one, contouring them apart gives the same triangles, joined at
+  // the same points.
+  ASSERT_EQ(index.extentsInRange(10.0, 10.0).size(), 5u);
+  auto full = IsoSurface::extract(image, "distance", 10.0);
+  auto bricks = IsoSurface::extract(image, "distance", 10.0, 1, &index);
+  EXPECT_GT(full->GetNumberOfPolys(), 0);
+  EXPECT_EQ(bricks->GetNumberOfPolys(), full->GetNumberOfPolys());
+  EXPECT_EQ(bricks->GetNumberOfPoints(), full->GetNumberOfPoints());
+  ASSERT_NE(bricks->GetPointData()->GetNormals(), nullptr);
+  double fullBounds[6];
+  double brickBounds[6];
+  full->GetBounds(fullBounds);
+  bricks->GetBounds(brickBounds);
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_NEAR(brickBounds[i], fullBounds[i], 1e-6);
+  }
+
+  auto empty = IsoSurface::extract(image, "distance", 100.0, 1, &index);
+  EXPECT_EQ(empty->GetNumberOfPolys(), 0);
+}
+
+TEST(IsoSurfaceTest, cache)
+{
+  auto image = sphereImage(32);
+  auto a = IsoSurface::extract(image, "distance", 8.0);
+  auto b = IsoSurface::extract(image, "distance", 10.0);
+  auto c = IsoSurface::extract(image, "distance", 12.0);
+  const size_t sizeA = a->GetActualMemorySize() * 1024;
+  const size_t sizeB = b->GetActualMemorySize() * 1024;
+  const size_t sizeC = c->GetActualMemorySize() * 1024;
+
+  IsoSurfaceCache cache(sizeA + sizeB + sizeC);
+  cache.insert(8.0, 1, a);
+  cache.insert(10.0, 1, b);
+  EXPECT_EQ(cache.count(), 2);
+  EXPECT_EQ(cache.size(), sizeA + sizeB);
+  EXPECT_EQ(cache.find(8.0).GetPointer(), a.GetPointer());
+  EXPECT_EQ(cache.find(8.0, 2).GetPointer(), nullptr);
+  EXPECT_EQ(cache.find(9.0).GetPointer(), nullptr);
+
+  // Replacing an entry does not count it twice.
+  cache.insert(10.0, 1, b);
+  EXPECT_EQ(cache.size(), sizeA + sizeB);
+  cache.find(8.0);
+
+  // b is the least recently used surface, so it is evicted first.
+  cache.setMaximumSize(sizeA + sizeC);
+  cache.insert(12.0, 1, c);
+  EXPECT_EQ(cache.find(10.0).GetPointer(), nullptr);
+  EXPECT_EQ(cache.find(8.0).GetPointer(), a.GetPointer());
+  EXPECT_EQ(cache.find(12.0).GetPointer(), c.GetPointer());
+  EXPECT_LE(cache.size(), cache.maximumSize());
+
+  // Surfaces larger than the cache are not kept.
+  cache.setMaximumSize(std::min(sizeA, sizeC) - 1);
+  EXPECT_EQ(cache.count(), 0);
+  cache.insert(8.0, 1, a);
+  EXPECT_EQ(cache.count(), 0);
+  EXPECT_EQ(cache.size(), 0u);
+}
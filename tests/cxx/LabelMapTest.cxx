@@ -0,0 +1,44 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <gtest/gtest.h>
+
+#include "LabelMap.h"
+#include "TomvizTest.h"
+
+#include <vtkFloatArray.h>
+#include <vtkNew.h>
+#include <vtkType.h>
+
+using namespace tomviz;
+
+class LabelMapTest : public ::testing::Test
+{
+};
+
+TEST_F(LabelMapTest, smallestType)
+{
+  ASSERT_EQ(LabelMap::smallestType(0), VTK_UNSIGNED_CHAR);
+  ASSERT_EQ(LabelMap::smallestType(255), VTK_UNSIGNED_CHAR);
+  ASSERT_EQ(LabelMap::smallestType(256), VTK_UNSIGNED_SHORT);
+  ASSERT_EQ(LabelMap::smallestType(70000), VTK_UNSIGNED_INT);
+}
+
+TEST_F(LabelMapTest, compact)
+{
+  vtkNew<vtkFloatArray> labels;
+  labels->SetName("labels");
+  labels->SetNumberOfTuples(1000);
+  for (vtkIdType i = 0; i < 1000; ++i) {
+    labels->SetValue(i, static_cast<float>(i % 300));
+  }
+  auto compacted = LabelMap::compact(labels.GetPointer());
+  ASSERT_TRUE(compacted != nullptr);
+  ASSERT_EQ(compacted->GetDataType(), VTK_UNSIGNED_SHORT);
+  ASSERT_STREQ(compacted->GetName(), "labels");
+  ASSERT_EQ(compacted->GetComponent(299, 0), 299.0);
+
+  // Fractional values are not labels.
+  labels->SetValue(10, 0.5f);
+  ASSERT_TRUE(LabelMap::compact(labels.GetPointer()) == nullptr);
+}
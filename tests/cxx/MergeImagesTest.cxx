@@ -0,0 +1,135 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <gtest/gtest.h>
+
+#include "MergeImages.h"
+
+#include <vtkDoubleArray.h>
+#include <vtkFloatArray.h>
+#include <vtkImageData.h>
+#include <vtkIntArray.h>
+#include <vtkPointData.h>
+#include <vtkUnsignedCharArray.h>
+#include <vtkUnsignedShortArray.h>
+
+using namespace tomviz;
+
+namespace {
+
+const int Size = 32;
+
+// An image whose array holds value + index of the tuple in each component.
+template <typename Array>
+vtkSmartPointer<vtkImageData> image(const char* name, int components,
+                                    int value)
+{
+  auto image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(Size, Size, Size);
+  auto array = vtkSmartPointer<Array>::New();
+  array->SetName(name);
+  array->SetNumberOfComponents(components);
+  array->SetNumberOfTuples(Size * Size * Size);
+  for (vtkIdType t = 0; t < array->GetNumberOfTuples(); ++t) {
+    for (int c = 0; c < components; ++c) {
+      array->SetTypedComponent(t, c, (value + t + c) % 200);
+    }
+  }
+  image->GetPointData()->SetScalars(array);
+  return image;
+}
+} // namespace
+
+TEST(MergeImagesTest, validate)
+{
+  auto a = image<vtkUnsignedCharArray>("a", 1, 0);
+  auto b = image<vtkUnsignedCharArray>("b", 1, 0);
+  EXPECT_TRUE(MergeImages::validate({ a, b }).isEmpty());
+  EXPECT_FALSE(MergeImages::validate({ a }).isEmpty());
+
+  b->SetSpacing(1, 1, 2);
+  EXPECT_FALSE(MergeImages::validate({ a, b }).isEmpty());
+  EXPECT_FALSE(MergeImages::mergeComponents({ a, b }));
+
+  b->SetSpacing(1, 1, 1);
+  b->SetExtent(1, Size, 0, Size - 1, 0, Size - 1);
+  EXPECT_FALSE(MergeImages::validate({ a, b }).isEmpty());
+  EXPECT_FALSE(MergeImages::appendArrays({ a, b }));
+}
+
+TEST(MergeImagesTest, appendArrays)
+{
+  auto a = image<vtkFloatArray>("scalars", 1, 0);
+  auto b = image<vtkUnsignedShortArray>("scalars", 2, 10);
+  a->SetOrigin(1, 2, 3);
+  auto merged = MergeImages::appendArrays({ a, b });
+  ASSERT_NE(merged.Get(), nullptr);
+  EXPECT_EQ(merged->GetOrigin()[2], 3);
+
+  auto pointData = merged->GetPointData();
+  ASSERT_EQ(pointData->GetNumberOfArrays(), 2);
+  EXPECT_STREQ(pointData->GetArrayName(0), "scalars");
+  EXPECT_STREQ(pointData->GetArrayName(1), "scalars_input_1");
+  EXPECT_STREQ(pointData->GetScalars()->GetName(), "scalars");
+
+  // The buffers are shared and the inputs keep their names.
+  auto inB = b->GetPointData()->GetScalars();
+  EXPECT_EQ(pointData->GetArray(1)->GetVoidPointer(0),
+            inB->GetVoidPointer(0));
+  EXPECT_EQ(pointData->GetArray(1)->GetNumberOfComponents(), 2);
+  EXPECT_STREQ(inB->GetName(), "scalars");
+}
+
+TEST(MergeImagesTest, mergeComponents)
+{
+  auto a = image<vtkUnsignedCharArray>("a", 1, 0);
+  auto b = image<vtkUnsignedCharArray>("b", 2, 50);
+  auto c = image<vtkUnsignedCharArray>("c", 1, 100);
+  auto merged = MergeImages::mergeComponents({ a, b, c });
+  ASSERT_NE(merged.Get(), nullptr);
+
+  auto array = merged->GetPointData()->GetScalars();
+  ASSERT_NE(array, nullptr);
+  EXPECT_STREQ(array->GetName(), "Merged");
+  EXPECT_EQ(array->GetDataType(), VTK_UNSIGNED_CHAR);
+  ASSERT_EQ(array->GetNumberOfComponents(), 4);
+  ASSERT_EQ(array->GetNumberOfTuples(), Size * Size * Size);
+
+  auto inA = a->GetPointData()->GetScalars();
+  auto inB = b->GetPointData()->GetScalars();
+  auto inC = c->GetPointData()->GetScalars();
+  for (vtkIdType t = 0; t < array->GetNumberOfTuples(); ++t) {
+    ASSERT_EQ(array->GetComponent(t, 0), inA->GetComponent(t, 0));
+    ASSERT_EQ(array->GetComponent(t, 1), inB->GetComponent(t, 0));
+    ASSERT_EQ(array->GetComponent(t, 2), inB->GetComponent(t, 1));
+    ASSERT_EQ(array->GetComponent(t, 3), inC->GetComponent(t, 0));
+  }
+}
+
+TEST(MergeImagesTest, mergedType)
+{
+  auto uchar = image<vtkUnsignedCharArray>("a", 1, 0);
+  auto ushort = image<vtkUnsignedShortArray>("b", 1, 0);
+  auto integer = image<vtkIntArray>("c", 1, 0);
+  auto real = image<vtkDoubleArray>("d", 1, 0);
+  auto array = [](vtkImageData* image) {
+    return image->GetPointData()->GetScalars();
+  };
+
+  EXPECT_EQ(MergeImages::mergedType({ array(uchar), array(uchar) }),
+            VTK_UNSIGNED_CHAR);
+  EXPECT_EQ(MergeImages::mergedType({ array(uchar), array(ushort) }),
+            VTK_FLOAT);
+  EXPECT_EQ(MergeImages::mergedType({ array(uchar), array(integer) }),
+            VTK_DOUBLE);
+  EXPECT_EQ(MergeImages::mergedType({ array(ushort), array(real) }),
+            VTK_DOUBLE);
+
+  // Values are converted to the merged type.
+  auto merged = MergeImages::mergeComponents({ uchar, real });
+  ASSERT_NE(merged.Get(), nullptr);
+  auto output = merged->GetPointData()->GetScalars();
+  EXPECT_EQ(output->GetDataType(), VTK_DOUBLE);
+  EXPECT_EQ(output->GetComponent(7, 0), 7);
+  EXPECT_EQ(output->GetComponent(7, 1), 7);
+}
@@ -0,0 +1,345 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <gtest/gtest.h>
+
+#include "NeighborhoodFilters.h"
+#include "TomvizTest.h"
+#include "operators/GaussianFilterOperator.h"
+#include "operators/MedianFilterOperator.h"
+#include "operators/OperatorPython.h"
+#include "operators/UnsharpMaskOperator.h"
+
+#include <vtkFloatArray.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkUnsignedShortArray.h>
+
+#include <QFile>
+#include <QJsonObject>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace tomviz;
+
+namespace {
+
+// Index of voxel (x, y, z) with each coordinate reflected into the volume.
+int64_t reflected(const int dims[3], int x, int y, int z)
+{
+  using NeighborhoodFilters::reflect;
+  return (static_cast<int64_t>(reflect(z, dims[2])) * dims[1] +
+          reflect(y, dims[1])) *
+           dims[0] +
+         reflect(x, dims[0]);
+}
+
+// One full pass per axis, as scipy's gaussian_filter does.
+std::vector<double> referenceGaussian(const std::vector<float>& input,
+                                      const int dims[3],
+                                      const double sigma[3])
+{
+  std::vector<double> values(input.begin(), input.end());
+  std::vector<double> next(values.size());
+  for (int axis = 0; axis < 3; ++axis) {
+    const auto kernel = NeighborhoodFilters::gaussianKernel(sigma[axis]);
+    const int radius = static_cast<int>(kernel.size()) / 2;
+    for (int z = 0; z < dims[2]; ++z) {
+      for (int y = 0; y < dims[1]; ++y) {
+        for (int x = 0; x < dims[0]; ++x) {
+          double sum = 0.0;
+          for (int k = 0; k < static_cast<int>(kernel.size()); ++k) {
+            int p[3] = { x, y, z };
+            p[axis] += k - radius;
+            sum += kernel[k] * values[reflected(dims, p[0], p[1], p[2])];
+          }
+          next[reflected(dims, x, y, z)] = sum;
+        }
+      }
+    }
+    values.swap(next);
+  }
+  return values;
+}
+
+template <typename T>
+std::vector<T> referenceMedian(const std::vector<T>& input, const int dims[3],
+                               int size)
+{
+  const int lo = size / 2;
+  const int hi = size - 1 - lo;
+  std::vector<T> output(input.size());
+  for (int z = 0; z < dims[2]; ++z) {
+    for (int y = 0; y < dims[1]; ++y) {
+      for (int x = 0; x < dims[0]; ++x) {
+        std::vector<T> window;
+        for (int dz = -lo; dz <= hi; ++dz) {
+          for (int dy = -lo; dy <= hi; ++dy) {
+            for (int dx = -lo; dx <= hi; ++dx) {
+              window.push_back(input[reflected(dims, x + dx, y + dy, z + dz)]);
+            }
+          }
+        }
+        std::sort(window.begin(), window.end());
+        output[reflected(dims, x, y, z)] = window[window.size() / 2];
+      }
+    }
+  }
+  return output;
+}
+
+std::vector<float> randomVolume(const int dims[3], float range)
+{
+  std::mt19937 generator(7);
+  std::uniform_real_distribution<float> distribution(0.0f, range);
+  std::vector<float> values(static_cast<size_t>(dims[0]) * dims[1] * dims[2]);
+  for (auto& value : values) {
+    value = distribution(generator);
+  }
+  return values;
+}
+
+vtkSmartPointer<vtkImageData> randomImage(int size)
+{
+  const int dims[3] = { size, size, size };
+  auto values = randomVolume(dims, 1000.0f);
+  auto image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(size, size, size);
+  vtkNew<vtkFloatArray> array;
+  array->SetName("values");
+  array->SetNumberOfTuples(values.size());
+  std::copy(values.begin(), values.end(), array->GetPointer(0));
+  image->GetPointData()->SetScalars(array);
+  return image;
+}
+
+QString readScript(const QString& name)
+{
+  QFile file(QString("%1/../../tomviz/python/%2").arg(SOURCE_DIR).arg(name));
+  if (!file.open(QIODevice::ReadOnly)) {
+    return QString();
+  }
+  return QString(file.readAll());
+}
+} // namespace
+
+TEST(NeighborhoodFiltersTest, kernel)
+{
+  auto kernel = NeighborhoodFilters::gaussianKernel(2.0);
+  ASSERT_EQ(kernel.size(), 17u);
+  double sum = 0.0;
+  for (auto weight : kernel) {
+    sum += weight;
+  }
+  EXPECT_NEAR(sum, 1.0, 1e-12);
+  EXPECT_DOUBLE_EQ(kernel[7], kernel[9]);
+  EXPECT_EQ(NeighborhoodFilters::gaussianKernel(0.0).size(), 1u);
+
+  EXPECT_EQ(NeighborhoodFilters::reflect(-1, 4), 0);
+  EXPECT_EQ(NeighborhoodFilters::reflect(-3, 4), 2);
+  EXPECT_EQ(NeighborhoodFilters::reflect(4, 4), 3);
+  EXPECT_EQ(NeighborhoodFilters::reflect(9, 4), 1);
+}
+
+TEST(NeighborhoodFiltersTest, gaussian)
+{
+  // Enough slices for several chunks, and a z kernel wider than a chunk.
+  const int dims[3] = { 13, 11, 37 };
+  const auto input = randomVolume(dims, 100.0f);
+  for (const double sigma : { 1.0, 6.0 }) {
+    const double sigmas[3] = { 1.5, 0.7, sigma };
+    const auto expected = referenceGaussian(input, dims, sigmas);
+    auto values = input;
+    ASSERT_TRUE(NeighborhoodFilters::gaussian(values.data(), dims, sigmas));
+    for (size_t i = 0; i < values.size(); ++i) {
+      ASSERT_NEAR(values[i], expected[i], 1e-3);
+    }
+  }
+}
+
+TEST(NeighborhoodFiltersTest, unsharpMask)
+{
+  const int dims[3] = { 12, 9, 21 };
+  const auto input = randomVolume(dims, 100.0f);
+  const double sigma[3] = { 1.0, 1.0, 2.0 };
+  const double amount = 0.5;
+  const double threshold = 3.0;
+  const auto blurred = referenceGaussian(input, dims, sigma);
+  auto values = input;
+  ASSERT_TRUE(NeighborhoodFilters::unsharpMask(values.data(), dims, sigma,
+                                               amount, threshold));
+  for (size_t i = 0; i < values.size(); ++i) {
+    const double difference = input[i] - blurred[i];
+    double expected = input[i];
+    if (difference > threshold) {
+      expected += (difference - threshold) * amount;
+    } else if (-difference > threshold) {
+      expected += (difference + threshold) * amount;
+    }
+    ASSERT_NEAR(values[i], expected, 1e-3);
+  }
+}
+
+TEST(NeighborhoodFiltersTest, median)
+{
+  const int dims[3] = { 14, 9, 7 };
+  std::mt19937 generator(3);
+  for (const int size : { 2, 3 }) {
+    const int sizes[3] = { size, size, size };
+
+    // The histogram, 8 and 16 bit.
+    std::vector<uint8_t> bytes(dims[0] * dims[1] * dims[2]);
+    for (auto& value : bytes) {
+      value = static_cast<uint8_t>(generator() % 256);
+    }
+    auto expectedBytes = referenceMedian(bytes, dims, size);
+    ASSERT_TRUE(NeighborhoodFilters::median(bytes.data(), dims, sizes));
+    EXPECT_EQ(bytes, expectedBytes);
+
+    std::vector<int16_t> shorts(bytes.size());
+    for (auto& value : shorts) {
+      value = static_cast<int16_t>(static_cast<int>(generator() % 65536) -
+                                   32768);
+    }
+    auto expectedShorts = referenceMedian(shorts, dims, size);
+    ASSERT_TRUE(NeighborhoodFilters::median(shorts.data(), dims, sizes));
+    EXPECT_EQ(shorts, expectedShorts);
+
+    // And selection.
+    auto floats = randomVolume(dims, 1.0f);
+    auto expectedFloats = referenceMedian(floats, dims, size);
+    ASSERT_TRUE(NeighborhoodFilters::median(floats.data(), dims, sizes));
+    EXPECT_EQ(floats, expectedFloats);
+  }
+}
+
+TEST(NeighborhoodFiltersTest, operators)
+{
+  GaussianFilterOperator gaussian;
+  const double sigma[3] = { 1.0, 2.0, 0.0 };
+  gaussian.setSigma(sigma);
+  GaussianFilterOperator gaussianCopy;
+  ASSERT_TRUE(gaussianCopy.deserialize(gaussian.serialize()));
+  EXPECT_DOUBLE_EQ(gaussianCopy.sigma()[1], 2.0);
+  EXPECT_DOUBLE_EQ(gaussianCopy.sigma()[2], 0.0);
+
+  MedianFilterOperator median;
+  median.setSize(3);
+  MedianFilterOperator medianCopy;
+  ASSERT_TRUE(medianCopy.deserialize(median.serialize()));
+  EXPECT_EQ(medianCopy.size(), 3);
+
+  UnsharpMaskOperator unsharp;
+  unsharp.setAmount(1.5);
+  unsharp.setThreshold(2.0);
+  unsharp.setSigma(0.5);
+  UnsharpMaskOperator unsharpCopy;
+  ASSERT_TRUE(unsharpCopy.deserialize(unsharp.serialize()));
+  EXPECT_DOUBLE_EQ(unsharpCopy.amount(), 1.5);
+  EXPECT_DOUBLE_EQ(unsharpCopy.threshold(), 2.0);
+  EXPECT_DOUBLE_EQ(unsharpCopy.sigma(), 0.5);
+
+  // A constant volume is left alone by all three.
+  auto image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(6, 5, 4);
+  vtkNew<vtkUnsignedShortArray> array;
+  array->SetNumberOfTuples(6 * 5 * 4);
+  array->FillComponent(0, 1234);
+  image->GetPointData()->SetScalars(array);
+  ASSERT_EQ(gaussian.transform(image), TransformResult::Complete);
+  ASSERT_EQ(median.transform(image), TransformResult::Complete);
+  ASSERT_EQ(unsharp.transform(image), TransformResult::Complete);
+  auto range = image->GetPointData()->GetScalars()->GetRange();
+  EXPECT_DOUBLE_EQ(range[0], 1234.0);
+  EXPECT_DOUBLE_EQ(range[1], 1234.0);
+
+  // All three can be applied to every array, as the Python versions could.
+  EXPECT_TRUE(gaussian.supportsAllArrays());
+  EXPECT_TRUE(median.supportsAllArrays());
+  EXPECT_TRUE(unsharp.supportsAllArrays());
+}
+
+TEST(NeighborhoodFiltersTest, components)
+{
+  // Each component of a multi-component volume is filtered as a volume of
+  // its own.
+  const int dims[3] = { 12, 10, 8 };
+  auto first = randomVolume(dims, 100.0f);
+  auto second = first;
+  std::reverse(second.begin(), second.end());
+
+  auto image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(dims[0], dims[1], dims[2]);
+  vtkNew<vtkFloatArray> array;
+  array->SetNumberOfComponents(2);
+  array->SetNumberOfTuples(first.size());
+  for (size_t i = 0; i < first.size(); ++i) {
+    array->SetTypedComponent(i, 0, first[i]);
+    array->SetTypedComponent(i, 1, second[i]);
+  }
+  image->GetPointData()->SetScalars(array);
+
+  GaussianFilterOperator gaussian;
+  const double sigma[3] = { 1.0, 1.5, 0.5 };
+  gaussian.setSigma(sigma);
+  ASSERT_EQ(gaussian.transform(image), TransformResult::Complete);
+  MedianFilterOperator median;
+  median.setSize(3);
+  ASSERT_EQ(median.transform(image), TransformResult::Complete);
+
+  const int sizes[3] = { 3, 3, 3 };
+  for (auto values : { &first, &second }) {
+    ASSERT_TRUE(NeighborhoodFilters::gaussian(values->data(), dims, sigma));
+    ASSERT_TRUE(NeighborhoodFilters::median(values->data(), dims, sizes));
+  }
+  auto filtered =
+    vtkFloatArray::SafeDownCast(image->GetPointData()->GetScalars());
+  ASSERT_EQ(filtered->GetNumberOfComponents(), 2);
+  for (size_t i = 0; i < first.size(); ++i) {
+    ASSERT_EQ(filtered->GetTypedComponent(i, 0), first[i]);
+    ASSERT_EQ(filtered->GetTypedComponent(i, 1), second[i]);
+  }
+}
+
+TEST(NeighborhoodFiltersTest, DISABLED_benchmark)
+{
+  // The scipy and ITK timings need the PYTHONPATH of the OperatorPython test.
+  const int size = 256;
+  const QString scripts[] = { "GaussianFilter.py", "MedianFilter.py",
+                              "UnsharpMask.py" };
+  for (const auto& script : scripts) {
+    auto image = randomImage(size);
+    OperatorPython python;
+    python.setLabel(script);
+    python.setScript(readScript(script));
+    auto start = std::chrono::steady_clock::now();
+    auto result = python.transform(image);
+    std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+    if (result == TransformResult::Complete) {
+      std::cout << "python " << script.toStdString() << ": "
+                << elapsed.count() << " s" << std::endl;
+    }
+  }
+
+  auto time = [](const char* name, Operator& op) {
+    auto image = randomImage(size);
+    auto start = std::chrono::steady_clock::now();
+    ASSERT_EQ(op.transform(image), TransformResult::Complete);
+    std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+    std::cout << name << ": " << elapsed.count() << " s" << std::endl;
+  };
+  GaussianFilterOperator gaussian;
+  time("gaussian", gaussian);
+  MedianFilterOperator median;
+  time("median", median);
+  UnsharpMaskOperator unsharp;
+  time("unsharp mask", unsharp);
+}
@@ -0,0 +1,278 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <gtest/gtest.h>
+
+#include "NpyFormat.h"
+
+#include <vtkDataArray.h>
+#include <vtkFloatArray.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+
+#include <QFile>
+#include <QTemporaryDir>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+using namespace tomviz;
+
+namespace {
+
+// A version 1.0 file as NumPy writes it, values given in file order.
+template <typename T>
+bool writeArray(const QString& fileName, const QString& descr, bool fortran,
+                const QString& shape, std::vector<T> values,
+                bool bigEndian = false)
+{
+  QString dictionary =
+    QString("{'descr': '%1', 'fortran_order': %2, 'shape': %3, }")
+      .arg(descr)
+      .arg(fortran ? "True" : "False")
+      .arg(shape);
+  while ((10 + dictionary.size() + 1) % 64 != 0) {
+    dictionary += ' ';
+  }
+  dictionary += '\n';
+  QByteArray bytes("\x93NUMPY\x01\x00", 8);
+  bytes.append(static_cast<char>(dictionary.size() & 0xff));
+  bytes.append(static_cast<char>(dictionary.size() >> 8));
+  bytes.append(dictionary.toLatin1());
+  for (auto value : values) {
+    auto begin = reinterpret_cast<const char*>(&value);
+    QByteArray item(begin, sizeof(T));
+    if (bigEndian) {
+      std::reverse(item.begin(), item.end());
+    }
+    bytes.append(item);
+  }
+  QFile file(fileName);
+  return file.open(QIODevice::WriteOnly) && file.write(bytes) == bytes.size();
+}
+
+double valueAt(vtkImageData* image, int x, int y, int z)
+{
+  int dims[3];
+  image->GetDimensions(dims);
+  return image->GetPointData()->GetScalars()->GetTuple1(
+    (static_cast<vtkIdType>(z) * dims[1] + y) * dims[0] + x);
+}
+} // namespace
+
+TEST(NpyFormatTest, cOrder)
+{
+  // Shape (4, 3, 2), value 100x + 10y + z, stored with z fastest.
+  QTemporaryDir dir;
+  std::vector<float> values;
+  for (int x = 0; x < 4; ++x) {
+    for (int y = 0; y < 3; ++y) {
+      for (int z = 0; z < 2; ++z) {
+        values.push_back(100.0f * x + 10.0f * y + z);
+      }
+    }
+  }
+  const QString fileName = dir.filePath("c.npy");
+  ASSERT_TRUE(writeArray(fileName, "<f4", false, "(4, 3, 2)", values));
+
+  NpyFormat format;
+  vtkNew<vtkImageData> image;
+  ASSERT_TRUE(format.read(fileName, image));
+  int dims[3];
+  image->GetDimensions(dims);
+  EXPECT_EQ(dims[0], 4);
+  EXPECT_EQ(dims[1], 3);
+  EXPECT_EQ(dims[2], 2);
+  EXPECT_EQ(image->GetPointData()->GetScalars()->GetDataType(), VTK_FLOAT);
+  for (int z = 0; z < 2; ++z) {
+    for (int y = 0; y < 3; ++y) {
+      for (int x = 0; x < 4; ++x) {
+        EXPECT_EQ(valueAt(image, x, y, z), 100.0 * x + 10.0 * y + z);
+      }
+    }
+  }
+}
+
+TEST(NpyFormatTest, fortranOrder)
+{
+  // Big endian data is swapped, native data is mapped.
+  QTemporaryDir dir;
+  std::vector<uint16_t> values;
+  for (uint16_t i = 0; i < 60; ++i) {
+    values.push_back(1000 + i);
+  }
+  const QString bigName = dir.filePath("big.npy");
+  ASSERT_TRUE(writeArray(bigName, ">u2", true, "(5, 4, 3)", values, true));
+  const QString nativeName = dir.filePath("native.npy");
+  ASSERT_TRUE(writeArray(nativeName, "<u2", true, "(5, 4, 3)", values));
+
+  NpyFormat format;
+  for (const auto& fileName : { bigName, nativeName }) {
+    vtkNew<vtkImageData> image;
+    ASSERT_TRUE(format.read(fileName, image));
+    auto scalars = image->GetPointData()->GetScalars();
+    ASSERT_EQ(scalars->GetDataType(), VTK_UNSIGNED_SHORT);
+    ASSERT_EQ(scalars->GetNumberOfTuples(), 60);
+    for (vtkIdType i = 0; i < 60; ++i) {
+      EXPECT_EQ(scalars->GetTuple1(i), 1000.0 + i);
+    }
+  }
+
+  // Changing the mapped values leaves the file as it was.
+  {
+    vtkNew<vtkImageData> image;
+    ASSERT_TRUE(format.read(nativeName, image));
+    image->GetPointData()->GetScalars()->SetTuple1(0, 7.0);
+    EXPECT_EQ(valueAt(image, 0, 0, 0), 7.0);
+  }
+  vtkNew<vtkImageData> image;
+  ASSERT_TRUE(format.read(nativeName, image));
+  EXPECT_EQ(valueAt(image, 0, 0, 0), 1000.0);
+}
+
+TEST(NpyFormatTest, roundTrip)
+{
+  QTemporaryDir dir;
+  vtkNew<vtkImageData> image;
+  image->SetDimensions(7, 6, 5);
+  vtkNew<vtkFloatArray> array;
+  array->SetNumberOfTuples(7 * 6 * 5);
+  for (vtkIdType i = 0; i < array->GetNumberOfTuples(); ++i) {
+    array->SetValue(i, 0.5f * i);
+  }
+  image->GetPointData()->SetScalars(array);
+
+  NpyFormat format;
+  const QString fileName = dir.filePath("round.npy");
+  ASSERT_TRUE(format.write(fileName, image));
+
+  // The header is padded to a multiple of 64 bytes.
+  QFile file(fileName);
+  ASSERT_TRUE(file.open(QIODevice::ReadOnly));
+  EXPECT_EQ((file.size() - 7 * 6 * 5 * 4) % 64, 0);
+  file.close();
+
+  vtkNew<vtkImageData> read;
+  ASSERT_TRUE(format.read(fileName, read));
+  int dims[3];
+  read->GetDimensions(dims);
+  EXPECT_EQ(dims[0], 7);
+  EXPECT_EQ(dims[2], 5);
+  for (int z = 0; z < 5; ++z) {
+    for (int y = 0; y < 6; ++y) {
+      for (int x = 0; x < 7; ++x) {
+        EXPECT_EQ(valueAt(read, x, y, z), valueAt(image, x, y, z));
+      }
+    }
+  }
+}
+
+TEST(NpyFormatTest, components)
+{
+  // Components are the last axis, so each is written as a volume of its own,
+  // and read back into tuples.
+  QTemporaryDir dir;
+  vtkNew<vtkImageData> image;
+  image->SetDimensions(4, 3, 2);
+  vtkNew<vtkFloatArray> array;
+  array->SetNumberOfComponents(3);
+  array->SetNumberOfTuples(4 * 3 * 2);
+  for (vtkIdType i = 0; i < array->GetNumberOfTuples(); ++i) {
+    for (int c = 0; c < 3; ++c) {
+      array->SetTypedComponent(i, c, 100.0f * c + i);
+    }
+  }
+  image->GetPointData()->SetScalars(array);
+
+  NpyFormat format;
+  const QString fileName = dir.filePath("components.npy");
+  ASSERT_TRUE(format.write(fileName, image));
+
+  QFile file(fileName);
+  ASSERT_TRUE(file.open(QIODevice::ReadOnly));
+  const QByteArray bytes = file.readAll();
+  const int headerSize = bytes.size() - 4 * 3 * 2 * 3 * 4;
+  EXPECT_EQ(headerSize % 64, 0);
+  EXPECT_TRUE(bytes.left(headerSize).contains("'shape': (4, 3, 2, 3)"));
+  auto values = reinterpret_cast<const float*>(bytes.data() + headerSize);
+  for (int c = 0; c < 3; ++c) {
+    for (int i = 0; i < 4 * 3 * 2; ++i) {
+      EXPECT_EQ(values[c * 4 * 3 * 2 + i], 100.0f * c + i);
+    }
+  }
+
+  vtkNew<vtkImageData> read;
+  ASSERT_TRUE(format.read(fileName, read));
+  int dims[3];
+  read->GetDimensions(dims);
+  EXPECT_EQ(dims[0], 4);
+  EXPECT_EQ(dims[1], 3);
+  EXPECT_EQ(dims[2], 2);
+  auto scalars = read->GetPointData()->GetScalars();
+  ASSERT_EQ(scalars->GetNumberOfComponents(), 3);
+  ASSERT_EQ(scalars->GetNumberOfTuples(), 4 * 3 * 2);
+  for (vtkIdType i = 0; i < 4 * 3 * 2; ++i) {
+    for (int c = 0; c < 3; ++c) {
+      EXPECT_EQ(scalars->GetComponent(i, c), array->GetComponent(i, c));
+    }
+  }
+}
+
+TEST(NpyFormatTest, cOrderComponents)
+{
+  // Shape (4, 3, 2, 2), value 100x + 10y + z + 0.5c, stored with the
+  // components fastest.
+  QTemporaryDir dir;
+  std::vector<float> values;
+  for (int x = 0; x < 4; ++x) {
+    for (int y = 0; y < 3; ++y) {
+      for (int z = 0; z < 2; ++z) {
+        for (int c = 0; c < 2; ++c) {
+          values.push_back(100.0f * x + 10.0f * y + z + 0.5f * c);
+        }
+      }
+    }
+  }
+  const QString fileName = dir.filePath("c.npy");
+  ASSERT_TRUE(writeArray(fileName, "<f4", false, "(4, 3, 2, 2)", values));
+
+  NpyFormat format;
+  vtkNew<vtkImageData> image;
+  ASSERT_TRUE(format.read(fileName, image));
+  auto scalars = image->GetPointData()->GetScalars();
+  ASSERT_EQ(scalars->GetNumberOfComponents(), 2);
+  for (int z = 0; z < 2; ++z) {
+    for (int y = 0; y < 3; ++y) {
+      for (int x = 0; x < 4; ++x) {
+        const vtkIdType i = (z * 3 + y) * 4 + x;
+        for (int c = 0; c < 2; ++c) {
+          EXPECT_EQ(scalars->GetComponent(i, c),
+                    100.0 * x + 10.0 * y + z + 0.5 * c);
+        }
+      }
+    }
+  }
+}
+
+TEST(NpyFormatTest, invalid)
+{
+  QTemporaryDir dir;
+  NpyFormat format;
+  vtkNew<vtkImageData> image;
+
+  // Complex numbers, five dimensions and a truncated file are rejected.
+  const QString complexName = dir.filePath("complex.npy");
+  ASSERT_TRUE(writeArray(complexName, "<c8", false, "(2, 2)",
+                         std::vector<uint64_t>(4, 0)));
+  EXPECT_FALSE(format.read(complexName, image));
+  const QString fiveName = dir.filePath("five.npy");
+  ASSERT_TRUE(writeArray(fiveName, "|u1", false, "(2, 2, 2, 2, 2)",
+                         std::vector<uint8_t>(32, 0)));
+  EXPECT_FALSE(format.read(fiveName, image));
+  const QString shortName = dir.filePath("short.npy");
+  ASSERT_TRUE(writeArray(shortName, "<f8", false, "(10,)",
+                         std::vector<double>(3, 0.0)));
+  EXPECT_FALSE(format.read(shortName, image));
+}
@@ -0,0 +1,222 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <gtest/gtest.h>
+
+#include "pvextensions/vtkOMETiffReader.h"
+
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+
+#include <QTemporaryDir>
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "vtk_tiff.h"
+}
+
+using namespace tomviz;
+
+namespace {
+
+struct Layout
+{
+  int width;
+  int height;
+  int pages;
+  int samples;
+  // Tile size, or zero for strips of rowsPerStrip rows.
+  int tileSize;
+  int rowsPerStrip;
+  bool topLeft;
+};
+
+// Sample s of pixel (x, y) of a page, counting rows as the file stores them.
+int value(int x, int y, int page, int sample)
+{
+  return x + 3 * y + 7 * page + 11 * sample;
+}
+
+template <typename T>
+bool writeVolume(const std::string& fileName, const Layout& layout)
+{
+  TIFF* tiff = TIFFOpen(fileName.c_str(), "w");
+  if (!tiff) {
+    return false;
+  }
+  const std::string description =
+    "<?xml version=\"1.0\"?><OME><Image><Pixels DimensionOrder=\"XYZCT\" "
+    "SizeX=\"" + std::to_string(layout.width) + "\" SizeY=\"" +
+    std::to_string(layout.height) + "\" SizeZ=\"" +
+    std::to_string(layout.pages) + "\" SizeC=\"1\" SizeT=\"1\"/>"
+    "</Image></OME>";
+  for (int page = 0; page < layout.pages; ++page) {
+    TIFFSetField(tiff, TIFFTAG_IMAGEWIDTH, layout.width);
+    TIFFSetField(tiff, TIFFTAG_IMAGELENGTH, layout.height);
+    TIFFSetField(tiff, TIFFTAG_BITSPERSAMPLE, 8 * sizeof(T));
+    TIFFSetField(tiff, TIFFTAG_SAMPLESPERPIXEL, layout.samples);
+    TIFFSetField(tiff, TIFFTAG_PHOTOMETRIC, layout.samples == 3
+                                              ? PHOTOMETRIC_RGB
+                                              : PHOTOMETRIC_MINISBLACK);
+    TIFFSetField(tiff, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
+    TIFFSetField(tiff, TIFFTAG_COMPRESSION, COMPRESSION_LZW);
+    if (layout.topLeft) {
+      TIFFSetField(tiff, TIFFTAG_ORIENTATION, ORIENTATION_TOPLEFT);
+    }
+    if (page == 0) {
+      TIFFSetField(tiff, TIFFTAG_IMAGEDESCRIPTION, description.c_str());
+    }
+
+    std::vector<T> values(static_cast<size_t>(layout.width) * layout.height *
+                          layout.samples);
+    for (int y = 0; y < layout.height; ++y) {
+      for (int x = 0; x < layout.width; ++x) {
+        for (int s = 0; s < layout.samples; ++s) {
+          values[(y * layout.width + x) * layout.samples + s] =
+            static_cast<T>(value(x, y, page, s));
+        }
+      }
+    }
+
+    if (layout.tileSize > 0) {
+      const int tile = layout.tileSize;
+      TIFFSetField(tiff, TIFFTAG_TILEWIDTH, tile);
+      TIFFSetField(tiff, TIFFTAG_TILELENGTH, tile);
+      std::vector<T> tileValues(static_cast<size_t>(tile) * tile *
+                                layout.samples);
+      for (int y0 = 0; y0 < layout.height; y0 += tile) {
+        for (int x0 = 0; x0 < layout.width; x0 += tile) {
+          std::fill(tileValues.begin(), tileValues.end(), T(0));
+          for (int y = y0; y < std::min(y0 + tile, layout.height); ++y) {
+            for (int x = x0; x < std::min(x0 + tile, layout.width); ++x) {
+              for (int s = 0; s < layout.samples; ++s) {
+                tileValues[((y - y0) * tile + x - x0) * layout.samples + s] =
+                  values[(y * layout.width + x) * layout.samples + s];
+              }
+            }
+          }
+          if (TIFFWriteTile(tiff, tileValues.data(), x0, y0, 0, 0) < 0) {
+            TIFFClose(tiff);
+            return false;
+          }
+        }
+      }
+    } else {
+      TIFFSetField(tiff, TIFFTAG_ROWSPERSTRIP, layout.rowsPerStrip);
+      for (int y = 0; y < layout.height; ++y) {
+        if (TIFFWriteScanline(
+              tiff, &values[static_cast<size_t>(y) * layout.width *
+                            layout.samples],
+              y, 0) < 0) {
+          TIFFClose(tiff);
+          return false;
+        }
+      }
+    }
+    TIFFWriteDirectory(tiff);
+  }
+  TIFFClose(tiff);
+  return true;
+}
+
+template <typename T>
+void checkVolume(const Layout& layout)
+{
+  QTemporaryDir dir;
+  const std::string fileName =
+    dir.filePath("volume.ome.tif").toLatin1().data();
+  ASSERT_TRUE(writeVolume<T>(fileName, layout));
+
+  vtkNew<vtkOMETiffReader> reader;
+  reader->SetFileName(fileName.c_str());
+  reader->Update();
+  vtkImageData* image = reader->GetOutput();
+  int dims[3];
+  image->GetDimensions(dims);
+  ASSERT_EQ(dims[0], layout.width);
+  ASSERT_EQ(dims[1], layout.height);
+  ASSERT_EQ(dims[2], layout.pages);
+  vtkDataArray* scalars = image->GetPointData()->GetScalars();
+  ASSERT_EQ(scalars->GetNumberOfComponents(), layout.samples);
+
+  // Without an orientation tag, rows are stored bottom to top.
+  const T* values = static_cast<const T*>(scalars->GetVoidPointer(0));
+  for (int z = 0; z < layout.pages; ++z) {
+    for (int y = 0; y < layout.height; ++y) {
+      const int fileRow = layout.topLeft ? y : layout.height - y - 1;
+      for (int x = 0; x < layout.width; ++x) {
+        for (int s = 0; s < layout.samples; ++s) {
+          const size_t index =
+            ((static_cast<size_t>(z) * layout.height + y) * layout.width + x) *
+              layout.samples +
+            s;
+          ASSERT_EQ(values[index], static_cast<T>(value(x, fileRow, z, s)))
+            << "at " << x << ", " << y << ", " << z;
+        }
+      }
+    }
+  }
+}
+} // namespace
+
+TEST(OMETiffReaderTest, strips)
+{
+  checkVolume<uint16_t>({ 40, 27, 9, 1, 0, 5, false });
+  checkVolume<uint16_t>({ 40, 27, 9, 1, 0, 4, true });
+}
+
+TEST(OMETiffReaderTest, tiles)
+{
+  // The image is not a whole number of tiles in either direction.
+  checkVolume<uint16_t>({ 40, 27, 5, 1, 16, 0, false });
+  checkVolume<uint16_t>({ 40, 27, 1, 1, 16, 0, true });
+}
+
+TEST(OMETiffReaderTest, rgb)
+{
+  checkVolume<uint8_t>({ 33, 20, 4, 3, 0, 3, false });
+  checkVolume<uint8_t>({ 33, 20, 4, 3, 16, 0, true });
+}
+
+TEST(OMETiffReaderTest, DISABLED_benchmark)
+{
+  // A 1 GB stack of compressed pages, read back scanline by scanline one
+  // page after the other as the reader used to, then by the reader.
+  const Layout layout = { 2048, 2048, 128, 1, 0, 16, false };
+  QTemporaryDir dir;
+  const std::string fileName =
+    dir.filePath("benchmark.ome.tif").toLatin1().data();
+  ASSERT_TRUE(writeVolume<uint16_t>(fileName, layout));
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<uint16_t> values(static_cast<size_t>(layout.width) *
+                               layout.height * layout.pages);
+  TIFF* tiff = TIFFOpen(fileName.c_str(), "r");
+  ASSERT_NE(tiff, nullptr);
+  for (int page = 0; page < layout.pages; ++page) {
+    for (int y = 0; y < layout.height; ++y) {
+      uint16_t* row =
+        &values[(static_cast<size_t>(page) * layout.height + y) * layout.width];
+      ASSERT_GE(TIFFReadScanline(tiff, row, y, 0), 0);
+    }
+    TIFFReadDirectory(tiff);
+  }
+  TIFFClose(tiff);
+  std::chrono::duration<double> elapsed =
+    std::chrono::steady_clock::now() - start;
+  std::cout << "scanlines: " << elapsed.count() << " s" << std::endl;
+
+  start = std::chrono::steady_clock::now();
+  vtkNew<vtkOMETiffReader> reader;
+  reader->SetFileName(fileName.c_str());
+  reader->Update();
+  elapsed = std::chrono::steady_clock::now() - start;
+  std::cout << "reader: " << elapsed.count() << " s" << std::endl;
+}
@@ -0,0 +1,59 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <gtest/gtest.h>
+
+#include "ParallelFor.h"
+
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace tomviz;
+
+TEST(ParallelForTest, coversRange)
+{
+  std::vector<std::atomic<int>> visits(1000);
+  for (auto& v : visits) {
+    v = 0;
+  }
+  parallelFor(10, 1000, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      ++visits[i];
+    }
+  });
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(visits[i], i < 10 ? 0 : 1);
+  }
+}
+
+TEST(ParallelForTest, nestedCallsRunSerially)
+{
+  // Every inner loop runs on the thread of its outer sub-range, as a single
+  // sub-range, so nesting does not multiply the number of threads.
+  std::mutex mutex;
+  std::set<std::thread::id> threads;
+  std::atomic<int> innerCalls(0);
+  std::atomic<int64_t> sum(0);
+  parallelFor(0, 64, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      const auto outer = std::this_thread::get_id();
+      parallelFor(0, 1000, 1, [&](int64_t b, int64_t e) {
+        EXPECT_EQ(std::this_thread::get_id(), outer);
+        ++innerCalls;
+        sum += e - b;
+      });
+      std::lock_guard<std::mutex> lock(mutex);
+      threads.insert(outer);
+    }
+  });
+  EXPECT_EQ(innerCalls, 64);
+  EXPECT_EQ(sum, 64 * 1000);
+  EXPECT_LE(threads.size(), parallelThreadCount());
+
+  // The calling thread takes part in the loop, later calls from it are
+  // parallel again.
+  EXPECT_FALSE(detail::insideParallelFor());
+}
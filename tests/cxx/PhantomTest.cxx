@@ -0,0 +1,72 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <gtest/gtest.h>
+
+#include "Phantom.h"
+
+#include <vtkImageData.h>
+
+using namespace tomviz;
+
+namespace {
+
+float value(vtkImageData* image, int x, int y, int z)
+{
+  return static_cast<float*>(image->GetScalarPointer(x, y, z))[0];
+}
+} // namespace
+
+TEST(PhantomTest, sheppLogan)
+{
+  auto phantom = Phantom::sheppLogan(64);
+  int dims[3];
+  phantom->GetDimensions(dims);
+  ASSERT_EQ(dims[0], 64);
+  ASSERT_EQ(dims[1], 64);
+  ASSERT_EQ(dims[2], 64);
+
+  double range[2];
+  phantom->GetScalarRange(range);
+  EXPECT_NEAR(range[0], 0.0, 1e-6);
+  EXPECT_NEAR(range[1], 1.0, 1e-6);
+
+  // The skull, the brain inside it, and nothing in the corners.
+  EXPECT_FLOAT_EQ(value(phantom, 32, 32, 32), 0.2f);
+  EXPECT_FLOAT_EQ(value(phantom, 32, 32, 57), 1.0f);
+  EXPECT_FLOAT_EQ(value(phantom, 0, 0, 0), 0.0f);
+}
+
+TEST(PhantomTest, beads)
+{
+  auto phantom = Phantom::beads(64, 10, 7);
+  double range[2];
+  phantom->GetScalarRange(range);
+  EXPECT_FLOAT_EQ(range[0], 0.0);
+  EXPECT_FLOAT_EQ(range[1], 1.0);
+
+  // The same seed places the same beads, at any size, a different one
+  // places them elsewhere.
+  auto same = Phantom::beads(64, 10, 7);
+  auto small = Phantom::beads(32, 10, 7);
+  auto other = Phantom::beads(64, 10, 8);
+  double sum = 0;
+  double smallSum = 0;
+  int different = 0;
+  for (int z = 0; z < 64; ++z) {
+    for (int y = 0; y < 64; ++y) {
+      for (int x = 0; x < 64; ++x) {
+        const float a = value(phantom, x, y, z);
+        ASSERT_EQ(a, value(same, x, y, z));
+        different += a != value(other, x, y, z);
+        sum += a;
+        if (x < 32 && y < 32 && z < 32) {
+          smallSum += 8 * value(small, x, y, z);
+        }
+      }
+    }
+  }
+  EXPECT_GT(sum, 0);
+  EXPECT_NEAR(smallSum / sum, 1.0, 0.15);
+  EXPECT_GT(different, 0);
+}
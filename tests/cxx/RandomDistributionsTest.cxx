@@ -0,0 +1,70 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <gtest/gtest.h>
+
+#include "RandomDistributions.h"
+
+#include <cmath>
+
+using namespace tomviz;
+
+namespace {
+
+void expectPoisson(double mean)
+{
+  std::mt19937 generator(1);
+  const int n = 100000;
+  double sum = 0;
+  double squares = 0;
+  for (int i = 0; i < n; ++i) {
+    const auto k = RandomDistributions::poisson(generator, mean);
+    ASSERT_GE(k, 0);
+    sum += k;
+    squares += static_cast<double>(k) * k;
+  }
+  // Both the mean and the variance are the mean of the distribution.
+  const double m = sum / n;
+  EXPECT_NEAR(m, mean, 5 * std::sqrt(mean / n));
+  EXPECT_NEAR(squares / n - m * m, mean, 0.03 * mean);
+}
+} // namespace
+
+TEST(RandomDistributionsTest, uniform)
+{
+  // The numbers only depend on the output of std::mt19937, which the standard
+  // fixes, so they are the same with every standard library.
+  std::mt19937 generator(7);
+  EXPECT_DOUBLE_EQ(RandomDistributions::uniform(generator),
+                   0.076308289373957172);
+  EXPECT_DOUBLE_EQ(RandomDistributions::uniform(generator),
+                   0.77991879224011462);
+
+  for (int i = 0; i < 10000; ++i) {
+    const double value = RandomDistributions::uniform(generator, -1, 3);
+    ASSERT_GE(value, -1);
+    ASSERT_LT(value, 3);
+  }
+}
+
+TEST(RandomDistributionsTest, logFactorial)
+{
+  for (long long k = 0; k < 200; ++k) {
+    EXPECT_NEAR(RandomDistributions::logFactorial(k), std::lgamma(k + 1.0),
+                1e-9 * (1 + std::lgamma(k + 1.0)));
+  }
+}
+
+TEST(RandomDistributionsTest, poisson)
+{
+  // Small means and larger ones take different paths.
+  expectPoisson(0.5);
+  expectPoisson(4);
+  expectPoisson(10);
+  expectPoisson(250);
+  expectPoisson(1e5);
+
+  std::mt19937 generator(3);
+  EXPECT_EQ(RandomDistributions::poisson(generator, 4), 6);
+  EXPECT_EQ(RandomDistributions::poisson(generator, 4), 1);
+}
@@ -0,0 +1,288 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <gtest/gtest.h>
+
+#include "Resample.h"
+#include "TomvizTest.h"
+#include "operators/BinOperator.h"
+#include "operators/OperatorPython.h"
+#include "operators/ResampleOperator.h"
+
+#include <vtkDoubleArray.h>
+#include <vtkFieldData.h>
+#include <vtkFloatArray.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+
+#include <QFile>
+#include <QVariant>
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+using namespace tomviz;
+
+namespace {
+
+std::vector<float> rampVolume(const int dims[3])
+{
+  std::vector<float> values;
+  for (int z = 0; z < dims[2]; ++z) {
+    for (int y = 0; y < dims[1]; ++y) {
+      for (int x = 0; x < dims[0]; ++x) {
+        values.push_back(static_cast<float>(x + 2 * y + 3 * z));
+      }
+    }
+  }
+  return values;
+}
+
+vtkSmartPointer<vtkImageData> rampImage(int size)
+{
+  const int dims[3] = { size, size, size };
+  auto values = rampVolume(dims);
+  auto image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(size, size, size);
+  vtkNew<vtkFloatArray> array;
+  array->SetName("values");
+  array->SetNumberOfTuples(values.size());
+  std::copy(values.begin(), values.end(), array->GetPointer(0));
+  image->GetPointData()->SetScalars(array);
+  return image;
+}
+
+QString readScript(const QString& name)
+{
+  QFile file(QString("%1/../../tomviz/python/%2").arg(SOURCE_DIR).arg(name));
+  if (!file.open(QIODevice::ReadOnly)) {
+    return QString();
+  }
+  return QString(file.readAll());
+}
+} // namespace
+
+TEST(ResampleTest, kernel)
+{
+  // The end points stay in place.
+  Resample::Kernel kernel(10, 4, Resample::Interpolation::Linear);
+  EXPECT_EQ(kernel.taps, 2);
+  EXPECT_DOUBLE_EQ(kernel.position(0), 0.0);
+  EXPECT_DOUBLE_EQ(kernel.position(1), 3.0);
+  EXPECT_DOUBLE_EQ(kernel.position(3), 9.0);
+
+  // Every output sample has weights summing to one.
+  Resample::Kernel cubic(7, 19, Resample::Interpolation::Cubic);
+  EXPECT_EQ(cubic.taps, 4);
+  for (int i = 0; i < cubic.outSize; ++i) {
+    double sum = 0.0;
+    for (int k = 0; k < cubic.taps; ++k) {
+      sum += cubic.weights[i * cubic.taps + k];
+      EXPECT_GE(cubic.indices[i * cubic.taps + k], 0);
+      EXPECT_LT(cubic.indices[i * cubic.taps + k], 7);
+    }
+    EXPECT_NEAR(sum, 1.0, 1e-12);
+  }
+
+  EXPECT_EQ(Resample::zoomedSize(10, 0.5), 5);
+  EXPECT_EQ(Resample::zoomedSize(3, 0.1), 1);
+  EXPECT_EQ(Resample::binnedSize(11, 2), 5);
+  EXPECT_EQ(Resample::binnedSize(3, 8), 1);
+}
+
+TEST(ResampleTest, linearRamp)
+{
+  // Linear interpolation reproduces a ramp along every axis.
+  const int inDims[3] = { 17, 9, 12 };
+  const int outDims[3] = { 9, 13, 5 };
+  auto input = rampVolume(inDims);
+  std::vector<float> output(outDims[0] * outDims[1] * outDims[2]);
+  ASSERT_TRUE(Resample::resample(input.data(), inDims, 1, outDims,
+                                 Resample::Interpolation::Linear,
+                                 output.data()));
+
+  Resample::Kernel kx(inDims[0], outDims[0], Resample::Interpolation::Linear);
+  Resample::Kernel ky(inDims[1], outDims[1], Resample::Interpolation::Linear);
+  Resample::Kernel kz(inDims[2], outDims[2], Resample::Interpolation::Linear);
+  for (int z = 0; z < outDims[2]; ++z) {
+    for (int y = 0; y < outDims[1]; ++y) {
+      for (int x = 0; x < outDims[0]; ++x) {
+        const double expected =
+          kx.position(x) + 2 * ky.position(y) + 3 * kz.position(z);
+        EXPECT_NEAR(output[(z * outDims[1] + y) * outDims[0] + x], expected,
+                    1e-4);
+      }
+    }
+  }
+}
+
+TEST(ResampleTest, cubic)
+{
+  // Cubic convolution reproduces a ramp away from the clamped boundaries and
+  // hits the input samples exactly.
+  const int inDims[3] = { 16, 1, 1 };
+  const int outDims[3] = { 31, 1, 1 };
+  std::vector<double> input(16);
+  for (int i = 0; i < 16; ++i) {
+    input[i] = 0.5 * i;
+  }
+  std::vector<double> output(31);
+  ASSERT_TRUE(Resample::resample(input.data(), inDims, 1, outDims,
+                                 Resample::Interpolation::Cubic,
+                                 output.data()));
+  for (int i = 0; i < 31; ++i) {
+    if (i % 2 == 0 || (i > 2 && i < 28)) {
+      EXPECT_NEAR(output[i], 0.25 * i, 1e-12);
+    }
+  }
+
+  // The overshoot on either side of a step is clamped to the range of the
+  // type rather than wrapping around. Output sample i sits at i / 3.
+  std::vector<uint8_t> step = { 0, 0, 0, 255, 255, 255 };
+  const int stepDims[3] = { 6, 1, 1 };
+  const int zoomedDims[3] = { 16, 1, 1 };
+  std::vector<uint8_t> zoomed(16);
+  ASSERT_TRUE(Resample::resample(step.data(), stepDims, 1, zoomedDims,
+                                 Resample::Interpolation::Cubic,
+                                 zoomed.data()));
+  for (int i = 0; i < 16; ++i) {
+    if (i <= 6) {
+      EXPECT_EQ(zoomed[i], 0);
+    } else if (i >= 9) {
+      EXPECT_EQ(zoomed[i], 255);
+    }
+  }
+}
+
+TEST(ResampleTest, bin)
+{
+  // Two components, the last x voxel is past the last whole box and dropped.
+  const int inDims[3] = { 5, 4, 2 };
+  std::vector<int16_t> input;
+  for (int i = 0; i < inDims[0] * inDims[1] * inDims[2]; ++i) {
+    input.push_back(static_cast<int16_t>(i));
+    input.push_back(static_cast<int16_t>(-i));
+  }
+  const int factors[3] = { 2, 2, 2 };
+  std::vector<int16_t> output(2 * 2 * 1 * 2);
+  ASSERT_TRUE(Resample::bin(input.data(), inDims, 2, factors, output.data()));
+
+  // The box of output voxel (x, y) starts at input voxel 2x + 10y, the
+  // offsets of its 8 voxels average to 13.
+  for (int y = 0; y < 2; ++y) {
+    for (int x = 0; x < 2; ++x) {
+      const int start = 2 * x + 10 * y;
+      const double average = start + (0 + 1 + 5 + 6 + 20 + 21 + 25 + 26) / 8.0;
+      EXPECT_EQ(output[(y * 2 + x) * 2], std::lround(average));
+      EXPECT_EQ(output[(y * 2 + x) * 2 + 1], std::lround(-average));
+    }
+  }
+}
+
+TEST(ResampleTest, operators)
+{
+  auto image = rampImage(8);
+  image->SetSpacing(1.0, 2.0, 0.5);
+  vtkNew<vtkDoubleArray> angles;
+  angles->SetName("tilt_angles");
+  angles->SetNumberOfTuples(8);
+  for (int i = 0; i < 8; ++i) {
+    angles->SetValue(i, -70.0 + 20.0 * i);
+  }
+  image->GetFieldData()->AddArray(angles);
+
+  BinOperator bin;
+  ASSERT_EQ(bin.transform(image), TransformResult::Complete);
+  int dims[3];
+  image->GetDimensions(dims);
+  EXPECT_EQ(dims[0], 4);
+  EXPECT_EQ(dims[2], 4);
+  EXPECT_DOUBLE_EQ(image->GetSpacing()[1], 4.0);
+  EXPECT_DOUBLE_EQ(image->GetOrigin()[0], 0.5);
+  EXPECT_STREQ(image->GetPointData()->GetScalars()->GetName(), "values");
+  auto binnedAngles = image->GetFieldData()->GetArray("tilt_angles");
+  ASSERT_EQ(binnedAngles->GetNumberOfTuples(), 4);
+  EXPECT_DOUBLE_EQ(binnedAngles->GetTuple1(0), -60.0);
+
+  ResampleOperator resample;
+  const double factors[3] = { 2.0, 1.0, 0.5 };
+  resample.setFactors(factors);
+  ASSERT_EQ(resample.transform(image), TransformResult::Complete);
+  image->GetDimensions(dims);
+  EXPECT_EQ(dims[0], 8);
+  EXPECT_EQ(dims[1], 4);
+  EXPECT_EQ(dims[2], 2);
+  EXPECT_DOUBLE_EQ(image->GetSpacing()[0], 6.0 / 7.0);
+  EXPECT_DOUBLE_EQ(image->GetSpacing()[2], 3.0);
+  auto resampledAngles = image->GetFieldData()->GetArray("tilt_angles");
+  ASSERT_EQ(resampledAngles->GetNumberOfTuples(), 2);
+  EXPECT_DOUBLE_EQ(resampledAngles->GetTuple1(1), 60.0);
+}
+
+TEST(ResampleTest, clone)
+{
+  ResampleOperator resample;
+  const double factors[3] = { 2.0, 1.0, 0.5 };
+  resample.setFactors(factors);
+  resample.setApplyToAllArrays(true);
+  std::unique_ptr<Operator> other(resample.clone());
+  EXPECT_TRUE(other->applyToAllArrays());
+  auto clone = qobject_cast<ResampleOperator*>(other.get());
+  ASSERT_NE(clone, nullptr);
+  EXPECT_DOUBLE_EQ(clone->factors()[2], 0.5);
+}
+
+TEST(ResampleTest, DISABLED_benchmark)
+{
+  // The scipy timings need the PYTHONPATH of the OperatorPython test.
+  const int size = 256;
+  const QString scripts[] = { "BinVolumeByTwo.py", "Resample.py" };
+  for (const auto& script : scripts) {
+    auto image = rampImage(size);
+    OperatorPython python;
+    python.setLabel(script);
+    python.setScript(readScript(script));
+    if (script == "Resample.py") {
+      QMap<QString, QVariant> arguments;
+      arguments["resampling_factor"] = QVariantList({ 0.5, 0.5, 0.5 });
+      python.setArguments(arguments);
+    }
+    auto start = std::chrono::steady_clock::now();
+    auto result = python.transform(image);
+    std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+    if (result == TransformResult::Complete) {
+      std::cout << "scipy " << script.toStdString() << ": "
+                << elapsed.count() << " s" << std::endl;
+    }
+  }
+
+  auto image = rampImage(size);
+  BinOperator bin;
+  auto start = std::chrono::steady_clock::now();
+  ASSERT_EQ(bin.transform(image), TransformResult::Complete);
+  std::chrono::duration<double> elapsed =
+    std::chrono::steady_clock::now() - start;
+  std::cout << "bin x2: " << elapsed.count() << " s" << std::endl;
+
+  for (auto interpolation :
+       { Resample::Interpolation::Linear, Resample::Interpolation::Cubic }) {
+    image = rampImage(size);
+    ResampleOperator resample;
+    const double factors[3] = { 0.5, 0.5, 0.5 };
+    resample.setFactors(factors);
+    resample.setInterpolation(interpolation);
+    start = std::chrono::steady_clock::now();
+    ASSERT_EQ(resample.transform(image), TransformResult::Complete);
+    elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "resample x0.5 "
+              << (interpolation == Resample::Interpolation::Cubic ? "cubic"
+                                                                  : "linear")
+              << ": " << elapsed.count() << " s" << std::endl;
+  }
+}
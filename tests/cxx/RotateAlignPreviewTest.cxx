@@ -0,0 +1,167 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <gtest/gtest.h>
+
+#include "RotateAlignPreview.h"
+#include "TomographyReconstruction.h"
+#include "TomographyTiltSeries.h"
+
+#include <vtkImageData.h>
+#include <vtkNew.h>
+
+#include <QVector>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace tomviz;
+using namespace tomviz::RotateAlignPreview;
+
+namespace {
+
+// A small Gaussian blob off the tilt axis, the same in every slice.
+vtkSmartPointer<vtkImageData> blob(int size)
+{
+  auto image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(4, size, size);
+  image->AllocateScalars(VTK_FLOAT, 1);
+  auto values = static_cast<float*>(image->GetScalarPointer());
+  for (int z = 0; z < size; ++z) {
+    for (int y = 0; y < size; ++y) {
+      const double dy = y + 0.5 - size / 2.0 - size / 6.0;
+      const double dz = z + 0.5 - size / 2.0 + size / 8.0;
+      for (int x = 0; x < 4; ++x) {
+        *values++ = static_cast<float>(std::exp(-(dy * dy + dz * dz) / 4));
+      }
+    }
+  }
+  return image;
+}
+
+std::vector<double> tiltAngles()
+{
+  std::vector<double> angles;
+  for (int angle = -70; angle <= 70; angle += 5) {
+    angles.push_back(angle);
+  }
+  return angles;
+}
+} // namespace
+
+TEST(RotateAlignPreviewTest, sliceShift)
+{
+  // Without an in-plane rotation every slice has the same shift.
+  EXPECT_DOUBLE_EQ(sliceShift(3, 0, 0, 10), 3);
+  EXPECT_DOUBLE_EQ(sliceShift(3, 0, 9, 10), 3);
+
+  // The center slice is never shifted by the rotation, the others are on
+  // opposite sides of it.
+  EXPECT_DOUBLE_EQ(sliceShift(-2, 10, 5, 10), -2);
+  const double below = sliceShift(0, 10, 0, 10);
+  const double above = sliceShift(0, 10, 10, 10);
+  EXPECT_NEAR(below, 5 * std::sin(10 * 3.14159265359 / 180), 1e-9);
+  EXPECT_NEAR(above, -below, 1e-9);
+}
+
+TEST(RotateAlignPreviewTest, reconstructSlice)
+{
+  auto tiltSeries =
+    TomographyTiltSeries::simulateTiltSeries(blob(32), tiltAngles());
+  auto angles = tiltAngles();
+  auto latest = std::make_shared<std::atomic<int>>(3);
+
+  const int rays = 24;
+  Preview preview =
+    reconstructSlice(tiltSeries, angles, 1, 1.5, rays, 3, latest);
+  EXPECT_EQ(preview.generation, 3);
+  EXPECT_EQ(preview.numberOfRays, rays);
+  ASSERT_EQ(preview.image.size(), static_cast<size_t>(rays * rays));
+
+  // The preview is the back projection of the interpolated sinogram.
+  int dims[3];
+  tiltSeries->GetDimensions(dims);
+  std::vector<float> sinogram(rays * dims[2]);
+  std::vector<float> expected(rays * rays);
+  TomographyTiltSeries::getSinogram(tiltSeries, 1, &sinogram[0], rays, 1.5);
+  TomographyReconstruction::unweightedBackProjection2(
+    &sinogram[0], &angles[0], &expected[0], dims[2], rays);
+  for (size_t i = 0; i < expected.size(); ++i) {
+    ASSERT_FLOAT_EQ(preview.image[i], expected[i]) << "at " << i;
+  }
+}
+
+TEST(RotateAlignPreviewTest, supersededRequest)
+{
+  auto tiltSeries =
+    TomographyTiltSeries::simulateTiltSeries(blob(16), tiltAngles());
+  auto latest = std::make_shared<std::atomic<int>>(2);
+
+  // A request that is no longer the latest gives up without reconstructing.
+  Preview preview =
+    reconstructSlice(tiltSeries, tiltAngles(), 0, 0, 16, 1, latest);
+  EXPECT_EQ(preview.generation, -1);
+  EXPECT_EQ(preview.numberOfRays, 0);
+  EXPECT_TRUE(preview.image.empty());
+
+  // Requests in flight on other threads are superseded the same way.
+  QFuture<Preview> future = QtConcurrent::run([=]() {
+    return reconstructSlice(tiltSeries, tiltAngles(), 0, 0, 16, 2, latest);
+  });
+  ++*latest;
+  future.waitForFinished();
+  EXPECT_TRUE(future.result().generation == 2 ||
+              future.result().image.empty());
+}
+
+TEST(RotateAlignPreviewTest, sharpness)
+{
+  const int n = 8;
+  std::vector<float> image(n * n, 0.0f);
+  EXPECT_EQ(sharpness(image, n), 0.0);
+
+  // A flat image scores 1 whatever its value, a single bright pixel n * n,
+  // and spreading the pixel out lowers the score.
+  std::fill(image.begin(), image.end(), -2.0f);
+  EXPECT_NEAR(sharpness(image, n), 1.0, 1e-9);
+  std::fill(image.begin(), image.end(), 0.0f);
+  image[3 * n + 4] = 5.0f;
+  EXPECT_NEAR(sharpness(image, n), n * n, 1e-9);
+  image[3 * n + 5] = 5.0f;
+  EXPECT_NEAR(sharpness(image, n), n * n / 2, 1e-9);
+  image[4 * n + 4] = image[4 * n + 5] = 2.5f;
+  EXPECT_LT(sharpness(image, n), n * n / 2);
+}
+
+TEST(RotateAlignPreviewTest, scoreAxisCandidates)
+{
+  auto tiltSeries =
+    TomographyTiltSeries::simulateTiltSeries(blob(48), tiltAngles());
+
+  ScoreAxisCandidate score;
+  score.imageData = tiltSeries;
+  score.tiltAngles = tiltAngles();
+  score.slices = { { 0, 1, 3 } };
+
+  QVector<AxisCandidate> candidates;
+  for (int shift : { -8, 0, 8 }) {
+    AxisCandidate candidate;
+    candidate.shift = shift;
+    candidates.append(candidate);
+  }
+
+  // Scored in parallel as the automatic search does, with the same results
+  // as scoring each candidate on its own.
+  QVector<double> scores = QtConcurrent::blockingMapped(candidates, score);
+  ASSERT_EQ(scores.size(), candidates.size());
+  for (int i = 0; i < candidates.size(); ++i) {
+    EXPECT_DOUBLE_EQ(scores[i], score(candidates[i]));
+  }
+
+  // The tilt series was simulated about its center, so the centered axis is
+  // sharper than axes shifted off it, which smear the blob into arcs.
+  EXPECT_GT(scores[1], 1.5 * scores[0]);
+  EXPECT_GT(scores[1], 1.5 * scores[2]);
+}
@@ -0,0 +1,147 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <gtest/gtest.h>
+
+#include "SlabGenerator.h"
+
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkPointData.h>
+
+#include <atomic>
+
+using namespace tomviz;
+
+namespace {
+
+// Each value is the index of its slice.
+SlabGenerator::Generate slices(const int shape[3], std::atomic<int>& calls)
+{
+  const int sliceSize = shape[0] * shape[1];
+  return [sliceSize, &calls](int begin, int end, double* values) {
+    ++calls;
+    for (int z = begin; z < end; ++z) {
+      for (int i = 0; i < sliceSize; ++i) {
+        *values++ = z;
+      }
+    }
+    return true;
+  };
+}
+
+double value(vtkImageData* image, int x, int y, int z)
+{
+  return image->GetScalarComponentAsDouble(x, y, z, 0);
+}
+} // namespace
+
+TEST(SlabGeneratorTest, sizes)
+{
+  EXPECT_EQ(SlabGenerator::previewStep(10), 1);
+  EXPECT_EQ(SlabGenerator::previewStep(2048), 64);
+
+  const int small[3] = { 4, 4, 1000 };
+  EXPECT_GE(SlabGenerator::slabSize(small), 1);
+  EXPECT_LE(SlabGenerator::slabSize(small), 1000);
+  // A slice larger than a slab makes a slab of its own.
+  const int large[3] = { 4096, 4096, 10 };
+  EXPECT_EQ(SlabGenerator::slabSize(large), 1);
+}
+
+TEST(SlabGeneratorTest, preview)
+{
+  SlabGenerator::clearCache();
+  const int shape[3] = { 3, 2, 100 };
+  std::atomic<int> calls(0);
+  SlabGenerator generator(shape, "preview", slices(shape, calls));
+
+  auto preview = generator.preview();
+  ASSERT_NE(preview.Get(), nullptr);
+  int dims[3];
+  preview->GetDimensions(dims);
+  EXPECT_EQ(dims[0], 3);
+  EXPECT_EQ(dims[1], 2);
+  EXPECT_EQ(dims[2], 34);
+  EXPECT_EQ(preview->GetSpacing()[2], 3);
+  EXPECT_EQ(value(preview, 2, 1, 0), 0);
+  EXPECT_EQ(value(preview, 2, 1, 33), 99);
+  EXPECT_EQ(calls, 34);
+}
+
+TEST(SlabGeneratorTest, generate)
+{
+  SlabGenerator::clearCache();
+  const int shape[3] = { 3, 2, 100 };
+  std::atomic<int> calls(0);
+  SlabGenerator generator(shape, "generate", slices(shape, calls));
+  generator.start();
+  auto volume = generator.result();
+  ASSERT_NE(volume.Get(), nullptr);
+  int dims[3];
+  volume->GetDimensions(dims);
+  EXPECT_EQ(dims[2], 100);
+  for (int z = 0; z < 100; ++z) {
+    EXPECT_EQ(value(volume, 1, 1, z), z);
+  }
+  EXPECT_STREQ(volume->GetPointData()->GetScalars()->GetName(),
+               "generated_scalars");
+
+  // The same parameters are served from the cache.
+  const int generated = calls;
+  SlabGenerator again(shape, "generate", slices(shape, calls));
+  again.start();
+  volume = again.result();
+  ASSERT_NE(volume.Get(), nullptr);
+  EXPECT_EQ(value(volume, 0, 0, 42), 42);
+  EXPECT_EQ(calls, generated);
+  EXPECT_GT(SlabGenerator::cacheSize(), 0u);
+
+  // Other parameters are not.
+  SlabGenerator other(shape, "other", slices(shape, calls));
+  other.start();
+  EXPECT_NE(other.result().Get(), nullptr);
+  EXPECT_GT(calls, generated);
+
+  // Nor are generators without a key.
+  SlabGenerator::clearCache();
+  SlabGenerator uncached(shape, "", slices(shape, calls));
+  uncached.start();
+  EXPECT_NE(uncached.result().Get(), nullptr);
+  EXPECT_EQ(SlabGenerator::cacheSize(), 0u);
+  const int uncachedCalls = calls;
+  SlabGenerator uncachedAgain(shape, "", slices(shape, calls));
+  uncachedAgain.start();
+  EXPECT_NE(uncachedAgain.result().Get(), nullptr);
+  EXPECT_GT(calls, uncachedCalls);
+
+  SlabGenerator::setMaximumCacheSize(0);
+  EXPECT_EQ(SlabGenerator::cacheSize(), 0u);
+  SlabGenerator::setMaximumCacheSize(1024 * 1024 * 1024);
+}
+
+TEST(SlabGeneratorTest, whole)
+{
+  const int shape[3] = { 3, 2, 100 };
+  std::atomic<int> calls(0);
+  SlabGenerator generator(shape, "", slices(shape, calls), false);
+
+  auto preview = generator.preview();
+  ASSERT_NE(preview.Get(), nullptr);
+  EXPECT_EQ(preview->GetDimensions()[2], 1);
+  EXPECT_EQ(calls, 0);
+
+  generator.start();
+  EXPECT_NE(generator.result().Get(), nullptr);
+  EXPECT_EQ(calls, 1);
+}
+
+TEST(SlabGeneratorTest, failure)
+{
+  const int shape[3] = { 3, 2, 100 };
+  SlabGenerator generator(shape, "failure",
+                          [](int, int, double*) { return false; });
+  EXPECT_EQ(generator.preview().Get(), nullptr);
+  generator.start();
+  EXPECT_EQ(generator.result().Get(), nullptr);
+}
@@ -0,0 +1,71 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <gtest/gtest.h>
+
+#include "StateBundle.h"
+
+#include <vtkFloatArray.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+
+#include <QJsonArray>
+#include <QJsonObject>
+
+using namespace tomviz;
+
+namespace {
+
+vtkSmartPointer<vtkImageData> image(float value)
+{
+  auto image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(4, 4, 4);
+  vtkNew<vtkFloatArray> scalars;
+  scalars->SetName("scalars");
+  scalars->SetNumberOfTuples(64);
+  scalars->FillValue(value);
+  image->GetPointData()->SetScalars(scalars);
+  return image;
+}
+
+QJsonArray operators(double sigma)
+{
+  QJsonObject jOperator;
+  jOperator["type"] = "GaussianBlur";
+  jOperator["sigma"] = sigma;
+  return QJsonArray({ jOperator });
+}
+} // namespace
+
+TEST(StateBundleTest, contentHash)
+{
+  auto data = image(1);
+  const QString hash = StateBundle::contentHash(data);
+  EXPECT_EQ(hash.size(), 40);
+  EXPECT_EQ(StateBundle::contentHash(image(1)), hash);
+
+  // Values, names and shape all change the hash.
+  EXPECT_NE(StateBundle::contentHash(image(2)), hash);
+  data->GetPointData()->GetScalars()->SetName("other");
+  EXPECT_NE(StateBundle::contentHash(data), hash);
+  auto reshaped = image(1);
+  reshaped->SetDimensions(8, 4, 2);
+  EXPECT_NE(StateBundle::contentHash(reshaped), hash);
+}
+
+TEST(StateBundleTest, inputHash)
+{
+  const QString hash = StateBundle::inputHash("data", operators(1));
+  EXPECT_EQ(StateBundle::inputHash("data", operators(1)), hash);
+  EXPECT_NE(StateBundle::inputHash("other", operators(1)), hash);
+  EXPECT_NE(StateBundle::inputHash("data", operators(2)), hash);
+
+  // Neither the branches nor the results are part of the input.
+  auto jOperators = operators(1);
+  auto jOperator = jOperators[0].toObject();
+  jOperator["dataSources"] = QJsonArray({ QJsonObject() });
+  jOperator["cachedResult"] = QJsonObject({ { "inputHash", hash } });
+  jOperators[0] = jOperator;
+  EXPECT_EQ(StateBundle::inputHash("data", jOperators), hash);
+}
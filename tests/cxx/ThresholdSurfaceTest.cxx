@@ -0,0 +1,259 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <gtest/gtest.h>
+
+#include "ThresholdSurface.h"
+#include "TomvizTest.h"
+
+#include <vtkFloatArray.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkThreshold.h>
+#include <vtkUnstructuredGrid.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <set>
+#include <vector>
+
+using namespace tomviz;
+
+namespace {
+
+using Face = std::array<int64_t, 4>;
+
+// Faces of a patch in grid point ids, rotated so the smallest id comes first
+// which keeps the winding.
+std::multiset<Face> faces(const detail::SurfacePatch& patch)
+{
+  std::multiset<Face> result;
+  for (size_t q = 0; q < patch.quads.size(); q += 4) {
+    Face face;
+    for (int j = 0; j < 4; ++j) {
+      face[j] = patch.points[patch.quads[q + j]];
+    }
+    std::rotate(face.begin(), std::min_element(face.begin(), face.end()),
+                face.end());
+    result.insert(face);
+  }
+  return result;
+}
+
+std::vector<float> randomVolume(const int dims[3], unsigned seed)
+{
+  std::mt19937 generator(seed);
+  std::uniform_real_distribution<float> distribution(0.f, 1.f);
+  std::vector<float> values(static_cast<size_t>(dims[0]) * dims[1] * dims[2]);
+  for (auto& value : values) {
+    value = distribution(generator);
+  }
+  return values;
+}
+
+// Count the boundary faces of the selected cells directly.
+int64_t referenceFaceCount(const std::vector<float>& values, const int dims[3],
+                           double minimum, double maximum)
+{
+  const int cx = dims[0] - 1, cy = dims[1] - 1, cz = dims[2] - 1;
+  auto inRange = [&](int x, int y, int z) {
+    const float v = values[(static_cast<size_t>(z) * dims[1] + y) * dims[0] + x];
+    return v >= minimum && v <= maximum;
+  };
+  auto selected = [&](int x, int y, int z) {
+    if (x < 0 || y < 0 || z < 0 || x >= cx || y >= cy || z >= cz) {
+      return false;
+    }
+    for (int k = 0; k < 8; ++k) {
+      if (!inRange(x + (k & 1), y + ((k >> 1) & 1), z + (k >> 2))) {
+        return false;
+      }
+    }
+    return true;
+  };
+  int64_t count = 0;
+  for (int z = 0; z < cz; ++z) {
+    for (int y = 0; y < cy; ++y) {
+      for (int x = 0; x < cx; ++x) {
+        if (selected(x, y, z)) {
+          count += !selected(x - 1, y, z) + !selected(x + 1, y, z) +
+                   !selected(x, y - 1, z) + !selected(x, y + 1, z) +
+                   !selected(x, y, z - 1) + !selected(x, y, z + 1);
+        }
+      }
+    }
+  }
+  return count;
+}
+
+// A ball of low values in the middle of a cube, with some noise.
+vtkSmartPointer<vtkImageData> ballImage(int size)
+{
+  auto image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(size, size, size);
+  vtkNew<vtkFloatArray> scalars;
+  scalars->SetName("scalars");
+  scalars->SetNumberOfTuples(static_cast<vtkIdType>(size) * size * size);
+  std::mt19937 generator(7);
+  std::uniform_real_distribution<float> noise(0.f, 0.05f);
+  float* value = scalars->GetPointer(0);
+  const double center = (size - 1) / 2.0;
+  for (int z = 0; z < size; ++z) {
+    for (int y = 0; y < size; ++y) {
+      for (int x = 0; x < size; ++x) {
+        const double dx = x - center, dy = y - center, dz = z - center;
+        *value++ = static_cast<float>(
+          std::sqrt(dx * dx + dy * dy + dz * dz) / size + noise(generator));
+      }
+    }
+  }
+  image->GetPointData()->SetScalars(scalars.GetPointer());
+  return image;
+}
+
+struct Comparison
+{
+  vtkIdType surfaceCells = 0;
+  vtkIdType gridCells = 0;
+  size_t surfaceBytes = 0;
+  size_t gridBytes = 0;
+  double surfaceSeconds = 0.0;
+  double gridSeconds = 0.0;
+};
+
+// Threshold the ball with ThresholdSurface and with vtkThreshold, measuring
+// the memory of their outputs and the time they take.
+Comparison compareToThreshold(vtkImageData* image, double minimum,
+                              double maximum)
+{
+  Comparison result;
+  auto start = std::chrono::steady_clock::now();
+  ThresholdSurface surface;
+  surface.setInput(image, "scalars");
+  surface.setRange(minimum, maximum);
+  surface.update();
+  std::chrono::duration<double> elapsed =
+    std::chrono::steady_clock::now() - start;
+  result.surfaceSeconds = elapsed.count();
+  result.surfaceCells = surface.numberOfSelectedCells();
+  result.surfaceBytes = surface.memorySize();
+
+  start = std::chrono::steady_clock::now();
+  vtkNew<vtkThreshold> threshold;
+  threshold->SetInputData(image);
+  threshold->SetInputArrayToProcess(0, 0, 0,
+                                    vtkDataObject::FIELD_ASSOCIATION_POINTS,
+                                    "scalars");
+  threshold->ThresholdBetween(minimum, maximum);
+  threshold->AllScalarsOn();
+  threshold->Update();
+  elapsed = std::chrono::steady_clock::now() - start;
+  result.gridSeconds = elapsed.count();
+  result.gridCells = threshold->GetOutput()->GetNumberOfCells();
+  // GetActualMemorySize is in kibibytes.
+  result.gridBytes =
+    static_cast<size_t>(threshold->GetOutput()->GetActualMemorySize()) * 1024;
+  return result;
+}
+} // namespace
+
+class ThresholdSurfaceTest : public ::testing::Test
+{
+};
+
+TEST_F(ThresholdSurfaceTest, singleCell)
+{
+  const int dims[3] = { 2, 2, 2 };
+  std::vector<float> values(8, 1.f);
+  detail::SurfacePatch patch;
+  detail::extractBoundary(values.data(), 1, dims, 0.5, 1.5, 0, 1, patch);
+  ASSERT_EQ(patch.selectedCells, 1);
+  ASSERT_EQ(patch.quads.size(), 24u);
+  // The eight corners are shared by the six faces.
+  ASSERT_EQ(patch.points.size(), 8u);
+
+  values[7] = 2.f;
+  detail::extractBoundary(values.data(), 1, dims, 0.5, 1.5, 0, 1, patch);
+  ASSERT_EQ(patch.selectedCells, 0);
+  ASSERT_TRUE(patch.quads.empty());
+}
+
+TEST_F(ThresholdSurfaceTest, matchesReference)
+{
+  const int dims[3] = { 13, 9, 21 };
+  auto values = randomVolume(dims, 3);
+  detail::SurfacePatch whole;
+  detail::extractBoundary(values.data(), 1, dims, 0.1, 0.95, 0, dims[2],
+                          whole);
+  ASSERT_EQ(static_cast<int64_t>(whole.quads.size() / 4),
+            referenceFaceCount(values, dims, 0.1, 0.95));
+  ASSERT_GT(whole.quads.size(), 0u);
+
+  // Points are not duplicated within a patch.
+  std::set<int64_t> unique(whole.points.begin(), whole.points.end());
+  ASSERT_EQ(unique.size(), whole.points.size());
+
+  // Extracting in slabs gives the same faces.
+  std::multiset<Face> slabFaces;
+  for (int z = 0; z < dims[2] - 1; z += 4) {
+    detail::SurfacePatch slab;
+    detail::extractBoundary(values.data(), 1, dims, 0.1, 0.95, z, z + 4,
+                            slab);
+    auto f = faces(slab);
+    slabFaces.insert(f.begin(), f.end());
+  }
+  ASSERT_TRUE(slabFaces == faces(whole));
+}
+
+TEST_F(ThresholdSurfaceTest, singleSlice)
+{
+  const int dims[3] = { 3, 3, 1 };
+  std::vector<float> values(9, 1.f);
+  values[8] = 0.f;
+  detail::SurfacePatch patch;
+  detail::extractBoundary(values.data(), 1, dims, 0.5, 1.5, 0, 1, patch);
+  ASSERT_EQ(patch.quads.size(), 12u);
+}
+
+TEST_F(ThresholdSurfaceTest, histogram)
+{
+  const int dims[3] = { 4, 4, 4 };
+  std::vector<float> values(64);
+  for (int i = 0; i < 64; ++i) {
+    values[i] = static_cast<float>(i);
+  }
+  std::vector<int64_t> bins(4);
+  detail::planeHistogram(values.data(), 1, dims, 1, 3, 0.0, 64.0, bins);
+  ASSERT_EQ(bins[0], 0);
+  ASSERT_EQ(bins[1], 16);
+  ASSERT_EQ(bins[2], 16);
+  ASSERT_EQ(bins[3], 0);
+}
+
+TEST_F(ThresholdSurfaceTest, comparedToThreshold)
+{
+  // The same cells are selected as by vtkThreshold, in a fraction of the
+  // memory of its unstructured grid.
+  auto image = ballImage(48);
+  auto result = compareToThreshold(image.GetPointer(), 0.0, 0.3);
+  ASSERT_GT(result.gridCells, 0);
+  ASSERT_EQ(result.surfaceCells, result.gridCells);
+  ASSERT_LT(result.surfaceBytes, result.gridBytes / 2);
+}
+
+TEST_F(ThresholdSurfaceTest, DISABLED_benchmark)
+{
+  auto image = ballImage(256);
+  auto result = compareToThreshold(image.GetPointer(), 0.0, 0.4);
+  const double megabyte = 1024.0 * 1024.0;
+  std::cout << result.gridCells << " cells" << std::endl;
+  std::cout << "vtkThreshold: " << result.gridBytes / megabyte << " MB, "
+            << result.gridSeconds << " s" << std::endl;
+  std::cout << "ThresholdSurface: " << result.surfaceBytes / megabyte
+            << " MB, " << result.surfaceSeconds << " s" << std::endl;
+}
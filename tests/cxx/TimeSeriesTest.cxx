@@ -0,0 +1,157 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <gtest/gtest.h>
+
+#include "EmdFormat.h"
+#include "TimeSeries.h"
+#include "TomvizTest.h"
+
+#include <vtkFloatArray.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+
+#include <QTemporaryDir>
+
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <thread>
+
+using namespace tomviz;
+
+namespace {
+
+// A volume whose values are the frame index plus the point index.
+vtkSmartPointer<vtkImageData> frameImage(int size, int frame)
+{
+  auto image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(size, size, size);
+  vtkNew<vtkFloatArray> values;
+  values->SetName("values");
+  values->SetNumberOfTuples(static_cast<vtkIdType>(size) * size * size);
+  for (vtkIdType i = 0; i < values->GetNumberOfTuples(); ++i) {
+    values->SetValue(i, static_cast<float>(frame + i));
+  }
+  image->GetPointData()->SetScalars(values);
+  return image;
+}
+
+QStringList writeFrames(const QTemporaryDir& dir, int size, int count)
+{
+  QStringList fileNames;
+  for (int i = 0; i < count; ++i) {
+    auto fileName = dir.filePath(QString("frame%1.emd").arg(i));
+    EmdFormat emdFile;
+    auto image = frameImage(size, i);
+    EXPECT_TRUE(emdFile.write(fileName.toLatin1().data(), image));
+    fileNames << fileName;
+  }
+  return fileNames;
+}
+} // namespace
+
+TEST(TimeSeriesTest, frameCache)
+{
+  auto first = frameImage(32, 0);
+  const size_t size = static_cast<size_t>(first->GetActualMemorySize()) * 1024;
+
+  TimeSeriesFrameCache cache(3 * size);
+  cache.insert(0, first);
+  cache.insert(1, frameImage(32, 1));
+  cache.insert(2, frameImage(32, 2));
+  EXPECT_EQ(cache.count(), 3);
+  EXPECT_EQ(cache.size(), 3 * size);
+
+  // A hit makes the first frame the most recently used, the second goes.
+  EXPECT_EQ(cache.find(0), first);
+  cache.insert(3, frameImage(32, 3));
+  EXPECT_EQ(cache.count(), 3);
+  EXPECT_TRUE(cache.contains(0));
+  EXPECT_FALSE(cache.contains(1));
+  EXPECT_EQ(cache.find(1), nullptr);
+
+  cache.setMaximumSize(size);
+  EXPECT_EQ(cache.count(), 1);
+  EXPECT_TRUE(cache.contains(3));
+
+  cache.clear();
+  EXPECT_EQ(cache.count(), 0);
+  EXPECT_EQ(cache.size(), 0u);
+}
+
+TEST(TimeSeriesTest, emdFrames)
+{
+  QTemporaryDir dir;
+  ASSERT_TRUE(dir.isValid());
+  auto fileNames = writeFrames(dir, 8, 3);
+
+  auto frames = TimeSeries::emdFrames(fileNames);
+  ASSERT_EQ(frames.size(), 3);
+  for (int i = 0; i < frames.size(); ++i) {
+    EXPECT_EQ(frames[i].fileName, fileNames[i]);
+    EXPECT_EQ(frames[i].group, QString("/data/tomography"));
+
+    auto image = TimeSeries::readFrame(frames[i]);
+    ASSERT_NE(image, nullptr);
+    EXPECT_EQ(image->GetNumberOfPoints(), 8 * 8 * 8);
+    auto scalars = image->GetPointData()->GetScalars();
+    ASSERT_NE(scalars, nullptr);
+    EXPECT_EQ(scalars->GetTuple1(0), i);
+  }
+
+  TimeSeriesFrame missing = { dir.filePath("missing.emd"), QString() };
+  EXPECT_EQ(TimeSeries::readFrame(missing), nullptr);
+}
+
+TEST(TimeSeriesTest, DISABLED_benchmark)
+{
+  // The frames are written under the temporary directory, point TMPDIR at an
+  // SSD to measure SSD resident playback.
+  QTemporaryDir dir;
+  ASSERT_TRUE(dir.isValid());
+  const int count = 24;
+  for (int size : { 128, 256 }) {
+    auto frames = TimeSeries::emdFrames(writeFrames(dir, size, count));
+    ASSERT_EQ(frames.size(), count);
+
+    // Reading each frame as it is shown.
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& frame : frames) {
+      TimeSeries::readFrame(frame);
+    }
+    std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+    std::cout << size << "^3 read: " << count / elapsed.count() << " fps"
+              << std::endl;
+
+    // Reading the next frame while the current one is shown, as the time
+    // series prefetches, with a frame taking 20 ms to show.
+    TimeSeriesFrameCache cache;
+    start = std::chrono::steady_clock::now();
+    auto next =
+      std::async(std::launch::async, TimeSeries::readFrame, frames[0]);
+    for (int i = 0; i < count; ++i) {
+      cache.insert(i, next.get());
+      if (i + 1 < count) {
+        next = std::async(std::launch::async, TimeSeries::readFrame,
+                          frames[i + 1]);
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << size << "^3 prefetched: " << count / elapsed.count()
+              << " fps" << std::endl;
+
+    // Playing again from the frame cache.
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; ++i) {
+      cache.find(i);
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << size << "^3 cached: " << count / elapsed.count() << " fps"
+              << std::endl;
+  }
+}
@@ -0,0 +1,159 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <gtest/gtest.h>
+
+#include "DataSource.h"
+#include "TomographyTiltSeries.h"
+
+#include <vtkDataArray.h>
+#include <vtkFieldData.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+
+#include <cmath>
+#include <vector>
+
+using namespace tomviz;
+
+namespace {
+
+// A Gaussian blob centered at (cy, cz) of the y-z plane, from voxel centers
+// measured from the center of the volume, the same along x.
+vtkSmartPointer<vtkImageData> blob(const int dims[3], double cy, double cz)
+{
+  auto image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(dims[0], dims[1], dims[2]);
+  image->AllocateScalars(VTK_DOUBLE, 1);
+  auto values = static_cast<double*>(image->GetScalarPointer());
+  for (int z = 0; z < dims[2]; ++z) {
+    for (int y = 0; y < dims[1]; ++y) {
+      const double dy = y + 0.5 - dims[1] / 2.0 - cy;
+      const double dz = z + 0.5 - dims[2] / 2.0 - cz;
+      for (int x = 0; x < dims[0]; ++x) {
+        *values++ = (x + 1) * std::exp(-(dy * dy + dz * dz) / 8);
+      }
+    }
+  }
+  return image;
+}
+
+double tiltSum(vtkImageData* tiltSeries, int tilt, int x)
+{
+  int dims[3];
+  tiltSeries->GetDimensions(dims);
+  double sum = 0;
+  for (int r = 0; r < dims[1]; ++r) {
+    sum += tiltSeries->GetScalarComponentAsDouble(x, r, tilt, 0);
+  }
+  return sum;
+}
+
+int peakRay(vtkImageData* tiltSeries, int tilt)
+{
+  int dims[3];
+  tiltSeries->GetDimensions(dims);
+  int peak = 0;
+  for (int r = 1; r < dims[1]; ++r) {
+    if (tiltSeries->GetScalarComponentAsDouble(0, r, tilt, 0) >
+        tiltSeries->GetScalarComponentAsDouble(0, peak, tilt, 0)) {
+      peak = r;
+    }
+  }
+  return peak;
+}
+} // namespace
+
+TEST(TomographyTiltSeriesTest, simulate)
+{
+  const int dims[3] = { 3, 24, 20 };
+  auto volume = blob(dims, 0, 0);
+  std::vector<double> angles = { -60, -40, -20, 0, 20, 40, 60 };
+  auto tiltSeries = TomographyTiltSeries::simulateTiltSeries(volume, angles);
+
+  // The odd number of rays covering the volume at any angle.
+  int outDims[3];
+  tiltSeries->GetDimensions(outDims);
+  ASSERT_EQ(outDims[0], 3);
+  ASSERT_EQ(outDims[1], 31);
+  ASSERT_EQ(outDims[2], 7);
+  ASSERT_EQ(tiltSeries->GetPointData()->GetScalars()->GetDataType(),
+            VTK_FLOAT);
+
+  auto tiltAngles = DataSource::getTiltAngles(tiltSeries);
+  ASSERT_EQ(tiltAngles.size(), 7);
+  for (int i = 0; i < 7; ++i) {
+    EXPECT_DOUBLE_EQ(tiltAngles[i], angles[i]);
+  }
+  auto type = tiltSeries->GetFieldData()->GetArray("tomviz_data_source_type");
+  ASSERT_NE(type, nullptr);
+  EXPECT_EQ(type->GetTuple1(0), DataSource::TiltSeries);
+
+  // Every ray sum of a slice adds up to the mass of the slice.
+  for (int x = 0; x < dims[0]; ++x) {
+    double mass = 0;
+    for (int z = 0; z < dims[2]; ++z) {
+      for (int y = 0; y < dims[1]; ++y) {
+        mass += volume->GetScalarComponentAsDouble(x, y, z, 0);
+      }
+    }
+    for (int i = 0; i < 7; ++i) {
+      EXPECT_NEAR(tiltSum(tiltSeries, i, x), mass, 1e-3 * mass);
+    }
+  }
+}
+
+TEST(TomographyTiltSeriesTest, geometry)
+{
+  // A blob off center along y is seen there at 0 degrees, and along z at 90
+  // degrees, ray t seeing y cos(angle) + z sin(angle) as back projection
+  // expects.
+  const int dims[3] = { 1, 32, 32 };
+  auto volume = blob(dims, 6, -4);
+  auto tiltSeries =
+    TomographyTiltSeries::simulateTiltSeries(volume, { 0, 90 }, 32);
+  EXPECT_NEAR(peakRay(tiltSeries, 0) + 0.5 - 16, 6, 1);
+  EXPECT_NEAR(peakRay(tiltSeries, 1) + 0.5 - 16, -4, 1);
+}
+
+TEST(TomographyTiltSeriesTest, poissonNoise)
+{
+  const int dims[3] = { 16, 24, 24 };
+  auto volume = blob(dims, 2, 0);
+  std::vector<double> angles;
+  for (int i = 0; i < 10; ++i) {
+    angles.push_back(-45 + 10 * i);
+  }
+  auto tiltSeries = TomographyTiltSeries::simulateTiltSeries(volume, angles);
+
+  auto noisy = [&tiltSeries](unsigned int seed) {
+    auto copy = vtkSmartPointer<vtkImageData>::New();
+    copy->DeepCopy(tiltSeries);
+    TomographyTiltSeries::addPoissonNoise(copy, 1000, seed);
+    return copy;
+  };
+  auto first = noisy(1);
+  auto same = noisy(1);
+  auto other = noisy(2);
+
+  vtkDataArray* clean = tiltSeries->GetPointData()->GetScalars();
+  vtkDataArray* a = first->GetPointData()->GetScalars();
+  vtkDataArray* b = same->GetPointData()->GetScalars();
+  vtkDataArray* c = other->GetPointData()->GetScalars();
+  int changed = 0;
+  int differs = 0;
+  double cleanSum = 0;
+  double noisySum = 0;
+  for (vtkIdType i = 0; i < a->GetNumberOfValues(); ++i) {
+    ASSERT_EQ(a->GetTuple1(i), b->GetTuple1(i));
+    changed += a->GetTuple1(i) != clean->GetTuple1(i);
+    differs += a->GetTuple1(i) != c->GetTuple1(i);
+    cleanSum += clean->GetTuple1(i);
+    noisySum += a->GetTuple1(i);
+  }
+  EXPECT_GT(changed, a->GetNumberOfValues() / 4);
+  EXPECT_GT(differs, a->GetNumberOfValues() / 4);
+  // A thousand counts per pixel on average leave the total within a percent.
+  EXPECT_NEAR(noisySum, cleanSum, 1e-2 * cleanSum);
+}
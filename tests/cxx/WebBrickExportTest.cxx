@@ -0,0 +1,156 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include <gtest/gtest.h>
+
+#include "WebBrickExport.h"
+
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkUnsignedShortArray.h>
+
+#include <QByteArray>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QTemporaryDir>
+
+using namespace tomviz;
+
+namespace {
+
+vtkSmartPointer<vtkImageData> image(int x, int y, int z)
+{
+  auto image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(x, y, z);
+  vtkNew<vtkUnsignedShortArray> scalars;
+  scalars->SetName("values");
+  scalars->SetNumberOfTuples(static_cast<vtkIdType>(x) * y * z);
+  for (vtkIdType i = 0; i < scalars->GetNumberOfTuples(); ++i) {
+    scalars->SetValue(i, static_cast<unsigned short>(i % 65536));
+  }
+  image->GetPointData()->SetScalars(scalars.GetPointer());
+  return image;
+}
+
+QJsonObject manifest(const QString& fileName)
+{
+  QFile file(fileName);
+  file.open(QIODevice::ReadOnly);
+  return QJsonDocument::fromJson(file.readAll()).object();
+}
+} // namespace
+
+TEST(WebBrickExportTest, levelDimensions)
+{
+  int dims[3] = { 200, 65, 1 };
+  auto levels = WebBrickExport::levelDimensions(dims);
+  ASSERT_EQ(levels.size(), 3u);
+  EXPECT_EQ(levels[1][0], 100);
+  EXPECT_EQ(levels[1][1], 32);
+  EXPECT_EQ(levels[1][2], 1);
+  EXPECT_EQ(levels[2][0], 50);
+  EXPECT_EQ(levels[2][1], 16);
+
+  int small[3] = { 64, 64, 64 };
+  EXPECT_EQ(WebBrickExport::levelDimensions(small).size(), 1u);
+}
+
+TEST(WebBrickExportTest, write)
+{
+  QTemporaryDir dir;
+  const QString fileName = dir.filePath("volume.json");
+  const QString bricks = WebBrickExport::bricksDirectory(fileName);
+  EXPECT_EQ(bricks, dir.filePath("volume_bricks"));
+
+  auto volume = image(100, 70, 3);
+  QJsonObject metadata;
+  metadata["name"] = "values";
+  ASSERT_TRUE(WebBrickExport::write(fileName, bricks, volume, metadata));
+
+  auto json = manifest(fileName);
+  EXPECT_EQ(json["name"].toString(), QString("values"));
+  EXPECT_EQ(json["dataType"].toString(), QString("Uint16Array"));
+  EXPECT_EQ(json["brickSize"].toInt(), WebBrickExport::BrickSize);
+
+  // The coarsest level comes first.
+  auto levels = json["levels"].toArray();
+  ASSERT_EQ(levels.size(), 2);
+  auto coarse = levels[0].toObject();
+  EXPECT_EQ(coarse["dimensions"].toArray()[0].toInt(), 50);
+  EXPECT_EQ(coarse["spacing"].toArray()[0].toDouble(), 2);
+  EXPECT_EQ(coarse["bricks"].toArray().size(), 1);
+  auto full = levels[1].toObject();
+  EXPECT_EQ(full["bricks"].toArray().size(), 4);
+
+  // The second brick of the full level starts at x = 64.
+  QFile file(dir.filePath(full["file"].toString()));
+  ASSERT_TRUE(file.open(QIODevice::ReadOnly));
+  auto brick = full["bricks"].toArray()[1].toArray();
+  ASSERT_TRUE(file.seek(static_cast<qint64>(brick[0].toDouble())));
+  QByteArray compressed = file.read(brick[1].toInt());
+  const int size = 36 * 64 * 3 * 2;
+  compressed.prepend(static_cast<char>(size & 0xff));
+  compressed.prepend(static_cast<char>((size >> 8) & 0xff));
+  compressed.prepend(static_cast<char>((size >> 16) & 0xff));
+  compressed.prepend(static_cast<char>((size >> 24) & 0xff));
+  QByteArray values = qUncompress(compressed);
+  ASSERT_EQ(values.size(), size);
+  auto data = reinterpret_cast<const unsigned short*>(values.constData());
+  EXPECT_EQ(data[0], 64);
+  EXPECT_EQ(data[36], 100 + 64);
+  EXPECT_EQ(data[36 * 64], 100 * 70 + 64);
+}
+
+TEST(WebBrickExportTest, cancel)
+{
+  QTemporaryDir dir;
+  const QString fileName = dir.filePath("volume.json");
+  const QString bricks = WebBrickExport::bricksDirectory(fileName);
+
+  auto volume = image(100, 70, 3);
+  EXPECT_FALSE(WebBrickExport::write(fileName, bricks, volume, QJsonObject(),
+                                     [](double) { return false; }));
+  EXPECT_FALSE(QFile::exists(fileName));
+  EXPECT_TRUE(QDir(bricks).entryList(QDir::Files).isEmpty());
+  EXPECT_TRUE(QDir(dir.path()).entryList(QDir::AllEntries | QDir::Hidden |
+                                         QDir::NoDotAndDotDot)
+                .isEmpty());
+}
+
+TEST(WebBrickExportTest, replace)
+{
+  QTemporaryDir dir;
+  const QString fileName = dir.filePath("volume.json");
+  const QString bricks = WebBrickExport::bricksDirectory(fileName);
+  ASSERT_TRUE(WebBrickExport::write(fileName, bricks, image(100, 70, 3),
+                                    QJsonObject()));
+  QFile level(QDir(bricks).filePath("level0.bin"));
+  ASSERT_TRUE(level.open(QIODevice::ReadOnly));
+  const QByteArray levelData = level.readAll();
+  level.close();
+
+  // A canceled export leaves the earlier one, manifest included, as it was.
+  const QJsonObject earlier = manifest(fileName);
+  EXPECT_FALSE(WebBrickExport::write(fileName, bricks, image(30, 20, 2),
+                                     QJsonObject(),
+                                     [](double) { return false; }));
+  ASSERT_TRUE(level.open(QIODevice::ReadOnly));
+  EXPECT_EQ(level.readAll(), levelData);
+  level.close();
+  EXPECT_EQ(manifest(fileName), earlier);
+
+  // A complete one replaces it.
+  ASSERT_TRUE(WebBrickExport::write(fileName, bricks, image(30, 20, 2),
+                                    QJsonObject()));
+  EXPECT_EQ(QDir(bricks).entryList(QDir::Files),
+            QStringList({ "level0.bin" }));
+  ASSERT_TRUE(level.open(QIODevice::ReadOnly));
+  EXPECT_NE(level.readAll(), levelData);
+  EXPECT_EQ(manifest(fileName)["levels"].toArray().size(), 1);
+  EXPECT_EQ(QDir(dir.path()).entryList(QDir::AllEntries | QDir::Hidden |
+                                       QDir::NoDotAndDotDot),
+            QStringList({ "volume.json", "volume_bricks" }));
+}
@@ -0,0 +1,51 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "AddOperatorReaction.h"
+
+#include "ActiveObjects.h"
+#include "DataSource.h"
+#include "EditOperatorDialog.h"
+#include "OperatorFactory.h"
+#include "Utilities.h"
+
+namespace tomviz {
+
+AddOperatorReaction::AddOperatorReaction(QAction* parentObject,
+                                         const QString& operatorType)
+  : pqReaction(parentObject), m_operatorType(operatorType)
+{
+  connect(&ActiveObjects::instance(), SIGNAL(dataSourceChanged(DataSource*)),
+          SLOT(updateEnableState()));
+  updateEnableState();
+}
+
+void AddOperatorReaction::updateEnableState()
+{
+  parentAction()->setEnabled(ActiveObjects::instance().activeDataSource() !=
+                             nullptr);
+}
+
+void AddOperatorReaction::addOperator(DataSource* source)
+{
+  source = source ? source : ActiveObjects::instance().activeParentDataSource();
+  if (!source) {
+    return;
+  }
+
+  Operator* op = OperatorFactory::createOperator(m_operatorType, source);
+  if (!op) {
+    return;
+  }
+
+  if (op->hasCustomUI()) {
+    EditOperatorDialog* dialog =
+      new EditOperatorDialog(op, source, true, tomviz::mainWidget());
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    dialog->show();
+    connect(op, SIGNAL(destroyed()), dialog, SLOT(reject()));
+  } else {
+    source->addOperator(op);
+  }
+}
+} // namespace tomviz
@@ -0,0 +1,34 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizAddOperatorReaction_h
+#define tomvizAddOperatorReaction_h
+
+#include <pqReaction.h>
+
+namespace tomviz {
+class DataSource;
+
+/// Adds a native operator, created through the OperatorFactory, to the active
+/// data source. Operators with a custom UI are shown in an EditOperatorDialog
+/// first.
+class AddOperatorReaction : public pqReaction
+{
+  Q_OBJECT
+
+public:
+  AddOperatorReaction(QAction* parent, const QString& operatorType);
+
+  void addOperator(DataSource* source = nullptr);
+
+protected:
+  void updateEnableState() override;
+  void onTriggered() override { addOperator(); }
+
+private:
+  Q_DISABLE_COPY(AddOperatorReaction)
+  QString m_operatorType;
+};
+} // namespace tomviz
+
+#endif
@@ -5,6 +5,7 @@
 
 #include "ActiveObjects.h"
 #include "DataSource.h"
+#include "ImageShift.h"
 #include "LoadDataReaction.h"
 #include "QVTKGLWidget.h"
 #include "SpinBox.h"
@@ -300,42 +301,43 @@ public:
 
     using T = decltype(in.Get(vtkIdType(), int()));
 
-    for (vtkIdType j = 0; j < m_ySize; ++j) {
-      for (vtkIdType i = 0; i < m_xSize; ++i) {
-        vtkIdType destIdx = j * m_xSize + i;
+    // Work out the columns of each row that overlap the shifted slices once,
+    // so the rows below are plain loops without per-pixel bounds checks.
+    int currBegin, currEnd, refBegin, refEnd;
+    const int xSize = static_cast<int>(m_xSize);
+    shiftedRange(xSize, m_currentSliceOffset[0], currBegin, currEnd);
+    shiftedRange(xSize, m_referenceSliceOffset[0], refBegin, refEnd);
+    const vtkIdType sliceSize = m_xSize * m_ySize;
+
+    parallelFor(0, m_ySize, [&](int64_t begin, int64_t end) {
+      for (vtkIdType j = begin; j < end; ++j) {
+        const vtkIdType destRow = j * m_xSize;
+        for (vtkIdType i = 0; i < m_xSize; ++i) {
+          out.Set(destRow + i, 0, 0);
+        }
 
-        vtkIdType iCurr = i - m_currentSliceOffset[0];
         vtkIdType jCurr = j - m_currentSliceOffset[1];
-        vtkIdType iRef = i - m_referenceSliceOffset[0];
-        vtkIdType jRef = j - m_referenceSliceOffset[1];
-
-        T currentValue = 0;
-        T referenceValue = 0;
-
-        bool currentIsBound =
-          (jCurr < m_ySize && jCurr >= 0 && iCurr < m_xSize && iCurr >= 0);
-
-        bool referenceIsBound =
-          (jRef < m_ySize && jRef >= 0 && iRef < m_xSize && iRef >= 0);
-
-        if (currentIsBound) {
+        if (jCurr >= 0 && jCurr < m_ySize) {
           // Index of the point in the current slice that corresponds to the
-          // given position
-          vtkIdType currentSliceIdx =
-            m_currentSlice * m_ySize * m_xSize + jCurr * m_xSize + iCurr;
-          currentValue = in.Get(currentSliceIdx, 0);
+          // first column of this row
+          vtkIdType src = m_currentSlice * sliceSize + jCurr * m_xSize -
+                          m_currentSliceOffset[0];
+          for (vtkIdType i = currBegin; i < currEnd; ++i) {
+            out.Set(destRow + i, 0, in.Get(src + i, 0));
+          }
         }
 
-        if (referenceIsBound) {
-          // Index in the reference slice that corresponds to the given position
-          vtkIdType referenceSliceIdx =
-            m_referenceSlice * m_ySize * m_xSize + jRef * m_xSize + iRef;
-          referenceValue = in.Get(referenceSliceIdx, 0);
+        vtkIdType jRef = j - m_referenceSliceOffset[1];
+        if (jRef >= 0 && jRef < m_ySize) {
+          vtkIdType src = m_referenceSlice * sliceSize + jRef * m_xSize -
+                          m_referenceSliceOffset[0];
+          for (vtkIdType i = refBegin; i < refEnd; ++i) {
+            T referenceValue = in.Get(src + i, 0);
+            out.Set(destRow + i, 0, out.Get(destRow + i, 0) - referenceValue);
+          }
         }
-
-        out.Set(destIdx, 0, currentValue - referenceValue);
       }
-    }
+    });
   }
 
 private:
@@ -0,0 +1,140 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "BackgroundWriter.h"
+
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkPointData.h>
+
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryFile>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+#include <algorithm>
+
+namespace tomviz {
+
+namespace {
+
+// Writers wait on the disk rather than compute, a pool of their own keeps
+// them from holding up the operators on the global pool.
+Q_GLOBAL_STATIC(QThreadPool, writerPool)
+} // namespace
+
+BackgroundWriter::BackgroundWriter(const QString& fileName,
+                                   vtkImageData* data,
+                                   const WriteFunction& write,
+                                   QObject* parent)
+  : QObject(parent), m_fileName(fileName), m_write(write), m_canceled(false)
+{
+  // Keep the suffix, writers may pick the format by it. The name is made
+  // unique, and reserved, so writers of the same file do not share it.
+  QFileInfo info(fileName);
+  QTemporaryFile partial(QString("%1/.%2.XXXXXX.partial.%3")
+                           .arg(info.absolutePath())
+                           .arg(info.completeBaseName())
+                           .arg(info.suffix()));
+  partial.setAutoRemove(false);
+  if (partial.open()) {
+    m_partialFileName = partial.fileName();
+  } else {
+    m_partialFileName = QString("%1/.%2.partial.%3")
+                          .arg(info.absolutePath())
+                          .arg(info.completeBaseName())
+                          .arg(info.suffix());
+  }
+
+  m_snapshot = vtkSmartPointer<vtkImageData>::New();
+  m_snapshot->ShallowCopy(data);
+  if (auto scalars = m_snapshot->GetPointData()->GetScalars()) {
+    m_size = static_cast<qint64>(scalars->GetNumberOfValues()) *
+             scalars->GetDataTypeSize();
+  }
+
+  connect(&m_watcher, &QFutureWatcherBase::finished, this,
+          &BackgroundWriter::writeFinished);
+}
+
+BackgroundWriter::~BackgroundWriter()
+{
+  if (isRunning()) {
+    cancel();
+    m_watcher.waitForFinished();
+  }
+  // The reserved name of a writer that never ran.
+  if (m_watcher.future().resultCount() == 0) {
+    QFile::remove(m_partialFileName);
+  }
+}
+
+void BackgroundWriter::start()
+{
+  m_canceled = false;
+  m_percent = 0;
+  m_timer.start();
+  m_watcher.setFuture(QtConcurrent::run(writerPool(), [this]() {
+    return run();
+  }));
+}
+
+bool BackgroundWriter::isRunning() const
+{
+  return m_watcher.isRunning();
+}
+
+bool BackgroundWriter::wait()
+{
+  m_watcher.waitForFinished();
+  return m_watcher.future().resultCount() > 0 && m_watcher.result();
+}
+
+void BackgroundWriter::cancel()
+{
+  m_canceled = true;
+}
+
+bool BackgroundWriter::run()
+{
+  auto progress = [this](double fraction) {
+    fraction = std::min(std::max(fraction, 0.0), 1.0);
+    const int percent = static_cast<int>(100 * fraction);
+    if (percent > m_percent) {
+      m_percent = percent;
+      const double seconds = m_timer.elapsed() / 1000.0;
+      emit progressChanged(percent,
+                           seconds > 0.0 ? m_size * fraction / seconds : 0.0);
+    }
+    return !m_canceled;
+  };
+
+  const bool written = m_write(m_partialFileName, m_snapshot, progress);
+  bool success = false;
+  if (written && !m_canceled) {
+    // Another writer of the file may put its own in place in between.
+    for (int attempt = 0; attempt < 3 && !success; ++attempt) {
+      if (QFile::exists(m_fileName)) {
+        QFile::remove(m_fileName);
+      }
+      success = QFile::rename(m_partialFileName, m_fileName);
+    }
+  }
+  if (!success) {
+    QFile::remove(m_partialFileName);
+  }
+  return success;
+}
+
+void BackgroundWriter::writeFinished()
+{
+  const bool success = m_watcher.result();
+  // Release the arrays of the snapshot.
+  m_snapshot = nullptr;
+  emit finished(success);
+  if (m_canceled) {
+    emit canceled();
+  }
+}
+} // namespace tomviz
@@ -0,0 +1,97 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizBackgroundWriter_h
+#define tomvizBackgroundWriter_h
+
+#include <QObject>
+
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <QString>
+
+#include <vtkSmartPointer.h>
+
+#include <atomic>
+#include <functional>
+
+class vtkImageData;
+
+namespace tomviz {
+
+/// Writes an image to a file on a worker thread, so saving a large volume
+/// leaves the application, and the pipelines, running. The writer works on a
+/// snapshot sharing the arrays of the image: data sources and operators
+/// replace arrays rather than writing into them, so the snapshot stays as it
+/// was when the write started. The file is written under a unique temporary
+/// name next to it and renamed once complete, a canceled or failed write
+/// removes it, leaving any previous file of that name in place. Several
+/// writers can run at once, on a pool of their own.
+class BackgroundWriter : public QObject
+{
+  Q_OBJECT
+
+public:
+  /// Called with the fraction written so far, the write stops, failing, when
+  /// it returns false.
+  using Progress = std::function<bool(double fraction)>;
+
+  /// Writes data to fileName, returning false on failure. It runs on a
+  /// worker thread, so it must not touch proxies or widgets.
+  using WriteFunction = std::function<bool(
+    const QString& fileName, vtkImageData* data, const Progress& progress)>;
+
+  BackgroundWriter(const QString& fileName, vtkImageData* data,
+                   const WriteFunction& write, QObject* parent = nullptr);
+  ~BackgroundWriter() override;
+
+  QString fileName() const { return m_fileName; }
+
+  /// The size of the snapshot in bytes.
+  qint64 size() const { return m_size; }
+
+  /// Start the write, returning immediately.
+  void start();
+
+  bool isRunning() const;
+  bool isCanceled() const { return m_canceled; }
+
+  /// Block until the write is done, returning whether it succeeded.
+  bool wait();
+
+public slots:
+  /// Stop the write at the next progress report and remove the partial file.
+  void cancel();
+
+signals:
+  /// Emitted from the worker thread as each percent is written, with the
+  /// average throughput since the start in bytes per second.
+  void progressChanged(int percent, double bytesPerSecond);
+
+  /// Emitted once the write is done, successful or not.
+  void finished(bool success);
+
+  /// Emitted, after finished(), if the write was canceled.
+  void canceled();
+
+private slots:
+  void writeFinished();
+
+private:
+  bool run();
+
+  QString m_fileName;
+  QString m_partialFileName;
+  vtkSmartPointer<vtkImageData> m_snapshot;
+  WriteFunction m_write;
+  qint64 m_size = 0;
+  std::atomic<bool> m_canceled;
+  int m_percent = 0;
+  QElapsedTimer m_timer;
+  QFutureWatcher<bool> m_watcher;
+
+  Q_DISABLE_COPY(BackgroundWriter)
+};
+} // namespace tomviz
+
+#endif
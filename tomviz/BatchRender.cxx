@@ -0,0 +1,348 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "BatchRender.h"
+
+#include "ActiveObjects.h"
+#include "ModuleManager.h"
+#include "ModuleOrthogonalSlice.h"
+
+#include <vtkCamera.h>
+#include <vtkImageData.h>
+#include <vtkImageWriter.h>
+#include <vtkJPEGWriter.h>
+#include <vtkPNGWriter.h>
+#include <vtkSMPropertyHelper.h>
+#include <vtkSMRenderViewProxy.h>
+#include <vtkSmartPointer.h>
+#include <vtkTIFFWriter.h>
+
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+#include <QFuture>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QList>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+namespace tomviz {
+
+namespace BatchRender {
+
+namespace {
+
+bool toInt(const QString& value, const QString& name, int minimum, int& out,
+           QString& error)
+{
+  bool ok = false;
+  int number = value.toInt(&ok);
+  if (!ok || number < minimum) {
+    error = QString("Invalid --%1: %2").arg(name).arg(value);
+    return false;
+  }
+  out = number;
+  return true;
+}
+
+bool writeFrame(vtkImageData* image, const QString& fileName,
+                const QString& format)
+{
+  vtkSmartPointer<vtkImageWriter> writer;
+  if (format == "jpg") {
+    writer = vtkSmartPointer<vtkJPEGWriter>::New();
+  } else if (format == "tif") {
+    writer = vtkSmartPointer<vtkTIFFWriter>::New();
+  } else {
+    writer = vtkSmartPointer<vtkPNGWriter>::New();
+  }
+  writer->SetInputData(image);
+  writer->SetFileName(fileName.toLocal8Bit().data());
+  writer->Write();
+  return writer->GetErrorCode() == 0;
+}
+
+// Load the state file, waiting for its pipelines to finish.
+bool loadState(const QString& fileName)
+{
+  QFile file(fileName);
+  if (!file.open(QIODevice::ReadOnly)) {
+    std::cerr << "Unable to read " << fileName.toStdString() << std::endl;
+    return false;
+  }
+  QJsonParseError error;
+  auto doc = QJsonDocument::fromJson(file.readAll(), &error);
+  if (!doc.isObject()) {
+    std::cerr << "Invalid state file " << fileName.toStdString() << ": "
+              << error.errorString().toStdString() << std::endl;
+    return false;
+  }
+
+  auto& manager = ModuleManager::instance();
+  bool done = false;
+  QEventLoop loop;
+  QObject::connect(&manager, &ModuleManager::stateDoneLoading, &loop,
+                   [&done, &loop]() {
+                     done = true;
+                     loop.quit();
+                   });
+  if (!manager.deserialize(doc.object(), QFileInfo(fileName).dir())) {
+    return false;
+  }
+  if (!done) {
+    loop.exec();
+  }
+  return manager.lastLoadStateSucceeded();
+}
+} // namespace
+
+bool requested(int argc, char** argv)
+{
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], Argument) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool parse(const QStringList& arguments, Options& options, QString& error)
+{
+  QCommandLineParser parser;
+  parser.addOption(QCommandLineOption(QString(Argument).mid(2),
+                                      "State file to render.", "state"));
+  parser.addOption(QCommandLineOption(
+    "output", "Directory the frames are written to.", "directory"));
+  parser.addOption(QCommandLineOption(
+    "path", "How the frames move, orbit or slices.", "path", "orbit"));
+  parser.addOption(
+    QCommandLineOption("frames", "Frames in the movie.", "count", "200"));
+  parser.addOption(QCommandLineOption(
+    "first-frame", "First frame rendered by this process.", "frame"));
+  parser.addOption(QCommandLineOption(
+    "last-frame", "Last frame rendered by this process.", "frame"));
+  parser.addOption(QCommandLineOption(
+    "size", "Size of the frames, WIDTHxHEIGHT.", "size", "1920x1080"));
+  parser.addOption(QCommandLineOption(
+    "format", "Image format of the frames, png, jpg or tif.", "format", "png"));
+  parser.addOption(QCommandLineOption(
+    "encoders", "Threads writing frames, 0 for one per core.", "count", "0"));
+  if (!parser.parse(arguments)) {
+    error = parser.errorText();
+    return false;
+  }
+
+  options.stateFile = parser.value(QString(Argument).mid(2));
+  options.outputDirectory = parser.value("output");
+  if (options.stateFile.isEmpty() || options.outputDirectory.isEmpty()) {
+    error = "A state file and an --output directory are required.";
+    return false;
+  }
+
+  const QString path = parser.value("path");
+  if (path == "orbit") {
+    options.path = Path::Orbit;
+  } else if (path == "slices") {
+    options.path = Path::Slices;
+  } else {
+    error = QString("Invalid --path: %1").arg(path);
+    return false;
+  }
+
+  options.format = parser.value("format").toLower();
+  if (options.format == "jpeg") {
+    options.format = "jpg";
+  } else if (options.format == "tiff") {
+    options.format = "tif";
+  }
+  if (!QStringList({ "png", "jpg", "tif" }).contains(options.format)) {
+    error = QString("Invalid --format: %1").arg(options.format);
+    return false;
+  }
+
+  const QStringList size = parser.value("size").split('x');
+  if (size.size() != 2 ||
+      !toInt(size[0], "size", 1, options.width, error) ||
+      !toInt(size[1], "size", 1, options.height, error)) {
+    error = QString("Invalid --size: %1").arg(parser.value("size"));
+    return false;
+  }
+
+  if (!toInt(parser.value("frames"), "frames", 1, options.frames, error) ||
+      !toInt(parser.value("encoders"), "encoders", 0, options.encoders,
+             error)) {
+    return false;
+  }
+  options.firstFrame = 0;
+  options.lastFrame = options.frames - 1;
+  if (parser.isSet("first-frame") &&
+      !toInt(parser.value("first-frame"), "first-frame", 0,
+             options.firstFrame, error)) {
+    return false;
+  }
+  if (parser.isSet("last-frame") &&
+      !toInt(parser.value("last-frame"), "last-frame", 0, options.lastFrame,
+             error)) {
+    return false;
+  }
+  if (options.firstFrame > options.lastFrame ||
+      options.lastFrame >= options.frames) {
+    error = QString("Invalid frame range %1 to %2 of %3 frames.")
+              .arg(options.firstFrame)
+              .arg(options.lastFrame)
+              .arg(options.frames);
+    return false;
+  }
+  return true;
+}
+
+QString frameFileName(const Options& options, int frame)
+{
+  const int digits = std::max(4, QString::number(options.frames - 1).size());
+  return QDir(options.outputDirectory)
+    .filePath(QString("frame_%1.%2")
+                .arg(frame, digits, 10, QChar('0'))
+                .arg(options.format));
+}
+
+int sweepIndex(int frame, int frames, int count)
+{
+  if (frames < 2 || count < 2) {
+    return 0;
+  }
+  return static_cast<int>(
+    std::lround(static_cast<double>(frame) * (count - 1) / (frames - 1)));
+}
+
+int run(const Options& options)
+{
+  if (!QDir().mkpath(options.outputDirectory)) {
+    std::cerr << "Unable to create " << options.outputDirectory.toStdString()
+              << std::endl;
+    return 1;
+  }
+
+  QElapsedTimer timer;
+  timer.start();
+  if (!loadState(options.stateFile)) {
+    std::cerr << "Unable to load " << options.stateFile.toStdString()
+              << std::endl;
+    return 1;
+  }
+  std::cout << "Loaded " << options.stateFile.toStdString() << " in "
+            << timer.elapsed() / 1000.0 << " s" << std::endl;
+
+  auto view =
+    vtkSMRenderViewProxy::SafeDownCast(ActiveObjects::instance().activeView());
+  if (!view) {
+    std::cerr << "The state has no render view." << std::endl;
+    return 1;
+  }
+  int size[2] = { options.width, options.height };
+  vtkSMPropertyHelper(view, "ViewSize").Set(size, 2);
+  view->UpdateVTKObjects();
+
+  // The event loop does not run between frames, so the work modules leave
+  // to background threads is finished before every capture.
+  const QList<Module*> modules =
+    ModuleManager::instance().findModulesGeneric(view);
+  QList<ModuleOrthogonalSlice*> slices;
+  foreach (Module* module, modules) {
+    if (auto slice = qobject_cast<ModuleOrthogonalSlice*>(module)) {
+      slices << slice;
+    }
+  }
+  if (options.path == Path::Slices && slices.isEmpty()) {
+    std::cerr << "The view shows no orthogonal slices to sweep." << std::endl;
+    return 1;
+  }
+
+  // Every frame of the orbit turns the camera from where the state left it.
+  vtkCamera* camera = view->GetActiveCamera();
+  double position[3];
+  double focalPoint[3];
+  double viewUp[3];
+  camera->GetPosition(position);
+  camera->GetFocalPoint(focalPoint);
+  camera->GetViewUp(viewUp);
+
+  // A couple of frames per encoder are queued at most, so rendering runs
+  // ahead of slow disks by a bounded amount of memory.
+  QThreadPool pool;
+  const int encoders =
+    options.encoders > 0 ? options.encoders : QThread::idealThreadCount();
+  pool.setMaxThreadCount(encoders);
+  QList<QFuture<bool>> pending;
+  bool success = true;
+
+  timer.restart();
+  qint64 renderTime = 0;
+  const int count = options.lastFrame - options.firstFrame + 1;
+  for (int frame = options.firstFrame; frame <= options.lastFrame; ++frame) {
+    QElapsedTimer renderTimer;
+    renderTimer.start();
+    if (options.path == Path::Orbit) {
+      camera->SetPosition(position);
+      camera->SetFocalPoint(focalPoint);
+      camera->SetViewUp(viewUp);
+      camera->Azimuth(360.0 * frame / options.frames);
+      camera->OrthogonalizeViewUp();
+      view->SynchronizeCameraProperties();
+    } else {
+      foreach (ModuleOrthogonalSlice* slice, slices) {
+        slice->showSliceNow(
+          sweepIndex(frame, options.frames, slice->sliceCount()));
+      }
+    }
+    foreach (Module* module, modules) {
+      module->flush();
+    }
+    vtkSmartPointer<vtkImageData> image;
+    image.TakeReference(view->CaptureImage(1));
+    renderTime += renderTimer.elapsed();
+
+    while (pending.size() >= 2 * encoders) {
+      success = pending.takeFirst().result() && success;
+    }
+    const QString fileName = frameFileName(options, frame);
+    const QString format = options.format;
+    pending << QtConcurrent::run(&pool, [image, fileName, format]() {
+      return writeFrame(image, fileName, format);
+    });
+
+    const int rendered = frame - options.firstFrame + 1;
+    if (rendered % 10 == 0 || rendered == count) {
+      std::cout << "Rendered " << rendered << "/" << count << " frames, "
+                << rendered * 1000.0 / std::max<qint64>(timer.elapsed(), 1)
+                << " frames/s" << std::endl;
+    }
+  }
+  while (!pending.isEmpty()) {
+    success = pending.takeFirst().result() && success;
+  }
+
+  const double seconds = std::max<qint64>(timer.elapsed(), 1) / 1000.0;
+  std::cout << "Wrote " << count << " frames in " << seconds << " s, "
+            << count / seconds << " frames/s, rendering took "
+            << static_cast<double>(renderTime) / count << " ms/frame"
+            << std::endl;
+  if (!success) {
+    std::cerr << "Some frames could not be written to "
+              << options.outputDirectory.toStdString() << std::endl;
+    return 1;
+  }
+  return 0;
+}
+} // namespace BatchRender
+} // namespace tomviz
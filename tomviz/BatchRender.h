@@ -0,0 +1,80 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizBatchRender_h
+#define tomvizBatchRender_h
+
+#include <QString>
+#include <QStringList>
+
+namespace tomviz {
+
+/// Rendering of movies from state files without a window, for scripts
+/// rendering many datasets on machines without a display or a GPU:
+///
+///   tomviz --batch-render state.tvsm --output frames --path orbit
+///
+/// The state is loaded offscreen, with its pipelines run or their results
+/// restored, then the frames of the camera path or slice sweep are rendered
+/// by the active view and written as numbered images. The work modules leave
+/// to background threads, such as contour surfaces and reslices, is finished
+/// before each frame is captured. Rendering needs the OpenGL context of the
+/// view and stays on the main thread, frames are encoded and written by a
+/// pool of threads while the next are rendered. The frames of a movie can be
+/// split between processes with --first-frame and --last-frame, each process
+/// loading the state on its own.
+namespace BatchRender {
+
+/// How the frames move through the scene.
+enum class Path
+{
+  /// The camera turns a full circle around its focal point, about its view
+  /// up direction.
+  Orbit,
+  /// The orthogonal slices of the view sweep through the volume, first to
+  /// last slice.
+  Slices
+};
+
+struct Options
+{
+  QString stateFile;
+  /// Directory the frames are written to, as frame_0000.png and so on.
+  QString outputDirectory;
+  /// Image format of the frames, by file extension: png, jpg or tif.
+  QString format = "png";
+  Path path = Path::Orbit;
+  /// Number of frames in the movie.
+  int frames = 200;
+  /// The frames rendered by this process, first to last inclusive.
+  int firstFrame = 0;
+  int lastFrame = -1;
+  int width = 1920;
+  int height = 1080;
+  /// Number of threads writing frames, the ideal thread count if 0.
+  int encoders = 0;
+};
+
+/// The argument asking for a batch render, followed by the state file.
+const char* const Argument = "--batch-render";
+
+/// Whether the command line asks for a batch render.
+bool requested(int argc, char** argv);
+
+/// Parse the options of a batch render from the arguments of the
+/// application. Returns false, with error set, if they are invalid.
+bool parse(const QStringList& arguments, Options& options, QString& error);
+
+/// The file frame is written to.
+QString frameFileName(const Options& options, int frame);
+
+/// The slice, of count, shown in frame of a sweep of frames frames.
+int sweepIndex(int frame, int frames, int count);
+
+/// Load the state and render the frames of options, reporting the frame
+/// rate as it goes. Returns the exit code of the application.
+int run(const Options& options);
+} // namespace BatchRender
+} // namespace tomviz
+
+#endif
@@ -0,0 +1,302 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "BinaryMorphology.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <utility>
+
+namespace {
+
+using tomviz::BinaryMorphology::BitVolume;
+using tomviz::parallelFor;
+
+// out |= in shifted by k voxels along x, out[x] |= in[x - k]. Bits shifted
+// past the end of the row land in the padding and must be masked off.
+void orShifted(const uint64_t* in, uint64_t* out, int words, int k)
+{
+  const int q = std::abs(k) / 64;
+  const int s = std::abs(k) % 64;
+  if (k >= 0) {
+    for (int w = q; w < words; ++w) {
+      uint64_t bits = in[w - q] << s;
+      if (s && w - q > 0) {
+        bits |= in[w - q - 1] >> (64 - s);
+      }
+      out[w] |= bits;
+    }
+  } else {
+    for (int w = 0; w + q < words; ++w) {
+      uint64_t bits = in[w + q] >> s;
+      if (s && w + q + 1 < words) {
+        bits |= in[w + q + 1] << (64 - s);
+      }
+      out[w] |= bits;
+    }
+  }
+}
+
+// Dilate a row along x by a line of the given radius. A line of radius a
+// dilated by the three points {-s, 0, s} is a line of radius a + s as long as
+// s <= 2a + 1, so the radius can be grown by doubling.
+void dilateRow(const uint64_t* in, uint64_t* out, uint64_t* scratch, int words,
+               int radius, uint64_t lastWordMask)
+{
+  std::copy(in, in + words, out);
+  for (int a = 0; a < radius;) {
+    const int s = std::min(2 * a + 1, radius - a);
+    std::copy(out, out + words, scratch);
+    orShifted(scratch, out, words, s);
+    orShifted(scratch, out, words, -s);
+    out[words - 1] &= lastWordMask;
+    a += s;
+  }
+}
+
+void dilateX(const BitVolume& input, BitVolume& output, int radius)
+{
+  const int words = input.wordsPerRow();
+  parallelFor(0, input.numberOfRows(), [&](int64_t begin, int64_t end) {
+    std::vector<uint64_t> scratch(words);
+    for (int64_t r = begin; r < end; ++r) {
+      dilateRow(input.row(r), output.row(r), scratch.data(), words, radius,
+                input.lastWordMask());
+    }
+  });
+}
+
+// Dilate volume in place by a line of the given radius along y (axis 1) or z
+// (axis 2), by doubling as in dilateRow.
+bool dilateLines(BitVolume& volume, BitVolume& scratch, int axis, int radius,
+                 const std::function<bool()>& canceled)
+{
+  const int* dims = volume.dimensions();
+  const int words = volume.wordsPerRow();
+  for (int a = 0; a < radius;) {
+    if (canceled && canceled()) {
+      return false;
+    }
+    const int s = std::min(2 * a + 1, radius - a);
+    parallelFor(0, dims[2], 1, [&](int64_t begin, int64_t end) {
+      for (int z = static_cast<int>(begin); z < end; ++z) {
+        for (int y = 0; y < dims[1]; ++y) {
+          const uint64_t* center = volume.row(y, z);
+          const uint64_t* lower = nullptr;
+          const uint64_t* upper = nullptr;
+          const int i = axis == 1 ? y : z;
+          if (i - s >= 0) {
+            lower = axis == 1 ? volume.row(y - s, z) : volume.row(y, z - s);
+          }
+          if (i + s < dims[axis]) {
+            upper = axis == 1 ? volume.row(y + s, z) : volume.row(y, z + s);
+          }
+          uint64_t* out = scratch.row(y, z);
+          for (int w = 0; w < words; ++w) {
+            out[w] = center[w] | (lower ? lower[w] : 0) | (upper ? upper[w] : 0);
+          }
+        }
+      }
+    });
+    std::swap(volume, scratch);
+    a += s;
+  }
+  return true;
+}
+
+void orVolume(const BitVolume& input, BitVolume& output)
+{
+  const int words = input.wordsPerRow();
+  parallelFor(0, input.numberOfRows(), [&](int64_t begin, int64_t end) {
+    for (int64_t r = begin; r < end; ++r) {
+      const uint64_t* in = input.row(r);
+      uint64_t* out = output.row(r);
+      for (int w = 0; w < words; ++w) {
+        out[w] |= in[w];
+      }
+    }
+  });
+}
+
+bool dilateBox(const BitVolume& input, BitVolume& output, int radius,
+               const std::function<bool()>& canceled)
+{
+  BitVolume scratch(input.dimensions());
+  dilateX(input, output, radius);
+  return dilateLines(output, scratch, 1, radius, canceled) &&
+         dilateLines(output, scratch, 2, radius, canceled);
+}
+
+bool dilateCross(const BitVolume& input, BitVolume& output, int radius,
+                 const std::function<bool()>& canceled)
+{
+  dilateX(input, output, radius);
+  BitVolume line(input.dimensions());
+  BitVolume scratch(input.dimensions());
+  for (int axis = 1; axis < 3; ++axis) {
+    line = input;
+    if (!dilateLines(line, scratch, axis, radius, canceled)) {
+      return false;
+    }
+    orVolume(line, output);
+  }
+  return true;
+}
+
+// Half width along x of the ball of the given radius at offset (dy, dz), or
+// -1 if the offset is outside of the ball. This is the ball used by ITK's
+// FlatStructuringElement::Ball, the voxels with dx^2 + dy^2 + dz^2 less than
+// or equal to (radius + 0.5)^2.
+int ballWidth(int radius, int dy, int dz)
+{
+  const int64_t limit = static_cast<int64_t>(2 * radius + 1) * (2 * radius + 1);
+  const int64_t m = 4 * (static_cast<int64_t>(dy) * dy + dz * dz);
+  if (m > limit) {
+    return -1;
+  }
+  int w = 0;
+  while (4 * static_cast<int64_t>(w + 1) * (w + 1) + m <= limit) {
+    ++w;
+  }
+  return w;
+}
+
+// The ball is the union of x runs, one per (dy, dz) offset. Each output slice
+// is computed by one task from the 2 * radius + 1 input slices around it. The
+// x dilations of an input slice are grown one radius at a time, so every run
+// width is available for the cost of a single line dilation.
+bool dilateBall(const BitVolume& input, BitVolume& output, int radius,
+                const std::function<bool()>& canceled)
+{
+  const int* dims = input.dimensions();
+  const int words = input.wordsPerRow();
+  const int64_t sliceWords = static_cast<int64_t>(words) * dims[1];
+
+  std::vector<int> widths((2 * radius + 1) * (2 * radius + 1));
+  for (int dz = -radius; dz <= radius; ++dz) {
+    for (int dy = -radius; dy <= radius; ++dy) {
+      widths[(dz + radius) * (2 * radius + 1) + dy + radius] =
+        ballWidth(radius, dy, dz);
+    }
+  }
+
+  std::atomic<bool> completed(true);
+  parallelFor(0, dims[2], 1, [&](int64_t begin, int64_t end) {
+    // dilated[w] holds the current input slice dilated along x by w.
+    std::vector<uint64_t> dilated((radius + 1) * sliceWords);
+    for (int z = static_cast<int>(begin); z < end; ++z) {
+      if (!completed || (canceled && canceled())) {
+        completed = false;
+        return;
+      }
+      uint64_t* out = output.row(0, z);
+      std::fill(out, out + sliceWords, 0);
+      for (int dz = -radius; dz <= radius; ++dz) {
+        const int zz = z + dz;
+        if (zz < 0 || zz >= dims[2]) {
+          continue;
+        }
+        const int* rowWidths = &widths[(dz + radius) * (2 * radius + 1)];
+        const int maxWidth = rowWidths[radius];
+        const uint64_t* in = input.row(0, zz);
+        std::copy(in, in + sliceWords, dilated.begin());
+        for (int w = 1; w <= maxWidth; ++w) {
+          uint64_t* previous = &dilated[(w - 1) * sliceWords];
+          uint64_t* current = &dilated[w * sliceWords];
+          std::copy(previous, previous + sliceWords, current);
+          for (int y = 0; y < dims[1]; ++y) {
+            uint64_t* row = current + static_cast<int64_t>(y) * words;
+            orShifted(in + static_cast<int64_t>(y) * words, row, words, w);
+            orShifted(in + static_cast<int64_t>(y) * words, row, words, -w);
+            row[words - 1] &= input.lastWordMask();
+          }
+        }
+        for (int dy = -radius; dy <= radius; ++dy) {
+          const int w = rowWidths[dy + radius];
+          if (w < 0) {
+            continue;
+          }
+          const uint64_t* source = &dilated[w * sliceWords];
+          const int yBegin = std::max(0, -dy);
+          const int yEnd = std::min(dims[1], dims[1] - dy);
+          for (int y = yBegin; y < yEnd; ++y) {
+            const uint64_t* src = source + static_cast<int64_t>(y + dy) * words;
+            uint64_t* dst = out + static_cast<int64_t>(y) * words;
+            for (int i = 0; i < words; ++i) {
+              dst[i] |= src[i];
+            }
+          }
+        }
+      }
+    }
+  });
+  return completed;
+}
+} // namespace
+
+namespace tomviz {
+
+namespace BinaryMorphology {
+
+void BitVolume::resize(const int dims[3])
+{
+  for (int i = 0; i < 3; ++i) {
+    m_dims[i] = dims[i];
+  }
+  m_wordsPerRow = (dims[0] + 63) / 64;
+  const int tail = dims[0] % 64;
+  m_lastWordMask = tail ? (uint64_t(1) << tail) - 1 : ~uint64_t(0);
+  m_words.assign(static_cast<size_t>(numberOfRows()) * m_wordsPerRow, 0);
+}
+
+void BitVolume::invert()
+{
+  const int words = m_wordsPerRow;
+  if (words == 0) {
+    return;
+  }
+  parallelFor(0, numberOfRows(), [&](int64_t begin, int64_t end) {
+    for (int64_t r = begin; r < end; ++r) {
+      uint64_t* bits = row(r);
+      for (int w = 0; w < words; ++w) {
+        bits[w] = ~bits[w];
+      }
+      bits[words - 1] &= m_lastWordMask;
+    }
+  });
+}
+
+bool dilate(const BitVolume& input, BitVolume& output,
+            StructuringElement element, int radius,
+            const std::function<bool()>& canceled)
+{
+  output.resize(input.dimensions());
+  if (input.wordsPerRow() == 0 || input.numberOfRows() == 0) {
+    return true;
+  }
+  radius = std::max(radius, 0);
+  switch (element) {
+    case StructuringElement::Box:
+      return dilateBox(input, output, radius, canceled);
+    case StructuringElement::Ball:
+      return dilateBall(input, output, radius, canceled);
+    case StructuringElement::Cross:
+      return dilateCross(input, output, radius, canceled);
+  }
+  return false;
+}
+
+bool erode(const BitVolume& input, BitVolume& output,
+           StructuringElement element, int radius,
+           const std::function<bool()>& canceled)
+{
+  BitVolume complement = input;
+  complement.invert();
+  if (!dilate(complement, output, element, radius, canceled)) {
+    return false;
+  }
+  output.invert();
+  return true;
+}
+} // namespace BinaryMorphology
+} // namespace tomviz
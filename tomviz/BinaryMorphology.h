@@ -0,0 +1,209 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizBinaryMorphology_h
+#define tomvizBinaryMorphology_h
+
+#include "ParallelFor.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace tomviz {
+
+namespace BinaryMorphology {
+
+/// Structuring elements, the values match the ids used by the Python binary
+/// morphology operators.
+enum class StructuringElement
+{
+  Box = 0,
+  Ball = 1,
+  Cross = 2
+};
+
+enum class Operation
+{
+  Dilate,
+  Erode,
+  Open,
+  Close
+};
+
+/// A binary volume packed 64 voxels to a word along x. Each row starts on a
+/// new word and the padding bits past the end of a row are always zero.
+class BitVolume
+{
+public:
+  BitVolume() = default;
+  explicit BitVolume(const int dims[3]) { resize(dims); }
+
+  /// Resize the volume, every voxel is set to zero.
+  void resize(const int dims[3]);
+
+  const int* dimensions() const { return m_dims; }
+  int wordsPerRow() const { return m_wordsPerRow; }
+  int64_t numberOfRows() const
+  {
+    return static_cast<int64_t>(m_dims[1]) * m_dims[2];
+  }
+  /// Mask of the bits of the last word of a row that hold voxels.
+  uint64_t lastWordMask() const { return m_lastWordMask; }
+
+  uint64_t* row(int64_t r) { return &m_words[r * m_wordsPerRow]; }
+  const uint64_t* row(int64_t r) const { return &m_words[r * m_wordsPerRow]; }
+  uint64_t* row(int y, int z)
+  {
+    return row(static_cast<int64_t>(z) * m_dims[1] + y);
+  }
+  const uint64_t* row(int y, int z) const
+  {
+    return row(static_cast<int64_t>(z) * m_dims[1] + y);
+  }
+
+  bool value(int x, int y, int z) const
+  {
+    return (row(y, z)[x / 64] >> (x % 64)) & 1;
+  }
+
+  /// Flip every voxel, in parallel.
+  void invert();
+
+private:
+  int m_dims[3] = { 0, 0, 0 };
+  int m_wordsPerRow = 0;
+  uint64_t m_lastWordMask = 0;
+  std::vector<uint64_t> m_words;
+};
+
+/// Dilate input by the structuring element of the given radius, voxels
+/// outside the volume are background. Box and cross elements are decomposed
+/// into lines that are dilated by doubling, O(log radius) passes per axis.
+/// The ball is decomposed into x runs, one per (y, z) offset. Returns false if
+/// canceled.
+bool dilate(const BitVolume& input, BitVolume& output,
+            StructuringElement element, int radius,
+            const std::function<bool()>& canceled = nullptr);
+
+/// Erode input by the structuring element of the given radius, voxels outside
+/// the volume are foreground. Computed as the dilation of the complement.
+bool erode(const BitVolume& input, BitVolume& output,
+           StructuringElement element, int radius,
+           const std::function<bool()>& canceled = nullptr);
+
+/// Apply a binary morphological operation in place on data, matching ITK's
+/// BinaryDilateImageFilter and BinaryErodeImageFilter as used by the Python
+/// operators. Voxels equal to object are the foreground, voxels added by a
+/// dilation are set to object and voxels removed by an erosion are set to
+/// background, every other voxel keeps its value. Open and close are fused,
+/// the intermediate results only exist as bit volumes and data is written in
+/// a single pass at the end. Returns false if canceled, leaving data intact.
+template <typename T>
+bool apply(T* data, const int dims[3], Operation operation,
+           StructuringElement element, int radius, T object, T background,
+           const std::function<bool()>& canceled = nullptr);
+
+namespace detail {
+
+/// Pack the voxels of data equal to value into mask.
+template <typename T>
+void pack(const T* data, T value, BitVolume& mask)
+{
+  const int64_t nx = mask.dimensions()[0];
+  const int words = mask.wordsPerRow();
+  parallelFor(0, mask.numberOfRows(), [&](int64_t begin, int64_t end) {
+    for (int64_t r = begin; r < end; ++r) {
+      const T* src = data + r * nx;
+      uint64_t* dst = mask.row(r);
+      for (int w = 0; w < words; ++w) {
+        const int64_t first = static_cast<int64_t>(w) * 64;
+        const int count = static_cast<int>(std::min<int64_t>(64, nx - first));
+        uint64_t bits = 0;
+        for (int i = 0; i < count; ++i) {
+          bits |= static_cast<uint64_t>(src[first + i] == value) << i;
+        }
+        dst[w] = bits;
+      }
+    }
+  });
+}
+
+/// Set the voxels of data whose bit is set in (set & ~clear) to value, clear
+/// may be nullptr. Words without any bit set are skipped, so sparse changes
+/// are cheap.
+template <typename T>
+void unpack(const BitVolume& set, const BitVolume* clear, T value, T* data)
+{
+  const int64_t nx = set.dimensions()[0];
+  const int words = set.wordsPerRow();
+  parallelFor(0, set.numberOfRows(), [&](int64_t begin, int64_t end) {
+    for (int64_t r = begin; r < end; ++r) {
+      const uint64_t* a = set.row(r);
+      const uint64_t* b = clear ? clear->row(r) : nullptr;
+      T* dst = data + r * nx;
+      for (int w = 0; w < words; ++w) {
+        const uint64_t bits = b ? a[w] & ~b[w] : a[w];
+        if (!bits) {
+          continue;
+        }
+        T* voxels = dst + static_cast<int64_t>(w) * 64;
+        for (int i = 0; i < 64; ++i) {
+          if ((bits >> i) & 1) {
+            voxels[i] = value;
+          }
+        }
+      }
+    }
+  });
+}
+} // namespace detail
+
+template <typename T>
+bool apply(T* data, const int dims[3], Operation operation,
+           StructuringElement element, int radius, T object, T background,
+           const std::function<bool()>& canceled)
+{
+  BitVolume foreground(dims);
+  detail::pack(data, object, foreground);
+
+  BitVolume first(dims);
+  BitVolume second(dims);
+  switch (operation) {
+    case Operation::Dilate:
+      if (!dilate(foreground, first, element, radius, canceled)) {
+        return false;
+      }
+      detail::unpack(first, &foreground, object, data);
+      break;
+    case Operation::Erode:
+      if (!erode(foreground, first, element, radius, canceled)) {
+        return false;
+      }
+      detail::unpack(foreground, &first, background, data);
+      break;
+    case Operation::Open:
+      if (!erode(foreground, first, element, radius, canceled) ||
+          !dilate(first, second, element, radius, canceled)) {
+        return false;
+      }
+      detail::unpack(foreground, &second, background, data);
+      break;
+    case Operation::Close:
+      if (!dilate(foreground, first, element, radius, canceled) ||
+          !erode(first, second, element, radius, canceled)) {
+        return false;
+      }
+      // Voxels added by the dilation and then removed by the erosion end up
+      // as background, even if they were some other label to begin with.
+      detail::unpack(first, &second, background, data);
+      detail::unpack(second, &foreground, object, data);
+      break;
+  }
+  return true;
+}
+} // namespace BinaryMorphology
+} // namespace tomviz
+
+#endif
@@ -0,0 +1,93 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "BrickRangeIndex.h"
+
+#include <vtkDataArray.h>
+
+namespace tomviz {
+
+void BrickRangeIndex::reset(const int dims[3])
+{
+  const double inf = std::numeric_limits<double>::infinity();
+  m_range[0] = inf;
+  m_range[1] = -inf;
+  for (int i = 0; i < 3; ++i) {
+    m_dims[i] = dims[i];
+    m_bricks[i] =
+      dims[i] > 0 ? std::max((dims[i] - 1 + BrickSize - 1) / BrickSize, 1) : 0;
+  }
+  m_minimum.assign(numberOfBricks(), inf);
+  m_maximum.assign(numberOfBricks(), -inf);
+}
+
+void BrickRangeIndex::build(vtkDataArray* scalars, const int dims[3])
+{
+  if (!scalars ||
+      scalars->GetNumberOfTuples() !=
+        static_cast<vtkIdType>(dims[0]) * dims[1] * dims[2]) {
+    const int none[3] = { 0, 0, 0 };
+    reset(none);
+    return;
+  }
+  switch (scalars->GetDataType()) {
+    vtkTemplateMacro(
+      build(static_cast<const VTK_TT*>(scalars->GetVoidPointer(0)),
+            scalars->GetNumberOfComponents(), dims));
+  }
+}
+
+std::vector<int64_t> BrickRangeIndex::bricksInRange(double minimum,
+                                                    double maximum) const
+{
+  std::vector<int64_t> bricks;
+  for (int64_t brick = 0; brick < numberOfBricks(); ++brick) {
+    if (overlaps(brick, minimum, maximum)) {
+      bricks.push_back(brick);
+    }
+  }
+  return bricks;
+}
+
+bool BrickRangeIndex::layerInRange(int k, double minimum,
+                                   double maximum) const
+{
+  if (k < 0 || k >= m_bricks[2]) {
+    return false;
+  }
+  const int64_t first = brickId(0, 0, k);
+  const int64_t last = first + static_cast<int64_t>(m_bricks[0]) * m_bricks[1];
+  for (int64_t brick = first; brick < last; ++brick) {
+    if (overlaps(brick, minimum, maximum)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::vector<std::array<int, 6>> BrickRangeIndex::extentsInRange(
+  double minimum, double maximum) const
+{
+  std::vector<std::array<int, 6>> extents;
+  for (int k = 0; k < m_bricks[2]; ++k) {
+    for (int j = 0; j < m_bricks[1]; ++j) {
+      int i = 0;
+      while (i < m_bricks[0]) {
+        if (!overlaps(brickId(i, j, k), minimum, maximum)) {
+          ++i;
+          continue;
+        }
+        const int first = i;
+        while (i < m_bricks[0] &&
+               overlaps(brickId(i, j, k), minimum, maximum)) {
+          ++i;
+        }
+        extents.push_back({ { firstPoint(first), lastPoint(i - 1, m_dims[0]),
+                              firstPoint(j), lastPoint(j, m_dims[1]),
+                              firstPoint(k), lastPoint(k, m_dims[2]) } });
+      }
+    }
+  }
+  return extents;
+}
+} // namespace tomviz
@@ -0,0 +1,151 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizBrickRangeIndex_h
+#define tomvizBrickRangeIndex_h
+
+#include "ParallelFor.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+class vtkDataArray;
+
+namespace tomviz {
+
+/// Minimum and maximum of the first component of an image array over bricks
+/// of BrickSize cells along each axis. A brick holds the points of its cells,
+/// so neighboring bricks share a plane of points and any cell, or any
+/// crossing of an iso value, lies within a single brick. Queries for a value
+/// range can skip the bricks whose range does not overlap it, which for
+/// sparse data is most of the volume. Non-finite values are ignored.
+class BrickRangeIndex
+{
+public:
+  static const int BrickSize = 16;
+
+  BrickRangeIndex() = default;
+
+  /// Build the index of the first component of scalars for an image with the
+  /// given point dimensions, the bricks are visited in parallel.
+  void build(vtkDataArray* scalars, const int dims[3]);
+  template <typename T>
+  void build(const T* data, int nComps, const int dims[3]);
+
+  bool isEmpty() const { return m_minimum.empty(); }
+
+  /// Point dimensions of the image indexed.
+  const int* dimensions() const { return m_dims; }
+  /// Number of bricks along each axis.
+  const int* bricks() const { return m_bricks; }
+  int64_t numberOfBricks() const
+  {
+    return static_cast<int64_t>(m_bricks[0]) * m_bricks[1] * m_bricks[2];
+  }
+  int64_t brickId(int i, int j, int k) const
+  {
+    return (static_cast<int64_t>(k) * m_bricks[1] + j) * m_bricks[0] + i;
+  }
+
+  double minimum(int64_t brick) const { return m_minimum[brick]; }
+  double maximum(int64_t brick) const { return m_maximum[brick]; }
+
+  /// Finite range of the whole image, [inf, -inf] if there is none.
+  const double* range() const { return m_range; }
+
+  /// Whether the brick may hold a value in [minimum, maximum].
+  bool overlaps(int64_t brick, double minimum, double maximum) const
+  {
+    return m_minimum[brick] <= maximum && m_maximum[brick] >= minimum;
+  }
+
+  /// Ids of the bricks that may hold a value in [minimum, maximum].
+  std::vector<int64_t> bricksInRange(double minimum, double maximum) const;
+
+  /// Whether any brick of the layer k may hold a value in [minimum,
+  /// maximum].
+  bool layerInRange(int k, double minimum, double maximum) const;
+
+  /// Point extents, starting at zero, of the bricks that may hold a value in
+  /// [minimum, maximum]. Bricks next to each other along x share an extent,
+  /// the extents of a row never overlap. Empty if there are none.
+  std::vector<std::array<int, 6>> extentsInRange(double minimum,
+                                                 double maximum) const;
+
+  /// Memory used by the index, in bytes.
+  size_t memorySize() const
+  {
+    return (m_minimum.capacity() + m_maximum.capacity()) * sizeof(double);
+  }
+
+  /// First and last point of brick b along an axis with n points.
+  static int firstPoint(int b) { return b * BrickSize; }
+  static int lastPoint(int b, int n)
+  {
+    return std::min(b * BrickSize + BrickSize, n - 1);
+  }
+
+private:
+  void reset(const int dims[3]);
+
+  int m_dims[3] = { 0, 0, 0 };
+  int m_bricks[3] = { 0, 0, 0 };
+  double m_range[2] = { std::numeric_limits<double>::infinity(),
+                        -std::numeric_limits<double>::infinity() };
+  std::vector<double> m_minimum;
+  std::vector<double> m_maximum;
+};
+
+template <typename T>
+void BrickRangeIndex::build(const T* data, int nComps, const int dims[3])
+{
+  reset(dims);
+  if (isEmpty()) {
+    return;
+  }
+
+  // One task per row of bricks along x, each point row of the bricks is
+  // read once per brick it belongs to.
+  const int64_t nx = dims[0];
+  const int64_t pointsPerPlane = nx * dims[1];
+  const int64_t rows = static_cast<int64_t>(m_bricks[1]) * m_bricks[2];
+  parallelFor(0, rows, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t row = begin; row < end; ++row) {
+      const int bj = static_cast<int>(row % m_bricks[1]);
+      const int bk = static_cast<int>(row / m_bricks[1]);
+      for (int bi = 0; bi < m_bricks[0]; ++bi) {
+        double minimum = std::numeric_limits<double>::infinity();
+        double maximum = -std::numeric_limits<double>::infinity();
+        const int x0 = firstPoint(bi);
+        const int x1 = lastPoint(bi, dims[0]);
+        for (int z = firstPoint(bk); z <= lastPoint(bk, dims[2]); ++z) {
+          for (int y = firstPoint(bj); y <= lastPoint(bj, dims[1]); ++y) {
+            const T* p = data + (z * pointsPerPlane + y * nx + x0) * nComps;
+            for (int x = x0; x <= x1; ++x, p += nComps) {
+              const double value = static_cast<double>(*p);
+              if (std::isfinite(value)) {
+                minimum = std::min(minimum, value);
+                maximum = std::max(maximum, value);
+              }
+            }
+          }
+        }
+        const int64_t brick = brickId(bi, bj, bk);
+        m_minimum[brick] = minimum;
+        m_maximum[brick] = maximum;
+      }
+    }
+  });
+
+  for (int64_t brick = 0; brick < numberOfBricks(); ++brick) {
+    m_range[0] = std::min(m_range[0], m_minimum[brick]);
+    m_range[1] = std::max(m_range[1], m_maximum[brick]);
+  }
+}
+} // namespace tomviz
+
+#endif
@@ -142,6 +142,8 @@ CentralWidget::CentralWidget(QWidget* parentObject, Qt::WindowFlags wflags)
           &CentralWidget::histogramReady);
   connect(&histogramMgr, &HistogramManager::histogram2DReady, this,
           &CentralWidget::histogram2DReady);
+  connect(&histogramMgr, &HistogramManager::gradientHistogramReady, this,
+          &CentralWidget::gradientHistogramReady);
 
   m_timer->setInterval(200);
   m_timer->setSingleShot(true);
@@ -258,15 +260,27 @@ void CentralWidget::setColorMapDataSource(DataSource* source)
   m_ui->histogram2DWidget->updateTransfer2D();
 
   vtkSmartPointer<vtkImageData> const imageSP = image;
-  auto histogram = HistogramManager::instance().getHistogram(imageSP);
-  auto histogram2D = HistogramManager::instance().getHistogram2D(imageSP);
-
-  if (histogram) {
+  auto& histogramMgr = HistogramManager::instance();
+  if (auto histogram = histogramMgr.getHistogram(imageSP)) {
     setHistogramTable(histogram);
   }
-  if (histogram2D) {
-    m_ui->histogram2DWidget->setHistogram(histogram2D);
-    m_ui->histogram2DWidget->addFunctionItem(m_transfer2DModel->getDefault());
+
+  // The gradient histograms need a pass over the gradient of the volume, only
+  // ask for the one the active transfer mode shows.
+  auto mode = Module::SCALAR;
+  if (m_activeModule && m_activeModule->supportsGradientOpacity()) {
+    mode = m_activeModule->getTransferMode();
+  }
+  if (mode == Module::GRADIENT_1D) {
+    if (auto histogram = histogramMgr.getGradientHistogram(imageSP)) {
+      m_ui->gradientOpacityWidget->setInputData(histogram, "image_extents",
+                                                "image_pops");
+    }
+  } else if (mode == Module::GRADIENT_2D) {
+    if (auto histogram2D = histogramMgr.getHistogram2D(imageSP)) {
+      m_ui->histogram2DWidget->setHistogram(histogram2D);
+      m_ui->histogram2DWidget->addFunctionItem(m_transfer2DModel->getDefault());
+    }
   }
 }
 
@@ -324,6 +338,18 @@ void CentralWidget::histogram2DReady(vtkSmartPointer<vtkImageData> input,
   refreshHistogram();
 }
 
+void CentralWidget::gradientHistogramReady(vtkSmartPointer<vtkImageData> input,
+                                           vtkSmartPointer<vtkTable> output)
+{
+  vtkImageData* inputIm = getInputImage(input);
+  if (!inputIm || !output) {
+    return;
+  }
+
+  m_ui->gradientOpacityWidget->setInputData(output, "image_extents",
+                                            "image_pops");
+}
+
 vtkImageData* CentralWidget::getInputImage(vtkSmartPointer<vtkImageData> input)
 {
   if (!input) {
@@ -356,8 +382,6 @@ void CentralWidget::setHistogramTable(vtkTable* table)
   }
 
   m_ui->histogramWidget->setInputData(table, "image_extents", "image_pops");
-  m_ui->gradientOpacityWidget->setInputData(table, "image_extents",
-                                            "image_pops");
 }
 
 void CentralWidget::onTransferModeChanged(const int mode)
@@ -380,6 +404,10 @@ void CentralWidget::onTransferModeChanged(const int mode)
   }
 
   m_ui->swTransferMode->setCurrentIndex(index);
+
+  // Show the gradient histogram of the new mode, the gradient magnitude is
+  // computed once per version of the data and shared between the two.
+  onColorMapDataSourceChanged();
 }
 
 } // end of namespace tomviz
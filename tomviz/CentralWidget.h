@@ -56,6 +56,8 @@ private slots:
   void histogramReady(vtkSmartPointer<vtkImageData>, vtkSmartPointer<vtkTable>);
   void histogram2DReady(vtkSmartPointer<vtkImageData> input,
                         vtkSmartPointer<vtkImageData> output);
+  void gradientHistogramReady(vtkSmartPointer<vtkImageData> input,
+                              vtkSmartPointer<vtkTable> output);
   void onColorMapDataSourceChanged();
   void refreshHistogram();
 
@@ -4,11 +4,19 @@
 #ifndef tomvizComputeHistogram_h
 #define tomvizComputeHistogram_h
 
+#include "GradientMagnitude.h"
+#include "ParallelFor.h"
+
 #include <vtkDoubleArray.h>
 #include <vtkImageData.h>
 #include <vtkMath.h>
+#include <vtkPointData.h>
 
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <mutex>
+#include <vector>
 
 namespace tomviz {
 
@@ -31,7 +39,7 @@ void calcHistogram(T*, const vtkIdType, uint64_t*)
 }
 
 /** Single component unsigned char covering 0 -> 255 range. */
-void calcHistogram(unsigned char* values, const vtkIdType numTuples,
+inline void calcHistogram(unsigned char* values, const vtkIdType numTuples,
                    uint64_t* pops)
 {
   for (vtkIdType j = 0; j < numTuples; ++j) {
@@ -105,10 +113,21 @@ void CalculateHistogram(T* values, const vtkIdType numTuples,
   }
 }
 
+/**
+ * Computes the 2D histogram of scalar value against gradient magnitude, with
+ * the gradient magnitudes of the values computed beforehand.
+ * \param values The scalars the gradient was computed from.
+ * \param numComp Number of components in each tuple, the first is binned.
+ * \param range Range of the scalars.
+ * \param gradient Gradient magnitude of the scalars.
+ * \param histogram Single component double image with the number of bins
+ * along x (scalar value) and y (gradient magnitude) as its dimensions.
+ */
 template <typename T>
-void Calculate2DHistogram(T* values, const int* dim, const int numComp,
-                          const double* range, vtkImageData* histogram,
-                          double spacing[3])
+void Calculate2DHistogram(const T* values, const int numComp,
+                          const double* range,
+                          const GradientMagnitude& gradient,
+                          vtkImageData* histogram)
 {
   // Assumes all inputs are valid
   // Expects histogram image to be 1C double
@@ -120,87 +139,169 @@ void Calculate2DHistogram(T* values, const int* dim, const int numComp,
   histogram->GetDimensions(bins);
   const size_t sizeBins = static_cast<size_t>(bins[0] * bins[1]);
 
+  // Normalize to RangeMax/4. This is what the gradient computation in the
+  // GPUMapper's fragment shader expects.
+  double maxGradMag = range[1] * 0.25;
+  if (maxGradMag <= 0.0) {
+    maxGradMag = std::max((range[1] - range[0]) * 0.25, 1.0);
+  }
+
+  // A constant image, or one without finite values, is binned over a unit
+  // range so the bin indices stay finite.
+  double width = range[1] - range[0];
+  if (!(width > 0.0) || !std::isfinite(width)) {
+    width = 1.0;
+  }
+  if (!std::isfinite(maxGradMag)) {
+    maxGradMag = 1.0;
+  }
+
   // Adjust histogram's spacing so that the axis show the actual range in the
   // chart
-  double binSpacing[3] = { (range[1] - range[0]) / bins[0],
-                           (range[1] * 0.25) / bins[1], 1.0 };
+  double binSpacing[3] = { width / bins[0], maxGradMag / bins[1], 1.0 };
   histogram->SetSpacing(binSpacing);
 
-  memset(histogramArr->GetVoidPointer(0), 0x0, sizeBins * sizeof(double));
-
-  const size_t sizeSlice = static_cast<size_t>(dim[0] * dim[1] * numComp);
-  std::vector<T> sliceLast(sizeSlice, 0);
-  std::vector<T> sliceCurrent(sizeSlice, 0);
-  std::vector<T> sliceNext(sizeSlice, 0);
-
-  double gradMagMax = std::numeric_limits<double>::min();
-  double gradMagMin = std::numeric_limits<double>::max();
-
-  // Central differences delta (2 * h)
-  const double avgSpacing = (spacing[0] + spacing[1] + spacing[2]) / 3.0;
-  const double delta[3] = { spacing[0] * 2 / avgSpacing,
-                            spacing[1] * 2 / avgSpacing,
-                            spacing[2] * 2 / avgSpacing };
-
-  for (int kIndex = 0; kIndex < dim[2]; kIndex++) {
-    // Index assumes alignment order in  x -> y -> z.
-    // ( z0 * Dx * Dy + y0 * Dx + x0 ) * numComp
-    const size_t strideSlice =
-      static_cast<size_t>(dim[0] * dim[1] * kIndex * numComp);
-    memcpy(&(sliceNext[0]), values + strideSlice, sizeSlice * sizeof(T));
-
-    // Fill up temporary slices during the first two iterations
-    if (kIndex >= 2) {
-      for (int jIndex = 1; jIndex < dim[1] - 1; jIndex++) {
-        for (int iIndex = 1; iIndex < dim[0] - 1; iIndex++) {
-          const size_t centerIndex = dim[0] * jIndex + iIndex;
-          const size_t deltaXFront = centerIndex + 1;
-          const size_t deltaXBack = centerIndex - 1;
-
-          const double Dx = static_cast<double>(sliceCurrent[deltaXFront] -
-                                                sliceCurrent[deltaXBack]) /
-                            delta[0];
-
-          const size_t deltaYFront = dim[0] * (jIndex + 1) + iIndex;
-          const size_t deltaYBack = dim[0] * (jIndex - 1) + iIndex;
-          const double Dy = static_cast<double>(sliceCurrent[deltaYFront] -
-                                                sliceCurrent[deltaYBack]) /
-                            delta[1];
-
-          const double Dz = static_cast<double>(sliceNext[centerIndex] -
-                                                sliceLast[centerIndex]) /
-                            delta[2];
-
-          double gradMag = sqrt(Dx * Dx + Dy * Dy + Dz * Dz);
-          gradMagMax = vtkMath::Max(gradMag, gradMagMax);
-          gradMagMin = vtkMath::Min(gradMag, gradMagMin);
-
-          // Normalize to RangeMax/4. This is what the gradient computation in
-          // the
-          // GPUMapper's fragment shader expects.
-          const double maxGradMag = range[1] * 0.25;
-          gradMag = floor(gradMag + 0.5);
-          gradMag = vtkMath::ClampValue(gradMag, 0.0, maxGradMag);
-          const vtkIdType gradIndex =
-            static_cast<vtkIdType>(gradMag * (bins[1] - 1) / maxGradMag);
-
-          const T value = values[strideSlice + centerIndex * numComp];
-          const vtkIdType valueIndex = static_cast<vtkIdType>(
-            (value - range[0]) * (bins[1] - 1) / (range[1] - range[0]));
-
-          // Update histogram array
-          const vtkIdType tupleIndex = gradIndex * bins[0] + valueIndex;
-          double histogramValue = histogramArr->GetValue(tupleIndex);
-          histogramArr->SetValue(tupleIndex, ++histogramValue);
-        }
+  double* pops = histogramArr->GetPointer(0);
+  std::fill(pops, pops + sizeBins, 0.0);
+
+  const double valueScale = (bins[0] - 1) / width;
+  const double gradScale = (bins[1] - 1) / maxGradMag;
+  std::mutex mutex;
+  parallelFor(0, gradient.size(), [&](int64_t begin, int64_t end) {
+    std::vector<double> local(sizeBins, 0.0);
+    for (int64_t i = begin; i < end; ++i) {
+      const double value = static_cast<double>(values[i * numComp]);
+      if (!std::isfinite(value)) {
+        continue;
       }
+      const int valueIndex = vtkMath::ClampValue(
+        static_cast<int>((value - range[0]) * valueScale), 0, bins[0] - 1);
+      const int gradIndex = vtkMath::ClampValue(
+        static_cast<int>(gradient.value(i) * gradScale), 0, bins[1] - 1);
+      ++local[gradIndex * bins[0] + valueIndex];
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t bin = 0; bin < sizeBins; ++bin) {
+      pops[bin] += local[bin];
     }
+  });
+  histogramArr->Modified();
+}
 
-    std::swap(sliceLast, sliceCurrent);
-    std::swap(sliceCurrent, sliceNext);
+/** Grows range to the finite values, or magnitudes, of the tuples. */
+template <typename T>
+void calcFiniteRange(const T* values, const vtkIdType numTuples,
+                     const int numComponents, double* range)
+{
+  for (vtkIdType j = 0; j < numTuples; ++j) {
+    double value = 0.0;
+    if (numComponents == 1) {
+      value = static_cast<double>(values[j]);
+    } else {
+      for (int c = 0; c < numComponents; ++c) {
+        const double component =
+          static_cast<double>(values[j * numComponents + c]);
+        value += component * component;
+      }
+      value = std::sqrt(value);
+    }
+    if (std::isfinite(value)) {
+      range[0] = std::min(range[0], value);
+      range[1] = std::max(range[1], value);
+    }
   }
 }
 
+/**
+ * Computes the histograms of all the arrays of an image together. The tuples
+ * are split into blocks handed out to worker threads, and each block is
+ * binned for every array, so the image is traversed once for the ranges and
+ * once for the populations rather than twice per array.
+ * \param arrays The arrays, all with the same number of tuples.
+ * \param numberOfBins Number of bins of each histogram.
+ * \param ranges Returns the finite range of each array, of the magnitude for
+ * multi-component arrays. Bin j is centered on
+ * range[0] + j * (range[1] - range[0]) / (numberOfBins - 1).
+ * \param pops Returns the populations of each array.
+ * \param invalid Returns the number of non-finite tuples of each array.
+ */
+inline void CalculateHistograms(const std::vector<vtkDataArray*>& arrays,
+                                const int numberOfBins,
+                                std::vector<std::array<double, 2>>& ranges,
+                                std::vector<std::vector<uint64_t>>& pops,
+                                std::vector<int>& invalid)
+{
+  const size_t numArrays = arrays.size();
+  ranges.assign(numArrays, { { VTK_DOUBLE_MAX, VTK_DOUBLE_MIN } });
+  pops.assign(numArrays, std::vector<uint64_t>(numberOfBins, 0));
+  invalid.assign(numArrays, 0);
+  if (arrays.empty()) {
+    return;
+  }
+  const vtkIdType numTuples = arrays[0]->GetNumberOfTuples();
+  for (auto array : arrays) {
+    if (array->GetNumberOfTuples() != numTuples) {
+      return;
+    }
+  }
+  const int64_t grain = 1 << 16;
+  std::mutex mutex;
+
+  parallelFor(0, numTuples, grain, [&](int64_t begin, int64_t end) {
+    std::vector<std::array<double, 2>> local(
+      numArrays, { { VTK_DOUBLE_MAX, VTK_DOUBLE_MIN } });
+    for (size_t i = 0; i < numArrays; ++i) {
+      const int numComp = arrays[i]->GetNumberOfComponents();
+      switch (arrays[i]->GetDataType()) {
+        vtkTemplateMacro(calcFiniteRange(
+          static_cast<VTK_TT*>(arrays[i]->GetVoidPointer(begin * numComp)),
+          end - begin, numComp, local[i].data()));
+      }
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t i = 0; i < numArrays; ++i) {
+      ranges[i][0] = std::min(ranges[i][0], local[i][0]);
+      ranges[i][1] = std::max(ranges[i][1], local[i][1]);
+    }
+  });
+
+  std::vector<float> inv(numArrays);
+  for (size_t i = 0; i < numArrays; ++i) {
+    if (ranges[i][0] > ranges[i][1]) {
+      // Nothing but non-finite values.
+      ranges[i] = { { 0.0, 0.0 } };
+    }
+    if (ranges[i][0] == ranges[i][1]) {
+      ranges[i][1] = ranges[i][0] + 1.0;
+    }
+    inv[i] = static_cast<float>((numberOfBins - 1) /
+                                (ranges[i][1] - ranges[i][0]));
+  }
+
+  parallelFor(0, numTuples, grain, [&](int64_t begin, int64_t end) {
+    std::vector<std::vector<uint64_t>> local(
+      numArrays, std::vector<uint64_t>(numberOfBins, 0));
+    std::vector<int> localInvalid(numArrays, 0);
+    for (size_t i = 0; i < numArrays; ++i) {
+      const int numComp = arrays[i]->GetNumberOfComponents();
+      switch (arrays[i]->GetDataType()) {
+        vtkTemplateMacro(CalculateHistogram(
+          static_cast<VTK_TT*>(arrays[i]->GetVoidPointer(begin * numComp)),
+          end - begin, numComp, static_cast<float>(ranges[i][0]),
+          static_cast<float>(ranges[i][1]), local[i].data(), inv[i],
+          localInvalid[i]));
+      }
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t i = 0; i < numArrays; ++i) {
+      for (int bin = 0; bin < numberOfBins; ++bin) {
+        pops[i][bin] += local[i][bin];
+      }
+      invalid[i] += localInvalid[i];
+    }
+  });
+}
+
 } // namespace tomviz
 
 #endif
@@ -0,0 +1,289 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "ConnectedComponents.h"
+
+#include <vtkMath.h>
+
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+
+namespace {
+
+using tomviz::ConnectedComponents::LabelMoments;
+
+uint32_t findRoot(std::vector<uint32_t>& parent, uint32_t i)
+{
+  // Path halving, roots are always the smallest label in their set.
+  while (parent[i] != i) {
+    parent[i] = parent[parent[i]];
+    i = parent[i];
+  }
+  return i;
+}
+
+uint32_t unite(std::vector<uint32_t>& parent, uint32_t a, uint32_t b)
+{
+  a = findRoot(parent, a);
+  b = findRoot(parent, b);
+  if (a == b) {
+    return a;
+  }
+  if (b < a) {
+    std::swap(a, b);
+  }
+  parent[b] = a;
+  return a;
+}
+
+struct Slab
+{
+  int zBegin = 0;
+  int zEnd = 0;
+  // Provisional labels of the slab, entry 0 is unused.
+  std::vector<uint32_t> parent;
+  std::vector<LabelMoments> moments;
+  // Maps a provisional label to the index of its component within the slab.
+  std::vector<uint32_t> compact;
+  std::vector<LabelMoments> compactMoments;
+  // Index of the first component of this slab across all slabs.
+  uint32_t offset = 0;
+};
+
+// First pass over a slab, voxels are given provisional labels looking only at
+// their already visited neighbors (-x, -y and -z within the slab).
+bool labelSlab(uint32_t* labels, const int dims[3], Slab& slab,
+               const std::function<bool()>& canceled)
+{
+  const int64_t nx = dims[0];
+  const int64_t sliceSize = nx * dims[1];
+  slab.parent.assign(1, 0);
+  slab.moments.assign(1, LabelMoments());
+
+  for (int z = slab.zBegin; z < slab.zEnd; ++z) {
+    if (canceled && canceled()) {
+      return false;
+    }
+    for (int y = 0; y < dims[1]; ++y) {
+      int64_t index = z * sliceSize + y * nx;
+      uint32_t* row = labels + index;
+      const uint32_t* above = y > 0 ? row - nx : nullptr;
+      const uint32_t* behind = z > slab.zBegin ? row - sliceSize : nullptr;
+      for (int x = 0; x < dims[0]; ++x, ++index) {
+        if (!row[x]) {
+          continue;
+        }
+        uint32_t label = 0;
+        const uint32_t neighbors[3] = { x > 0 ? row[x - 1] : 0u,
+                                        above ? above[x] : 0u,
+                                        behind ? behind[x] : 0u };
+        for (uint32_t neighbor : neighbors) {
+          if (neighbor) {
+            label = label ? unite(slab.parent, label, neighbor)
+                          : findRoot(slab.parent, neighbor);
+          }
+        }
+        if (!label) {
+          label = static_cast<uint32_t>(slab.parent.size());
+          slab.parent.push_back(label);
+          slab.moments.emplace_back();
+        }
+        row[x] = label;
+        slab.moments[label].add(x, y, z, index);
+      }
+    }
+  }
+  return true;
+}
+
+// Collapse the provisional labels of a slab to one entry per component.
+void compactSlab(Slab& slab)
+{
+  slab.compact.assign(slab.parent.size(), 0);
+  slab.compactMoments.clear();
+  for (uint32_t i = 1; i < slab.parent.size(); ++i) {
+    uint32_t root = findRoot(slab.parent, i);
+    if (root == i) {
+      slab.compact[i] = static_cast<uint32_t>(slab.compactMoments.size());
+      slab.compactMoments.emplace_back();
+    } else {
+      // The root is the smallest label of the set, so it was visited first.
+      slab.compact[i] = slab.compact[root];
+    }
+    slab.compactMoments[slab.compact[i]].merge(slab.moments[i]);
+  }
+  slab.parent.clear();
+  slab.parent.shrink_to_fit();
+  slab.moments.clear();
+  slab.moments.shrink_to_fit();
+}
+} // namespace
+
+namespace tomviz {
+
+namespace ConnectedComponents {
+
+void LabelMoments::merge(const LabelMoments& other)
+{
+  count += other.count;
+  for (int i = 0; i < 3; ++i) {
+    sum[i] += other.sum[i];
+    min[i] = std::min(min[i], other.min[i]);
+    max[i] = std::max(max[i], other.max[i]);
+  }
+  for (int i = 0; i < 6; ++i) {
+    sumProducts[i] += other.sumProducts[i];
+  }
+  for (int i = 0; i < 3; ++i) {
+    faces[i] += other.faces[i];
+  }
+  first = std::min(first, other.first);
+}
+
+uint32_t labelForeground(uint32_t* labels, const int dims[3],
+                         std::vector<LabelMoments>* moments,
+                         const std::function<bool()>& canceled)
+{
+  const int64_t sliceSize = static_cast<int64_t>(dims[0]) * dims[1];
+  const int nSlabs = static_cast<int>(
+    std::min<int64_t>(dims[2], std::max(1u, parallelThreadCount()) * 2));
+  if (nSlabs < 1 || sliceSize < 1) {
+    return 0;
+  }
+
+  std::vector<Slab> slabs(nSlabs);
+  for (int s = 0; s < nSlabs; ++s) {
+    slabs[s].zBegin = static_cast<int>(static_cast<int64_t>(dims[2]) * s /
+                                       nSlabs);
+    slabs[s].zEnd = static_cast<int>(static_cast<int64_t>(dims[2]) * (s + 1) /
+                                     nSlabs);
+  }
+
+  std::atomic<bool> completed(true);
+  parallelFor(0, nSlabs, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t s = begin; s < end; ++s) {
+      if (!labelSlab(labels, dims, slabs[s], canceled)) {
+        completed = false;
+        return;
+      }
+      compactSlab(slabs[s]);
+    }
+  });
+  if (!completed) {
+    return 0;
+  }
+
+  uint32_t total = 0;
+  for (auto& slab : slabs) {
+    slab.offset = total;
+    total += static_cast<uint32_t>(slab.compactMoments.size());
+  }
+
+  // Merge the components that touch across slab boundaries, the boundary
+  // planes are small compared to the volume so this is done serially.
+  std::vector<uint32_t> parent(total);
+  std::iota(parent.begin(), parent.end(), 0);
+  for (int s = 1; s < nSlabs; ++s) {
+    const uint32_t* lower = labels + (slabs[s].zBegin - 1) * sliceSize;
+    const uint32_t* upper = labels + slabs[s].zBegin * sliceSize;
+    const Slab& lowerSlab = slabs[s - 1];
+    const Slab& upperSlab = slabs[s];
+    for (int64_t i = 0; i < sliceSize; ++i) {
+      if (lower[i] && upper[i]) {
+        unite(parent, lowerSlab.offset + lowerSlab.compact[lower[i]],
+              upperSlab.offset + upperSlab.compact[upper[i]]);
+      }
+    }
+  }
+
+  // Gather the moments of each final component onto its root.
+  std::vector<LabelMoments> rootMoments(total);
+  std::vector<uint32_t> roots;
+  for (const auto& slab : slabs) {
+    for (size_t i = 0; i < slab.compactMoments.size(); ++i) {
+      uint32_t global = slab.offset + static_cast<uint32_t>(i);
+      uint32_t root = findRoot(parent, global);
+      if (root == global) {
+        roots.push_back(root);
+      }
+      rootMoments[root].merge(slab.compactMoments[i]);
+    }
+  }
+
+  // Order the components by increasing size, and for equal sizes the
+  // component found last in the volume comes first.
+  std::sort(roots.begin(), roots.end(), [&](uint32_t a, uint32_t b) {
+    const auto& ma = rootMoments[a];
+    const auto& mb = rootMoments[b];
+    return ma.count != mb.count ? ma.count < mb.count : ma.first > mb.first;
+  });
+  std::vector<uint32_t> finalLabels(total, 0);
+  for (size_t i = 0; i < roots.size(); ++i) {
+    finalLabels[roots[i]] = static_cast<uint32_t>(i + 1);
+  }
+  for (uint32_t i = 0; i < total; ++i) {
+    finalLabels[i] = finalLabels[findRoot(parent, i)];
+  }
+
+  // Write the final labels, one slab per task.
+  parallelFor(0, nSlabs, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t s = begin; s < end; ++s) {
+      const Slab& slab = slabs[s];
+      uint32_t* first = labels + slab.zBegin * sliceSize;
+      uint32_t* last = labels + slab.zEnd * sliceSize;
+      for (uint32_t* label = first; label != last; ++label) {
+        if (*label) {
+          *label = finalLabels[slab.offset + slab.compact[*label]];
+        }
+      }
+    }
+  });
+
+  if (moments) {
+    moments->resize(roots.size());
+    for (size_t i = 0; i < roots.size(); ++i) {
+      (*moments)[i] = rootMoments[roots[i]];
+    }
+  }
+  return static_cast<uint32_t>(roots.size());
+}
+
+void principalAxes(const LabelMoments& moments, const double origin[3],
+                   const double spacing[3], double center[3],
+                   double axes[3][3])
+{
+  const double count = static_cast<double>(moments.count);
+  double mean[3];
+  for (int i = 0; i < 3; ++i) {
+    mean[i] = moments.sum[i] / count;
+    center[i] = origin[i] + spacing[i] * mean[i];
+  }
+
+  // Covariance in physical units, ordered as LabelMoments::sumProducts.
+  const int pairs[6][2] = { { 0, 0 }, { 1, 1 }, { 2, 2 },
+                            { 0, 1 }, { 0, 2 }, { 1, 2 } };
+  double covariance[3][3];
+  for (int i = 0; i < 6; ++i) {
+    const int a = pairs[i][0];
+    const int b = pairs[i][1];
+    covariance[a][b] = spacing[a] * spacing[b] *
+                       (moments.sumProducts[i] / count - mean[a] * mean[b]);
+    covariance[b][a] = covariance[a][b];
+  }
+
+  // Jacobi orders the eigenvalues from largest to smallest, with the
+  // eigenvectors as the columns of vectors.
+  double values[3];
+  double vectors[3][3];
+  double* covarianceRows[3] = { covariance[0], covariance[1], covariance[2] };
+  double* vectorRows[3] = { vectors[0], vectors[1], vectors[2] };
+  vtkMath::Jacobi(covarianceRows, values, vectorRows);
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      axes[i][j] = vectors[j][i];
+    }
+  }
+}
+} // namespace ConnectedComponents
+} // namespace tomviz
@@ -0,0 +1,175 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizConnectedComponents_h
+#define tomvizConnectedComponents_h
+
+#include "ParallelFor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <map>
+#include <vector>
+
+namespace tomviz {
+
+namespace ConnectedComponents {
+
+/// Moments of a labeled object, accumulated while the labels are assigned.
+/// Positions are in voxel indices, conversion to physical units is left to
+/// the caller.
+struct LabelMoments
+{
+  uint64_t count = 0;
+  /// Sums of x, y and z.
+  double sum[3] = { 0.0, 0.0, 0.0 };
+  /// Sums of xx, yy, zz, xy, xz and yz.
+  double sumProducts[6] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+  int min[3] = { std::numeric_limits<int>::max(),
+                 std::numeric_limits<int>::max(),
+                 std::numeric_limits<int>::max() };
+  int max[3] = { -1, -1, -1 };
+  /// Lowest linear index of a voxel in the object, used to order objects of
+  /// the same size.
+  int64_t first = std::numeric_limits<int64_t>::max();
+  /// Faces of the voxels normal to x, y and z that are not shared with
+  /// another voxel of the object, only counted by measure.
+  uint64_t faces[3] = { 0, 0, 0 };
+
+  void add(int x, int y, int z, int64_t index)
+  {
+    ++count;
+    sum[0] += x;
+    sum[1] += y;
+    sum[2] += z;
+    sumProducts[0] += static_cast<double>(x) * x;
+    sumProducts[1] += static_cast<double>(y) * y;
+    sumProducts[2] += static_cast<double>(z) * z;
+    sumProducts[3] += static_cast<double>(x) * y;
+    sumProducts[4] += static_cast<double>(x) * z;
+    sumProducts[5] += static_cast<double>(y) * z;
+    const int pos[3] = { x, y, z };
+    for (int i = 0; i < 3; ++i) {
+      min[i] = pos[i] < min[i] ? pos[i] : min[i];
+      max[i] = pos[i] > max[i] ? pos[i] : max[i];
+    }
+    first = index < first ? index : first;
+  }
+
+  void merge(const LabelMoments& other);
+};
+
+/// Label the face connected (6-connected) components of the non-zero voxels
+/// in labels, in place. On input any non-zero value marks a foreground voxel,
+/// on output each component has its own label in 1..N where N is returned.
+/// Labels are ordered by increasing size, so the largest component has label
+/// N, matching the ITK based Python operator.
+///
+/// The volume is split into z-slabs that are labeled in parallel with their
+/// own union-find, the labels touching across slab boundaries are then merged
+/// and a final parallel pass writes the compact labels. If moments is not
+/// nullptr it is resized to N and filled in, with entry i describing label
+/// i + 1. If canceled returns true the labeling stops early and 0 is returned,
+/// leaving labels in an undefined state.
+uint32_t labelForeground(uint32_t* labels, const int dims[3],
+                         std::vector<LabelMoments>* moments = nullptr,
+                         const std::function<bool()>& canceled = nullptr);
+
+/// Label the connected components of the voxels of input that are not equal
+/// to background, see labelForeground.
+template <typename T>
+uint32_t label(const T* input, const int dims[3], T background,
+               uint32_t* labels, std::vector<LabelMoments>* moments = nullptr,
+               const std::function<bool()>& canceled = nullptr)
+{
+  const int64_t size = static_cast<int64_t>(dims[0]) * dims[1] * dims[2];
+  parallelFor(0, size, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      labels[i] = input[i] != background ? 1 : 0;
+    }
+  });
+  return labelForeground(labels, dims, moments, canceled);
+}
+
+/// Measure every object of an existing label map, keyed by label, voxels of
+/// value 0 are background. Unlike label the objects are not split into
+/// connected components, all the voxels of a label make up its object, and
+/// the faces each object exposes are counted as well. The z-slabs are
+/// measured in parallel and merged. If canceled returns true measuring stops
+/// early and an empty map is returned.
+template <typename T>
+std::map<T, LabelMoments> measure(
+  const T* labels, const int dims[3],
+  const std::function<bool()>& canceled = nullptr)
+{
+  const int64_t nx = dims[0];
+  const int64_t sliceSize = nx * dims[1];
+  const int nSlabs = static_cast<int>(
+    std::min<int64_t>(dims[2], std::max(1u, parallelThreadCount()) * 2));
+  std::vector<std::map<T, LabelMoments>> slabs(std::max(nSlabs, 0));
+  std::atomic<bool> completed(true);
+  parallelFor(0, nSlabs, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t s = begin; s < end; ++s) {
+      auto& objects = slabs[s];
+      const int zBegin = static_cast<int>(dims[2] * s / nSlabs);
+      const int zEnd = static_cast<int>(dims[2] * (s + 1) / nSlabs);
+      // Labels come in runs, so the object of the previous voxel is kept.
+      T last = 0;
+      LabelMoments* moments = nullptr;
+      for (int z = zBegin; z < zEnd; ++z) {
+        if (canceled && canceled()) {
+          completed = false;
+          return;
+        }
+        for (int y = 0; y < dims[1]; ++y) {
+          int64_t index = z * sliceSize + y * nx;
+          for (int x = 0; x < dims[0]; ++x, ++index) {
+            const T value = labels[index];
+            if (value == 0) {
+              continue;
+            }
+            if (!moments || value != last) {
+              moments = &objects[value];
+              last = value;
+            }
+            moments->add(x, y, z, index);
+            moments->faces[0] +=
+              (x == 0 || labels[index - 1] != value) +
+              (x == dims[0] - 1 || labels[index + 1] != value);
+            moments->faces[1] +=
+              (y == 0 || labels[index - nx] != value) +
+              (y == dims[1] - 1 || labels[index + nx] != value);
+            moments->faces[2] +=
+              (z == 0 || labels[index - sliceSize] != value) +
+              (z == dims[2] - 1 || labels[index + sliceSize] != value);
+          }
+        }
+      }
+    }
+  });
+
+  std::map<T, LabelMoments> objects;
+  if (!completed) {
+    return objects;
+  }
+  for (const auto& slab : slabs) {
+    for (const auto& object : slab) {
+      objects[object.first].merge(object.second);
+    }
+  }
+  return objects;
+}
+
+/// The center and principal axes of an object in physical units, from the
+/// covariance of the positions of its voxels. The axes are unit vectors,
+/// ordered from the largest variance to the smallest.
+void principalAxes(const LabelMoments& moments, const double origin[3],
+                   const double spacing[3], double center[3],
+                   double axes[3][3]);
+} // namespace ConnectedComponents
+} // namespace tomviz
+
+#endif
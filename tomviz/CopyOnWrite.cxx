@@ -0,0 +1,128 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "CopyOnWrite.h"
+
+#include <vtkCallbackCommand.h>
+#include <vtkCellData.h>
+#include <vtkDataArray.h>
+#include <vtkFieldData.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+
+#include <map>
+#include <mutex>
+
+namespace tomviz {
+
+namespace CopyOnWrite {
+
+namespace {
+
+// The values of the arrays copy() made share, by array. Arrays leave the map
+// as they are deleted, which may happen while it is locked, hence the
+// recursive mutex.
+std::recursive_mutex sharersMutex;
+std::map<vtkDataArray*, void*> sharers;
+
+void removeSharer(vtkObject* caller, unsigned long, void*, void*)
+{
+  std::lock_guard<std::recursive_mutex> lock(sharersMutex);
+  sharers.erase(static_cast<vtkDataArray*>(caller));
+}
+
+// Record the values array has now, sharersMutex must be locked.
+void addSharer(vtkDataArray* array)
+{
+  auto it = sharers.find(array);
+  if (it != sharers.end()) {
+    it->second = array->GetVoidPointer(0);
+    return;
+  }
+  vtkNew<vtkCallbackCommand> command;
+  command->SetCallback(&removeSharer);
+  array->AddObserver(vtkCommand::DeleteEvent, command.GetPointer());
+  sharers[array] = array->GetVoidPointer(0);
+}
+} // namespace
+
+vtkSmartPointer<vtkImageData> copy(vtkImageData* image)
+{
+  auto output = vtkSmartPointer<vtkImageData>::New();
+  output->CopyStructure(image);
+  output->GetFieldData()->DeepCopy(image->GetFieldData());
+  output->GetCellData()->DeepCopy(image->GetCellData());
+
+  vtkPointData* pointData = image->GetPointData();
+  vtkPointData* outPointData = output->GetPointData();
+  std::lock_guard<std::recursive_mutex> lock(sharersMutex);
+  for (int i = 0; i < pointData->GetNumberOfArrays(); ++i) {
+    vtkAbstractArray* array = pointData->GetAbstractArray(i);
+    if (!array) {
+      continue;
+    }
+    vtkSmartPointer<vtkAbstractArray> outArray;
+    outArray.TakeReference(array->NewInstance());
+    if (auto dataArray = vtkDataArray::SafeDownCast(array)) {
+      // Arrays of values in a single buffer share it, others are copied.
+      auto shared = vtkDataArray::SafeDownCast(outArray);
+      shared->ShallowCopy(dataArray);
+      addSharer(dataArray);
+      addSharer(shared);
+    } else {
+      outArray->DeepCopy(array);
+    }
+    const int index = outPointData->AddArray(outArray);
+    const int attribute = pointData->IsArrayAnAttribute(i);
+    if (attribute >= 0) {
+      outPointData->SetActiveAttribute(index, attribute);
+    }
+  }
+  return output;
+}
+
+bool isShared(vtkDataArray* array)
+{
+  std::lock_guard<std::recursive_mutex> lock(sharersMutex);
+  auto it = sharers.find(array);
+  void* values = it != sharers.end() ? it->second : array->GetVoidPointer(0);
+  if (!values) {
+    return false;
+  }
+  for (auto& sharer : sharers) {
+    if (sharer.first != array && sharer.second == values) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool detach(vtkDataArray* array)
+{
+  if (!array || !isShared(array)) {
+    return false;
+  }
+
+  vtkSmartPointer<vtkDataArray> values;
+  values.TakeReference(array->NewInstance());
+  values->DeepCopy(array);
+  array->ShallowCopy(values);
+
+  std::lock_guard<std::recursive_mutex> lock(sharersMutex);
+  auto it = sharers.find(array);
+  if (it != sharers.end()) {
+    it->second = array->GetVoidPointer(0);
+  }
+  return true;
+}
+
+void detach(vtkImageData* image)
+{
+  vtkPointData* pointData = image->GetPointData();
+  for (int i = 0; i < pointData->GetNumberOfArrays(); ++i) {
+    detach(pointData->GetArray(i));
+  }
+}
+} // namespace CopyOnWrite
+} // namespace tomviz
@@ -0,0 +1,43 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizCopyOnWrite_h
+#define tomvizCopyOnWrite_h
+
+#include <vtkSmartPointer.h>
+
+class vtkDataArray;
+class vtkImageData;
+
+namespace tomviz {
+
+/// Copies of images that share the values of their point arrays until one
+/// side writes into them, so clones, snapshots and the inputs of pipeline
+/// runs take no memory of their own for the arrays they leave untouched.
+///
+/// Data sources replace their arrays rather than write into them, so their
+/// data can share values freely. Code writing into the values of an array in
+/// place, as operators filtering in place do, must detach() the array first:
+/// the values it shares are copied then, only for the arrays written and
+/// only once, as the copy is no longer shared.
+namespace CopyOnWrite {
+
+/// A copy of image whose point arrays share the values of those of image.
+/// The arrays are arrays of their own, so renaming or replacing them leaves
+/// image be, and the field data, such as tilt angles, is copied.
+vtkSmartPointer<vtkImageData> copy(vtkImageData* image);
+
+/// Whether another array shares the values of array.
+bool isShared(vtkDataArray* array);
+
+/// Give array values of its own before writing into them, copying them if
+/// they are shared. Returns whether they were copied.
+bool detach(vtkDataArray* array);
+
+/// Detach every point array of image, for code that may write into any of
+/// them.
+void detach(vtkImageData* image);
+} // namespace CopyOnWrite
+} // namespace tomviz
+
+#endif
@@ -0,0 +1,51 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "CpuVolumeRendering.h"
+
+#include "ParallelFor.h"
+
+#include <vtkFixedPointVolumeRayCastMapper.h>
+#include <vtkImageData.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace tomviz {
+
+namespace CpuVolumeRendering {
+
+void setup(vtkFixedPointVolumeRayCastMapper* mapper, vtkImageData* image)
+{
+  mapper->SetInputData(image);
+  mapper->SetNumberOfThreads(static_cast<int>(parallelThreadCount()));
+
+  double spacing[3] = { 1.0, 1.0, 1.0 };
+  if (image) {
+    image->GetSpacing(spacing);
+  }
+  const double voxel = std::max(
+    std::min(std::min(std::abs(spacing[0]), std::abs(spacing[1])),
+             std::abs(spacing[2])),
+    1e-6);
+  mapper->SetSampleDistance(voxel);
+  mapper->SetInteractiveSampleDistance(2.0 * voxel);
+
+  // The view raises the desired update rate of the render window while
+  // interacting, the mapper then uses the interactive sample distance and
+  // casts rays for one in up to 4x4 pixels to meet it.
+  mapper->AutoAdjustSampleDistancesOn();
+  mapper->SetImageSampleDistance(1.0);
+  mapper->SetMinimumImageSampleDistance(1.0);
+  mapper->SetMaximumImageSampleDistance(4.0);
+  mapper->IntermixIntersectingGeometryOn();
+}
+
+bool supportsBlendMode(int mode)
+{
+  return mode == vtkVolumeMapper::COMPOSITE_BLEND ||
+         mode == vtkVolumeMapper::MAXIMUM_INTENSITY_BLEND ||
+         mode == vtkVolumeMapper::MINIMUM_INTENSITY_BLEND;
+}
+} // namespace CpuVolumeRendering
+} // namespace tomviz
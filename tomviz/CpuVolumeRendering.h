@@ -0,0 +1,30 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizCpuVolumeRendering_h
+#define tomvizCpuVolumeRendering_h
+
+class vtkFixedPointVolumeRayCastMapper;
+class vtkImageData;
+
+namespace tomviz {
+
+/// Volume rendering on the CPU, for render nodes without a GPU where the GPU
+/// ray cast mapper falls back to software OpenGL.
+namespace CpuVolumeRendering {
+
+/// Set up a fixed point ray cast mapper to render an image on all cores.
+/// The mapper keeps a min/max volume of small blocks and skips the blocks
+/// that are transparent under the opacity transfer function, and stops a ray
+/// once it is opaque. Still renders take a sample per voxel, while
+/// interacting samples are twice as far apart and rays are cast for fewer
+/// pixels as needed to keep up with the frame rate the view asks for.
+void setup(vtkFixedPointVolumeRayCastMapper* mapper, vtkImageData* image);
+
+/// Whether the mapper supports a vtkVolumeMapper blend mode, the average
+/// and additive modes of the GPU mapper are not.
+bool supportsBlendMode(int mode);
+} // namespace CpuVolumeRendering
+} // namespace tomviz
+
+#endif
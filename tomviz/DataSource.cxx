@@ -4,11 +4,15 @@
 #include "DataSource.h"
 
 #include "ActiveObjects.h"
+#include "BrickRangeIndex.h"
+#include "CopyOnWrite.h"
 #include "ModuleFactory.h"
 #include "ModuleManager.h"
 #include "Operator.h"
 #include "OperatorFactory.h"
 #include "Pipeline.h"
+#include "StateBundle.h"
+#include "TimeSeries.h"
 #include "Utilities.h"
 
 #include <vtkDataObject.h>
@@ -23,6 +27,7 @@
 #include <vtkTrivialProducer.h>
 #include <vtkTypeInt8Array.h>
 #include <vtkVector.h>
+#include <vtkWeakPointer.h>
 
 #include <vtkPVArrayInformation.h>
 #include <vtkPVDataInformation.h>
@@ -36,9 +41,12 @@
 #include <vtkSMViewProxy.h>
 
 #include <QDebug>
+#include <QFutureWatcher>
 #include <QJsonArray>
 #include <QMap>
+#include <QPointer>
 #include <QTimer>
+#include <QtConcurrent>
 
 #include <cmath>
 #include <cstring>
@@ -88,6 +96,20 @@ public:
   bool UnitsModified = false;
   bool Forkable = true;
 
+  // Indexes belong to arrays rather than to names, so the frames of a time
+  // series each keep the indexes of their arrays.
+  struct IndexEntry
+  {
+    vtkWeakPointer<vtkDataArray> Array;
+    vtkMTimeType ArrayTime = 0;
+    std::shared_ptr<const BrickRangeIndex> Index;
+    // Modification time of the array an index is being built for, zero if
+    // none is.
+    vtkMTimeType BuildTime = 0;
+  };
+  QMap<vtkDataArray*, IndexEntry> BrickRangeIndexes;
+  QPointer<TimeSeries> Series;
+
   // Checks if the tilt angles data array exists on the given VTK data
   // and creates it if it does not exist.
   void ensureTiltAnglesArrayExists()
@@ -342,6 +364,13 @@ QJsonObject DataSource::serialize() const
     }
   }
 
+  if (this->Internals->Series) {
+    // The frames are the files the data source was loaded from.
+    QJsonObject seriesJson;
+    seriesJson["frame"] = this->Internals->Series->currentFrame();
+    json["timeSeries"] = seriesJson;
+  }
+
   // Serialize the color map, opacity map, and others if needed.
   json["colorOpacityMap"] = tomviz::serialize(colorMap());
   json["gradientOpacityMap"] = tomviz::serialize(gradientOpacityMap());
@@ -407,6 +436,11 @@ bool DataSource::deserialize(const QJsonObject& state)
     setSpacing(spacing);
   }
 
+  if (state.contains("timeSeries") && this->Internals->Series) {
+    this->Internals->Series->setCurrentFrame(
+      state["timeSeries"].toObject()["frame"].toInt());
+  }
+
   if (state.contains("units")) {
     auto units = state["units"].toString();
     setUnits(units);
@@ -435,16 +469,29 @@ bool DataSource::deserialize(const QJsonObject& state)
       operatorObj = operatorArray[i].toObject();
       op =
         OperatorFactory::createOperator(operatorObj["type"].toString(), this);
+      if (op) {
+        op->setApplyToAllArrays(operatorObj["applyToAllArrays"].toBool());
+      }
       if (op && op->deserialize(operatorObj)) {
         addOperator(op);
       }
     }
 
+    // A state saved with its results holds the output of the operators, use
+    // it rather than running them if their input is unchanged.
+    QString resultHash;
+    if (op != nullptr && operatorObj.contains("cachedResult")) {
+      resultHash = StateBundle::restoreResult(this, state);
+    }
+
     // If we have a child data source we need to restore it once the data source
     // has been create by the first execution of the pipeline.
     if (op != nullptr && operatorObj.contains("dataSources")) {
-      // We currently support a single child data source.
-      auto dataSourcesState = operatorObj["dataSources"].toArray();
+      // We currently support a single child data source. A branch can use its
+      // own result only if this one was used.
+      auto childState = operatorObj["dataSources"].toArray()[0].toObject();
+      childState["resultOf"] = resultHash;
+      auto dataSourcesState = QJsonArray({ childState });
       auto connection = new QMetaObject::Connection;
       *connection = connect(pipeline(), &Pipeline::finished, op,
                             [connection, dataSourcesState, op]() {
@@ -465,14 +512,22 @@ bool DataSource::deserialize(const QJsonObject& state)
     }
 
     pipeline()->resume(this);
+
+    // Nothing ran, finish as the pipeline would have.
+    if (!resultHash.isEmpty()) {
+      auto p = pipeline();
+      QTimer::singleShot(0, p, [p]() { emit p->finished(); });
+    }
   }
   return true;
 }
 
 DataSource* DataSource::clone() const
 {
-  auto newClone = new DataSource(vtkImageData::SafeDownCast(this->dataObject()),
-                                 this->Internals->Type, this->pipeline());
+  // The clone shares the values of the arrays until either side writes.
+  auto data = CopyOnWrite::copy(vtkImageData::SafeDownCast(dataObject()));
+  auto newClone =
+    new DataSource(data, this->Internals->Type, this->pipeline());
   newClone->setLabel(this->label());
   newClone->setPersistenceState(PersistenceState::Modified);
 
@@ -525,6 +580,16 @@ void DataSource::getRange(double range[2])
     vtkImageData* data = vtkImageData::SafeDownCast(tp->GetOutputDataObject(0));
     if (data) {
       vtkDataArray* arrayPtr = data->GetPointData()->GetScalars();
+      if (arrayPtr && arrayPtr->GetNumberOfComponents() == 1) {
+        // A brick index built for the modules querying value ranges holds
+        // the range already.
+        auto index = brickRangeIndex();
+        if (index && index->range()[0] <= index->range()[1]) {
+          range[0] = index->range()[0];
+          range[1] = index->range()[1];
+          return;
+        }
+      }
       if (arrayPtr) {
         arrayPtr->GetFiniteRange(range, -1);
         return;
@@ -588,7 +653,9 @@ void DataSource::setActiveScalars(const QString& arrayName)
     }
   }
 
-  dataModified();
+  // Switching arrays leaves their values alone, so the ranges and histograms
+  // of the arrays are kept for switching back and forth between channels.
+  markDataModified(false);
 
   emit activeScalarsChanged();
   emit dataPropertiesChanged();
@@ -708,6 +775,99 @@ vtkDataArray* DataSource::getScalarsArray(const QString& arrayName)
   return pointData->GetScalars(arrayName.toLatin1().data());
 }
 
+TimeSeries* DataSource::timeSeries() const
+{
+  return this->Internals->Series;
+}
+
+void DataSource::setTimeSeries(TimeSeries* timeSeries)
+{
+  if (this->Internals->Series == timeSeries) {
+    return;
+  }
+  delete this->Internals->Series;
+  this->Internals->Series = timeSeries;
+  if (timeSeries) {
+    timeSeries->setParent(this);
+  }
+}
+
+std::shared_ptr<const BrickRangeIndex> DataSource::brickRangeIndex(
+  const QString& arrayName)
+{
+  const QString name = arrayName.isEmpty() ? activeScalars() : arrayName;
+  vtkImageData* data = vtkImageData::SafeDownCast(dataObject());
+  vtkDataArray* scalars = data ? getScalarsArray(name) : nullptr;
+  auto it = this->Internals->BrickRangeIndexes.find(scalars);
+  if (!scalars || it == this->Internals->BrickRangeIndexes.end()) {
+    return nullptr;
+  }
+
+  // Arrays modified in place without a call to dataModified() are caught by
+  // their modification time, and new arrays at the address of a deleted one
+  // by the weak pointer.
+  if (it->Array != scalars || it->ArrayTime != scalars->GetMTime()) {
+    return nullptr;
+  }
+  return it->Index;
+}
+
+void DataSource::buildBrickRangeIndex(const QString& arrayName)
+{
+  const QString name = arrayName.isEmpty() ? activeScalars() : arrayName;
+  vtkImageData* data = vtkImageData::SafeDownCast(dataObject());
+  vtkSmartPointer<vtkDataArray> scalars =
+    data ? getScalarsArray(name) : nullptr;
+  if (!scalars) {
+    return;
+  }
+  // Drop the indexes of arrays that were deleted, such as those of frames
+  // evicted from the frame cache of a time series.
+  auto& indexes = this->Internals->BrickRangeIndexes;
+  for (auto it = indexes.begin(); it != indexes.end();) {
+    it = it->Array ? it + 1 : indexes.erase(it);
+  }
+  auto& entry = indexes[scalars];
+  const vtkMTimeType time = scalars->GetMTime();
+  if (entry.Array == scalars &&
+      ((entry.Index && entry.ArrayTime == time) || entry.BuildTime == time)) {
+    return;
+  }
+  entry.Array = scalars;
+  entry.BuildTime = time;
+
+  int dims[3];
+  data->GetDimensions(dims);
+  using Index = std::shared_ptr<const BrickRangeIndex>;
+  auto watcher = new QFutureWatcher<Index>(this);
+  connect(watcher, &QFutureWatcherBase::finished, this,
+          [this, watcher, name, scalars, time]() {
+            Index index = watcher->result();
+            watcher->deleteLater();
+            // Dropped if the data was modified while it was built.
+            auto it = this->Internals->BrickRangeIndexes.find(scalars);
+            if (it == this->Internals->BrickRangeIndexes.end()) {
+              return;
+            }
+            auto& built = *it;
+            if (built.Array != scalars || built.BuildTime != time ||
+                scalars->GetMTime() != time) {
+              return;
+            }
+            built.BuildTime = 0;
+            built.Index = index;
+            built.ArrayTime = time;
+            if (getScalarsArray(name) == scalars) {
+              emit brickRangeIndexReady(name);
+            }
+          });
+  watcher->setFuture(QtConcurrent::run([scalars, dims]() -> Index {
+    auto index = std::make_shared<BrickRangeIndex>();
+    index->build(scalars, dims);
+    return index;
+  }));
+}
+
 unsigned int DataSource::getNumberOfComponents()
 {
   unsigned int numComponents = 0;
@@ -818,6 +978,11 @@ bool DataSource::removeAllOperators()
 }
 
 void DataSource::dataModified()
+{
+  markDataModified(true);
+}
+
+void DataSource::markDataModified(bool valuesChanged)
 {
   vtkTrivialProducer* tp = producer();
   if (tp == nullptr) {
@@ -827,6 +992,19 @@ void DataSource::dataModified()
   tp->Modified();
   vtkDataObject* dObject = tp->GetOutputDataObject(0);
   dObject->Modified();
+  if (valuesChanged) {
+    // Arrays are often written to in place, mark them so anything cached
+    // for an array is computed again.
+    if (auto image = vtkImageData::SafeDownCast(dObject)) {
+      vtkPointData* pointData = image->GetPointData();
+      for (int i = 0; i < pointData->GetNumberOfArrays(); ++i) {
+        if (auto array = pointData->GetArray(i)) {
+          array->Modified();
+          this->Internals->BrickRangeIndexes.remove(array);
+        }
+      }
+    }
+  }
   this->Internals->ProducerProxy->MarkModified(nullptr);
 
   vtkFieldData* fd = dObject->GetFieldData();
@@ -895,6 +1073,11 @@ vtkDataObject* DataSource::copyData()
 {
   this->Internals->ProducerProxy->UpdatePipeline();
   vtkDataObject* data = dataObject();
+  if (auto image = vtkImageData::SafeDownCast(data)) {
+    auto copy = CopyOnWrite::copy(image);
+    copy->Register(nullptr);
+    return copy;
+  }
   vtkDataObject* copy = data->NewInstance();
   copy->DeepCopy(data);
 
@@ -947,6 +1130,23 @@ void DataSource::copyData(vtkDataObject* newData)
   emit activeScalarsChanged();
 }
 
+void DataSource::swapData(vtkDataObject* newData)
+{
+  vtkDataObject* current = dataObject();
+  if (current && current != newData) {
+    vtkFieldData* from = current->GetFieldData();
+    vtkFieldData* to = newData->GetFieldData();
+    for (int i = 0; i < from->GetNumberOfArrays(); ++i) {
+      vtkAbstractArray* array = from->GetAbstractArray(i);
+      if (array && array->GetName() && !to->HasArray(array->GetName())) {
+        to->AddArray(array);
+      }
+    }
+  }
+  setData(newData);
+  markDataModified(false);
+}
+
 vtkSMProxy* DataSource::colorMap() const
 {
   return this->Internals->ColorMap;
@@ -13,6 +13,8 @@
 
 #include <vtkRect.h>
 
+#include <memory>
+
 class vtkSMProxy;
 class vtkSMSourceProxy;
 class vtkImageData;
@@ -23,8 +25,10 @@ class vtkAlgorithm;
 class vtkTrivialProducer;
 
 namespace tomviz {
+class BrickRangeIndex;
 class Operator;
 class Pipeline;
+class TimeSeries;
 
 /// Encapsulation for a DataSource. This class manages a data source, including
 /// the provenance for any operations performed on the data source.
@@ -189,6 +193,26 @@ public:
   // Get pointer to scalar array
   vtkDataArray* getScalarsArray(const QString& arrayName);
 
+  /// Per brick minimum and maximum of the first component of a point array,
+  /// the active scalars by default, so value range queries can skip the
+  /// bricks that can not hold a value in the range. Returns nullptr if there
+  /// is no such array, or its index was not built since it was last
+  /// modified.
+  std::shared_ptr<const BrickRangeIndex> brickRangeIndex(
+    const QString& arrayName = QString());
+
+  /// Build the brick index of a point array, the active scalars by default,
+  /// on a worker thread. brickRangeIndexReady() is emitted once it can be
+  /// retrieved. Does nothing if the index is current or being built.
+  void buildBrickRangeIndex(const QString& arrayName = QString());
+
+  /// The time series whose current frame is the data of the data source, or
+  /// nullptr if the data source is a single volume.
+  TimeSeries* timeSeries() const;
+  /// Set the time series of the data source, the data source takes ownership
+  /// of it and its current frame should be the data of the data source.
+  void setTimeSeries(TimeSeries* timeSeries);
+
   /// Returns the number of components in the dataset.
   unsigned int getNumberOfComponents();
 
@@ -215,6 +239,13 @@ public:
   /// Copy data from a data object to the existing data.
   void copyData(vtkDataObject* newData);
 
+  /// Show a data object computed earlier in place of the data, such as a
+  /// frame of a time series. The field data of the current data, its type
+  /// among others, carries over to the new data where it has none. Its
+  /// arrays are taken as unchanged, so their ranges, histograms and brick
+  /// indexes are kept.
+  void swapData(vtkDataObject* newData);
+
   bool unitsModified();
 
   // Returns true if the data source is not associated with a file, false
@@ -255,6 +286,10 @@ signals:
   /// to translate the dataset.
   void displayPositionChanged(double newX, double newY, double newZ);
 
+  /// Fired when the brick index of an array requested with
+  /// buildBrickRangeIndex() is available.
+  void brickRangeIndexReady(const QString& arrayName);
+
 public slots:
   void dataModified();
   void renameScalarsArray(const QString& oldName, const QString& newName);
@@ -270,6 +305,11 @@ private:
 
   vtkAlgorithm* algorithm() const;
 
+  /// Notify the pipeline and the modules of a change to the data. When the
+  /// values may have changed the arrays are marked as modified, dropping the
+  /// ranges and histograms computed from them.
+  void markDataModified(bool valuesChanged);
+
   Q_DISABLE_COPY(DataSource)
 
   class DSInternals;
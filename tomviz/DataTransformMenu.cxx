@@ -8,6 +8,7 @@
 #include <QMenu>
 
 #include "AddExpressionReaction.h"
+#include "AddOperatorReaction.h"
 #include "AddPythonTransformReaction.h"
 #include "CloneDataReaction.h"
 #include "ConvertToFloatReaction.h"
@@ -90,11 +91,8 @@ void DataTransformMenu::buildTransforms()
   new AddPythonTransformReaction(padVolumeAction, "Pad Volume",
                                  readInPythonScript("Pad_Data"), false, false,
                                  false, readInJSONDescription("Pad_Data"));
-  new AddPythonTransformReaction(downsampleByTwoAction, "Bin Volume x2",
-                                 readInPythonScript("BinVolumeByTwo"));
-  new AddPythonTransformReaction(resampleAction, "Resample",
-                                 readInPythonScript("Resample"), false, false,
-                                 false, readInJSONDescription("Resample"));
+  new AddOperatorReaction(downsampleByTwoAction, "Bin");
+  new AddOperatorReaction(resampleAction, "Resample");
   new AddPythonTransformReaction(rotateAction, "Rotate",
                                  readInPythonScript("Rotate3D"), false, false,
                                  false, readInJSONDescription("Rotate3D"));
@@ -120,9 +118,7 @@ void DataTransformMenu::buildTransforms()
   new AddPythonTransformReaction(gradientMagnitudeSobelAction,
                                  "Gradient Magnitude",
                                  readInPythonScript("GradientMagnitude_Sobel"));
-  new AddPythonTransformReaction(
-    unsharpMaskAction, "Unsharp Mask", readInPythonScript("UnsharpMask"), false,
-    false, false, readInJSONDescription("UnsharpMask"));
+  new AddOperatorReaction(unsharpMaskAction, "UnsharpMask");
   new AddPythonTransformReaction(laplaceFilterAction, "Laplace Sharpen",
                                  readInPythonScript("LaplaceFilter"));
   new AddPythonTransformReaction(
@@ -131,17 +127,13 @@ void DataTransformMenu::buildTransforms()
   new AddPythonTransformReaction(TVminAction, "TV_Filter",
                                  readInPythonScript("TV_Filter"), false, false,
                                  false, readInJSONDescription("TV_Filter"));
-  new AddPythonTransformReaction(
-    gaussianFilterAction, "Gaussian Blur", readInPythonScript("GaussianFilter"),
-    false, false, false, readInJSONDescription("GaussianFilter"));
+  new AddOperatorReaction(gaussianFilterAction, "GaussianFilter");
   new AddPythonTransformReaction(
     peronaMalikeAnisotropicDiffusionAction,
     "Perona-Malik Anisotropic Diffusion",
     readInPythonScript("PeronaMalikAnisotropicDiffusion"), false, false, false,
     readInJSONDescription("PeronaMalikAnisotropicDiffusion"));
-  new AddPythonTransformReaction(
-    medianFilterAction, "Median Filter", readInPythonScript("MedianFilter"),
-    false, false, false, readInJSONDescription("MedianFilter"));
+  new AddOperatorReaction(medianFilterAction, "MedianFilter");
   new AddPythonTransformReaction(
     moleculeAction, "Add Molecule", readInPythonScript("DummyMolecule"), false,
     false, false, readInJSONDescription("DummyMolecule"));
@@ -190,35 +182,20 @@ void DataTransformMenu::buildSegmentation()
     otsuMultipleThresholdAction, "Otsu Multiple Threshold",
     readInPythonScript("OtsuMultipleThreshold"), false, false, false,
     readInJSONDescription("OtsuMultipleThreshold"));
-  new AddPythonTransformReaction(
-    connectedComponentsAction, "Connected Components",
-    readInPythonScript("ConnectedComponents"), false, false, false,
-    readInJSONDescription("ConnectedComponents"));
-  new AddPythonTransformReaction(
-    binaryDilateAction, "Binary Dilate", readInPythonScript("BinaryDilate"),
-    false, false, false, readInJSONDescription("BinaryDilate"));
-  new AddPythonTransformReaction(
-    binaryErodeAction, "Binary Erode", readInPythonScript("BinaryErode"), false,
-    false, false, readInJSONDescription("BinaryErode"));
-  new AddPythonTransformReaction(binaryOpenAction, "Binary Open",
-                                 readInPythonScript("BinaryOpen"), false, false,
-                                 false, readInJSONDescription("BinaryOpen"));
-  new AddPythonTransformReaction(
-    binaryCloseAction, "Binary Close", readInPythonScript("BinaryClose"), false,
-    false, false, readInJSONDescription("BinaryClose"));
+  new AddOperatorReaction(connectedComponentsAction, "ConnectedComponents");
+  new AddOperatorReaction(binaryDilateAction, "BinaryDilate");
+  new AddOperatorReaction(binaryErodeAction, "BinaryErode");
+  new AddOperatorReaction(binaryOpenAction, "BinaryOpen");
+  new AddOperatorReaction(binaryCloseAction, "BinaryClose");
   new AddPythonTransformReaction(
     binaryMinMaxCurvatureFlowAction, "Binary MinMax Curvature Flow",
     readInPythonScript("BinaryMinMaxCurvatureFlow"), false, false, false,
     readInJSONDescription("BinaryMinMaxCurvatureFlow"));
 
-  new AddPythonTransformReaction(
-    labelObjectAttributesAction, "Label Object Attributes",
-    readInPythonScript("LabelObjectAttributes"), false, false, false,
-    readInJSONDescription("LabelObjectAttributes"));
-  new AddPythonTransformReaction(
-    labelObjectPrincipalAxesAction, "Label Object Principal Axes",
-    readInPythonScript("LabelObjectPrincipalAxes"), false, false, false,
-    readInJSONDescription("LabelObjectPrincipalAxes"));
+  new AddOperatorReaction(labelObjectAttributesAction,
+                          "LabelObjectAttributes");
+  new AddOperatorReaction(labelObjectPrincipalAxesAction,
+                          "LabelObjectPrincipalAxes");
   new AddPythonTransformReaction(
     distanceFromAxisAction, "Label Object Distance From Principal Axis",
     readInPythonScript("LabelObjectDistanceFromPrincipalAxis"), false, false,
@@ -16,7 +16,10 @@
 
 #include "vtk_hdf5.h"
 
+#include <algorithm>
 #include <cassert>
+#include <functional>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -33,7 +36,8 @@ namespace tomviz {
  */
 template <typename T>
 bool writeVolume(T* buffer, hid_t groupId, const char* name, hid_t dataspaceId,
-                 hid_t dataTypeId, hid_t memTypeId)
+                 hid_t dataTypeId, hid_t memTypeId,
+                 const std::function<bool(double)>& progress)
 {
   bool success = true;
   hid_t dataId = H5Dcreate(groupId, name, dataTypeId, dataspaceId, H5P_DEFAULT,
@@ -41,12 +45,34 @@ bool writeVolume(T* buffer, hid_t groupId, const char* name, hid_t dataspaceId,
   if (dataId < 0) { // Failed to create object.
     return false;
   }
-  hid_t status =
-    H5Dwrite(dataId, memTypeId, H5S_ALL, H5S_ALL, H5P_DEFAULT, buffer);
-  if (status < 0) {
-    success = false;
+
+  // Write slabs of about 64 MB along the slowest axis, so progress can be
+  // reported, and the write stopped, between them.
+  hsize_t dims[3];
+  H5Sget_simple_extent_dims(dataspaceId, dims, nullptr);
+  const hsize_t planeSize = dims[1] * dims[2];
+  const hsize_t slabPlanes = std::max<hsize_t>(
+    1, (hsize_t(64) << 20) / std::max<hsize_t>(planeSize * sizeof(T), 1));
+  for (hsize_t plane = 0; plane < dims[0] && success; plane += slabPlanes) {
+    const hsize_t start[3] = { plane, 0, 0 };
+    const hsize_t count[3] = { std::min(slabPlanes, dims[0] - plane), dims[1],
+                               dims[2] };
+    hid_t memspaceId = H5Screate_simple(3, count, nullptr);
+    H5Sselect_hyperslab(dataspaceId, H5S_SELECT_SET, start, nullptr, count,
+                        nullptr);
+    hid_t status = H5Dwrite(dataId, memTypeId, memspaceId, dataspaceId,
+                            H5P_DEFAULT, buffer + plane * planeSize);
+    H5Sclose(memspaceId);
+    if (status < 0) {
+      success = false;
+    } else if (progress &&
+               !progress(static_cast<double>(plane + count[0]) / dims[0])) {
+      success = false;
+    }
   }
-  status = H5Dclose(dataId);
+  H5Sselect_all(dataspaceId);
+
+  hid_t status = H5Dclose(dataId);
   if (status < 0) {
     success = false;
   }
@@ -275,7 +301,8 @@ public:
   }
 
   bool writeData(const std::string& group, const std::string& name,
-                 vtkImageData* data)
+                 vtkImageData* data,
+                 const std::function<bool(double)>& progress = nullptr)
   {
     bool success = true;
     hsize_t h5dim[3];
@@ -332,7 +359,8 @@ public:
     switch (data->GetScalarType()) {
       vtkTemplateMacro(success =
                          writeVolume((VTK_TT*)(dataPtr), groupId, name.c_str(),
-                                     dataspaceId, dataTypeId, memTypeId));
+                                     dataspaceId, dataTypeId, memTypeId,
+                                     progress));
       default:
         success = false;
     }
@@ -537,35 +565,73 @@ public:
     return result;
   }
 
-  std::string firstEmdNode()
+  std::vector<std::string> emdNodes(bool firstOnly = false)
   {
-    // Find the first valid EMD node, and return its path.
+    // Find the valid EMD nodes, and return their paths.
+    std::vector<std::string> result;
     int emdVersion = 1;
     std::vector<std::string> firstLevel = children("/");
     for (size_t i = 0; i < firstLevel.size(); ++i) {
       std::vector<std::string> nodes = children("/" + firstLevel[i]);
       for (size_t j = 0; j < nodes.size(); ++j) {
         std::string path = "/" + firstLevel[i] + "/" + nodes[j];
-        if (attribute(path, "emd_group_type", emdVersion)) {
-          return path;
-        }
+        bool isEmdNode = attribute(path, "emd_group_type", emdVersion);
         // This is a little hackish, some EMDs don't use the attribute.
         std::vector<std::string> third = children(path);
-        for (size_t k = 0; k < third.size(); ++k) {
-          if (third[k] == "data") {
-            return path;
+        for (size_t k = 0; !isEmdNode && k < third.size(); ++k) {
+          isEmdNode = third[k] == "data";
+        }
+        if (isEmdNode) {
+          result.push_back(path);
+          if (firstOnly) {
+            return result;
           }
         }
       }
     }
-    return "";
+    return result;
+  }
+
+  std::string firstEmdNode()
+  {
+    std::vector<std::string> nodes = emdNodes(true);
+    return nodes.empty() ? "" : nodes[0];
   }
 };
 
+namespace {
+
+// The HDF5 library built with VTK is not thread safe. Files are read and
+// written from worker threads, by background saves and time series, so every
+// entry point holds this while it calls into HDF5.
+std::mutex hdf5Mutex;
+} // namespace
+
 EmdFormat::EmdFormat() : d(new Private) {}
 
 bool EmdFormat::read(const std::string& fileName, vtkImageData* image)
 {
+  return read(fileName, std::string(), image);
+}
+
+std::vector<std::string> EmdFormat::nodes(const std::string& fileName)
+{
+  std::lock_guard<std::mutex> lock(hdf5Mutex);
+  d->fileId = H5Fopen(fileName.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+  if (d->fileId < 0) {
+    d->fileId = H5I_INVALID_HID;
+    return std::vector<std::string>();
+  }
+  std::vector<std::string> result = d->emdNodes();
+  H5Fclose(d->fileId);
+  d->fileId = H5I_INVALID_HID;
+  return result;
+}
+
+bool EmdFormat::read(const std::string& fileName, const std::string& node,
+                     vtkImageData* image)
+{
+  std::lock_guard<std::mutex> lock(hdf5Mutex);
   d->fileId = H5Fopen(fileName.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
 
   int version[2];
@@ -576,7 +642,7 @@ bool EmdFormat::read(const std::string& fileName, vtkImageData* image)
     cout << "Failed to find version_minor" << endl;
   }
 
-  std::string emdNode = d->firstEmdNode();
+  std::string emdNode = node.empty() ? d->firstEmdNode() : node;
   std::string emdDataNode = emdNode + "/data";
 
   if (emdNode.length() == 0) {
@@ -654,8 +720,10 @@ bool EmdFormat::write(const std::string& fileName, DataSource* source)
   return this->write(fileName, image);
 }
 
-bool EmdFormat::write(const std::string& fileName, vtkImageData* image)
+bool EmdFormat::write(const std::string& fileName, vtkImageData* image,
+                      const std::function<bool(double)>& progress)
 {
+  std::lock_guard<std::mutex> lock(hdf5Mutex);
   d->fileId =
     H5Fcreate(fileName.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
 
@@ -709,7 +777,14 @@ bool EmdFormat::write(const std::string& fileName, vtkImageData* image)
     }
   }
 
-  d->writeData("/data/tomography", "data", image);
+  if (!d->writeData("/data/tomography", "data", image, progress)) {
+    H5Gclose(tomoGroupId);
+    H5Gclose(dataGroupId);
+    H5Gclose(groupId);
+    H5Fclose(d->fileId);
+    d->fileId = H5I_INVALID_HID;
+    return false;
+  }
 
   // Create the 3 dim sets too...
   std::vector<int> side(1);
@@ -4,7 +4,9 @@
 #ifndef tomvizEmdFormat_h
 #define tomvizEmdFormat_h
 
+#include <functional>
 #include <string>
+#include <vector>
 
 class vtkImageData;
 
@@ -12,6 +14,8 @@ namespace tomviz {
 
 class DataSource;
 
+/// Reads and writes EMD files. HDF5 calls are serialized, so files can be
+/// read and written from several threads at once.
 class EmdFormat
 {
 public:
@@ -19,8 +23,18 @@ public:
   ~EmdFormat();
 
   bool read(const std::string& fileName, vtkImageData* data);
+  /// Read the volume of an EMD group (node), such as "/data/tomography", of a
+  /// file that holds several volumes. An empty node reads the first one.
+  bool read(const std::string& fileName, const std::string& node,
+            vtkImageData* data);
+
+  /// The paths of the EMD groups holding a volume in a file, in file order.
+  std::vector<std::string> nodes(const std::string& fileName);
   bool write(const std::string& fileName, DataSource* source);
-  bool write(const std::string& fileName, vtkImageData* image);
+  /// Write image, calling progress, if set, with the fraction of the volume
+  /// written so far. The write stops, failing, when progress returns false.
+  bool write(const std::string& fileName, vtkImageData* image,
+             const std::function<bool(double)>& progress = nullptr);
 
 private:
   class Private;
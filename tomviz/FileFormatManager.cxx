@@ -2,19 +2,52 @@
    It is released under the 3-Clause BSD License, see "LICENSE". */
 
 #include "FileFormatManager.h"
+#include "NpyFormat.h"
 #include "PythonReader.h"
 #include "PythonUtilities.h"
 #include "PythonWriter.h"
 #include <QDebug>
+#include <QSet>
 
 namespace tomviz {
 
+QString NativeFileFormat::fileDialogFilter() const
+{
+  QStringList patterns;
+  foreach (auto extension, extensions()) {
+    patterns << QString("*.%1").arg(extension);
+  }
+  return QString("%1 (%2)").arg(description()).arg(patterns.join(" "));
+}
+
 FileFormatManager& FileFormatManager::instance()
 {
   static FileFormatManager theInstance;
   return theInstance;
 }
 
+FileFormatManager::FileFormatManager()
+{
+  registerNativeFormat(new NpyFormat);
+}
+
+void FileFormatManager::registerNativeFormat(NativeFileFormat* format)
+{
+  foreach (auto extension, format->extensions()) {
+    m_nativeExtFormatMap[extension] = format;
+  }
+}
+
+QList<NativeFileFormat*> FileFormatManager::nativeFormats()
+{
+  return m_nativeExtFormatMap.values().toSet().values();
+}
+
+NativeFileFormat* FileFormatManager::nativeFormat(const QString& ext)
+{
+  return m_nativeExtFormatMap.value(ext, nullptr);
+}
+
 template <typename T>
 void registerFactories(const QString& registerFunction,
                        QMap<QString, T*>& factories)
@@ -82,7 +115,14 @@ void FileFormatManager::registerPythonWriters()
 
 QList<PythonReaderFactory*> FileFormatManager::pythonReaderFactories()
 {
-  return m_pythonExtReaderMap.values().toSet().values();
+  QSet<PythonReaderFactory*> factories;
+  for (auto it = m_pythonExtReaderMap.begin(); it != m_pythonExtReaderMap.end();
+       ++it) {
+    if (!m_nativeExtFormatMap.contains(it.key())) {
+      factories.insert(it.value());
+    }
+  }
+  return factories.values();
 }
 
 PythonReaderFactory* FileFormatManager::pythonReaderFactory(const QString& ext)
@@ -92,7 +132,14 @@ PythonReaderFactory* FileFormatManager::pythonReaderFactory(const QString& ext)
 
 QList<PythonWriterFactory*> FileFormatManager::pythonWriterFactories()
 {
-  return m_pythonExtWriterMap.values().toSet().values();
+  QSet<PythonWriterFactory*> factories;
+  for (auto it = m_pythonExtWriterMap.begin(); it != m_pythonExtWriterMap.end();
+       ++it) {
+    if (!m_nativeExtFormatMap.contains(it.key())) {
+      factories.insert(it.value());
+    }
+  }
+  return factories.values();
 }
 
 PythonWriterFactory* FileFormatManager::pythonWriterFactory(const QString& ext)
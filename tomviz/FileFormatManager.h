@@ -7,18 +7,47 @@
 #include <QList>
 #include <QMap>
 #include <QString>
+#include <QStringList>
+
+#include <functional>
+
+class vtkImageData;
 
 namespace tomviz {
 
 class PythonReaderFactory;
 class PythonWriterFactory;
 
+/// A file format read and written in C++. Native formats take precedence
+/// over Python readers and writers of the same extensions.
+class NativeFileFormat
+{
+public:
+  /// Called with the fraction written so far, the write stops, failing,
+  /// when it returns false.
+  using Progress = std::function<bool(double fraction)>;
+
+  virtual ~NativeFileFormat() = default;
+
+  virtual QString description() const = 0;
+  virtual QStringList extensions() const = 0;
+  QString fileDialogFilter() const;
+
+  virtual bool read(const QString& fileName, vtkImageData* image) = 0;
+  virtual bool write(const QString& fileName, vtkImageData* image,
+                     const Progress& progress = nullptr) = 0;
+};
+
 class FileFormatManager
 {
 
 public:
   static FileFormatManager& instance();
 
+  // The native formats, registered on construction
+  QList<NativeFileFormat*> nativeFormats();
+  NativeFileFormat* nativeFormat(const QString& ext);
+
   // Fetch the available python readers
   void registerPythonReaders();
 
@@ -32,6 +61,10 @@ public:
   PythonWriterFactory* pythonWriterFactory(const QString& ext);
 
 private:
+  FileFormatManager();
+  void registerNativeFormat(NativeFileFormat* format);
+
+  QMap<QString, NativeFileFormat*> m_nativeExtFormatMap;
   QMap<QString, PythonReaderFactory*> m_pythonExtReaderMap;
   QMap<QString, PythonWriterFactory*> m_pythonExtWriterMap;
 };
@@ -0,0 +1,78 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "GradientMagnitude.h"
+
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkPointData.h>
+
+#include <mutex>
+
+namespace tomviz {
+
+void GradientMagnitude::reset(const int dims[3], const double spacing[3])
+{
+  double average = 0.0;
+  for (int i = 0; i < 3; ++i) {
+    m_dims[i] = std::max(dims[i], 0);
+    average += std::abs(spacing[i]) / 3.0;
+  }
+  // Central differences span two points, the gradient is in units of the
+  // average spacing.
+  for (int i = 0; i < 3; ++i) {
+    const double s = std::abs(spacing[i]);
+    m_factor[i] = s > 0.0 && average > 0.0 ? average / (2.0 * s) : 0.5;
+  }
+  m_maximum = 0.0;
+  m_step = 0.0;
+  m_floats.clear();
+  m_floats.shrink_to_fit();
+  m_shorts.clear();
+  m_shorts.shrink_to_fit();
+  m_bytes.clear();
+  m_bytes.shrink_to_fit();
+}
+
+void GradientMagnitude::build(vtkImageData* image)
+{
+  vtkDataArray* scalars =
+    image ? image->GetPointData()->GetScalars() : nullptr;
+  const double unit[3] = { 1.0, 1.0, 1.0 };
+  if (!scalars) {
+    const int none[3] = { 0, 0, 0 };
+    reset(none, unit);
+    return;
+  }
+  int dims[3];
+  double spacing[3];
+  image->GetDimensions(dims);
+  image->GetSpacing(spacing);
+  switch (scalars->GetDataType()) {
+    vtkTemplateMacro(
+      build(static_cast<const VTK_TT*>(scalars->GetVoidPointer(0)),
+            scalars->GetNumberOfComponents(), dims, spacing));
+  }
+}
+
+void GradientMagnitude::histogram(double maximum, int bins,
+                                  uint64_t* pops) const
+{
+  if (bins <= 0 || isEmpty()) {
+    return;
+  }
+  const double scale = maximum > 0.0 ? bins / maximum : 0.0;
+  std::mutex mutex;
+  parallelFor(0, size(), [&](int64_t begin, int64_t end) {
+    std::vector<uint64_t> local(bins, 0);
+    for (int64_t i = begin; i < end; ++i) {
+      const int bin = static_cast<int>(value(i) * scale);
+      ++local[std::min(bin, bins - 1)];
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    for (int bin = 0; bin < bins; ++bin) {
+      pops[bin] += local[bin];
+    }
+  });
+}
+} // namespace tomviz
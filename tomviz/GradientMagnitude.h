@@ -0,0 +1,215 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizGradientMagnitude_h
+#define tomvizGradientMagnitude_h
+
+#include "ParallelFor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+class vtkImageData;
+
+namespace tomviz {
+
+/// Gradient magnitude of the first component of an image array, computed
+/// once so the 2D histogram and the gradient histogram do not each take a
+/// pass over the volume. Gradients are central differences, one sided on the
+/// boundaries, with the spacing along each axis relative to the average
+/// spacing, which is the scale the volume mapper's 2D transfer function
+/// expects. The magnitudes may be quantized to 8 or 16 bits of the largest
+/// one to save memory. Non-finite gradients are stored as zero.
+class GradientMagnitude
+{
+public:
+  enum class Storage
+  {
+    Float,
+    UnsignedShort,
+    UnsignedChar
+  };
+
+  explicit GradientMagnitude(Storage storage = Storage::Float)
+    : m_storage(storage)
+  {
+  }
+
+  /// Build from the active scalars of an image, the rows of the image are
+  /// visited in parallel.
+  void build(vtkImageData* image);
+  template <typename T>
+  void build(const T* data, int nComps, const int dims[3],
+             const double spacing[3]);
+
+  bool isEmpty() const { return size() == 0; }
+  Storage storage() const { return m_storage; }
+
+  /// Point dimensions of the image.
+  const int* dimensions() const { return m_dims; }
+  int64_t size() const
+  {
+    return static_cast<int64_t>(m_dims[0]) * m_dims[1] * m_dims[2];
+  }
+
+  /// Largest gradient magnitude, zero for an empty or constant image.
+  double maximum() const { return m_maximum; }
+
+  /// Gradient magnitude at a point, to within the quantization step.
+  double value(int64_t i) const
+  {
+    switch (m_storage) {
+      case Storage::UnsignedShort:
+        return m_shorts[i] * m_step;
+      case Storage::UnsignedChar:
+        return m_bytes[i] * m_step;
+      default:
+        return m_floats[i];
+    }
+  }
+
+  /// Difference between consecutive quantized magnitudes, 0 for floats.
+  double step() const { return m_step; }
+
+  /// Add the number of magnitudes in each of bins equal bins over
+  /// [0, maximum] to pops, larger magnitudes go in the last bin.
+  void histogram(double maximum, int bins, uint64_t* pops) const;
+
+  /// Memory used by the magnitudes, in bytes.
+  size_t memorySize() const
+  {
+    return m_floats.capacity() * sizeof(float) +
+           m_shorts.capacity() * sizeof(uint16_t) + m_bytes.capacity();
+  }
+
+private:
+  void reset(const int dims[3], const double spacing[3]);
+  template <typename T>
+  void rowMagnitudes(const T* data, int nComps, int64_t row,
+                     float* magnitudes) const;
+  template <typename Q>
+  void quantize(const std::vector<float>& magnitudes, int64_t row,
+                double levels, std::vector<Q>& values) const;
+
+  Storage m_storage;
+  int m_dims[3] = { 0, 0, 0 };
+  double m_factor[3] = { 0.5, 0.5, 0.5 };
+  double m_maximum = 0.0;
+  double m_step = 0.0;
+  std::vector<float> m_floats;
+  std::vector<uint16_t> m_shorts;
+  std::vector<uint8_t> m_bytes;
+};
+
+template <typename T>
+void GradientMagnitude::rowMagnitudes(const T* data, int nComps, int64_t row,
+                                      float* magnitudes) const
+{
+  const int64_t nx = m_dims[0];
+  const int64_t ny = m_dims[1];
+  const int64_t nz = m_dims[2];
+  const int64_t y = row % ny;
+  const int64_t z = row / ny;
+  const T* p = data + row * nx * nComps;
+
+  // Neighboring rows along y and z, the row itself on a boundary where the
+  // difference is one sided and covers half the distance.
+  const int64_t strideY = nx * nComps;
+  const int64_t strideZ = nx * ny * nComps;
+  const T* yLow = y > 0 ? p - strideY : p;
+  const T* yHigh = y < ny - 1 ? p + strideY : p;
+  const double fy = (y > 0 && y < ny - 1) ? m_factor[1] : 2.0 * m_factor[1];
+  const T* zLow = z > 0 ? p - strideZ : p;
+  const T* zHigh = z < nz - 1 ? p + strideZ : p;
+  const double fz = (z > 0 && z < nz - 1) ? m_factor[2] : 2.0 * m_factor[2];
+
+  for (int64_t x = 0; x < nx; ++x) {
+    const int64_t xLow = x > 0 ? x - 1 : x;
+    const int64_t xHigh = x < nx - 1 ? x + 1 : x;
+    const double fx = xHigh - xLow == 2 ? m_factor[0] : 2.0 * m_factor[0];
+    const int64_t i = x * nComps;
+    const double dx = (static_cast<double>(p[xHigh * nComps]) -
+                       static_cast<double>(p[xLow * nComps])) *
+                      fx;
+    const double dy =
+      (static_cast<double>(yHigh[i]) - static_cast<double>(yLow[i])) * fy;
+    const double dz =
+      (static_cast<double>(zHigh[i]) - static_cast<double>(zLow[i])) * fz;
+    const double magnitude = std::sqrt(dx * dx + dy * dy + dz * dz);
+    magnitudes[x] = std::isfinite(magnitude) ? static_cast<float>(magnitude)
+                                             : 0.f;
+  }
+}
+
+template <typename Q>
+void GradientMagnitude::quantize(const std::vector<float>& magnitudes,
+                                 int64_t row, double levels,
+                                 std::vector<Q>& values) const
+{
+  const double scale = m_step > 0.0 ? 1.0 / m_step : 0.0;
+  Q* out = values.data() + row * m_dims[0];
+  for (int x = 0; x < m_dims[0]; ++x) {
+    out[x] = static_cast<Q>(std::min(levels, magnitudes[x] * scale + 0.5));
+  }
+}
+
+template <typename T>
+void GradientMagnitude::build(const T* data, int nComps, const int dims[3],
+                              const double spacing[3])
+{
+  reset(dims, spacing);
+  if (isEmpty()) {
+    return;
+  }
+
+  const int64_t nx = dims[0];
+  const int64_t rows = static_cast<int64_t>(dims[1]) * dims[2];
+  std::vector<float> rowMaxima(rows, 0.f);
+  if (m_storage == Storage::Float) {
+    m_floats.resize(size());
+    parallelFor(0, rows, [&](int64_t begin, int64_t end) {
+      for (int64_t row = begin; row < end; ++row) {
+        float* magnitudes = m_floats.data() + row * nx;
+        rowMagnitudes(data, nComps, row, magnitudes);
+        rowMaxima[row] = *std::max_element(magnitudes, magnitudes + nx);
+      }
+    });
+    m_maximum = *std::max_element(rowMaxima.begin(), rowMaxima.end());
+    return;
+  }
+
+  // Quantized magnitudes need the largest one first, so the gradients are
+  // computed twice rather than keeping a float copy of the volume.
+  parallelFor(0, rows, [&](int64_t begin, int64_t end) {
+    std::vector<float> magnitudes(nx);
+    for (int64_t row = begin; row < end; ++row) {
+      rowMagnitudes(data, nComps, row, magnitudes.data());
+      rowMaxima[row] = *std::max_element(magnitudes.begin(), magnitudes.end());
+    }
+  });
+  m_maximum = *std::max_element(rowMaxima.begin(), rowMaxima.end());
+
+  const double levels = m_storage == Storage::UnsignedShort ? 65535.0 : 255.0;
+  m_step = m_maximum > 0.0 ? m_maximum / levels : 1.0 / levels;
+  if (m_storage == Storage::UnsignedShort) {
+    m_shorts.resize(size());
+  } else {
+    m_bytes.resize(size());
+  }
+  parallelFor(0, rows, [&](int64_t begin, int64_t end) {
+    std::vector<float> magnitudes(nx);
+    for (int64_t row = begin; row < end; ++row) {
+      rowMagnitudes(data, nComps, row, magnitudes.data());
+      if (m_storage == Storage::UnsignedShort) {
+        quantize(magnitudes, row, levels, m_shorts);
+      } else {
+        quantize(magnitudes, row, levels, m_bytes);
+      }
+    }
+  });
+}
+} // namespace tomviz
+
+#endif
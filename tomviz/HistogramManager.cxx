@@ -3,97 +3,86 @@
 
 #include "HistogramManager.h"
 
+#include <vtkDataArray.h>
 #include <vtkFloatArray.h>
 #include <vtkImageData.h>
 #include <vtkPointData.h>
 #include <vtkTable.h>
 #include <vtkUnsignedLongLongArray.h>
+#include <vtkWeakPointer.h>
 
 #include "ComputeHistogram.h"
+#include "GradientMagnitude.h"
 
 #include <QCoreApplication>
 #include <QThread>
 
+#include <array>
+#include <memory>
+#include <vector>
+
 Q_DECLARE_METATYPE(vtkSmartPointer<vtkImageData>)
 Q_DECLARE_METATYPE(vtkSmartPointer<vtkTable>)
+Q_DECLARE_METATYPE(QVector<vtkSmartPointer<vtkDataArray>>)
+Q_DECLARE_METATYPE(QVector<vtkSmartPointer<vtkTable>>)
 
 namespace {
 
-// This is just here for now - quick and dirty historgram calculations...
-void PopulateHistogram(vtkImageData* input, vtkTable* output)
+// The histograms of several arrays of an image, computed together. The
+// tables get a column with the bin centers and one with the populations.
+void PopulateHistograms(const QVector<vtkSmartPointer<vtkDataArray>>& arrays,
+                        const QVector<vtkSmartPointer<vtkTable>>& output)
 {
-  // The output table will have the twice the number of columns, they will be
-  // the x and y for input column. This is the bin centers, and the population.
-  double minmax[2] = { 0.0, 0.0 };
-
   // This number of bins in the 2D histogram will also be used as the number of
   // bins in the 2D transfer function for X (scalar value) and Y (gradient mag.)
   const int numberOfBins = 256;
 
-  // Keep the array we are working on around even if the user shallow copies
-  // over the input image data by incrementing the reference count here.
-  vtkSmartPointer<vtkDataArray> arrayPtr = input->GetPointData()->GetScalars();
-  if (!arrayPtr) {
-    return;
+  // The smart pointers keep the arrays we are working on around even if the
+  // user shallow copies over the input image data.
+  std::vector<vtkDataArray*> inputs;
+  for (auto& array : arrays) {
+    inputs.push_back(array.Get());
   }
-
-  // The bin values are the centers, extending +/- half an inc either side
-  arrayPtr->GetFiniteRange(minmax, -1);
-  if (minmax[0] == minmax[1]) {
-    minmax[1] = minmax[0] + 1.0;
-  }
-
-  double inc = (minmax[1] - minmax[0]) / (numberOfBins - 1);
-  double halfInc = inc / 2.0;
-  vtkSmartPointer<vtkFloatArray> extents =
-    vtkFloatArray::SafeDownCast(output->GetColumnByName("image_extents"));
-  if (!extents) {
-    extents = vtkSmartPointer<vtkFloatArray>::New();
+  std::vector<std::array<double, 2>> ranges;
+  std::vector<std::vector<uint64_t>> pops;
+  std::vector<int> invalid;
+  tomviz::CalculateHistograms(inputs, numberOfBins, ranges, pops, invalid);
+
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    // The bin values are the centers, extending +/- half an inc either side
+    double inc = (ranges[i][1] - ranges[i][0]) / (numberOfBins - 1);
+    double halfInc = inc / 2.0;
+    auto extents = vtkSmartPointer<vtkFloatArray>::New();
     extents->SetName("image_extents");
-  }
-  extents->SetNumberOfTuples(numberOfBins);
-  double min = minmax[0] + halfInc;
-  for (int j = 0; j < numberOfBins; ++j) {
-    extents->SetValue(j, min + j * inc);
-  }
-  vtkSmartPointer<vtkUnsignedLongLongArray> populations =
-    vtkUnsignedLongLongArray::SafeDownCast(
-      output->GetColumnByName("image_pops"));
-  if (!populations) {
-    populations = vtkSmartPointer<vtkUnsignedLongLongArray>::New();
+    extents->SetNumberOfTuples(numberOfBins);
+    double min = ranges[i][0] + halfInc;
+    for (int j = 0; j < numberOfBins; ++j) {
+      extents->SetValue(j, min + j * inc);
+    }
+    auto populations = vtkSmartPointer<vtkUnsignedLongLongArray>::New();
     populations->SetName("image_pops");
-  }
-  populations->SetNumberOfTuples(numberOfBins);
-  auto pops = static_cast<uint64_t*>(populations->GetVoidPointer(0));
-  for (int k = 0; k < numberOfBins; ++k) {
-    pops[k] = 0;
-  }
-  int invalid = 0;
-
-  switch (arrayPtr->GetDataType()) {
-    vtkTemplateMacro(tomviz::CalculateHistogram(
-      reinterpret_cast<VTK_TT*>(arrayPtr->GetVoidPointer(0)),
-      arrayPtr->GetNumberOfTuples(), arrayPtr->GetNumberOfComponents(),
-      minmax[0], minmax[1], pops, 1.0 / inc, invalid));
-    default:
-      cout << "UpdateFromFile: Unknown data type" << endl;
-  }
+    populations->SetNumberOfTuples(numberOfBins);
+    std::copy(pops[i].begin(), pops[i].end(),
+              static_cast<uint64_t*>(populations->GetVoidPointer(0)));
 
 #ifndef NDEBUG
-  vtkIdType total = invalid;
-  for (int i = 0; i < numberOfBins; ++i)
-    total += pops[i];
-  assert(total == arrayPtr->GetNumberOfTuples());
+    vtkIdType total = invalid[i];
+    for (int j = 0; j < numberOfBins; ++j)
+      total += pops[i][j];
+    assert(total == inputs[i]->GetNumberOfTuples());
 #endif
-  if (invalid) {
-    cout << "Warning: NaN or infinite value in dataset" << endl;
-  }
+    if (invalid[i]) {
+      cout << "Warning: NaN or infinite value in dataset" << endl;
+    }
 
-  output->AddColumn(extents);
-  output->AddColumn(populations);
+    output[i]->AddColumn(extents);
+    output[i]->AddColumn(populations);
+  }
 }
 
-void Populate2DHistogram(vtkImageData* input, vtkImageData* output)
+void Populate2DHistogram(vtkImageData* input,
+                         const tomviz::GradientMagnitude& gradient,
+                         vtkImageData* output)
 {
   double minmax[2] = { 0.0, 0.0 };
   const int numberOfBins = 256;
@@ -101,7 +90,7 @@ void Populate2DHistogram(vtkImageData* input, vtkImageData* output)
   // Keep the array we are working on around even if the user shallow copies
   // over the input image data by incrementing the reference count here.
   vtkSmartPointer<vtkDataArray> arrayPtr = input->GetPointData()->GetScalars();
-  if (!arrayPtr) {
+  if (!arrayPtr || gradient.size() != arrayPtr->GetNumberOfTuples()) {
     return;
   }
 
@@ -115,22 +104,53 @@ void Populate2DHistogram(vtkImageData* input, vtkImageData* output)
   output->SetDimensions(numberOfBins, numberOfBins, 1);
   output->AllocateScalars(VTK_DOUBLE, 1);
 
-  // Get input parameters
-  int dim[3];
-  input->GetDimensions(dim);
   int numComp = arrayPtr->GetNumberOfComponents();
-  double spacing[3];
-  input->GetSpacing(spacing);
-
   switch (arrayPtr->GetDataType()) {
     vtkTemplateMacro(tomviz::Calculate2DHistogram(
-      reinterpret_cast<VTK_TT*>(arrayPtr->GetVoidPointer(0)), dim, numComp,
-      minmax, output, spacing));
+      reinterpret_cast<VTK_TT*>(arrayPtr->GetVoidPointer(0)), numComp, minmax,
+      gradient, output));
     default:
       cout << "UpdateFromFile: Unknown data type" << endl;
   }
 }
 
+void PopulateGradientHistogram(vtkImageData* input,
+                               const tomviz::GradientMagnitude& gradient,
+                               vtkTable* output)
+{
+  vtkSmartPointer<vtkDataArray> arrayPtr = input->GetPointData()->GetScalars();
+  if (!arrayPtr) {
+    return;
+  }
+
+  // The gradient opacity function covers a quarter of the scalar range, see
+  // Module::gradientOpacityMap().
+  double minmax[2] = { 0.0, 0.0 };
+  arrayPtr->GetFiniteRange(minmax, -1);
+  double maximum = (minmax[1] - minmax[0]) / 4.0;
+  if (maximum <= 0.0) {
+    maximum = 1.0;
+  }
+
+  const int numberOfBins = 256;
+  const double inc = maximum / numberOfBins;
+  auto extents = vtkSmartPointer<vtkFloatArray>::New();
+  extents->SetName("image_extents");
+  extents->SetNumberOfTuples(numberOfBins);
+  for (int j = 0; j < numberOfBins; ++j) {
+    extents->SetValue(j, (j + 0.5) * inc);
+  }
+  auto populations = vtkSmartPointer<vtkUnsignedLongLongArray>::New();
+  populations->SetName("image_pops");
+  populations->SetNumberOfTuples(numberOfBins);
+  auto pops = static_cast<uint64_t*>(populations->GetVoidPointer(0));
+  std::fill(pops, pops + numberOfBins, 0);
+  gradient.histogram(maximum, numberOfBins, pops);
+
+  output->AddColumn(extents);
+  output->AddColumn(populations);
+}
+
 } // namespace
 
 namespace tomviz {
@@ -143,49 +163,123 @@ class HistogramMaker : public QObject
 
   void run();
 
+  std::shared_ptr<const GradientMagnitude> gradientMagnitude(
+    vtkImageData* image);
+
+  // Gradient magnitudes are shared by the 2D histogram and the gradient
+  // histogram, the volume is only computed again once the image changes.
+  // The most recently used come first, the others are dropped once the
+  // magnitudes take more than MaximumGradientSize bytes. This is only
+  // accessed on the background thread.
+  struct GradientEntry
+  {
+    vtkWeakPointer<vtkImageData> image;
+    vtkMTimeType time;
+    std::shared_ptr<const GradientMagnitude> gradient;
+  };
+  static const size_t MaximumGradientSize = size_t(1) << 30;
+  QList<GradientEntry> m_gradients;
+
 public:
   HistogramMaker(QObject* p = nullptr) : QObject(p) {}
 
 public slots:
-  void makeHistogram(vtkSmartPointer<vtkImageData> input,
-                     vtkSmartPointer<vtkTable> output);
+  void makeHistograms(vtkSmartPointer<vtkImageData> input,
+                      QVector<vtkSmartPointer<vtkDataArray>> arrays,
+                      QVector<vtkSmartPointer<vtkTable>> output);
 
   void makeHistogram2D(vtkSmartPointer<vtkImageData> input,
                        vtkSmartPointer<vtkImageData> output);
 
+  void makeGradientHistogram(vtkSmartPointer<vtkImageData> input,
+                             vtkSmartPointer<vtkTable> output);
+
 signals:
-  void histogramDone(vtkSmartPointer<vtkImageData> image,
-                     vtkSmartPointer<vtkTable> output);
+  void histogramsDone(vtkSmartPointer<vtkImageData> image,
+                      QVector<vtkSmartPointer<vtkDataArray>> arrays,
+                      QVector<vtkSmartPointer<vtkTable>> output);
 
   void histogram2DDone(vtkSmartPointer<vtkImageData> image,
                        vtkSmartPointer<vtkImageData> output);
+
+  void gradientHistogramDone(vtkSmartPointer<vtkImageData> image,
+                             vtkSmartPointer<vtkTable> output);
 };
 
-void HistogramMaker::makeHistogram(vtkSmartPointer<vtkImageData> input,
-                                   vtkSmartPointer<vtkTable> output)
+std::shared_ptr<const GradientMagnitude> HistogramMaker::gradientMagnitude(
+  vtkImageData* image)
 {
-  // make the histogram and notify observers (the main thread) that it
-  // is done.
-  if (input && output) {
-    PopulateHistogram(input.Get(), output.Get());
+  // Drop the gradients of images that were deleted or have changed since.
+  for (int i = 0; i < m_gradients.size();) {
+    const GradientEntry& entry = m_gradients[i];
+    if (!entry.image || entry.image->GetMTime() != entry.time) {
+      m_gradients.removeAt(i);
+    } else if (entry.image == image) {
+      m_gradients.move(i, 0);
+      return m_gradients.front().gradient;
+    } else {
+      ++i;
+    }
+  }
+
+  // 16 bits resolve the gradient far more finely than the 256 histogram
+  // bins, at half the memory of floats.
+  auto gradient = std::make_shared<GradientMagnitude>(
+    GradientMagnitude::Storage::UnsignedShort);
+  gradient->build(image);
+  m_gradients.prepend({ image, image->GetMTime(), gradient });
+
+  size_t size = 0;
+  for (int i = 0; i < m_gradients.size(); ++i) {
+    size += m_gradients[i].gradient->memorySize();
+    if (size > MaximumGradientSize) {
+      // A gradient too large for the cache is used once and not kept.
+      m_gradients.erase(m_gradients.begin() + i, m_gradients.end());
+      break;
+    }
   }
-  emit histogramDone(input, output);
+  return gradient;
+}
+
+void HistogramMaker::makeHistograms(
+  vtkSmartPointer<vtkImageData> input,
+  QVector<vtkSmartPointer<vtkDataArray>> arrays,
+  QVector<vtkSmartPointer<vtkTable>> output)
+{
+  // make the histograms and notify observers (the main thread) that they
+  // are done.
+  if (input && arrays.size() == output.size()) {
+    PopulateHistograms(arrays, output);
+  }
+  emit histogramsDone(input, arrays, output);
 }
 
 void HistogramMaker::makeHistogram2D(vtkSmartPointer<vtkImageData> input,
                                      vtkSmartPointer<vtkImageData> output)
 {
   if (input && output) {
-    Populate2DHistogram(input.Get(), output.Get());
+    Populate2DHistogram(input.Get(), *gradientMagnitude(input), output.Get());
   }
   emit histogram2DDone(input, output);
 }
 
+void HistogramMaker::makeGradientHistogram(vtkSmartPointer<vtkImageData> input,
+                                           vtkSmartPointer<vtkTable> output)
+{
+  if (input && output) {
+    PopulateGradientHistogram(input.Get(), *gradientMagnitude(input),
+                              output.Get());
+  }
+  emit gradientHistogramDone(input, output);
+}
+
 HistogramManager::HistogramManager()
   : m_histogramGen(new HistogramMaker), m_worker(new QThread(this))
 {
   qRegisterMetaType<vtkSmartPointer<vtkImageData>>();
   qRegisterMetaType<vtkSmartPointer<vtkTable>>();
+  qRegisterMetaType<QVector<vtkSmartPointer<vtkDataArray>>>();
+  qRegisterMetaType<QVector<vtkSmartPointer<vtkTable>>>();
 
   // Start the worker thread and give it ownership of the HistogramMaker
   // object. Also connect the HistogramMaker's signal to the histogramReady
@@ -193,15 +287,23 @@ HistogramManager::HistogramManager()
   // histogram has been finished on the background thread.
   m_worker->start();
   m_histogramGen->moveToThread(m_worker);
-  connect(m_histogramGen, SIGNAL(histogramDone(vtkSmartPointer<vtkImageData>,
-                                               vtkSmartPointer<vtkTable>)),
-          SLOT(histogramReadyInternal(vtkSmartPointer<vtkImageData>,
-                                      vtkSmartPointer<vtkTable>)));
+  connect(m_histogramGen,
+          SIGNAL(histogramsDone(vtkSmartPointer<vtkImageData>,
+                                QVector<vtkSmartPointer<vtkDataArray>>,
+                                QVector<vtkSmartPointer<vtkTable>>)),
+          SLOT(histogramsReadyInternal(vtkSmartPointer<vtkImageData>,
+                                       QVector<vtkSmartPointer<vtkDataArray>>,
+                                       QVector<vtkSmartPointer<vtkTable>>)));
   connect(m_histogramGen,
           SIGNAL(histogram2DDone(vtkSmartPointer<vtkImageData>,
                                  vtkSmartPointer<vtkImageData>)),
           SLOT(histogram2DReadyInternal(vtkSmartPointer<vtkImageData>,
                                         vtkSmartPointer<vtkImageData>)));
+  connect(m_histogramGen,
+          SIGNAL(gradientHistogramDone(vtkSmartPointer<vtkImageData>,
+                                       vtkSmartPointer<vtkTable>)),
+          SLOT(gradientHistogramReadyInternal(vtkSmartPointer<vtkImageData>,
+                                              vtkSmartPointer<vtkTable>)));
 }
 
 HistogramManager::~HistogramManager()
@@ -227,6 +329,7 @@ void HistogramManager::finalize()
   m_worker = nullptr;
   m_histogramCache.clear();
   m_histogram2DCache.clear();
+  m_gradientHistogramCache.clear();
 }
 
 HistogramManager& HistogramManager::instance()
@@ -238,30 +341,55 @@ HistogramManager& HistogramManager::instance()
 vtkSmartPointer<vtkTable> HistogramManager::getHistogram(
   vtkSmartPointer<vtkImageData> image)
 {
-  if (m_histogramCache.contains(image)) {
-    auto cachedTable = m_histogramCache[image];
-    if (cachedTable->GetMTime() > image->GetMTime()) {
+  vtkDataArray* scalars = image->GetPointData()->GetScalars();
+  if (!scalars) {
+    return nullptr;
+  }
+  // Histograms belong to arrays rather than to the image, so switching
+  // between the arrays of an image does not compute them again.
+  if (m_histogramCache.contains(scalars)) {
+    auto cachedTable = m_histogramCache[scalars];
+    if (cachedTable->GetMTime() > scalars->GetMTime()) {
       return cachedTable;
     } else {
       // Need to recalculate, clear the plots, and remove the cached data.
-      m_histogramCache.remove(image);
+      m_histogramCache.remove(scalars);
     }
   }
   if (m_histogramsInProgress.contains(image)) {
     // it is in progress, don't start a new one
     return nullptr;
   }
-  auto table = vtkSmartPointer<vtkTable>::New();
+
+  // The histograms of all the arrays of the image that are not cached are
+  // computed together, in one pass over the image.
+  QVector<vtkSmartPointer<vtkDataArray>> arrays;
+  QVector<vtkSmartPointer<vtkTable>> tables;
+  vtkPointData* pointData = image->GetPointData();
+  for (int i = 0; i < pointData->GetNumberOfArrays(); ++i) {
+    vtkDataArray* array = pointData->GetArray(i);
+    if (!array || array->GetNumberOfTuples() != scalars->GetNumberOfTuples()) {
+      continue;
+    }
+    auto cachedTable = m_histogramCache.value(array);
+    if (array == scalars || !cachedTable ||
+        cachedTable->GetMTime() <= array->GetMTime()) {
+      arrays.append(array);
+      tables.append(vtkSmartPointer<vtkTable>::New());
+    }
+  }
   m_histogramsInProgress.append(image);
   vtkSmartPointer<vtkImageData> const imageSP = image;
 
   // This fakes a Qt signal to the background thread (without exposing the
   // class internals as a signal).  The background thread will then call
-  // makeHistogram on the HistogramMaker object with the parameters we
+  // makeHistograms on the HistogramMaker object with the parameters we
   // gave here.
-  QMetaObject::invokeMethod(m_histogramGen, "makeHistogram",
-                            Q_ARG(vtkSmartPointer<vtkImageData>, imageSP),
-                            Q_ARG(vtkSmartPointer<vtkTable>, table));
+  QMetaObject::invokeMethod(
+    m_histogramGen, "makeHistograms",
+    Q_ARG(vtkSmartPointer<vtkImageData>, imageSP),
+    Q_ARG(QVector<vtkSmartPointer<vtkDataArray>>, arrays),
+    Q_ARG(QVector<vtkSmartPointer<vtkTable>>, tables));
 
   // The histogram cannot be returned for use while the background thread is
   // populating it.
@@ -300,12 +428,62 @@ vtkSmartPointer<vtkImageData> HistogramManager::getHistogram2D(
   return nullptr;
 }
 
-void HistogramManager::histogramReadyInternal(
-  vtkSmartPointer<vtkImageData> image, vtkSmartPointer<vtkTable> histogram)
+vtkSmartPointer<vtkTable> HistogramManager::getGradientHistogram(
+  vtkSmartPointer<vtkImageData> image)
 {
-  m_histogramCache[image] = histogram;
+  if (m_gradientHistogramCache.contains(image)) {
+    auto cachedTable = m_gradientHistogramCache[image];
+    if (cachedTable->GetMTime() > image->GetMTime()) {
+      return cachedTable;
+    } else {
+      m_gradientHistogramCache.remove(image);
+    }
+  }
+  if (m_gradientHistogramsInProgress.contains(image)) {
+    return nullptr;
+  }
+  auto table = vtkSmartPointer<vtkTable>::New();
+  m_gradientHistogramsInProgress.append(image);
+  vtkSmartPointer<vtkImageData> const imageSP = image;
+  QMetaObject::invokeMethod(m_histogramGen, "makeGradientHistogram",
+                            Q_ARG(vtkSmartPointer<vtkImageData>, imageSP),
+                            Q_ARG(vtkSmartPointer<vtkTable>, table));
+  return nullptr;
+}
+
+vtkSmartPointer<vtkTable> HistogramManager::cachedHistogram(
+  vtkDataArray* array) const
+{
+  auto cachedTable = m_histogramCache.value(array);
+  if (cachedTable && cachedTable->GetMTime() > array->GetMTime()) {
+    return cachedTable;
+  }
+  return nullptr;
+}
+
+void HistogramManager::setHistogram(vtkDataArray* array, vtkTable* histogram)
+{
+  // The table must be newer than the array to count as up to date.
+  histogram->Modified();
+  m_histogramCache[array] = histogram;
+}
+
+void HistogramManager::histogramsReadyInternal(
+  vtkSmartPointer<vtkImageData> image,
+  QVector<vtkSmartPointer<vtkDataArray>> arrays,
+  QVector<vtkSmartPointer<vtkTable>> histograms)
+{
+  for (int i = 0; i < arrays.size() && i < histograms.size(); ++i) {
+    m_histogramCache[arrays[i]] = histograms[i];
+  }
   m_histogramsInProgress.removeAll(image);
-  emit this->histogramReady(image, histogram);
+
+  // The active scalars may have been switched while the histograms were
+  // computed, hand out the histogram of the current ones.
+  vtkDataArray* scalars = image->GetPointData()->GetScalars();
+  if (scalars && m_histogramCache.contains(scalars)) {
+    emit this->histogramReady(image, m_histogramCache[scalars]);
+  }
 }
 
 void HistogramManager::histogram2DReadyInternal(
@@ -316,6 +494,14 @@ void HistogramManager::histogram2DReadyInternal(
   emit this->histogram2DReady(image, histogram);
 }
 
+void HistogramManager::gradientHistogramReadyInternal(
+  vtkSmartPointer<vtkImageData> image, vtkSmartPointer<vtkTable> histogram)
+{
+  m_gradientHistogramCache[image] = histogram;
+  m_gradientHistogramsInProgress.removeAll(image);
+  emit this->gradientHistogramReady(image, histogram);
+}
+
 } // namespace tomviz
 
 #include "HistogramManager.moc"
@@ -8,9 +8,11 @@
 #include <vtkSmartPointer.h>
 
 #include <QMap>
+#include <QVector>
 
 class QThread;
 
+class vtkDataArray;
 class vtkImageData;
 class vtkTable;
 
@@ -32,25 +34,47 @@ public:
   vtkSmartPointer<vtkImageData> getHistogram2D(
     vtkSmartPointer<vtkImageData> image);
 
+  /// Histogram of the gradient magnitude of the image over the domain of the
+  /// gradient opacity function, computed in the background like the others.
+  /// The gradient magnitude volume is computed once per version of an image
+  /// and shared with the 2D histogram.
+  vtkSmartPointer<vtkTable> getGradientHistogram(
+    vtkSmartPointer<vtkImageData> image);
+
+  /// The histogram of an array if it is cached and up to date, null
+  /// otherwise. It never starts computing one.
+  vtkSmartPointer<vtkTable> cachedHistogram(vtkDataArray* array) const;
+
+  /// Cache a histogram of an array computed earlier, such as one stored with
+  /// a state file, so it is not computed again.
+  void setHistogram(vtkDataArray* array, vtkTable* histogram);
+
 signals:
   void histogramReady(vtkSmartPointer<vtkImageData>, vtkSmartPointer<vtkTable>);
   void histogram2DReady(vtkSmartPointer<vtkImageData> input,
                         vtkSmartPointer<vtkImageData> output);
+  void gradientHistogramReady(vtkSmartPointer<vtkImageData> input,
+                              vtkSmartPointer<vtkTable> output);
 
 private slots:
-  void histogramReadyInternal(vtkSmartPointer<vtkImageData>,
-                              vtkSmartPointer<vtkTable>);
+  void histogramsReadyInternal(vtkSmartPointer<vtkImageData>,
+                               QVector<vtkSmartPointer<vtkDataArray>>,
+                               QVector<vtkSmartPointer<vtkTable>>);
   void histogram2DReadyInternal(vtkSmartPointer<vtkImageData> input,
                                 vtkSmartPointer<vtkImageData> output);
+  void gradientHistogramReadyInternal(vtkSmartPointer<vtkImageData> input,
+                                      vtkSmartPointer<vtkTable> output);
 
 private:
   HistogramManager();
   ~HistogramManager();
 
-  QMap<vtkImageData*, vtkSmartPointer<vtkTable>> m_histogramCache;
+  QMap<vtkDataArray*, vtkSmartPointer<vtkTable>> m_histogramCache;
   QMap<vtkImageData*, vtkSmartPointer<vtkImageData>> m_histogram2DCache;
   QList<vtkImageData*> m_histogramsInProgress;
+  QMap<vtkImageData*, vtkSmartPointer<vtkTable>> m_gradientHistogramCache;
   QList<vtkImageData*> m_histogram2DsInProgress;
+  QList<vtkImageData*> m_gradientHistogramsInProgress;
   HistogramMaker* m_histogramGen;
   QThread* m_worker;
 };
@@ -0,0 +1,176 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizImageShift_h
+#define tomvizImageShift_h
+
+#include "ParallelFor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace tomviz {
+
+/// Range of output columns [begin, end) that receive data when a row of
+/// length n is shifted by offset, the rest of the row is zero.
+inline void shiftedRange(int n, int offset, int& begin, int& end)
+{
+  begin = std::min(std::max(0, offset), n);
+  end = std::max(std::min(n, n + offset), begin);
+}
+
+/// Shift a single slice of nx by ny tuples with nComps components by an integer
+/// offset, writing into out which must not alias in. Pixels shifted in from
+/// outside the slice are set to zero. Each row is moved with one bulk copy.
+template <typename T>
+void shiftSlice(const T* in, T* out, int nx, int ny, int nComps, int dx,
+                int dy)
+{
+  const size_t rowSize = static_cast<size_t>(nx) * nComps;
+  int xBegin, xEnd, yBegin, yEnd;
+  shiftedRange(nx, dx, xBegin, xEnd);
+  shiftedRange(ny, dy, yBegin, yEnd);
+  const size_t head = static_cast<size_t>(xBegin) * nComps;
+  const size_t width = static_cast<size_t>(xEnd - xBegin) * nComps;
+
+  std::fill(out, out + yBegin * rowSize, T(0));
+  for (int y = yBegin; y < yEnd; ++y) {
+    T* dst = out + y * rowSize;
+    const T* src = in + (y - dy) * rowSize + (xBegin - dx) * nComps;
+    std::fill(dst, dst + head, T(0));
+    std::memcpy(dst + head, src, width * sizeof(T));
+    std::fill(dst + head + width, dst + rowSize, T(0));
+  }
+  std::fill(out + yEnd * rowSize, out + ny * rowSize, T(0));
+}
+
+namespace detail {
+
+template <typename T,
+          typename std::enable_if<std::is_integral<T>::value>::type* = nullptr>
+inline T roundTo(float value)
+{
+  return static_cast<T>(std::floor(value + 0.5f));
+}
+
+template <typename T,
+          typename std::enable_if<!std::is_integral<T>::value>::type* = nullptr>
+inline T roundTo(float value)
+{
+  return static_cast<T>(value);
+}
+
+/// Linearly interpolate one row horizontally into dst. The source row is
+/// staged in a zero padded buffer so the inner loop has no bounds checks and
+/// can be vectorized by the compiler.
+template <typename T>
+void interpolateRow(const T* src, float* padded, float* dst, int nx,
+                    int nComps, int ix, float fx)
+{
+  const int rowSize = nx * nComps;
+  std::fill(padded, padded + nComps, 0.f);
+  std::fill(padded + nComps + rowSize, padded + 2 * nComps + rowSize, 0.f);
+  for (int i = 0; i < rowSize; ++i) {
+    padded[nComps + i] = static_cast<float>(src[i]);
+  }
+
+  // Output column x samples padded columns x - ix and x - ix + 1, which are
+  // both inside the padded row for x in [ix, nx + ix].
+  const int begin = std::min(std::max(0, ix), nx);
+  const int end = std::max(std::min(nx, nx + ix + 1), begin);
+  const float gx = 1.f - fx;
+  std::fill(dst, dst + begin * nComps, 0.f);
+  const float* a = padded + (begin - ix) * nComps;
+  const float* b = a + nComps;
+  for (int i = begin * nComps; i < end * nComps; ++i) {
+    dst[i] = fx * *a++ + gx * *b++;
+  }
+  std::fill(dst + end * nComps, dst + rowSize, 0.f);
+}
+} // namespace detail
+
+/// Shift a single slice by a sub-pixel offset using bilinear interpolation,
+/// samples falling outside the slice are treated as zero. The slice is
+/// processed as two separable passes over a pair of rolling row buffers.
+template <typename T>
+void shiftSliceBilinear(const T* in, T* out, int nx, int ny, int nComps,
+                        double dx, double dy)
+{
+  const int ix = static_cast<int>(std::floor(dx));
+  const int iy = static_cast<int>(std::floor(dy));
+  const float fx = static_cast<float>(dx - ix);
+  const float fy = static_cast<float>(dy - iy);
+  if (fx == 0.f && fy == 0.f) {
+    shiftSlice(in, out, nx, ny, nComps, ix, iy);
+    return;
+  }
+
+  const int rowSize = nx * nComps;
+  std::vector<float> padded(rowSize + 2 * nComps);
+  std::vector<float> upper(rowSize), lower(rowSize), zero(rowSize, 0.f);
+
+  // Output row y blends source rows y - iy - 1 (weight fy) and y - iy
+  // (weight 1 - fy).
+  auto loadRow = [&](int row, std::vector<float>& dst) -> const float* {
+    if (row < 0 || row >= ny) {
+      return zero.data();
+    }
+    detail::interpolateRow(in + static_cast<size_t>(row) * rowSize,
+                           padded.data(), dst.data(), nx, nComps, ix, fx);
+    return dst.data();
+  };
+
+  const float gy = 1.f - fy;
+  const float* a = loadRow(-iy - 1, upper);
+  for (int y = 0; y < ny; ++y) {
+    const float* b = loadRow(y - iy, lower);
+    T* dst = out + static_cast<size_t>(y) * rowSize;
+    for (int i = 0; i < rowSize; ++i) {
+      dst[i] = detail::roundTo<T>(fy * a[i] + gy * b[i]);
+    }
+    // The lower row becomes the upper row of the next output row.
+    if (b == lower.data()) {
+      std::swap(upper, lower);
+      a = upper.data();
+    } else {
+      a = b;
+    }
+  }
+}
+
+/// Shift every slice along z of a volume of dimensions dims by its own integer
+/// offset, offsets must hold dims[2] (x, y) pairs. Slices are processed in
+/// parallel and written straight into the preallocated out array.
+template <typename T>
+void shiftSlices(const T* in, T* out, const int dims[3], int nComps,
+                 const int* offsets)
+{
+  const size_t sliceSize = static_cast<size_t>(dims[0]) * dims[1] * nComps;
+  parallelFor(0, dims[2], 1, [&](int64_t begin, int64_t end) {
+    for (int64_t z = begin; z < end; ++z) {
+      shiftSlice(in + z * sliceSize, out + z * sliceSize, dims[0], dims[1],
+                 nComps, offsets[2 * z], offsets[2 * z + 1]);
+    }
+  });
+}
+
+/// Sub-pixel variant of shiftSlices, slices whose offsets are integral take
+/// the bulk copy path.
+template <typename T>
+void shiftSlicesBilinear(const T* in, T* out, const int dims[3], int nComps,
+                         const double* offsets)
+{
+  const size_t sliceSize = static_cast<size_t>(dims[0]) * dims[1] * nComps;
+  parallelFor(0, dims[2], 1, [&](int64_t begin, int64_t end) {
+    for (int64_t z = begin; z < end; ++z) {
+      shiftSliceBilinear(in + z * sliceSize, out + z * sliceSize, dims[0],
+                         dims[1], nComps, offsets[2 * z], offsets[2 * z + 1]);
+    }
+  });
+}
+} // namespace tomviz
+
+#endif
@@ -0,0 +1,140 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "ImageSlice.h"
+
+#include "ParallelFor.h"
+
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkInformation.h>
+#include <vtkInformationObjectBaseKey.h>
+#include <vtkPointData.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace tomviz {
+
+namespace {
+
+// Holds the image scalars a slice is a view into, so they outlive the slice
+// wherever the slice is shallow copied to.
+vtkInformationObjectBaseKey* viewSourceKey()
+{
+  // Keys are owned by the key lookup, as those of vtkInformationKeyMacro.
+  static auto key =
+    new vtkInformationObjectBaseKey("VIEW_SOURCE", "tomviz::ImageSlice");
+  return key;
+}
+} // namespace
+
+namespace ImageSlice {
+
+vtkSmartPointer<vtkImageData> extract(vtkImageData* image, int axis,
+                                      int index)
+{
+  vtkDataArray* scalars =
+    image ? image->GetPointData()->GetScalars() : nullptr;
+  if (!scalars || axis < 0 || axis > 2) {
+    return nullptr;
+  }
+
+  int dims[3];
+  int extent[6];
+  image->GetDimensions(dims);
+  image->GetExtent(extent);
+  if (dims[axis] < 1) {
+    return nullptr;
+  }
+  index = std::min(std::max(index, 0), dims[axis] - 1);
+  extent[2 * axis] = extent[2 * axis + 1] = extent[2 * axis] + index;
+
+  auto slice = vtkSmartPointer<vtkImageData>::New();
+  slice->SetOrigin(image->GetOrigin());
+  slice->SetSpacing(image->GetSpacing());
+  slice->SetExtent(extent);
+
+  const int nComps = scalars->GetNumberOfComponents();
+  const size_t tupleSize =
+    static_cast<size_t>(nComps) * scalars->GetDataTypeSize();
+  const int64_t nx = dims[0];
+  const int64_t ny = dims[1];
+  const int64_t tuples = slice->GetNumberOfPoints();
+  auto source = static_cast<char*>(scalars->GetVoidPointer(0));
+
+  vtkSmartPointer<vtkDataArray> array;
+  array.TakeReference(scalars->NewInstance());
+  array->SetName(scalars->GetName());
+  array->SetNumberOfComponents(nComps);
+  if (axis == 2) {
+    array->SetVoidArray(source + index * nx * ny * tupleSize,
+                        tuples * nComps, 1);
+    array->GetInformation()->Set(viewSourceKey(), scalars);
+  } else {
+    array->SetNumberOfTuples(tuples);
+    auto target = static_cast<char*>(array->GetVoidPointer(0));
+    if (axis == 1) {
+      // One row of the image per slice of the volume.
+      const size_t rowSize = nx * tupleSize;
+      parallelFor(0, dims[2], [&](int64_t begin, int64_t end) {
+        for (int64_t z = begin; z < end; ++z) {
+          std::memcpy(target + z * rowSize,
+                      source + (z * ny + index) * rowSize, rowSize);
+        }
+      });
+    } else {
+      parallelFor(0, dims[2], [&](int64_t begin, int64_t end) {
+        for (int64_t z = begin; z < end; ++z) {
+          for (int64_t y = 0; y < ny; ++y) {
+            std::memcpy(target + (z * ny + y) * tupleSize,
+                        source + ((z * ny + y) * nx + index) * tupleSize,
+                        tupleSize);
+          }
+        }
+      });
+    }
+  }
+  slice->GetPointData()->SetScalars(array);
+  return slice;
+}
+
+bool isView(vtkImageData* slice)
+{
+  vtkDataArray* scalars =
+    slice ? slice->GetPointData()->GetScalars() : nullptr;
+  return scalars && scalars->HasInformation() &&
+         scalars->GetInformation()->Has(viewSourceKey());
+}
+
+size_t memorySize(vtkImageData* slice)
+{
+  if (!slice || isView(slice)) {
+    return 0;
+  }
+  // GetActualMemorySize is in kibibytes.
+  return static_cast<size_t>(slice->GetActualMemorySize()) * 1024;
+}
+} // namespace ImageSlice
+
+ImageSliceCache::ImageSliceCache(size_t maximumSize)
+  : MemoryCache(maximumSize)
+{
+}
+
+vtkSmartPointer<vtkImageData> ImageSliceCache::find(int axis, int index)
+{
+  return MemoryCache::find({ axis, index });
+}
+
+bool ImageSliceCache::contains(int axis, int index) const
+{
+  return MemoryCache::contains({ axis, index });
+}
+
+void ImageSliceCache::insert(int axis, int index, vtkImageData* slice)
+{
+  MemoryCache::insert({ axis, index }, slice,
+                      slice ? ImageSlice::memorySize(slice) : 0);
+}
+} // namespace tomviz
@@ -0,0 +1,51 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizImageSlice_h
+#define tomvizImageSlice_h
+
+#include "MemoryCache.h"
+
+#include <vtkSmartPointer.h>
+
+#include <utility>
+
+class vtkImageData;
+
+namespace tomviz {
+
+namespace ImageSlice {
+
+/// Extract the slice at index along an axis (0 for YZ, 1 for XZ and 2 for XY
+/// slices) of the active scalars of an image. The slice keeps the origin,
+/// spacing and extent of the image along the other axes, so it is drawn where
+/// it lies in the volume. A slice along z is contiguous in memory and its
+/// scalars are a view into the image scalars, which they keep alive, other
+/// slices are gathered in parallel.
+vtkSmartPointer<vtkImageData> extract(vtkImageData* image, int axis,
+                                      int index);
+
+/// Whether the scalars of a slice are a view into the image they came from.
+bool isView(vtkImageData* slice);
+
+/// Memory held by a slice in bytes, zero for a view.
+size_t memorySize(vtkImageData* slice);
+} // namespace ImageSlice
+
+/// Least recently used cache of image slices keyed by axis and index,
+/// bounded by the memory the slices hold.
+class ImageSliceCache : public MemoryCache<std::pair<int, int>, vtkImageData>
+{
+public:
+  explicit ImageSliceCache(size_t maximumSize = 512 * 1024 * 1024);
+
+  vtkSmartPointer<vtkImageData> find(int axis, int index);
+  bool contains(int axis, int index) const;
+
+  /// Add a slice, replacing any slice with the same key. Slices larger than
+  /// the cache are not kept.
+  void insert(int axis, int index, vtkImageData* slice);
+};
+} // namespace tomviz
+
+#endif
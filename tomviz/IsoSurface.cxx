@@ -0,0 +1,225 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "IsoSurface.h"
+
+#include "BrickRangeIndex.h"
+#include "ParallelFor.h"
+
+#include <vtkAppendPolyData.h>
+#include <vtkCellArray.h>
+#include <vtkDataObject.h>
+#include <vtkExtractVOI.h>
+#include <vtkFlyingEdges3D.h>
+#include <vtkIdList.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkStaticCleanPolyData.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+// Flying edges over the voi of the image, sampled at the sample rate.
+vtkSmartPointer<vtkPolyData> contour(vtkImageData* image, const int voi[6],
+                                     const std::string& arrayName,
+                                     double value, int sampleRate)
+{
+  int extent[6];
+  image->GetExtent(extent);
+  const bool cropped = !std::equal(voi, voi + 6, extent);
+
+  vtkNew<vtkFlyingEdges3D> flyingEdges;
+  vtkNew<vtkExtractVOI> sample;
+  if (sampleRate > 1 || cropped) {
+    sample->SetInputData(image);
+    sample->SetVOI(const_cast<int*>(voi));
+    sample->SetSampleRate(sampleRate, sampleRate, sampleRate);
+    sample->IncludeBoundaryOn();
+    flyingEdges->SetInputConnection(sample->GetOutputPort());
+  } else {
+    flyingEdges->SetInputData(image);
+  }
+  flyingEdges->SetInputArrayToProcess(
+    0, 0, 0, vtkDataObject::FIELD_ASSOCIATION_POINTS, arrayName.c_str());
+  flyingEdges->SetValue(0, value);
+  flyingEdges->ComputeScalarsOn();
+  flyingEdges->ComputeNormalsOn();
+  flyingEdges->Update();
+
+  vtkSmartPointer<vtkPolyData> surface = flyingEdges->GetOutput();
+  return surface;
+}
+
+// Drop the triangles of the cells outside the given point extent. A triangle
+// lies in the cell holding its centroid.
+void keepCells(vtkPolyData* surface, vtkImageData* image, const int owned[6])
+{
+  double origin[3];
+  double spacing[3];
+  image->GetOrigin(origin);
+  image->GetSpacing(spacing);
+  vtkPoints* points = surface->GetPoints();
+  vtkCellArray* polys = surface->GetPolys();
+  if (!points || !polys) {
+    return;
+  }
+  vtkNew<vtkCellArray> kept;
+  vtkNew<vtkIdList> ids;
+  for (vtkIdType c = 0; c < polys->GetNumberOfCells(); ++c) {
+    polys->GetCellAtId(c, ids.GetPointer());
+    double centroid[3] = { 0.0, 0.0, 0.0 };
+    for (vtkIdType i = 0; i < ids->GetNumberOfIds(); ++i) {
+      double p[3];
+      points->GetPoint(ids->GetId(i), p);
+      for (int a = 0; a < 3; ++a) {
+        centroid[a] += p[a] / ids->GetNumberOfIds();
+      }
+    }
+    bool inside = true;
+    for (int a = 0; a < 3 && inside; ++a) {
+      const double cell = std::floor((centroid[a] - origin[a]) / spacing[a]);
+      inside = cell >= owned[2 * a] && cell < owned[2 * a + 1];
+    }
+    if (inside) {
+      kept->InsertNextCell(ids.GetPointer());
+    }
+  }
+  surface->SetPolys(kept.GetPointer());
+}
+} // namespace
+
+namespace tomviz {
+
+namespace IsoSurface {
+
+int previewSampleRate(const int dims[3], int64_t maximumPoints)
+{
+  auto points = [&](int rate) {
+    int64_t n = 1;
+    for (int i = 0; i < 3; ++i) {
+      n *= (dims[i] + rate - 1) / rate;
+    }
+    return n;
+  };
+  int rate = 1;
+  while (points(rate) > maximumPoints) {
+    ++rate;
+  }
+  return rate;
+}
+
+vtkSmartPointer<vtkPolyData> extract(vtkImageData* image,
+                                     const std::string& arrayName,
+                                     double value, int sampleRate,
+                                     const BrickRangeIndex* index)
+{
+  int dims[3];
+  int extent[6];
+  image->GetDimensions(dims);
+  image->GetExtent(extent);
+  if (!index || !std::equal(dims, dims + 3, index->dimensions())) {
+    return contour(image, extent, arrayName, value, sampleRate);
+  }
+
+  auto bricks = index->extentsInRange(value, value);
+  if (bricks.empty()) {
+    return vtkSmartPointer<vtkPolyData>::New();
+  }
+
+  // Extents in the image, padded by a point so normals are unchanged.
+  auto padded = [&](const std::array<int, 6>& brick, int voi[6]) {
+    for (int i = 0; i < 3; ++i) {
+      voi[2 * i] = extent[2 * i] + std::max(brick[2 * i] - 1, 0);
+      voi[2 * i + 1] =
+        extent[2 * i] + std::min(brick[2 * i + 1] + 1, dims[i] - 1);
+    }
+  };
+
+  if (sampleRate > 1 || bricks.size() == 1) {
+    // Previews are contoured over the box around the bricks, a sampled
+    // image does not line up with them.
+    std::array<int, 6> box = bricks.front();
+    for (const auto& brick : bricks) {
+      for (int i = 0; i < 3; ++i) {
+        box[2 * i] = std::min(box[2 * i], brick[2 * i]);
+        box[2 * i + 1] = std::max(box[2 * i + 1], brick[2 * i + 1]);
+      }
+    }
+    int voi[6];
+    padded(box, voi);
+    return contour(image, voi, arrayName, value, sampleRate);
+  }
+
+  // Each extent is contoured on its own, the triangles of its padding cells
+  // belong to the neighboring extents and are dropped. Every task reads its
+  // own shallow copy, a data object can only be the input of one pipeline at
+  // a time.
+  const int64_t count = static_cast<int64_t>(bricks.size());
+  std::vector<vtkSmartPointer<vtkImageData>> inputs(count);
+  for (auto& input : inputs) {
+    input = vtkSmartPointer<vtkImageData>::New();
+    input->ShallowCopy(image);
+  }
+  std::vector<vtkSmartPointer<vtkPolyData>> pieces(count);
+  parallelFor(0, count, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      int voi[6];
+      int owned[6];
+      padded(bricks[i], voi);
+      for (int a = 0; a < 6; ++a) {
+        owned[a] = extent[a & ~1] + bricks[i][a];
+      }
+      pieces[i] = contour(inputs[i], voi, arrayName, value, sampleRate);
+      keepCells(pieces[i], inputs[i], owned);
+    }
+  });
+
+  vtkNew<vtkAppendPolyData> append;
+  for (const auto& piece : pieces) {
+    if (piece->GetNumberOfPolys() > 0) {
+      append->AddInputData(piece);
+    }
+  }
+  if (append->GetNumberOfInputConnections(0) == 0) {
+    return vtkSmartPointer<vtkPolyData>::New();
+  }
+  // The extents share the points on their faces, each is generated once per
+  // extent and merged here so the surface stays connected across them.
+  vtkNew<vtkStaticCleanPolyData> merge;
+  merge->SetInputConnection(append->GetOutputPort());
+  merge->SetTolerance(0.0);
+  merge->ConvertPolysToLinesOff();
+  merge->ConvertLinesToPointsOff();
+  merge->ConvertStripsToPolysOff();
+  merge->Update();
+  vtkSmartPointer<vtkPolyData> surface = merge->GetOutput();
+  return surface;
+}
+} // namespace IsoSurface
+
+IsoSurfaceCache::IsoSurfaceCache(size_t maximumSize)
+  : MemoryCache(maximumSize)
+{
+}
+
+vtkSmartPointer<vtkPolyData> IsoSurfaceCache::find(double value,
+                                                   int sampleRate)
+{
+  return MemoryCache::find({ value, sampleRate });
+}
+
+void IsoSurfaceCache::insert(double value, int sampleRate,
+                             vtkPolyData* surface)
+{
+  // GetActualMemorySize is in kibibytes.
+  MemoryCache::insert(
+    { value, sampleRate }, surface,
+    surface ? static_cast<size_t>(surface->GetActualMemorySize()) * 1024 : 0);
+}
+} // namespace tomviz
@@ -0,0 +1,63 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizIsoSurface_h
+#define tomvizIsoSurface_h
+
+#include "MemoryCache.h"
+
+#include <vtkSmartPointer.h>
+
+#include <cstdint>
+#include <string>
+#include <utility>
+
+class vtkImageData;
+class vtkPolyData;
+
+namespace tomviz {
+
+class BrickRangeIndex;
+
+namespace IsoSurface {
+
+/// Number of points a preview image is sampled down to, at most.
+const int64_t PreviewPoints = 1 << 21;
+
+/// Sample rate along each axis that brings an image of the given dimensions
+/// down to at most maximumPoints points, 1 if it is small enough already.
+int previewSampleRate(const int dims[3],
+                      int64_t maximumPoints = PreviewPoints);
+
+/// Extract the iso surface of the first component of a point array with
+/// flying edges, with scalars and normals. A sample rate above one extracts
+/// the surface from the image sampled at that rate along each axis, which is
+/// used for the previews shown while the iso value is being dragged. With a
+/// brick index of the array only the bricks that hold the value are
+/// contoured, in parallel, each padded by a point so normals are unchanged,
+/// and the points they share are merged. Previews contour the box around
+/// those bricks.
+vtkSmartPointer<vtkPolyData> extract(vtkImageData* image,
+                                     const std::string& arrayName,
+                                     double value, int sampleRate = 1,
+                                     const BrickRangeIndex* index = nullptr);
+} // namespace IsoSurface
+
+/// Least recently used cache of iso surfaces keyed by iso value and sample
+/// rate, bounded by the memory used by the surfaces.
+class IsoSurfaceCache : public MemoryCache<std::pair<double, int>, vtkPolyData>
+{
+public:
+  explicit IsoSurfaceCache(size_t maximumSize = 256 * 1024 * 1024);
+
+  /// The cached surface, or nullptr. A hit makes the surface the most
+  /// recently used one.
+  vtkSmartPointer<vtkPolyData> find(double value, int sampleRate = 1);
+
+  /// Add a surface, replacing any surface with the same key. Surfaces larger
+  /// than the cache are not kept.
+  void insert(double value, int sampleRate, vtkPolyData* surface);
+};
+} // namespace tomviz
+
+#endif
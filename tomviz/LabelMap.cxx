@@ -0,0 +1,123 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "LabelMap.h"
+
+#include "ParallelFor.h"
+
+#include <vtkDataArray.h>
+#include <vtkType.h>
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
+namespace {
+
+template <typename T>
+bool labelRange(const T* values, vtkIdType size, uint64_t& maximum)
+{
+  std::mutex mutex;
+  bool valid = true;
+  maximum = 0;
+  tomviz::parallelFor(0, size, [&](int64_t begin, int64_t end) {
+    T localMaximum = 0;
+    bool localValid = true;
+    for (int64_t i = begin; i < end; ++i) {
+      const T value = values[i];
+      // Negative and fractional values, including NaN, are not labels.
+      localValid = localValid && value >= 0 &&
+                   std::floor(static_cast<double>(value)) == value;
+      localMaximum = value > localMaximum ? value : localMaximum;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    valid = valid && localValid;
+    if (localValid) {
+      maximum = std::max(maximum, static_cast<uint64_t>(localMaximum));
+    }
+  });
+  return valid;
+}
+
+template <typename T, typename U>
+void convertLabels(const T* input, U* output, vtkIdType size)
+{
+  tomviz::parallelFor(0, size, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      output[i] = static_cast<U>(input[i]);
+    }
+  });
+}
+
+template <typename T>
+void convertLabels(const T* input, vtkDataArray* output, vtkIdType size)
+{
+  void* data = output->GetVoidPointer(0);
+  switch (output->GetDataType()) {
+    case VTK_UNSIGNED_CHAR:
+      convertLabels(input, static_cast<unsigned char*>(data), size);
+      break;
+    case VTK_UNSIGNED_SHORT:
+      convertLabels(input, static_cast<unsigned short*>(data), size);
+      break;
+    case VTK_UNSIGNED_INT:
+      convertLabels(input, static_cast<unsigned int*>(data), size);
+      break;
+  }
+}
+} // namespace
+
+namespace tomviz {
+
+namespace LabelMap {
+
+int smallestType(uint64_t maxLabel)
+{
+  if (maxLabel <= VTK_UNSIGNED_CHAR_MAX) {
+    return VTK_UNSIGNED_CHAR;
+  } else if (maxLabel <= VTK_UNSIGNED_SHORT_MAX) {
+    return VTK_UNSIGNED_SHORT;
+  }
+  return VTK_UNSIGNED_INT;
+}
+
+vtkSmartPointer<vtkDataArray> compact(vtkDataArray* labels)
+{
+  if (!labels || labels->GetNumberOfComponents() != 1) {
+    return nullptr;
+  }
+
+  const vtkIdType size = labels->GetNumberOfTuples();
+  uint64_t maximum = 0;
+  bool valid = false;
+  switch (labels->GetDataType()) {
+    vtkTemplateMacro(valid = labelRange(
+                       static_cast<VTK_TT*>(labels->GetVoidPointer(0)), size,
+                       maximum));
+  }
+  if (!valid || maximum > VTK_UNSIGNED_INT_MAX) {
+    return nullptr;
+  }
+
+  return convert(labels, smallestType(maximum));
+}
+
+vtkSmartPointer<vtkDataArray> convert(vtkDataArray* labels, int type)
+{
+  if (type == labels->GetDataType()) {
+    return labels;
+  }
+
+  const vtkIdType size = labels->GetNumberOfTuples();
+  vtkSmartPointer<vtkDataArray> output;
+  output.TakeReference(vtkDataArray::CreateDataArray(type));
+  output->SetName(labels->GetName());
+  output->SetNumberOfTuples(size);
+  switch (labels->GetDataType()) {
+    vtkTemplateMacro(convertLabels(
+      static_cast<VTK_TT*>(labels->GetVoidPointer(0)), output.Get(), size));
+  }
+  return output;
+}
+} // namespace LabelMap
+} // namespace tomviz
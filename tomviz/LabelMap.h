@@ -0,0 +1,32 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizLabelMap_h
+#define tomvizLabelMap_h
+
+#include <vtkSmartPointer.h>
+
+#include <cstdint>
+
+class vtkDataArray;
+
+namespace tomviz {
+
+namespace LabelMap {
+
+/// Smallest unsigned VTK integer type that can hold the labels 0..maxLabel.
+int smallestType(uint64_t maxLabel);
+
+/// Returns labels stored in the smallest unsigned integer type that holds all
+/// of its values, converting in parallel if needed. Labels already stored in
+/// that type are returned as is. Returns nullptr if the array is not a label
+/// map, i.e. it has several components or negative or fractional values.
+vtkSmartPointer<vtkDataArray> compact(vtkDataArray* labels);
+
+/// Returns labels converted to the unsigned integer type, which must hold all
+/// of its values. Labels already stored in that type are returned as is.
+vtkSmartPointer<vtkDataArray> convert(vtkDataArray* labels, int type);
+} // namespace LabelMap
+} // namespace tomviz
+
+#endif
@@ -18,6 +18,7 @@
 #include "PythonUtilities.h"
 #include "RAWFileReaderDialog.h"
 #include "RecentFilesMenu.h"
+#include "TimeSeries.h"
 #include "Utilities.h"
 
 #include <pqActiveObjects.h>
@@ -49,6 +50,7 @@
 #include <QFileDialog>
 #include <QFileInfo>
 #include <QJsonArray>
+#include <QMessageBox>
 
 #include <sstream>
 
@@ -124,6 +126,10 @@ QList<DataSource*> LoadDataReaction::loadData()
           << "Molecule files (*.xyz)"
           << "Text files (*.txt)";
 
+  foreach (auto format, FileFormatManager::instance().nativeFormats()) {
+    filters << format->fileDialogFilter();
+  }
+
   foreach (auto reader, FileFormatManager::instance().pythonReaderFactories()) {
     filters << reader->getFileDialogFilter();
   }
@@ -148,7 +154,20 @@ QList<DataSource*> LoadDataReaction::loadData()
     } else if (moleculeExt.contains(suffix)) {
       loadMolecule(filenames);
     } else {
-      dataSources << loadData(filenames);
+      QJsonObject options;
+      if (suffix == "emd") {
+        const int frames = TimeSeries::emdFrames(filenames).size();
+        if (frames > 1) {
+          auto answer = QMessageBox::question(
+            tomviz::mainWidget(), "Load as a time series?",
+            QString("The selection holds %1 volumes. Load them as the frames "
+                    "of one time series? Otherwise only the first volume is "
+                    "loaded.")
+              .arg(frames));
+          options["timeSeries"] = answer == QMessageBox::Yes;
+        }
+      }
+      dataSources << loadData(filenames, options);
     }
   }
 
@@ -181,6 +200,7 @@ DataSource* LoadDataReaction::loadData(const QStringList& fileNames,
   bool defaultModules = options["defaultModules"].toBool(true);
   bool addToRecent = options["addToRecent"].toBool(true);
   bool child = options["child"].toBool(false);
+  bool timeSeries = options["timeSeries"].toBool(false);
   bool loadWithParaview = true;
   bool loadWithPython = false;
 
@@ -193,13 +213,27 @@ DataSource* LoadDataReaction::loadData(const QStringList& fileNames,
   if (info.suffix().toLower() == "emd") {
     // Load the file using our simple EMD class.
     loadWithParaview = false;
+    // Several volumes, in several files or in the EMD groups of a file, are
+    // loaded as the frames of a time series when asked for, only the first
+    // volume is loaded otherwise.
+    QList<TimeSeriesFrame> frames;
+    if (timeSeries) {
+      frames = TimeSeries::emdFrames(fileNames);
+    }
     EmdFormat emdFile;
     vtkNew<vtkImageData> imageData;
-    if (emdFile.read(fileName.toLatin1().data(), imageData)) {
+    bool read = frames.size() > 1
+                  ? emdFile.read(frames[0].fileName.toLatin1().data(),
+                                 frames[0].group.toLatin1().data(), imageData)
+                  : emdFile.read(fileName.toLatin1().data(), imageData);
+    if (read) {
       DataSource::DataSourceType type = DataSource::hasTiltAngles(imageData)
                                           ? DataSource::TiltSeries
                                           : DataSource::Volume;
       dataSource = new DataSource(imageData, type);
+      if (frames.size() > 1) {
+        dataSource->setTimeSeries(new TimeSeries(frames, dataSource));
+      }
       LoadDataReaction::dataSourceAdded(dataSource, defaultModules, child);
     }
   } else if (info.completeSuffix().endsWith("ome.tif")) {
@@ -241,6 +275,14 @@ DataSource* LoadDataReaction::loadData(const QStringList& fileNames,
 
     dataSource->setReaderProperties(props.toVariantMap());
 
+  } else if (auto format = FileFormatManager::instance().nativeFormat(
+               info.suffix().toLower())) {
+    loadWithParaview = false;
+    vtkNew<vtkImageData> imageData;
+    if (format->read(fileName, imageData)) {
+      dataSource = new DataSource(imageData);
+      LoadDataReaction::dataSourceAdded(dataSource, defaultModules, child);
+    }
   } else if (FileFormatManager::instance().pythonReaderFactory(
                info.suffix().toLower()) != nullptr) {
     loadWithParaview = false;
@@ -47,7 +47,8 @@ public:
 
   /// Load data files from the specified locations, options can be used to pass
   /// additional parameters to the method, such as defaultModules, addToRecent,
-  /// and child, or pvXML to pass to the ParaView reader.
+  /// and child, or pvXML to pass to the ParaView reader. With timeSeries set,
+  /// the volumes of EMD files are loaded as the frames of a time series.
   static DataSource* loadData(const QStringList& fileNames,
                               const QJsonObject& options = QJsonObject());
 
@@ -21,6 +21,7 @@
 #include "AcquisitionWidget.h"
 #include "ActiveObjects.h"
 #include "AddAlignReaction.h"
+#include "AddOperatorReaction.h"
 #include "AddPythonTransformReaction.h"
 #include "AxesReaction.h"
 #include "Behaviors.h"
@@ -317,16 +318,11 @@ MainWindow::MainWindow(QWidget* parent, Qt::WindowFlags flags)
     readInJSONDescription("GenerateTiltSeries"));
 
   new AddAlignReaction(alignAction);
-  new AddPythonTransformReaction(downsampleByTwoAction, "Bin Tilt Image x2",
-                                 readInPythonScript("BinTiltSeriesByTwo"),
-                                 false, false, false);
+  new AddOperatorReaction(downsampleByTwoAction, "Bin");
   new AddPythonTransformReaction(
     removeBadPixelsAction, "Remove Bad Pixels",
     readInPythonScript("RemoveBadPixelsTiltSeries"), false, false, false);
-  new AddPythonTransformReaction(
-    gaussianFilterAction, "Gaussian Filter Tilt Series",
-    readInPythonScript("GaussianFilterTiltSeries"), false, false, false,
-    readInJSONDescription("GaussianFilterTiltSeries"));
+  new AddOperatorReaction(gaussianFilterAction, "GaussianFilter");
   new AddPythonTransformReaction(
     autoSubtractBackgroundAction, "Background Subtraction (Auto)",
     readInPythonScript("Subtract_TiltSer_Background_Auto"), false, false,
@@ -504,12 +500,25 @@ MainWindow::MainWindow(QWidget* parent, Qt::WindowFlags flags)
 MainWindow::~MainWindow()
 {
   ModuleManager::instance().reset();
+  if (m_batchMode) {
+    return;
+  }
   QString autosaveFile = getAutosaveFile();
   if (QFile::exists(autosaveFile) && !QFile::remove(autosaveFile)) {
     std::cerr << "Failed to remove autosave file." << std::endl;
   }
 }
 
+void MainWindow::setBatchMode(bool batch)
+{
+  m_batchMode = batch;
+  if (batch) {
+    m_timer->stop();
+  } else if (!m_timer->isActive()) {
+    m_timer->start();
+  }
+}
+
 std::vector<OperatorDescription> MainWindow::initPython()
 {
   Python::initialize();
@@ -36,6 +36,11 @@ public:
   MainWindow(QWidget* parent = nullptr, Qt::WindowFlags flags = nullptr);
   ~MainWindow() override;
 
+  /// In batch mode the window is never shown, it only holds the views, so
+  /// the state is not autosaved and the autosave file of an interactive
+  /// session is left in place.
+  void setBatchMode(bool batch);
+
 protected:
   void showEvent(QShowEvent* event) override;
   void closeEvent(QCloseEvent* event) override;
@@ -89,6 +94,7 @@ private:
   QMenu* m_customTransformsMenu = nullptr;
   QTimer* m_timer = nullptr;
   bool m_isFirstShow = true;
+  bool m_batchMode = false;
 
   // Lazily loaded dialogs
   QWidget* m_aboutDialog = nullptr;
@@ -0,0 +1,107 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizMemoryCache_h
+#define tomvizMemoryCache_h
+
+#include <vtkSmartPointer.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <list>
+
+namespace tomviz {
+
+/// Least recently used cache of VTK objects bounded by the memory they hold,
+/// the size of an object is given when it is inserted. Lookups are linear in
+/// the number of entries, which stays small as the entries are large.
+template <typename Key, typename T>
+class MemoryCache
+{
+public:
+  explicit MemoryCache(size_t maximumSize) : m_maximumSize(maximumSize) {}
+
+  /// Set the maximum memory held by the cached objects in bytes, objects are
+  /// evicted until the cache fits.
+  void setMaximumSize(size_t bytes)
+  {
+    m_maximumSize = bytes;
+    evict();
+  }
+  size_t maximumSize() const { return m_maximumSize; }
+
+  /// The cached object, or nullptr. A hit makes the object the most recently
+  /// used one.
+  vtkSmartPointer<T> find(const Key& key)
+  {
+    auto it = entry(key);
+    if (it == m_entries.end()) {
+      return nullptr;
+    }
+    m_entries.splice(m_entries.begin(), m_entries, it);
+    return it->object;
+  }
+
+  bool contains(const Key& key) const
+  {
+    return std::any_of(m_entries.begin(), m_entries.end(),
+                       [&key](const Entry& e) { return e.key == key; });
+  }
+
+  /// Add an object holding size bytes, replacing any object with the same
+  /// key. Objects larger than the cache are not kept.
+  void insert(const Key& key, T* object, size_t size)
+  {
+    auto it = entry(key);
+    if (it != m_entries.end()) {
+      m_size -= it->size;
+      m_entries.erase(it);
+    }
+    if (!object || size > m_maximumSize) {
+      return;
+    }
+    m_entries.push_front({ key, size, object });
+    m_size += size;
+    evict();
+  }
+
+  void clear()
+  {
+    m_entries.clear();
+    m_size = 0;
+  }
+
+  /// Memory held by the cached objects in bytes.
+  size_t size() const { return m_size; }
+  int count() const { return static_cast<int>(m_entries.size()); }
+
+private:
+  struct Entry
+  {
+    Key key;
+    size_t size;
+    vtkSmartPointer<T> object;
+  };
+
+  typename std::list<Entry>::iterator entry(const Key& key)
+  {
+    return std::find_if(m_entries.begin(), m_entries.end(),
+                        [&key](const Entry& e) { return e.key == key; });
+  }
+
+  void evict()
+  {
+    while (m_size > m_maximumSize && !m_entries.empty()) {
+      m_size -= m_entries.back().size;
+      m_entries.pop_back();
+    }
+  }
+
+  // The most recently used entry comes first.
+  std::list<Entry> m_entries;
+  size_t m_maximumSize;
+  size_t m_size = 0;
+};
+} // namespace tomviz
+
+#endif
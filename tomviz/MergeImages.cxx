@@ -0,0 +1,207 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "MergeImages.h"
+
+#include "ParallelFor.h"
+
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkPointData.h>
+
+#include <QSet>
+
+#include <algorithm>
+#include <cmath>
+
+namespace tomviz {
+
+namespace MergeImages {
+
+namespace {
+
+// Tuples per tile, the tile of the output stays in cache while each input
+// array is copied into it.
+const int64_t TileSize = 16384;
+
+std::vector<vtkDataArray*> pointArrays(const std::vector<vtkImageData*>& images)
+{
+  std::vector<vtkDataArray*> arrays;
+  for (auto image : images) {
+    auto pointData = image->GetPointData();
+    for (int i = 0; i < pointData->GetNumberOfArrays(); ++i) {
+      if (auto array = pointData->GetArray(i)) {
+        arrays.push_back(array);
+      }
+    }
+  }
+  return arrays;
+}
+
+template <typename Out>
+void merge(const std::vector<vtkDataArray*>& arrays, Out* output,
+           int outComponents, vtkIdType tuples)
+{
+  parallelFor(0, tuples, TileSize, [&](int64_t begin, int64_t end) {
+    int offset = 0;
+    for (auto array : arrays) {
+      const int components = array->GetNumberOfComponents();
+      switch (array->GetDataType()) {
+        vtkTemplateMacro(interleave(
+          static_cast<const VTK_TT*>(array->GetVoidPointer(0)), components,
+          output, outComponents, offset, begin, end));
+      }
+      offset += components;
+    }
+  });
+}
+
+QString extentString(const int extent[6])
+{
+  return QString("[%1 %2 %3 %4 %5 %6]")
+    .arg(extent[0])
+    .arg(extent[1])
+    .arg(extent[2])
+    .arg(extent[3])
+    .arg(extent[4])
+    .arg(extent[5]);
+}
+
+vtkSmartPointer<vtkImageData> emptyImage(vtkImageData* reference)
+{
+  auto image = vtkSmartPointer<vtkImageData>::New();
+  image->SetExtent(reference->GetExtent());
+  image->SetSpacing(reference->GetSpacing());
+  image->SetOrigin(reference->GetOrigin());
+  return image;
+}
+} // namespace
+
+QString validate(const std::vector<vtkImageData*>& images)
+{
+  if (images.size() < 2) {
+    return "At least two images are needed.";
+  }
+
+  auto reference = images.front();
+  int refExtent[6];
+  reference->GetExtent(refExtent);
+  double refSpacing[3];
+  reference->GetSpacing(refSpacing);
+  for (size_t i = 1; i < images.size(); ++i) {
+    int extent[6];
+    images[i]->GetExtent(extent);
+    if (!std::equal(refExtent, refExtent + 6, extent)) {
+      return QString("Image %1 has extent %2, the first image %3.")
+        .arg(i + 1)
+        .arg(extentString(extent))
+        .arg(extentString(refExtent));
+    }
+    double spacing[3];
+    images[i]->GetSpacing(spacing);
+    for (int j = 0; j < 3; ++j) {
+      if (std::abs(spacing[j] - refSpacing[j]) >
+          1e-6 * std::abs(refSpacing[j])) {
+        return QString("Image %1 has spacing %2 %3 %4, the first image "
+                       "%5 %6 %7.")
+          .arg(i + 1)
+          .arg(spacing[0])
+          .arg(spacing[1])
+          .arg(spacing[2])
+          .arg(refSpacing[0])
+          .arg(refSpacing[1])
+          .arg(refSpacing[2]);
+      }
+    }
+  }
+  return QString();
+}
+
+vtkSmartPointer<vtkImageData> appendArrays(
+  const std::vector<vtkImageData*>& images)
+{
+  if (!validate(images).isEmpty()) {
+    return nullptr;
+  }
+
+  auto output = emptyImage(images.front());
+  auto outPointData = output->GetPointData();
+  QSet<QString> names;
+  for (size_t i = 0; i < images.size(); ++i) {
+    auto pointData = images[i]->GetPointData();
+    for (int j = 0; j < pointData->GetNumberOfArrays(); ++j) {
+      auto array = pointData->GetArray(j);
+      if (!array) {
+        continue;
+      }
+      QString name = array->GetName() ? array->GetName() : "";
+      if (names.contains(name)) {
+        name = QString("%1_input_%2").arg(name).arg(i);
+      }
+      names.insert(name);
+
+      // A new array sharing the buffer, so renaming it leaves the input be.
+      vtkSmartPointer<vtkDataArray> shared;
+      shared.TakeReference(array->NewInstance());
+      shared->ShallowCopy(array);
+      shared->SetName(name.toUtf8().data());
+      outPointData->AddArray(shared);
+    }
+  }
+  if (outPointData->GetNumberOfArrays() > 0) {
+    outPointData->SetActiveScalars(outPointData->GetArrayName(0));
+  }
+  return output;
+}
+
+vtkSmartPointer<vtkImageData> mergeComponents(
+  const std::vector<vtkImageData*>& images)
+{
+  if (!validate(images).isEmpty()) {
+    return nullptr;
+  }
+  auto arrays = pointArrays(images);
+  if (arrays.empty()) {
+    return nullptr;
+  }
+
+  int components = 0;
+  for (auto array : arrays) {
+    components += array->GetNumberOfComponents();
+  }
+  const vtkIdType tuples = images.front()->GetNumberOfPoints();
+
+  vtkSmartPointer<vtkDataArray> merged;
+  merged.TakeReference(vtkDataArray::CreateDataArray(mergedType(arrays)));
+  merged->SetName("Merged");
+  merged->SetNumberOfComponents(components);
+  merged->SetNumberOfTuples(tuples);
+  switch (merged->GetDataType()) {
+    vtkTemplateMacro(merge(arrays,
+                           static_cast<VTK_TT*>(merged->GetVoidPointer(0)),
+                           components, tuples));
+  }
+
+  auto output = emptyImage(images.front());
+  output->GetPointData()->SetScalars(merged);
+  return output;
+}
+
+int mergedType(const std::vector<vtkDataArray*>& arrays)
+{
+  const int type = arrays.front()->GetDataType();
+  bool same = true;
+  bool wide = false;
+  for (auto array : arrays) {
+    const int arrayType = array->GetDataType();
+    same = same && arrayType == type;
+    wide = wide || arrayType == VTK_DOUBLE ||
+           (arrayType != VTK_FLOAT && array->GetDataTypeSize() > 2);
+  }
+  if (same) {
+    return type;
+  }
+  return wide ? VTK_DOUBLE : VTK_FLOAT;
+}
+} // namespace MergeImages
+} // namespace tomviz
@@ -0,0 +1,65 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizMergeImages_h
+#define tomvizMergeImages_h
+
+#include <vtkSmartPointer.h>
+#include <vtkType.h>
+
+#include <QString>
+
+#include <cstdint>
+#include <vector>
+
+class vtkDataArray;
+class vtkImageData;
+
+namespace tomviz {
+
+/// Merging of images sampled on the same grid, such as the channels of an
+/// EDS acquisition, into one image.
+namespace MergeImages {
+
+/// Check the images can be merged, they must have the same extent and
+/// spacing. Returns a description of the first mismatch, empty if they can.
+/// The origin of the merged image is the one of the first image.
+QString validate(const std::vector<vtkImageData*>& images);
+
+/// An image with the point arrays of all of the images, in order. The arrays
+/// share the buffers of the input arrays, nothing is copied. Names used by
+/// an earlier image get the suffix "_input_<index>", as ParaView's
+/// AppendAttributes does. Returns nullptr if the images cannot be merged.
+vtkSmartPointer<vtkImageData> appendArrays(
+  const std::vector<vtkImageData*>& images);
+
+/// An image with a single point array, "Merged", holding the components of
+/// all of the point arrays of the images, in order. The array is allocated
+/// once and filled in parallel tiles of tuples. Returns nullptr if the images
+/// cannot be merged.
+vtkSmartPointer<vtkImageData> mergeComponents(
+  const std::vector<vtkImageData*>& images);
+
+/// The type of the merged components: the type of the arrays if they all
+/// have the same, otherwise float, or double if one of them is double or an
+/// integer wider than 16 bits.
+int mergedType(const std::vector<vtkDataArray*>& arrays);
+
+/// Copy the tuples [begin, end) of input, of inComponents, to the components
+/// [offset, offset + inComponents) of output, of outComponents.
+template <typename In, typename Out>
+void interleave(const In* input, int inComponents, Out* output,
+                int outComponents, int offset, int64_t begin, int64_t end)
+{
+  for (int64_t t = begin; t < end; ++t) {
+    const In* in = input + t * inComponents;
+    Out* out = output + t * outComponents + offset;
+    for (int c = 0; c < inComponents; ++c) {
+      out[c] = static_cast<Out>(in[c]);
+    }
+  }
+}
+} // namespace MergeImages
+} // namespace tomviz
+
+#endif
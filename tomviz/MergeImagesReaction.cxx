@@ -3,23 +3,17 @@
 
 #include "MergeImagesReaction.h"
 
-#include "ActiveObjects.h"
 #include "DataSource.h"
 #include "LoadDataReaction.h"
+#include "MergeImages.h"
 #include "MergeImagesDialog.h"
+#include "Utilities.h"
 
 #include <QFileInfo>
+#include <QMessageBox>
 #include <QSet>
 
-#include <vtkPVArrayInformation.h>
-#include <vtkPVDataInformation.h>
-#include <vtkPVDataSetAttributesInformation.h>
-#include <vtkSMPropertyHelper.h>
-#include <vtkSMSessionProxyManager.h>
-#include <vtkSMSourceProxy.h>
-
-#include <algorithm>
-#include <sstream>
+#include <vtkImageData.h>
 
 namespace tomviz {
 
@@ -43,6 +37,13 @@ void MergeImagesReaction::onTriggered()
     return;
   }
 
+  auto error = MergeImages::validate(images());
+  if (!error.isEmpty()) {
+    QMessageBox::warning(tomviz::mainWidget(), "Merge Images",
+                         "The images cannot be merged. " + error);
+    return;
+  }
+
   DataSource* newSource = nullptr;
   if (dialog.getMode() == MergeImagesDialog::Arrays) {
     newSource = mergeArrays();
@@ -63,110 +64,51 @@ void MergeImagesReaction::updateDataSources(QSet<DataSource*> sources)
 
 void MergeImagesReaction::updateEnableState()
 {
-  bool enabled = m_dataSources.size() > 1;
-
-  // Check for compatibility of the DataSource extents. Ignore overlap in
-  // physical space for now.
-  if (enabled) {
-    QList<DataSource*> sourceList = m_dataSources.toList();
-    auto info = sourceList[0]->proxy()->GetDataInformation();
-    int refExtent[6];
-    info->GetExtent(refExtent);
-
-    // Check against other DataSource extents
-    for (int i = 0; i < m_dataSources.size(); ++i) {
-      info = sourceList[i]->proxy()->GetDataInformation();
-      int thisExtent[6];
-      info->GetExtent(thisExtent);
-      enabled = enabled && std::equal(refExtent, refExtent + 6, thisExtent);
+  // Ignore overlap in physical space for now.
+  parentAction()->setEnabled(MergeImages::validate(images()).isEmpty());
+}
+
+std::vector<vtkImageData*> MergeImagesReaction::images() const
+{
+  std::vector<vtkImageData*> images;
+  foreach (DataSource* source, m_dataSources) {
+    if (auto image = vtkImageData::SafeDownCast(source->dataObject())) {
+      images.push_back(image);
     }
   }
-
-  parentAction()->setEnabled(enabled);
+  return images;
 }
 
 DataSource* MergeImagesReaction::mergeArrays()
 {
-  if (m_dataSources.size() < 1) {
+  auto image = MergeImages::appendArrays(images());
+  if (!image) {
     return nullptr;
   }
 
   QList<DataSource*> sourceList = m_dataSources.toList();
-
-  // Eventually, we'll offer the option to merge compontents in a single array.
-  // For now, we will simply append the point data arrays.
-  vtkSMSessionProxyManager* pxm = ActiveObjects::instance().proxyManager();
-  vtkSMSourceProxy* filter = vtkSMSourceProxy::SafeDownCast(
-    pxm->NewProxy("filters", "AppendAttributes"));
-  Q_ASSERT(filter);
-
-  for (int i = 0; i < sourceList.size(); ++i) {
-    vtkSMPropertyHelper(filter, "Input").Add(sourceList[i]->proxy(), 0);
-  }
-
-  filter->UpdateVTKObjects();
-  filter->UpdatePipeline();
-
-  DataSource* newSource = new DataSource(filter);
+  DataSource* newSource = new DataSource(image);
   QString mergedFilename(QFileInfo(sourceList[0]->fileName()).baseName());
   for (int i = 1; i < sourceList.size(); ++i) {
     mergedFilename.append(" + ");
     mergedFilename.append(QFileInfo(sourceList[i]->fileName()).baseName());
   }
   newSource->setFileName(mergedFilename);
-  filter->Delete();
+  newSource->setPersistenceState(DataSource::PersistenceState::Modified);
 
   return newSource;
 }
 
 DataSource* MergeImagesReaction::mergeComponents()
 {
-  if (m_dataSources.size() < 1) {
+  auto image = MergeImages::mergeComponents(images());
+  if (!image) {
     return nullptr;
   }
 
-  QList<DataSource*> sourceList = m_dataSources.toList();
-
-  vtkSMSessionProxyManager* pxm = ActiveObjects::instance().proxyManager();
-  vtkSMSourceProxy* filter = vtkSMSourceProxy::SafeDownCast(
-    pxm->NewProxy("filters", "PythonCalculator"));
-  Q_ASSERT(filter);
-
-  std::stringstream expression;
-  expression << "np.transpose(np.vstack((";
-
-  for (int i = 0; i < sourceList.size(); ++i) {
-    vtkSMPropertyHelper(filter, "Input").Add(sourceList[i]->proxy(), 0);
-
-    auto info = sourceList[0]->proxy()->GetDataInformation();
-    auto pointData = info->GetPointDataInformation();
-    for (int j = 0; j < pointData->GetNumberOfArrays(); ++j) {
-      auto arrayInfo = pointData->GetArrayInformation(j);
-      std::string arrayName(arrayInfo->GetName());
-      expression << "inputs[" << i << "].PointData['" << arrayName << "']";
-      if (i < sourceList.size() - 1 || j < pointData->GetNumberOfArrays() - 1) {
-        expression << ", ";
-      }
-    }
-  }
-
-  // Arrange columns
-  expression << ")))";
-
-  std::cout << "expression: " << expression.str() << std::endl;
-
-  // Set the Python expression for arranging the components in the output
-  vtkSMPropertyHelper(filter, "ArrayAssociation").Set(0);
-  vtkSMPropertyHelper(filter, "CopyArrays").Set(0);
-  vtkSMPropertyHelper(filter, "Expression").Set(expression.str().c_str());
-  vtkSMPropertyHelper(filter, "ArrayName").Set("Merged");
-
-  filter->UpdateVTKObjects();
-  filter->UpdatePipeline();
-
-  DataSource* newSource = new DataSource(filter);
+  DataSource* newSource = new DataSource(image);
   newSource->setFileName("Merged Image");
-  filter->Delete();
+  newSource->setPersistenceState(DataSource::PersistenceState::Modified);
 
   return newSource;
 }
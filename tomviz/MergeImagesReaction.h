@@ -8,6 +8,10 @@
 
 #include <QSet>
 
+#include <vector>
+
+class vtkImageData;
+
 namespace tomviz {
 
 class DataSource;
@@ -29,6 +33,9 @@ protected:
   DataSource* mergeArrays();
   DataSource* mergeComponents();
 
+  /// The data of the selected data sources.
+  std::vector<vtkImageData*> images() const;
+
 private:
   Q_DISABLE_COPY(MergeImagesReaction)
 
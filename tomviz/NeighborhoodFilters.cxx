@@ -0,0 +1,28 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "NeighborhoodFilters.h"
+
+namespace tomviz {
+
+namespace NeighborhoodFilters {
+
+std::vector<double> gaussianKernel(double sigma)
+{
+  if (sigma <= 0.0) {
+    return { 1.0 };
+  }
+  const int radius = static_cast<int>(4.0 * sigma + 0.5);
+  std::vector<double> weights(2 * radius + 1);
+  double sum = 0.0;
+  for (int i = -radius; i <= radius; ++i) {
+    weights[i + radius] = std::exp(-0.5 * i * i / (sigma * sigma));
+    sum += weights[i + radius];
+  }
+  for (auto& weight : weights) {
+    weight /= sum;
+  }
+  return weights;
+}
+} // namespace NeighborhoodFilters
+} // namespace tomviz
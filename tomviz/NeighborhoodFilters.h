@@ -0,0 +1,458 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizNeighborhoodFilters_h
+#define tomvizNeighborhoodFilters_h
+
+#include "ParallelFor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <map>
+#include <type_traits>
+#include <vector>
+
+namespace tomviz {
+
+namespace NeighborhoodFilters {
+
+/// Index of sample i of an axis of n samples, with the axis mirrored about
+/// its ends as in the 'reflect' mode of scipy.ndimage (d c b a | a b c d).
+inline int reflect(int i, int n)
+{
+  const int period = 2 * n;
+  i %= period;
+  if (i < 0) {
+    i += period;
+  }
+  return i < n ? i : period - 1 - i;
+}
+
+/// Normalized weights of a Gaussian of standard deviation sigma, in samples,
+/// truncated at four standard deviations as scipy.ndimage.gaussian_filter
+/// truncates it. A sigma of zero gives the single weight one.
+std::vector<double> gaussianKernel(double sigma);
+
+/// Smooth a single component volume in place with a Gaussian of standard
+/// deviation sigma[i], in voxels, along axis i, matching
+/// scipy.ndimage.gaussian_filter. See smooth() for how the volume is
+/// traversed. Returns false if canceled, the data is then partly filtered.
+template <typename T>
+bool gaussian(T* data, const int dims[3], const double sigma[3],
+              const std::function<bool()>& canceled = nullptr);
+
+/// Sharpen a single component volume in place, following ITK's
+/// UnsharpMaskImageFilter: where the difference d between a voxel and its
+/// Gaussian blur exceeds threshold in magnitude, amount times the part of d
+/// past the threshold is added to the voxel. The blur is computed a slice
+/// at a time as the volume is written, no blurred volume is ever held.
+/// Returns false if canceled, the data is then partly filtered.
+template <typename T>
+bool unsharpMask(T* data, const int dims[3], const double sigma[3],
+                 double amount, double threshold,
+                 const std::function<bool()>& canceled = nullptr);
+
+/// Replace each voxel of a single component volume by the median of the
+/// size[0] x size[1] x size[2] window around it, matching
+/// scipy.ndimage.median_filter: windows of even size extend one voxel
+/// further back than forward, the upper median of an even count is taken
+/// and the volume is reflected at its ends. For 8 and 16 bit integers the
+/// window is kept as a histogram that slides along x, a step adds and
+/// removes one y-z plane of the window and the median is found in a two
+/// level histogram, independent of the window size. Other types select the
+/// median of each window. Rows run in parallel. Returns false, leaving data
+/// intact, if canceled.
+template <typename T>
+bool median(T* data, const int dims[3], const int size[3],
+            const std::function<bool()>& canceled = nullptr);
+
+/// Call filter(component) on each component of a volume of count
+/// interleaved components, component being a single component volume the
+/// filter works on in place. Multi-component volumes are filtered one
+/// component at a time through a copy of the component. Returns false as
+/// soon as the filter does, the components before it are then filtered.
+template <typename T, typename Filter>
+bool eachComponent(T* data, const int dims[3], int count, Filter&& filter)
+{
+  if (count == 1) {
+    return filter(data);
+  }
+  const int64_t n = static_cast<int64_t>(dims[0]) * dims[1] * dims[2];
+  std::vector<T> component(n);
+  for (int c = 0; c < count; ++c) {
+    parallelFor(0, n, [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; ++i) {
+        component[i] = data[i * count + c];
+      }
+    });
+    if (!filter(component.data())) {
+      return false;
+    }
+    parallelFor(0, n, [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; ++i) {
+        data[i * count + c] = component[i];
+      }
+    });
+  }
+  return true;
+}
+
+namespace detail {
+
+/// Intermediate values are float, double for double data.
+template <typename T>
+using Real =
+  typename std::conditional<std::is_same<T, double>::value, double,
+                            float>::type;
+
+template <typename T, typename R,
+          typename std::enable_if<std::is_integral<T>::value>::type* = nullptr>
+T clampCast(R value)
+{
+  const R rounded = std::round(value);
+  if (rounded <= static_cast<R>(std::numeric_limits<T>::lowest())) {
+    return std::numeric_limits<T>::lowest();
+  }
+  if (rounded >= static_cast<R>(std::numeric_limits<T>::max())) {
+    return std::numeric_limits<T>::max();
+  }
+  return static_cast<T>(rounded);
+}
+
+template <typename T, typename R,
+          typename std::enable_if<!std::is_integral<T>::value>::type* = nullptr>
+T clampCast(R value)
+{
+  return static_cast<T>(value);
+}
+
+/// Blur slice along x and y into blurred, rows are padded by reflection into
+/// line so the convolution itself has no boundary checks.
+template <typename T, typename R>
+void blurSlice(const T* slice, int nx, int ny, const std::vector<double>& kx,
+               const std::vector<double>& ky, R* blurred, std::vector<R>& line,
+               std::vector<R>& rows)
+{
+  const int rx = static_cast<int>(kx.size()) / 2;
+  const int ry = static_cast<int>(ky.size()) / 2;
+  const int64_t sliceSize = static_cast<int64_t>(nx) * ny;
+  rows.resize(sliceSize);
+  line.resize(nx + 2 * rx);
+  for (int y = 0; y < ny; ++y) {
+    const T* row = slice + static_cast<int64_t>(y) * nx;
+    for (int x = -rx; x < nx + rx; ++x) {
+      line[x + rx] = static_cast<R>(row[reflect(x, nx)]);
+    }
+    R* out = &rows[static_cast<int64_t>(y) * nx];
+    for (int x = 0; x < nx; ++x) {
+      R sum = 0;
+      for (size_t k = 0; k < kx.size(); ++k) {
+        sum += static_cast<R>(kx[k]) * line[x + k];
+      }
+      out[x] = sum;
+    }
+  }
+  for (int y = 0; y < ny; ++y) {
+    R* out = blurred + static_cast<int64_t>(y) * nx;
+    std::fill(out, out + nx, R(0));
+    for (size_t k = 0; k < ky.size(); ++k) {
+      const R weight = static_cast<R>(ky[k]);
+      const R* row =
+        &rows[static_cast<int64_t>(reflect(y + static_cast<int>(k) - ry, ny)) *
+              nx];
+      for (int x = 0; x < nx; ++x) {
+        out[x] += weight * row[x];
+      }
+    }
+  }
+}
+
+/// Blur the volume with a separable Gaussian and hand each blurred slice to
+/// combine(slice, blurred, count), which writes the result into the slice
+/// in place. The z range is split into one chunk per thread. Each chunk
+/// walks its slices in order, keeping the x-y blur of the 2r + 1 slices
+/// around the current one in a ring, r being the radius of the z kernel. A
+/// slice is only written once no later slice of its chunk needs it. The
+/// slices a chunk needs from its neighbours are blurred along x and y up
+/// front, before any slice is written.
+template <typename T, typename Combine>
+bool smooth(T* data, const int dims[3], const double sigma[3],
+            Combine combine, const std::function<bool()>& canceled)
+{
+  using R = Real<T>;
+
+  const int nx = dims[0];
+  const int ny = dims[1];
+  const int nz = dims[2];
+  const int64_t sliceSize = static_cast<int64_t>(nx) * ny;
+  const auto kx = gaussianKernel(sigma[0]);
+  const auto ky = gaussianKernel(sigma[1]);
+  const auto kz = gaussianKernel(sigma[2]);
+  const int rz = static_cast<int>(kz.size()) / 2;
+
+  const int64_t threads = parallelThreadCount();
+  const int grain = static_cast<int>((nz + threads - 1) / threads);
+  const int chunks = (nz + grain - 1) / grain;
+
+  // The slices outside of each chunk that it needs, blurred along x and y.
+  std::map<int, std::vector<R>> halos;
+  for (int c = 0; c < chunks; ++c) {
+    const int begin = c * grain;
+    const int end = std::min(begin + grain, nz);
+    for (int z = begin - rz; z < end + rz; ++z) {
+      const int index = reflect(z, nz);
+      if (index < begin || index >= end) {
+        halos[index];
+      }
+    }
+  }
+  std::vector<int> haloIndices;
+  for (auto& halo : halos) {
+    halo.second.resize(sliceSize);
+    haloIndices.push_back(halo.first);
+  }
+  const int64_t numberOfHalos = haloIndices.size();
+  parallelFor(0, numberOfHalos, 1, [&](int64_t begin, int64_t end) {
+    std::vector<R> line;
+    std::vector<R> rows;
+    for (int64_t i = begin; i < end; ++i) {
+      const int index = haloIndices[i];
+      blurSlice(data + index * sliceSize, nx, ny, kx, ky,
+                halos.find(index)->second.data(), line, rows);
+    }
+  });
+
+  std::atomic<bool> stopped(false);
+  parallelFor(0, chunks, 1, [&](int64_t chunkBegin, int64_t chunkEnd) {
+    std::vector<R> line;
+    std::vector<R> rows;
+    std::vector<R> blurred(sliceSize);
+    const int window = 2 * rz + 1;
+    std::vector<std::vector<R>> ring(window, std::vector<R>(sliceSize));
+    for (int64_t c = chunkBegin; c < chunkEnd; ++c) {
+      const int begin = static_cast<int>(c) * grain;
+      const int end = std::min(begin + grain, nz);
+      std::vector<int> ringIndex(window, -1);
+      auto slice = [&](int index) -> const R* {
+        if (index < begin || index >= end) {
+          return halos.find(index)->second.data();
+        }
+        const int slot = index % window;
+        if (ringIndex[slot] != index) {
+          blurSlice(data + index * sliceSize, nx, ny, kx, ky,
+                    ring[slot].data(), line, rows);
+          ringIndex[slot] = index;
+        }
+        return ring[slot].data();
+      };
+      for (int z = begin; z < end; ++z) {
+        if (stopped || (canceled && canceled())) {
+          stopped = true;
+          return;
+        }
+        std::fill(blurred.begin(), blurred.end(), R(0));
+        for (int k = 0; k < window; ++k) {
+          const R weight = static_cast<R>(kz[k]);
+          const R* source = slice(reflect(z + k - rz, nz));
+          for (int64_t i = 0; i < sliceSize; ++i) {
+            blurred[i] += weight * source[i];
+          }
+        }
+        combine(data + z * sliceSize, blurred.data(), sliceSize);
+      }
+    }
+  });
+  return !stopped;
+}
+
+/// Median of each window using a histogram of the window that slides along
+/// x, for 8 and 16 bit integers.
+template <typename T>
+void medianRowsHistogram(const T* input, const int dims[3], const int lo[3],
+                         const int hi[3], T* output, int64_t rowBegin,
+                         int64_t rowEnd)
+{
+  const int nx = dims[0];
+  const int ny = dims[1];
+  const int nz = dims[2];
+  const int bins = 1 << (8 * sizeof(T));
+  const int shift = sizeof(T) == 1 ? 4 : 8;
+  const int lowest = static_cast<int>(std::numeric_limits<T>::lowest());
+  std::vector<int> fine(bins, 0);
+  std::vector<int> coarse(bins >> shift, 0);
+  const int count = (lo[0] + hi[0] + 1) * (lo[1] + hi[1] + 1) *
+                    (lo[2] + hi[2] + 1);
+  const int rank = count / 2;
+
+  std::vector<const T*> rows;
+  for (int64_t r = rowBegin; r < rowEnd; ++r) {
+    const int y = static_cast<int>(r % ny);
+    const int z = static_cast<int>(r / ny);
+    rows.clear();
+    for (int dz = -lo[2]; dz <= hi[2]; ++dz) {
+      for (int dy = -lo[1]; dy <= hi[1]; ++dy) {
+        const int64_t row = static_cast<int64_t>(reflect(z + dz, nz)) * ny +
+                            reflect(y + dy, ny);
+        rows.push_back(input + row * nx);
+      }
+    }
+    auto addColumn = [&](int x, int delta) {
+      const int column = reflect(x, nx);
+      for (auto row : rows) {
+        const int bin = static_cast<int>(row[column]) - lowest;
+        fine[bin] += delta;
+        coarse[bin >> shift] += delta;
+      }
+    };
+
+    for (int x = -lo[0]; x <= hi[0]; ++x) {
+      addColumn(x, 1);
+    }
+    T* out = output + r * nx;
+    for (int x = 0; x < nx; ++x) {
+      // Find the coarse bin holding the rank, then the fine bin within it.
+      int below = 0;
+      int c = 0;
+      while (below + coarse[c] <= rank) {
+        below += coarse[c++];
+      }
+      int bin = c << shift;
+      while (below + fine[bin] <= rank) {
+        below += fine[bin++];
+      }
+      out[x] = static_cast<T>(bin + lowest);
+      if (x + 1 < nx) {
+        addColumn(x - lo[0], -1);
+        addColumn(x + 1 + hi[0], 1);
+      }
+    }
+    // Empty the histogram for the next row.
+    for (int x = nx - 1 - lo[0]; x <= nx - 1 + hi[0]; ++x) {
+      addColumn(x, -1);
+    }
+  }
+}
+
+/// Median of each window by selection, for any type.
+template <typename T>
+void medianRowsSelect(const T* input, const int dims[3], const int lo[3],
+                      const int hi[3], T* output, int64_t rowBegin,
+                      int64_t rowEnd)
+{
+  const int nx = dims[0];
+  const int ny = dims[1];
+  const int nz = dims[2];
+  std::vector<T> window;
+  for (int64_t r = rowBegin; r < rowEnd; ++r) {
+    const int y = static_cast<int>(r % ny);
+    const int z = static_cast<int>(r / ny);
+    T* out = output + r * nx;
+    for (int x = 0; x < nx; ++x) {
+      window.clear();
+      for (int dz = -lo[2]; dz <= hi[2]; ++dz) {
+        for (int dy = -lo[1]; dy <= hi[1]; ++dy) {
+          const int64_t row = static_cast<int64_t>(reflect(z + dz, nz)) * ny +
+                              reflect(y + dy, ny);
+          const T* values = input + row * nx;
+          for (int dx = -lo[0]; dx <= hi[0]; ++dx) {
+            window.push_back(values[reflect(x + dx, nx)]);
+          }
+        }
+      }
+      auto middle = window.begin() + window.size() / 2;
+      std::nth_element(window.begin(), middle, window.end());
+      out[x] = *middle;
+    }
+  }
+}
+
+template <typename T>
+void medianRows(std::true_type, const T* input, const int dims[3],
+                const int lo[3], const int hi[3], T* output, int64_t begin,
+                int64_t end)
+{
+  medianRowsHistogram(input, dims, lo, hi, output, begin, end);
+}
+
+template <typename T>
+void medianRows(std::false_type, const T* input, const int dims[3],
+                const int lo[3], const int hi[3], T* output, int64_t begin,
+                int64_t end)
+{
+  medianRowsSelect(input, dims, lo, hi, output, begin, end);
+}
+} // namespace detail
+
+template <typename T>
+bool gaussian(T* data, const int dims[3], const double sigma[3],
+              const std::function<bool()>& canceled)
+{
+  using R = detail::Real<T>;
+  auto write = [](T* slice, const R* blurred, int64_t count) {
+    for (int64_t i = 0; i < count; ++i) {
+      slice[i] = detail::clampCast<T>(blurred[i]);
+    }
+  };
+  return detail::smooth(data, dims, sigma, write, canceled);
+}
+
+template <typename T>
+bool unsharpMask(T* data, const int dims[3], const double sigma[3],
+                 double amount, double threshold,
+                 const std::function<bool()>& canceled)
+{
+  using R = detail::Real<T>;
+  const R a = static_cast<R>(amount);
+  const R t = static_cast<R>(threshold);
+  auto sharpen = [a, t](T* slice, const R* blurred, int64_t count) {
+    for (int64_t i = 0; i < count; ++i) {
+      const R value = static_cast<R>(slice[i]);
+      const R difference = value - blurred[i];
+      if (difference > t) {
+        slice[i] = detail::clampCast<T>(value + (difference - t) * a);
+      } else if (-difference > t) {
+        slice[i] = detail::clampCast<T>(value + (difference + t) * a);
+      }
+    }
+  };
+  return detail::smooth(data, dims, sigma, sharpen, canceled);
+}
+
+template <typename T>
+bool median(T* data, const int dims[3], const int size[3],
+            const std::function<bool()>& canceled)
+{
+  int lo[3];
+  int hi[3];
+  for (int i = 0; i < 3; ++i) {
+    lo[i] = std::max(size[i], 1) / 2;
+    hi[i] = std::max(size[i], 1) - 1 - lo[i];
+  }
+  const int64_t numberOfRows = static_cast<int64_t>(dims[1]) * dims[2];
+  std::vector<T> output(numberOfRows * dims[0]);
+  using UseHistogram =
+    std::integral_constant<bool, std::is_integral<T>::value &&
+                                   (sizeof(T) <= 2)>;
+  std::atomic<bool> stopped(false);
+  parallelFor(0, numberOfRows, [&](int64_t begin, int64_t end) {
+    if (stopped || (canceled && canceled())) {
+      stopped = true;
+      return;
+    }
+    detail::medianRows(UseHistogram(), data, dims, lo, hi, output.data(),
+                       begin, end);
+  });
+  if (stopped) {
+    return false;
+  }
+  std::copy(output.begin(), output.end(), data);
+  return true;
+}
+} // namespace NeighborhoodFilters
+} // namespace tomviz
+
+#endif
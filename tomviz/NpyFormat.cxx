@@ -0,0 +1,482 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "NpyFormat.h"
+
+#include "ParallelFor.h"
+
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkPointData.h>
+#include <vtkSmartPointer.h>
+
+#include <QDebug>
+#include <QFile>
+#include <QRegularExpression>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace tomviz {
+
+namespace {
+
+const char magic[] = "\x93NUMPY";
+const int magicLength = 6;
+
+struct Header
+{
+  int type = 0;
+  int itemSize = 0;
+  bool swap = false;
+  bool fortranOrder = false;
+  int64_t shape[3] = { 1, 1, 1 };
+  int components = 1;
+  qint64 dataOffset = 0;
+};
+
+bool littleEndianHost()
+{
+  const uint16_t one = 1;
+  return *reinterpret_cast<const unsigned char*>(&one) == 1;
+}
+
+// The VTK type of a NumPy type string such as '<u2', 0 if unsupported.
+int vtkTypeOf(QChar kind, int size)
+{
+  switch (kind.toLatin1()) {
+    case 'b':
+      return size == 1 ? VTK_UNSIGNED_CHAR : 0;
+    case 'i':
+      switch (size) {
+        case 1:
+          return VTK_SIGNED_CHAR;
+        case 2:
+          return VTK_SHORT;
+        case 4:
+          return VTK_INT;
+        case 8:
+          return VTK_LONG_LONG;
+      }
+      return 0;
+    case 'u':
+      switch (size) {
+        case 1:
+          return VTK_UNSIGNED_CHAR;
+        case 2:
+          return VTK_UNSIGNED_SHORT;
+        case 4:
+          return VTK_UNSIGNED_INT;
+        case 8:
+          return VTK_UNSIGNED_LONG_LONG;
+      }
+      return 0;
+    case 'f':
+      switch (size) {
+        case 4:
+          return VTK_FLOAT;
+        case 8:
+          return VTK_DOUBLE;
+      }
+      return 0;
+  }
+  return 0;
+}
+
+// The NumPy type string of a VTK type, empty if unsupported.
+QString descrOf(int type)
+{
+  const QString order = littleEndianHost() ? "<" : ">";
+  switch (type) {
+    case VTK_CHAR:
+    case VTK_SIGNED_CHAR:
+      return "|i1";
+    case VTK_UNSIGNED_CHAR:
+      return "|u1";
+    case VTK_SHORT:
+      return order + "i2";
+    case VTK_UNSIGNED_SHORT:
+      return order + "u2";
+    case VTK_INT:
+      return order + "i4";
+    case VTK_UNSIGNED_INT:
+      return order + "u4";
+    case VTK_LONG:
+      return order + QString("i%1").arg(sizeof(long));
+    case VTK_UNSIGNED_LONG:
+      return order + QString("u%1").arg(sizeof(long));
+    case VTK_LONG_LONG:
+    case VTK_ID_TYPE:
+      return order + "i8";
+    case VTK_UNSIGNED_LONG_LONG:
+      return order + "u8";
+    case VTK_FLOAT:
+      return order + "f4";
+    case VTK_DOUBLE:
+      return order + "f8";
+  }
+  return QString();
+}
+
+bool readHeader(QFile& file, Header& header)
+{
+  char preamble[magicLength + 2];
+  if (file.read(preamble, sizeof(preamble)) != sizeof(preamble) ||
+      memcmp(preamble, magic, magicLength) != 0) {
+    return false;
+  }
+  const int major = static_cast<unsigned char>(preamble[magicLength]);
+  qint64 length = 0;
+  if (major == 1) {
+    unsigned char bytes[2];
+    if (file.read(reinterpret_cast<char*>(bytes), 2) != 2) {
+      return false;
+    }
+    length = bytes[0] | (bytes[1] << 8);
+  } else if (major == 2 || major == 3) {
+    unsigned char bytes[4];
+    if (file.read(reinterpret_cast<char*>(bytes), 4) != 4) {
+      return false;
+    }
+    length = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) |
+             (static_cast<qint64>(bytes[3]) << 24);
+  } else {
+    return false;
+  }
+  const QString dictionary = QString::fromLatin1(file.read(length));
+  header.dataOffset = file.pos();
+
+  QRegularExpression descrExp("'descr'\\s*:\\s*'([<>|=])([biuf])(\\d+)'");
+  QRegularExpression orderExp("'fortran_order'\\s*:\\s*(True|False)");
+  QRegularExpression shapeExp("'shape'\\s*:\\s*\\(([^)]*)\\)");
+  auto descr = descrExp.match(dictionary);
+  auto order = orderExp.match(dictionary);
+  auto shape = shapeExp.match(dictionary);
+  if (!descr.hasMatch() || !order.hasMatch() || !shape.hasMatch()) {
+    return false;
+  }
+
+  header.itemSize = descr.captured(3).toInt();
+  header.type = vtkTypeOf(descr.captured(2)[0], header.itemSize);
+  const QChar byteOrder = descr.captured(1)[0];
+  header.swap = header.itemSize > 1 &&
+                ((byteOrder == '<' && !littleEndianHost()) ||
+                 (byteOrder == '>' && littleEndianHost()));
+  header.fortranOrder = order.captured(1) == "True";
+
+  // A fourth axis holds the components, as the writer lays them out.
+  auto sizes = shape.captured(1).split(',', QString::SkipEmptyParts);
+  if (header.type == 0 || sizes.isEmpty() || sizes.size() > 4) {
+    return false;
+  }
+  for (int i = 0; i < sizes.size(); ++i) {
+    bool ok = false;
+    const int64_t size = sizes[i].trimmed().toLongLong(&ok);
+    if (!ok || size < 1 || (i == 3 && size > VTK_INT_MAX)) {
+      return false;
+    }
+    if (i < 3) {
+      header.shape[i] = size;
+    } else {
+      header.components = static_cast<int>(size);
+    }
+  }
+  return true;
+}
+
+// Mappings backing arrays, by the address of their first value, closed when
+// the array frees its buffer.
+std::mutex mappingsMutex;
+std::map<void*, std::unique_ptr<QFile>> mappings;
+
+void closeMapping(void* buffer)
+{
+  std::lock_guard<std::mutex> lock(mappingsMutex);
+  mappings.erase(buffer);
+}
+
+template <typename Word>
+Word swapBytes(Word value)
+{
+  auto bytes = reinterpret_cast<unsigned char*>(&value);
+  std::reverse(bytes, bytes + sizeof(Word));
+  return value;
+}
+
+// Copy a C ordered array of shape (nx, ny, nz, components) into x fastest
+// order, in square tiles of x and z so both sides stay in cache.
+template <typename Word>
+void transpose(const Word* input, const int64_t shape[3], int components,
+               bool swap, Word* output)
+{
+  const int64_t nx = shape[0];
+  const int64_t ny = shape[1];
+  const int64_t nz = shape[2];
+  const int64_t tile = 32;
+  const int64_t tilesX = (nx + tile - 1) / tile;
+  parallelFor(0, ny * tilesX, [&](int64_t begin, int64_t end) {
+    for (int64_t item = begin; item < end; ++item) {
+      const int64_t y = item / tilesX;
+      const int64_t x0 = (item % tilesX) * tile;
+      const int64_t x1 = std::min(x0 + tile, nx);
+      for (int64_t z0 = 0; z0 < nz; z0 += tile) {
+        const int64_t z1 = std::min(z0 + tile, nz);
+        for (int64_t z = z0; z < z1; ++z) {
+          Word* out = output + (z * ny + y) * nx * components;
+          for (int64_t x = x0; x < x1; ++x) {
+            const Word* in = input + ((x * ny + y) * nz + z) * components;
+            for (int c = 0; c < components; ++c) {
+              out[x * components + c] = swap ? swapBytes(in[c]) : in[c];
+            }
+          }
+        }
+      }
+    }
+  });
+}
+
+template <typename Word>
+void swapAll(const Word* input, int64_t count, Word* output)
+{
+  parallelFor(0, count, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      output[i] = swapBytes(input[i]);
+    }
+  });
+}
+
+// Interleave count values of each of the components, stored one component
+// after the other, into tuples.
+template <typename Word>
+void interleave(const Word* input, int64_t count, int components, bool swap,
+                Word* output)
+{
+  parallelFor(0, count, [&](int64_t begin, int64_t end) {
+    for (int c = 0; c < components; ++c) {
+      const Word* in = input + c * count;
+      for (int64_t i = begin; i < end; ++i) {
+        output[i * components + c] = swap ? swapBytes(in[i]) : in[i];
+      }
+    }
+  });
+}
+
+// Copy the values into the layout of the image scalars, sameLayout when they
+// are laid out that way already and only need swapping.
+template <typename Word>
+void copyValues(const void* input, const Header& header, bool sameLayout,
+                void* output)
+{
+  const int64_t count = header.shape[0] * header.shape[1] * header.shape[2];
+  auto in = static_cast<const Word*>(input);
+  auto out = static_cast<Word*>(output);
+  if (sameLayout) {
+    swapAll(in, count * header.components, out);
+  } else if (header.fortranOrder) {
+    interleave(in, count, header.components, header.swap, out);
+  } else {
+    transpose(in, header.shape, header.components, header.swap, out);
+  }
+}
+// Copy component c of count tuples of components interleaved values into
+// contiguous values.
+template <typename Word>
+void extractComponent(const void* input, int64_t count, int components, int c,
+                      void* output)
+{
+  auto in = static_cast<const Word*>(input) + c;
+  auto out = static_cast<Word*>(output);
+  parallelFor(0, count, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      out[i] = in[i * components];
+    }
+  });
+}
+
+void extractComponent(const void* input, int64_t count, int components, int c,
+                      int itemSize, void* output)
+{
+  switch (itemSize) {
+    case 1:
+      extractComponent<uint8_t>(input, count, components, c, output);
+      break;
+    case 2:
+      extractComponent<uint16_t>(input, count, components, c, output);
+      break;
+    case 4:
+      extractComponent<uint32_t>(input, count, components, c, output);
+      break;
+    case 8:
+      extractComponent<uint64_t>(input, count, components, c, output);
+      break;
+  }
+}
+} // namespace
+
+bool NpyFormat::read(const QString& fileName, vtkImageData* image)
+{
+  std::unique_ptr<QFile> file(new QFile(fileName));
+  if (!file->open(QIODevice::ReadOnly)) {
+    qCritical() << "Unable to open" << fileName;
+    return false;
+  }
+  Header header;
+  if (!readHeader(*file, header)) {
+    qCritical() << fileName << "is not a supported NumPy array";
+    return false;
+  }
+  const int64_t* shape = header.shape;
+  const int64_t count = shape[0] * shape[1] * shape[2];
+  const int64_t values = count * header.components;
+  const qint64 bytes = values * header.itemSize;
+  if (file->size() < header.dataOffset + bytes) {
+    qCritical() << fileName << "is truncated";
+    return false;
+  }
+  // Copy on write, operators changing the data in place leave the file be.
+  uchar* mapped =
+    file->map(header.dataOffset, bytes, QFileDevice::MapPrivateOption);
+  if (!mapped) {
+    qCritical() << "Unable to map" << fileName;
+    return false;
+  }
+
+  vtkSmartPointer<vtkDataArray> array;
+  array.TakeReference(vtkDataArray::CreateDataArray(header.type));
+  array->SetName("Scalars");
+  array->SetNumberOfComponents(header.components);
+
+  // The components of a Fortran ordered array are stored one after the
+  // other rather than in tuples. A C ordered array with a single spatial
+  // axis longer than one keeps its components in tuples, as the image does.
+  const bool sameLayout =
+    header.fortranOrder
+      ? header.components == 1
+      : std::count_if(shape, shape + 3,
+                      [](int64_t size) { return size > 1; }) <= 1;
+  if (sameLayout && !header.swap) {
+    array->SetVoidArray(mapped, values, 0, VTK_DATA_ARRAY_USER_DEFINED);
+    array->SetArrayFreeFunction(&closeMapping);
+    std::lock_guard<std::mutex> lock(mappingsMutex);
+    mappings[mapped] = std::move(file);
+  } else {
+    array->SetNumberOfTuples(count);
+    void* output = array->GetVoidPointer(0);
+    switch (header.itemSize) {
+      case 1:
+        copyValues<uint8_t>(mapped, header, sameLayout, output);
+        break;
+      case 2:
+        copyValues<uint16_t>(mapped, header, sameLayout, output);
+        break;
+      case 4:
+        copyValues<uint32_t>(mapped, header, sameLayout, output);
+        break;
+      case 8:
+        copyValues<uint64_t>(mapped, header, sameLayout, output);
+        break;
+    }
+    file->unmap(mapped);
+  }
+
+  image->SetOrigin(0, 0, 0);
+  image->SetSpacing(1, 1, 1);
+  image->SetExtent(0, shape[0] - 1, 0, shape[1] - 1, 0, shape[2] - 1);
+  image->GetPointData()->SetScalars(array);
+  return true;
+}
+
+bool NpyFormat::write(const QString& fileName, vtkImageData* image,
+                      const Progress& progress)
+{
+  vtkDataArray* scalars = image->GetPointData()->GetScalars();
+  if (!scalars) {
+    qCritical() << "There are no scalars to write to .npy";
+    return false;
+  }
+  const QString descr = descrOf(scalars->GetDataType());
+  if (descr.isEmpty()) {
+    qCritical() << "Unsupported data type for .npy";
+    return false;
+  }
+
+  int dims[3];
+  image->GetDimensions(dims);
+  const int components = scalars->GetNumberOfComponents();
+  QString shape = QString("%1, %2, %3").arg(dims[0]).arg(dims[1]).arg(dims[2]);
+  if (components > 1) {
+    shape += QString(", %1").arg(components);
+  }
+  QString dictionary =
+    QString("{'descr': '%1', 'fortran_order': True, 'shape': (%2), }")
+      .arg(descr)
+      .arg(shape);
+  // The header, magic and lengths included, is padded with spaces to a
+  // multiple of 64 bytes and ends with a newline.
+  const bool version1 = dictionary.size() + 11 < 65536;
+  const int preamble = magicLength + 2 + (version1 ? 2 : 4);
+  const int total = (preamble + dictionary.size() + 1 + 63) / 64 * 64;
+  dictionary += QString(total - preamble - dictionary.size() - 1, ' ');
+  dictionary += '\n';
+  const quint32 length = dictionary.size();
+
+  QFile file(fileName);
+  if (!file.open(QIODevice::WriteOnly)) {
+    qCritical() << "Unable to open" << fileName << "for writing";
+    return false;
+  }
+  QByteArray header(magic, magicLength);
+  header.append(static_cast<char>(version1 ? 1 : 2));
+  header.append('\0');
+  header.append(static_cast<char>(length & 0xff));
+  header.append(static_cast<char>((length >> 8) & 0xff));
+  if (!version1) {
+    header.append(static_cast<char>((length >> 16) & 0xff));
+    header.append(static_cast<char>((length >> 24) & 0xff));
+  }
+  header.append(dictionary.toLatin1());
+  if (file.write(header) != header.size()) {
+    return false;
+  }
+
+  // Fortran order is the layout of single component scalars, slabs of
+  // slices of about 64 MB are written straight from them. Components are
+  // the last axis, written one after the other, a slab of each gathered from
+  // the interleaved tuples at a time.
+  const int itemSize = scalars->GetDataTypeSize();
+  const qint64 sliceValues = static_cast<qint64>(dims[0]) * dims[1];
+  const qint64 sliceBytes = sliceValues * itemSize;
+  const int slabSlices = static_cast<int>(
+    std::max<qint64>(1, (qint64(64) << 20) / std::max<qint64>(sliceBytes, 1)));
+  auto values = static_cast<const char*>(scalars->GetVoidPointer(0));
+  std::vector<char> slab(components > 1 ? slabSlices * sliceBytes : 0);
+  const double steps = static_cast<double>(components) * dims[2];
+  for (int c = 0; c < components; ++c) {
+    for (int z = 0; z < dims[2]; z += slabSlices) {
+      const int slices = std::min(slabSlices, dims[2] - z);
+      const qint64 slabBytes = slices * sliceBytes;
+      const char* data = values + z * sliceBytes;
+      if (components > 1) {
+        extractComponent(values + z * sliceBytes * components,
+                         slices * sliceValues, components, c, itemSize,
+                         slab.data());
+        data = slab.data();
+      }
+      if (file.write(data, slabBytes) != slabBytes) {
+        qCritical() << "Failed to write" << fileName;
+        return false;
+      }
+      const int written = c * dims[2] + z + slices;
+      if (progress && !progress(written / steps)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+} // namespace tomviz
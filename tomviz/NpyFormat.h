@@ -0,0 +1,36 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizNpyFormat_h
+#define tomvizNpyFormat_h
+
+#include "FileFormatManager.h"
+
+namespace tomviz {
+
+/// NumPy's .npy format, read and written without Python. Reading memory maps
+/// the file copy on write: a Fortran ordered array, as the writer produces,
+/// becomes the scalars of the image without a copy, so only the pages that
+/// are touched are ever read and changes never reach the file. C ordered and
+/// big endian arrays are transposed, or swapped, into memory in parallel
+/// tiles. Arrays of one to three dimensions are supported, and a fourth
+/// axis holds the components of multi-component scalars as the writer lays
+/// them out. The image has unit spacing and its origin at zero, as with the
+/// Python reader.
+class NpyFormat : public NativeFileFormat
+{
+public:
+  QString description() const override { return "NumPy binary format"; }
+  QStringList extensions() const override { return { "npy" }; }
+
+  bool read(const QString& fileName, vtkImageData* image) override;
+
+  /// Write the active scalars as a Fortran ordered array, streaming the
+  /// image a slab of slices at a time and reporting progress after each
+  /// slab. Multi-component scalars get a last axis for their components.
+  bool write(const QString& fileName, vtkImageData* image,
+             const Progress& progress = nullptr) override;
+};
+} // namespace tomviz
+
+#endif
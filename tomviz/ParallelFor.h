@@ -0,0 +1,98 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizParallelFor_h
+#define tomvizParallelFor_h
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace tomviz {
+
+/// Number of worker threads used by parallelFor, at least one.
+inline unsigned int parallelThreadCount()
+{
+  const unsigned int minCores = 1;
+  return std::max(std::thread::hardware_concurrency(), minCores);
+}
+
+namespace detail {
+
+/// Set on the threads running the sub-ranges of a parallelFor, so nested
+/// calls run serially on them rather than starting threads of their own.
+inline bool& insideParallelFor()
+{
+  static thread_local bool inside = false;
+  return inside;
+}
+
+struct ParallelForScope
+{
+  ParallelForScope() : previous(insideParallelFor())
+  {
+    insideParallelFor() = true;
+  }
+  ~ParallelForScope() { insideParallelFor() = previous; }
+  bool previous;
+};
+} // namespace detail
+
+/// Calls func(begin, end) on contiguous sub-ranges of [first, last) from a
+/// set of worker threads, returning once every sub-range has been processed.
+/// Sub-ranges are handed out dynamically so uneven work (for example slices
+/// with very different content) balances across threads. The calling thread
+/// takes part in the work, so small ranges do not pay for thread start up.
+/// Calls made from within func run serially on the calling thread.
+/// \param grain Minimum number of items in a sub-range, use 0 to pick one
+/// automatically.
+template <typename Functor>
+void parallelFor(int64_t first, int64_t last, int64_t grain, Functor&& func)
+{
+  const int64_t n = last - first;
+  if (n <= 0) {
+    return;
+  }
+  const int64_t nThreads = parallelThreadCount();
+  if (grain <= 0) {
+    // Aim for a few chunks per thread to even out the load.
+    grain = std::max<int64_t>(1, n / (nThreads * 4));
+  }
+  const int64_t nChunks = (n + grain - 1) / grain;
+  if (nThreads == 1 || nChunks == 1 || detail::insideParallelFor()) {
+    func(first, last);
+    return;
+  }
+
+  std::atomic<int64_t> next(0);
+  auto worker = [&]() {
+    detail::ParallelForScope scope;
+    for (int64_t chunk = next++; chunk < nChunks; chunk = next++) {
+      const int64_t begin = first + chunk * grain;
+      func(begin, std::min(begin + grain, last));
+    }
+  };
+
+  std::vector<std::thread> threads;
+  const int64_t nWorkers = std::min(nThreads, nChunks) - 1;
+  threads.reserve(nWorkers);
+  for (int64_t i = 0; i < nWorkers; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+template <typename Functor>
+void parallelFor(int64_t first, int64_t last, Functor&& func)
+{
+  parallelFor(first, last, 0, std::forward<Functor>(func));
+}
+} // namespace tomviz
+
+#endif
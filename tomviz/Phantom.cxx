@@ -0,0 +1,178 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "Phantom.h"
+
+#include "ParallelFor.h"
+#include "RandomDistributions.h"
+
+#include <vtkFloatArray.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+
+#include <array>
+#include <cmath>
+#include <iterator>
+#include <random>
+#include <vector>
+
+namespace tomviz {
+
+namespace Phantom {
+
+namespace {
+
+const double Pi = 3.14159265358979323846;
+
+// An ellipsoid of the phantom, in coordinates spanning [-1, 1] along every
+// axis, rotated by the z-x-z Euler angles phi, theta and psi in degrees.
+struct Ellipsoid
+{
+  double density;
+  double axes[3];
+  double center[3];
+  double angles[3];
+};
+
+// The modified Shepp-Logan ellipsoids, with the densities raised for
+// contrast, as in Toft and in Schabel's phantom3d.
+const Ellipsoid SheppLogan[] = {
+  { 1.0, { .69, .92, .81 }, { 0, 0, 0 }, { 0, 0, 0 } },
+  { -.8, { .6624, .874, .78 }, { 0, -.0184, 0 }, { 0, 0, 0 } },
+  { -.2, { .11, .31, .22 }, { .22, 0, 0 }, { -18, 0, 10 } },
+  { -.2, { .16, .41, .28 }, { -.22, 0, 0 }, { 18, 0, 10 } },
+  { .1, { .21, .25, .41 }, { 0, .35, -.15 }, { 0, 0, 0 } },
+  { .1, { .046, .046, .05 }, { 0, .1, .25 }, { 0, 0, 0 } },
+  { .1, { .046, .046, .05 }, { 0, -.1, .25 }, { 0, 0, 0 } },
+  { .1, { .046, .023, .05 }, { -.08, -.605, 0 }, { 0, 0, 0 } },
+  { .1, { .023, .023, .02 }, { 0, -.606, 0 }, { 0, 0, 0 } },
+  { .1, { .023, .046, .02 }, { .06, -.605, 0 }, { 0, 0, 0 } }
+};
+
+vtkSmartPointer<vtkImageData> newVolume(int size)
+{
+  auto image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(size, size, size);
+  vtkNew<vtkFloatArray> scalars;
+  scalars->SetName("phantom");
+  scalars->SetNumberOfValues(static_cast<vtkIdType>(size) * size * size);
+  scalars->Fill(0);
+  image->GetPointData()->SetScalars(scalars.GetPointer());
+  return image;
+}
+
+// The coordinate of voxel i of size along an axis, in [-1, 1].
+double coordinate(int i, int size)
+{
+  return (i + 0.5) * 2.0 / size - 1.0;
+}
+
+// Add the density of the ellipsoids to the voxels they contain.
+void addEllipsoids(const std::vector<Ellipsoid>& ellipsoids, int size,
+                   float* values)
+{
+  // The rotation of each ellipsoid, rows of the matrix taking the volume
+  // coordinates to the axes of the ellipsoid.
+  std::vector<std::array<double, 9>> rotations;
+  for (auto& ellipsoid : ellipsoids) {
+    const double phi = ellipsoid.angles[0] * Pi / 180;
+    const double theta = ellipsoid.angles[1] * Pi / 180;
+    const double psi = ellipsoid.angles[2] * Pi / 180;
+    const double cphi = cos(phi), sphi = sin(phi);
+    const double ctheta = cos(theta), stheta = sin(theta);
+    const double cpsi = cos(psi), spsi = sin(psi);
+    rotations.push_back({ { cpsi * cphi - ctheta * sphi * spsi,
+                            cpsi * sphi + ctheta * cphi * spsi, spsi * stheta,
+                            -spsi * cphi - ctheta * sphi * cpsi,
+                            -spsi * sphi + ctheta * cphi * cpsi, cpsi * stheta,
+                            stheta * sphi, -stheta * cphi, ctheta } });
+  }
+
+  const int64_t sliceSize = static_cast<int64_t>(size) * size;
+  parallelFor(0, size, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t k = begin; k < end; ++k) {
+      const double z = coordinate(static_cast<int>(k), size);
+      for (int j = 0; j < size; ++j) {
+        const double y = coordinate(j, size);
+        float* row = values + k * sliceSize + static_cast<int64_t>(j) * size;
+        for (int i = 0; i < size; ++i) {
+          const double x = coordinate(i, size);
+          double density = 0;
+          for (size_t e = 0; e < ellipsoids.size(); ++e) {
+            const auto& a = rotations[e];
+            const auto& ellipsoid = ellipsoids[e];
+            const double p[3] = { a[0] * x + a[1] * y + a[2] * z,
+                                  a[3] * x + a[4] * y + a[5] * z,
+                                  a[6] * x + a[7] * y + a[8] * z };
+            double r = 0;
+            for (int d = 0; d < 3; ++d) {
+              const double q =
+                (p[d] - ellipsoid.center[d]) / ellipsoid.axes[d];
+              r += q * q;
+            }
+            if (r <= 1) {
+              density += ellipsoid.density;
+            }
+          }
+          row[i] += static_cast<float>(density);
+        }
+      }
+    }
+  });
+}
+} // namespace
+
+vtkSmartPointer<vtkImageData> sheppLogan(int size)
+{
+  auto image = newVolume(size);
+  std::vector<Ellipsoid> ellipsoids(std::begin(SheppLogan),
+                                    std::end(SheppLogan));
+  addEllipsoids(ellipsoids, size,
+                static_cast<float*>(image->GetScalarPointer()));
+  return image;
+}
+
+vtkSmartPointer<vtkImageData> beads(int size, int count, unsigned int seed)
+{
+  // Spheres are drawn in the cylinder about the tilt axis inscribed in the
+  // volume, so every tilt sees all of them, rejecting those overlapping
+  // spheres already placed.
+  std::mt19937 generator(seed);
+  auto uniform = [&generator](double min, double max) {
+    return RandomDistributions::uniform(generator, min, max);
+  };
+  std::vector<Ellipsoid> spheres;
+  for (int attempt = 0; attempt < 1000 * count &&
+                        static_cast<int>(spheres.size()) < count;
+       ++attempt) {
+    const double r = uniform(0.04, 0.12);
+    const double c[3] = { uniform(-1, 1) * (0.9 - r),
+                          uniform(-1, 1) * (0.9 - r),
+                          uniform(-1, 1) * (0.9 - r) };
+    if (c[1] * c[1] + c[2] * c[2] > (0.9 - r) * (0.9 - r)) {
+      continue;
+    }
+    bool overlaps = false;
+    for (auto& sphere : spheres) {
+      double distance = 0;
+      for (int d = 0; d < 3; ++d) {
+        distance += (c[d] - sphere.center[d]) * (c[d] - sphere.center[d]);
+      }
+      if (sqrt(distance) < r + sphere.axes[0]) {
+        overlaps = true;
+        break;
+      }
+    }
+    if (!overlaps) {
+      Ellipsoid sphere = { 1.0, { r, r, r }, { c[0], c[1], c[2] }, {} };
+      spheres.push_back(sphere);
+    }
+  }
+
+  auto image = newVolume(size);
+  addEllipsoids(spheres, size, static_cast<float*>(image->GetScalarPointer()));
+  return image;
+}
+} // namespace Phantom
+} // namespace tomviz
@@ -0,0 +1,31 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizPhantom_h
+#define tomvizPhantom_h
+
+#include <vtkSmartPointer.h>
+
+class vtkImageData;
+
+namespace tomviz {
+
+/// Standard test volumes of floats with known content, to simulate tilt
+/// series from and measure how well reconstructions recover them. The
+/// volumes are size voxels on a side, with the same content at any size.
+namespace Phantom {
+
+/// The modified 3D Shepp-Logan head phantom, ten ellipsoids of densities
+/// between 0 and 1 filling the volume, as commonly used to compare
+/// reconstruction methods.
+vtkSmartPointer<vtkImageData> sheppLogan(int size);
+
+/// Spheres of random radius and position, of density 1, well inside the
+/// volume and not overlapping, like nanoparticles on a support. The same
+/// seed gives the same spheres at every size.
+vtkSmartPointer<vtkImageData> beads(int size, int count = 20,
+                                    unsigned int seed = 0);
+} // namespace Phantom
+} // namespace tomviz
+
+#endif
@@ -4,6 +4,7 @@
 #include "Pipeline.h"
 
 #include "ActiveObjects.h"
+#include "CopyOnWrite.h"
 #include "DataSource.h"
 #include "DockerUtilities.h"
 #include "EmdFormat.h"
@@ -28,6 +29,7 @@
 #include <pqApplicationCore.h>
 #include <pqSettings.h>
 #include <pqView.h>
+#include <vtkImageData.h>
 #include <vtkSMViewProxy.h>
 #include <vtkTrivialProducer.h>
 
@@ -101,10 +103,16 @@ void ThreadPipelineExecutor::executePipelineBranch(vtkDataObject* data,
     return;
   }
 
-  auto copy = data->NewInstance();
-  copy->DeepCopy(data);
+  // Operators writing in place detach the arrays they write, the others are
+  // left shared with the data source.
+  vtkSmartPointer<vtkDataObject> copy;
+  if (auto image = vtkImageData::SafeDownCast(data)) {
+    copy = CopyOnWrite::copy(image);
+  } else {
+    copy.TakeReference(data->NewInstance());
+    copy->DeepCopy(data);
+  }
   m_future = m_worker->run(copy, operators);
-  copy->FastDelete();
   connect(m_future, &PipelineWorker::Future::finished, this,
           &ThreadPipelineExecutor::pipelineBranchFinished);
   connect(m_future, &PipelineWorker::Future::canceled, this,
@@ -7,12 +7,16 @@
 #include "DataSource.h"
 #include "LoadDataReaction.h"
 #include "ModuleManager.h"
+#include "Pipeline.h"
 #include "PythonUtilities.h"
+#include "SlabGenerator.h"
 #include "Utilities.h"
 #include "Variant.h"
 
+#include <vtkDoubleArray.h>
 #include <vtkImageData.h>
 #include <vtkNew.h>
+#include <vtkPointData.h>
 #include <vtkSmartPointer.h>
 #include <vtkTrivialProducer.h>
 
@@ -23,18 +27,24 @@
 #include <vtkSMSessionProxyManager.h>
 #include <vtkSMSourceProxy.h>
 
+#include <QCryptographicHash>
 #include <QDebug>
 #include <QDialog>
 #include <QDialogButtonBox>
 #include <QGridLayout>
 #include <QHBoxLayout>
 #include <QJsonArray>
+#include <QJsonDocument>
 #include <QJsonObject>
 #include <QLabel>
+#include <QMainWindow>
 #include <QSpinBox>
+#include <QStatusBar>
 #include <QVBoxLayout>
 
+#include <cstring>
 #include <limits>
+#include <memory>
 
 namespace {
 
@@ -81,40 +91,23 @@ public:
         qCritical() << "Could not find make_dataset function in tomviz.utils";
         return;
       }
+
+      // Scripts defining generate_slab are generated a slab at a time.
+      if (module.hasAttribute("generate_slab")) {
+        m_generateSlabFunction = module.findFunction("generate_slab");
+        m_makeSlabFunction = m_operatorModule.findFunction("make_slab");
+      }
     }
 
     m_pythonScript = script;
   }
 
+  /// A data source showing a preview of the volume of shape, which fills in
+  /// in the background, see SlabGenerator.
   tomviz::DataSource* createDataSource(const int shape[3])
   {
-    vtkNew<vtkImageData> image;
-
-    {
-      tomviz::Python python;
-
-      tomviz::Python::Object result;
-      tomviz::Python::Tuple args(5);
-
-      args.set(0, shape[0]);
-      args.set(1, shape[1]);
-      args.set(2, shape[2]);
-      tomviz::Python::Object imageData =
-        tomviz::Python::VTK::GetObjectFromPointer(image);
-      args.set(3, imageData);
-      args.set(4, m_generateFunction);
-
-      tomviz::Python::Dict kwargs;
-      foreach (QString key, m_arguments.keys()) {
-        tomviz::Variant value = tomviz::toVariant(m_arguments[key]);
-        kwargs.set(key, value);
-      }
-
-      result = m_makeDatasetFunction.call(args, kwargs);
-      if (!result.isValid()) {
-        qCritical() << "Failed to execute script.";
-        return nullptr;
-      }
+    if (!m_generateFunction.isValid()) {
+      return nullptr;
     }
 
     QVariantMap vmap;
@@ -135,11 +128,59 @@ public:
     description["args"] = argsJson;
     description["shape"] = size;
 
+    // Slabs are cached by everything the volume is generated from, for
+    // generate_slab scripts only, whose slabs must depend on nothing else.
+    // generate_dataset scripts may draw unseeded random numbers, and caching
+    // their single slab would keep a second copy of the whole volume.
+    const bool slabs = m_generateSlabFunction.isValid();
+    QString key;
+    if (slabs) {
+      key = QCryptographicHash::hash(
+              QJsonDocument(description).toJson(QJsonDocument::Compact),
+              QCryptographicHash::Sha1)
+              .toHex();
+    }
+    auto generator = new tomviz::SlabGenerator(shape, key, generate(shape),
+                                               slabs);
+    auto preview = generator->preview();
+    if (!preview) {
+      qCritical() << "Failed to execute script.";
+      delete generator;
+      return nullptr;
+    }
+
     tomviz::DataSource* dataSource = new tomviz::DataSource(
       m_label, tomviz::DataSource::Volume, nullptr,
       tomviz::DataSource::PersistenceState::Transient, description);
 
-    dataSource->setData(image);
+    dataSource->setData(preview);
+
+    // Generation stops if the data source is deleted before it is done.
+    generator->setParent(dataSource);
+    const QString label = m_label;
+    QObject::connect(
+      generator, &tomviz::SlabGenerator::progressChanged, dataSource,
+      [label](int percent) {
+        if (auto window = qobject_cast<QMainWindow*>(tomviz::mainWidget())) {
+          window->statusBar()->showMessage(
+            QString("Generating %1: %2%").arg(label).arg(percent), 3000);
+        }
+      });
+    QObject::connect(
+      generator, &tomviz::SlabGenerator::finished, dataSource,
+      [generator, dataSource](bool success) {
+        if (success) {
+          dataSource->setData(generator->result());
+          dataSource->dataModified();
+          if (dataSource->pipeline() && !dataSource->operators().isEmpty()) {
+            dataSource->pipeline()->execute(dataSource);
+          }
+        } else if (!generator->isCanceled()) {
+          qCritical() << "Failed to execute script.";
+        }
+        generator->deleteLater();
+      });
+    generator->start();
 
     return dataSource;
   }
@@ -147,9 +188,83 @@ public:
   void setArguments(QMap<QString, QVariant> args) { m_arguments = args; }
 
 private:
+  struct Functions
+  {
+    tomviz::Python::Function make;
+    tomviz::Python::Function generate;
+  };
+
+  // Runs the script for the slices [begin, end) of a volume of shape, on the
+  // worker threads of the SlabGenerator, so it holds on to the functions and
+  // arguments it needs rather than to this generator.
+  tomviz::SlabGenerator::Generate generate(const int shape[3])
+  {
+    const bool slabs = m_generateSlabFunction.isValid();
+    auto functions = std::make_shared<Functions>();
+    {
+      tomviz::Python python;
+      functions->make = slabs ? m_makeSlabFunction : m_makeDatasetFunction;
+      functions->generate = slabs ? m_generateSlabFunction : m_generateFunction;
+    }
+    const QMap<QString, QVariant> arguments = m_arguments;
+    const int x = shape[0];
+    const int y = shape[1];
+    const int z = shape[2];
+    return [functions, arguments, slabs, x, y, z](int begin, int end,
+                                                  double* values) {
+      const vtkIdType count = static_cast<vtkIdType>(x) * y * (end - begin);
+      vtkNew<vtkImageData> image;
+      vtkNew<vtkDoubleArray> scalars;
+      if (slabs) {
+        // The script writes into the values in place.
+        image->SetDimensions(x, y, end - begin);
+        scalars->SetArray(values, count, 1);
+        image->GetPointData()->SetScalars(scalars.GetPointer());
+      }
+
+      tomviz::Python python;
+      tomviz::Python::Object dataset =
+        tomviz::Python::VTK::GetObjectFromPointer(image);
+      tomviz::Python::Tuple args(slabs ? 6 : 5);
+      args.set(0, x);
+      args.set(1, y);
+      args.set(2, z);
+      if (slabs) {
+        args.set(3, begin);
+        args.set(4, dataset);
+        args.set(5, functions->generate);
+      } else {
+        args.set(3, dataset);
+        args.set(4, functions->generate);
+      }
+
+      tomviz::Python::Dict kwargs;
+      foreach (QString key, arguments.keys()) {
+        tomviz::Variant value = tomviz::toVariant(arguments[key]);
+        kwargs.set(key, value);
+      }
+
+      tomviz::Python::Object result = functions->make.call(args, kwargs);
+      if (!result.isValid()) {
+        return false;
+      }
+      if (!slabs) {
+        auto generated =
+          vtkDoubleArray::SafeDownCast(image->GetPointData()->GetScalars());
+        if (!generated || generated->GetNumberOfValues() != count) {
+          return false;
+        }
+        std::memcpy(values, generated->GetPointer(0), count * sizeof(double));
+      }
+      return true;
+    };
+  }
+
   tomviz::Python::Module m_operatorModule;
   tomviz::Python::Function m_generateFunction;
   tomviz::Python::Function m_makeDatasetFunction;
+  tomviz::Python::Function m_generateSlabFunction;
+  tomviz::Python::Function m_makeSlabFunction;
   QString m_label;
   QString m_pythonScript;
   QMap<QString, QVariant> m_arguments;
@@ -345,6 +345,12 @@ Python::Function Python::Module::findFunction(const QString& name)
   return func;
 }
 
+bool Python::Module::hasAttribute(const QString& name)
+{
+  return PyObject_HasAttrString(m_smartPyObject->GetPointer(),
+                                name.toLatin1().data()) == 1;
+}
+
 Python::Module Python::import(const QString& str, const QString& filename,
                               const QString& moduleName)
 {
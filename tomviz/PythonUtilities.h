@@ -137,6 +137,9 @@ public:
     Module(const Module& other);
     Module& operator=(const Module& other);
     Function findFunction(const QString& name);
+    /// Whether the module has an attribute name, without reporting an error
+    /// when it does not.
+    bool hasAttribute(const QString& name);
   };
 
   class VTK
@@ -0,0 +1,96 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizRandomDistributions_h
+#define tomvizRandomDistributions_h
+
+#include <cmath>
+#include <random>
+
+namespace tomviz {
+
+/// Distributions drawing from std::mt19937. The standard fixes the output of
+/// the generator but leaves that of its distributions to the library, so
+/// these are written here to give the same numbers for a seed with every
+/// standard library.
+namespace RandomDistributions {
+
+/// Uniform in [0, 1), from 53 bits of two outputs of generator.
+inline double uniform(std::mt19937& generator)
+{
+  const double a = static_cast<double>(generator() >> 5);
+  const double b = static_cast<double>(generator() >> 6);
+  return (a * 67108864.0 + b) / 9007199254740992.0;
+}
+
+/// Uniform in [min, max).
+inline double uniform(std::mt19937& generator, double min, double max)
+{
+  return min + (max - min) * uniform(generator);
+}
+
+/// log(k!), from the Stirling series past the first few values.
+inline double logFactorial(long long k)
+{
+  if (k < 10) {
+    double sum = 0;
+    for (long long i = 2; i <= k; ++i) {
+      sum += std::log(static_cast<double>(i));
+    }
+    return sum;
+  }
+  const double x = static_cast<double>(k);
+  const double x2 = x * x;
+  // 0.5 * log(2 * pi) is the constant.
+  return (x + 0.5) * std::log(x) - x + 0.9189385332046727 +
+         (1.0 / 12 - (1.0 / 360 - 1.0 / (1260 * x2)) / x2) / x;
+}
+
+/// Poisson distributed with the given positive mean. Small means multiply
+/// uniforms until their product drops below exp(-mean), larger ones use the
+/// transformed rejection of Hormann (PTRS), whose cost does not grow with the
+/// mean.
+inline long long poisson(std::mt19937& generator, double mean)
+{
+  if (mean < 10) {
+    const double limit = std::exp(-mean);
+    long long k = 0;
+    double product = uniform(generator);
+    while (product > limit) {
+      ++k;
+      product *= uniform(generator);
+    }
+    return k;
+  }
+
+  const double sqrtMean = std::sqrt(mean);
+  const double logMean = std::log(mean);
+  const double b = 0.931 + 2.53 * sqrtMean;
+  const double a = -0.059 + 0.02483 * b;
+  const double inverseAlpha = 1.1239 + 1.1328 / (b - 3.4);
+  const double vr = 0.9277 - 3.6224 / (b - 2);
+  while (true) {
+    const double u = uniform(generator) - 0.5;
+    const double v = uniform(generator);
+    const double us = 0.5 - std::fabs(u);
+    if (us <= 0) {
+      continue;
+    }
+    const long long k =
+      static_cast<long long>(std::floor((2 * a / us + b) * u + mean + 0.43));
+    if (us >= 0.07 && v <= vr) {
+      return k;
+    }
+    if (k < 0 || (us < 0.013 && v > us)) {
+      continue;
+    }
+    if (std::log(v) + std::log(inverseAlpha) - std::log(a / (us * us) + b) <=
+        -mean + k * logMean - logFactorial(k)) {
+      return k;
+    }
+  }
+}
+} // namespace RandomDistributions
+} // namespace tomviz
+
+#endif
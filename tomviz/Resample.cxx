@@ -0,0 +1,127 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "Resample.h"
+
+#include <vtkDataArray.h>
+#include <vtkFieldData.h>
+#include <vtkImageData.h>
+#include <vtkPointData.h>
+#include <vtkSmartPointer.h>
+
+#include <string>
+
+namespace tomviz {
+
+namespace Resample {
+
+namespace {
+
+// Keys' cubic convolution kernel (a = -0.5) at distance t from a sample.
+double cubicWeight(double t)
+{
+  t = std::abs(t);
+  if (t < 1.0) {
+    return (1.5 * t - 2.5) * t * t + 1.0;
+  }
+  if (t < 2.0) {
+    return ((-0.5 * t + 2.5) * t - 4.0) * t + 2.0;
+  }
+  return 0.0;
+}
+} // namespace
+
+int zoomedSize(int size, double factor)
+{
+  return std::max(static_cast<int>(std::lround(size * factor)), 1);
+}
+
+Kernel::Kernel(int in, int out, Interpolation interpolation)
+  : inSize(in), outSize(out),
+    taps(interpolation == Interpolation::Cubic ? 4 : 2),
+    indices(static_cast<size_t>(out) * taps),
+    weights(static_cast<size_t>(out) * taps)
+{
+  for (int i = 0; i < outSize; ++i) {
+    const double x = position(i);
+    const int base = static_cast<int>(std::floor(x));
+    const double t = x - base;
+    // The taps start one sample before the base for cubic interpolation.
+    const int start = taps == 4 ? base - 1 : base;
+    for (int k = 0; k < taps; ++k) {
+      const int index = start + k;
+      indices[i * taps + k] = std::min(std::max(index, 0), inSize - 1);
+      weights[i * taps + k] =
+        taps == 4 ? cubicWeight(x - index) : (k == 0 ? 1.0 - t : t);
+    }
+  }
+}
+
+double Kernel::position(int i) const
+{
+  if (outSize < 2) {
+    return 0.0;
+  }
+  return i * static_cast<double>(inSize - 1) / (outSize - 1);
+}
+
+bool resampleImage(vtkImageData* image, const int outDims[3],
+                   const ArrayFunction& function)
+{
+  int inDims[3];
+  image->GetDimensions(inDims);
+  const vtkIdType outTuples =
+    static_cast<vtkIdType>(outDims[0]) * outDims[1] * outDims[2];
+
+  vtkPointData* pointData = image->GetPointData();
+  std::vector<vtkSmartPointer<vtkDataArray>> arrays;
+  for (int i = 0; i < pointData->GetNumberOfArrays(); ++i) {
+    vtkDataArray* input = pointData->GetArray(i);
+    if (!input) {
+      continue;
+    }
+    vtkSmartPointer<vtkDataArray> output;
+    output.TakeReference(input->NewInstance());
+    output->SetName(input->GetName());
+    output->SetNumberOfComponents(input->GetNumberOfComponents());
+    output->SetNumberOfTuples(outTuples);
+    if (!function(input, inDims, outDims, output)) {
+      return false;
+    }
+    arrays.push_back(output);
+  }
+
+  vtkSmartPointer<vtkDataArray> angles =
+    image->GetFieldData()->GetArray("tilt_angles");
+  if (angles && angles->GetNumberOfTuples() == inDims[2] &&
+      outDims[2] != inDims[2]) {
+    const int angleInDims[3] = { 1, 1, inDims[2] };
+    const int angleOutDims[3] = { 1, 1, outDims[2] };
+    vtkSmartPointer<vtkDataArray> resampled;
+    resampled.TakeReference(angles->NewInstance());
+    resampled->SetName(angles->GetName());
+    resampled->SetNumberOfComponents(angles->GetNumberOfComponents());
+    resampled->SetNumberOfTuples(outDims[2]);
+    if (!function(angles, angleInDims, angleOutDims, resampled)) {
+      return false;
+    }
+    image->GetFieldData()->AddArray(resampled);
+  }
+
+  vtkDataArray* scalars = pointData->GetScalars();
+  const std::string active =
+    scalars && scalars->GetName() ? scalars->GetName() : "";
+  image->SetExtent(0, outDims[0] - 1, 0, outDims[1] - 1, 0, outDims[2] - 1);
+  pointData->Initialize();
+  for (auto& array : arrays) {
+    pointData->AddArray(array);
+  }
+  if (!active.empty()) {
+    pointData->SetActiveScalars(active.c_str());
+  } else if (!arrays.empty()) {
+    pointData->SetScalars(arrays[0]);
+  }
+  return true;
+}
+} // namespace Resample
+} // namespace tomviz
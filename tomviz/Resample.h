@@ -0,0 +1,328 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizResample_h
+#define tomvizResample_h
+
+#include "ParallelFor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+class vtkDataArray;
+class vtkImageData;
+
+namespace tomviz {
+
+namespace Resample {
+
+/// Interpolation of the resampling, the values match the spline orders of
+/// scipy.ndimage.zoom used by the Python operators.
+enum class Interpolation
+{
+  Linear = 1,
+  Cubic = 3
+};
+
+/// Number of samples of an axis of size samples zoomed by factor, matching
+/// utils.zoom_shape, at least one.
+int zoomedSize(int size, double factor);
+
+/// The weights resampling an axis of inSize samples to outSize samples. The
+/// first and last samples of the axis are kept in place, as scipy's zoom
+/// does, so output sample i sits at i * (inSize - 1) / (outSize - 1) in the
+/// input. Output sample i is the sum over the taps k of
+/// weights[i * taps + k] * input[indices[i * taps + k]], with the indices
+/// clamped to the axis.
+struct Kernel
+{
+  Kernel(int inSize, int outSize, Interpolation interpolation);
+
+  int inSize;
+  int outSize;
+  int taps;
+  std::vector<int> indices;
+  std::vector<double> weights;
+
+  /// Position of output sample i in the input, in samples.
+  double position(int i) const;
+};
+
+/// Resample a volume of tuples of components to outDims with separable
+/// kernels, one pass per axis whose size changes. Passes run over parallel
+/// z slabs and keep intermediate results as float, or double for double
+/// data. Integral output is rounded and clamped to the range of the type.
+/// Returns false if canceled.
+template <typename T>
+bool resample(const T* input, const int inDims[3], int components,
+              const int outDims[3], Interpolation interpolation, T* output,
+              const std::function<bool()>& canceled = nullptr);
+
+/// Bin a volume of tuples of components by integer factors, each output
+/// voxel is the average of a factors[0] x factors[1] x factors[2] box of
+/// input voxels. Voxels past the last whole box of an axis are dropped, see
+/// binnedSize(). Boxes are summed a row at a time, so the inner loops are
+/// contiguous adds the compiler vectorizes. Returns false if canceled.
+template <typename T>
+bool bin(const T* input, const int inDims[3], int components,
+         const int factors[3], T* output,
+         const std::function<bool()>& canceled = nullptr);
+
+/// Number of samples of an axis of size samples binned by factor, at least
+/// one.
+inline int binnedSize(int size, int factor)
+{
+  return std::max(size / std::max(factor, 1), 1);
+}
+
+/// Fills output, of the same type and components as input, with input
+/// resampled from inDims to outDims. Returns false if canceled.
+using ArrayFunction =
+  std::function<bool(vtkDataArray* input, const int inDims[3],
+                     const int outDims[3], vtkDataArray* output)>;
+
+/// Resample every point array of image to outDims with function, then set
+/// the new dimensions, with the extent starting at zero. A tilt series keeps
+/// one tilt angle per slice, its tilt angles are resampled as a column of
+/// slices. Arrays keep their names and the active scalars stay active.
+/// Geometry is left to the caller. Returns false, leaving image untouched,
+/// if canceled.
+bool resampleImage(vtkImageData* image, const int outDims[3],
+                   const ArrayFunction& function);
+
+namespace detail {
+
+/// Intermediate values are float, double for double data.
+template <typename T>
+using Real =
+  typename std::conditional<std::is_same<T, double>::value, double,
+                            float>::type;
+
+/// Sums of up to a few hundred 8 or 16 bit values and of floats fit a float,
+/// anything wider is summed as double.
+template <typename T>
+using Sum = typename std::conditional<
+  (sizeof(T) > 2 && !std::is_same<T, float>::value), double, float>::type;
+
+template <typename T, typename R,
+          typename std::enable_if<std::is_integral<T>::value>::type* = nullptr>
+T convert(R value)
+{
+  const R rounded = std::round(value);
+  if (rounded <= static_cast<R>(std::numeric_limits<T>::lowest())) {
+    return std::numeric_limits<T>::lowest();
+  }
+  if (rounded >= static_cast<R>(std::numeric_limits<T>::max())) {
+    return std::numeric_limits<T>::max();
+  }
+  return static_cast<T>(rounded);
+}
+
+template <typename T, typename R,
+          typename std::enable_if<!std::is_integral<T>::value>::type* = nullptr>
+T convert(R value)
+{
+  return static_cast<T>(value);
+}
+
+/// Resample one axis of a volume of dims, where dims[0] counts values rather
+/// than tuples along x, so x has a stride of components.
+template <typename In, typename Out, typename R>
+void resampleAxis(const In* input, const int64_t dims[3], int components,
+                  int axis, const Kernel& kernel, Out* output)
+{
+  const int64_t nx = dims[0];
+  const int64_t ny = dims[1];
+  const int64_t nz = dims[2];
+  const int taps = kernel.taps;
+  const int64_t outSize = kernel.outSize;
+
+  if (axis == 0) {
+    const int64_t outNx = outSize * components;
+    parallelFor(0, nz, [&](int64_t begin, int64_t end) {
+      for (int64_t z = begin; z < end; ++z) {
+        for (int64_t y = 0; y < ny; ++y) {
+          const In* row = input + (z * ny + y) * nx;
+          Out* outRow = output + (z * ny + y) * outNx;
+          for (int64_t i = 0; i < outSize; ++i) {
+            const int* index = &kernel.indices[i * taps];
+            const double* weight = &kernel.weights[i * taps];
+            for (int c = 0; c < components; ++c) {
+              R value = 0;
+              for (int k = 0; k < taps; ++k) {
+                value += static_cast<R>(weight[k]) *
+                         static_cast<R>(row[index[k] * components + c]);
+              }
+              outRow[i * components + c] = convert<Out>(value);
+            }
+          }
+        }
+      }
+    });
+  } else if (axis == 1) {
+    // Whole rows are weighted and summed, contiguous along x.
+    parallelFor(0, nz, [&](int64_t begin, int64_t end) {
+      std::vector<R> sum(nx);
+      for (int64_t z = begin; z < end; ++z) {
+        for (int64_t i = 0; i < outSize; ++i) {
+          std::fill(sum.begin(), sum.end(), R(0));
+          for (int k = 0; k < taps; ++k) {
+            const R weight = static_cast<R>(kernel.weights[i * taps + k]);
+            const int64_t y = kernel.indices[i * taps + k];
+            const In* row = input + (z * ny + y) * nx;
+            for (int64_t x = 0; x < nx; ++x) {
+              sum[x] += weight * static_cast<R>(row[x]);
+            }
+          }
+          Out* outRow = output + (z * outSize + i) * nx;
+          for (int64_t x = 0; x < nx; ++x) {
+            outRow[x] = convert<Out>(sum[x]);
+          }
+        }
+      }
+    });
+  } else {
+    // Whole slices are weighted and summed, each output slice is a slab.
+    const int64_t sliceSize = nx * ny;
+    parallelFor(0, outSize, [&](int64_t begin, int64_t end) {
+      std::vector<R> sum(sliceSize);
+      for (int64_t i = begin; i < end; ++i) {
+        std::fill(sum.begin(), sum.end(), R(0));
+        for (int k = 0; k < taps; ++k) {
+          const R weight = static_cast<R>(kernel.weights[i * taps + k]);
+          const In* slice = input + kernel.indices[i * taps + k] * sliceSize;
+          for (int64_t j = 0; j < sliceSize; ++j) {
+            sum[j] += weight * static_cast<R>(slice[j]);
+          }
+        }
+        Out* outSlice = output + i * sliceSize;
+        for (int64_t j = 0; j < sliceSize; ++j) {
+          outSlice[j] = convert<Out>(sum[j]);
+        }
+      }
+    });
+  }
+}
+} // namespace detail
+
+template <typename T>
+bool resample(const T* input, const int inDims[3], int components,
+              const int outDims[3], Interpolation interpolation, T* output,
+              const std::function<bool()>& canceled)
+{
+  using R = detail::Real<T>;
+
+  std::vector<int> axes;
+  for (int axis = 0; axis < 3; ++axis) {
+    if (outDims[axis] != inDims[axis]) {
+      axes.push_back(axis);
+    }
+  }
+  int64_t dims[3] = { static_cast<int64_t>(inDims[0]) * components, inDims[1],
+                      inDims[2] };
+  if (axes.empty()) {
+    std::copy(input, input + dims[0] * dims[1] * dims[2], output);
+    return true;
+  }
+
+  // Each pass reads the result of the previous one, the first reads the
+  // input and the last writes the output.
+  std::vector<R> previous;
+  std::vector<R> next;
+  for (size_t pass = 0; pass < axes.size(); ++pass) {
+    if (canceled && canceled()) {
+      return false;
+    }
+    const int axis = axes[pass];
+    const Kernel kernel(inDims[axis], outDims[axis], interpolation);
+    int64_t nextDims[3] = { dims[0], dims[1], dims[2] };
+    nextDims[axis] = axis == 0
+                       ? static_cast<int64_t>(outDims[0]) * components
+                       : static_cast<int64_t>(outDims[axis]);
+    const bool first = pass == 0;
+    const bool last = pass + 1 == axes.size();
+    if (!last) {
+      next.resize(nextDims[0] * nextDims[1] * nextDims[2]);
+    }
+    if (first && last) {
+      detail::resampleAxis<T, T, R>(input, dims, components, axis, kernel,
+                                    output);
+    } else if (first) {
+      detail::resampleAxis<T, R, R>(input, dims, components, axis, kernel,
+                                    next.data());
+    } else if (last) {
+      detail::resampleAxis<R, T, R>(previous.data(), dims, components, axis,
+                                    kernel, output);
+    } else {
+      detail::resampleAxis<R, R, R>(previous.data(), dims, components, axis,
+                                    kernel, next.data());
+    }
+    previous.swap(next);
+    std::copy(nextDims, nextDims + 3, dims);
+  }
+  return true;
+}
+
+template <typename T>
+bool bin(const T* input, const int inDims[3], int components,
+         const int factors[3], T* output,
+         const std::function<bool()>& canceled)
+{
+  using S = detail::Sum<T>;
+
+  const int64_t nx = static_cast<int64_t>(inDims[0]) * components;
+  const int64_t ny = inDims[1];
+  const int64_t outDims[3] = { binnedSize(inDims[0], factors[0]),
+                               binnedSize(inDims[1], factors[1]),
+                               binnedSize(inDims[2], factors[2]) };
+  // Factors larger than an axis bin the whole axis.
+  const int64_t f[3] = { std::min<int64_t>(factors[0], inDims[0]),
+                         std::min<int64_t>(factors[1], inDims[1]),
+                         std::min<int64_t>(factors[2], inDims[2]) };
+  const S scale = S(1) / static_cast<S>(f[0] * f[1] * f[2]);
+  const int64_t outNx = outDims[0] * components;
+
+  std::atomic<bool> stopped(false);
+  parallelFor(0, outDims[2], [&](int64_t begin, int64_t end) {
+    std::vector<S> sum(nx);
+    for (int64_t z = begin; z < end; ++z) {
+      if (canceled && canceled()) {
+        stopped = true;
+        return;
+      }
+      for (int64_t y = 0; y < outDims[1]; ++y) {
+        // Sum the rows of the box, then the runs of x along the summed row.
+        std::fill(sum.begin(), sum.end(), S(0));
+        for (int64_t dz = 0; dz < f[2]; ++dz) {
+          for (int64_t dy = 0; dy < f[1]; ++dy) {
+            const T* row = input + ((z * f[2] + dz) * ny + y * f[1] + dy) * nx;
+            for (int64_t x = 0; x < nx; ++x) {
+              sum[x] += static_cast<S>(row[x]);
+            }
+          }
+        }
+        T* outRow = output + (z * outDims[1] + y) * outNx;
+        for (int64_t x = 0; x < outDims[0]; ++x) {
+          for (int c = 0; c < components; ++c) {
+            S value = 0;
+            for (int64_t dx = 0; dx < f[0]; ++dx) {
+              value += sum[(x * f[0] + dx) * components + c];
+            }
+            outRow[x * components + c] = detail::convert<T>(value * scale);
+          }
+        }
+      }
+    }
+  });
+  return !stopped;
+}
+} // namespace Resample
+} // namespace tomviz
+
+#endif
@@ -0,0 +1,83 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "RotateAlignPreview.h"
+
+#include "TomographyReconstruction.h"
+#include "TomographyTiltSeries.h"
+
+#include <vtkImageData.h>
+
+#include <cmath>
+
+#define PI 3.14159265359
+
+namespace tomviz {
+
+namespace RotateAlignPreview {
+
+double sliceShift(int shiftRotation, double tiltRotation, int sliceNum,
+                  int numberOfSlices)
+{
+  return shiftRotation +
+         sin(-tiltRotation * PI / 180) * (sliceNum - numberOfSlices / 2);
+}
+
+Preview reconstructSlice(vtkSmartPointer<vtkImageData> imageData,
+                         std::vector<double> tiltAngles, int sliceNum,
+                         double shift, int numberOfRays, int generation,
+                         std::shared_ptr<std::atomic<int>> latest)
+{
+  Preview preview;
+  if (generation != *latest) {
+    return preview;
+  }
+
+  int dims[3];
+  imageData->GetDimensions(dims);
+  std::vector<float> sinogram(numberOfRays * dims[2]);
+  TomographyTiltSeries::getSinogram(imageData, sliceNum, &sinogram[0],
+                                    numberOfRays, shift);
+  if (generation != *latest) {
+    return preview;
+  }
+
+  preview.image.resize(numberOfRays * numberOfRays);
+  TomographyReconstruction::unweightedBackProjection2(
+    &sinogram[0], &tiltAngles[0], &preview.image[0], dims[2], numberOfRays);
+  preview.generation = generation;
+  preview.numberOfRays = numberOfRays;
+  return preview;
+}
+
+double sharpness(const std::vector<float>& image, int n)
+{
+  double squares = 0.0;
+  double fourths = 0.0;
+  for (int i = 0; i < n * n; ++i) {
+    double square = static_cast<double>(image[i]) * image[i];
+    squares += square;
+    fourths += square * square;
+  }
+  return squares > 0.0 ? fourths / (squares * squares) * n * n : 0.0;
+}
+
+double ScoreAxisCandidate::operator()(const AxisCandidate& candidate) const
+{
+  int dims[3];
+  imageData->GetDimensions(dims);
+  std::vector<float> sinogram(SearchRaySize * dims[2]);
+  std::vector<float> recon(SearchRaySize * SearchRaySize);
+  double score = 0.0;
+  for (int slice : slices) {
+    double shift = sliceShift(candidate.shift, candidate.angle, slice, dims[0]);
+    TomographyTiltSeries::getSinogram(imageData, slice, &sinogram[0],
+                                      SearchRaySize, shift);
+    TomographyReconstruction::unweightedBackProjection2(
+      &sinogram[0], &tiltAngles[0], &recon[0], dims[2], SearchRaySize);
+    score += sharpness(recon, SearchRaySize);
+  }
+  return score;
+}
+} // namespace RotateAlignPreview
+} // namespace tomviz
@@ -0,0 +1,78 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizRotateAlignPreview_h
+#define tomvizRotateAlignPreview_h
+
+#include <vtkSmartPointer.h>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+class vtkImageData;
+
+namespace tomviz {
+
+/// The reconstructions the rotation alignment widget previews candidate tilt
+/// axes with. These run on worker threads, they only use the tilt series and
+/// the arguments they are given.
+namespace RotateAlignPreview {
+
+/// Size of the reconstructions scored by the automatic search.
+const int SearchRaySize = 128;
+
+struct Preview
+{
+  /// The request this is the result of, -1 if it was superseded.
+  int generation = -1;
+  int numberOfRays = 0;
+  /// numberOfRays by numberOfRays reconstruction of the slice.
+  std::vector<float> image;
+};
+
+/// Shift of the tilt axis at slice sliceNum, approximating the in-plane
+/// rotation of the axis by tiltRotation degrees as a shift in y.
+double sliceShift(int shiftRotation, double tiltRotation, int sliceNum,
+                  int numberOfSlices);
+
+/// Reconstruct slice sliceNum of the tilt series using numberOfRays rays and
+/// an axis shifted by shift. This gives up early, returning an empty preview,
+/// if latest no longer holds generation because a newer preview has been
+/// requested in the meantime.
+Preview reconstructSlice(vtkSmartPointer<vtkImageData> imageData,
+                         std::vector<double> tiltAngles, int sliceNum,
+                         double shift, int numberOfRays, int generation,
+                         std::shared_ptr<std::atomic<int>> latest);
+
+/// Image sharpness used to rank candidate rotation axes, this is how
+/// concentrated the energy of the image is: the sum of the fourth powers over
+/// the square of the sum of squares, times the number of pixels, so a flat
+/// image scores 1 and a single bright pixel n * n. A misaligned axis smears
+/// features into arcs, which spreads out their energy. Gradient based scores
+/// do not work here, the arcs have edges of their own.
+double sharpness(const std::vector<float>& image, int n);
+
+struct AxisCandidate
+{
+  int shift = 0;
+  double angle = 0.0;
+};
+
+/// Scores one candidate axis against the three preview slices, this is mapped
+/// over all of the candidates in parallel.
+struct ScoreAxisCandidate
+{
+  typedef double result_type;
+
+  vtkSmartPointer<vtkImageData> imageData;
+  std::vector<double> tiltAngles;
+  std::array<int, 3> slices;
+
+  double operator()(const AxisCandidate& candidate) const;
+};
+} // namespace RotateAlignPreview
+} // namespace tomviz
+
+#endif
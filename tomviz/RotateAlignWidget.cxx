@@ -7,8 +7,7 @@
 #include "AddPythonTransformReaction.h"
 #include "DataSource.h"
 #include "LoadDataReaction.h"
-#include "TomographyReconstruction.h"
-#include "TomographyTiltSeries.h"
+#include "RotateAlignPreview.h"
 #include "Utilities.h"
 
 #include <cmath>
@@ -44,6 +43,7 @@
 #include "ui_RotateAlignWidget.h"
 
 #include <QDoubleSpinBox>
+#include <QFutureWatcher>
 #include <QGridLayout>
 #include <QHBoxLayout>
 #include <QKeyEvent>
@@ -54,14 +54,32 @@
 #include <QSpinBox>
 #include <QTimer>
 #include <QVBoxLayout>
+#include <QVector>
+#include <QtConcurrent>
 
 #include <algorithm>
 #include <array>
-
-#define PI 3.14159265359
+#include <atomic>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <vector>
 
 namespace tomviz {
 
+namespace {
+
+// Reconstruction sizes used for the previews, each preview is first shown at
+// the coarsest size and then refined up to the size of the tilt series.
+const int PreviewRaySizes[] = { 64, 256 };
+
+using RotateAlignPreview::AxisCandidate;
+using RotateAlignPreview::Preview;
+using RotateAlignPreview::ScoreAxisCandidate;
+using RotateAlignPreview::reconstructSlice;
+using RotateAlignPreview::sliceShift;
+} // namespace
+
 class RotateAlignWidget::RAWInternal
 {
 public:
@@ -83,6 +101,15 @@ public:
   bool m_reconSliceDirty[3];
   QTimer m_updateSlicesTimer;
 
+  // Latest preview requested for each slice, shared with the worker threads
+  // so stale requests can bail out early.
+  std::shared_ptr<std::atomic<int>> m_reconGeneration[3];
+  QFutureWatcher<Preview> m_reconWatcher[3];
+
+  QVector<AxisCandidate> m_searchCandidates;
+  QFutureWatcher<double> m_searchWatcher;
+  bool m_searchRefining = false;
+
   LengthUnit m_lengthUnit = LengthUnit::pixel;
   int m_projectionNum;
   int m_shiftRotation;
@@ -94,10 +121,26 @@ public:
   RAWInternal()
   {
     m_reconSliceDirty[0] = m_reconSliceDirty[1] = m_reconSliceDirty[2] = true;
-    m_updateSlicesTimer.setInterval(500);
+    m_updateSlicesTimer.setInterval(100);
     m_updateSlicesTimer.setSingleShot(true);
     QObject::connect(&m_updateSlicesTimer, &QTimer::timeout,
                      [this]() { this->updateDirtyReconSlices(); });
+    for (int i = 0; i < 3; ++i) {
+      m_reconGeneration[i] = std::make_shared<std::atomic<int>>(0);
+      QObject::connect(&m_reconWatcher[i], &QFutureWatcherBase::finished,
+                       [this, i]() { this->reconSliceFinished(i); });
+    }
+  }
+
+  ~RAWInternal()
+  {
+    // Invalidate any previews still in flight, the worker threads only hold
+    // shared copies of what they need so they can finish on their own.
+    for (int i = 0; i < 3; ++i) {
+      ++*m_reconGeneration[i];
+    }
+    m_searchWatcher.cancel();
+    m_searchWatcher.waitForFinished();
   }
 
   void setupCameras()
@@ -186,65 +229,209 @@ public:
   {
     for (int i = 0; i < 3; ++i) {
       if (m_reconSliceDirty[i]) {
-        this->updateReconSlice(i);
+        this->requestReconSlice(i);
         m_reconSliceDirty[i] = false;
       }
     }
   }
 
+  std::vector<double> tiltAngles() const
+  {
+    vtkDataArray* tiltAnglesArray =
+      m_image->GetFieldData()->GetArray("tilt_angles");
+    std::vector<double> angles(tiltAnglesArray->GetNumberOfTuples());
+    for (size_t i = 0; i < angles.size(); ++i) {
+      angles[i] = tiltAnglesArray->GetTuple1(i);
+    }
+    return angles;
+  }
+
+  int sliceNumber(int i) const
+  {
+    int sliceNumbers[] = { m_slice0, m_slice1, m_slice2 };
+    return sliceNumbers[i];
+  }
+
+  /// Sizes the preview of a slice is refined through, ending at the full size
+  /// of the tilt series.
+  std::vector<int> previewRaySizes() const
+  {
+    int dims[3];
+    m_image->GetDimensions(dims);
+    std::vector<int> sizes;
+    for (int size : PreviewRaySizes) {
+      if (size < dims[1]) {
+        sizes.push_back(size);
+      }
+    }
+    sizes.push_back(dims[1]);
+    return sizes;
+  }
+
+  /// Start computing the preview of slice i in the background, superseding
+  /// any preview of that slice that is still being computed.
+  void requestReconSlice(int i)
+  {
+    if (m_image) {
+      ++*m_reconGeneration[i];
+      startReconSlice(i, previewRaySizes().front());
+    }
+  }
+
+  void startReconSlice(int i, int numberOfRays)
+  {
+    int dims[3];
+    m_image->GetDimensions(dims);
+    int sliceNum = sliceNumber(i);
+    double shift =
+      sliceShift(m_shiftRotation, m_tiltRotation, sliceNum, dims[0]);
+    vtkSmartPointer<vtkImageData> image = m_image;
+    std::vector<double> angles = tiltAngles();
+    int generation = *m_reconGeneration[i];
+    auto latest = m_reconGeneration[i];
+    m_reconWatcher[i].setFuture(QtConcurrent::run([=]() {
+      return reconstructSlice(image, angles, sliceNum, shift, numberOfRays,
+                              generation, latest);
+    }));
+  }
+
+  /// Start the next refinement of the preview of slice i, if there is one.
+  void refineReconSlice(int i, int numberOfRays)
+  {
+    auto sizes = previewRaySizes();
+    auto next = std::upper_bound(sizes.begin(), sizes.end(), numberOfRays);
+    if (next != sizes.end()) {
+      startReconSlice(i, *next);
+    }
+  }
+
+  void reconSliceFinished(int i)
+  {
+    Preview preview = m_reconWatcher[i].result();
+    if (preview.generation != *m_reconGeneration[i]) {
+      // Superseded, the newer request is already on its way.
+      return;
+    }
+    showReconSlice(i, preview);
+    refineReconSlice(i, preview.numberOfRays);
+  }
+
+  /// Compute the preview of slice i at the coarsest size on this thread, this
+  /// is used once at start up so the cameras can be set up. The finer sizes
+  /// follow in the background.
   void updateReconSlice(int i)
   {
-    vtkImageData* imageData = m_image;
-    if (imageData) {
-      int extent[6];
-      imageData->GetExtent(extent);
-      int dims[3] = { extent[1] - extent[0] + 1, extent[3] - extent[2] + 1,
-                      extent[5] - extent[4] + 1 };
-
-      int sliceNumbers[] = { m_slice0, m_slice1, m_slice2 };
-      int sliceNum = sliceNumbers[i];
-
-      int Nray = 256; // Size of 2D reconstruction. Fixed for all tilt series
-      std::vector<float> sinogram(Nray * dims[2]);
-      // Approximate in-plance rotation as a shift in y-direction
-      double shift =
-        this->m_shiftRotation +
-        sin(-this->m_tiltRotation * PI / 180) * (sliceNum - dims[0] / 2);
-
-      TomographyTiltSeries::getSinogram(
-        imageData, sliceNum, &sinogram[0], Nray,
-        shift); // Get a sinogram from tilt series
-      this->reconImage[i]->SetExtent(0, Nray - 1, 0, Nray - 1, 0, 0);
-      this->reconImage[i]->AllocateScalars(VTK_FLOAT, 1);
-      vtkDataArray* reconArray =
-        this->reconImage[i]->GetPointData()->GetScalars();
-      float* reconPtr = static_cast<float*>(reconArray->GetVoidPointer(0));
-
-      vtkDataArray* tiltAnglesArray =
-        imageData->GetFieldData()->GetArray("tilt_angles");
-      double* tiltAngles =
-        static_cast<double*>(tiltAnglesArray->GetVoidPointer(0));
-
-      TomographyReconstruction::unweightedBackProjection2(
-        &sinogram[0], tiltAngles, reconPtr, dims[2], Nray);
-      this->reconSliceMapper[i]->SetInputData(this->reconImage[i].GetPointer());
-      this->reconSliceMapper[i]->SetSliceNumber(0);
-      this->reconSliceMapper[i]->Update();
+    if (m_image) {
+      int dims[3];
+      m_image->GetDimensions(dims);
+      int sliceNum = sliceNumber(i);
+      Preview preview = reconstructSlice(
+        m_image, tiltAngles(), sliceNum,
+        sliceShift(m_shiftRotation, m_tiltRotation, sliceNum, dims[0]),
+        previewRaySizes().front(), *m_reconGeneration[i],
+        m_reconGeneration[i]);
+      showReconSlice(i, preview);
+      refineReconSlice(i, preview.numberOfRays);
+    }
+  }
 
-      double range[2];
-      reconArray->GetRange(range);
-      vtkSMTransferFunctionProxy::RescaleTransferFunction(
-        this->ReconColorMap[i], range);
-      this->reconSlice[i]->GetProperty()->SetLookupTable(
-        vtkScalarsToColors::SafeDownCast(
-          this->ReconColorMap[i]->GetClientSideObject()));
-
-      tomviz::QVTKGLWidget* sliceView[] = { this->Ui.sliceView_1,
-                                            this->Ui.sliceView_2,
-                                            this->Ui.sliceView_3 };
-
-      sliceView[i]->GetRenderWindow()->Render();
+  /// Candidate axes for the automatic search. The first pass covers a coarse
+  /// grid around the current axis, the second refines around the best
+  /// candidate of the first pass.
+  QVector<AxisCandidate> searchCandidates(const AxisCandidate& center,
+                                          bool refine) const
+  {
+    int dims[3];
+    m_image->GetDimensions(dims);
+    int shiftRange = std::max(1, dims[1] / 8);
+    int shiftStep = std::max(1, shiftRange / 10);
+    double angleRange = 5.0;
+    double angleStep = 1.0;
+    if (refine) {
+      shiftRange = shiftStep;
+      shiftStep = 1;
+      angleRange = angleStep;
+      angleStep = 0.25;
+    }
+
+    QVector<AxisCandidate> candidates;
+    for (int shift = -shiftRange; shift <= shiftRange; shift += shiftStep) {
+      for (double angle = -angleRange; angle <= angleRange + 1e-6;
+           angle += angleStep) {
+        AxisCandidate candidate;
+        candidate.shift = center.shift + shift;
+        candidate.angle = center.angle + angle;
+        if (std::abs(candidate.shift) <= dims[1] / 2) {
+          candidates.append(candidate);
+        }
+      }
     }
+    return candidates;
+  }
+
+  /// Score the candidates in parallel, the results are collected through
+  /// m_searchWatcher.
+  void startSearch(const QVector<AxisCandidate>& candidates)
+  {
+    ScoreAxisCandidate score;
+    score.imageData = m_image;
+    score.tiltAngles = tiltAngles();
+    score.slices = { { m_slice0, m_slice1, m_slice2 } };
+    m_searchCandidates = candidates;
+    m_searchWatcher.setFuture(QtConcurrent::mapped(m_searchCandidates, score));
+  }
+
+  AxisCandidate bestCandidate() const
+  {
+    AxisCandidate best;
+    best.shift = m_shiftRotation;
+    best.angle = m_tiltRotation;
+    double bestScore = -std::numeric_limits<double>::max();
+    QFuture<double> future = m_searchWatcher.future();
+    for (int i = 0; i < m_searchCandidates.size(); ++i) {
+      if (future.resultAt(i) > bestScore) {
+        bestScore = future.resultAt(i);
+        best = m_searchCandidates[i];
+      }
+    }
+    return best;
+  }
+
+  void showReconSlice(int i, const Preview& preview)
+  {
+    int dims[3];
+    m_image->GetDimensions(dims);
+    int Nray = preview.numberOfRays;
+
+    // Keep the physical size of the preview fixed as it is refined, so the
+    // camera does not need to be reset.
+    double spacing = static_cast<double>(previewRaySizes().back()) / Nray;
+    this->reconImage[i]->SetExtent(0, Nray - 1, 0, Nray - 1, 0, 0);
+    this->reconImage[i]->SetSpacing(spacing, spacing, 1.0);
+    this->reconImage[i]->AllocateScalars(VTK_FLOAT, 1);
+    vtkDataArray* reconArray =
+      this->reconImage[i]->GetPointData()->GetScalars();
+    float* reconPtr = static_cast<float*>(reconArray->GetVoidPointer(0));
+    std::copy(preview.image.begin(), preview.image.end(), reconPtr);
+    this->reconImage[i]->Modified();
+
+    this->reconSliceMapper[i]->SetInputData(this->reconImage[i].GetPointer());
+    this->reconSliceMapper[i]->SetSliceNumber(0);
+    this->reconSliceMapper[i]->Update();
+
+    double range[2];
+    reconArray->GetRange(range);
+    vtkSMTransferFunctionProxy::RescaleTransferFunction(this->ReconColorMap[i],
+                                                        range);
+    this->reconSlice[i]->GetProperty()->SetLookupTable(
+      vtkScalarsToColors::SafeDownCast(
+        this->ReconColorMap[i]->GetClientSideObject()));
+
+    tomviz::QVTKGLWidget* sliceView[] = { this->Ui.sliceView_1,
+                                          this->Ui.sliceView_2,
+                                          this->Ui.sliceView_3 };
+
+    sliceView[i]->GetRenderWindow()->Render();
   }
 
   void updateSliceLines()
@@ -401,6 +588,16 @@ RotateAlignWidget::RotateAlignWidget(Operator* op,
                    &RotateAlignWidget::onRotationAngleChanged);
   this->Internals->Ui.rotationAngle->installEventFilter(this);
 
+  QObject::connect(this->Internals->Ui.autoSearchButton,
+                   &QPushButton::clicked, this,
+                   &RotateAlignWidget::onAutoSearchClicked);
+  QObject::connect(&this->Internals->m_searchWatcher,
+                   &QFutureWatcherBase::progressValueChanged, this,
+                   &RotateAlignWidget::onAutoSearchProgress);
+  QObject::connect(&this->Internals->m_searchWatcher,
+                   &QFutureWatcherBase::finished, this,
+                   &RotateAlignWidget::onAutoSearchFinished);
+
   //  this->connect(this->Internals->Ui.pushButton, SIGNAL(pressed()),
   //                SLOT(onFinalReconButtonPressed()));
 
@@ -862,4 +1059,51 @@ void RotateAlignWidget::updateControls()
 }
 
 void RotateAlignWidget::onFinalReconButtonPressed() {}
+
+void RotateAlignWidget::onAutoSearchClicked()
+{
+  if (this->Internals->m_searchWatcher.isRunning()) {
+    this->Internals->m_searchWatcher.cancel();
+    return;
+  }
+
+  AxisCandidate current;
+  current.shift = this->Internals->m_shiftRotation;
+  current.angle = this->Internals->m_tiltRotation;
+  this->Internals->m_searchRefining = false;
+  this->Internals->startSearch(
+    this->Internals->searchCandidates(current, false));
+  this->Internals->Ui.autoSearchButton->setText("Cancel Search");
+}
+
+void RotateAlignWidget::onAutoSearchProgress(int value)
+{
+  int maximum = this->Internals->m_searchWatcher.progressMaximum();
+  if (maximum > 0) {
+    this->Internals->Ui.autoSearchButton->setText(
+      QString("Cancel Search (%1%)").arg(100 * value / maximum));
+  }
+}
+
+void RotateAlignWidget::onAutoSearchFinished()
+{
+  if (this->Internals->m_searchWatcher.isCanceled()) {
+    this->Internals->Ui.autoSearchButton->setText("Auto Search");
+    return;
+  }
+
+  AxisCandidate best = this->Internals->bestCandidate();
+  if (!this->Internals->m_searchRefining) {
+    this->Internals->m_searchRefining = true;
+    this->Internals->startSearch(
+      this->Internals->searchCandidates(best, true));
+    return;
+  }
+
+  this->Internals->Ui.autoSearchButton->setText("Auto Search");
+  this->Internals->m_shiftRotation = best.shift;
+  this->Internals->m_tiltRotation = best.angle;
+  onRotationAxisChanged();
+  updateControls();
+}
 } // namespace tomviz
@@ -54,6 +54,10 @@ protected slots:
 
   void onFinalReconButtonPressed();
 
+  void onAutoSearchClicked();
+  void onAutoSearchProgress(int value);
+  void onAutoSearchFinished();
+
   void showChangeColorMapDialog0() { this->showChangeColorMapDialog(0); }
   void showChangeColorMapDialog1() { this->showChangeColorMapDialog(1); }
   void showChangeColorMapDialog2() { this->showChangeColorMapDialog(2); }
@@ -8,6 +8,7 @@
 #include "Utilities.h"
 
 #include "ActiveObjects.h"
+#include "BackgroundWriter.h"
 #include "DataSource.h"
 #include "FileFormatManager.h"
 #include "ModuleManager.h"
@@ -32,17 +33,71 @@
 #include <vtkPointData.h>
 #include <vtkTIFFWriter.h>
 #include <vtkTrivialProducer.h>
+#include <vtkWeakPointer.h>
 
 #include <cassert>
 
 #include <QDebug>
 #include <QFileDialog>
 #include <QFileInfo>
+#include <QPointer>
+#include <QProgressDialog>
 #include <QRegularExpression>
 #include <QStringList>
 
 namespace tomviz {
 
+namespace {
+
+void saveInBackground(const QString& fileName, DataSource* source,
+                      vtkImageData* data,
+                      const BackgroundWriter::WriteFunction& write)
+{
+  auto writer = new BackgroundWriter(fileName, data, write);
+  const QString name = QFileInfo(fileName).fileName();
+  auto dialog = new QProgressDialog(QString("Saving %1").arg(name), "Cancel", 0,
+                                    100, tomviz::mainWidget());
+  dialog->setWindowTitle("Saving Data");
+  dialog->setAttribute(Qt::WA_DeleteOnClose);
+  dialog->setAutoClose(false);
+  dialog->setAutoReset(false);
+  dialog->setMinimumDuration(500);
+  dialog->setValue(0);
+
+  QObject::connect(dialog, &QProgressDialog::canceled, writer,
+                   &BackgroundWriter::cancel);
+  QObject::connect(
+    writer, &BackgroundWriter::progressChanged, dialog,
+    [dialog, name](int percent, double bytesPerSecond) {
+      dialog->setLabelText(QString("Saving %1 (%2 MB/s)")
+                             .arg(name)
+                             .arg(bytesPerSecond / (1024 * 1024), 0, 'f', 1));
+      dialog->setValue(percent);
+    });
+  QPointer<DataSource> saved(source);
+  QPointer<QProgressDialog> progress(dialog);
+  // The source is only saved if its data did not change during the write.
+  vtkWeakPointer<vtkImageData> written(data);
+  const vtkMTimeType time = data->GetMTime();
+  QObject::connect(
+    writer, &BackgroundWriter::finished, writer,
+    [writer, saved, progress, fileName, written, time](bool success) {
+      if (progress) {
+        progress->close();
+      }
+      if (success && saved && written && saved->dataObject() == written &&
+          written->GetMTime() == time) {
+        saved->setPersistenceState(DataSource::PersistenceState::Saved);
+        saved->setFileName(fileName);
+      } else if (!success && !writer->isCanceled()) {
+        qCritical() << "Failed to write out" << fileName;
+      }
+      writer->deleteLater();
+    });
+  writer->start();
+}
+} // namespace
+
 SaveDataReaction::SaveDataReaction(QAction* parentObject)
   : pqReaction(parentObject)
 {
@@ -72,6 +127,10 @@ void SaveDataReaction::onTriggered()
           << "XDMF Data File (*.xmf)"
           << "JSON Image Files (*.json)";
 
+  foreach (auto format, FileFormatManager::instance().nativeFormats()) {
+    filters << format->fileDialogFilter();
+  }
+
   foreach (auto writer, FileFormatManager::instance().pythonWriterFactories()) {
     filters << writer->getFileDialogFilter();
   }
@@ -127,31 +186,37 @@ bool SaveDataReaction::saveData(const QString& filename)
 
   FileFormatManager::instance().registerPythonWriters();
 
+  // EMD, native and Python formats are written in the background.
   QFileInfo info(filename);
-  if (info.suffix() == "emd") {
-    EmdFormat writer;
-    if (!writer.write(filename.toLatin1().data(), source)) {
-      qCritical() << "Failed to write out data.";
-      return false;
-    } else {
-      updateSource(filename, source);
-      return true;
-    }
-  } else if (FileFormatManager::instance().pythonWriterFactory(
-               info.suffix().toLower()) != nullptr) {
-    auto factory = FileFormatManager::instance().pythonWriterFactory(
-      info.suffix().toLower());
-    Q_ASSERT(factory != nullptr);
-    auto writer = factory->createWriter();
+  const QString suffix = info.suffix().toLower();
+  BackgroundWriter::WriteFunction write;
+  if (suffix == "emd") {
+    write = [](const QString& fileName, vtkImageData* data,
+               const BackgroundWriter::Progress& progress) {
+      EmdFormat writer;
+      return writer.write(fileName.toStdString(), data, progress);
+    };
+  } else if (auto format = FileFormatManager::instance().nativeFormat(suffix)) {
+    write = [format](const QString& fileName, vtkImageData* data,
+                     const BackgroundWriter::Progress& progress) {
+      return format->write(fileName, data, progress);
+    };
+  } else if (auto factory =
+               FileFormatManager::instance().pythonWriterFactory(suffix)) {
+    write = [factory](const QString& fileName, vtkImageData* data,
+                      const BackgroundWriter::Progress&) {
+      // The writer holds Python objects, it is created and destroyed on the
+      // worker thread, under the GIL.
+      Python python;
+      auto writer = factory->createWriter();
+      return writer.write(fileName, data);
+    };
+  }
+  if (write) {
     auto t = source->producer();
     auto data = vtkImageData::SafeDownCast(t->GetOutputDataObject(0));
-    if (!writer.write(filename, data)) {
-      qCritical() << "Failed to write out data.";
-      return false;
-    } else {
-      updateSource(filename, source);
-      return true;
-    }
+    saveInBackground(filename, source, data, write);
+    return true;
   }
 
   vtkSMSourceProxy* producer = nullptr;
@@ -19,7 +19,9 @@ class SaveDataReaction : public pqReaction
 public:
   SaveDataReaction(QAction* parentAction);
 
-  /// Save the file
+  /// Save the file. EMD, native and Python formats are written in the
+  /// background, with progress shown, and this returns once the write has
+  /// started.
   bool saveData(const QString& filename);
 
 protected:
@@ -5,24 +5,67 @@
 
 #include "ModuleManager.h"
 #include "RecentFilesMenu.h"
+#include "StateBundle.h"
 #include "Utilities.h"
 
 #include <vtkSMProxyManager.h>
 
 #include <QDebug>
 #include <QDir>
+#include <QEventLoop>
 #include <QFileDialog>
 #include <QHBoxLayout>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QLabel>
 #include <QMessageBox>
+#include <QProgressDialog>
+#include <QScopedPointer>
 #include <QTimer>
 
 #include <vtk_pugixml.h>
 
 namespace tomviz {
 
+namespace {
+
+// Write the results gathered for a state, keeping the application responsive
+// meanwhile. Returns whether they were all written.
+bool writeResults(StateBundle::ResultsWriter& results, bool interactive)
+{
+  QScopedPointer<QProgressDialog> dialog;
+  if (interactive) {
+    dialog.reset(new QProgressDialog("Saving pipeline results", "Cancel", 0,
+                                     100, tomviz::mainWidget()));
+    dialog->setWindowTitle("Saving State");
+    dialog->setWindowModality(Qt::WindowModal);
+    dialog->setAutoClose(false);
+    dialog->setAutoReset(false);
+    dialog->setMinimumDuration(500);
+    dialog->setValue(0);
+    QObject::connect(dialog.data(), &QProgressDialog::canceled, &results,
+                     &StateBundle::ResultsWriter::cancel);
+    QObject::connect(&results, &StateBundle::ResultsWriter::progressChanged,
+                     dialog.data(), &QProgressDialog::setValue);
+  }
+
+  bool done = false;
+  bool success = false;
+  QEventLoop loop;
+  QObject::connect(&results, &StateBundle::ResultsWriter::finished, &loop,
+                   [&done, &success, &loop](bool written) {
+                     done = true;
+                     success = written;
+                     loop.quit();
+                   });
+  results.start();
+  if (!done) {
+    loop.exec();
+  }
+  return success;
+}
+} // namespace
+
 SaveLoadStateReaction::SaveLoadStateReaction(QAction* parentObject, bool load)
   : pqReaction(parentObject), m_load(load)
 {}
@@ -38,19 +81,22 @@ void SaveLoadStateReaction::onTriggered()
 
 bool SaveLoadStateReaction::saveState()
 {
-  QFileDialog fileDialog(tomviz::mainWidget(), tr("Save State File"), QString(),
-                         "Tomviz state files (*.tvsm);;All files (*)");
+  const QString withResultsFilter =
+    "Tomviz state files with results (*.tvsm)";
+  QFileDialog fileDialog(
+    tomviz::mainWidget(), tr("Save State File"), QString(),
+    "Tomviz state files (*.tvsm);;" + withResultsFilter + ";;All files (*)");
   fileDialog.setObjectName("SaveStateDialog");
   fileDialog.setAcceptMode(QFileDialog::AcceptSave);
   fileDialog.setFileMode(QFileDialog::AnyFile);
   if (fileDialog.exec() == QDialog::Accepted) {
     QString filename = fileDialog.selectedFiles()[0];
     QString format = fileDialog.selectedNameFilter();
-    if (!filename.endsWith(".tvsm") &&
-        format == "Tomviz state files (*.tvsm)") {
+    if (!filename.endsWith(".tvsm") && format.endsWith("(*.tvsm)")) {
       filename = QString("%1%2").arg(filename, ".tvsm");
     }
-    return SaveLoadStateReaction::saveState(filename);
+    return SaveLoadStateReaction::saveState(filename, true,
+                                            format == withResultsFilter);
   }
   return false;
 }
@@ -133,7 +179,8 @@ bool SaveLoadStateReaction::loadState(const QString& filename)
   return false;
 }
 
-bool SaveLoadStateReaction::saveState(const QString& fileName, bool interactive)
+bool SaveLoadStateReaction::saveState(const QString& fileName, bool interactive,
+                                      bool withResults)
 {
   QFileInfo info(fileName);
   QFile saveFile(fileName);
@@ -142,12 +189,36 @@ bool SaveLoadStateReaction::saveState(const QString& fileName, bool interactive)
     return false;
   }
 
+  QScopedPointer<StateBundle::ResultsWriter> results;
+  if (withResults) {
+    auto resultsDir = StateBundle::resultsDir(fileName);
+    if (resultsDir.mkpath(".")) {
+      results.reset(new StateBundle::ResultsWriter(info.dir(), resultsDir));
+    } else {
+      qWarning() << "Couldn't create" << resultsDir.path()
+                 << ", saving the state without results.";
+    }
+  }
+
   QJsonObject state;
-  auto success =
-    ModuleManager::instance().serialize(state, info.dir(), interactive);
+  auto success = ModuleManager::instance().serialize(
+    state, info.dir(), interactive, results.data());
+  if (success && results) {
+    // Results that could not be written are left out, their pipelines run
+    // again when the state is loaded.
+    if (!writeResults(*results, interactive) && !results->isCanceled()) {
+      qWarning("Couldn't write all the pipeline results.");
+    }
+    results->record(state);
+  }
   QJsonDocument doc(state);
   auto writeSuccess = saveFile.write(doc.toJson());
-  return success && writeSuccess != -1;
+  success = success && writeSuccess != -1;
+  if (success && results) {
+    // Results of an earlier save of this state may no longer be used.
+    StateBundle::removeUnusedResults(state, StateBundle::resultsDir(fileName));
+  }
+  return success;
 }
 
 QString SaveLoadStateReaction::extractLegacyStateFileVersion(
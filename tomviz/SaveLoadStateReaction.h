@@ -18,7 +18,10 @@ public:
   SaveLoadStateReaction(QAction* action, bool load = false);
 
   static bool saveState();
-  static bool saveState(const QString& filename, bool interactive = true);
+  /// Save the state to filename, with the results of the pipelines when
+  /// withResults is set, see StateBundle.
+  static bool saveState(const QString& filename, bool interactive = true,
+                        bool withResults = false);
   static bool loadState();
   static bool loadState(const QString& filename);
 
@@ -4,8 +4,10 @@
 #include "SaveWebReaction.h"
 
 #include "ActiveObjects.h"
+#include "BackgroundWriter.h"
 #include "DataSource.h"
 #include "ModuleManager.h"
+#include "WebBrickExport.h"
 
 #include "pqActiveObjects.h"
 #include "pqCoreUtilities.h"
@@ -19,13 +21,22 @@
 #include <cassert>
 
 #include <pqSettings.h>
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkPointData.h>
+#include <vtkSMPropertyHelper.h>
+#include <vtkSMProxy.h>
 
 #include <QCoreApplication>
 #include <QDebug>
 #include <QDialog>
 #include <QFileDialog>
+#include <QJsonArray>
+#include <QJsonObject>
 #include <QMap>
 #include <QMessageBox>
+#include <QPointer>
+#include <QProgressDialog>
 #include <QRegularExpression>
 #include <QString>
 #include <QVariant>
@@ -51,17 +62,22 @@ void SaveWebReaction::onTriggered()
 {
   WebExportWidget dialog;
   if (dialog.exec() == QDialog::Accepted) {
+    auto args = dialog.getKeywordArguments();
+    const bool bricks =
+      args["exportType"].toInt() == WebExportWidget::BricksExportType;
 
     QString lastUsedExt;
     // Load the most recently used file extensions from QSettings, if available.
     auto settings = pqApplicationCore::instance()->settings();
-    QString defaultFileName = "tomviz.html";
-    if (settings->contains("web/exportFilename")) {
-      defaultFileName = settings->value("web/exportFilename").toString();
+    const QString settingsKey =
+      bricks ? "web/bricksFilename" : "web/exportFilename";
+    QString defaultFileName = bricks ? "tomviz.json" : "tomviz.html";
+    if (settings->contains(settingsKey)) {
+      defaultFileName = settings->value(settingsKey).toString();
     }
 
     QStringList filters;
-    filters << "HTML (*.html)";
+    filters << (bricks ? "Brick manifest (*.json)" : "HTML (*.html)");
 
     QFileDialog fileDialog(nullptr, "Save Web Export:");
     fileDialog.setFileMode(QFileDialog::AnyFile);
@@ -73,16 +89,92 @@ void SaveWebReaction::onTriggered()
       return;
     }
 
-    auto args = dialog.getKeywordArguments();
     auto filePath = fileDialog.selectedFiles()[0];
     QFileInfo info(filePath);
     auto filename = info.fileName();
+    settings->setValue(settingsKey, QVariant(filename));
+    if (bricks) {
+      if (info.suffix().isEmpty()) {
+        filePath += ".json";
+      }
+      this->saveBricks(filePath);
+      return;
+    }
     args.insert("htmlFilePath", QVariant(filePath));
-    settings->setValue("web/exportFilename", QVariant(filename));
     this->saveWeb(args);
   }
 }
 
+void SaveWebReaction::saveBricks(const QString& fileName)
+{
+  auto source = ActiveObjects::instance().activeDataSource();
+  auto image = vtkImageData::SafeDownCast(source->dataObject());
+  auto scalars = image ? image->GetPointData()->GetScalars() : nullptr;
+  if (!scalars || scalars->GetNumberOfComponents() != 1 ||
+      WebBrickExport::typedArray(scalars->GetDataType()).isEmpty()) {
+    QMessageBox::warning(
+      m_mainWindow, "Web export",
+      "Only single component scalars of up to 32 bit integers, floats or "
+      "doubles can be exported as bricks.");
+    return;
+  }
+
+  // Proxies are read here, the worker only touches the data.
+  QJsonObject metadata;
+  metadata["name"] = scalars->GetName();
+  double range[2];
+  scalars->GetRange(range);
+  metadata["range"] = QJsonArray({ range[0], range[1] });
+  auto points = [](vtkSMProxy* proxy, const char* name) {
+    QJsonArray jPoints;
+    if (proxy) {
+      vtkSMPropertyHelper helper(proxy, name);
+      foreach (double value, helper.GetDoubleArray()) {
+        jPoints.append(value);
+      }
+    }
+    return jPoints;
+  };
+  metadata["colorMap"] = points(source->colorMap(), "RGBPoints");
+  metadata["opacityMap"] = points(source->opacityMap(), "Points");
+
+  const QString bricksDirectory = WebBrickExport::bricksDirectory(fileName);
+  auto writer = new BackgroundWriter(
+    fileName, image,
+    [bricksDirectory, metadata](const QString& manifestFileName,
+                                vtkImageData* data,
+                                const BackgroundWriter::Progress& progress) {
+      return WebBrickExport::write(manifestFileName, bricksDirectory, data,
+                                   metadata, progress);
+    });
+
+  const QString name = QFileInfo(fileName).fileName();
+  auto dialog = new QProgressDialog(QString("Exporting %1").arg(name),
+                                    "Cancel", 0, 100, m_mainWindow);
+  dialog->setWindowTitle("Web export");
+  dialog->setAttribute(Qt::WA_DeleteOnClose);
+  dialog->setAutoClose(false);
+  dialog->setAutoReset(false);
+  dialog->setMinimumDuration(500);
+  dialog->setValue(0);
+  connect(dialog, &QProgressDialog::canceled, writer,
+          &BackgroundWriter::cancel);
+  connect(writer, &BackgroundWriter::progressChanged, dialog,
+          &QProgressDialog::setValue);
+  QPointer<QProgressDialog> progress(dialog);
+  connect(writer, &BackgroundWriter::finished, writer,
+          [writer, progress, fileName](bool success) {
+            if (progress) {
+              progress->close();
+            }
+            if (!success && !writer->isCanceled()) {
+              qCritical() << "Failed to export" << fileName;
+            }
+            writer->deleteLater();
+          });
+  writer->start();
+}
+
 void SaveWebReaction::saveWeb(QMap<QString, QVariant> kwargsMap)
 {
   Python::initialize();
@@ -22,6 +22,10 @@ public:
   /// Save the file
   void saveWeb(QMap<QString, QVariant> kwargs);
 
+  /// Save the active data source as compressed bricks described by the
+  /// manifest fileName, in the background, see WebBrickExport.
+  void saveBricks(const QString& fileName);
+
 protected:
   /// Called when the data changes to enable/disable the menu item
   void updateEnableState() override;
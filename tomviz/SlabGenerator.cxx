@@ -0,0 +1,254 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "SlabGenerator.h"
+
+#include "ParallelFor.h"
+
+#include <vtkDoubleArray.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cstring>
+#include <list>
+#include <mutex>
+
+namespace tomviz {
+
+namespace {
+
+// Slices in the preview of a volume with as many or more.
+const int PreviewSlices = 32;
+
+// Bytes of values aimed for in a slab.
+const int64_t SlabBytes = 16 * 1024 * 1024;
+
+struct CachedSlab
+{
+  QString key;
+  int begin;
+  int end;
+  vtkSmartPointer<vtkDoubleArray> values;
+};
+
+// The cached slabs, most recently used first.
+std::mutex cacheMutex;
+std::list<CachedSlab> cache;
+size_t cacheBytes = 0;
+size_t maximumCacheBytes = 1024 * 1024 * 1024;
+
+size_t bytes(const CachedSlab& slab)
+{
+  return static_cast<size_t>(slab.values->GetNumberOfValues()) *
+         sizeof(double);
+}
+
+// Evict slabs until the cache fits, cacheMutex must be locked.
+void evict()
+{
+  while (cacheBytes > maximumCacheBytes && !cache.empty()) {
+    cacheBytes -= bytes(cache.back());
+    cache.pop_back();
+  }
+}
+
+bool findSlab(const QString& key, int begin, int end, double* values,
+              vtkIdType count)
+{
+  std::lock_guard<std::mutex> lock(cacheMutex);
+  for (auto it = cache.begin(); it != cache.end(); ++it) {
+    if (it->begin == begin && it->end == end && it->key == key) {
+      std::memcpy(values, it->values->GetPointer(0), count * sizeof(double));
+      cache.splice(cache.begin(), cache, it);
+      return true;
+    }
+  }
+  return false;
+}
+
+void insertSlab(const QString& key, int begin, int end, const double* values,
+                vtkIdType count)
+{
+  if (static_cast<size_t>(count) * sizeof(double) > maximumCacheBytes) {
+    return;
+  }
+  CachedSlab slab = { key, begin, end, vtkSmartPointer<vtkDoubleArray>::New() };
+  slab.values->SetNumberOfValues(count);
+  std::memcpy(slab.values->GetPointer(0), values, count * sizeof(double));
+
+  std::lock_guard<std::mutex> lock(cacheMutex);
+  cache.push_front(slab);
+  cacheBytes += bytes(slab);
+  evict();
+}
+} // namespace
+
+SlabGenerator::SlabGenerator(const int shape[3], const QString& key,
+                             const Generate& generate, bool slabs,
+                             QObject* parent)
+  : QObject(parent), m_key(key), m_generate(generate), m_slabs(slabs),
+    m_canceled(false), m_slicesDone(0)
+{
+  std::copy(shape, shape + 3, m_shape);
+  connect(&m_watcher, &QFutureWatcherBase::finished, this,
+          [this]() { emit finished(m_watcher.result() != nullptr); });
+}
+
+SlabGenerator::~SlabGenerator()
+{
+  if (isRunning()) {
+    cancel();
+    m_watcher.waitForFinished();
+  }
+}
+
+vtkSmartPointer<vtkImageData> SlabGenerator::preview()
+{
+  if (!m_slabs) {
+    auto image = newImage(1);
+    image->GetPointData()->GetScalars()->Fill(0);
+    return image;
+  }
+
+  const int step = previewStep(m_shape[2]);
+  const int slices = (m_shape[2] - 1) / step + 1;
+  auto image = newImage(slices);
+  image->SetSpacing(1, 1, step);
+  auto values = static_cast<double*>(image->GetScalarPointer());
+  const int64_t sliceSize = static_cast<int64_t>(m_shape[0]) * m_shape[1];
+  std::atomic<bool> failed(false);
+  parallelFor(0, slices, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end && !failed; ++i) {
+      const int slice = static_cast<int>(i) * step;
+      if (!generateSlab(slice, slice + 1, values + i * sliceSize)) {
+        failed = true;
+      }
+    }
+  });
+  return failed ? nullptr : image;
+}
+
+void SlabGenerator::start()
+{
+  m_canceled = false;
+  m_slicesDone = 0;
+  m_watcher.setFuture(QtConcurrent::run([this]() { return run(); }));
+}
+
+void SlabGenerator::cancel()
+{
+  m_canceled = true;
+}
+
+bool SlabGenerator::isRunning() const
+{
+  return m_watcher.isRunning();
+}
+
+vtkSmartPointer<vtkImageData> SlabGenerator::result()
+{
+  m_watcher.waitForFinished();
+  if (m_watcher.future().resultCount() == 0) {
+    return nullptr;
+  }
+  return m_watcher.result();
+}
+
+int SlabGenerator::previewStep(int slices)
+{
+  return std::max(slices / PreviewSlices, 1);
+}
+
+int SlabGenerator::slabSize(const int shape[3])
+{
+  const int64_t sliceBytes =
+    static_cast<int64_t>(shape[0]) * shape[1] * sizeof(double);
+  const int64_t threads = parallelThreadCount();
+  const int64_t perThread = (shape[2] + threads - 1) / threads;
+  const int64_t size = std::max<int64_t>(SlabBytes / sliceBytes, 1);
+  return static_cast<int>(std::max<int64_t>(std::min(size, perThread), 1));
+}
+
+void SlabGenerator::setMaximumCacheSize(size_t bytes)
+{
+  std::lock_guard<std::mutex> lock(cacheMutex);
+  maximumCacheBytes = bytes;
+  evict();
+}
+
+size_t SlabGenerator::cacheSize()
+{
+  std::lock_guard<std::mutex> lock(cacheMutex);
+  return cacheBytes;
+}
+
+void SlabGenerator::clearCache()
+{
+  std::lock_guard<std::mutex> lock(cacheMutex);
+  cache.clear();
+  cacheBytes = 0;
+}
+
+vtkSmartPointer<vtkImageData> SlabGenerator::newImage(int slices) const
+{
+  auto image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(m_shape[0], m_shape[1], slices);
+  vtkNew<vtkDoubleArray> scalars;
+  scalars->SetName("generated_scalars");
+  scalars->SetNumberOfValues(static_cast<vtkIdType>(m_shape[0]) * m_shape[1] *
+                             slices);
+  image->GetPointData()->SetScalars(scalars.GetPointer());
+  return image;
+}
+
+bool SlabGenerator::generateSlab(int begin, int end, double* values)
+{
+  const vtkIdType count =
+    static_cast<vtkIdType>(m_shape[0]) * m_shape[1] * (end - begin);
+  if (m_key.isEmpty()) {
+    return m_generate(begin, end, values);
+  }
+  if (findSlab(m_key, begin, end, values, count)) {
+    return true;
+  }
+  if (!m_generate(begin, end, values)) {
+    return false;
+  }
+  insertSlab(m_key, begin, end, values, count);
+  return true;
+}
+
+vtkSmartPointer<vtkImageData> SlabGenerator::run()
+{
+  auto image = newImage(m_shape[2]);
+  auto values = static_cast<double*>(image->GetScalarPointer());
+  const int64_t sliceSize = static_cast<int64_t>(m_shape[0]) * m_shape[1];
+  const int size = m_slabs ? slabSize(m_shape) : m_shape[2];
+  const int slabs = (m_shape[2] + size - 1) / size;
+  std::atomic<bool> failed(false);
+  parallelFor(0, slabs, 1, [&](int64_t first, int64_t last) {
+    for (int64_t i = first; i < last && !failed && !m_canceled; ++i) {
+      const int begin = static_cast<int>(i) * size;
+      const int end = std::min(begin + size, m_shape[2]);
+      if (!generateSlab(begin, end, values + begin * sliceSize)) {
+        failed = true;
+        return;
+      }
+      // Only the slab crossing a percentage reports it.
+      const int done = m_slicesDone += end - begin;
+      const int percent = static_cast<int>(100LL * done / m_shape[2]);
+      if (percent > 100LL * (done - (end - begin)) / m_shape[2]) {
+        emit progressChanged(percent);
+      }
+    }
+  });
+  if (failed || m_canceled) {
+    return nullptr;
+  }
+  return image;
+}
+} // namespace tomviz
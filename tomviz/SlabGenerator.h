@@ -0,0 +1,108 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizSlabGenerator_h
+#define tomvizSlabGenerator_h
+
+#include <QObject>
+
+#include <QFutureWatcher>
+#include <QString>
+
+#include <vtkSmartPointer.h>
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+
+class vtkImageData;
+
+namespace tomviz {
+
+/// Generates the values of a volume of doubles a slab of z slices at a time,
+/// on worker threads, for data sources that compute their data rather than
+/// read it. A preview made of every previewStep() slice is generated first,
+/// so there is something to show at once, then the full volume fills in in
+/// the background.
+///
+/// Slabs are cached by the key of the generator, which must identify the
+/// parameters the volume is generated with, so generating a volume again,
+/// or after a canceled run, only generates the slabs that are not cached.
+/// Generators with an empty key, whose output is not determined by their
+/// parameters, are not cached. The cache is shared by all generators and
+/// bounded in size, the least recently used slabs are evicted first.
+class SlabGenerator : public QObject
+{
+  Q_OBJECT
+
+public:
+  /// Fills values with the slices [begin, end) of the volume, x fastest,
+  /// returning false on failure. It is called from several worker threads
+  /// at once, so it must not touch proxies or widgets.
+  using Generate = std::function<bool(int begin, int end, double* values)>;
+
+  /// A generator of a volume of shape. Unless slabs is set the volume can
+  /// only be generated whole, generate is called once for all slices and
+  /// the preview is empty.
+  SlabGenerator(const int shape[3], const QString& key,
+                const Generate& generate, bool slabs = true,
+                QObject* parent = nullptr);
+  ~SlabGenerator() override;
+
+  /// The preview, every previewStep() slice generated on the calling thread
+  /// and its workers, with its spacing along z set so it covers the extent
+  /// of the volume. Generators without slabs return a single slice of
+  /// zeros. Returns nullptr if generation failed.
+  vtkSmartPointer<vtkImageData> preview();
+
+  /// Start generating the volume, returning immediately.
+  void start();
+
+  /// Stop generating, slabs done so far stay cached.
+  void cancel();
+  bool isCanceled() const { return m_canceled; }
+  bool isRunning() const;
+
+  /// Wait for the volume, returning it, or nullptr if it failed or was
+  /// canceled.
+  vtkSmartPointer<vtkImageData> result();
+
+  /// Distance between the slices of the preview of a volume of slices.
+  static int previewStep(int slices);
+
+  /// Slices per slab of a volume of shape, a few megabytes of values each,
+  /// but enough slabs to keep every thread busy.
+  static int slabSize(const int shape[3]);
+
+  /// Set the maximum memory held by cached slabs in bytes, slabs are
+  /// evicted until the cache fits.
+  static void setMaximumCacheSize(size_t bytes);
+  static size_t cacheSize();
+  static void clearCache();
+
+signals:
+  /// Percentage of the slices of the volume generated.
+  void progressChanged(int percent);
+
+  /// Emitted once the volume is generated, or generation failed or was
+  /// canceled.
+  void finished(bool success);
+
+private:
+  vtkSmartPointer<vtkImageData> newImage(int slices) const;
+  bool generateSlab(int begin, int end, double* values);
+  vtkSmartPointer<vtkImageData> run();
+
+  int m_shape[3];
+  QString m_key;
+  Generate m_generate;
+  bool m_slabs;
+  std::atomic<bool> m_canceled;
+  std::atomic<int> m_slicesDone;
+  QFutureWatcher<vtkSmartPointer<vtkImageData>> m_watcher;
+
+  Q_DISABLE_COPY(SlabGenerator)
+};
+} // namespace tomviz
+
+#endif
@@ -0,0 +1,636 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "StateBundle.h"
+
+#include "BackgroundWriter.h"
+#include "DataSource.h"
+#include "HistogramManager.h"
+#include "NpyFormat.h"
+#include "Operator.h"
+#include "ParallelFor.h"
+#include "Pipeline.h"
+
+#include <vtkDataArray.h>
+#include <vtkFieldData.h>
+#include <vtkFloatArray.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkSmartPointer.h>
+#include <vtkTable.h>
+#include <vtkTypeInt8Array.h>
+#include <vtkUnsignedLongLongArray.h>
+
+#include <QCryptographicHash>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QSet>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <vector>
+
+namespace tomviz {
+
+namespace StateBundle {
+
+namespace {
+
+const char resultKey[] = "cachedResult";
+
+template <typename T>
+QJsonArray toJson(const T* values, int size)
+{
+  QJsonArray array;
+  for (int i = 0; i < size; ++i) {
+    array.append(values[i]);
+  }
+  return array;
+}
+
+QJsonObject histogramToJson(vtkTable* histogram)
+{
+  QJsonObject json;
+  auto extents = vtkDataArray::SafeDownCast(histogram->GetColumn(0));
+  auto populations = vtkDataArray::SafeDownCast(histogram->GetColumn(1));
+  if (!extents || !populations) {
+    return json;
+  }
+  QJsonArray jExtents;
+  QJsonArray jPopulations;
+  for (vtkIdType i = 0; i < extents->GetNumberOfTuples(); ++i) {
+    jExtents.append(extents->GetTuple1(i));
+    jPopulations.append(populations->GetTuple1(i));
+  }
+  json["extents"] = jExtents;
+  json["populations"] = jPopulations;
+  return json;
+}
+
+vtkSmartPointer<vtkTable> histogramFromJson(const QJsonObject& json)
+{
+  auto jExtents = json["extents"].toArray();
+  auto jPopulations = json["populations"].toArray();
+  if (jExtents.isEmpty() || jExtents.size() != jPopulations.size()) {
+    return nullptr;
+  }
+  vtkNew<vtkFloatArray> extents;
+  extents->SetName("image_extents");
+  extents->SetNumberOfTuples(jExtents.size());
+  vtkNew<vtkUnsignedLongLongArray> populations;
+  populations->SetName("image_pops");
+  populations->SetNumberOfTuples(jPopulations.size());
+  for (int i = 0; i < jExtents.size(); ++i) {
+    extents->SetValue(i, jExtents[i].toDouble());
+    populations->SetValue(i, static_cast<unsigned long long>(
+                               jPopulations[i].toDouble()));
+  }
+  auto histogram = vtkSmartPointer<vtkTable>::New();
+  histogram->AddColumn(extents);
+  histogram->AddColumn(populations);
+  return histogram;
+}
+
+// The point arrays of image stored in a result.
+std::vector<vtkDataArray*> resultArrays(vtkImageData* image)
+{
+  std::vector<vtkDataArray*> arrays;
+  vtkPointData* pointData = image->GetPointData();
+  for (int i = 0; i < pointData->GetNumberOfArrays(); ++i) {
+    if (vtkDataArray* array = pointData->GetArray(i)) {
+      arrays.push_back(array);
+    }
+  }
+  return arrays;
+}
+
+// Describe the point arrays of image, with its geometry, in result. The file
+// names of the arrays are added once the result is hashed.
+bool describeResult(vtkImageData* image, QJsonObject& result)
+{
+  auto arrays = resultArrays(image);
+  if (arrays.empty()) {
+    return false;
+  }
+  vtkDataArray* scalars = image->GetPointData()->GetScalars();
+  QJsonArray jArrays;
+  for (vtkDataArray* array : arrays) {
+    if (array->GetNumberOfComponents() != 1) {
+      return false;
+    }
+    QJsonObject jArray;
+    jArray["name"] = QString(array->GetName() ? array->GetName() : "");
+    if (array == scalars) {
+      result["scalars"] = jArrays.size();
+      auto histogram = HistogramManager::instance().cachedHistogram(array);
+      if (histogram) {
+        result["histogram"] = histogramToJson(histogram);
+      }
+    }
+    jArrays.append(jArray);
+  }
+  result["arrays"] = jArrays;
+  result["extent"] = toJson(image->GetExtent(), 6);
+  result["origin"] = toJson(image->GetOrigin(), 3);
+  result["spacing"] = toJson(image->GetSpacing(), 3);
+
+  vtkFieldData* fieldData = image->GetFieldData();
+  if (auto type = fieldData->GetArray("tomviz_data_source_type")) {
+    result["type"] = static_cast<int>(type->GetTuple1(0));
+  }
+  if (DataSource::hasTiltAngles(image)) {
+    auto angles = DataSource::getTiltAngles(image);
+    result["tiltAngles"] = toJson(angles.data(), angles.size());
+  }
+  return true;
+}
+
+vtkSmartPointer<vtkImageData> readResult(const QJsonObject& result)
+{
+  auto jExtent = result["extent"].toArray();
+  auto jOrigin = result["origin"].toArray();
+  auto jSpacing = result["spacing"].toArray();
+  if (jExtent.size() != 6 || jOrigin.size() != 3 || jSpacing.size() != 3) {
+    return nullptr;
+  }
+  auto image = vtkSmartPointer<vtkImageData>::New();
+  int extent[6];
+  for (int i = 0; i < 6; ++i) {
+    extent[i] = jExtent[i].toInt();
+  }
+  image->SetExtent(extent);
+  image->SetOrigin(jOrigin[0].toDouble(), jOrigin[1].toDouble(),
+                   jOrigin[2].toDouble());
+  image->SetSpacing(jSpacing[0].toDouble(), jSpacing[1].toDouble(),
+                    jSpacing[2].toDouble());
+
+  NpyFormat npy;
+  vtkPointData* pointData = image->GetPointData();
+  auto jArrays = result["arrays"].toArray();
+  for (int i = 0; i < jArrays.size(); ++i) {
+    auto jArray = jArrays[i].toObject();
+    vtkNew<vtkImageData> arrayImage;
+    if (!npy.read(jArray["fileName"].toString(), arrayImage)) {
+      return nullptr;
+    }
+    vtkDataArray* array = arrayImage->GetPointData()->GetScalars();
+    if (array->GetNumberOfTuples() != image->GetNumberOfPoints()) {
+      return nullptr;
+    }
+    const QString name = jArray["name"].toString();
+    array->SetName(name.isEmpty() ? nullptr : name.toUtf8().data());
+    pointData->AddArray(array);
+    if (i == result["scalars"].toInt()) {
+      pointData->SetScalars(array);
+    }
+  }
+  if (!pointData->GetScalars() && pointData->GetNumberOfArrays() > 0) {
+    pointData->SetScalars(pointData->GetArray(0));
+  }
+
+  if (result.contains("type")) {
+    vtkNew<vtkTypeInt8Array> type;
+    type->SetName("tomviz_data_source_type");
+    type->SetNumberOfTuples(1);
+    type->SetTuple1(0, result["type"].toInt());
+    image->GetFieldData()->AddArray(type);
+  }
+  if (result.contains("tiltAngles")) {
+    QVector<double> angles;
+    foreach (const QJsonValue& angle, result["tiltAngles"].toArray()) {
+      angles.append(angle.toDouble());
+    }
+    DataSource::setTiltAngles(image, angles);
+  }
+  return image;
+}
+
+// Calls func with each result recorded in the state of a data source.
+template <typename Func>
+void forEachResult(QJsonObject& state, Func func)
+{
+  auto jOperators = state["operators"].toArray();
+  for (int i = 0; i < jOperators.size(); ++i) {
+    auto jOperator = jOperators[i].toObject();
+    if (jOperator.contains(resultKey)) {
+      auto result = jOperator[resultKey].toObject();
+      func(result);
+      jOperator[resultKey] = result;
+    }
+    auto jChildren = jOperator["dataSources"].toArray();
+    for (int j = 0; j < jChildren.size(); ++j) {
+      auto jChild = jChildren[j].toObject();
+      forEachResult(jChild, func);
+      jChildren[j] = jChild;
+    }
+    if (!jChildren.isEmpty()) {
+      jOperator["dataSources"] = jChildren;
+    }
+    jOperators[i] = jOperator;
+  }
+  if (!jOperators.isEmpty()) {
+    state["operators"] = jOperators;
+  }
+}
+} // namespace
+
+QDir resultsDir(const QString& stateFileName)
+{
+  QFileInfo info(stateFileName);
+  return QDir(
+    info.absoluteDir().filePath(info.completeBaseName() + ".results"));
+}
+
+QString contentHash(vtkImageData* image)
+{
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+  int dims[3];
+  image->GetDimensions(dims);
+  hash.addData(reinterpret_cast<const char*>(dims), sizeof(dims));
+
+  vtkPointData* pointData = image->GetPointData();
+  const int64_t blockSize = int64_t(64) << 20;
+  for (int i = 0; i < pointData->GetNumberOfArrays(); ++i) {
+    vtkDataArray* array = pointData->GetArray(i);
+    if (!array) {
+      continue;
+    }
+    hash.addData(QString("%1 %2 %3")
+                   .arg(array->GetName() ? array->GetName() : "")
+                   .arg(array->GetDataType())
+                   .arg(array->GetNumberOfComponents())
+                   .toUtf8());
+
+    // Blocks are hashed in parallel, their digests in order.
+    const int64_t bytes =
+      static_cast<int64_t>(array->GetNumberOfValues()) *
+      array->GetDataTypeSize();
+    const int64_t blocks = (bytes + blockSize - 1) / blockSize;
+    auto values = static_cast<const char*>(array->GetVoidPointer(0));
+    std::vector<QByteArray> digests(blocks);
+    parallelFor(0, blocks, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t block = begin; block < end; ++block) {
+        const int64_t size = std::min(blockSize, bytes - block * blockSize);
+        digests[block] = QCryptographicHash::hash(
+          QByteArray::fromRawData(values + block * blockSize,
+                                  static_cast<int>(size)),
+          QCryptographicHash::Sha1);
+      }
+    });
+    for (const auto& digest : digests) {
+      hash.addData(digest);
+    }
+  }
+  return QString(hash.result().toHex());
+}
+
+QString inputHash(const QString& dataHash, const QJsonArray& operators)
+{
+  // The child data sources and results are not part of the input.
+  QJsonArray state;
+  foreach (const QJsonValue& value, operators) {
+    auto jOperator = value.toObject();
+    jOperator.remove("dataSources");
+    jOperator.remove(resultKey);
+    state.append(jOperator);
+  }
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+  hash.addData(dataHash.toLatin1());
+  hash.addData(QJsonDocument(state).toJson(QJsonDocument::Compact));
+  return QString(hash.result().toHex());
+}
+
+void removeUnusedResults(const QJsonObject& state, const QDir& resultsDir)
+{
+  QSet<QString> used;
+  foreach (const QJsonValue& value, state["dataSources"].toArray()) {
+    auto jDataSource = value.toObject();
+    forEachResult(jDataSource, [&used](QJsonObject& result) {
+      foreach (const QJsonValue& jArray, result["arrays"].toArray()) {
+        used.insert(
+          QFileInfo(jArray.toObject()["fileName"].toString()).fileName());
+      }
+    });
+  }
+  foreach (const QString& fileName, resultsDir.entryList(QDir::Files)) {
+    if (!used.contains(fileName)) {
+      resultsDir.remove(fileName);
+    }
+  }
+}
+
+void absoluteResultPaths(QJsonObject& state, const QDir& stateDir)
+{
+  forEachResult(state, [&stateDir](QJsonObject& result) {
+    auto jArrays = result["arrays"].toArray();
+    for (int i = 0; i < jArrays.size(); ++i) {
+      auto jArray = jArrays[i].toObject();
+      jArray["fileName"] = QDir::cleanPath(
+        stateDir.absoluteFilePath(jArray["fileName"].toString()));
+      jArrays[i] = jArray;
+    }
+    result["arrays"] = jArrays;
+  });
+}
+
+QString restoreResult(DataSource* source, const QJsonObject& state)
+{
+  auto operators = source->operators();
+  auto jOperators = state["operators"].toArray();
+  if (operators.isEmpty() || operators.size() != jOperators.size()) {
+    return QString();
+  }
+  auto jLast = jOperators.last().toObject();
+  auto result = jLast[resultKey].toObject();
+  if (result.isEmpty()) {
+    return QString();
+  }
+  foreach (Operator* op, operators) {
+    if (op != operators.last() && op->hasChildDataSource()) {
+      return QString();
+    }
+  }
+
+  QString dataHash;
+  if (state.contains("resultOf")) {
+    dataHash = state["resultOf"].toString();
+  } else if (auto image = vtkImageData::SafeDownCast(source->dataObject())) {
+    dataHash = contentHash(image);
+  }
+  if (dataHash.isEmpty()) {
+    return QString();
+  }
+  const QString hash = inputHash(dataHash, jOperators);
+  if (hash != result["inputHash"].toString()) {
+    return QString();
+  }
+  auto image = readResult(result);
+  if (!image) {
+    return QString();
+  }
+
+  foreach (Operator* op, operators) {
+    op->setComplete();
+    emit op->transformingDone(TransformResult::Complete);
+  }
+  Operator* lastOp = operators.last();
+  if (lastOp->hasChildDataSource()) {
+    auto jChildren = jLast["dataSources"].toArray();
+    const QString label = jChildren.isEmpty()
+                            ? lastOp->label()
+                            : jChildren[0].toObject()["label"].toString();
+    lastOp->restoreChildDataSource(label, image);
+  } else {
+    source->pipeline()->branchFinished(source, image);
+  }
+  if (result.contains("histogram")) {
+    auto histogram = histogramFromJson(result["histogram"].toObject());
+    auto scalars = image->GetPointData()->GetScalars();
+    if (histogram && scalars) {
+      HistogramManager::instance().setHistogram(scalars, histogram);
+    }
+  }
+  return hash;
+}
+
+ResultsWriter::ResultsWriter(const QDir& stateDir, const QDir& resultsDir,
+                             QObject* parent)
+  : QObject(parent), m_stateDir(stateDir), m_resultsDir(resultsDir),
+    m_canceled(false)
+{
+  connect(&m_hashWatcher, &QFutureWatcherBase::finished, this,
+          &ResultsWriter::hashingFinished);
+}
+
+ResultsWriter::~ResultsWriter()
+{
+  // The writers, children of this, cancel and wait for themselves.
+  m_canceled = true;
+  m_hashWatcher.waitForFinished();
+}
+
+void ResultsWriter::addResults(DataSource* source, const QJsonObject& state,
+                               int index)
+{
+  auto image = vtkImageData::SafeDownCast(source->dataObject());
+  if (!image) {
+    return;
+  }
+  Pipeline pipeline;
+  pipeline.index = index;
+  if (!gather(source, state, pipeline.results)) {
+    return;
+  }
+  pipeline.input = vtkSmartPointer<vtkImageData>::New();
+  pipeline.input->ShallowCopy(image);
+  m_pipelines.push_back(pipeline);
+}
+
+bool ResultsWriter::gather(DataSource* source, const QJsonObject& state,
+                           std::vector<Result>& results)
+{
+  auto operators = source->operators();
+  auto jOperators = state["operators"].toArray();
+  if (operators.isEmpty() || operators.size() != jOperators.size() ||
+      source->pipeline()->isRunning()) {
+    return false;
+  }
+  // Only the child of the last operator is restored with the state.
+  foreach (Operator* op, operators) {
+    if (op->state() != OperatorState::Complete || op->numberOfResults() > 0 ||
+        (op != operators.last() && op->childDataSource())) {
+      return false;
+    }
+  }
+  DataSource* child = operators.last()->childDataSource();
+  auto image =
+    child ? vtkImageData::SafeDownCast(child->dataObject()) : nullptr;
+  if (!image) {
+    return false;
+  }
+
+  // Data sources and operators replace arrays rather than writing into them,
+  // a snapshot sharing them stays as it is now, see BackgroundWriter.
+  Result result;
+  result.operators = jOperators;
+  result.image = vtkSmartPointer<vtkImageData>::New();
+  result.image->ShallowCopy(image);
+  if (!describeResult(result.image, result.description)) {
+    return false;
+  }
+  results.push_back(result);
+
+  // A branch starts from this result.
+  auto jChildren = jOperators.last().toObject()["dataSources"].toArray();
+  if (!jChildren.isEmpty()) {
+    gather(child, jChildren[0].toObject(), results);
+  }
+  return true;
+}
+
+void ResultsWriter::start()
+{
+  m_canceled = false;
+  // Hashing reads all of the root data, it is done on a worker thread too.
+  m_hashWatcher.setFuture(QtConcurrent::run([this]() {
+    for (auto& pipeline : m_pipelines) {
+      if (m_canceled) {
+        return;
+      }
+      QString hash = contentHash(pipeline.input);
+      for (auto& result : pipeline.results) {
+        hash = inputHash(hash, result.operators);
+        result.inputHash = hash;
+      }
+    }
+  }));
+}
+
+void ResultsWriter::cancel()
+{
+  m_canceled = true;
+  foreach (BackgroundWriter* writer, m_writers) {
+    writer->cancel();
+  }
+}
+
+void ResultsWriter::hashingFinished()
+{
+  if (m_canceled) {
+    finish();
+    return;
+  }
+
+  auto write = [](const QString& fileName, vtkImageData* data,
+                  const BackgroundWriter::Progress& progress) {
+    NpyFormat npy;
+    return npy.write(fileName, data, progress);
+  };
+  for (auto& pipeline : m_pipelines) {
+    for (auto& result : pipeline.results) {
+      int dims[3];
+      result.image->GetDimensions(dims);
+      auto arrays = resultArrays(result.image);
+      auto jArrays = result.description["arrays"].toArray();
+      for (size_t i = 0; i < arrays.size(); ++i) {
+        // Results are named by the input hash, a file already there holds
+        // the same result, so it is kept, it may well be mapped by the data
+        // loaded from it.
+        const QString fileName = m_resultsDir.filePath(
+          QString("%1-%2.npy").arg(result.inputHash).arg(i));
+        auto jArray = jArrays[static_cast<int>(i)].toObject();
+        jArray["fileName"] = m_stateDir.relativeFilePath(fileName);
+        jArrays[static_cast<int>(i)] = jArray;
+        if (QFile::exists(fileName)) {
+          continue;
+        }
+
+        vtkNew<vtkImageData> arrayImage;
+        arrayImage->SetDimensions(dims);
+        arrayImage->GetPointData()->SetScalars(arrays[i]);
+        auto writer = new BackgroundWriter(fileName, arrayImage, write, this);
+        const int index = m_writers.size();
+        connect(writer, &BackgroundWriter::progressChanged, this,
+                [this, index](int percent) {
+                  m_percents[index] = percent;
+                  updateProgress();
+                });
+        connect(writer, &BackgroundWriter::finished, this,
+                &ResultsWriter::writerFinished);
+        result.writers.append(writer);
+        m_writers.append(writer);
+      }
+      result.description["arrays"] = jArrays;
+    }
+  }
+
+  m_percents.assign(m_writers.size(), 0);
+  m_pending = m_writers.size();
+  if (m_pending == 0) {
+    finish();
+    return;
+  }
+  foreach (BackgroundWriter* writer, m_writers) {
+    writer->start();
+  }
+}
+
+void ResultsWriter::writerFinished()
+{
+  if (--m_pending == 0) {
+    finish();
+  }
+}
+
+void ResultsWriter::updateProgress()
+{
+  qint64 total = 0;
+  double written = 0.0;
+  for (int i = 0; i < m_writers.size(); ++i) {
+    total += m_writers[i]->size();
+    written += m_writers[i]->size() * m_percents[i] / 100.0;
+  }
+  if (total > 0) {
+    emit progressChanged(static_cast<int>(100 * written / total));
+  }
+}
+
+void ResultsWriter::finish()
+{
+  bool success = !m_canceled;
+  for (auto& pipeline : m_pipelines) {
+    for (auto& result : pipeline.results) {
+      result.written =
+        !m_canceled &&
+        std::all_of(result.writers.begin(), result.writers.end(),
+                    [](BackgroundWriter* writer) { return writer->wait(); });
+      success = success && result.written;
+      // Release the arrays of the snapshots.
+      result.image = nullptr;
+    }
+    pipeline.input = nullptr;
+  }
+  emit finished(success);
+}
+
+void ResultsWriter::record(QJsonObject& state) const
+{
+  auto jDataSources = state["dataSources"].toArray();
+  for (const auto& pipeline : m_pipelines) {
+    if (pipeline.index >= jDataSources.size()) {
+      continue;
+    }
+    auto jDataSource = jDataSources[pipeline.index].toObject();
+    recordResult(jDataSource, pipeline.results, 0);
+    jDataSources[pipeline.index] = jDataSource;
+  }
+  state["dataSources"] = jDataSources;
+}
+
+void ResultsWriter::recordResult(QJsonObject& state,
+                                 const std::vector<Result>& results, size_t i)
+{
+  // A branch is only restored from the result of its parent.
+  if (i >= results.size() || !results[i].written) {
+    return;
+  }
+  auto jOperators = state["operators"].toArray();
+  auto jLast = jOperators.last().toObject();
+  auto result = results[i].description;
+  result["inputHash"] = results[i].inputHash;
+  jLast[resultKey] = result;
+
+  auto jChildren = jLast["dataSources"].toArray();
+  if (!jChildren.isEmpty()) {
+    auto jChild = jChildren[0].toObject();
+    recordResult(jChild, results, i + 1);
+    jChildren[0] = jChild;
+    jLast["dataSources"] = jChildren;
+  }
+  jOperators[jOperators.size() - 1] = jLast;
+  state["operators"] = jOperators;
+}
+} // namespace StateBundle
+} // namespace tomviz
@@ -0,0 +1,156 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizStateBundle_h
+#define tomvizStateBundle_h
+
+#include <QObject>
+
+#include <QDir>
+#include <QFutureWatcher>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+
+#include <vtkSmartPointer.h>
+
+#include <atomic>
+#include <vector>
+
+class vtkImageData;
+
+namespace tomviz {
+
+class BackgroundWriter;
+class DataSource;
+
+/// A state file saved with the results of its pipelines, so loading it does
+/// not run the operators again. The results are .npy files, one per point
+/// array, in a directory next to the state file and are memory mapped when
+/// loaded, so only the pages in use are read. They are not compressed: a
+/// compressed file has to be read, and inflated, in full before any of it is
+/// used, which is the wait the results are there to save. They are written a
+/// slab of slices at a time, in the background, see ResultsWriter.
+///
+/// The last operator of a data source records its result, along with the
+/// hash of the input of the operators: the hash of the data they start from
+/// and of their state. A root data source starts from the data read from its
+/// files, hashed when the state is loaded, a branch from the result of its
+/// parent, identified by the input hash of its parent. The result is used
+/// only if the hash recorded matches the one of the state being loaded, so
+/// changed files or operators run the pipeline as before.
+namespace StateBundle {
+
+/// The directory holding the results of a state file.
+QDir resultsDir(const QString& stateFileName);
+
+/// Hash of the dimensions and point arrays of an image, hex encoded. Blocks
+/// of the arrays are hashed in parallel.
+QString contentHash(vtkImageData* image);
+
+/// Hash of the input of operators, from the hash of the data they start from
+/// and their serialized state, hex encoded.
+QString inputHash(const QString& dataHash, const QJsonArray& operators);
+
+/// Stores the results of pipelines with a state. The results are gathered
+/// from the data sources on the GUI thread, then hashed and written in the
+/// background, each array by a BackgroundWriter, and recorded in the state
+/// once written. A result whose files could not be written is left out, its
+/// pipeline runs again when the state is loaded.
+class ResultsWriter : public QObject
+{
+  Q_OBJECT
+
+public:
+  /// Results are written to resultsDir, with paths relative to stateDir.
+  ResultsWriter(const QDir& stateDir, const QDir& resultsDir,
+                QObject* parent = nullptr);
+  ~ResultsWriter() override;
+
+  /// Gather the result of the operators of source, and those of the branches
+  /// it produces, for state, the serialized source, found at index in the
+  /// data sources of the state. Pipelines that are running, produce operator
+  /// results or have multi component arrays are left to run again.
+  void addResults(DataSource* source, const QJsonObject& state, int index);
+
+  /// Start hashing and writing the results, returning immediately.
+  /// finished() is emitted once they are all done, from the event loop.
+  void start();
+
+  bool isCanceled() const { return m_canceled; }
+
+  /// Record the results written in state, the serialized application state.
+  void record(QJsonObject& state) const;
+
+public slots:
+  /// Stop the writes, none of the results is recorded.
+  void cancel();
+
+signals:
+  /// Percent of the bytes of the results written so far.
+  void progressChanged(int percent);
+
+  /// Emitted once the results are written, success is false if any of them
+  /// failed or the writes were canceled.
+  void finished(bool success);
+
+private slots:
+  void hashingFinished();
+  void writerFinished();
+
+private:
+  // The result of the operators of one data source, the first of a pipeline
+  // starts from its root data, the others from the result before them.
+  struct Result
+  {
+    QJsonArray operators;
+    vtkSmartPointer<vtkImageData> image;
+    QJsonObject description;
+    QString inputHash;
+    QList<BackgroundWriter*> writers;
+    bool written = false;
+  };
+
+  struct Pipeline
+  {
+    int index;
+    vtkSmartPointer<vtkImageData> input;
+    std::vector<Result> results;
+  };
+
+  bool gather(DataSource* source, const QJsonObject& state,
+              std::vector<Result>& results);
+  void updateProgress();
+  void finish();
+  static void recordResult(QJsonObject& state,
+                           const std::vector<Result>& results, size_t i);
+
+  QDir m_stateDir;
+  QDir m_resultsDir;
+  std::vector<Pipeline> m_pipelines;
+  QList<BackgroundWriter*> m_writers;
+  std::vector<int> m_percents;
+  QFutureWatcher<void> m_hashWatcher;
+  std::atomic<bool> m_canceled;
+  int m_pending = 0;
+
+  Q_DISABLE_COPY(ResultsWriter)
+};
+
+/// Remove the files of resultsDir no data source of the state refers to.
+void removeUnusedResults(const QJsonObject& state, const QDir& resultsDir);
+
+/// Make the paths of the results recorded in state, the serialized data
+/// source, absolute.
+void absoluteResultPaths(QJsonObject& state, const QDir& stateDir);
+
+/// Restore the result recorded in state for the operators of source, in
+/// place of running them. A branch gets the input hash of its parent as
+/// "resultOf" in its state, empty if its parent was not restored. Returns
+/// the input hash of the operators, empty if they must run.
+QString restoreResult(DataSource* source, const QJsonObject& state);
+} // namespace StateBundle
+} // namespace tomviz
+
+#endif
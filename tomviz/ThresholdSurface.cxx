@@ -0,0 +1,287 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "ThresholdSurface.h"
+
+#include <vtkCellArray.h>
+#include <vtkDataArray.h>
+#include <vtkFloatArray.h>
+#include <vtkIdList.h>
+#include <vtkIdTypeArray.h>
+#include <vtkImageData.h>
+#include <vtkMultiBlockDataSet.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+
+namespace {
+
+template <typename T>
+void extract(vtkDataArray* scalars, const int dims[3], const double range[2],
+             int zBegin, int zEnd, tomviz::detail::SurfacePatch& patch)
+{
+  tomviz::detail::extractBoundary(
+    static_cast<const T*>(scalars->GetVoidPointer(0)),
+    scalars->GetNumberOfComponents(), dims, range[0], range[1], zBegin, zEnd,
+    patch);
+}
+
+template <typename T>
+void histogram(vtkDataArray* scalars, const int dims[3], int zBegin, int zEnd,
+               const double range[2], std::vector<int64_t>& bins)
+{
+  tomviz::detail::planeHistogram(
+    static_cast<const T*>(scalars->GetVoidPointer(0)),
+    scalars->GetNumberOfComponents(), dims, zBegin, zEnd, range[0], range[1],
+    bins);
+}
+
+// Convert a patch to poly data, with the points in physical coordinates and
+// the scalars of the grid points they came from.
+vtkSmartPointer<vtkPolyData> toPolyData(const tomviz::detail::SurfacePatch& p,
+                                        vtkImageData* image,
+                                        vtkDataArray* scalars)
+{
+  auto polyData = vtkSmartPointer<vtkPolyData>::New();
+  const vtkIdType nPoints = static_cast<vtkIdType>(p.points.size());
+  const vtkIdType nQuads = static_cast<vtkIdType>(p.quads.size() / 4);
+  if (nQuads == 0) {
+    return polyData;
+  }
+
+  int dims[3];
+  int extent[6];
+  double origin[3];
+  double spacing[3];
+  image->GetDimensions(dims);
+  image->GetExtent(extent);
+  image->GetOrigin(origin);
+  image->GetSpacing(spacing);
+  const int64_t pointsPerPlane = static_cast<int64_t>(dims[0]) * dims[1];
+
+  vtkNew<vtkFloatArray> coordinates;
+  coordinates->SetNumberOfComponents(3);
+  coordinates->SetNumberOfTuples(nPoints);
+  float* xyz = coordinates->GetPointer(0);
+  vtkNew<vtkIdList> ids;
+  ids->SetNumberOfIds(nPoints);
+  for (vtkIdType i = 0; i < nPoints; ++i) {
+    const int64_t id = p.points[i];
+    const int64_t ijk[3] = { id % dims[0], id % pointsPerPlane / dims[0],
+                             id / pointsPerPlane };
+    for (int j = 0; j < 3; ++j) {
+      xyz[3 * i + j] = static_cast<float>(
+        origin[j] + spacing[j] * (ijk[j] + extent[2 * j]));
+    }
+    ids->SetId(i, static_cast<vtkIdType>(id));
+  }
+  vtkNew<vtkPoints> points;
+  points->SetData(coordinates.GetPointer());
+  polyData->SetPoints(points.GetPointer());
+
+  vtkSmartPointer<vtkDataArray> values;
+  values.TakeReference(scalars->NewInstance());
+  values->SetName(scalars->GetName());
+  values->SetNumberOfComponents(scalars->GetNumberOfComponents());
+  scalars->GetTuples(ids.GetPointer(), values);
+  polyData->GetPointData()->SetScalars(values);
+
+  vtkNew<vtkIdTypeArray> connectivity;
+  connectivity->SetNumberOfValues(nQuads * 5);
+  vtkIdType* cell = connectivity->GetPointer(0);
+  for (vtkIdType q = 0; q < nQuads; ++q) {
+    *cell++ = 4;
+    for (int j = 0; j < 4; ++j) {
+      *cell++ = p.quads[4 * q + j];
+    }
+  }
+  vtkNew<vtkCellArray> polys;
+  polys->SetCells(nQuads, connectivity.GetPointer());
+  polyData->SetPolys(polys.GetPointer());
+  return polyData;
+}
+} // namespace
+
+namespace tomviz {
+
+ThresholdSurface::ThresholdSurface() = default;
+
+ThresholdSurface::~ThresholdSurface() = default;
+
+void ThresholdSurface::setInput(vtkImageData* image,
+                                const std::string& arrayName,
+                                std::shared_ptr<const BrickRangeIndex> index)
+{
+  m_image = image;
+  m_arrayName = arrayName;
+  m_index = index;
+  invalidate();
+}
+
+void ThresholdSurface::setIndex(std::shared_ptr<const BrickRangeIndex> index)
+{
+  m_index = index;
+}
+
+void ThresholdSurface::invalidate()
+{
+  m_invalid = true;
+}
+
+void ThresholdSurface::setRange(double minimum, double maximum)
+{
+  m_range[0] = minimum;
+  m_range[1] = maximum;
+}
+
+vtkMultiBlockDataSet* ThresholdSurface::output() const
+{
+  return m_output.GetPointer();
+}
+
+bool ThresholdSurface::affected(const Slab& slab) const
+{
+  if (slab.dirty) {
+    return true;
+  }
+  if (m_range[0] == m_extractedRange[0] && m_range[1] == m_extractedRange[1]) {
+    return false;
+  }
+
+  // Only values between the old and the new lower bound, or the old and the
+  // new upper bound, can change their selection.
+  const double width = m_scalarRange[1] - m_scalarRange[0];
+  const double scale = width > 0.0 ? HistogramBins / width : 0.0;
+  auto binOf = [&](double value) {
+    const int bin = static_cast<int>((value - m_scalarRange[0]) * scale);
+    return std::min(std::max(bin, 0), HistogramBins - 1);
+  };
+  for (int bound = 0; bound < 2; ++bound) {
+    const double a = std::min(m_range[bound], m_extractedRange[bound]);
+    const double b = std::max(m_range[bound], m_extractedRange[bound]);
+    if (a == b || b < m_scalarRange[0] || a > m_scalarRange[1]) {
+      continue;
+    }
+    for (int bin = binOf(a); bin <= binOf(b); ++bin) {
+      if (slab.histogram[bin]) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+int ThresholdSurface::update()
+{
+  vtkDataArray* scalars =
+    m_image ? m_image->GetPointData()->GetArray(m_arrayName.c_str()) : nullptr;
+  if (!scalars) {
+    m_slabs.clear();
+    m_output->SetNumberOfBlocks(0);
+    return 0;
+  }
+
+  int dims[3];
+  m_image->GetDimensions(dims);
+  if (m_invalid) {
+    scalars->GetRange(m_scalarRange, 0);
+    const int layers = std::max(dims[2] - 1, 1);
+    const int nSlabs = (layers + SlabSize - 1) / SlabSize;
+    m_slabs.assign(nSlabs, Slab());
+    for (int s = 0; s < nSlabs; ++s) {
+      Slab& slab = m_slabs[s];
+      slab.zBegin = s * SlabSize;
+      slab.zEnd = std::min(slab.zBegin + SlabSize, layers);
+      slab.histogram.resize(HistogramBins);
+    }
+    // The cells of a slab read the point planes of its layers and those of
+    // the halo layer on each side.
+    parallelFor(0, nSlabs, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t s = begin; s < end; ++s) {
+        Slab& slab = m_slabs[s];
+        const int zBegin = std::max(slab.zBegin - 1, 0);
+        const int zEnd = std::min(slab.zEnd + 2, dims[2]);
+        switch (scalars->GetDataType()) {
+          vtkTemplateMacro(histogram<VTK_TT>(scalars, dims, zBegin, zEnd,
+                                             m_scalarRange, slab.histogram));
+        }
+      }
+    });
+    m_output->SetNumberOfBlocks(nSlabs);
+    m_invalid = false;
+  }
+
+  std::vector<int> slabs;
+  for (int s = 0; s < static_cast<int>(m_slabs.size()); ++s) {
+    if (affected(m_slabs[s])) {
+      slabs.push_back(s);
+    }
+  }
+
+  const bool indexed = m_index && m_index->dimensions()[0] == dims[0] &&
+                       m_index->dimensions()[1] == dims[1] &&
+                       m_index->dimensions()[2] == dims[2];
+  std::vector<detail::SurfacePatch> patches(slabs.size());
+  parallelFor(0, static_cast<int64_t>(slabs.size()), 1,
+              [&](int64_t begin, int64_t end) {
+                for (int64_t i = begin; i < end; ++i) {
+                  // Slab s is brick layer s, without a brick in range none
+                  // of its cells is selected.
+                  if (indexed &&
+                      !m_index->layerInRange(slabs[i], m_range[0],
+                                             m_range[1])) {
+                    continue;
+                  }
+                  const Slab& slab = m_slabs[slabs[i]];
+                  switch (scalars->GetDataType()) {
+                    vtkTemplateMacro(extract<VTK_TT>(scalars, dims, m_range,
+                                                     slab.zBegin, slab.zEnd,
+                                                     patches[i]));
+                  }
+                }
+              });
+
+  for (size_t i = 0; i < slabs.size(); ++i) {
+    Slab& slab = m_slabs[slabs[i]];
+    slab.surface = toPolyData(patches[i], m_image, scalars);
+    slab.selectedCells = patches[i].selectedCells;
+    slab.dirty = false;
+    m_output->SetBlock(slabs[i], slab.surface);
+    patches[i].clear();
+  }
+  if (!slabs.empty()) {
+    m_output->Modified();
+  }
+  m_extractedRange[0] = m_range[0];
+  m_extractedRange[1] = m_range[1];
+  return static_cast<int>(slabs.size());
+}
+
+vtkIdType ThresholdSurface::numberOfFaces() const
+{
+  vtkIdType faces = 0;
+  for (const auto& slab : m_slabs) {
+    faces += slab.surface ? slab.surface->GetNumberOfPolys() : 0;
+  }
+  return faces;
+}
+
+vtkIdType ThresholdSurface::numberOfSelectedCells() const
+{
+  vtkIdType cells = 0;
+  for (const auto& slab : m_slabs) {
+    cells += slab.selectedCells;
+  }
+  return cells;
+}
+
+size_t ThresholdSurface::memorySize() const
+{
+  size_t size = 0;
+  for (const auto& slab : m_slabs) {
+    // GetActualMemorySize is in kibibytes.
+    size += slab.surface ? slab.surface->GetActualMemorySize() * 1024 : 0;
+  }
+  return size;
+}
+} // namespace tomviz
@@ -0,0 +1,286 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizThresholdSurface_h
+#define tomvizThresholdSurface_h
+
+#include "BrickRangeIndex.h"
+#include "ParallelFor.h"
+
+#include <vtkNew.h>
+#include <vtkSmartPointer.h>
+#include <vtkType.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class vtkImageData;
+class vtkMultiBlockDataSet;
+class vtkPolyData;
+
+namespace tomviz {
+
+namespace detail {
+
+/// Part of a threshold surface, quads index into points which holds grid
+/// point ids.
+struct SurfacePatch
+{
+  std::vector<int64_t> points;
+  std::vector<uint32_t> quads;
+  /// Number of cells selected in the patch, including interior ones.
+  int64_t selectedCells = 0;
+
+  void clear()
+  {
+    points.clear();
+    quads.clear();
+    selectedCells = 0;
+  }
+};
+
+/// Extract the boundary faces of the cells in layers [zBegin, zEnd) whose
+/// corner points all have a first component in [minimum, maximum], the cells
+/// vtkThreshold keeps with AllScalars on. Points are shared between the faces
+/// of the patch, two planes of point ids are kept while sweeping so memory
+/// stays proportional to the output. Images with a single slice produce one
+/// quad per selected pixel.
+template <typename T>
+void extractBoundary(const T* scalars, int nComps, const int dims[3],
+                     double minimum, double maximum, int zBegin, int zEnd,
+                     SurfacePatch& patch)
+{
+  patch.clear();
+  const int64_t nx = dims[0];
+  const int64_t ny = dims[1];
+  const int nz = dims[2];
+  if (nx < 2 || ny < 2 || nz < 1) {
+    return;
+  }
+  const int64_t cx = nx - 1;
+  const int64_t cy = ny - 1;
+  const int64_t cellsPerLayer = cx * cy;
+  const int64_t pointsPerPlane = nx * ny;
+  const int lastLayer = std::max(nz - 2, 0);
+
+  // q(i, j) of a point plane is set when the four corners of the cell face
+  // with lower corner (i, j) are in range.
+  std::vector<uint8_t> mask(pointsPerPlane);
+  auto faceMask = [&](int z, uint8_t* q) {
+    const T* plane = scalars + z * pointsPerPlane * nComps;
+    for (int64_t p = 0; p < pointsPerPlane; ++p) {
+      const double value = static_cast<double>(plane[p * nComps]);
+      mask[p] = value >= minimum && value <= maximum;
+    }
+    for (int64_t j = 0; j < cy; ++j) {
+      const uint8_t* row = &mask[j * nx];
+      const uint8_t* next = row + nx;
+      for (int64_t i = 0; i < cx; ++i) {
+        q[j * cx + i] = row[i] & row[i + 1] & next[i] & next[i + 1];
+      }
+    }
+  };
+
+  // Point ids of the patch for the two planes touched by a cell layer.
+  std::vector<int32_t> lower(pointsPerPlane, -1);
+  std::vector<int32_t> upper(pointsPerPlane, -1);
+  auto point = [&](int64_t i, int64_t j, int z, int plane) -> uint32_t {
+    int32_t& id = (plane ? upper : lower)[j * nx + i];
+    if (id < 0) {
+      id = static_cast<int32_t>(patch.points.size());
+      patch.points.push_back((z + plane) * pointsPerPlane + j * nx + i);
+    }
+    return static_cast<uint32_t>(id);
+  };
+  auto quad = [&](uint32_t a, uint32_t b, uint32_t c, uint32_t d) {
+    patch.quads.push_back(a);
+    patch.quads.push_back(b);
+    patch.quads.push_back(c);
+    patch.quads.push_back(d);
+  };
+
+  if (nz == 1) {
+    if (zBegin > 0) {
+      return;
+    }
+    std::vector<uint8_t> cells(cellsPerLayer);
+    faceMask(0, cells.data());
+    for (int64_t j = 0; j < cy; ++j) {
+      for (int64_t i = 0; i < cx; ++i) {
+        if (cells[j * cx + i]) {
+          ++patch.selectedCells;
+          quad(point(i, j, 0, 0), point(i + 1, j, 0, 0),
+               point(i + 1, j + 1, 0, 0), point(i, j + 1, 0, 0));
+        }
+      }
+    }
+    return;
+  }
+
+  zEnd = std::min(zEnd, lastLayer + 1);
+  if (zBegin >= zEnd) {
+    return;
+  }
+
+  // Cell masks of the layers [first, last], one layer of halo on each side
+  // of the slab so faces between slabs are decided consistently.
+  const int first = std::max(zBegin - 1, 0);
+  const int last = std::min(zEnd, lastLayer);
+  std::vector<uint8_t> cells((last - first + 1) * cellsPerLayer);
+  {
+    std::vector<uint8_t> below(cellsPerLayer);
+    std::vector<uint8_t> above(cellsPerLayer);
+    faceMask(first, below.data());
+    for (int z = first; z <= last; ++z) {
+      faceMask(z + 1, above.data());
+      uint8_t* layer = &cells[(z - first) * cellsPerLayer];
+      for (int64_t c = 0; c < cellsPerLayer; ++c) {
+        layer[c] = below[c] & above[c];
+      }
+      std::swap(below, above);
+    }
+  }
+  auto cell = [&](int64_t i, int64_t j, int z) -> bool {
+    return cells[(z - first) * cellsPerLayer + j * cx + i] != 0;
+  };
+
+  std::fill(upper.begin(), upper.end(), -1);
+  for (int z = zBegin; z < zEnd; ++z) {
+    // The upper plane of the previous layer is the lower plane of this one.
+    std::swap(lower, upper);
+    std::fill(upper.begin(), upper.end(), -1);
+    if (z == zBegin) {
+      std::fill(lower.begin(), lower.end(), -1);
+    }
+    for (int64_t j = 0; j < cy; ++j) {
+      for (int64_t i = 0; i < cx; ++i) {
+        if (!cell(i, j, z)) {
+          continue;
+        }
+        ++patch.selectedCells;
+        // Faces are wound counter clockwise seen from outside the cell.
+        if (i == 0 || !cell(i - 1, j, z)) {
+          quad(point(i, j, z, 0), point(i, j, z, 1), point(i, j + 1, z, 1),
+               point(i, j + 1, z, 0));
+        }
+        if (i == cx - 1 || !cell(i + 1, j, z)) {
+          quad(point(i + 1, j, z, 0), point(i + 1, j + 1, z, 0),
+               point(i + 1, j + 1, z, 1), point(i + 1, j, z, 1));
+        }
+        if (j == 0 || !cell(i, j - 1, z)) {
+          quad(point(i, j, z, 0), point(i + 1, j, z, 0),
+               point(i + 1, j, z, 1), point(i, j, z, 1));
+        }
+        if (j == cy - 1 || !cell(i, j + 1, z)) {
+          quad(point(i, j + 1, z, 0), point(i, j + 1, z, 1),
+               point(i + 1, j + 1, z, 1), point(i + 1, j + 1, z, 0));
+        }
+        if (z == 0 || !cell(i, j, z - 1)) {
+          quad(point(i, j, z, 0), point(i, j + 1, z, 0),
+               point(i + 1, j + 1, z, 0), point(i + 1, j, z, 0));
+        }
+        if (z == lastLayer || !cell(i, j, z + 1)) {
+          quad(point(i, j, z, 1), point(i + 1, j, z, 1),
+               point(i + 1, j + 1, z, 1), point(i, j + 1, z, 1));
+        }
+      }
+    }
+  }
+}
+
+/// Histogram of the first component of the point planes [zBegin, zEnd) over
+/// [minimum, maximum], used to find the slabs a change of range affects.
+template <typename T>
+void planeHistogram(const T* scalars, int nComps, const int dims[3],
+                    int zBegin, int zEnd, double minimum, double maximum,
+                    std::vector<int64_t>& histogram)
+{
+  const int bins = static_cast<int>(histogram.size());
+  std::fill(histogram.begin(), histogram.end(), 0);
+  const double scale = maximum > minimum ? bins / (maximum - minimum) : 0.0;
+  const int64_t pointsPerPlane = static_cast<int64_t>(dims[0]) * dims[1];
+  const T* first = scalars + zBegin * pointsPerPlane * nComps;
+  const T* last = scalars + zEnd * pointsPerPlane * nComps;
+  for (const T* p = first; p < last; p += nComps) {
+    const double value = static_cast<double>(*p);
+    if (std::isnan(value)) {
+      continue;
+    }
+    const int bin = static_cast<int>((value - minimum) * scale);
+    ++histogram[std::min(std::max(bin, 0), bins - 1)];
+  }
+}
+} // namespace detail
+
+/// Renders the cells of an image selected by a threshold as their boundary
+/// faces, instead of the unstructured grid of hexahedra the Threshold filter
+/// builds. The image is cut into slabs of SlabSize cell layers that are
+/// extracted in parallel into the blocks of a multiblock data set, and when
+/// the range changes only the slabs holding values between the old and new
+/// range bounds are extracted again. Slabs match the brick layers of a
+/// BrickRangeIndex, with an index slabs without a brick overlapping the range
+/// are known to be empty and are not scanned at all.
+class ThresholdSurface
+{
+public:
+  static const int SlabSize = 16;
+  static const int HistogramBins = 256;
+
+  ThresholdSurface();
+  ~ThresholdSurface();
+
+  /// Set the image and the point array to threshold, all slabs are extracted
+  /// on the next update. The index, if any, must be of the same array.
+  void setInput(vtkImageData* image, const std::string& arrayName,
+                std::shared_ptr<const BrickRangeIndex> index = nullptr);
+  /// Set the index of the input array once it is built, the slabs already
+  /// extracted are kept.
+  void setIndex(std::shared_ptr<const BrickRangeIndex> index);
+  void invalidate();
+
+  void setRange(double minimum, double maximum);
+  const double* range() const { return m_range; }
+
+  /// Extract the slabs affected by the changes since the last update. Returns
+  /// the number of slabs extracted.
+  int update();
+
+  vtkMultiBlockDataSet* output() const;
+
+  /// Number of faces in the output.
+  vtkIdType numberOfFaces() const;
+  /// Number of cells selected by the threshold.
+  vtkIdType numberOfSelectedCells() const;
+  /// Memory used by the output, in bytes.
+  size_t memorySize() const;
+
+private:
+  struct Slab
+  {
+    int zBegin = 0;
+    int zEnd = 0;
+    std::vector<int64_t> histogram;
+    vtkSmartPointer<vtkPolyData> surface;
+    int64_t selectedCells = 0;
+    bool dirty = true;
+  };
+
+  bool affected(const Slab& slab) const;
+
+  vtkSmartPointer<vtkImageData> m_image;
+  std::string m_arrayName;
+  std::shared_ptr<const BrickRangeIndex> m_index;
+  std::vector<Slab> m_slabs;
+  double m_range[2] = { 0.0, 0.0 };
+  double m_extractedRange[2] = { 0.0, 0.0 };
+  double m_scalarRange[2] = { 0.0, 0.0 };
+  bool m_invalid = true;
+  vtkNew<vtkMultiBlockDataSet> m_output;
+};
+} // namespace tomviz
+
+#endif
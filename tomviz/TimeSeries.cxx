@@ -0,0 +1,219 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "TimeSeries.h"
+
+#include "DataSource.h"
+#include "EmdFormat.h"
+#include "Operator.h"
+
+#include <pqAnimationManager.h>
+#include <pqAnimationScene.h>
+#include <pqPVApplicationCore.h>
+#include <vtkSMPropertyHelper.h>
+#include <vtkSMProxy.h>
+
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkPointData.h>
+
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+
+namespace tomviz {
+
+TimeSeriesFrameCache::TimeSeriesFrameCache(size_t maximumSize)
+  : MemoryCache(maximumSize)
+{
+}
+
+void TimeSeriesFrameCache::insert(int frame, vtkImageData* image)
+{
+  // GetActualMemorySize is in kibibytes.
+  MemoryCache::insert(
+    frame, image,
+    image ? static_cast<size_t>(image->GetActualMemorySize()) * 1024 : 0);
+}
+
+QList<TimeSeriesFrame> TimeSeries::emdFrames(const QStringList& fileNames)
+{
+  QList<TimeSeriesFrame> frames;
+  foreach (const QString& fileName, fileNames) {
+    EmdFormat emdFile;
+    for (const auto& node : emdFile.nodes(fileName.toLatin1().data())) {
+      frames.append({ fileName, QString::fromStdString(node) });
+    }
+  }
+  return frames;
+}
+
+vtkSmartPointer<vtkImageData> TimeSeries::readFrame(
+  const TimeSeriesFrame& frame)
+{
+  auto image = vtkSmartPointer<vtkImageData>::New();
+  EmdFormat emdFile;
+  if (!emdFile.read(frame.fileName.toLatin1().data(),
+                    frame.group.toLatin1().data(), image)) {
+    return nullptr;
+  }
+  return image;
+}
+
+TimeSeries::TimeSeries(const QList<TimeSeriesFrame>& frames,
+                       DataSource* dataSource)
+  : QObject(dataSource), m_frames(frames), m_dataSource(dataSource)
+{
+  connect(&m_watcher, &QFutureWatcherBase::finished, this,
+          &TimeSeries::onReadFinished);
+
+  m_cache.insert(0, vtkImageData::SafeDownCast(dataSource->dataObject()));
+  setupAnimationScene();
+  prefetch();
+}
+
+TimeSeries::~TimeSeries()
+{
+  // Reads only hold copies of their frame, but HDF5 should be done with the
+  // file before the application goes on to close it.
+  m_watcher.waitForFinished();
+}
+
+void TimeSeries::setupAnimationScene()
+{
+  auto scene =
+    pqPVApplicationCore::instance()->animationManager()->getActiveScene();
+  if (!scene) {
+    return;
+  }
+  // Make sure the scene has a frame for every frame of the series.
+  vtkSMPropertyHelper sceneFrames(scene->getProxy(), "NumberOfFrames");
+  if (sceneFrames.GetAsInt() < numberOfFrames()) {
+    sceneFrames.Set(numberOfFrames());
+    scene->getProxy()->UpdateVTKObjects();
+  }
+  connect(scene, &pqAnimationScene::animationTime, this,
+          &TimeSeries::onAnimationTimeChanged);
+}
+
+void TimeSeries::onAnimationTimeChanged(double time)
+{
+  auto scene = qobject_cast<pqAnimationScene*>(sender());
+  if (!scene || m_frames.size() < 2) {
+    return;
+  }
+  // The whole scene plays the whole series.
+  auto range = scene->getClockTimeRange();
+  const double length = range.second - range.first;
+  const double progress = length > 0.0 ? (time - range.first) / length : 0.0;
+  setCurrentFrame(
+    static_cast<int>(std::lround(progress * (m_frames.size() - 1))));
+}
+
+void TimeSeries::setCurrentFrame(int frame)
+{
+  if (m_frames.isEmpty()) {
+    return;
+  }
+  frame = std::max(std::min(frame, m_frames.size() - 1), 0);
+  if (frame != m_requestedFrame) {
+    // Looping back to the start keeps playing forwards.
+    const bool looped = frame == 0 && m_requestedFrame == m_frames.size() - 1;
+    m_lastStep = frame > m_requestedFrame || looped ? 1 : -1;
+    m_requestedFrame = frame;
+  }
+  updateFrame();
+}
+
+void TimeSeries::updateFrame()
+{
+  if (m_unreadableFrames.contains(m_requestedFrame)) {
+    m_requestedFrame = m_currentFrame;
+  }
+  if (m_requestedFrame == m_currentFrame) {
+    prefetch();
+    return;
+  }
+  if (auto image = m_cache.find(m_requestedFrame)) {
+    showFrame(m_requestedFrame, image);
+    prefetch();
+    return;
+  }
+  if (m_watcher.isRunning()) {
+    // Picked up when the running read finishes.
+    return;
+  }
+  startRead(m_requestedFrame);
+}
+
+void TimeSeries::startRead(int frame)
+{
+  const TimeSeriesFrame source = m_frames[frame];
+  m_watcher.setFuture(QtConcurrent::run([source, frame]() {
+    Read read;
+    read.frame = frame;
+    read.image = readFrame(source);
+    return read;
+  }));
+}
+
+void TimeSeries::onReadFinished()
+{
+  Read read = m_watcher.result();
+  if (read.image) {
+    m_cache.insert(read.frame, read.image);
+  } else {
+    qWarning("Failed to read frame %d of the time series.", read.frame);
+    m_unreadableFrames.insert(read.frame);
+  }
+  updateFrame();
+}
+
+void TimeSeries::prefetch()
+{
+  if (m_watcher.isRunning()) {
+    return;
+  }
+  const int count = m_frames.size();
+  for (int step = 1; step <= std::min(m_prefetchCount, count - 1); ++step) {
+    // Playback loops, so the frames wrap around.
+    const int frame =
+      ((m_currentFrame + m_lastStep * step) % count + count) % count;
+    if (!m_cache.contains(frame) && !m_unreadableFrames.contains(frame)) {
+      startRead(frame);
+      return;
+    }
+  }
+}
+
+void TimeSeries::showFrame(int frame, vtkImageData* image)
+{
+  if (!m_dataSource) {
+    return;
+  }
+  // The spacing and the active scalars set on the data source carry over to
+  // the frames of the series.
+  auto current = vtkImageData::SafeDownCast(m_dataSource->dataObject());
+  if (current && current != image) {
+    image->SetOrigin(current->GetOrigin());
+    image->SetSpacing(current->GetSpacing());
+    auto scalars = current->GetPointData()->GetScalars();
+    if (scalars && scalars->GetName() &&
+        image->GetPointData()->GetArray(scalars->GetName())) {
+      image->GetPointData()->SetActiveScalars(scalars->GetName());
+    }
+  }
+  m_currentFrame = frame;
+  // The type and the field data of the data source carry over as well, and
+  // the histograms and brick indexes of cached frames are kept.
+  m_dataSource->swapData(image);
+  // Operators transform the frame, so the pipeline runs again from the
+  // first one, canceling any run on the previous frame.
+  auto operators = m_dataSource->operators();
+  if (!operators.isEmpty()) {
+    emit operators.first()->transformModified();
+  }
+  emit currentFrameChanged(frame);
+}
+} // namespace tomviz
@@ -0,0 +1,119 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizTimeSeries_h
+#define tomvizTimeSeries_h
+
+#include <QObject>
+
+#include <QFutureWatcher>
+#include <QList>
+#include <QPointer>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+#include "MemoryCache.h"
+
+#include <vtkSmartPointer.h>
+
+class vtkImageData;
+
+namespace tomviz {
+
+class DataSource;
+
+/// A frame of a time series, the volume of an EMD file or, for files holding
+/// several volumes, of one of its EMD groups.
+struct TimeSeriesFrame
+{
+  QString fileName;
+  QString group;
+};
+
+/// Least recently used cache of time series frames keyed by frame index,
+/// bounded by the memory the frames hold.
+class TimeSeriesFrameCache : public MemoryCache<int, vtkImageData>
+{
+public:
+  explicit TimeSeriesFrameCache(size_t maximumSize = size_t(2) << 30);
+
+  /// Add a frame, replacing any frame with the same index. Frames larger than
+  /// the cache are not kept.
+  void insert(int frame, vtkImageData* image);
+};
+
+/// Volumes acquired over time shown as one data source. The data of the data
+/// source is the volume of the current frame, so modules follow the current
+/// frame as they follow any other change to the data, and the operators of
+/// the data source run again on each frame. Frames are read on a
+/// background thread into a frame cache, and the frames after the current
+/// one, in the direction of playback, are read ahead of time. The frame
+/// follows the time of the animation scene, so the VCR toolbar plays the
+/// series.
+class TimeSeries : public QObject
+{
+  Q_OBJECT
+
+public:
+  /// The frames of EMD files, one per EMD group holding a volume.
+  static QList<TimeSeriesFrame> emdFrames(const QStringList& fileNames);
+
+  /// Read the volume of a frame, nullptr if it can not be read.
+  static vtkSmartPointer<vtkImageData> readFrame(const TimeSeriesFrame& frame);
+
+  /// The data source should hold the volume of the first frame.
+  TimeSeries(const QList<TimeSeriesFrame>& frames, DataSource* dataSource);
+  ~TimeSeries() override;
+
+  const QList<TimeSeriesFrame>& frames() const { return m_frames; }
+  int numberOfFrames() const { return m_frames.size(); }
+
+  /// The frame whose volume the data source holds.
+  int currentFrame() const { return m_currentFrame; }
+
+  /// Number of frames read ahead of the current one.
+  void setPrefetchCount(int count) { m_prefetchCount = count; }
+  int prefetchCount() const { return m_prefetchCount; }
+
+  TimeSeriesFrameCache& frameCache() { return m_cache; }
+
+public slots:
+  /// Show a frame, right away if it is cached and once it is read otherwise.
+  /// Requests made while a frame is read are coalesced, so playback skips
+  /// the frames that can not be read in time.
+  void setCurrentFrame(int frame);
+
+signals:
+  void currentFrameChanged(int frame);
+
+private slots:
+  void onReadFinished();
+  void onAnimationTimeChanged(double time);
+
+private:
+  struct Read
+  {
+    int frame = -1;
+    vtkSmartPointer<vtkImageData> image;
+  };
+
+  void updateFrame();
+  void startRead(int frame);
+  void prefetch();
+  void showFrame(int frame, vtkImageData* image);
+  void setupAnimationScene();
+
+  QList<TimeSeriesFrame> m_frames;
+  QPointer<DataSource> m_dataSource;
+  TimeSeriesFrameCache m_cache;
+  QSet<int> m_unreadableFrames;
+  QFutureWatcher<Read> m_watcher;
+  int m_currentFrame = 0;
+  int m_requestedFrame = 0;
+  int m_lastStep = 1;
+  int m_prefetchCount = 3;
+};
+} // namespace tomviz
+
+#endif
@@ -81,8 +81,9 @@ void weightedBackProjection3(vtkImageData* tiltSeries, vtkImageData* recon)
 }
 
 // 2D WBP recon
-void unweightedBackProjection2(float* sinogram, double* tiltAngles,
-                               float* image, int numOfTilts, int numOfRays)
+void unweightedBackProjection2(const float* sinogram,
+                               const double* tiltAngles, float* image,
+                               int numOfTilts, int numOfRays)
 {
   for (int i = 0; i < numOfRays * numOfRays; ++i) {
     image[i] = 0; // Set all pixels to zero
@@ -26,9 +26,9 @@ void weightedBackProjection3(vtkImageData* tiltSeries,
 //
 // The output image will be stored in recon and will be square with size
 // numOfRays by numOfRays.
-void unweightedBackProjection2(float* sinogram, double* tiltAngles,
-                               float* recon, int numOfTilts,
-                               int numOfRays); // 2D WBP recon
+void unweightedBackProjection2(const float* sinogram,
+                               const double* tiltAngles, float* recon,
+                               int numOfTilts, int numOfRays); // 2D WBP recon
 } // namespace TomographyReconstruction
 } // namespace tomviz
 
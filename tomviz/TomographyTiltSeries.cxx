@@ -2,16 +2,26 @@
    It is released under the 3-Clause BSD License, see "LICENSE". */
 
 #include "TomographyTiltSeries.h"
+#include "DataSource.h"
+#include "ParallelFor.h"
+#include "RandomDistributions.h"
 #include "vtkDataArray.h"
 #include "vtkFieldData.h"
 #include "vtkImageData.h"
 #include <math.h>
 #define PI 3.14159265359
 #include "vtkFloatArray.h"
+#include "vtkNew.h"
 #include "vtkPointData.h"
 #include "vtkSmartPointer.h"
+#include "vtkTypeInt8Array.h"
 
 #include <QDebug>
+#include <QVector>
+
+#include <algorithm>
+#include <random>
+#include <vector>
 
 namespace {
 
@@ -39,6 +49,123 @@ vtkSmartPointer<vtkFloatArray> convertToFloat(vtkImageData* image)
   }
   return array;
 }
+
+template <typename T>
+void extractSinogram(const T* dataPtr, int xDim, int yDim, int zDim,
+                     int sliceNumber, float* sinogram)
+{
+  for (int t = 0; t < zDim; ++t) // Loop through tilts (z-direction)
+  {
+    for (int r = 0; r < yDim; ++r) // Loop through rays (y-direction)
+    {
+      sinogram[t * yDim + r] = static_cast<float>(
+        dataPtr[static_cast<vtkIdType>(t) * xDim * yDim + r * xDim +
+                sliceNumber]);
+    }
+  }
+}
+
+template <typename T>
+void interpolateSinogram(const T* dataPtr, int xDim, int yDim, int zDim,
+                         int sliceNumber, float* sinogram, int Nray,
+                         double axisPosition)
+{
+  double rayWidth = (double)yDim / (double)Nray;
+  std::vector<float> weight1(Nray); // Store weights for linear interpolation
+  std::vector<float> weight2(Nray); // Store weights for linear interpolation
+  std::vector<int> index1(Nray);    // Store indices for linear interpolation
+  std::vector<int> index2(Nray);    // Store indices for linear interpolation
+  for (int r = 0; r < Nray; ++r) {
+    double rayCoord = (double)(r - Nray / 2) * rayWidth + axisPosition;
+    index1[r] = floor(rayCoord) + yDim / 2;
+    index2[r] = index1[r] + 1;
+    weight2[r] = rayCoord - floor(rayCoord);
+    weight1[r] = 1 - weight2[r];
+  }
+
+  for (int z = 0; z < zDim; ++z) // Loop through tilts (z-direction)
+  {
+    const T* tilt = dataPtr + static_cast<vtkIdType>(z) * xDim * yDim;
+    for (int r = 0; r < Nray; ++r) // Loop through rays (y-direction)
+    {
+      float value = 0;
+      if (index1[r] >= 0 && index1[r] < yDim)
+        value += tilt[index1[r] * xDim + sliceNumber] * weight1[r];
+      if (index2[r] >= 0 && index2[r] < yDim)
+        value += tilt[index2[r] * xDim + sliceNumber] * weight2[r];
+      sinogram[z * Nray + r] = value;
+    }
+  }
+}
+// Add the sums along the rays of one tilt to projection, [x, rays]. Each ray
+// samples the y-z plane every voxel with bilinear interpolation, gathering a
+// whole row of x at a time so the volume is read contiguously.
+template <typename T>
+void projectTilt(const T* volume, const int dims[3], double angle, int rays,
+                 float* projection)
+{
+  const int xDim = dims[0];
+  const int yDim = dims[1];
+  const int zDim = dims[2];
+  const vtkIdType sliceSize = static_cast<vtkIdType>(xDim) * yDim;
+  const int samples =
+    static_cast<int>(ceil(sqrt(double(yDim) * yDim + double(zDim) * zDim)));
+  const double c = cos(angle * PI / 180);
+  const double s = sin(angle * PI / 180);
+
+  std::vector<double> sums(xDim);
+  for (int r = 0; r < rays; ++r) {
+    std::fill(sums.begin(), sums.end(), 0.0);
+    const double t = r + 0.5 - rays / 2.0;
+    for (int k = 0; k < samples; ++k) {
+      const double u = k + 0.5 - samples / 2.0;
+      // The point of the ray, as a fractional voxel index.
+      const double fy = t * c - u * s + yDim / 2.0 - 0.5;
+      const double fz = t * s + u * c + zDim / 2.0 - 0.5;
+      const int iy = static_cast<int>(floor(fy));
+      const int iz = static_cast<int>(floor(fz));
+      if (iy < -1 || iy >= yDim || iz < -1 || iz >= zDim) {
+        continue;
+      }
+      const double wy = fy - iy;
+      const double wz = fz - iz;
+      for (int dz = 0; dz < 2; ++dz) {
+        const int z = iz + dz;
+        if (z < 0 || z >= zDim) {
+          continue;
+        }
+        for (int dy = 0; dy < 2; ++dy) {
+          const int y = iy + dy;
+          if (y < 0 || y >= yDim) {
+            continue;
+          }
+          const double weight = (dy ? wy : 1 - wy) * (dz ? wz : 1 - wz);
+          const T* row =
+            volume + z * sliceSize + static_cast<vtkIdType>(y) * xDim;
+          for (int x = 0; x < xDim; ++x) {
+            sums[x] += weight * row[x];
+          }
+        }
+      }
+    }
+    for (int x = 0; x < xDim; ++x) {
+      projection[static_cast<vtkIdType>(r) * xDim + x] =
+        static_cast<float>(sums[x]);
+    }
+  }
+}
+
+template <typename T>
+void projectTilts(const T* volume, const int dims[3],
+                  const std::vector<double>& angles, int rays, float* output)
+{
+  const vtkIdType tiltSize = static_cast<vtkIdType>(dims[0]) * rays;
+  tomviz::parallelFor(0, angles.size(), 1, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      projectTilt(volume, dims, angles[i], rays, output + i * tiltSize);
+    }
+  });
+}
 } // end of namespace
 
 namespace tomviz {
@@ -53,19 +180,13 @@ void getSinogram(vtkImageData* tiltSeries, int sliceNumber, float* sinogram)
   int yDim = extents[3] - extents[2] + 1; // Number of rays
   int zDim = extents[5] - extents[4] + 1; // Number of tilts
 
-  // Convert tiltSeries type to float
-  vtkSmartPointer<vtkFloatArray> dataAsFloats = convertToFloat(tiltSeries);
-  float* dataPtr = static_cast<float*>(dataAsFloats->GetVoidPointer(
-    0)); // Get pointer to tilt series (of type float)
-
-  // Extract sinograms from tilt series. Make a deep copy
-  for (int t = 0; t < zDim; ++t) // Loop through tilts (z-direction)
-  {
-    for (int r = 0; r < yDim; ++r) // Loop through rays (y-direction)
-    {
-      sinogram[t * yDim + r] =
-        dataPtr[t * xDim * yDim + r * xDim + sliceNumber];
-    }
+  // Only the requested slice is read, converting each value to float as it is
+  // copied rather than converting the whole tilt series up front.
+  vtkDataArray* scalars = tiltSeries->GetPointData()->GetScalars();
+  switch (scalars->GetDataType()) {
+    vtkTemplateMacro(extractSinogram(
+      static_cast<VTK_TT*>(scalars->GetVoidPointer(0)), xDim, yDim, zDim,
+      sliceNumber, sinogram));
   }
 }
 
@@ -79,39 +200,11 @@ void getSinogram(vtkImageData* tiltSeries, int sliceNumber, float* sinogram,
   int yDim = extents[3] - extents[2] + 1; // number of rays in tilt series
   int zDim = extents[5] - extents[4] + 1; // number of tilts
 
-  // Convert tiltSeries type to float
-  vtkSmartPointer<vtkFloatArray> dataAsFloats = convertToFloat(tiltSeries);
-  float* dataPtr = static_cast<float*>(dataAsFloats->GetVoidPointer(
-    0)); // Get pointer to tilt series (of type float)
-
-  double rayWidth = (double)yDim / (double)Nray;
-  std::vector<float> weight1(Nray); // Store weights for linear interpolation
-  std::vector<float> weight2(Nray); // Store weights for linear interpolation
-  std::vector<int> index1(Nray);    // Store indices for linear interpolation
-  std::vector<int> index2(Nray);    // Store indices for linear interpolation
-
-  // Extract sinograms from tilt series. Make a deep copy
-  for (int z = 0; z < zDim; ++z) // Loop through tilts (z-direction)
-  {
-    for (int r = 0; r < Nray; ++r) // Loop through rays (y-direction)
-    {
-      if (z == 0) { // Initialize weights and indicies
-        double rayCoord = (double)(r - Nray / 2) * rayWidth + axisPosition;
-        index1[r] = floor(rayCoord) + yDim / 2;
-        index2[r] = index1[r] + 1;
-        weight1[r] = fabs(rayCoord - floor(rayCoord));
-        weight2[r] = 1 - weight1[r];
-      }
-      sinogram[z * Nray + r] = 0;
-      if (index1[r] >= 0 && index1[r] < yDim)
-        sinogram[z * Nray + r] +=
-          dataPtr[z * xDim * yDim + index1[r] * xDim + sliceNumber] *
-          weight1[r];
-      if (index2[r] >= 0 && index2[r] < yDim)
-        sinogram[z * Nray + r] +=
-          dataPtr[z * xDim * yDim + index2[r] * xDim + sliceNumber] *
-          weight2[r];
-    }
+  vtkDataArray* scalars = tiltSeries->GetPointData()->GetScalars();
+  switch (scalars->GetDataType()) {
+    vtkTemplateMacro(interpolateSinogram(
+      static_cast<VTK_TT*>(scalars->GetVoidPointer(0)), xDim, yDim, zDim,
+      sliceNumber, sinogram, Nray, axisPosition));
   }
 }
 
@@ -143,5 +236,75 @@ void averageTiltSeries(vtkImageData* tiltSeries, float* average)
   }
 }
 
+vtkSmartPointer<vtkImageData> simulateTiltSeries(
+  vtkImageData* volume, const std::vector<double>& angles, int rays)
+{
+  int dims[3];
+  volume->GetDimensions(dims);
+  if (rays <= 0) {
+    // The odd size enclosing the volume at every angle.
+    rays = static_cast<int>(
+      round(sqrt(double(dims[1]) * dims[1] + double(dims[2]) * dims[2])));
+    rays = rays / 2 * 2 + 1;
+  }
+
+  auto tiltSeries = vtkSmartPointer<vtkImageData>::New();
+  tiltSeries->SetDimensions(dims[0], rays, static_cast<int>(angles.size()));
+  tiltSeries->SetSpacing(volume->GetSpacing());
+  tiltSeries->AllocateScalars(VTK_FLOAT, 1);
+  auto output = static_cast<float*>(tiltSeries->GetScalarPointer());
+
+  vtkDataArray* scalars = volume->GetPointData()->GetScalars();
+  switch (scalars->GetDataType()) {
+    vtkTemplateMacro(projectTilts(
+      static_cast<VTK_TT*>(scalars->GetVoidPointer(0)), dims, angles, rays,
+      output));
+  }
+
+  vtkNew<vtkTypeInt8Array> type;
+  type->SetName("tomviz_data_source_type");
+  type->SetNumberOfTuples(1);
+  type->SetTuple1(0, DataSource::TiltSeries);
+  tiltSeries->GetFieldData()->AddArray(type);
+  DataSource::setTiltAngles(tiltSeries,
+                            QVector<double>::fromStdVector(angles));
+  return tiltSeries;
+}
+
+void addPoissonNoise(vtkImageData* tiltSeries, double counts,
+                     unsigned int seed)
+{
+  int dims[3];
+  tiltSeries->GetDimensions(dims);
+  const vtkIdType tiltSize = static_cast<vtkIdType>(dims[0]) * dims[1];
+  auto data = static_cast<float*>(tiltSeries->GetScalarPointer());
+
+  parallelFor(0, dims[2], 1, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      float* tilt = data + i * tiltSize;
+      double sum = 0;
+      for (vtkIdType j = 0; j < tiltSize; ++j) {
+        sum += tilt[j];
+      }
+      if (sum <= 0) {
+        continue;
+      }
+      // Every tilt has a generator of its own, seeded by its index.
+      std::seed_seq sequence{ seed, static_cast<unsigned int>(i) };
+      std::mt19937 generator(sequence);
+      const double scale = tiltSize * counts / sum;
+      for (vtkIdType j = 0; j < tiltSize; ++j) {
+        const double mean = tilt[j] * scale;
+        if (mean <= 0) {
+          tilt[j] = 0;
+          continue;
+        }
+        tilt[j] = static_cast<float>(
+          RandomDistributions::poisson(generator, mean) / scale);
+      }
+    }
+  });
+}
+
 } // end of namespace TomographyTiltSeries
 } // end of namespace tomviz
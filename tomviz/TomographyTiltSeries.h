@@ -6,6 +6,9 @@
 
 #include "pqReaction.h"
 #include "vtkImageData.h"
+#include "vtkSmartPointer.h"
+
+#include <vector>
 
 namespace tomviz {
 
@@ -28,8 +31,23 @@ void getSinogram(vtkImageData* tiltSeries, int, float* sinogram, int Nray,
 // void getSinogram(vtkImageData *tiltSeries, int, float* sinogram,  int Nray,
 // double axisPosition = 0, double axisAngle = 0);
 
-/// Generate tiltseries from a volume
-// void generaeTiltSeries(vtkImageData *volume, vtkImageData* tiltSeries);
+/// Generate a tilt series from a volume, the sums along parallel rays through
+/// the volume rotated about the x axis by each of the angles in degrees. The
+/// output has dimensions [x, rays, angles] of floats, with the tilt angles set
+/// and marked as a tilt series. Rays are one voxel apart, centered on the
+/// volume, and sample it with bilinear interpolation every voxel along their
+/// length, in the geometry the back projection reconstructs. If rays is 0 it
+/// is the odd number of rays covering the volume at every angle, as the
+/// Generate Tilt Series operator does.
+vtkSmartPointer<vtkImageData> simulateTiltSeries(
+  vtkImageData* volume, const std::vector<double>& angles, int rays = 0);
+
+/// Add Poisson noise to each tilt image of a float tilt series, as the Add
+/// Poisson Noise operator does: the image is scaled to counts per pixel on
+/// average, sampled and scaled back. The noise only depends on the seed, not
+/// on the number of threads adding it.
+void addPoissonNoise(vtkImageData* tiltSeries, double counts,
+                     unsigned int seed);
 
 void averageTiltSeries(vtkImageData* tiltSeries,
                        float* average); // Average all tilts
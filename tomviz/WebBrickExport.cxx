@@ -0,0 +1,310 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "WebBrickExport.h"
+
+#include "ParallelFor.h"
+#include "Resample.h"
+
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkPointData.h>
+
+#include <QByteArray>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSysInfo>
+#include <QTemporaryDir>
+
+#include <algorithm>
+#include <cstring>
+
+namespace tomviz {
+
+namespace WebBrickExport {
+
+namespace {
+
+int brickCount(int size)
+{
+  return (size + BrickSize - 1) / BrickSize;
+}
+
+// The values of a brick, x fastest.
+QByteArray extractBrick(const char* values, int valueSize, const int dims[3],
+                        int bx, int by, int bz)
+{
+  const int begin[3] = { bx * BrickSize, by * BrickSize, bz * BrickSize };
+  int size[3];
+  for (int i = 0; i < 3; ++i) {
+    size[i] = std::min(BrickSize, dims[i] - begin[i]);
+  }
+  const int64_t rowBytes = static_cast<int64_t>(size[0]) * valueSize;
+  QByteArray brick(static_cast<int>(rowBytes * size[1] * size[2]), 0);
+  char* out = brick.data();
+  for (int z = 0; z < size[2]; ++z) {
+    for (int y = 0; y < size[1]; ++y) {
+      const int64_t index =
+        (static_cast<int64_t>(begin[2] + z) * dims[1] + begin[1] + y) *
+          dims[0] +
+        begin[0];
+      std::memcpy(out, values + index * valueSize, rowBytes);
+      out += rowBytes;
+    }
+  }
+  return brick;
+}
+
+// Write the bricks of a level to file, recording their offset and size.
+// progress gets the fraction of the level written.
+bool writeLevel(const char* values, int valueSize, const int dims[3],
+                QFile& file, QJsonArray& bricks,
+                const std::function<bool(double)>& progress)
+{
+  const int nx = brickCount(dims[0]);
+  const int ny = brickCount(dims[1]);
+  const int nz = brickCount(dims[2]);
+  std::vector<QByteArray> layer(static_cast<size_t>(nx) * ny);
+  for (int bz = 0; bz < nz; ++bz) {
+    parallelFor(0, layer.size(), 1, [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; ++i) {
+        auto brick = extractBrick(values, valueSize, dims,
+                                  static_cast<int>(i % nx),
+                                  static_cast<int>(i / nx), bz);
+        // Drop the size qCompress puts in front, leaving a zlib stream.
+        layer[i] = qCompress(brick).mid(4);
+      }
+    });
+    for (auto& brick : layer) {
+      const qint64 offset = file.pos();
+      if (file.write(brick) != brick.size()) {
+        return false;
+      }
+      bricks.append(QJsonArray({ static_cast<double>(offset), brick.size() }));
+      brick.clear();
+    }
+    if (progress && !progress(static_cast<double>(bz + 1) / nz)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename T>
+bool binLevel(const char* values, const int dims[3], const int factors[3],
+              char* output)
+{
+  return Resample::bin(reinterpret_cast<const T*>(values), dims, 1, factors,
+                       reinterpret_cast<T*>(output));
+}
+} // namespace
+
+std::vector<std::array<int, 3>> levelDimensions(const int dims[3])
+{
+  std::vector<std::array<int, 3>> levels;
+  std::array<int, 3> level = { { dims[0], dims[1], dims[2] } };
+  levels.push_back(level);
+  while (level[0] > BrickSize || level[1] > BrickSize ||
+         level[2] > BrickSize) {
+    for (int i = 0; i < 3; ++i) {
+      level[i] = Resample::binnedSize(level[i], level[i] > 1 ? 2 : 1);
+    }
+    levels.push_back(level);
+  }
+  return levels;
+}
+
+QString bricksDirectory(const QString& manifestFileName)
+{
+  QFileInfo info(manifestFileName);
+  return info.dir().filePath(info.completeBaseName() + "_bricks");
+}
+
+QString typedArray(int vtkType)
+{
+  switch (vtkType) {
+    case VTK_CHAR:
+    case VTK_SIGNED_CHAR:
+      return "Int8Array";
+    case VTK_UNSIGNED_CHAR:
+      return "Uint8Array";
+    case VTK_SHORT:
+      return "Int16Array";
+    case VTK_UNSIGNED_SHORT:
+      return "Uint16Array";
+    case VTK_INT:
+      return "Int32Array";
+    case VTK_UNSIGNED_INT:
+      return "Uint32Array";
+    case VTK_FLOAT:
+      return "Float32Array";
+    case VTK_DOUBLE:
+      return "Float64Array";
+    default:
+      return QString();
+  }
+}
+
+bool write(const QString& manifestFileName, const QString& bricksDirectory,
+           vtkImageData* image, const QJsonObject& metadata,
+           const std::function<bool(double)>& progress)
+{
+  vtkDataArray* scalars = image->GetPointData()->GetScalars();
+  if (!scalars || scalars->GetNumberOfComponents() != 1 ||
+      typedArray(scalars->GetDataType()).isEmpty()) {
+    qCritical() << "Only single component scalars of up to 32 bit integers,"
+                << "floats or doubles can be exported as bricks.";
+    return false;
+  }
+
+  // The levels are written to a directory of their own next to the bricks
+  // of an earlier export, and swapped in once the export is complete. It is
+  // removed, with whatever it holds, when the export fails.
+  QFileInfo bricksInfo(bricksDirectory);
+  QTemporaryDir staging(QString("%1/.%2.XXXXXX")
+                          .arg(bricksInfo.absolutePath())
+                          .arg(bricksInfo.fileName()));
+  QDir dir(staging.path());
+  if (!staging.isValid() || !dir.mkdir("levels") || !dir.cd("levels")) {
+    qCritical() << "Unable to create a directory next to" << bricksDirectory;
+    return false;
+  }
+
+  int dims[3];
+  image->GetDimensions(dims);
+  double origin[3];
+  double spacing[3];
+  image->GetOrigin(origin);
+  image->GetSpacing(spacing);
+  const auto levels = levelDimensions(dims);
+  const int valueSize = scalars->GetDataTypeSize();
+
+  // Progress is shared by the levels as their number of voxels.
+  std::vector<double> voxels;
+  double total = 0;
+  for (auto& level : levels) {
+    voxels.push_back(static_cast<double>(level[0]) * level[1] * level[2]);
+    total += voxels.back();
+  }
+
+  // Levels are referred to where they end up.
+  const QDir manifestDir = QFileInfo(manifestFileName).dir();
+  const QDir bricksDir(bricksDirectory);
+  QJsonArray jLevels;
+  const char* values = static_cast<const char*>(scalars->GetVoidPointer(0));
+  std::vector<char> current;
+  std::vector<char> next;
+  double done = 0;
+  for (size_t i = 0; i < levels.size(); ++i) {
+    const int levelDims[3] = { levels[i][0], levels[i][1], levels[i][2] };
+    const QString fileName = QString("level%1.bin").arg(i);
+    QFile file(dir.filePath(fileName));
+    if (!file.open(QIODevice::WriteOnly)) {
+      qCritical() << "Unable to write" << file.fileName();
+      return false;
+    }
+
+    QJsonArray bricks;
+    auto levelProgress = [&](double fraction) {
+      return !progress || progress((done + fraction * voxels[i]) / total);
+    };
+    if (!writeLevel(values, valueSize, levelDims, file, bricks,
+                    levelProgress)) {
+      return false;
+    }
+    done += voxels[i];
+
+    QJsonObject jLevel;
+    jLevel["dimensions"] =
+      QJsonArray({ levelDims[0], levelDims[1], levelDims[2] });
+    jLevel["origin"] = QJsonArray({ origin[0], origin[1], origin[2] });
+    jLevel["spacing"] = QJsonArray({ spacing[0], spacing[1], spacing[2] });
+    jLevel["file"] = manifestDir.relativeFilePath(bricksDir.filePath(fileName));
+    jLevel["bricks"] = bricks;
+    jLevels.prepend(jLevel);
+
+    if (i + 1 == levels.size()) {
+      break;
+    }
+
+    // Bin the level into the next, moving the geometry so the voxels cover
+    // the same extent.
+    int factors[3];
+    for (int j = 0; j < 3; ++j) {
+      factors[j] = levelDims[j] > 1 ? 2 : 1;
+      origin[j] += 0.5 * (factors[j] - 1) * spacing[j];
+      spacing[j] *= factors[j];
+    }
+    next.resize(static_cast<size_t>(voxels[i + 1]) * valueSize);
+    switch (scalars->GetDataType()) {
+      vtkTemplateMacro(binLevel<VTK_TT>(values, levelDims, factors,
+                                        next.data()));
+    }
+    current.swap(next);
+    values = current.data();
+  }
+
+  QJsonObject manifest = metadata;
+  manifest["format"] = "tomviz-bricks";
+  manifest["version"] = 1;
+  manifest["dataType"] = typedArray(scalars->GetDataType());
+  manifest["littleEndian"] = QSysInfo::ByteOrder == QSysInfo::LittleEndian;
+  manifest["compression"] = "zlib";
+  manifest["brickSize"] = BrickSize;
+  manifest["levels"] = jLevels;
+
+  // The manifest is staged as well, it replaces an earlier one last.
+  const QString stagedManifest = staging.path() + "/manifest.json";
+  QFile file(stagedManifest);
+  if (!file.open(QIODevice::WriteOnly) ||
+      file.write(QJsonDocument(manifest).toJson()) < 0 || !file.flush()) {
+    qCritical() << "Unable to write" << manifestFileName;
+    return false;
+  }
+  file.close();
+
+  // The bricks and the manifest of an earlier export are moved into the
+  // staging directory, and removed with it. A step that fails puts back
+  // what the steps before it moved.
+  const QString previousBricks = staging.path() + "/previous";
+  const QString previousManifest = staging.path() + "/previous.json";
+  const bool replaceBricks = bricksInfo.exists();
+  const bool replaceManifest = QFileInfo::exists(manifestFileName);
+  if (replaceBricks && !QDir().rename(bricksDirectory, previousBricks)) {
+    qCritical() << "Unable to replace" << bricksDirectory;
+    return false;
+  }
+  auto restoreBricks = [&]() {
+    if (replaceBricks) {
+      QDir().rename(previousBricks, bricksDirectory);
+    }
+  };
+  if (!QDir().rename(dir.path(), bricksDirectory)) {
+    restoreBricks();
+    qCritical() << "Unable to replace" << bricksDirectory;
+    return false;
+  }
+  if (replaceManifest &&
+      !QFile::rename(manifestFileName, previousManifest)) {
+    QDir().rename(bricksDirectory, dir.path());
+    restoreBricks();
+    qCritical() << "Unable to replace" << manifestFileName;
+    return false;
+  }
+  if (!QFile::rename(stagedManifest, manifestFileName)) {
+    if (replaceManifest) {
+      QFile::rename(previousManifest, manifestFileName);
+    }
+    QDir().rename(bricksDirectory, dir.path());
+    restoreBricks();
+    qCritical() << "Unable to replace" << manifestFileName;
+    return false;
+  }
+  return true;
+}
+} // namespace WebBrickExport
+} // namespace tomviz
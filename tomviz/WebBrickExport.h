@@ -0,0 +1,59 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizWebBrickExport_h
+#define tomvizWebBrickExport_h
+
+#include <QJsonObject>
+#include <QString>
+
+#include <array>
+#include <functional>
+#include <vector>
+
+class vtkImageData;
+
+namespace tomviz {
+
+/// Web export of a volume as compressed bricks at several resolutions, so a
+/// viewer can show the coarsest level at once and stream the bricks of the
+/// finer levels as they are needed, rather than decoding the whole volume
+/// embedded in a page first.
+///
+/// The export is a JSON manifest and a directory of bricks next to it, one
+/// file per level. A brick holds the values of up to BrickSize^3 voxels, x
+/// fastest, as a zlib stream. The manifest lists the levels, coarsest first,
+/// with their dimensions, geometry and the offset and size of each of their
+/// bricks in the file of the level, x fastest, then y and z, so a viewer can
+/// fetch a brick with a range request.
+namespace WebBrickExport {
+
+const int BrickSize = 64;
+
+/// The dimensions of the levels of a volume of dims, the volume then the
+/// volume binned by two, again and again, until it fits a single brick.
+std::vector<std::array<int, 3>> levelDimensions(const int dims[3]);
+
+/// The directory of the bricks of the export to manifestFileName,
+/// "<name>_bricks" next to it.
+QString bricksDirectory(const QString& manifestFileName);
+
+/// The JavaScript typed array holding values of a VTK type, empty if there is
+/// none.
+QString typedArray(int vtkType);
+
+/// Write the active scalars of image, which must have one component, as
+/// bricks to bricksDirectory and the manifest, with the keys of metadata
+/// added, to manifestFileName. Bricks are extracted and compressed in
+/// parallel a layer of bricks at a time, progress is reported after each
+/// layer and the export stops, failing, when progress returns false. The
+/// levels and the manifest are written to a temporary directory next to
+/// bricksDirectory and replace the earlier ones only once the export
+/// succeeds, so a canceled or failed export leaves an earlier one as it was.
+bool write(const QString& manifestFileName, const QString& bricksDirectory,
+           vtkImageData* image, const QJsonObject& metadata,
+           const std::function<bool(double)>& progress = nullptr);
+} // namespace WebBrickExport
+} // namespace tomviz
+
+#endif
@@ -43,6 +43,7 @@ WebExportWidget::WebExportWidget(QWidget* p) : QDialog(p)
   m_exportType->addItem("Geometry: Current scene contour(s)");
   m_exportType->addItem("Geometry: Contour exploration");
   m_exportType->addItem("Geometry: Volume");
+  m_exportType->insertItem(BricksExportType, "Volume: Compressed bricks");
   // exportType->addItem("Composite surfaces"); // specularColor segfault
   m_exportType->setCurrentIndex(0);
   typeGroup->addWidget(outputTypelabel);
@@ -204,6 +205,8 @@ void WebExportWidget::onTypeChange(int index)
   m_volumeExplorationGroup->setVisible(index == 1);
   m_valuesGroup->setVisible(index == 1 || index == 2 || index == 4);
   m_volumeResampleGroup->setVisible(index == 5);
+  // Bricks are written next to their manifest, not bundled in a page.
+  m_keepData->setVisible(index != BricksExportType);
 }
 
 void WebExportWidget::onExport()
@@ -32,6 +32,10 @@ class WebExportWidget : public QDialog
 public:
   WebExportWidget(QWidget* parent = nullptr);
 
+  /// The exportType of the brick export, written natively rather than by the
+  /// tomviz.web module.
+  static const int BricksExportType = 6;
+
   QMap<QString, QVariant> getKeywordArguments();
 
 private slots:
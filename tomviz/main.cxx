@@ -13,11 +13,13 @@
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
 
+#include "BatchRender.h"
 #include "MainWindow.h"
 #include "tomvizConfig.h"
 #include "tomvizPythonConfig.h"
 
 #include <clocale>
+#include <iostream>
 
 int main(int argc, char** argv)
 {
@@ -30,6 +32,12 @@ int main(int argc, char** argv)
 
   tomviz::InitializePythonEnvironment(argc, argv);
 
+  // Batch renders run on nodes without a display, Qt needs none either.
+  const bool batch = tomviz::BatchRender::requested(argc, argv);
+  if (batch && qgetenv("QT_QPA_PLATFORM").isEmpty()) {
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+  }
+
   QApplication app(argc, argv);
 
 #if defined(__APPLE__)
@@ -49,6 +57,24 @@ int main(int argc, char** argv)
   qputenv("TOMVIZ_APPLICATION", "1");
 
   setlocale(LC_NUMERIC, "C");
+  if (batch) {
+    tomviz::BatchRender::Options options;
+    QString error;
+    if (!tomviz::BatchRender::parse(app.arguments(), options, error)) {
+      std::cerr << error.toStdString() << std::endl;
+      return 1;
+    }
+    // ParaView does not know the batch arguments, it only gets told to
+    // render offscreen, through OSMesa or EGL on nodes without a GPU.
+    char offscreen[] = "--force-offscreen-rendering";
+    char* pvArgv[] = { argv[0], offscreen, nullptr };
+    int pvArgc = 2;
+    pqPVApplicationCore appCore(pvArgc, pvArgv);
+    // The window is never shown, it holds the views the state is loaded in.
+    tomviz::MainWindow window;
+    window.setBatchMode(true);
+    return tomviz::BatchRender::run(options);
+  }
   pqPVApplicationCore appCore(argc, argv);
   tomviz::MainWindow window;
   window.show();
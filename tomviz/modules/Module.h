@@ -114,6 +114,13 @@ public:
   /// Returns the data to export for this visualization module.
   virtual vtkSmartPointer<vtkDataObject> getDataToExport();
 
+  /// Finish, on this thread, the work the module has left to background
+  /// threads, so the next render shows the module as it is now rather than
+  /// once their results are picked up by the event loop. Renders made
+  /// without running the event loop, such as those of batch rendering, call
+  /// it first.
+  virtual void flush() {}
+
   /// Returns the active scalars of the module
   int activeScalars() const { return m_activeScalars; }
   static const int DEFAULT_SCALARS;
@@ -5,23 +5,30 @@
 #include "ModuleContourWidget.h"
 
 #include "ActiveObjects.h"
+#include "BrickRangeIndex.h"
 #include "DataSource.h"
 #include "DoubleSliderWidget.h"
+#include "IsoSurface.h"
 #include "Operator.h"
 #include "Utilities.h"
 
 #include "pqApplicationCore.h"
 #include "pqColorChooserButton.h"
+#include "pqCoreUtilities.h"
 #include "pqPropertyLinks.h"
 #include "pqSignalAdaptors.h"
 #include "pqWidgetRangeDomain.h"
 
-#include "vtkAlgorithm.h"
+#include "vtkCommand.h"
 #include "vtkDataObject.h"
+#include "vtkImageData.h"
 #include "vtkNew.h"
 #include "vtkPVArrayInformation.h"
 #include "vtkPVDataInformation.h"
 #include "vtkPVDataSetAttributesInformation.h"
+#include "vtkPassThrough.h"
+#include "vtkPointData.h"
+#include "vtkPolyData.h"
 #include "vtkSMPVRepresentationProxy.h"
 #include "vtkSMParaViewPipelineControllerWithRendering.h"
 #include "vtkSMPropertyHelper.h"
@@ -31,16 +38,68 @@
 #include "vtkSmartPointer.h"
 
 #include <algorithm>
+#include <atomic>
 #include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include <QCheckBox>
 #include <QDialog>
+#include <QFutureWatcher>
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QLayout>
 #include <QPointer>
+#include <QtConcurrent>
+
+namespace {
+
+using tomviz::BrickRangeIndex;
+
+struct Extraction
+{
+  double value = 0.0;
+  int sampleRate = 1;
+  int version = 0;
+  vtkSmartPointer<vtkPolyData> surface;
+  std::shared_ptr<const BrickRangeIndex> index;
+};
+
+// Extract a surface on a worker thread from a shallow copy of the image. The
+// brick index of the array is built there first if there is none yet. With a
+// latest generation the extraction is skipped if it was superseded while
+// queued.
+QFuture<Extraction> extractInBackground(
+  vtkImageData* input, const std::string& arrayName, double value,
+  int sampleRate, int version, std::shared_ptr<const BrickRangeIndex> index,
+  int generation = 0,
+  std::shared_ptr<std::atomic<int>> latest = nullptr)
+{
+  auto image = vtkSmartPointer<vtkImageData>::New();
+  image->ShallowCopy(input);
+  return QtConcurrent::run([=]() {
+    Extraction extraction;
+    extraction.value = value;
+    extraction.sampleRate = sampleRate;
+    extraction.version = version;
+    if (latest && generation != *latest) {
+      return extraction;
+    }
+    extraction.index = index;
+    if (!extraction.index) {
+      int dims[3];
+      image->GetDimensions(dims);
+      auto built = std::make_shared<BrickRangeIndex>();
+      built->build(image->GetPointData()->GetArray(arrayName.c_str()), dims);
+      extraction.index = built;
+    }
+    extraction.surface = tomviz::IsoSurface::extract(
+      image, arrayName, value, sampleRate, extraction.index.get());
+    return extraction;
+  });
+}
+} // namespace
 
 namespace tomviz {
 
@@ -51,12 +110,30 @@ public:
   bool UseSolidColor = false;
   pqPropertyLinks Links;
   QPointer<DataSource> ColorByDataSource = nullptr;
+
+  // Input of the pass through filter, holds the surface shown.
+  vtkNew<vtkPolyData> Surface;
+  IsoSurfaceCache Cache;
+  // Iso value of the surface requested last.
+  double RequestedValue = 0.0;
+  // Latest request, shared with the worker threads so extractions that were
+  // superseded before they started can be skipped.
+  std::shared_ptr<std::atomic<int>> Generation =
+    std::make_shared<std::atomic<int>>(0);
+  // Bumped when the data or the array changes, extractions of an older
+  // version are not cached.
+  int Version = 0;
+  // Brick index of the contoured array, built by the first extraction.
+  std::shared_ptr<const BrickRangeIndex> Index;
+  QFutureWatcher<Extraction> Watcher;
 };
 
 ModuleContour::ModuleContour(QObject* parentObject) : Module(parentObject)
 {
   d = new Private;
   d->Links.setAutoUpdateVTKObjects(true);
+  connect(&d->Watcher, &QFutureWatcherBase::finished, this,
+          &ModuleContour::onExtractionFinished);
 }
 
 ModuleContour::~ModuleContour()
@@ -94,8 +171,19 @@ bool ModuleContour::initialize(DataSource* data, vtkSMViewProxy* vtkView)
 
   controller->PostInitializeProxy(m_contourFilter);
   controller->RegisterPipelineProxy(m_contourFilter);
+  d->RequestedValue = getIsoValue();
+
+  vtkSmartPointer<vtkSMProxy> surfaceProxy;
+  surfaceProxy.TakeReference(pxm->NewProxy("filters", "PassThrough"));
+  m_surfaceFilter = vtkSMSourceProxy::SafeDownCast(surfaceProxy);
+  Q_ASSERT(m_surfaceFilter);
+  controller->PreInitializeProxy(m_surfaceFilter);
+  vtkPassThrough::SafeDownCast(m_surfaceFilter->GetClientSideObject())
+    ->SetInputData(d->Surface.GetPointer());
+  controller->PostInitializeProxy(m_surfaceFilter);
+  controller->RegisterPipelineProxy(m_surfaceFilter);
 
-  m_activeRepresentation = controller->Show(m_contourFilter, 0, vtkView);
+  m_activeRepresentation = controller->Show(m_surfaceFilter, 0, vtkView);
 
   // Color by the data source by default
   d->ColorByDataSource = dataSource();
@@ -105,7 +193,10 @@ bool ModuleContour::initialize(DataSource* data, vtkSMViewProxy* vtkView)
     p->rename(label());
   }
 
+  pqCoreUtilities::connect(m_contourFilter, vtkCommand::PropertyModifiedEvent,
+                           this, SLOT(onContourValuesModified()));
   connect(data, SIGNAL(activeScalarsChanged()), SLOT(onScalarArrayChanged()));
+  connect(data, SIGNAL(dataChanged()), SLOT(onDataChanged()));
   onScalarArrayChanged();
 
   return true;
@@ -127,9 +218,18 @@ bool ModuleContour::finalize()
 {
   vtkNew<vtkSMParaViewPipelineControllerWithRendering> controller;
   controller->UnRegisterProxy(m_activeRepresentation);
+  controller->UnRegisterProxy(m_surfaceFilter);
   controller->UnRegisterProxy(m_contourFilter);
   m_activeRepresentation = nullptr;
+  m_surfaceFilter = nullptr;
   m_contourFilter = nullptr;
+
+  // Extractions still running only hold shallow copies of the image, they
+  // finish on their own and their results are dropped.
+  ++*d->Generation;
+  ++d->Version;
+  d->Cache.clear();
+  d->Index.reset();
   return true;
 }
 
@@ -154,8 +254,13 @@ bool ModuleContour::visibility() const
 
 void ModuleContour::setIsoValue(double value)
 {
+  // Set the requested value first so the change of the property is not
+  // taken for one made from outside the module.
+  d->RequestedValue = value;
+  ++*d->Generation;
   vtkSMPropertyHelper(m_contourFilter, "ContourValues").Set(value);
   m_contourFilter->UpdateVTKObjects();
+  updateSurface();
 }
 
 double ModuleContour::getIsoValue() const
@@ -182,8 +287,11 @@ void ModuleContour::addToPanel(QWidget* panel)
 
   connect(m_controllers, SIGNAL(useSolidColor(const bool)), this,
           SLOT(setUseSolidColor(const bool)));
+  connect(m_controllers, SIGNAL(isoValueEdited(double)), this,
+          SLOT(onIsoValueEdited(double)));
   m_controllers->addPropertyLinks(d->Links, m_activeRepresentation,
                                   m_contourFilter);
+  m_controllers->setIsoValue(getIsoValue());
   connect(m_controllers, SIGNAL(propertyChanged()), this,
           SLOT(onPropertyChanged()));
 
@@ -216,12 +324,144 @@ void ModuleContour::onScalarArrayChanged()
     .SetInputArrayToProcess(vtkDataObject::FIELD_ASSOCIATION_POINTS,
                             arrayName.toLatin1().data());
   m_contourFilter->UpdateVTKObjects();
+  onDataChanged();
 
   onPropertyChanged();
 
   emit renderNeeded();
 }
 
+void ModuleContour::onDataChanged()
+{
+  ++d->Version;
+  ++*d->Generation;
+  d->Cache.clear();
+  d->Index.reset();
+  updateSurface();
+}
+
+void ModuleContour::onIsoValueEdited(double value)
+{
+  setIsoValue(value);
+}
+
+void ModuleContour::onContourValuesModified()
+{
+  if (!m_contourFilter) {
+    return;
+  }
+  const double value = getIsoValue();
+  if (m_controllers) {
+    m_controllers->setIsoValue(value);
+  }
+  if (value == d->RequestedValue) {
+    return;
+  }
+  d->RequestedValue = value;
+  ++*d->Generation;
+  showSurfaceNow();
+}
+
+vtkImageData* ModuleContour::inputImage() const
+{
+  return dataSource() ? vtkImageData::SafeDownCast(dataSource()->dataObject())
+                      : nullptr;
+}
+
+void ModuleContour::updateSurface()
+{
+  if (!m_surfaceFilter) {
+    return;
+  }
+  const double value = d->RequestedValue;
+  if (auto full = d->Cache.find(value)) {
+    showSurface(full);
+    return;
+  }
+  if (d->Watcher.isRunning()) {
+    // Picked up when the running extraction finishes.
+    return;
+  }
+  auto image = inputImage();
+  if (!image) {
+    return;
+  }
+
+  // Extract a preview from a decimated image first, the full surface is
+  // extracted once the preview is shown.
+  int dims[3];
+  image->GetDimensions(dims);
+  int sampleRate = IsoSurface::previewSampleRate(dims);
+  if (sampleRate > 1) {
+    if (auto preview = d->Cache.find(value, sampleRate)) {
+      showSurface(preview);
+      sampleRate = 1;
+    }
+  }
+  startExtraction(image, value, sampleRate);
+}
+
+void ModuleContour::startExtraction(vtkImageData* image, double value,
+                                    int sampleRate)
+{
+  d->Watcher.setFuture(extractInBackground(
+    image, dataSource()->activeScalars().toStdString(), value, sampleRate,
+    d->Version, d->Index, *d->Generation, d->Generation));
+}
+
+void ModuleContour::onExtractionFinished()
+{
+  Extraction extraction = d->Watcher.result();
+  if (extraction.version == d->Version) {
+    if (extraction.index) {
+      d->Index = extraction.index;
+    }
+    // Superseded surfaces are cached as well, scrubbing back to them is then
+    // instant.
+    if (extraction.surface) {
+      d->Cache.insert(extraction.value, extraction.sampleRate,
+                      extraction.surface);
+    }
+  }
+  updateSurface();
+}
+
+vtkSmartPointer<vtkPolyData> ModuleContour::surface(double value)
+{
+  auto full = d->Cache.find(value);
+  auto image = inputImage();
+  if (!full && image) {
+    auto future =
+      extractInBackground(image, dataSource()->activeScalars().toStdString(),
+                          value, 1, d->Version, d->Index);
+    Extraction extraction = future.result();
+    if (extraction.index) {
+      d->Index = extraction.index;
+    }
+    full = extraction.surface;
+    d->Cache.insert(value, 1, full);
+  }
+  return full;
+}
+
+void ModuleContour::showSurfaceNow()
+{
+  if (!m_surfaceFilter) {
+    return;
+  }
+  showSurface(surface(d->RequestedValue));
+}
+
+void ModuleContour::showSurface(vtkPolyData* surface)
+{
+  if (!m_surfaceFilter || !surface) {
+    return;
+  }
+  d->Surface->ShallowCopy(surface);
+  m_surfaceFilter->MarkModified(m_surfaceFilter);
+  emit renderNeeded();
+}
+
 QJsonObject ModuleContour::serialize() const
 {
   auto json = Module::serialize();
@@ -282,9 +522,14 @@ bool ModuleContour::deserialize(const QJsonObject& json)
   if (json["properties"].isObject()) {
     auto props = json["properties"].toObject();
     if (m_contourFilter != nullptr) {
-      vtkSMPropertyHelper(m_contourFilter, "ContourValues")
-        .Set(props["contourValue"].toDouble());
+      // The surface of a loaded state is extracted right away, as for any
+      // value set on the proxy, the views are rendered next.
+      const double value = props["contourValue"].toDouble();
+      d->RequestedValue = value;
+      ++*d->Generation;
+      vtkSMPropertyHelper(m_contourFilter, "ContourValues").Set(value);
       m_contourFilter->UpdateVTKObjects();
+      showSurfaceNow();
     }
 
     d->UseSolidColor = props["useSolidColor"].toBool();
@@ -344,13 +589,12 @@ DataSource* ModuleContour::colorMapDataSource() const
 
 bool ModuleContour::isProxyPartOfModule(vtkSMProxy* proxy)
 {
-  return proxy == m_contourFilter.Get();
+  return proxy == m_contourFilter.Get() || proxy == m_surfaceFilter.Get();
 }
 
 vtkSmartPointer<vtkDataObject> ModuleContour::getDataToExport()
 {
-  return vtkAlgorithm::SafeDownCast(m_contourFilter->GetClientSideObject())
-    ->GetOutputDataObject(0);
+  return surface(d->RequestedValue);
 }
 
 std::string ModuleContour::getStringForProxy(vtkSMProxy* proxy)
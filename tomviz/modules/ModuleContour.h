@@ -9,6 +9,8 @@
 
 #include <QPointer>
 
+class vtkImageData;
+class vtkPolyData;
 class vtkSMProxy;
 class vtkSMSourceProxy;
 namespace tomviz {
@@ -37,6 +39,9 @@ public:
 
   void dataSourceMoved(double newX, double newY, double newZ) override;
 
+  /// Set the iso value interactively, the surface is extracted in the
+  /// background. A decimated preview is shown until the full surface is
+  /// ready, unless the surface for this value is still cached.
   void setIsoValue(double value);
   double getIsoValue() const;
 
@@ -48,6 +53,8 @@ public:
 
   vtkSmartPointer<vtkDataObject> getDataToExport() override;
 
+  void flush() override { showSurfaceNow(); }
+
 protected:
   void updateColorMap() override;
   std::string getStringForProxy(vtkSMProxy* proxy) override;
@@ -55,7 +62,25 @@ protected:
   QList<DataSource*> getChildDataSources();
   void updateScalarColoring();
 
+  /// Show the surface of the requested iso value if it is cached, otherwise
+  /// start extracting its preview or full surface unless an extraction is
+  /// already running. Called again every time an extraction finishes.
+  void updateSurface();
+  void startExtraction(vtkImageData* image, double value, int sampleRate);
+  /// The full surface of an iso value. If it is not cached it is extracted
+  /// in the background as any other request, and waited for.
+  vtkSmartPointer<vtkPolyData> surface(double value);
+  /// Extract the full surface of the requested iso value, unless it is
+  /// cached, and show it before returning.
+  void showSurfaceNow();
+  void showSurface(vtkPolyData* surface);
+  vtkImageData* inputImage() const;
+
+  /// The FlyingEdges proxy holds the iso value for the GUI, Python and
+  /// animations, the surface itself is extracted by the module and shown
+  /// through a pass through filter.
   vtkWeakPointer<vtkSMSourceProxy> m_contourFilter;
+  vtkWeakPointer<vtkSMSourceProxy> m_surfaceFilter;
   vtkWeakPointer<vtkSMProxy> m_activeRepresentation;
 
   class Private;
@@ -71,6 +96,19 @@ private slots:
 
   void onScalarArrayChanged();
 
+  /// Drop the cached surfaces and extract the surface again.
+  void onDataChanged();
+
+  void onIsoValueEdited(double value);
+
+  /// The iso value was changed on the proxy from outside the module, by
+  /// Python or an animation. The surface is extracted before returning, as
+  /// the change is usually followed by a render, of a screenshot or of the
+  /// next frame of an animation, without going back to the event loop.
+  void onContourValuesModified();
+
+  void onExtractionFinished();
+
   void setUseSolidColor(const bool useSolidColor);
 
 private:
@@ -55,7 +55,7 @@ ModuleContourWidget::ModuleContourWidget(QWidget* parent_)
   connect(m_uiLighting->sliSpecularPower, SIGNAL(valueEdited(double)), this,
           SIGNAL(propertyChanged()));
   connect(m_ui->sliValue, SIGNAL(valueEdited(double)), this,
-          SIGNAL(propertyChanged()));
+          SIGNAL(isoValueEdited(double)));
   connect(m_ui->cbRepresentation, SIGNAL(currentTextChanged(const QString&)),
           this, SIGNAL(propertyChanged()));
   connect(m_ui->sliOpacity, SIGNAL(valueEdited(double)), this,
@@ -75,9 +75,6 @@ void ModuleContourWidget::addPropertyLinks(pqPropertyLinks& links,
   links.addPropertyLink(m_ui->cbColorMapData, "checked", SIGNAL(toggled(bool)),
                         representation,
                         representation->GetProperty("MapScalars"), 0);
-  links.addPropertyLink(m_ui->sliValue, "value", SIGNAL(valueEdited(double)),
-                        contourFilter,
-                        contourFilter->GetProperty("ContourValues"), 0);
   new pqWidgetRangeDomain(m_ui->sliValue, "minimum", "maximum",
                           contourFilter->GetProperty("ContourValues"), 0);
 
@@ -167,4 +164,9 @@ void ModuleContourWidget::setUseSolidColor(const bool useSolid)
   m_ui->cbSelectColor->setChecked(useSolid);
 }
 
+void ModuleContourWidget::setIsoValue(double value)
+{
+  m_ui->sliValue->setValue(value);
+}
+
 } // namespace tomviz
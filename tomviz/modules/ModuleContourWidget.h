@@ -41,6 +41,7 @@ public:
    * when constructing the UI.
    */
   void setUseSolidColor(const bool useSolid);
+  void setIsoValue(double value);
   //@}
 
   /**
@@ -58,6 +59,11 @@ signals:
    */
   void specularPowerChanged(const double value);
   void useSolidColor(const bool value);
+  /**
+   * The iso value is not linked to the contour filter, ModuleContour
+   * extracts the surface itself.
+   */
+  void isoValueEdited(double value);
   /**
    * All proxy properties should use this signal.
    */
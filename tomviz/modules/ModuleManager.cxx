@@ -10,6 +10,7 @@
 #include "MoleculeSource.h"
 #include "Pipeline.h"
 #include "PythonGeneratedDatasetReaction.h"
+#include "StateBundle.h"
 #include "Utilities.h"
 #include "tomvizConfig.h"
 
@@ -377,6 +378,17 @@ QList<Module*> ModuleManager::findModulesGeneric(const DataSource* dataSource,
   return modules;
 }
 
+QList<Module*> ModuleManager::findModulesGeneric(const vtkSMViewProxy* view)
+{
+  QList<Module*> modules;
+  foreach (Module* module, d->Modules) {
+    if (module && module->dataSource() && module->view() == view) {
+      modules.push_back(module);
+    }
+  }
+  return modules;
+}
+
 QList<Module*> ModuleManager::findModulesGeneric(
   const MoleculeSource* dataSource, const vtkSMViewProxy* view)
 {
@@ -415,7 +427,8 @@ QJsonArray jsonArrayFromXmlDouble(pugi::xml_node node)
 }
 
 bool ModuleManager::serialize(QJsonObject& doc, const QDir& stateDir,
-                              bool interactive) const
+                              bool interactive,
+                              StateBundle::ResultsWriter* results) const
 {
   QJsonObject tvObj;
   tvObj["version"] = QString(TOMVIZ_VERSION);
@@ -479,6 +492,9 @@ bool ModuleManager::serialize(QJsonObject& doc, const QDir& stateDir,
     }
 
     d->relativeFilePaths(ds, stateDir, jDataSource);
+    if (results) {
+      results->addResults(ds, jDataSource, jDataSources.size());
+    }
 
     jDataSources.append(jDataSource);
   }
@@ -944,6 +960,7 @@ void ModuleManager::onPVStateLoaded(vtkPVXMLElement*,
       options["addToRecent"] = false;
       options["child"] = false;
       d->absoluteFilePaths(dsObject);
+      StateBundle::absoluteResultPaths(dsObject, d->dir);
 
       QStringList fileNames;
       if (dsObject.contains("reader")) {
@@ -980,6 +997,7 @@ void ModuleManager::onPVStateLoaded(vtkPVXMLElement*,
           dsObject["sourceInformation"].toObject());
         LoadDataReaction::dataSourceAdded(dataSource, false, false);
       } else if (fileNames.size() > 0) {
+        options["timeSeries"] = dsObject.contains("timeSeries");
         dataSource = LoadDataReaction::loadData(fileNames, options);
       } else {
         qCritical() << "Files not found on disk for data source, check paths.";
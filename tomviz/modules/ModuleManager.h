@@ -26,6 +26,10 @@ class Module;
 class Operator;
 class Pipeline;
 
+namespace StateBundle {
+class ResultsWriter;
+}
+
 /// Singleton akin to ProxyManager, but to keep track (and
 /// serialize/deserialze) modules.
 class ModuleManager : public QObject
@@ -62,10 +66,14 @@ public:
   QList<Module*> findModulesGeneric(const MoleculeSource* dataSource,
                                     const vtkSMViewProxy* view);
 
+  /// Returns the modules of every data source shown in view.
+  QList<Module*> findModulesGeneric(const vtkSMViewProxy* view);
+
   /// Save the application state as JSON, use stateDir as the base for relative
-  /// paths.
-  bool serialize(QJsonObject& doc, const QDir& stateDir,
-                 bool interative = true) const;
+  /// paths. When results is set the results of the pipelines are gathered
+  /// to be stored with the state, so loading it does not run them again.
+  bool serialize(QJsonObject& doc, const QDir& stateDir, bool interative = true,
+                 StateBundle::ResultsWriter* results = nullptr) const;
   bool deserialize(const QJsonObject& doc, const QDir& stateDir);
 
   /// Test if any data source has running operators
@@ -5,16 +5,18 @@
 
 #include "DataSource.h"
 #include "DoubleSliderWidget.h"
+#include "ImageSlice.h"
 #include "IntSliderWidget.h"
 #include "ScalarsComboBox.h"
 #include "Utilities.h"
 #include "pqPropertyLinks.h"
 #include "pqSignalAdaptors.h"
-#include "pqWidgetRangeDomain.h"
-#include "vtkAlgorithm.h"
 #include "vtkImageData.h"
 #include "vtkImageReslice.h"
 #include "vtkNew.h"
+#include "pqCoreUtilities.h"
+#include "vtkCommand.h"
+#include "vtkPassThrough.h"
 #include "vtkSMPVRepresentationProxy.h"
 #include "vtkSMParaViewPipelineControllerWithRendering.h"
 #include "vtkSMPropertyHelper.h"
@@ -28,11 +30,18 @@
 #include <QCheckBox>
 #include <QComboBox>
 #include <QFormLayout>
+#include <QtConcurrent>
+
+#include <algorithm>
+
 namespace tomviz {
 
 ModuleOrthogonalSlice::ModuleOrthogonalSlice(QObject* parentObject)
   : Module(parentObject)
-{}
+{
+  connect(&m_watcher, &QFutureWatcherBase::finished, this,
+          &ModuleOrthogonalSlice::onExtractionFinished);
+}
 
 ModuleOrthogonalSlice::~ModuleOrthogonalSlice()
 {
@@ -51,6 +60,8 @@ bool ModuleOrthogonalSlice::initialize(DataSource* data,
     return false;
   }
 
+  m_imageData->ShallowCopy(vtkImageData::SafeDownCast(data->dataObject()));
+
   vtkNew<vtkSMParaViewPipelineControllerWithRendering> controller;
 
   auto pxm = data->proxy()->GetSessionProxyManager();
@@ -59,18 +70,30 @@ bool ModuleOrthogonalSlice::initialize(DataSource* data,
   vtkSmartPointer<vtkSMProxy> proxy;
   proxy.TakeReference(pxm->NewProxy("filters", "PassThrough"));
 
+  // The pass through filter shows the slice extracted by the module rather
+  // than the whole volume, so moving through the slices never waits on the
+  // representation slicing the volume on the GUI thread.
   m_passThrough = vtkSMSourceProxy::SafeDownCast(proxy);
   Q_ASSERT(m_passThrough);
   controller->PreInitializeProxy(m_passThrough);
-  vtkSMPropertyHelper(m_passThrough, "Input").Set(data->proxy());
+  vtkPassThrough::SafeDownCast(m_passThrough->GetClientSideObject())
+    ->SetInputData(m_sliceData);
   controller->PostInitializeProxy(m_passThrough);
   controller->RegisterPipelineProxy(m_passThrough);
+  updateSlice();
 
   // Create the representation for it.
   m_representation = controller->Show(m_passThrough, 0, vtkView);
   Q_ASSERT(m_representation);
 
+  // The representation shows the single slice it is given whatever its
+  // "Slice" property, which holds the index of the slice for the panel,
+  // Python and animations.
   vtkSMRepresentationProxy::SetRepresentationType(m_representation, "Slice");
+  vtkSMPropertyHelper(m_representation, "Slice").Set(m_slice);
+  pqCoreUtilities::connect(m_representation->GetProperty("Slice"),
+                           vtkCommand::ModifiedEvent, this,
+                           SLOT(onSlicePropertyModified()));
   vtkSMPropertyHelper(m_representation, "Position")
     .Set(data->displayPosition(), 3);
 
@@ -84,6 +107,7 @@ bool ModuleOrthogonalSlice::initialize(DataSource* data,
   }
 
   connect(data, SIGNAL(activeScalarsChanged()), SLOT(onScalarArrayChanged()));
+  connect(data, SIGNAL(dataChanged()), SLOT(onDataChanged()));
 
   onScalarArrayChanged();
 
@@ -108,6 +132,11 @@ bool ModuleOrthogonalSlice::finalize()
 
   m_passThrough = nullptr;
   m_representation = nullptr;
+
+  // Extractions still running only hold shallow copies of the image, they
+  // finish on their own and their results are dropped.
+  ++m_version;
+  m_cache.clear();
   return true;
 }
 
@@ -162,10 +191,11 @@ void ModuleOrthogonalSlice::addToPanel(QWidget* panel)
 
   pqSignalAdaptorComboBox* adaptor = new pqSignalAdaptorComboBox(direction);
 
-  IntSliderWidget* sliceIndex = new IntSliderWidget(true);
-  sliceIndex->setLineEditWidth(50);
-  sliceIndex->setPageStep(1);
-  layout->addRow("Slice", sliceIndex);
+  m_sliceSlider = new IntSliderWidget(true);
+  m_sliceSlider->setLineEditWidth(50);
+  m_sliceSlider->setPageStep(1);
+  layout->addRow("Slice", m_sliceSlider);
+  updateSliceRange();
 
   DoubleSliderWidget* opacitySlider = new DoubleSliderWidget(true);
   opacitySlider->setLineEditWidth(50);
@@ -173,11 +203,9 @@ void ModuleOrthogonalSlice::addToPanel(QWidget* panel)
 
   panel->setLayout(layout);
 
-  m_links.addPropertyLink(sliceIndex, "value", SIGNAL(valueEdited(int)),
+  m_links.addPropertyLink(m_sliceSlider, "value", SIGNAL(valueEdited(int)),
                           m_representation,
                           m_representation->GetProperty("Slice"), 0);
-  new pqWidgetRangeDomain(sliceIndex, "minimum", "maximum",
-                          m_representation->GetProperty("Slice"), 0);
   m_links.addPropertyLink(opacitySlider, "value", SIGNAL(valueEdited(double)),
                           m_representation,
                           m_representation->GetProperty("Opacity"), 0);
@@ -189,10 +217,11 @@ void ModuleOrthogonalSlice::addToPanel(QWidget* panel)
                           SIGNAL(currentTextChanged(QString)), m_representation,
                           m_representation->GetProperty("SliceMode"));
 
-  connect(sliceIndex, &IntSliderWidget::valueEdited, this,
-          &ModuleOrthogonalSlice::dataUpdated);
-  connect(direction, &QComboBox::currentTextChanged, this,
-          &ModuleOrthogonalSlice::dataUpdated);
+  connect(direction, &QComboBox::currentTextChanged, this, [this]() {
+    m_links.accept();
+    updateSliceRange();
+    updateSlice();
+  });
   connect(opacitySlider, &DoubleSliderWidget::valueEdited, this,
           &ModuleOrthogonalSlice::dataUpdated);
   connect(mapScalarsCheckBox, SIGNAL(toggled(bool)), this, SLOT(dataUpdated()));
@@ -226,6 +255,177 @@ void ModuleOrthogonalSlice::dataUpdated()
   emit renderNeeded();
 }
 
+void ModuleOrthogonalSlice::setSlice(int index)
+{
+  int dims[3] = { 0, 0, 0 };
+  m_imageData->GetDimensions(dims);
+  index = std::max(std::min(index, dims[sliceAxis()] - 1), 0);
+  if (index != m_slice) {
+    m_lastStep = index > m_slice ? 1 : -1;
+    m_slice = index;
+  }
+  if (m_sliceSlider) {
+    m_sliceSlider->setValue(m_slice);
+  }
+  updateSliceProperty();
+  updateSlice();
+}
+
+void ModuleOrthogonalSlice::onSlicePropertyModified()
+{
+  const int index = vtkSMPropertyHelper(m_representation, "Slice").GetAsInt();
+  if (index != m_slice) {
+    setSlice(index);
+  }
+}
+
+void ModuleOrthogonalSlice::updateSliceProperty()
+{
+  if (m_representation) {
+    vtkSMPropertyHelper(m_representation, "Slice").Set(m_slice);
+    m_representation->UpdateVTKObjects();
+  }
+}
+
+int ModuleOrthogonalSlice::sliceAxis() const
+{
+  if (!m_representation) {
+    return 2;
+  }
+  switch (vtkSMPropertyHelper(m_representation, "SliceMode").GetAsInt()) {
+    case 6: // YZ Plane
+      return 0;
+    case 7: // XZ Plane
+      return 1;
+    default: // XY Plane
+      return 2;
+  }
+}
+
+int ModuleOrthogonalSlice::sliceCount() const
+{
+  int dims[3] = { 0, 0, 0 };
+  m_imageData->GetDimensions(dims);
+  return dims[sliceAxis()];
+}
+
+void ModuleOrthogonalSlice::showSliceNow(int index)
+{
+  if (!m_passThrough || !m_imageData->GetPointData()->GetScalars()) {
+    return;
+  }
+  m_slice = std::max(std::min(index, sliceCount() - 1), 0);
+  if (m_sliceSlider) {
+    m_sliceSlider->setValue(m_slice);
+  }
+  updateSliceProperty();
+  const int axis = sliceAxis();
+  vtkSmartPointer<vtkImageData> slice = m_cache.find(axis, m_slice);
+  if (!slice) {
+    slice = ImageSlice::extract(m_imageData, axis, m_slice);
+    if (axis != 2) {
+      m_cache.insert(axis, m_slice, slice);
+    }
+  }
+  showSlice(slice);
+}
+
+void ModuleOrthogonalSlice::updateSliceRange()
+{
+  const int count = sliceCount();
+  m_slice = std::max(std::min(m_slice, count - 1), 0);
+  if (m_sliceSlider) {
+    m_sliceSlider->setMinimum(0);
+    m_sliceSlider->setMaximum(std::max(count - 1, 0));
+    m_sliceSlider->setValue(m_slice);
+  }
+  updateSliceProperty();
+}
+
+void ModuleOrthogonalSlice::updateSlice()
+{
+  if (!m_passThrough || !m_imageData->GetPointData()->GetScalars()) {
+    return;
+  }
+  const int axis = sliceAxis();
+  if (axis == 2) {
+    // Slices along z are views into the volume, they take no time to make.
+    showSlice(ImageSlice::extract(m_imageData, axis, m_slice));
+    return;
+  }
+  if (auto slice = m_cache.find(axis, m_slice)) {
+    showSlice(slice);
+    prefetch();
+    return;
+  }
+  if (m_watcher.isRunning()) {
+    // Picked up when the running extraction finishes.
+    return;
+  }
+  startExtraction(axis, m_slice);
+}
+
+void ModuleOrthogonalSlice::startExtraction(int axis, int index)
+{
+  auto image = vtkSmartPointer<vtkImageData>::New();
+  image->ShallowCopy(m_imageData);
+  const int version = m_version;
+  m_watcher.setFuture(QtConcurrent::run([=]() {
+    Extraction extraction;
+    extraction.axis = axis;
+    extraction.index = index;
+    extraction.version = version;
+    extraction.slice = ImageSlice::extract(image, axis, index);
+    return extraction;
+  }));
+}
+
+void ModuleOrthogonalSlice::onExtractionFinished()
+{
+  Extraction extraction = m_watcher.result();
+  if (extraction.slice && extraction.version == m_version) {
+    m_cache.insert(extraction.axis, extraction.index, extraction.slice);
+  }
+  updateSlice();
+}
+
+void ModuleOrthogonalSlice::prefetch()
+{
+  const int axis = sliceAxis();
+  if (axis == 2 || m_watcher.isRunning()) {
+    return;
+  }
+  int dims[3];
+  m_imageData->GetDimensions(dims);
+  for (int step = 1; step <= PrefetchRadius; ++step) {
+    for (int direction : { m_lastStep, -m_lastStep }) {
+      const int index = m_slice + direction * step;
+      if (index >= 0 && index < dims[axis] && !m_cache.contains(axis, index)) {
+        startExtraction(axis, index);
+        return;
+      }
+    }
+  }
+}
+
+void ModuleOrthogonalSlice::showSlice(vtkImageData* slice)
+{
+  if (!slice || slice == m_shownSlice) {
+    return;
+  }
+  m_shownSlice = slice;
+  m_sliceData->ShallowCopy(slice);
+  m_passThrough->MarkModified(m_passThrough);
+  emit renderNeeded();
+}
+
+void ModuleOrthogonalSlice::onDataChanged()
+{
+  m_imageData->ShallowCopy(
+    vtkImageData::SafeDownCast(dataSource()->dataObject()));
+  onScalarArrayChanged();
+}
+
 void ModuleOrthogonalSlice::onScalarArrayChanged()
 {
   QString arrayName;
@@ -239,6 +439,13 @@ void ModuleOrthogonalSlice::onScalarArrayChanged()
                             arrayName.toLatin1().data());
   m_representation->UpdateVTKObjects();
 
+  m_imageData->GetPointData()->SetActiveScalars(arrayName.toLatin1().data());
+  ++m_version;
+  m_cache.clear();
+  m_shownSlice = nullptr;
+  updateSliceRange();
+  updateSlice();
+
   emit renderNeeded();
 }
 
@@ -249,8 +456,7 @@ QJsonObject ModuleOrthogonalSlice::serialize() const
 
   vtkSMPropertyHelper sliceMode(m_representation->GetProperty("SliceMode"));
   props["sliceMode"] = sliceMode.GetAsInt();
-  vtkSMPropertyHelper slice(m_representation->GetProperty("Slice"));
-  props["slice"] = slice.GetAsInt();
+  props["slice"] = m_slice;
   vtkSMPropertyHelper opacity(m_representation->GetProperty("Opacity"));
   props["opacity"] = opacity.GetAsDouble();
   vtkSMPropertyHelper mapScalars(m_representation->GetProperty("MapScalars"));
@@ -270,7 +476,6 @@ bool ModuleOrthogonalSlice::deserialize(const QJsonObject& json)
     auto rep = m_representation.Get();
     auto props = json["properties"].toObject();
     vtkSMPropertyHelper(rep, "SliceMode").Set(props["sliceMode"].toInt());
-    vtkSMPropertyHelper(rep, "Slice").Set(props["slice"].toInt());
     vtkSMPropertyHelper(rep, "Opacity").Set(props["opacity"].toDouble());
     vtkSMPropertyHelper(rep, "MapScalars")
       .Set(props["mapScalars"].toBool() ? 1 : 0);
@@ -282,6 +487,8 @@ bool ModuleOrthogonalSlice::deserialize(const QJsonObject& json)
     }
     rep->UpdateVTKObjects();
     m_scalarsCombo->setOptions(dataSource(), this);
+    updateSliceRange();
+    setSlice(props["slice"].toInt());
     return true;
   }
   return false;
@@ -297,11 +504,16 @@ void ModuleOrthogonalSlice::dataSourceMoved(double newX, double newY,
 
 vtkSmartPointer<vtkDataObject> ModuleOrthogonalSlice::getDataToExport()
 {
-  vtkAlgorithm* algorithm =
-    vtkAlgorithm::SafeDownCast(m_passThrough->GetClientSideObject());
-  vtkNew<vtkImageData> volume;
-  volume->ShallowCopy(
-    vtkImageData::SafeDownCast(algorithm->GetOutputDataObject(0)));
+  // Reorient the slice shown rather than reslicing the whole volume, its
+  // extent along the slice axis starts at the slice.
+  const int axis = sliceAxis();
+  vtkSmartPointer<vtkImageData> volume = m_cache.find(axis, m_slice);
+  if (!volume) {
+    volume = ImageSlice::extract(m_imageData, axis, m_slice);
+  }
+  if (!volume) {
+    return nullptr;
+  }
 
   double origin[3], spacing[3];
   int extent[6];
@@ -309,35 +521,22 @@ vtkSmartPointer<vtkDataObject> ModuleOrthogonalSlice::getDataToExport()
   volume->GetSpacing(spacing);
   volume->GetExtent(extent);
 
-  QString arrayName;
-  if (activeScalars() == Module::DEFAULT_SCALARS) {
-    arrayName = dataSource()->activeScalars();
-  } else {
-    arrayName = dataSource()->scalarsName(activeScalars());
-  }
-  volume->GetPointData()->SetActiveScalars(arrayName.toLatin1().data());
-
   double cosines[9] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
   double newOrigin[3] = { origin[0], origin[1], origin[2] };
-  vtkSMPropertyHelper directionHelper(m_representation, "SliceMode");
-  vtkSMPropertyHelper sliceNumHelper(m_representation, "Slice");
-  switch (directionHelper.GetAsInt()) {
-    case 5: // XY Plane
+  switch (axis) {
+    case 2: // XY Plane
       cosines[0] = cosines[4] = cosines[8] = 1;
-      newOrigin[2] =
-        origin[2] + spacing[2] * (extent[4] + sliceNumHelper.GetAsInt());
+      newOrigin[2] = origin[2] + spacing[2] * extent[4];
       break;
-    case 6: // YZ Plane
+    case 0: // YZ Plane
       cosines[4] = cosines[6] = 1;
       cosines[2] = -1;
-      newOrigin[0] =
-        origin[0] + spacing[0] * (extent[0] + sliceNumHelper.GetAsInt());
+      newOrigin[0] = origin[0] + spacing[0] * extent[0];
       break;
-    case 7: // XZ Plane
+    case 1: // XZ Plane
       cosines[0] = cosines[7] = 1;
       cosines[5] = -1;
-      newOrigin[1] =
-        origin[1] + spacing[1] * (extent[2] + sliceNumHelper.GetAsInt());
+      newOrigin[1] = origin[1] + spacing[1] * extent[2];
       break;
   }
 
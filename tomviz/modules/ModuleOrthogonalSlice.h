@@ -4,16 +4,22 @@
 #ifndef tomvizModuleOrthogonalSlice_h
 #define tomvizModuleOrthogonalSlice_h
 
+#include "ImageSlice.h"
 #include "Module.h"
 #include <pqPropertyLinks.h>
+#include <vtkNew.h>
 #include <vtkWeakPointer.h>
 
+#include <QFutureWatcher>
+
 class QCheckBox;
+class vtkImageData;
 class vtkSMProxy;
 class vtkSMSourceProxy;
 
 namespace tomviz {
 
+class IntSliderWidget;
 class ScalarsComboBox;
 
 class ModuleOrthogonalSlice : public Module
@@ -46,18 +52,63 @@ public:
 
   vtkSmartPointer<vtkDataObject> getDataToExport() override;
 
+  /// Number of slices along the slice direction.
+  int sliceCount() const;
+
+  /// Show the slice at index right away, extracting it on this thread unless
+  /// it is cached, for renders that must show it in their next frame.
+  void showSliceNow(int index);
+
+  void flush() override { showSliceNow(m_slice); }
+
 protected:
   void updateColorMap() override;
   std::string getStringForProxy(vtkSMProxy* proxy) override;
   vtkSMProxy* getProxyForString(const std::string& str) override;
 
+  /// Number of slices on either side of the one shown that are extracted
+  /// ahead of time, in the direction of the last move first.
+  static const int PrefetchRadius = 2;
+
+  /// Index of the slice shown along the slice direction.
+  int slice() const { return m_slice; }
+  void setSlice(int index);
+
 private slots:
   void dataUpdated();
 
+  void onDataChanged();
   void onScalarArrayChanged();
+  void onExtractionFinished();
+  /// The "Slice" property of the representation was set, from the panel,
+  /// Python or an animation.
+  void onSlicePropertyModified();
 
 private:
   Q_DISABLE_COPY(ModuleOrthogonalSlice)
+
+  struct Extraction
+  {
+    int axis = 2;
+    int index = 0;
+    int version = 0;
+    vtkSmartPointer<vtkImageData> slice;
+  };
+
+  /// Image axis normal to the slices of the current slice mode.
+  int sliceAxis() const;
+  void updateSliceRange();
+  /// Keep the "Slice" property of the representation at the slice shown.
+  void updateSliceProperty();
+
+  /// Show the requested slice, extracting it in the background unless it is
+  /// cached. Requests made while an extraction runs are coalesced, only the
+  /// latest is extracted once it finishes.
+  void updateSlice();
+  void startExtraction(int axis, int index);
+  void prefetch();
+  void showSlice(vtkImageData* slice);
+
   vtkWeakPointer<vtkSMSourceProxy> m_passThrough;
   vtkWeakPointer<vtkSMProxy> m_representation;
 
@@ -65,7 +116,22 @@ private:
 
   QPointer<QCheckBox> m_opacityCheckBox;
   QPointer<ScalarsComboBox> m_scalarsCombo;
+  QPointer<IntSliderWidget> m_sliceSlider;
   bool m_mapOpacity = false;
+
+  // The data with the scalars of the module active, slices are taken from it.
+  vtkNew<vtkImageData> m_imageData;
+  // Input of the pass through filter, holds the slice shown. The
+  // representation always shows its only slice.
+  vtkNew<vtkImageData> m_sliceData;
+  vtkSmartPointer<vtkImageData> m_shownSlice;
+  int m_slice = 0;
+  int m_lastStep = 1;
+  // Bumped when the data or the array changes, extractions of an older
+  // version are not cached.
+  int m_version = 0;
+  ImageSliceCache m_cache;
+  QFutureWatcher<Extraction> m_watcher;
 };
 } // namespace tomviz
 #endif
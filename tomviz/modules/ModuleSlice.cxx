@@ -12,6 +12,8 @@
 #include <vtkCommand.h>
 #include <vtkDataObject.h>
 #include <vtkImageData.h>
+#include <vtkImageReslice.h>
+#include <vtkMatrix4x4.h>
 #include <vtkNew.h>
 #include <vtkNonOrthoImagePlaneWidget.h>
 #include <vtkPassThrough.h>
@@ -20,6 +22,7 @@
 #include <vtkRenderWindow.h>
 #include <vtkRenderWindowInteractor.h>
 #include <vtkScalarsToColors.h>
+#include <vtkTexture.h>
 #include <vtkTrivialProducer.h>
 
 #include <pqCoreUtilities.h>
@@ -48,10 +51,15 @@
 #include <QJsonArray>
 #include <QLabel>
 #include <QVBoxLayout>
+#include <QtConcurrent>
 
 namespace tomviz {
 
-ModuleSlice::ModuleSlice(QObject* parentObject) : Module(parentObject) {}
+ModuleSlice::ModuleSlice(QObject* parentObject) : Module(parentObject)
+{
+  connect(&m_resliceWatcher, &QFutureWatcherBase::finished, this,
+          &ModuleSlice::onResliceFinished);
+}
 
 ModuleSlice::~ModuleSlice()
 {
@@ -158,6 +166,12 @@ bool ModuleSlice::setupWidget(vtkSMViewProxy* vtkView)
   // Lastly we set up the input connection.
   m_widget->SetInputConnection(passThroughAlg->GetOutputPort());
 
+  // The texture shows planes resliced in the background, the first plane is
+  // resliced right away so there is always one to show.
+  m_widget->GetReslice()->Update();
+  m_textureData->ShallowCopy(m_widget->GetResliceOutput());
+  m_widget->GetTexture()->SetInputData(m_textureData);
+
   Q_ASSERT(rwi);
   Q_ASSERT(passThroughAlg);
   onPlaneChanged();
@@ -329,6 +343,77 @@ void ModuleSlice::dataUpdated()
     vtkSMPropertyHelper(m_propsPanelProxy->GetProperty("MapScalars"), 1)
       .GetAsInt());
   m_widget->UpdatePlacement();
+  updateTexture();
+  emit renderNeeded();
+}
+
+void ModuleSlice::updateTexture()
+{
+  if (!m_widget) {
+    return;
+  }
+  if (m_resliceRunning) {
+    m_reslicePending = true;
+    return;
+  }
+  m_reslicePending = false;
+  m_resliceRunning = true;
+  auto reslice = newReslice();
+  m_resliceWatcher.setFuture(QtConcurrent::run([reslice]() {
+    reslice->Update();
+    vtkSmartPointer<vtkImageData> output = reslice->GetOutput();
+    return output;
+  }));
+}
+
+vtkSmartPointer<vtkImageReslice> ModuleSlice::newReslice()
+{
+  auto current = m_widget->GetReslice();
+  auto image = vtkSmartPointer<vtkImageData>::New();
+  image->ShallowCopy(m_imageData);
+  auto axes = vtkSmartPointer<vtkMatrix4x4>::New();
+  axes->DeepCopy(current->GetResliceAxes());
+  auto reslice = vtkSmartPointer<vtkImageReslice>::New();
+  reslice->SetInputData(image);
+  reslice->SetResliceAxes(axes);
+  reslice->SetTransformInputSampling(current->GetTransformInputSampling());
+  reslice->SetAutoCropOutput(current->GetAutoCropOutput());
+  reslice->SetMirror(current->GetMirror());
+  reslice->SetInterpolationMode(current->GetInterpolationMode());
+  reslice->SetOutputSpacing(current->GetOutputSpacing());
+  reslice->SetOutputOrigin(current->GetOutputOrigin());
+  reslice->SetOutputExtent(current->GetOutputExtent());
+  return reslice;
+}
+
+void ModuleSlice::onResliceFinished()
+{
+  auto output = m_resliceWatcher.result();
+  m_resliceRunning = false;
+  const bool stale = m_resliceStale;
+  m_resliceStale = false;
+  if (m_reslicePending) {
+    // The plane moved on, skip straight to the latest one.
+    updateTexture();
+  }
+  if (output && m_widget && !stale) {
+    m_textureData->ShallowCopy(output);
+    emit renderNeeded();
+  }
+}
+
+void ModuleSlice::flush()
+{
+  if (!m_widget || (!m_resliceRunning && !m_reslicePending)) {
+    return;
+  }
+  // The running reslice is of this plane or of an earlier one, its output is
+  // dropped when it finishes.
+  m_resliceStale = m_resliceRunning;
+  m_reslicePending = false;
+  auto reslice = newReslice();
+  reslice->Update();
+  m_textureData->ShallowCopy(reslice->GetOutput());
   emit renderNeeded();
 }
 
@@ -413,6 +498,7 @@ void ModuleSlice::onPropertyChanged()
   std::vector<double> normalVector = normalProperty.GetDoubleArray();
   m_widget->SetNormal(&normalVector[0]);
   m_widget->UpdatePlacement();
+  updateTexture();
   m_ignoreSignals = false;
 }
 
@@ -432,6 +518,7 @@ void ModuleSlice::onPlaneChanged()
   vtkSMPropertyHelper mapScalarsProperty(m_propsPanelProxy, "MapScalars");
   int mapScalars = m_widget->GetMapScalars();
   mapScalarsProperty.Set(mapScalars);
+  updateTexture();
 
   m_ignoreSignals = false;
 }
@@ -444,6 +531,8 @@ void ModuleSlice::dataSourceMoved(double newX, double newY, double newZ)
 
 vtkSmartPointer<vtkDataObject> ModuleSlice::getDataToExport()
 {
+  // The texture no longer pulls on the widget's reslice.
+  m_widget->GetReslice()->Update();
   return m_widget->GetResliceOutput();
 }
 
@@ -491,6 +580,7 @@ void ModuleSlice::onScalarArrayChanged()
     arrayName = dataSource()->scalarsName(activeScalars());
   }
   m_imageData->GetPointData()->SetActiveScalars(arrayName.toLatin1().data());
+  updateTexture();
   emit renderNeeded();
 }
 
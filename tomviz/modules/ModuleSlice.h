@@ -10,9 +10,12 @@
 
 #include <pqPropertyLinks.h>
 
+#include <QFutureWatcher>
+
 class QCheckBox;
 class vtkSMProxy;
 class vtkSMSourceProxy;
+class vtkImageReslice;
 class vtkNonOrthoImagePlaneWidget;
 
 namespace tomviz {
@@ -49,6 +52,8 @@ public:
 
   vtkSmartPointer<vtkDataObject> getDataToExport() override;
 
+  void flush() override;
+
 protected:
   void updateColorMap() override;
   std::string getStringForProxy(vtkSMProxy* proxy) override;
@@ -62,10 +67,20 @@ private slots:
 
   void onScalarArrayChanged();
 
+  void onResliceFinished();
+
 private:
   // Should only be called from initialize after the PassThrough has been setup.
   bool setupWidget(vtkSMViewProxy* view);
 
+  /// Reslice the plane of the widget on a background thread and show it as
+  /// the texture of the plane once done. Requests made while a reslice runs
+  /// are coalesced, the plane is resliced again once it finishes.
+  void updateTexture();
+
+  /// A reslice of the current plane of the widget, of its own input.
+  vtkSmartPointer<vtkImageReslice> newReslice();
+
   Q_DISABLE_COPY(ModuleSlice)
 
   vtkWeakPointer<vtkSMSourceProxy> m_passThrough;
@@ -80,6 +95,15 @@ private:
 
   vtkNew<vtkImageData> m_imageData;
   QPointer<ScalarsComboBox> m_scalarsCombo;
+
+  // Texture of the plane, the widget's own reslice only holds the reslice
+  // parameters of the current plane.
+  vtkNew<vtkImageData> m_textureData;
+  QFutureWatcher<vtkSmartPointer<vtkImageData>> m_resliceWatcher;
+  bool m_resliceRunning = false;
+  bool m_reslicePending = false;
+  // Set when the running reslice was overtaken by one made by flush().
+  bool m_resliceStale = false;
 };
 } // namespace tomviz
 
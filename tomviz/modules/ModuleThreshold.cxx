@@ -5,26 +5,33 @@
 
 #include "DataSource.h"
 #include "DoubleSliderWidget.h"
-#include "Utilities.h"
-#include "pqDoubleRangeSliderPropertyWidget.h"
-#include "pqProxiesWidget.h"
-#include "pqSignalAdaptors.h"
-#include "pqStringVectorPropertyWidget.h"
-
-#include "vtkDataObject.h"
-#include "vtkNew.h"
-#include "vtkSMPVRepresentationProxy.h"
-#include "vtkSMParaViewPipelineControllerWithRendering.h"
-#include "vtkSMPropertyHelper.h"
-#include "vtkSMSessionProxyManager.h"
-#include "vtkSMSourceProxy.h"
-#include "vtkSMViewProxy.h"
-#include "vtkSmartPointer.h"
+#include "ScalarsComboBox.h"
+
+#include <pqCoreUtilities.h>
+#include <vtkActor.h>
+#include <vtkCommand.h>
+#include <vtkCompositePolyDataMapper2.h>
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkMultiBlockDataSet.h>
+#include <vtkPVRenderView.h>
+#include <vtkPointData.h>
+#include <vtkProperty.h>
+#include <vtkSMPropertyHelper.h>
+#include <vtkSMProxy.h>
+#include <vtkSMSessionProxyManager.h>
+#include <vtkSMSourceProxy.h>
+#include <vtkSMViewProxy.h>
+#include <vtkScalarsToColors.h>
 
 #include <QCheckBox>
 #include <QComboBox>
+#include <QElapsedTimer>
 #include <QFormLayout>
+#include <QLabel>
+#include <QSignalBlocker>
 #include <QVBoxLayout>
+
 namespace tomviz {
 
 ModuleThreshold::ModuleThreshold(QObject* parentObject) : Module(parentObject)
@@ -46,220 +53,304 @@ bool ModuleThreshold::initialize(DataSource* data, vtkSMViewProxy* vtkView)
     return false;
   }
 
-  auto producer = data->proxy();
-
-  vtkNew<vtkSMParaViewPipelineControllerWithRendering> controller;
-
-  vtkSMSessionProxyManager* pxm = producer->GetSessionProxyManager();
-
-  // Create the contour filter.
-  vtkSmartPointer<vtkSMProxy> proxy;
-  proxy.TakeReference(pxm->NewProxy("filters", "Threshold"));
-
-  m_thresholdFilter = vtkSMSourceProxy::SafeDownCast(proxy);
-  Q_ASSERT(m_thresholdFilter);
-  controller->PreInitializeProxy(m_thresholdFilter);
-  vtkSMPropertyHelper(m_thresholdFilter, "Input").Set(producer);
-  controller->PostInitializeProxy(m_thresholdFilter);
-  controller->RegisterPipelineProxy(m_thresholdFilter);
-
-  // Update min/max to avoid thresholding the full dataset.
-  vtkSMPropertyHelper rangeProperty(m_thresholdFilter, "ThresholdBetween");
-  double range[2], newRange[2];
-  rangeProperty.Get(range, 2);
-  double delta = (range[1] - range[0]);
-  double mid = ((range[0] + range[1]) / 2.0);
-  newRange[0] = mid - 0.1 * delta;
-  newRange[1] = mid + 0.1 * delta;
-  rangeProperty.Set(newRange, 2);
-  m_thresholdFilter->UpdateVTKObjects();
-
-  // Create the representation for it.
-  m_thresholdRepresentation = controller->Show(m_thresholdFilter, 0, vtkView);
-  Q_ASSERT(m_thresholdRepresentation);
-  vtkSMRepresentationProxy::SetRepresentationType(m_thresholdRepresentation,
-                                                  "Surface");
-  vtkSMPropertyHelper(m_thresholdRepresentation, "Position")
-    .Set(data->displayPosition(), 3);
-  updateColorMap();
-  m_thresholdRepresentation->UpdateVTKObjects();
-
-  // Give the proxy a friendly name for the GUI/Python world.
-  if (auto p = convert<pqProxy*>(proxy)) {
-    p->rename(label());
+  m_mapper->SetInputDataObject(m_surface.output());
+  m_mapper->UseLookupTableScalarRangeOn();
+  m_mapper->SetColorModeToMapScalars();
+  m_actor->SetMapper(m_mapper.Get());
+  const double* displayPosition = data->displayPosition();
+  m_actor->SetPosition(displayPosition[0], displayPosition[1],
+                       displayPosition[2]);
+
+  // Start from the middle fifth of the range to avoid thresholding the full
+  // dataset.
+  auto image = vtkImageData::SafeDownCast(data->dataObject());
+  vtkDataArray* scalars =
+    image ? image->GetPointData()->GetArray(
+              scalarArrayName().toLatin1().data())
+          : nullptr;
+  double range[2] = { 0.0, 1.0 };
+  if (scalars) {
+    scalars->GetRange(range, 0);
   }
+  const double delta = range[1] - range[0];
+  const double mid = (range[0] + range[1]) / 2.0;
+  const double newRange[2] = { mid - 0.1 * delta, mid + 0.1 * delta };
+  m_surface.setRange(newRange[0], newRange[1]);
+
+  // The properties panel and animation proxies, the module follows them.
+  vtkSMSessionProxyManager* pxm = data->proxy()->GetSessionProxyManager();
+  m_thresholdProxy.TakeReference(pxm->NewProxy("tomviz_proxies", "Threshold"));
+  m_representationProxy.TakeReference(
+    pxm->NewProxy("tomviz_proxies", "ThresholdRepresentation"));
+  vtkSMPropertyHelper(m_thresholdProxy, "ThresholdBetween").Set(newRange, 2);
+  auto property = m_actor->GetProperty();
+  vtkSMPropertyHelper(m_representationProxy, "Representation")
+    .Set(property->GetRepresentation());
+  vtkSMPropertyHelper(m_representationProxy, "Opacity")
+    .Set(property->GetOpacity());
+  vtkSMPropertyHelper(m_representationProxy, "Specular")
+    .Set(property->GetSpecular());
+  pqCoreUtilities::connect(m_thresholdProxy, vtkCommand::PropertyModifiedEvent,
+                           this, SLOT(onPropertyChanged()));
+  pqCoreUtilities::connect(m_representationProxy,
+                           vtkCommand::PropertyModifiedEvent, this,
+                           SLOT(onPropertyChanged()));
 
-  connect(data, SIGNAL(activeScalarsChanged()), SLOT(onScalarArrayChanged()));
+  updateColorMap();
   onScalarArrayChanged();
 
+  m_view = vtkPVRenderView::SafeDownCast(vtkView->GetClientSideView());
+  m_view->AddPropToRenderer(m_actor.Get());
+  m_view->Update();
+
+  connect(data, &DataSource::activeScalarsChanged, this,
+          &ModuleThreshold::onScalarArrayChanged);
+  connect(data, &DataSource::dataChanged, this,
+          &ModuleThreshold::onScalarArrayChanged);
+  connect(data, &DataSource::brickRangeIndexReady, this,
+          [this](const QString& arrayName) {
+            if (arrayName == scalarArrayName()) {
+              m_surface.setIndex(dataSource()->brickRangeIndex(arrayName));
+            }
+          });
+
   return true;
 }
 
 void ModuleThreshold::updateColorMap()
 {
-  Q_ASSERT(m_thresholdRepresentation);
-
-  // by default, use the data source's color/opacity maps.
-  vtkSMPropertyHelper(m_thresholdRepresentation, "LookupTable").Set(colorMap());
-  vtkSMPropertyHelper(m_thresholdRepresentation, "ScalarOpacityFunction")
-    .Set(opacityMap());
-
-  m_thresholdRepresentation->UpdateVTKObjects();
+  // by default, use the data source's color map.
+  m_mapper->SetLookupTable(
+    vtkScalarsToColors::SafeDownCast(colorMap()->GetClientSideObject()));
 }
 
 bool ModuleThreshold::finalize()
 {
-  vtkNew<vtkSMParaViewPipelineControllerWithRendering> controller;
-  controller->UnRegisterProxy(m_thresholdRepresentation);
-  controller->UnRegisterProxy(m_thresholdFilter);
-  m_thresholdFilter = nullptr;
-  m_thresholdRepresentation = nullptr;
+  if (m_view) {
+    m_view->RemovePropFromRenderer(m_actor.Get());
+    m_view = nullptr;
+  }
   return true;
 }
 
 bool ModuleThreshold::setVisibility(bool val)
 {
-  Q_ASSERT(m_thresholdRepresentation);
-  vtkSMPropertyHelper(m_thresholdRepresentation, "Visibility").Set(val ? 1 : 0);
-  m_thresholdRepresentation->UpdateVTKObjects();
+  m_actor->SetVisibility(val ? 1 : 0);
   return true;
 }
 
 bool ModuleThreshold::visibility() const
 {
-  if (m_thresholdRepresentation) {
-    return vtkSMPropertyHelper(m_thresholdRepresentation, "Visibility")
-             .GetAsInt() != 0;
-  } else {
-    return false;
-  }
+  return m_actor->GetVisibility() != 0;
 }
 
 void ModuleThreshold::addToPanel(QWidget* panel)
 {
-  Q_ASSERT(m_thresholdFilter);
-  Q_ASSERT(m_thresholdRepresentation);
-
   if (panel->layout()) {
     delete panel->layout();
   }
 
   QVBoxLayout* layout = new QVBoxLayout;
-
-  pqStringVectorPropertyWidget* arraySelection =
-    new pqStringVectorPropertyWidget(
-      m_thresholdFilter->GetProperty("SelectInputScalars"),
-      m_thresholdFilter.Get());
-  layout->addWidget(arraySelection);
-
-  pqDoubleRangeSliderPropertyWidget* range =
-    new pqDoubleRangeSliderPropertyWidget(
-      m_thresholdFilter.Get(),
-      m_thresholdFilter->GetProperty("ThresholdBetween"));
-  range->setProperty(m_thresholdFilter->GetProperty("ThresholdBetween"));
-  layout->addWidget(range);
-
   QFormLayout* formLayout = new QFormLayout;
   formLayout->setHorizontalSpacing(5);
   layout->addItem(formLayout);
 
-  QComboBox* representations = new QComboBox;
-  representations->addItem("Surface");
-  representations->addItem("Wireframe");
-  representations->addItem("Points");
-  formLayout->addRow("Representation", representations);
+  m_scalarsCombo = new ScalarsComboBox();
+  m_scalarsCombo->setOptions(dataSource(), this);
+  formLayout->addRow("Active Scalars", m_scalarsCombo);
+
+  m_minimumSlider = new DoubleSliderWidget(true);
+  m_minimumSlider->setLineEditWidth(50);
+  formLayout->addRow("Minimum", m_minimumSlider);
+
+  m_maximumSlider = new DoubleSliderWidget(true);
+  m_maximumSlider->setLineEditWidth(50);
+  formLayout->addRow("Maximum", m_maximumSlider);
+
+  m_representations = new QComboBox;
+  m_representations->addItem("Surface", VTK_SURFACE);
+  m_representations->addItem("Wireframe", VTK_WIREFRAME);
+  m_representations->addItem("Points", VTK_POINTS);
+  formLayout->addRow("Representation", m_representations);
+
+  m_opacitySlider = new DoubleSliderWidget(true);
+  m_opacitySlider->setLineEditWidth(50);
+  formLayout->addRow("Opacity", m_opacitySlider);
 
-  DoubleSliderWidget* opacitySlider = new DoubleSliderWidget(true);
-  opacitySlider->setLineEditWidth(50);
-  formLayout->addRow("Opacity", opacitySlider);
+  m_specularSlider = new DoubleSliderWidget(true);
+  m_specularSlider->setLineEditWidth(50);
+  formLayout->addRow("Specular", m_specularSlider);
 
-  DoubleSliderWidget* specularSlider = new DoubleSliderWidget(true);
-  specularSlider->setLineEditWidth(50);
-  formLayout->addRow("Specular", specularSlider);
+  m_mapScalarsCheckBox = new QCheckBox();
+  formLayout->addRow("Color Map Data", m_mapScalarsCheckBox);
 
-  QCheckBox* mapScalarsCheckBox = new QCheckBox();
-  formLayout->addRow("Color Map Data", mapScalarsCheckBox);
+  m_statistics = new QLabel;
+  m_statistics->setWordWrap(true);
+  layout->addWidget(m_statistics);
 
   layout->addStretch();
   panel->setLayout(layout);
-
-  pqSignalAdaptorComboBox* adaptor =
-    new pqSignalAdaptorComboBox(representations);
-
-  m_links.addPropertyLink(
-    adaptor, "currentText", SIGNAL(currentTextChanged(QString)),
-    m_thresholdRepresentation,
-    m_thresholdRepresentation->GetProperty("Representation"));
-
-  m_links.addPropertyLink(opacitySlider, "value", SIGNAL(valueEdited(double)),
-                          m_thresholdRepresentation,
-                          m_thresholdRepresentation->GetProperty("Opacity"), 0);
-  m_links.addPropertyLink(specularSlider, "value", SIGNAL(valueEdited(double)),
-                          m_thresholdRepresentation,
-                          m_thresholdRepresentation->GetProperty("Specular"),
-                          0);
-
-  m_links.addPropertyLink(mapScalarsCheckBox, "checked", SIGNAL(toggled(bool)),
-                          m_thresholdRepresentation,
-                          m_thresholdRepresentation->GetProperty("MapScalars"),
-                          0);
-
-  connect(arraySelection, &pqPropertyWidget::changeFinished, arraySelection,
-          &pqPropertyWidget::apply);
-  connect(arraySelection, &pqPropertyWidget::changeFinished, this,
-          &Module::renderNeeded);
-  connect(range, &pqPropertyWidget::changeFinished, range,
-          &pqPropertyWidget::apply);
-  connect(range, &pqPropertyWidget::changeFinished, this,
-          &Module::renderNeeded);
-  connect(representations, &QComboBox::currentTextChanged, this,
+  updatePanel();
+
+  connect(m_scalarsCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+          this, [this](int idx) {
+            setActiveScalars(m_scalarsCombo->itemData(idx).toInt());
+            onScalarArrayChanged();
+          });
+  connect(m_minimumSlider, &DoubleSliderWidget::valueEdited, this,
+          [this](double value) {
+            setThresholdRange(value, m_surface.range()[1]);
+          });
+  connect(m_maximumSlider, &DoubleSliderWidget::valueEdited, this,
+          [this](double value) {
+            setThresholdRange(m_surface.range()[0], value);
+          });
+  connect(m_representations,
+          QOverload<int>::of(&QComboBox::currentIndexChanged), this,
           &ModuleThreshold::dataUpdated);
-  connect(opacitySlider, &DoubleSliderWidget::valueEdited, this,
+  connect(m_opacitySlider, &DoubleSliderWidget::valueEdited, this,
           &ModuleThreshold::dataUpdated);
-  connect(specularSlider, &DoubleSliderWidget::valueEdited, this,
+  connect(m_specularSlider, &DoubleSliderWidget::valueEdited, this,
           &ModuleThreshold::dataUpdated);
-  connect(mapScalarsCheckBox, &QCheckBox::toggled, this,
+  connect(m_mapScalarsCheckBox, &QCheckBox::toggled, this,
           &ModuleThreshold::dataUpdated);
 }
 
+void ModuleThreshold::updatePanel()
+{
+  if (!m_minimumSlider || !m_maximumSlider) {
+    return;
+  }
+
+  auto image = vtkImageData::SafeDownCast(dataSource()->dataObject());
+  vtkDataArray* scalars =
+    image ? image->GetPointData()->GetArray(
+              scalarArrayName().toLatin1().data())
+          : nullptr;
+  double range[2] = { 0.0, 1.0 };
+  if (scalars) {
+    scalars->GetRange(range, 0);
+  }
+  for (auto slider : { m_minimumSlider, m_maximumSlider }) {
+    slider->setMinimum(range[0]);
+    slider->setMaximum(range[1]);
+  }
+  m_minimumSlider->setValue(m_surface.range()[0]);
+  m_maximumSlider->setValue(m_surface.range()[1]);
+
+  QSignalBlocker representationsBlocker(m_representations);
+  QSignalBlocker mapScalarsBlocker(m_mapScalarsCheckBox);
+  auto property = m_actor->GetProperty();
+  m_representations->setCurrentIndex(
+    m_representations->findData(property->GetRepresentation()));
+  m_opacitySlider->setValue(property->GetOpacity());
+  m_specularSlider->setValue(property->GetSpecular());
+  m_mapScalarsCheckBox->setChecked(m_mapper->GetColorMode() ==
+                                   VTK_COLOR_MODE_MAP_SCALARS);
+
+  if (m_statistics) {
+    m_statistics->setText(
+      QString("%1 faces for %2 cells, %3 MB, updated in %4 ms")
+        .arg(m_surface.numberOfFaces())
+        .arg(m_surface.numberOfSelectedCells())
+        .arg(m_surface.memorySize() / (1024.0 * 1024.0), 0, 'f', 1)
+        .arg(m_updateTime, 0, 'f', 1));
+  }
+}
+
 void ModuleThreshold::dataUpdated()
 {
-  m_links.accept();
+  if (!m_representations || !m_opacitySlider || !m_specularSlider ||
+      !m_mapScalarsCheckBox) {
+    return;
+  }
+  // Read every widget first, each property set refreshes the panel.
+  const int representation = m_representations->currentData().toInt();
+  const double opacity = m_opacitySlider->value();
+  const double specular = m_specularSlider->value();
+  const int mapScalars = m_mapScalarsCheckBox->isChecked() ? 1 : 0;
+  vtkSMPropertyHelper(m_representationProxy, "Representation")
+    .Set(representation);
+  vtkSMPropertyHelper(m_representationProxy, "Opacity").Set(opacity);
+  vtkSMPropertyHelper(m_representationProxy, "Specular").Set(specular);
+  vtkSMPropertyHelper(m_representationProxy, "MapScalars").Set(mapScalars);
+}
+
+void ModuleThreshold::onPropertyChanged()
+{
+  auto property = m_actor->GetProperty();
+  property->SetRepresentation(
+    vtkSMPropertyHelper(m_representationProxy, "Representation").GetAsInt());
+  property->SetOpacity(
+    vtkSMPropertyHelper(m_representationProxy, "Opacity").GetAsDouble());
+  property->SetSpecular(
+    vtkSMPropertyHelper(m_representationProxy, "Specular").GetAsDouble());
+  m_mapper->SetColorMode(
+    vtkSMPropertyHelper(m_representationProxy, "MapScalars").GetAsInt()
+      ? VTK_COLOR_MODE_MAP_SCALARS
+      : VTK_COLOR_MODE_DEFAULT);
+
+  double range[2];
+  vtkSMPropertyHelper(m_thresholdProxy, "ThresholdBetween").Get(range, 2);
+  if (range[0] != m_surface.range()[0] || range[1] != m_surface.range()[1]) {
+    m_surface.setRange(range[0], range[1]);
+    updateSurface();
+  } else {
+    updatePanel();
+  }
   emit renderNeeded();
 }
 
-void ModuleThreshold::onScalarArrayChanged()
+void ModuleThreshold::setThresholdRange(double minimum, double maximum)
 {
-  QString arrayName = dataSource()->activeScalars();
-  vtkSMPropertyHelper(m_thresholdRepresentation, "ColorArrayName")
-    .SetInputArrayToProcess(vtkDataObject::FIELD_ASSOCIATION_POINTS,
-                            arrayName.toLatin1().data());
-  m_thresholdRepresentation->UpdateVTKObjects();
+  const double range[2] = { minimum, maximum };
+  vtkSMPropertyHelper(m_thresholdProxy, "ThresholdBetween").Set(range, 2);
+}
+
+QString ModuleThreshold::scalarArrayName() const
+{
+  if (activeScalars() == Module::DEFAULT_SCALARS) {
+    return dataSource()->activeScalars();
+  }
+  return dataSource()->scalarsName(activeScalars());
+}
 
+void ModuleThreshold::onScalarArrayChanged()
+{
+  // The surface is extracted without the brick index until it is built.
+  auto image = vtkImageData::SafeDownCast(dataSource()->dataObject());
+  const QString name = scalarArrayName();
+  auto index = dataSource()->brickRangeIndex(name);
+  m_surface.setInput(image, name.toStdString(), index);
+  if (!index) {
+    dataSource()->buildBrickRangeIndex(name);
+  }
+  updateSurface();
   emit renderNeeded();
 }
 
+void ModuleThreshold::updateSurface()
+{
+  QElapsedTimer timer;
+  timer.start();
+  m_surface.update();
+  m_updateTime = timer.nsecsElapsed() / 1.0e6;
+  updatePanel();
+}
+
 QJsonObject ModuleThreshold::serialize() const
 {
   auto json = Module::serialize();
   auto props = json["properties"].toObject();
 
-  auto rep = m_thresholdRepresentation;
-  vtkSMPropertyHelper scalars(m_thresholdFilter, "SelectInputScalars");
-  props["scalarArray"] = scalars.GetAsInt();
-  double range[2];
-  vtkSMPropertyHelper minMax(m_thresholdFilter, "ThresholdBetween");
-  minMax.Get(range, 2);
-  props["minimum"] = range[0];
-  props["maximum"] = range[1];
-  vtkSMPropertyHelper representationHelper(rep->GetProperty("Representation"));
-  props["representation"] = representationHelper.GetAsString();
-  vtkSMPropertyHelper specular(rep->GetProperty("Specular"));
-  props["specular"] = specular.GetAsDouble();
-  vtkSMPropertyHelper opacity(rep->GetProperty("Opacity"));
-  props["opacity"] = opacity.GetAsDouble();
-  vtkSMPropertyHelper mapScalars(rep->GetProperty("MapScalars"));
-  props["mapScalars"] = mapScalars.GetAsInt() == 1;
+  props["scalarArray"] = scalarArrayName();
+  props["minimum"] = m_surface.range()[0];
+  props["maximum"] = m_surface.range()[1];
+  auto property = m_actor->GetProperty();
+  props["representation"] = property->GetRepresentationAsString();
+  props["specular"] = property->GetSpecular();
+  props["opacity"] = property->GetOpacity();
+  props["mapScalars"] = m_mapper->GetColorMode() == VTK_COLOR_MODE_MAP_SCALARS;
 
   json["properties"] = props;
 
@@ -273,23 +364,32 @@ bool ModuleThreshold::deserialize(const QJsonObject& json)
   }
   if (json["properties"].isObject()) {
     auto props = json["properties"].toObject();
-    auto rep = m_thresholdRepresentation;
-    vtkSMPropertyHelper scalars(m_thresholdFilter, "SelectInputScalars");
-    scalars.Set(props["scalarArray"].toInt());
-    double range[2] = { props["minimum"].toDouble(),
-                        props["maximum"].toDouble() };
-    vtkSMPropertyHelper minMax(m_thresholdFilter, "ThresholdBetween");
-    minMax.Set(range, 2);
-    vtkSMPropertyHelper repHelper(rep, "Representation");
-    repHelper.Set(props["representation"].toString().toStdString().c_str());
-    vtkSMPropertyHelper specular(rep, "Specular");
-    specular.Set(props["specular"].toDouble());
-    vtkSMPropertyHelper opacity(rep, "Opacity");
-    opacity.Set(props["opacity"].toDouble());
-    vtkSMPropertyHelper mapScalars(rep, "MapScalars");
-    mapScalars.Set(props["mapScalars"].toBool() ? 1 : 0);
-    m_thresholdFilter->UpdateVTKObjects();
-    rep->UpdateVTKObjects();
+    auto representation = props["representation"].toString();
+    int type = VTK_SURFACE;
+    if (representation == "Wireframe") {
+      type = VTK_WIREFRAME;
+    } else if (representation == "Points") {
+      type = VTK_POINTS;
+    }
+    vtkSMPropertyHelper(m_representationProxy, "Representation").Set(type);
+    vtkSMPropertyHelper(m_representationProxy, "Specular")
+      .Set(props["specular"].toDouble());
+    vtkSMPropertyHelper(m_representationProxy, "Opacity")
+      .Set(props["opacity"].toDouble());
+    vtkSMPropertyHelper(m_representationProxy, "MapScalars")
+      .Set(props["mapScalars"].toBool() ? 1 : 0);
+    // The array is also stored by name, as it was when the module ran a
+    // threshold filter, older states only record it there.
+    const QString arrayName = props["scalarArray"].toString();
+    if (!arrayName.isEmpty() && arrayName != scalarArrayName()) {
+      const int index = dataSource()->listScalars().indexOf(arrayName);
+      if (index >= 0) {
+        setActiveScalars(index);
+      }
+    }
+    setThresholdRange(props["minimum"].toDouble(),
+                      props["maximum"].toDouble());
+    onScalarArrayChanged();
     return true;
   }
   return false;
@@ -297,23 +397,21 @@ bool ModuleThreshold::deserialize(const QJsonObject& json)
 
 void ModuleThreshold::dataSourceMoved(double newX, double newY, double newZ)
 {
-  double pos[3] = { newX, newY, newZ };
-  vtkSMPropertyHelper(m_thresholdRepresentation, "Position").Set(pos, 3);
-  m_thresholdRepresentation->UpdateVTKObjects();
+  m_actor->SetPosition(newX, newY, newZ);
 }
 
 //-----------------------------------------------------------------------------
 bool ModuleThreshold::isProxyPartOfModule(vtkSMProxy* proxy)
 {
-  return (proxy == m_thresholdFilter.Get()) ||
-         (proxy == m_thresholdRepresentation.Get());
+  return proxy == m_thresholdProxy.Get() ||
+         proxy == m_representationProxy.Get();
 }
 
 std::string ModuleThreshold::getStringForProxy(vtkSMProxy* proxy)
 {
-  if (proxy == m_thresholdFilter.Get()) {
+  if (proxy == m_thresholdProxy.Get()) {
     return "Threshold";
-  } else if (proxy == m_thresholdRepresentation.Get()) {
+  } else if (proxy == m_representationProxy.Get()) {
     return "Representation";
   } else {
     qWarning("Unknown proxy passed to module threshold in save animation");
@@ -324,9 +422,9 @@ std::string ModuleThreshold::getStringForProxy(vtkSMProxy* proxy)
 vtkSMProxy* ModuleThreshold::getProxyForString(const std::string& str)
 {
   if (str == "Threshold") {
-    return m_thresholdFilter.Get();
+    return m_thresholdProxy.Get();
   } else if (str == "Representation") {
-    return m_thresholdRepresentation.Get();
+    return m_representationProxy.Get();
   } else {
     return nullptr;
   }
@@ -6,14 +6,34 @@
 
 #include "Module.h"
 
-#include <pqPropertyLinks.h>
+#include "ThresholdSurface.h"
+
+#include <vtkNew.h>
+#include <vtkSmartPointer.h>
 #include <vtkWeakPointer.h>
 
+#include <QPointer>
+
+class QCheckBox;
+class QComboBox;
+class QLabel;
+
+class vtkActor;
+class vtkCompositePolyDataMapper2;
+class vtkPVRenderView;
 class vtkSMProxy;
-class vtkSMSourceProxy;
 
 namespace tomviz {
 
+class DoubleSliderWidget;
+class ScalarsComboBox;
+
+/// Shows the cells of the data selected by a scalar range. Rather than
+/// building an unstructured grid with the Threshold filter, only the
+/// boundary faces of the selected cells are extracted, straight from the
+/// image, see ThresholdSurface. The range and the display settings live in
+/// the "Threshold" and "ThresholdRepresentation" proxies so they can be
+/// animated like the properties of the other modules.
 class ModuleThreshold : public Module
 {
   Q_OBJECT
@@ -38,6 +58,8 @@ public:
 
   bool isProxyPartOfModule(vtkSMProxy* proxy) override;
 
+  void setThresholdRange(double minimum, double maximum);
+
 protected:
   void updateColorMap() override;
   std::string getStringForProxy(vtkSMProxy* proxy) override;
@@ -46,14 +68,32 @@ protected:
 private slots:
   void dataUpdated();
 
+  void onPropertyChanged();
   void onScalarArrayChanged();
 
 private:
   Q_DISABLE_COPY(ModuleThreshold)
 
-  pqPropertyLinks m_links;
-  vtkWeakPointer<vtkSMSourceProxy> m_thresholdFilter;
-  vtkWeakPointer<vtkSMProxy> m_thresholdRepresentation;
+  QString scalarArrayName() const;
+  void updateSurface();
+  void updatePanel();
+
+  vtkWeakPointer<vtkPVRenderView> m_view;
+  vtkSmartPointer<vtkSMProxy> m_thresholdProxy;
+  vtkSmartPointer<vtkSMProxy> m_representationProxy;
+  ThresholdSurface m_surface;
+  vtkNew<vtkCompositePolyDataMapper2> m_mapper;
+  vtkNew<vtkActor> m_actor;
+
+  QPointer<ScalarsComboBox> m_scalarsCombo;
+  QPointer<DoubleSliderWidget> m_minimumSlider;
+  QPointer<DoubleSliderWidget> m_maximumSlider;
+  QPointer<QComboBox> m_representations;
+  QPointer<DoubleSliderWidget> m_opacitySlider;
+  QPointer<DoubleSliderWidget> m_specularSlider;
+  QPointer<QCheckBox> m_mapScalarsCheckBox;
+  QPointer<QLabel> m_statistics;
+  double m_updateTime = 0.0;
 };
 } // namespace tomviz
 
@@ -4,12 +4,14 @@
 #include "ModuleVolume.h"
 #include "ModuleVolumeWidget.h"
 
+#include "CpuVolumeRendering.h"
 #include "DataSource.h"
 #include "HistogramManager.h"
 #include "ScalarsComboBox.h"
 #include "vtkTransferFunctionBoxItem.h"
 
 #include <vtkColorTransferFunction.h>
+#include <vtkFixedPointVolumeRayCastMapper.h>
 #include <vtkGPUVolumeRayCastMapper.h>
 #include <vtkImageData.h>
 #include <vtkNew.h>
@@ -86,6 +88,9 @@ bool ModuleVolume::initialize(DataSource* data, vtkSMViewProxy* vtkView)
                         displayPosition[2]);
   m_volumeMapper->UseJitteringOn();
   m_volumeMapper->SetBlendMode(vtkVolumeMapper::COMPOSITE_BLEND);
+  CpuVolumeRendering::setup(m_cpuVolumeMapper.GetPointer(),
+                            m_imageData.GetPointer());
+  m_cpuVolumeMapper->SetBlendMode(vtkVolumeMapper::COMPOSITE_BLEND);
   m_volumeProperty->SetInterpolationType(VTK_LINEAR_INTERPOLATION);
   m_volumeProperty->SetAmbient(0.0);
   m_volumeProperty->SetDiffuse(1.0);
@@ -184,6 +189,7 @@ QJsonObject ModuleVolume::serialize() const
   props["interpolation"] = m_volumeProperty->GetInterpolationType();
   props["blendingMode"] = m_volumeMapper->GetBlendMode();
   props["rayJittering"] = m_volumeMapper->GetUseJittering() == 1;
+  props["cpuRendering"] = m_cpuRendering;
 
   QJsonObject lighting;
   lighting["enabled"] = m_volumeProperty->GetShade() == 1;
@@ -208,6 +214,7 @@ bool ModuleVolume::deserialize(const QJsonObject& json)
     setTransferMode(
       static_cast<Module::TransferMode>(props["transferMode"].toInt()));
     onInterpolationChanged(props["interpolation"].toInt());
+    setCpuRendering(props["cpuRendering"].toBool());
     setBlendingMode(props["blendingMode"].toInt());
     setJittering(props["rayJittering"].toBool());
 
@@ -248,6 +255,8 @@ void ModuleVolume::addToPanel(QWidget* panel)
 
   connect(m_controllers, SIGNAL(jitteringToggled(const bool)), this,
           SLOT(setJittering(const bool)));
+  connect(m_controllers, SIGNAL(cpuRenderingToggled(const bool)), this,
+          SLOT(setCpuRendering(const bool)));
   connect(m_controllers, SIGNAL(lightingToggled(const bool)), this,
           SLOT(setLighting(const bool)));
   connect(m_controllers, SIGNAL(blendingChanged(const int)), this,
@@ -281,6 +290,7 @@ void ModuleVolume::updatePanel()
   }
   m_controllers->setJittering(
     static_cast<bool>(m_volumeMapper->GetUseJittering()));
+  m_controllers->setCpuRendering(m_cpuRendering);
   m_controllers->setLighting(static_cast<bool>(m_volumeProperty->GetShade()));
   m_controllers->setBlendingMode(m_volumeMapper->GetBlendMode());
   m_controllers->setAmbient(m_volumeProperty->GetAmbient());
@@ -370,6 +380,9 @@ void ModuleVolume::setLighting(const bool val)
 void ModuleVolume::setBlendingMode(const int mode)
 {
   m_volumeMapper->SetBlendMode(mode);
+  m_cpuVolumeMapper->SetBlendMode(CpuVolumeRendering::supportsBlendMode(mode)
+                                    ? mode
+                                    : vtkVolumeMapper::COMPOSITE_BLEND);
   emit renderNeeded();
 }
 
@@ -379,6 +392,20 @@ void ModuleVolume::setJittering(const bool val)
   emit renderNeeded();
 }
 
+void ModuleVolume::setCpuRendering(const bool val)
+{
+  m_cpuRendering = val;
+  if (val) {
+    // The spacing may have changed since the mapper was set up.
+    CpuVolumeRendering::setup(m_cpuVolumeMapper.GetPointer(),
+                              m_imageData.GetPointer());
+    m_volume->SetMapper(m_cpuVolumeMapper.Get());
+  } else {
+    m_volume->SetMapper(m_volumeMapper.Get());
+  }
+  emit renderNeeded();
+}
+
 void ModuleVolume::onScalarArrayChanged()
 {
   QString arrayName;
@@ -16,6 +16,7 @@ class vtkSMSourceProxy;
 
 class vtkPVRenderView;
 
+class vtkFixedPointVolumeRayCastMapper;
 class vtkGPUVolumeRayCastMapper;
 class vtkVolumeProperty;
 class vtkVolume;
@@ -68,6 +69,8 @@ private:
   vtkNew<vtkImageData> m_imageData;
   vtkNew<vtkVolume> m_volume;
   vtkNew<vtkGPUVolumeRayCastMapper> m_volumeMapper;
+  vtkNew<vtkFixedPointVolumeRayCastMapper> m_cpuVolumeMapper;
+  bool m_cpuRendering = false;
   vtkNew<vtkVolumeProperty> m_volumeProperty;
   QPointer<ModuleVolumeWidget> m_controllers;
   QPointer<ScalarsComboBox> m_scalarsCombo;
@@ -81,6 +84,8 @@ private slots:
   void setBlendingMode(const int mode);
   void onInterpolationChanged(const int type);
   void setJittering(const bool val);
+  /// Render with the multi-threaded CPU ray caster instead of the GPU one.
+  void setCpuRendering(const bool val);
   void onAmbientChanged(const double value);
   void onDiffuseChanged(const double value);
   void onSpecularChanged(const double value);
@@ -47,6 +47,8 @@ ModuleVolumeWidget::ModuleVolumeWidget(QWidget* parent_)
 
   connect(m_ui->cbJittering, SIGNAL(toggled(bool)), this,
           SIGNAL(jitteringToggled(const bool)));
+  connect(m_ui->cbCpuRendering, SIGNAL(toggled(bool)), this,
+          SLOT(onCpuRenderingToggled(const bool)));
   connect(m_ui->cbBlending, SIGNAL(currentIndexChanged(int)), this,
           SLOT(onBlendingChanged(const int)));
   connect(m_ui->cbInterpolation, SIGNAL(currentIndexChanged(int)), this,
@@ -73,6 +75,19 @@ void ModuleVolumeWidget::setJittering(const bool enable)
   m_ui->cbJittering->setChecked(enable);
 }
 
+void ModuleVolumeWidget::setCpuRendering(const bool enable)
+{
+  // The CPU ray caster does not jitter its rays.
+  m_ui->cbJittering->setEnabled(!enable);
+  m_ui->cbCpuRendering->setChecked(enable);
+}
+
+void ModuleVolumeWidget::onCpuRenderingToggled(const bool state)
+{
+  m_ui->cbJittering->setEnabled(!state);
+  emit cpuRenderingToggled(state);
+}
+
 void ModuleVolumeWidget::setBlendingMode(const int mode)
 {
   m_uiLighting->gbLighting->setEnabled(usesLighting(mode));
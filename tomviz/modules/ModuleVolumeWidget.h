@@ -39,6 +39,7 @@ public:
    */
   void setActiveScalars(const QString& scalars);
   void setJittering(const bool enable);
+  void setCpuRendering(const bool enable);
   void setBlendingMode(const int mode);
   void setInterpolationType(const int type);
   void setLighting(const bool enable);
@@ -56,6 +57,7 @@ signals:
    * Forwarded signals.
    */
   void jitteringToggled(const bool state);
+  void cpuRenderingToggled(const bool state);
   void blendingChanged(const int state);
   void interpolationChanged(const int state);
   void lightingToggled(const bool state);
@@ -77,6 +79,7 @@ private:
 
 private slots:
   void onBlendingChanged(const int mode);
+  void onCpuRenderingToggled(const bool state);
 };
 } // namespace tomviz
 #endif
@@ -0,0 +1,178 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "BinOperator.h"
+
+#include "DataSource.h"
+#include "EditOperatorWidget.h"
+#include "Resample.h"
+
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QPointer>
+#include <QSpinBox>
+
+#include <algorithm>
+
+namespace {
+
+using tomviz::BinOperator;
+
+class BinWidget : public tomviz::EditOperatorWidget
+{
+  Q_OBJECT
+
+public:
+  BinWidget(BinOperator* source, QWidget* p)
+    : tomviz::EditOperatorWidget(p), m_operator(source)
+  {
+    auto factorsLayout = new QHBoxLayout;
+    for (int i = 0; i < 3; ++i) {
+      m_factors[i] = new QSpinBox(this);
+      m_factors[i]->setRange(1, 64);
+      m_factors[i]->setValue(source->factors()[i]);
+      factorsLayout->addWidget(m_factors[i]);
+    }
+
+    QFormLayout* layout = new QFormLayout;
+    layout->addRow("Factor (x, y, z)", factorsLayout);
+    setLayout(layout);
+  }
+
+  void applyChangesToOperator() override
+  {
+    if (m_operator) {
+      int factors[3];
+      for (int i = 0; i < 3; ++i) {
+        factors[i] = m_factors[i]->value();
+      }
+      m_operator->setFactors(factors);
+    }
+  }
+
+private:
+  QPointer<BinOperator> m_operator;
+  QSpinBox* m_factors[3];
+};
+
+template <typename T>
+bool binArray(vtkDataArray* input, const int inDims[3], const int factors[3],
+              vtkDataArray* output, const std::function<bool()>& canceled)
+{
+  return tomviz::Resample::bin(
+    static_cast<T*>(input->GetVoidPointer(0)), inDims,
+    input->GetNumberOfComponents(), factors,
+    static_cast<T*>(output->GetVoidPointer(0)), canceled);
+}
+} // namespace
+
+#include "BinOperator.moc"
+
+namespace tomviz {
+
+BinOperator::BinOperator(DataSource* dataSource, QObject* p) : Operator(p)
+{
+  setSupportsCancel(true);
+  if (dataSource && dataSource->type() == DataSource::TiltSeries) {
+    m_factors[2] = 1;
+  }
+}
+
+QIcon BinOperator::icon() const
+{
+  return QIcon();
+}
+
+bool BinOperator::applyTransform(vtkDataObject* data)
+{
+  vtkImageData* image = vtkImageData::SafeDownCast(data);
+  if (!image) {
+    return false;
+  }
+
+  int extent[6];
+  int inDims[3];
+  int outDims[3];
+  double spacing[3];
+  double origin[3];
+  image->GetExtent(extent);
+  image->GetDimensions(inDims);
+  image->GetSpacing(spacing);
+  image->GetOrigin(origin);
+  for (int i = 0; i < 3; ++i) {
+    outDims[i] = Resample::binnedSize(inDims[i], m_factors[i]);
+  }
+
+  auto canceled = [this]() { return isCanceled(); };
+  // Factors larger than an axis, such as those of the tilt angles along x
+  // and y, bin the whole axis.
+  const int* factors = m_factors;
+  auto bin = [&](vtkDataArray* input, const int in[3], const int[3],
+                 vtkDataArray* output) {
+    bool completed = false;
+    switch (input->GetDataType()) {
+      vtkTemplateMacro(completed = binArray<VTK_TT>(input, in, factors, output,
+                                                    canceled));
+    }
+    return completed;
+  };
+  if (!Resample::resampleImage(image, outDims, bin)) {
+    return false;
+  }
+
+  // Each voxel sits at the center of its box.
+  for (int i = 0; i < 3; ++i) {
+    const int factor = std::min(m_factors[i], inDims[i]);
+    origin[i] += (extent[2 * i] + (factor - 1) / 2.0) * spacing[i];
+    spacing[i] *= factor;
+  }
+  image->SetOrigin(origin);
+  image->SetSpacing(spacing);
+  return true;
+}
+
+Operator* BinOperator::clone() const
+{
+  auto other = new BinOperator();
+  other->setFactors(m_factors);
+  return initializeClone(other);
+}
+
+QJsonObject BinOperator::serialize() const
+{
+  auto json = Operator::serialize();
+  json["factors"] = QJsonArray({ m_factors[0], m_factors[1], m_factors[2] });
+  return json;
+}
+
+bool BinOperator::deserialize(const QJsonObject& json)
+{
+  if (json.contains("factors")) {
+    auto factors = json["factors"].toArray();
+    if (factors.size() == 3) {
+      for (int i = 0; i < 3; ++i) {
+        m_factors[i] = std::max(factors[i].toInt(1), 1);
+      }
+    }
+  }
+  return true;
+}
+
+EditOperatorWidget* BinOperator::getEditorContents(QWidget* p)
+{
+  return new BinWidget(this, p);
+}
+
+void BinOperator::setFactors(const int factors[3])
+{
+  for (int i = 0; i < 3; ++i) {
+    m_factors[i] = std::max(factors[i], 1);
+  }
+  emit transformModified();
+}
+} // namespace tomviz
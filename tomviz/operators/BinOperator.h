@@ -0,0 +1,45 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizBinOperator_h
+#define tomvizBinOperator_h
+
+#include "Operator.h"
+
+namespace tomviz {
+
+/// Native binning by integer factors, each voxel of the result is the
+/// average of a box of voxels. Replaces the Bin Volume x2 and Bin Tilt Image
+/// x2 Python operators, the default factors follow them: tilt series are
+/// binned within their images, other data along every axis. The tilt angles
+/// are binned along with the slices.
+class BinOperator : public Operator
+{
+  Q_OBJECT
+
+public:
+  BinOperator(DataSource* dataSource = nullptr, QObject* parent = nullptr);
+
+  QString label() const override { return "Bin"; }
+  QIcon icon() const override;
+  Operator* clone() const override;
+
+  QJsonObject serialize() const override;
+  bool deserialize(const QJsonObject& json) override;
+
+  EditOperatorWidget* getEditorContents(QWidget* parent) override;
+  bool hasCustomUI() const override { return true; }
+
+  void setFactors(const int factors[3]);
+  const int* factors() const { return m_factors; }
+
+protected:
+  bool applyTransform(vtkDataObject* data) override;
+
+private:
+  int m_factors[3] = { 2, 2, 2 };
+  Q_DISABLE_COPY(BinOperator)
+};
+} // namespace tomviz
+
+#endif
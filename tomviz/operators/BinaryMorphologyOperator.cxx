@@ -0,0 +1,228 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "BinaryMorphologyOperator.h"
+
+#include "CopyOnWrite.h"
+#include "EditOperatorWidget.h"
+#include "LabelMap.h"
+
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkPointData.h>
+
+#include <QComboBox>
+#include <QFormLayout>
+#include <QJsonObject>
+#include <QPointer>
+#include <QSpinBox>
+
+#include <limits>
+
+namespace {
+
+using tomviz::BinaryMorphologyOperator;
+
+class BinaryMorphologyWidget : public tomviz::EditOperatorWidget
+{
+  Q_OBJECT
+
+public:
+  BinaryMorphologyWidget(BinaryMorphologyOperator* source, QWidget* p)
+    : tomviz::EditOperatorWidget(p), m_operator(source)
+  {
+    m_element = new QComboBox(this);
+    m_element->addItem("Box");
+    m_element->addItem("Ball");
+    m_element->addItem("Cross");
+    m_element->setCurrentIndex(static_cast<int>(source->structuringElement()));
+
+    m_radius = new QSpinBox(this);
+    m_radius->setRange(1, 100);
+    m_radius->setValue(source->radius());
+
+    m_objectLabel = new QSpinBox(this);
+    m_objectLabel->setRange(std::numeric_limits<int>::min(),
+                            std::numeric_limits<int>::max());
+    m_objectLabel->setValue(source->objectLabel());
+
+    m_backgroundLabel = new QSpinBox(this);
+    m_backgroundLabel->setRange(std::numeric_limits<int>::min(),
+                                std::numeric_limits<int>::max());
+    m_backgroundLabel->setValue(source->backgroundLabel());
+
+    QFormLayout* layout = new QFormLayout;
+    layout->addRow("Structuring Element", m_element);
+    layout->addRow("Radius", m_radius);
+    layout->addRow("Object Label", m_objectLabel);
+    layout->addRow("Background Label", m_backgroundLabel);
+    setLayout(layout);
+  }
+
+  void applyChangesToOperator() override
+  {
+    if (m_operator) {
+      m_operator->setStructuringElement(
+        static_cast<BinaryMorphologyOperator::StructuringElement>(
+          m_element->currentIndex()));
+      m_operator->setRadius(m_radius->value());
+      m_operator->setObjectLabel(m_objectLabel->value());
+      m_operator->setBackgroundLabel(m_backgroundLabel->value());
+    }
+  }
+
+private:
+  QPointer<BinaryMorphologyOperator> m_operator;
+  QComboBox* m_element;
+  QSpinBox* m_radius;
+  QSpinBox* m_objectLabel;
+  QSpinBox* m_backgroundLabel;
+};
+
+template <typename T>
+bool applyMorphology(vtkDataArray* scalars, const int dims[3],
+                     BinaryMorphologyOperator* op,
+                     const std::function<bool()>& canceled)
+{
+  return tomviz::BinaryMorphology::apply(
+    static_cast<T*>(scalars->GetVoidPointer(0)), dims, op->operation(),
+    op->structuringElement(), op->radius(), static_cast<T>(op->objectLabel()),
+    static_cast<T>(op->backgroundLabel()), canceled);
+}
+} // namespace
+
+#include "BinaryMorphologyOperator.moc"
+
+namespace tomviz {
+
+BinaryMorphologyOperator::BinaryMorphologyOperator(Operation operation,
+                                                   QObject* p)
+  : Operator(p), m_operation(operation)
+{
+  setSupportsCancel(true);
+}
+
+QString BinaryMorphologyOperator::label() const
+{
+  switch (m_operation) {
+    case Operation::Dilate:
+      return "Binary Dilate";
+    case Operation::Erode:
+      return "Binary Erode";
+    case Operation::Open:
+      return "Binary Open";
+    case Operation::Close:
+      return "Binary Close";
+  }
+  return QString();
+}
+
+QIcon BinaryMorphologyOperator::icon() const
+{
+  return QIcon();
+}
+
+bool BinaryMorphologyOperator::applyTransform(vtkDataObject* data)
+{
+  vtkImageData* image = vtkImageData::SafeDownCast(data);
+  if (!image) {
+    return false;
+  }
+  vtkDataArray* scalars = image->GetPointData()->GetScalars();
+  if (!scalars || scalars->GetNumberOfComponents() != 1) {
+    return false;
+  }
+  // The scalars are filtered in place.
+  CopyOnWrite::detach(scalars);
+
+  int dims[3];
+  image->GetDimensions(dims);
+  bool completed = false;
+  auto canceled = [this]() { return isCanceled(); };
+  switch (scalars->GetDataType()) {
+    vtkTemplateMacro(completed = applyMorphology<VTK_TT>(scalars, dims, this,
+                                                         canceled));
+  }
+  if (!completed) {
+    return false;
+  }
+  scalars->Modified();
+
+  // The result is a label map, store it in the smallest type that holds its
+  // labels rather than the type of the data it was computed from.
+  auto compacted = LabelMap::compact(scalars);
+  if (compacted && compacted != scalars) {
+    image->GetPointData()->RemoveArray(scalars->GetName());
+    image->GetPointData()->SetScalars(compacted);
+  }
+  return true;
+}
+
+Operator* BinaryMorphologyOperator::clone() const
+{
+  auto other = new BinaryMorphologyOperator(m_operation);
+  other->setStructuringElement(m_element);
+  other->setRadius(m_radius);
+  other->setObjectLabel(m_objectLabel);
+  other->setBackgroundLabel(m_backgroundLabel);
+  return initializeClone(other);
+}
+
+QJsonObject BinaryMorphologyOperator::serialize() const
+{
+  auto json = Operator::serialize();
+  json["structuringElement"] = static_cast<int>(m_element);
+  json["radius"] = m_radius;
+  json["objectLabel"] = m_objectLabel;
+  json["backgroundLabel"] = m_backgroundLabel;
+  return json;
+}
+
+bool BinaryMorphologyOperator::deserialize(const QJsonObject& json)
+{
+  if (json.contains("structuringElement")) {
+    m_element =
+      static_cast<StructuringElement>(json["structuringElement"].toInt());
+  }
+  if (json.contains("radius")) {
+    m_radius = json["radius"].toInt();
+  }
+  if (json.contains("objectLabel")) {
+    m_objectLabel = json["objectLabel"].toInt();
+  }
+  if (json.contains("backgroundLabel")) {
+    m_backgroundLabel = json["backgroundLabel"].toInt();
+  }
+  return true;
+}
+
+EditOperatorWidget* BinaryMorphologyOperator::getEditorContents(QWidget* p)
+{
+  return new BinaryMorphologyWidget(this, p);
+}
+
+void BinaryMorphologyOperator::setStructuringElement(
+  StructuringElement element)
+{
+  m_element = element;
+  emit transformModified();
+}
+
+void BinaryMorphologyOperator::setRadius(int radius)
+{
+  m_radius = radius;
+  emit transformModified();
+}
+
+void BinaryMorphologyOperator::setObjectLabel(int label)
+{
+  m_objectLabel = label;
+  emit transformModified();
+}
+
+void BinaryMorphologyOperator::setBackgroundLabel(int label)
+{
+  m_backgroundLabel = label;
+  emit transformModified();
+}
+} // namespace tomviz
@@ -0,0 +1,64 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizBinaryMorphologyOperator_h
+#define tomvizBinaryMorphologyOperator_h
+
+#include "Operator.h"
+
+#include "BinaryMorphology.h"
+
+namespace tomviz {
+
+/// Native binary dilate, erode, open and close, replacing the ITK based
+/// Python operators of the same names and producing identical results.
+class BinaryMorphologyOperator : public Operator
+{
+  Q_OBJECT
+
+public:
+  using Operation = BinaryMorphology::Operation;
+  using StructuringElement = BinaryMorphology::StructuringElement;
+
+  BinaryMorphologyOperator(Operation operation, QObject* parent = nullptr);
+
+  QString label() const override;
+  QIcon icon() const override;
+  Operator* clone() const override;
+  bool supportsAllArrays() const override { return true; }
+  bool isReentrant() const override { return true; }
+
+  QJsonObject serialize() const override;
+  bool deserialize(const QJsonObject& json) override;
+
+  EditOperatorWidget* getEditorContents(QWidget* parent) override;
+  bool hasCustomUI() const override { return true; }
+
+  Operation operation() const { return m_operation; }
+
+  void setStructuringElement(StructuringElement element);
+  StructuringElement structuringElement() const { return m_element; }
+
+  void setRadius(int radius);
+  int radius() const { return m_radius; }
+
+  void setObjectLabel(int label);
+  int objectLabel() const { return m_objectLabel; }
+
+  void setBackgroundLabel(int label);
+  int backgroundLabel() const { return m_backgroundLabel; }
+
+protected:
+  bool applyTransform(vtkDataObject* data) override;
+
+private:
+  Operation m_operation;
+  StructuringElement m_element = StructuringElement::Box;
+  int m_radius = 1;
+  int m_objectLabel = 1;
+  int m_backgroundLabel = 0;
+  Q_DISABLE_COPY(BinaryMorphologyOperator)
+};
+} // namespace tomviz
+
+#endif
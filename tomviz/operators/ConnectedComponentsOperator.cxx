@@ -0,0 +1,262 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "ConnectedComponentsOperator.h"
+
+#include "ConnectedComponents.h"
+#include "EditOperatorWidget.h"
+#include "LabelMap.h"
+#include "OperatorResult.h"
+
+#include <vtkDataArray.h>
+#include <vtkDoubleArray.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkSmartPointer.h>
+#include <vtkTable.h>
+#include <vtkTypeUInt32Array.h>
+#include <vtkTypeUInt64Array.h>
+
+#include <QDoubleSpinBox>
+#include <QFormLayout>
+#include <QJsonObject>
+#include <QPointer>
+
+#include <limits>
+
+namespace {
+
+using tomviz::ConnectedComponents::LabelMoments;
+
+class ConnectedComponentsWidget : public tomviz::EditOperatorWidget
+{
+  Q_OBJECT
+
+public:
+  ConnectedComponentsWidget(tomviz::ConnectedComponentsOperator* source,
+                            QWidget* p)
+    : tomviz::EditOperatorWidget(p), m_operator(source)
+  {
+    m_background = new QDoubleSpinBox(this);
+    m_background->setRange(-std::numeric_limits<double>::max(),
+                           std::numeric_limits<double>::max());
+    m_background->setDecimals(0);
+    m_background->setValue(source->backgroundValue());
+    QFormLayout* layout = new QFormLayout;
+    layout->addRow("Background Value", m_background);
+    setLayout(layout);
+  }
+
+  void applyChangesToOperator() override
+  {
+    if (m_operator) {
+      m_operator->setBackgroundValue(m_background->value());
+    }
+  }
+
+private:
+  QPointer<tomviz::ConnectedComponentsOperator> m_operator;
+  QDoubleSpinBox* m_background;
+};
+
+template <typename T>
+uint32_t labelComponents(vtkDataArray* scalars, const int dims[3],
+                         double background, vtkTypeUInt32Array* labels,
+                         std::vector<LabelMoments>* moments,
+                         const std::function<bool()>& canceled)
+{
+  return tomviz::ConnectedComponents::label(
+    static_cast<T*>(scalars->GetVoidPointer(0)), dims,
+    static_cast<T>(background), labels->GetPointer(0), moments, canceled);
+}
+
+vtkSmartPointer<vtkDoubleArray> newColumn(const char* name, vtkIdType size)
+{
+  auto column = vtkSmartPointer<vtkDoubleArray>::New();
+  column->SetName(name);
+  column->SetNumberOfTuples(size);
+  return column;
+}
+
+// Convert the label moments to physical units, one row per label. The inertia
+// tensor assumes unit density, so it is in units of length^5.
+vtkSmartPointer<vtkTable> statisticsTable(
+  const std::vector<LabelMoments>& moments, const double origin[3],
+  const double spacing[3])
+{
+  const vtkIdType n = static_cast<vtkIdType>(moments.size());
+  const double voxelVolume = spacing[0] * spacing[1] * spacing[2];
+
+  vtkNew<vtkTypeUInt32Array> labelColumn;
+  labelColumn->SetName("Label");
+  labelColumn->SetNumberOfTuples(n);
+  vtkNew<vtkTypeUInt64Array> countColumn;
+  countColumn->SetName("VoxelCount");
+  countColumn->SetNumberOfTuples(n);
+  auto volume = newColumn("Volume", n);
+  vtkSmartPointer<vtkDoubleArray> centroid[3] = {
+    newColumn("CentroidX", n), newColumn("CentroidY", n),
+    newColumn("CentroidZ", n)
+  };
+  // Order matches LabelMoments::sumProducts.
+  vtkSmartPointer<vtkDoubleArray> inertia[6] = {
+    newColumn("InertiaXX", n), newColumn("InertiaYY", n),
+    newColumn("InertiaZZ", n), newColumn("InertiaXY", n),
+    newColumn("InertiaXZ", n), newColumn("InertiaYZ", n)
+  };
+  vtkSmartPointer<vtkDoubleArray> minimum[3] = { newColumn("MinX", n),
+                                                 newColumn("MinY", n),
+                                                 newColumn("MinZ", n) };
+  vtkSmartPointer<vtkDoubleArray> maximum[3] = { newColumn("MaxX", n),
+                                                 newColumn("MaxY", n),
+                                                 newColumn("MaxZ", n) };
+
+  const int pairs[6][2] = { { 0, 0 }, { 1, 1 }, { 2, 2 },
+                            { 0, 1 }, { 0, 2 }, { 1, 2 } };
+  for (vtkIdType i = 0; i < n; ++i) {
+    const LabelMoments& m = moments[i];
+    const double count = static_cast<double>(m.count);
+    labelColumn->SetValue(i, static_cast<uint32_t>(i + 1));
+    countColumn->SetValue(i, m.count);
+    volume->SetValue(i, count * voxelVolume);
+
+    double mean[3];
+    for (int j = 0; j < 3; ++j) {
+      mean[j] = m.sum[j] / count;
+      centroid[j]->SetValue(i, origin[j] + spacing[j] * mean[j]);
+      minimum[j]->SetValue(i, origin[j] + spacing[j] * m.min[j]);
+      maximum[j]->SetValue(i, origin[j] + spacing[j] * m.max[j]);
+    }
+
+    // Central second moments in physical units.
+    double c[6];
+    for (int j = 0; j < 6; ++j) {
+      const int a = pairs[j][0];
+      const int b = pairs[j][1];
+      c[j] = spacing[a] * spacing[b] *
+             (m.sumProducts[j] - count * mean[a] * mean[b]) * voxelVolume;
+    }
+    inertia[0]->SetValue(i, c[1] + c[2]);
+    inertia[1]->SetValue(i, c[0] + c[2]);
+    inertia[2]->SetValue(i, c[0] + c[1]);
+    inertia[3]->SetValue(i, -c[3]);
+    inertia[4]->SetValue(i, -c[4]);
+    inertia[5]->SetValue(i, -c[5]);
+  }
+
+  auto table = vtkSmartPointer<vtkTable>::New();
+  table->AddColumn(labelColumn.GetPointer());
+  table->AddColumn(countColumn.GetPointer());
+  table->AddColumn(volume);
+  for (auto& column : centroid) {
+    table->AddColumn(column);
+  }
+  for (auto& column : inertia) {
+    table->AddColumn(column);
+  }
+  for (int j = 0; j < 3; ++j) {
+    table->AddColumn(minimum[j]);
+    table->AddColumn(maximum[j]);
+  }
+  return table;
+}
+} // namespace
+
+#include "ConnectedComponentsOperator.moc"
+
+namespace tomviz {
+
+ConnectedComponentsOperator::ConnectedComponentsOperator(QObject* p)
+  : Operator(p)
+{
+  setSupportsCancel(true);
+  setNumberOfResults(1);
+  auto res = resultAt(0);
+  res->setName("component_statistics");
+  res->setLabel("Component Statistics");
+}
+
+QIcon ConnectedComponentsOperator::icon() const
+{
+  return QIcon();
+}
+
+bool ConnectedComponentsOperator::applyTransform(vtkDataObject* data)
+{
+  vtkImageData* image = vtkImageData::SafeDownCast(data);
+  if (!image) {
+    return false;
+  }
+  vtkDataArray* scalars = image->GetPointData()->GetScalars();
+  if (!scalars || scalars->GetNumberOfComponents() != 1) {
+    return false;
+  }
+
+  int dims[3];
+  image->GetDimensions(dims);
+  vtkNew<vtkTypeUInt32Array> labels;
+  labels->SetNumberOfTuples(scalars->GetNumberOfTuples());
+  labels->SetName(scalars->GetName());
+
+  std::vector<LabelMoments> moments;
+  uint32_t n = 0;
+  auto canceled = [this]() { return isCanceled(); };
+  switch (scalars->GetDataType()) {
+    vtkTemplateMacro(n = labelComponents<VTK_TT>(
+                       scalars, dims, m_backgroundValue, labels.GetPointer(),
+                       &moments, canceled));
+  }
+  if (isCanceled()) {
+    return false;
+  }
+
+  double origin[3];
+  double spacing[3];
+  image->GetOrigin(origin);
+  image->GetSpacing(spacing);
+  auto table = statisticsTable(moments, origin, spacing);
+  setResult(0, table.Get());
+
+  // Store the labels in the smallest type that holds them, most label maps
+  // have few enough objects to fit in a byte per voxel.
+  auto compacted =
+    LabelMap::convert(labels.GetPointer(), LabelMap::smallestType(n));
+  image->GetPointData()->RemoveArray(scalars->GetName());
+  image->GetPointData()->SetScalars(compacted);
+  return true;
+}
+
+Operator* ConnectedComponentsOperator::clone() const
+{
+  ConnectedComponentsOperator* other = new ConnectedComponentsOperator();
+  other->setBackgroundValue(m_backgroundValue);
+  return initializeClone(other);
+}
+
+QJsonObject ConnectedComponentsOperator::serialize() const
+{
+  auto json = Operator::serialize();
+  json["backgroundValue"] = m_backgroundValue;
+  return json;
+}
+
+bool ConnectedComponentsOperator::deserialize(const QJsonObject& json)
+{
+  if (json.contains("backgroundValue")) {
+    m_backgroundValue = json["backgroundValue"].toDouble();
+  }
+  return true;
+}
+
+EditOperatorWidget* ConnectedComponentsOperator::getEditorContents(QWidget* p)
+{
+  return new ConnectedComponentsWidget(this, p);
+}
+
+void ConnectedComponentsOperator::setBackgroundValue(double value)
+{
+  m_backgroundValue = value;
+  emit transformModified();
+}
+} // namespace tomviz
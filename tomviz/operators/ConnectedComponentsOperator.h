@@ -0,0 +1,43 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizConnectedComponentsOperator_h
+#define tomvizConnectedComponentsOperator_h
+
+#include "Operator.h"
+
+namespace tomviz {
+
+/// Native replacement for the ITK based ConnectedComponents.py. Labels the
+/// face connected components of the non-background voxels with 32-bit labels,
+/// ordered by increasing size, and produces a table of per-label statistics.
+class ConnectedComponentsOperator : public Operator
+{
+  Q_OBJECT
+
+public:
+  ConnectedComponentsOperator(QObject* parent = nullptr);
+
+  QString label() const override { return "Connected Components"; }
+  QIcon icon() const override;
+  Operator* clone() const override;
+
+  QJsonObject serialize() const override;
+  bool deserialize(const QJsonObject& json) override;
+
+  EditOperatorWidget* getEditorContents(QWidget* parent) override;
+  bool hasCustomUI() const override { return true; }
+
+  void setBackgroundValue(double value);
+  double backgroundValue() const { return m_backgroundValue; }
+
+protected:
+  bool applyTransform(vtkDataObject* data) override;
+
+private:
+  double m_backgroundValue = 0.0;
+  Q_DISABLE_COPY(ConnectedComponentsOperator)
+};
+} // namespace tomviz
+
+#endif
@@ -54,7 +54,7 @@ bool ConvertToFloatOperator::applyTransform(vtkDataObject* data)
 
 Operator* ConvertToFloatOperator::clone() const
 {
-  return new ConvertToFloatOperator();
+  return initializeClone(new ConvertToFloatOperator());
 }
 
 } // namespace tomviz
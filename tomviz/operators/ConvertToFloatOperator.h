@@ -18,6 +18,8 @@ public:
   QString label() const override { return "Convert to Float"; }
   QIcon icon() const override;
   Operator* clone() const override;
+  bool supportsAllArrays() const override { return true; }
+  bool isReentrant() const override { return true; }
 
   bool applyTransform(vtkDataObject* data) override;
 
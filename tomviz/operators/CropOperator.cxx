@@ -97,7 +97,7 @@ Operator* CropOperator::clone() const
 {
   CropOperator* other = new CropOperator();
   other->setCropBounds(m_bounds);
-  return other;
+  return initializeClone(other);
 }
 
 QJsonObject CropOperator::serialize() const
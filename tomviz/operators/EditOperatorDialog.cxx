@@ -15,6 +15,7 @@
 #include <pqPythonSyntaxHighlighter.h>
 #include <pqSettings.h>
 
+#include <QCheckBox>
 #include <QDebug>
 #include <QDialogButtonBox>
 #include <QMessageBox>
@@ -32,6 +33,14 @@ public:
   EditOperatorWidget* Widget;
   bool needsToBeAdded;
   DataSource* dataSource;
+  QPointer<QCheckBox> AllArrays;
+
+  void applyAllArrays()
+  {
+    if (!Op.isNull() && AllArrays) {
+      Op->setApplyToAllArrays(AllArrays->isChecked());
+    }
+  }
 
   void saveGeometry(const QRect& geometry)
   {
@@ -171,6 +180,7 @@ void EditOperatorDialog::applyChanges()
         emit editEnded(this->Internals->Op);
         // We do this before causing cancel so the values are in place for when
         // whenCanceled cause the pipeline to be re-executed.
+        this->Internals->applyAllArrays();
         this->Internals->Widget->applyChangesToOperator();
         if (dataSource->pipeline()->isRunning()) {
           this->Internals->dataSource->pipeline()->cancel(whenCanceled);
@@ -179,6 +189,7 @@ void EditOperatorDialog::applyChanges()
         }
       }
     } else {
+      this->Internals->applyAllArrays();
       this->Internals->Widget->applyChangesToOperator();
       if (this->Internals->needsToBeAdded) {
         this->Internals->needsToBeAdded = false;
@@ -247,6 +258,14 @@ void EditOperatorDialog::setupUI(EditOperatorWidget* opWidget)
   } else {
     this->Internals->Widget = nullptr;
   }
+  // Multi-channel data can have the operator applied to each of its arrays.
+  if (this->Internals->Op->supportsAllArrays() &&
+      this->Internals->dataSource->listScalars().size() > 1) {
+    auto allArrays = new QCheckBox("Apply to all arrays", this);
+    allArrays->setChecked(this->Internals->Op->applyToAllArrays());
+    vLayout->addWidget(allArrays);
+    this->Internals->AllArrays = allArrays;
+  }
   QDialogButtonBox* dialogButtons = new QDialogButtonBox(
     QDialogButtonBox::Apply | QDialogButtonBox::Cancel | QDialogButtonBox::Ok,
     Qt::Horizontal, this);
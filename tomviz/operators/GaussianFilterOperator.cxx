@@ -0,0 +1,163 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "GaussianFilterOperator.h"
+
+#include "CopyOnWrite.h"
+#include "DataSource.h"
+#include "EditOperatorWidget.h"
+#include "NeighborhoodFilters.h"
+
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkPointData.h>
+
+#include <QDoubleSpinBox>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QPointer>
+
+#include <algorithm>
+
+namespace {
+
+using tomviz::GaussianFilterOperator;
+
+class GaussianFilterWidget : public tomviz::EditOperatorWidget
+{
+  Q_OBJECT
+
+public:
+  GaussianFilterWidget(GaussianFilterOperator* source, QWidget* p)
+    : tomviz::EditOperatorWidget(p), m_operator(source)
+  {
+    auto sigmaLayout = new QHBoxLayout;
+    for (int i = 0; i < 3; ++i) {
+      m_sigma[i] = new QDoubleSpinBox(this);
+      m_sigma[i]->setRange(0.0, 100.0);
+      m_sigma[i]->setSingleStep(0.5);
+      m_sigma[i]->setValue(source->sigma()[i]);
+      sigmaLayout->addWidget(m_sigma[i]);
+    }
+
+    QFormLayout* layout = new QFormLayout;
+    layout->addRow("Sigma (x, y, z)", sigmaLayout);
+    setLayout(layout);
+  }
+
+  void applyChangesToOperator() override
+  {
+    if (m_operator) {
+      double sigma[3];
+      for (int i = 0; i < 3; ++i) {
+        sigma[i] = m_sigma[i]->value();
+      }
+      m_operator->setSigma(sigma);
+    }
+  }
+
+private:
+  QPointer<GaussianFilterOperator> m_operator;
+  QDoubleSpinBox* m_sigma[3];
+};
+
+template <typename T>
+bool gaussianFilter(vtkDataArray* array, const int dims[3],
+                    const double sigma[3],
+                    const std::function<bool()>& canceled)
+{
+  return tomviz::NeighborhoodFilters::eachComponent(
+    static_cast<T*>(array->GetVoidPointer(0)), dims,
+    array->GetNumberOfComponents(), [&](T* component) {
+      return tomviz::NeighborhoodFilters::gaussian(component, dims, sigma,
+                                                   canceled);
+    });
+}
+} // namespace
+
+#include "GaussianFilterOperator.moc"
+
+namespace tomviz {
+
+GaussianFilterOperator::GaussianFilterOperator(DataSource* dataSource,
+                                               QObject* p)
+  : Operator(p)
+{
+  setSupportsCancel(true);
+  if (dataSource && dataSource->type() == DataSource::TiltSeries) {
+    m_sigma[2] = 0.0;
+  }
+}
+
+QIcon GaussianFilterOperator::icon() const
+{
+  return QIcon();
+}
+
+bool GaussianFilterOperator::applyTransform(vtkDataObject* data)
+{
+  vtkImageData* image = vtkImageData::SafeDownCast(data);
+  if (!image) {
+    return false;
+  }
+  vtkDataArray* scalars = image->GetPointData()->GetScalars();
+  if (!scalars) {
+    return false;
+  }
+  // The scalars are filtered in place.
+  CopyOnWrite::detach(scalars);
+
+  int dims[3];
+  image->GetDimensions(dims);
+  auto canceled = [this]() { return isCanceled(); };
+  bool completed = false;
+  switch (scalars->GetDataType()) {
+    vtkTemplateMacro(completed = gaussianFilter<VTK_TT>(scalars, dims, m_sigma,
+                                                        canceled));
+  }
+  scalars->Modified();
+  return completed;
+}
+
+Operator* GaussianFilterOperator::clone() const
+{
+  auto other = new GaussianFilterOperator();
+  other->setSigma(m_sigma);
+  return initializeClone(other);
+}
+
+QJsonObject GaussianFilterOperator::serialize() const
+{
+  auto json = Operator::serialize();
+  json["sigma"] = QJsonArray({ m_sigma[0], m_sigma[1], m_sigma[2] });
+  return json;
+}
+
+bool GaussianFilterOperator::deserialize(const QJsonObject& json)
+{
+  if (json.contains("sigma")) {
+    auto sigma = json["sigma"].toArray();
+    if (sigma.size() == 3) {
+      for (int i = 0; i < 3; ++i) {
+        m_sigma[i] = std::max(sigma[i].toDouble(2.0), 0.0);
+      }
+    }
+  }
+  return true;
+}
+
+EditOperatorWidget* GaussianFilterOperator::getEditorContents(QWidget* p)
+{
+  return new GaussianFilterWidget(this, p);
+}
+
+void GaussianFilterOperator::setSigma(const double sigma[3])
+{
+  for (int i = 0; i < 3; ++i) {
+    m_sigma[i] = std::max(sigma[i], 0.0);
+  }
+  emit transformModified();
+}
+} // namespace tomviz
@@ -0,0 +1,47 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizGaussianFilterOperator_h
+#define tomvizGaussianFilterOperator_h
+
+#include "Operator.h"
+
+namespace tomviz {
+
+/// Native Gaussian blur with a standard deviation, in voxels, per axis.
+/// Replaces the Gaussian Blur and Gaussian Filter Tilt Series Python
+/// operators, matching scipy's gaussian_filter. Tilt series are blurred
+/// within their images by default.
+class GaussianFilterOperator : public Operator
+{
+  Q_OBJECT
+
+public:
+  GaussianFilterOperator(DataSource* dataSource = nullptr,
+                         QObject* parent = nullptr);
+
+  QString label() const override { return "Gaussian Blur"; }
+  QIcon icon() const override;
+  Operator* clone() const override;
+  bool supportsAllArrays() const override { return true; }
+  bool isReentrant() const override { return true; }
+
+  QJsonObject serialize() const override;
+  bool deserialize(const QJsonObject& json) override;
+
+  EditOperatorWidget* getEditorContents(QWidget* parent) override;
+  bool hasCustomUI() const override { return true; }
+
+  void setSigma(const double sigma[3]);
+  const double* sigma() const { return m_sigma; }
+
+protected:
+  bool applyTransform(vtkDataObject* data) override;
+
+private:
+  double m_sigma[3] = { 2.0, 2.0, 2.0 };
+  Q_DISABLE_COPY(GaussianFilterOperator)
+};
+} // namespace tomviz
+
+#endif
@@ -0,0 +1,124 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "LabelObjectAttributesOperator.h"
+
+#include "ConnectedComponents.h"
+#include "OperatorResult.h"
+
+#include <vtkDataArray.h>
+#include <vtkDoubleArray.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkTable.h>
+#include <vtkTypeInt64Array.h>
+
+namespace {
+
+using tomviz::ConnectedComponents::LabelMoments;
+
+template <typename T>
+void fillTable(vtkDataArray* scalars, const int dims[3],
+               const double spacing[3], vtkTable* table,
+               const std::function<bool()>& canceled)
+{
+  auto objects = tomviz::ConnectedComponents::measure(
+    static_cast<T*>(scalars->GetVoidPointer(0)), dims, canceled);
+
+  const vtkIdType n = static_cast<vtkIdType>(objects.size());
+  vtkNew<vtkTypeInt64Array> labels;
+  labels->SetName("Label");
+  labels->SetNumberOfTuples(n);
+  vtkNew<vtkDoubleArray> area;
+  area->SetName("SurfaceArea");
+  area->SetNumberOfTuples(n);
+  vtkNew<vtkDoubleArray> volume;
+  volume->SetName("Volume");
+  volume->SetNumberOfTuples(n);
+  vtkNew<vtkDoubleArray> ratio;
+  ratio->SetName("SurfaceAreaToVolumeRatio");
+  ratio->SetNumberOfTuples(n);
+
+  // Areas of the faces normal to x, y and z.
+  const double faceArea[3] = { spacing[1] * spacing[2],
+                               spacing[0] * spacing[2],
+                               spacing[0] * spacing[1] };
+  const double voxelVolume = spacing[0] * spacing[1] * spacing[2];
+  vtkIdType i = 0;
+  for (const auto& object : objects) {
+    const LabelMoments& m = object.second;
+    double a = 0.0;
+    for (int j = 0; j < 3; ++j) {
+      a += m.faces[j] * faceArea[j];
+    }
+    const double v = m.count * voxelVolume;
+    labels->SetValue(i, static_cast<vtkTypeInt64>(object.first));
+    area->SetValue(i, a);
+    volume->SetValue(i, v);
+    ratio->SetValue(i, a / v);
+    ++i;
+  }
+
+  table->AddColumn(labels.GetPointer());
+  table->AddColumn(area.GetPointer());
+  table->AddColumn(volume.GetPointer());
+  table->AddColumn(ratio.GetPointer());
+}
+} // namespace
+
+namespace tomviz {
+
+LabelObjectAttributesOperator::LabelObjectAttributesOperator(QObject* p)
+  : Operator(p)
+{
+  setSupportsCancel(true);
+  setNumberOfResults(1);
+  auto res = resultAt(0);
+  res->setName("component_statistics");
+  res->setLabel("Component Statistics");
+}
+
+QIcon LabelObjectAttributesOperator::icon() const
+{
+  return QIcon();
+}
+
+bool LabelObjectAttributesOperator::applyTransform(vtkDataObject* data)
+{
+  vtkImageData* image = vtkImageData::SafeDownCast(data);
+  if (!image) {
+    return false;
+  }
+  vtkDataArray* scalars = image->GetPointData()->GetScalars();
+  if (!scalars || scalars->GetNumberOfComponents() != 1) {
+    return false;
+  }
+  // Labels are integers, as for the Python operator.
+  if (scalars->GetDataType() == VTK_FLOAT ||
+      scalars->GetDataType() == VTK_DOUBLE) {
+    return false;
+  }
+
+  int dims[3];
+  double spacing[3];
+  image->GetDimensions(dims);
+  image->GetSpacing(spacing);
+  vtkNew<vtkTable> table;
+  auto canceled = [this]() { return isCanceled(); };
+  switch (scalars->GetDataType()) {
+    vtkTemplateMacro(fillTable<VTK_TT>(scalars, dims, spacing,
+                                       table.GetPointer(), canceled));
+  }
+  if (isCanceled()) {
+    return false;
+  }
+  setResult(0, table.GetPointer());
+  return true;
+}
+
+Operator* LabelObjectAttributesOperator::clone() const
+{
+  return initializeClone(new LabelObjectAttributesOperator());
+}
+} // namespace tomviz
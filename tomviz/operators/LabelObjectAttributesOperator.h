@@ -0,0 +1,34 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizLabelObjectAttributesOperator_h
+#define tomvizLabelObjectAttributesOperator_h
+
+#include "Operator.h"
+
+namespace tomviz {
+
+/// Native replacement for the ITK based LabelObjectAttributes.py. Produces a
+/// table of the surface area, volume and their ratio of every object of a
+/// label map, the input is left unchanged. The surface area is the area of
+/// the voxel faces an object exposes.
+class LabelObjectAttributesOperator : public Operator
+{
+  Q_OBJECT
+
+public:
+  LabelObjectAttributesOperator(QObject* parent = nullptr);
+
+  QString label() const override { return "Label Object Attributes"; }
+  QIcon icon() const override;
+  Operator* clone() const override;
+
+protected:
+  bool applyTransform(vtkDataObject* data) override;
+
+private:
+  Q_DISABLE_COPY(LabelObjectAttributesOperator)
+};
+} // namespace tomviz
+
+#endif
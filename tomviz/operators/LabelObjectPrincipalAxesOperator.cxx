@@ -0,0 +1,186 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "LabelObjectPrincipalAxesOperator.h"
+
+#include "ConnectedComponents.h"
+#include "EditOperatorWidget.h"
+
+#include <vtkDataArray.h>
+#include <vtkFieldData.h>
+#include <vtkFloatArray.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+
+#include <QFormLayout>
+#include <QJsonObject>
+#include <QPointer>
+#include <QSpinBox>
+
+#include <limits>
+
+namespace {
+
+using tomviz::ConnectedComponents::LabelMoments;
+
+class LabelObjectPrincipalAxesWidget : public tomviz::EditOperatorWidget
+{
+  Q_OBJECT
+
+public:
+  LabelObjectPrincipalAxesWidget(
+    tomviz::LabelObjectPrincipalAxesOperator* source, QWidget* p)
+    : tomviz::EditOperatorWidget(p), m_operator(source)
+  {
+    m_labelValue = new QSpinBox(this);
+    m_labelValue->setRange(std::numeric_limits<int>::min(),
+                           std::numeric_limits<int>::max());
+    m_labelValue->setValue(source->labelValue());
+    QFormLayout* layout = new QFormLayout;
+    layout->addRow("Label Value", m_labelValue);
+    setLayout(layout);
+  }
+
+  void applyChangesToOperator() override
+  {
+    if (m_operator) {
+      m_operator->setLabelValue(m_labelValue->value());
+    }
+  }
+
+private:
+  QPointer<tomviz::LabelObjectPrincipalAxesOperator> m_operator;
+  QSpinBox* m_labelValue;
+};
+
+// Moments of the voxels equal to value, only the object of that label is
+// measured so the other labels do not need to be kept.
+template <typename T>
+LabelMoments measureLabel(vtkDataArray* scalars, const int dims[3], int value)
+{
+  const T* labels = static_cast<T*>(scalars->GetVoidPointer(0));
+  const T label = static_cast<T>(value);
+  const int64_t nx = dims[0];
+  const int64_t sliceSize = nx * dims[1];
+  std::vector<LabelMoments> slices(dims[2]);
+  tomviz::parallelFor(0, dims[2], [&](int64_t begin, int64_t end) {
+    for (int64_t z = begin; z < end; ++z) {
+      int64_t index = z * sliceSize;
+      for (int y = 0; y < dims[1]; ++y) {
+        for (int x = 0; x < dims[0]; ++x, ++index) {
+          if (labels[index] == label) {
+            slices[z].add(x, y, static_cast<int>(z), index);
+          }
+        }
+      }
+    }
+  });
+  LabelMoments moments;
+  for (const auto& slice : slices) {
+    moments.merge(slice);
+  }
+  return moments;
+}
+} // namespace
+
+#include "LabelObjectPrincipalAxesOperator.moc"
+
+namespace tomviz {
+
+LabelObjectPrincipalAxesOperator::LabelObjectPrincipalAxesOperator(QObject* p)
+  : Operator(p)
+{
+}
+
+QIcon LabelObjectPrincipalAxesOperator::icon() const
+{
+  return QIcon();
+}
+
+bool LabelObjectPrincipalAxesOperator::applyTransform(vtkDataObject* data)
+{
+  vtkImageData* image = vtkImageData::SafeDownCast(data);
+  if (!image) {
+    return false;
+  }
+  vtkDataArray* scalars = image->GetPointData()->GetScalars();
+  if (!scalars || scalars->GetNumberOfComponents() != 1) {
+    return false;
+  }
+
+  int dims[3];
+  image->GetDimensions(dims);
+  LabelMoments moments;
+  switch (scalars->GetDataType()) {
+    vtkTemplateMacro(
+      moments = measureLabel<VTK_TT>(scalars, dims, m_labelValue));
+  }
+  if (moments.count == 0) {
+    qWarning("No voxels with label %d in label map", m_labelValue);
+    return false;
+  }
+
+  double origin[3];
+  double spacing[3];
+  double center[3];
+  double axes[3][3];
+  image->GetOrigin(origin);
+  image->GetSpacing(spacing);
+  ConnectedComponents::principalAxes(moments, origin, spacing, center, axes);
+
+  vtkNew<vtkFloatArray> axisArray;
+  axisArray->SetName("PrincipalAxes");
+  axisArray->SetNumberOfComponents(3);
+  axisArray->SetNumberOfTuples(3);
+  for (int i = 0; i < 3; ++i) {
+    axisArray->SetTuple(i, axes[i]);
+  }
+  vtkNew<vtkFloatArray> centerArray;
+  centerArray->SetName("Center");
+  centerArray->SetNumberOfComponents(3);
+  centerArray->SetNumberOfTuples(1);
+  centerArray->SetTuple(0, center);
+
+  vtkFieldData* fd = image->GetFieldData();
+  fd->RemoveArray("PrincipalAxes");
+  fd->AddArray(axisArray.GetPointer());
+  fd->RemoveArray("Center");
+  fd->AddArray(centerArray.GetPointer());
+  return true;
+}
+
+Operator* LabelObjectPrincipalAxesOperator::clone() const
+{
+  auto other = new LabelObjectPrincipalAxesOperator();
+  other->setLabelValue(m_labelValue);
+  return initializeClone(other);
+}
+
+QJsonObject LabelObjectPrincipalAxesOperator::serialize() const
+{
+  auto json = Operator::serialize();
+  json["labelValue"] = m_labelValue;
+  return json;
+}
+
+bool LabelObjectPrincipalAxesOperator::deserialize(const QJsonObject& json)
+{
+  if (json.contains("labelValue")) {
+    m_labelValue = json["labelValue"].toInt();
+  }
+  return true;
+}
+
+EditOperatorWidget* LabelObjectPrincipalAxesOperator::getEditorContents(
+  QWidget* p)
+{
+  return new LabelObjectPrincipalAxesWidget(this, p);
+}
+
+void LabelObjectPrincipalAxesOperator::setLabelValue(int value)
+{
+  m_labelValue = value;
+  emit transformModified();
+}
+} // namespace tomviz
@@ -0,0 +1,44 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizLabelObjectPrincipalAxesOperator_h
+#define tomvizLabelObjectPrincipalAxesOperator_h
+
+#include "Operator.h"
+
+namespace tomviz {
+
+/// Native replacement for LabelObjectPrincipalAxes.py. Computes the principal
+/// axes and center of the object with the given label from the moments of its
+/// voxels, and stores them in the "PrincipalAxes" and "Center" field data
+/// arrays. The voxels are left unchanged.
+class LabelObjectPrincipalAxesOperator : public Operator
+{
+  Q_OBJECT
+
+public:
+  LabelObjectPrincipalAxesOperator(QObject* parent = nullptr);
+
+  QString label() const override { return "Label Object Principal Axes"; }
+  QIcon icon() const override;
+  Operator* clone() const override;
+
+  QJsonObject serialize() const override;
+  bool deserialize(const QJsonObject& json) override;
+
+  EditOperatorWidget* getEditorContents(QWidget* parent) override;
+  bool hasCustomUI() const override { return true; }
+
+  void setLabelValue(int value);
+  int labelValue() const { return m_labelValue; }
+
+protected:
+  bool applyTransform(vtkDataObject* data) override;
+
+private:
+  int m_labelValue = 1;
+  Q_DISABLE_COPY(LabelObjectPrincipalAxesOperator)
+};
+} // namespace tomviz
+
+#endif
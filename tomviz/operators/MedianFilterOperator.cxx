@@ -0,0 +1,139 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "MedianFilterOperator.h"
+
+#include "CopyOnWrite.h"
+#include "EditOperatorWidget.h"
+#include "NeighborhoodFilters.h"
+
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkPointData.h>
+
+#include <QFormLayout>
+#include <QJsonObject>
+#include <QPointer>
+#include <QSpinBox>
+
+#include <algorithm>
+
+namespace {
+
+using tomviz::MedianFilterOperator;
+
+class MedianFilterWidget : public tomviz::EditOperatorWidget
+{
+  Q_OBJECT
+
+public:
+  MedianFilterWidget(MedianFilterOperator* source, QWidget* p)
+    : tomviz::EditOperatorWidget(p), m_operator(source)
+  {
+    m_size = new QSpinBox(this);
+    m_size->setRange(1, 15);
+    m_size->setValue(source->size());
+
+    QFormLayout* layout = new QFormLayout;
+    layout->addRow("Size", m_size);
+    setLayout(layout);
+  }
+
+  void applyChangesToOperator() override
+  {
+    if (m_operator) {
+      m_operator->setSize(m_size->value());
+    }
+  }
+
+private:
+  QPointer<MedianFilterOperator> m_operator;
+  QSpinBox* m_size;
+};
+
+template <typename T>
+bool medianFilter(vtkDataArray* array, const int dims[3], const int size[3],
+                  const std::function<bool()>& canceled)
+{
+  return tomviz::NeighborhoodFilters::eachComponent(
+    static_cast<T*>(array->GetVoidPointer(0)), dims,
+    array->GetNumberOfComponents(), [&](T* component) {
+      return tomviz::NeighborhoodFilters::median(component, dims, size,
+                                                 canceled);
+    });
+}
+} // namespace
+
+#include "MedianFilterOperator.moc"
+
+namespace tomviz {
+
+MedianFilterOperator::MedianFilterOperator(QObject* p) : Operator(p)
+{
+  setSupportsCancel(true);
+}
+
+QIcon MedianFilterOperator::icon() const
+{
+  return QIcon();
+}
+
+bool MedianFilterOperator::applyTransform(vtkDataObject* data)
+{
+  vtkImageData* image = vtkImageData::SafeDownCast(data);
+  if (!image) {
+    return false;
+  }
+  vtkDataArray* scalars = image->GetPointData()->GetScalars();
+  if (!scalars) {
+    return false;
+  }
+  // The scalars are filtered in place.
+  CopyOnWrite::detach(scalars);
+
+  int dims[3];
+  image->GetDimensions(dims);
+  const int size[3] = { m_size, m_size, m_size };
+  auto canceled = [this]() { return isCanceled(); };
+  bool completed = false;
+  switch (scalars->GetDataType()) {
+    vtkTemplateMacro(
+      completed = medianFilter<VTK_TT>(scalars, dims, size, canceled));
+  }
+  scalars->Modified();
+  return completed;
+}
+
+Operator* MedianFilterOperator::clone() const
+{
+  auto other = new MedianFilterOperator();
+  other->setSize(m_size);
+  return initializeClone(other);
+}
+
+QJsonObject MedianFilterOperator::serialize() const
+{
+  auto json = Operator::serialize();
+  json["size"] = m_size;
+  return json;
+}
+
+bool MedianFilterOperator::deserialize(const QJsonObject& json)
+{
+  if (json.contains("size")) {
+    m_size = std::max(json["size"].toInt(2), 1);
+  }
+  return true;
+}
+
+EditOperatorWidget* MedianFilterOperator::getEditorContents(QWidget* p)
+{
+  return new MedianFilterWidget(this, p);
+}
+
+void MedianFilterOperator::setSize(int size)
+{
+  m_size = std::max(size, 1);
+  emit transformModified();
+}
+} // namespace tomviz
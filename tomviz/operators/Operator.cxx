@@ -7,9 +7,13 @@
 #include "EditOperatorDialog.h"
 #include "ModuleManager.h"
 #include "OperatorResult.h"
+#include "ParallelFor.h"
 #include "Pipeline.h"
 
+#include "vtkDataArray.h"
+#include "vtkFieldData.h"
 #include "vtkImageData.h"
+#include "vtkPointData.h"
 #include "vtkSMSourceProxy.h"
 
 #include <QJsonArray>
@@ -18,6 +22,9 @@
 
 #include <QDebug>
 
+#include <algorithm>
+#include <vector>
+
 namespace tomviz {
 
 Operator::Operator(QObject* parentObject) : QObject(parentObject)
@@ -63,7 +70,9 @@ TransformResult Operator::transform(vtkDataObject* data)
   m_state = OperatorState::Running;
   emit transformingStarted();
   setProgressStep(0);
-  bool result = this->applyTransform(data);
+  bool result = m_applyToAllArrays && supportsAllArrays()
+                  ? applyTransformToAllArrays(data)
+                  : this->applyTransform(data);
   TransformResult transformResult =
     result ? TransformResult::Complete : TransformResult::Error;
   // If the user requested the operator to be canceled then when it returns
@@ -78,6 +87,74 @@ TransformResult Operator::transform(vtkDataObject* data)
   return transformResult;
 }
 
+bool Operator::applyTransformToAllArrays(vtkDataObject* data)
+{
+  auto image = vtkImageData::SafeDownCast(data);
+  auto pointData = image ? image->GetPointData() : nullptr;
+  if (!pointData || pointData->GetNumberOfArrays() < 2) {
+    return this->applyTransform(data);
+  }
+
+  // Each array is transformed as the scalars of its own shallow copy of the
+  // image, so the arrays can be transformed independently.
+  std::vector<vtkSmartPointer<vtkImageData>> copies;
+  vtkDataArray* active = pointData->GetScalars();
+  int activeIndex = 0;
+  for (int i = 0; i < pointData->GetNumberOfArrays(); ++i) {
+    vtkDataArray* array = pointData->GetArray(i);
+    if (!array) {
+      continue;
+    }
+    if (array == active) {
+      activeIndex = static_cast<int>(copies.size());
+    }
+    auto copy = vtkSmartPointer<vtkImageData>::New();
+    copy->ShallowCopy(image);
+    copy->GetPointData()->Initialize();
+    copy->GetPointData()->SetScalars(array);
+    copies.push_back(copy);
+  }
+
+  std::vector<char> transformed(copies.size(), 0);
+  auto transformArrays = [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end && !isCanceled(); ++i) {
+      transformed[i] = this->applyTransform(copies[i]);
+    }
+  };
+  if (isReentrant()) {
+    parallelFor(0, copies.size(), 1, transformArrays);
+  } else {
+    transformArrays(0, copies.size());
+  }
+  if (isCanceled() ||
+      std::find(transformed.begin(), transformed.end(), 0) !=
+        transformed.end()) {
+    return false;
+  }
+
+  // The transformed arrays must still agree on the structure of the image.
+  int dims[3];
+  copies[0]->GetDimensions(dims);
+  for (auto& copy : copies) {
+    int copyDims[3];
+    copy->GetDimensions(copyDims);
+    if (!std::equal(dims, dims + 3, copyDims) ||
+        !copy->GetPointData()->GetScalars()) {
+      qWarning() << "The arrays were transformed into different shapes.";
+      return false;
+    }
+  }
+  image->CopyStructure(copies[0]);
+  image->GetFieldData()->ShallowCopy(copies[0]->GetFieldData());
+  pointData->Initialize();
+  for (auto& copy : copies) {
+    pointData->AddArray(copy->GetPointData()->GetScalars());
+  }
+  pointData->SetActiveScalars(
+    copies[activeIndex]->GetPointData()->GetScalars()->GetName());
+  return true;
+}
+
 void Operator::setNumberOfResults(int n)
 {
   int previousSize = m_results.size();
@@ -159,9 +236,18 @@ DataSource* Operator::childDataSource() const
   return m_childDataSource;
 }
 
+Operator* Operator::initializeClone(Operator* other) const
+{
+  other->setApplyToAllArrays(m_applyToAllArrays);
+  return other;
+}
+
 QJsonObject Operator::serialize() const
 {
   QJsonObject json;
+  if (m_applyToAllArrays) {
+    json["applyToAllArrays"] = true;
+  }
   if (childDataSource()) {
     QJsonArray dataSources;
     DataSource* ds = childDataSource();
@@ -194,6 +280,12 @@ void Operator::setCustomDialog(EditOperatorDialog* dialog)
   m_customDialog = dialog;
 }
 
+void Operator::restoreChildDataSource(const QString& label,
+                                      vtkSmartPointer<vtkDataObject> data)
+{
+  createNewChildDataSource(label, data);
+}
+
 void Operator::createNewChildDataSource(
   const QString& label, vtkSmartPointer<vtkDataObject> childData,
   DataSource::DataSourceType type, DataSource::PersistenceState state)
@@ -63,7 +63,8 @@ public:
 
   TransformResult transform(vtkDataObject* data);
 
-  /// Return a new clone.
+  /// Return a new clone. Implementations should return the new operator
+  /// through initializeClone() so the state of the base class carries over.
   virtual Operator* clone() const = 0;
 
   /// Set the number of results produced by this operator.
@@ -93,6 +94,11 @@ public:
   /// Get the child DataSource.
   virtual DataSource* childDataSource() const;
 
+  /// Create the child DataSource from data the operator produced earlier,
+  /// such as a result stored with a state file, as if it had just run.
+  void restoreChildDataSource(const QString& label,
+                              vtkSmartPointer<vtkDataObject> data);
+
   /// Save/Restore state.
   virtual QJsonObject serialize() const;
   virtual bool deserialize(const QJsonObject& json);
@@ -179,6 +185,21 @@ public:
     emit progressMessageChanged(message);
   }
 
+  /// Returns true if the operator only transforms the active scalars, so it
+  /// can be applied to each point array of multi-channel data in turn.
+  /// Defaults to false.
+  virtual bool supportsAllArrays() const { return false; }
+
+  /// Returns true if applyTransform can be called for several arrays at once
+  /// from parallel threads. Defaults to false, the arrays are then
+  /// transformed one after the other.
+  virtual bool isReentrant() const { return false; }
+
+  /// Apply the operator to every point array of the data rather than just the
+  /// active scalars, if the operator supports it.
+  void setApplyToAllArrays(bool value) { m_applyToAllArrays = value; }
+  bool applyToAllArrays() const { return m_applyToAllArrays; }
+
   /// Set the operator state, this is needed for external execution.
   void setState(OperatorState state) { m_state = state; }
 
@@ -264,17 +285,25 @@ protected:
   /// the cancelTransform slot to listen for the cancel signal and handle it.
   void setSupportsCancel(bool b) { m_supportsCancel = b; }
 
+  /// Copy the state held by this class, such as whether the operator is
+  /// applied to all arrays, to a clone and return it.
+  Operator* initializeClone(Operator* other) const;
+
 private:
   Q_DISABLE_COPY(Operator)
 
+  bool applyTransformToAllArrays(vtkDataObject* data);
+
   QList<OperatorResult*> m_results;
   bool m_supportsCancel = false;
   bool m_hasChildDataSource = false;
   bool m_modified = true;
   bool m_new = true;
+  bool m_applyToAllArrays = false;
   QPointer<DataSource> m_childDataSource;
   int m_totalProgressSteps = 0;
-  int m_progressStep = 0;
+  // Arrays transformed in parallel report progress from several threads.
+  std::atomic<int> m_progressStep{ 0 };
   QString m_progressMessage;
   std::atomic<OperatorState> m_state{ OperatorState::Queued };
   QPointer<EditOperatorDialog> m_customDialog;
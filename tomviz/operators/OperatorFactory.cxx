@@ -3,13 +3,22 @@
 
 #include "OperatorFactory.h"
 
+#include "BinOperator.h"
+#include "BinaryMorphologyOperator.h"
+#include "ConnectedComponentsOperator.h"
 #include "ConvertToFloatOperator.h"
 #include "CropOperator.h"
+#include "GaussianFilterOperator.h"
+#include "LabelObjectAttributesOperator.h"
+#include "LabelObjectPrincipalAxesOperator.h"
+#include "MedianFilterOperator.h"
 #include "OperatorPython.h"
 #include "ReconstructionOperator.h"
+#include "ResampleOperator.h"
 #include "SetTiltAnglesOperator.h"
 #include "SnapshotOperator.h"
 #include "TranslateAlignOperator.h"
+#include "UnsharpMaskOperator.h"
 
 #include "vtkFieldData.h"
 #include "vtkImageData.h"
@@ -76,12 +85,24 @@ QList<QString> OperatorFactory::operatorTypes()
 {
   QList<QString> reply;
   reply << "Python"
+        << "Bin"
+        << "BinaryClose"
+        << "BinaryDilate"
+        << "BinaryErode"
+        << "BinaryOpen"
+        << "ConnectedComponents"
         << "ConvertToFloat"
         << "ConvertToVolume"
         << "Crop"
         << "CxxReconstruction"
+        << "GaussianFilter"
+        << "LabelObjectAttributes"
+        << "LabelObjectPrincipalAxes"
+        << "MedianFilter"
+        << "Resample"
         << "SetTiltAngles"
         << "TranslateAlign"
+        << "UnsharpMask"
         << "Snapshot";
   qSort(reply);
   return reply;
@@ -104,6 +125,18 @@ Operator* OperatorFactory::createOperator(const QString& type, DataSource* ds)
   Operator* op = nullptr;
   if (type == "Python") {
     op = new OperatorPython();
+  } else if (type == "Bin") {
+    op = new BinOperator(ds);
+  } else if (type == "BinaryClose") {
+    op = new BinaryMorphologyOperator(BinaryMorphology::Operation::Close);
+  } else if (type == "BinaryDilate") {
+    op = new BinaryMorphologyOperator(BinaryMorphology::Operation::Dilate);
+  } else if (type == "BinaryErode") {
+    op = new BinaryMorphologyOperator(BinaryMorphology::Operation::Erode);
+  } else if (type == "BinaryOpen") {
+    op = new BinaryMorphologyOperator(BinaryMorphology::Operation::Open);
+  } else if (type == "ConnectedComponents") {
+    op = new ConnectedComponentsOperator();
   } else if (type == "ConvertToFloat") {
     op = new ConvertToFloatOperator();
   } else if (type == "ConvertToVolume") {
@@ -112,10 +145,22 @@ Operator* OperatorFactory::createOperator(const QString& type, DataSource* ds)
     op = new CropOperator();
   } else if (type == "CxxReconstruction") {
     op = new ReconstructionOperator(ds);
+  } else if (type == "GaussianFilter") {
+    op = new GaussianFilterOperator(ds);
+  } else if (type == "LabelObjectAttributes") {
+    op = new LabelObjectAttributesOperator();
+  } else if (type == "LabelObjectPrincipalAxes") {
+    op = new LabelObjectPrincipalAxesOperator();
+  } else if (type == "MedianFilter") {
+    op = new MedianFilterOperator();
+  } else if (type == "Resample") {
+    op = new ResampleOperator();
   } else if (type == "SetTiltAngles") {
     op = new SetTiltAnglesOperator();
   } else if (type == "TranslateAlign") {
     op = new TranslateAlignOperator(ds);
+  } else if (type == "UnsharpMask") {
+    op = new UnsharpMaskOperator();
   } else if (type == "Snapshot") {
     op = new SnapshotOperator(ds);
   }
@@ -130,6 +175,24 @@ const char* OperatorFactory::operatorType(Operator* op)
   if (qobject_cast<ConvertToVolumeOperator*>(op)) {
     return "ConvertToVolume";
   }
+  if (qobject_cast<BinOperator*>(op)) {
+    return "Bin";
+  }
+  if (auto morphology = qobject_cast<BinaryMorphologyOperator*>(op)) {
+    switch (morphology->operation()) {
+      case BinaryMorphology::Operation::Close:
+        return "BinaryClose";
+      case BinaryMorphology::Operation::Dilate:
+        return "BinaryDilate";
+      case BinaryMorphology::Operation::Erode:
+        return "BinaryErode";
+      case BinaryMorphology::Operation::Open:
+        return "BinaryOpen";
+    }
+  }
+  if (qobject_cast<ConnectedComponentsOperator*>(op)) {
+    return "ConnectedComponents";
+  }
   if (qobject_cast<ConvertToFloatOperator*>(op)) {
     return "ConvertToFloat";
   }
@@ -139,12 +202,30 @@ const char* OperatorFactory::operatorType(Operator* op)
   if (qobject_cast<ReconstructionOperator*>(op)) {
     return "CxxReconstruction";
   }
+  if (qobject_cast<GaussianFilterOperator*>(op)) {
+    return "GaussianFilter";
+  }
+  if (qobject_cast<LabelObjectAttributesOperator*>(op)) {
+    return "LabelObjectAttributes";
+  }
+  if (qobject_cast<LabelObjectPrincipalAxesOperator*>(op)) {
+    return "LabelObjectPrincipalAxes";
+  }
+  if (qobject_cast<MedianFilterOperator*>(op)) {
+    return "MedianFilter";
+  }
+  if (qobject_cast<ResampleOperator*>(op)) {
+    return "Resample";
+  }
   if (qobject_cast<SetTiltAnglesOperator*>(op)) {
     return "SetTiltAngles";
   }
   if (qobject_cast<TranslateAlignOperator*>(op)) {
     return "TranslateAlign";
   }
+  if (qobject_cast<UnsharpMaskOperator*>(op)) {
+    return "UnsharpMask";
+  }
   if (qobject_cast<SnapshotOperator*>(op)) {
     return "Snapshot";
   }
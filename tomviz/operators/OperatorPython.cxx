@@ -11,6 +11,7 @@
 #include <QtDebug>
 
 #include "ActiveObjects.h"
+#include "CopyOnWrite.h"
 #include "CustomPythonOperatorWidget.h"
 #include "DataSource.h"
 #include "EditOperatorWidget.h"
@@ -372,6 +373,11 @@ bool OperatorPython::applyTransform(vtkDataObject* data)
     dataSourceByName.insert(childDataSource(), nameLabelPair.first);
   }
 
+  // Scripts may write into any of the arrays in place.
+  if (auto image = vtkImageData::SafeDownCast(data)) {
+    CopyOnWrite::detach(image);
+  }
+
   Python::Object pydata = Python::VTK::GetObjectFromPointer(data);
 
   Python::Object result;
@@ -466,7 +472,7 @@ Operator* OperatorPython::clone() const
   newClone->setLabel(label());
   newClone->setScript(script());
   newClone->setJSONDescription(JSONDescription());
-  return newClone;
+  return initializeClone(newClone);
 }
 
 QJsonObject OperatorPython::serialize() const
@@ -32,6 +32,12 @@ public:
   /// Return a new clone.
   Operator* clone() const override;
 
+  /// Operators producing results or a child data source are only run once.
+  bool supportsAllArrays() const override
+  {
+    return numberOfResults() == 0 && !hasChildDataSource();
+  }
+
   QJsonObject serialize() const override;
   bool deserialize(const QJsonObject& json) override;
 
@@ -55,7 +55,7 @@ QIcon ReconstructionOperator::icon() const
 
 Operator* ReconstructionOperator::clone() const
 {
-  return new ReconstructionOperator(m_dataSource);
+  return initializeClone(new ReconstructionOperator(m_dataSource));
 }
 
 QWidget* ReconstructionOperator::getCustomProgressWidget(QWidget* p) const
@@ -0,0 +1,202 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "ResampleOperator.h"
+
+#include "EditOperatorWidget.h"
+
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+
+#include <QComboBox>
+#include <QDoubleSpinBox>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QPointer>
+
+#include <algorithm>
+
+namespace {
+
+using tomviz::ResampleOperator;
+
+class ResampleWidget : public tomviz::EditOperatorWidget
+{
+  Q_OBJECT
+
+public:
+  ResampleWidget(ResampleOperator* source, QWidget* p)
+    : tomviz::EditOperatorWidget(p), m_operator(source)
+  {
+    auto factorsLayout = new QHBoxLayout;
+    for (int i = 0; i < 3; ++i) {
+      m_factors[i] = new QDoubleSpinBox(this);
+      m_factors[i]->setRange(0.01, 100.0);
+      m_factors[i]->setDecimals(2);
+      m_factors[i]->setSingleStep(0.1);
+      m_factors[i]->setValue(source->factors()[i]);
+      factorsLayout->addWidget(m_factors[i]);
+    }
+
+    m_interpolation = new QComboBox(this);
+    m_interpolation->addItem("Linear");
+    m_interpolation->addItem("Cubic");
+    const bool cubic =
+      source->interpolation() == ResampleOperator::Interpolation::Cubic;
+    m_interpolation->setCurrentIndex(cubic ? 1 : 0);
+
+    QFormLayout* layout = new QFormLayout;
+    layout->addRow("Factor (x, y, z)", factorsLayout);
+    layout->addRow("Interpolation", m_interpolation);
+    setLayout(layout);
+  }
+
+  void applyChangesToOperator() override
+  {
+    if (m_operator) {
+      double factors[3];
+      for (int i = 0; i < 3; ++i) {
+        factors[i] = m_factors[i]->value();
+      }
+      m_operator->setFactors(factors);
+      m_operator->setInterpolation(
+        m_interpolation->currentIndex() == 1
+          ? ResampleOperator::Interpolation::Cubic
+          : ResampleOperator::Interpolation::Linear);
+    }
+  }
+
+private:
+  QPointer<ResampleOperator> m_operator;
+  QDoubleSpinBox* m_factors[3];
+  QComboBox* m_interpolation;
+};
+
+template <typename T>
+bool resampleArray(vtkDataArray* input, const int inDims[3],
+                   const int outDims[3], vtkDataArray* output,
+                   ResampleOperator::Interpolation interpolation,
+                   const std::function<bool()>& canceled)
+{
+  return tomviz::Resample::resample(
+    static_cast<T*>(input->GetVoidPointer(0)), inDims,
+    input->GetNumberOfComponents(), outDims, interpolation,
+    static_cast<T*>(output->GetVoidPointer(0)), canceled);
+}
+} // namespace
+
+#include "ResampleOperator.moc"
+
+namespace tomviz {
+
+ResampleOperator::ResampleOperator(QObject* p) : Operator(p)
+{
+  setSupportsCancel(true);
+}
+
+QIcon ResampleOperator::icon() const
+{
+  return QIcon();
+}
+
+bool ResampleOperator::applyTransform(vtkDataObject* data)
+{
+  vtkImageData* image = vtkImageData::SafeDownCast(data);
+  if (!image) {
+    return false;
+  }
+
+  int extent[6];
+  int inDims[3];
+  int outDims[3];
+  double spacing[3];
+  double origin[3];
+  image->GetExtent(extent);
+  image->GetDimensions(inDims);
+  image->GetSpacing(spacing);
+  image->GetOrigin(origin);
+  for (int i = 0; i < 3; ++i) {
+    outDims[i] = Resample::zoomedSize(inDims[i], m_factors[i]);
+  }
+
+  auto canceled = [this]() { return isCanceled(); };
+  auto interpolation = m_interpolation;
+  auto resample = [&](vtkDataArray* input, const int in[3], const int out[3],
+                      vtkDataArray* output) {
+    bool completed = false;
+    switch (input->GetDataType()) {
+      vtkTemplateMacro(completed = resampleArray<VTK_TT>(
+                         input, in, out, output, interpolation, canceled));
+    }
+    return completed;
+  };
+  if (!Resample::resampleImage(image, outDims, resample)) {
+    return false;
+  }
+
+  // The first and last samples stay in place, so the volume covers the same
+  // extent as before.
+  for (int i = 0; i < 3; ++i) {
+    origin[i] += extent[2 * i] * spacing[i];
+    if (outDims[i] > 1) {
+      spacing[i] *= (inDims[i] - 1) / static_cast<double>(outDims[i] - 1);
+    }
+  }
+  image->SetOrigin(origin);
+  image->SetSpacing(spacing);
+  return true;
+}
+
+Operator* ResampleOperator::clone() const
+{
+  auto other = new ResampleOperator();
+  other->setFactors(m_factors);
+  other->setInterpolation(m_interpolation);
+  return initializeClone(other);
+}
+
+QJsonObject ResampleOperator::serialize() const
+{
+  auto json = Operator::serialize();
+  json["factors"] = QJsonArray({ m_factors[0], m_factors[1], m_factors[2] });
+  json["interpolation"] = static_cast<int>(m_interpolation);
+  return json;
+}
+
+bool ResampleOperator::deserialize(const QJsonObject& json)
+{
+  if (json.contains("factors")) {
+    auto factors = json["factors"].toArray();
+    if (factors.size() == 3) {
+      for (int i = 0; i < 3; ++i) {
+        m_factors[i] = factors[i].toDouble(1.0);
+      }
+    }
+  }
+  if (json.contains("interpolation")) {
+    m_interpolation = json["interpolation"].toInt() == 3
+                        ? Interpolation::Cubic
+                        : Interpolation::Linear;
+  }
+  return true;
+}
+
+EditOperatorWidget* ResampleOperator::getEditorContents(QWidget* p)
+{
+  return new ResampleWidget(this, p);
+}
+
+void ResampleOperator::setFactors(const double factors[3])
+{
+  std::copy(factors, factors + 3, m_factors);
+  emit transformModified();
+}
+
+void ResampleOperator::setInterpolation(Interpolation interpolation)
+{
+  m_interpolation = interpolation;
+  emit transformModified();
+}
+} // namespace tomviz
@@ -0,0 +1,52 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizResampleOperator_h
+#define tomvizResampleOperator_h
+
+#include "Operator.h"
+
+#include "Resample.h"
+
+namespace tomviz {
+
+/// Native resampling by a zoom factor per axis, replacing the scipy based
+/// Resample Python operator. The spacing is scaled so the volume covers the
+/// same extent, and the tilt angles of a tilt series are resampled along
+/// with its slices.
+class ResampleOperator : public Operator
+{
+  Q_OBJECT
+
+public:
+  using Interpolation = Resample::Interpolation;
+
+  ResampleOperator(QObject* parent = nullptr);
+
+  QString label() const override { return "Resample"; }
+  QIcon icon() const override;
+  Operator* clone() const override;
+
+  QJsonObject serialize() const override;
+  bool deserialize(const QJsonObject& json) override;
+
+  EditOperatorWidget* getEditorContents(QWidget* parent) override;
+  bool hasCustomUI() const override { return true; }
+
+  void setFactors(const double factors[3]);
+  const double* factors() const { return m_factors; }
+
+  void setInterpolation(Interpolation interpolation);
+  Interpolation interpolation() const { return m_interpolation; }
+
+protected:
+  bool applyTransform(vtkDataObject* data) override;
+
+private:
+  double m_factors[3] = { 1.0, 1.0, 1.0 };
+  Interpolation m_interpolation = Interpolation::Linear;
+  Q_DISABLE_COPY(ResampleOperator)
+};
+} // namespace tomviz
+
+#endif
@@ -375,7 +375,7 @@ Operator* SetTiltAnglesOperator::clone() const
 {
   SetTiltAnglesOperator* op = new SetTiltAnglesOperator;
   op->setTiltAngles(m_tiltAngles);
-  return op;
+  return initializeClone(op);
 }
 
 QJsonObject SetTiltAnglesOperator::serialize() const
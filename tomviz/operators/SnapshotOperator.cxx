@@ -3,12 +3,12 @@
 
 #include "SnapshotOperator.h"
 
+#include "CopyOnWrite.h"
 #include "DataSource.h"
 
 #include "pqSMProxy.h"
 #include "vtkDataArray.h"
 #include "vtkImageData.h"
-#include "vtkNew.h"
 #include "vtkPointData.h"
 #include "vtkSMProxyManager.h"
 #include "vtkSMSessionProxyManager.h"
@@ -43,7 +43,7 @@ QIcon SnapshotOperator::icon() const
 
 Operator* SnapshotOperator::clone() const
 {
-  return new SnapshotOperator(m_dataSource);
+  return initializeClone(new SnapshotOperator(m_dataSource));
 }
 
 QJsonObject SnapshotOperator::serialize() const
@@ -85,10 +85,11 @@ bool SnapshotOperator::applyTransform(vtkDataObject* dataObject)
     return false;
   }
 
-  vtkNew<vtkImageData> cacheImage;
-  cacheImage->DeepCopy(imageData);
+  // Operators after this one detach the arrays they write into, so the
+  // snapshot keeps the values as they are now.
+  auto cacheImage = CopyOnWrite::copy(imageData);
 
-  emit newChildDataSource("Snapshot", cacheImage.Get());
+  emit newChildDataSource("Snapshot", cacheImage);
   return true;
 }
 } // namespace tomviz
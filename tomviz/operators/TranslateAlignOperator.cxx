@@ -5,70 +5,46 @@
 
 #include "AlignWidget.h"
 #include "DataSource.h"
+#include "ImageShift.h"
 #include "OperatorResult.h"
 
+#include "vtkDataArray.h"
+#include "vtkDoubleArray.h"
 #include "vtkImageData.h"
 #include "vtkIntArray.h"
 #include "vtkNew.h"
+#include "vtkPointData.h"
 #include "vtkTable.h"
 
 #include <QJsonArray>
 
+#include <cmath>
+#include <vector>
+
 namespace {
 
-// We are assuming an image that begins at 0, 0, 0.
-vtkIdType imageIndex(const vtkVector3i& incs, const vtkVector3i& pos)
+template <typename T>
+void applyImageOffsets(vtkDataArray* in, vtkDataArray* out, const int dims[3],
+                       const std::vector<int>& offsets)
 {
-  return pos[0] * incs[0] + pos[1] * incs[1] + pos[2] * incs[2];
+  tomviz::shiftSlices(static_cast<T*>(in->GetVoidPointer(0)),
+                      static_cast<T*>(out->GetVoidPointer(0)), dims,
+                      in->GetNumberOfComponents(), offsets.data());
 }
 
 template <typename T>
-void applyImageOffsets(T* in, T* out, vtkImageData* image,
-                       const QVector<vtkVector2i>& offsets)
+void applySubPixelImageOffsets(vtkDataArray* in, vtkDataArray* out,
+                               const int dims[3],
+                               const std::vector<double>& offsets)
 {
-  // We know that the input and output images are the same size, with the
-  // supplied offsets applied to each slice. Copy the pixels, applying offsets.
-  int* extents = image->GetExtent();
-  vtkVector3i extent(extents[1] - extents[0] + 1, extents[3] - extents[2] + 1,
-                     extents[5] - extents[4] + 1);
-  vtkVector3i incs(1, 1 * extent[0], 1 * extent[0] * extent[1]);
-
-  // Zero out our output array, we should do this more intelligently in future.
-  T* ptr = out;
-  for (int i = 0; i < extent[0] * extent[1] * extent[2]; ++i) {
-    *ptr++ = 0;
-  }
+  tomviz::shiftSlicesBilinear(static_cast<T*>(in->GetVoidPointer(0)),
+                              static_cast<T*>(out->GetVoidPointer(0)), dims,
+                              in->GetNumberOfComponents(), offsets.data());
+}
 
-  // We need to go slice by slice, applying the pixel offsets to the new image.
-  for (int i = 0; i < extent[2]; ++i) {
-    vtkVector2i offset = offsets[i];
-    int idx = imageIndex(incs, vtkVector3i(0, 0, i));
-    T* inPtr = in + idx;
-    T* outPtr = out + idx;
-    for (int y = 0; y < extent[1]; ++y) {
-      if (y + offset[1] >= extent[1]) {
-        break;
-      } else if (y + offset[1] < 0) {
-        inPtr += incs[1];
-        outPtr += incs[1];
-        continue;
-      }
-      for (int x = 0; x < extent[0]; ++x) {
-        if (x + offset[0] >= extent[0]) {
-          inPtr += offset[0];
-          outPtr += offset[0];
-          break;
-        } else if (x + offset[0] < 0) {
-          ++inPtr;
-          ++outPtr;
-          continue;
-        }
-        *(outPtr + offset[0] + incs[1] * offset[1]) = *inPtr;
-        ++inPtr;
-        ++outPtr;
-      }
-    }
-  }
+bool isIntegral(double value)
+{
+  return std::floor(value) == value;
 }
 } // namespace
 
@@ -96,18 +72,51 @@ void TranslateAlignOperator::initializeResults()
 
 bool TranslateAlignOperator::applyTransform(vtkDataObject* data)
 {
-  vtkNew<vtkImageData> outImage;
-  vtkImageData* inImage = vtkImageData::SafeDownCast(data);
-  assert(inImage);
-  outImage->DeepCopy(data);
-  switch (inImage->GetScalarType()) {
-    vtkTemplateMacro(
-      applyImageOffsets(reinterpret_cast<VTK_TT*>(inImage->GetScalarPointer()),
-                        reinterpret_cast<VTK_TT*>(outImage->GetScalarPointer()),
-                        inImage, offsets));
+  vtkImageData* image = vtkImageData::SafeDownCast(data);
+  if (!image) {
+    return false;
+  }
+  vtkDataArray* inScalars = image->GetPointData()->GetScalars();
+  if (!inScalars) {
+    return false;
+  }
+
+  // Shift straight into a freshly allocated scalar array, there is no need to
+  // copy the input first as every output value is written exactly once.
+  int dims[3];
+  image->GetDimensions(dims);
+  vtkSmartPointer<vtkDataArray> outScalars;
+  outScalars.TakeReference(inScalars->NewInstance());
+  outScalars->SetNumberOfComponents(inScalars->GetNumberOfComponents());
+  outScalars->SetNumberOfTuples(inScalars->GetNumberOfTuples());
+  outScalars->SetName(inScalars->GetName());
+
+  // Slices without an offset are left where they are.
+  if (m_subPixelOffsets.isEmpty()) {
+    std::vector<int> sliceOffsets(2 * dims[2], 0);
+    for (int i = 0; i < std::min(dims[2], offsets.size()); ++i) {
+      sliceOffsets[2 * i] = offsets[i][0];
+      sliceOffsets[2 * i + 1] = offsets[i][1];
+    }
+    switch (inScalars->GetDataType()) {
+      vtkTemplateMacro(applyImageOffsets<VTK_TT>(inScalars, outScalars, dims,
+                                                 sliceOffsets));
+    }
+  } else {
+    std::vector<double> sliceOffsets(2 * dims[2], 0.0);
+    for (int i = 0; i < std::min(dims[2], m_subPixelOffsets.size()); ++i) {
+      sliceOffsets[2 * i] = m_subPixelOffsets[i][0];
+      sliceOffsets[2 * i + 1] = m_subPixelOffsets[i][1];
+    }
+    switch (inScalars->GetDataType()) {
+      vtkTemplateMacro(applySubPixelImageOffsets<VTK_TT>(
+        inScalars, outScalars, dims, sliceOffsets));
+    }
   }
+
   offsetsToResult();
-  data->ShallowCopy(outImage.Get());
+  image->GetPointData()->RemoveArray(inScalars->GetName());
+  image->GetPointData()->SetScalars(outScalars);
   return true;
 }
 
@@ -115,14 +124,22 @@ Operator* TranslateAlignOperator::clone() const
 {
   TranslateAlignOperator* op = new TranslateAlignOperator(this->dataSource);
   op->setAlignOffsets(this->offsets);
-  return op;
+  op->m_subPixelOffsets = m_subPixelOffsets;
+  return initializeClone(op);
 }
 
 void TranslateAlignOperator::offsetsToResult()
 {
-  vtkNew<vtkIntArray> arrX;
+  vtkSmartPointer<vtkDataArray> arrX;
+  vtkSmartPointer<vtkDataArray> arrY;
+  if (m_subPixelOffsets.isEmpty()) {
+    arrX = vtkSmartPointer<vtkIntArray>::New();
+    arrY = vtkSmartPointer<vtkIntArray>::New();
+  } else {
+    arrX = vtkSmartPointer<vtkDoubleArray>::New();
+    arrY = vtkSmartPointer<vtkDoubleArray>::New();
+  }
   arrX->SetName("X Offset");
-  vtkNew<vtkIntArray> arrY;
   arrY->SetName("Y Offset");
 
   vtkNew<vtkTable> table;
@@ -131,8 +148,13 @@ void TranslateAlignOperator::offsetsToResult()
   table->SetNumberOfRows(offsets.size());
 
   for (int i = 0; i < offsets.size(); ++i) {
-    table->SetValue(i, 0, offsets[i][0]);
-    table->SetValue(i, 1, offsets[i][1]);
+    if (m_subPixelOffsets.isEmpty()) {
+      table->SetValue(i, 0, offsets[i][0]);
+      table->SetValue(i, 1, offsets[i][1]);
+    } else {
+      table->SetValue(i, 0, m_subPixelOffsets[i][0]);
+      table->SetValue(i, 1, m_subPixelOffsets[i][1]);
+    }
   }
   setResult(0, table);
 }
@@ -142,8 +164,14 @@ QJsonObject TranslateAlignOperator::serialize() const
   auto json = Operator::serialize();
 
   QJsonArray offsetArray;
-  foreach (auto offset, this->offsets) {
-    offsetArray << offset[0] << offset[1];
+  if (m_subPixelOffsets.isEmpty()) {
+    foreach (auto offset, this->offsets) {
+      offsetArray << offset[0] << offset[1];
+    }
+  } else {
+    foreach (auto offset, m_subPixelOffsets) {
+      offsetArray << offset[0] << offset[1];
+    }
   }
   json["offsets"] = offsetArray;
 
@@ -163,9 +191,20 @@ bool TranslateAlignOperator::deserialize(const QJsonObject& json)
   if (json.contains("offsets") && json["offsets"].isArray()) {
     auto offsetArray = json["offsets"].toArray();
     this->offsets.resize(offsetArray.size() / 2);
+    m_subPixelOffsets.resize(offsetArray.size() / 2);
+    bool subPixel = false;
     for (int i = 0; i < offsetArray.size() / 2; ++i) {
-      this->offsets[i][0] = offsetArray[2 * i].toInt();
-      this->offsets[i][1] = offsetArray[2 * i + 1].toInt();
+      double x = offsetArray[2 * i].toDouble();
+      double y = offsetArray[2 * i + 1].toDouble();
+      subPixel = subPixel || !isIntegral(x) || !isIntegral(y);
+      m_subPixelOffsets[i] = vtkVector2d(x, y);
+      this->offsets[i][0] = static_cast<int>(std::round(x));
+      this->offsets[i][1] = static_cast<int>(std::round(y));
+    }
+    // Only keep the fractional offsets around if they are needed, integer
+    // offsets take the faster bulk copy path.
+    if (!subPixel) {
+      m_subPixelOffsets.clear();
     }
   }
 
@@ -192,6 +231,7 @@ void TranslateAlignOperator::setAlignOffsets(
 {
   this->offsets.resize(newOffsets.size());
   std::copy(newOffsets.begin(), newOffsets.end(), this->offsets.begin());
+  m_subPixelOffsets.clear();
   emit this->transformModified();
 }
 
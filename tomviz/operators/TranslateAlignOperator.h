@@ -25,6 +25,8 @@ public:
   QString label() const override { return "Translation Align"; }
   QIcon icon() const override;
   Operator* clone() const override;
+  // Sets its offsets as a result, so the arrays are shifted one at a time.
+  bool supportsAllArrays() const override { return true; }
 
   QJsonObject serialize() const override;
   bool deserialize(const QJsonObject& json) override;
@@ -52,6 +54,9 @@ protected:
 private:
   QVector<vtkVector2i> offsets;
   QVector<vtkVector2i> m_draftOffsets;
+  // Only populated when the restored offsets have a fractional part, in which
+  // case the slices are shifted with bilinear interpolation.
+  QVector<vtkVector2d> m_subPixelOffsets;
   const QPointer<DataSource> dataSource;
 };
 } // namespace tomviz
@@ -0,0 +1,183 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#include "UnsharpMaskOperator.h"
+
+#include "CopyOnWrite.h"
+#include "EditOperatorWidget.h"
+#include "NeighborhoodFilters.h"
+
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkPointData.h>
+
+#include <QDoubleSpinBox>
+#include <QFormLayout>
+#include <QJsonObject>
+#include <QPointer>
+
+#include <algorithm>
+
+namespace {
+
+using tomviz::UnsharpMaskOperator;
+
+class UnsharpMaskWidget : public tomviz::EditOperatorWidget
+{
+  Q_OBJECT
+
+public:
+  UnsharpMaskWidget(UnsharpMaskOperator* source, QWidget* p)
+    : tomviz::EditOperatorWidget(p), m_operator(source)
+  {
+    m_amount = new QDoubleSpinBox(this);
+    m_amount->setRange(0.0, 100.0);
+    m_amount->setSingleStep(0.1);
+    m_amount->setValue(source->amount());
+
+    m_threshold = new QDoubleSpinBox(this);
+    m_threshold->setRange(0.0, 1e9);
+    m_threshold->setValue(source->threshold());
+
+    m_sigma = new QDoubleSpinBox(this);
+    m_sigma->setRange(0.0, 1e6);
+    m_sigma->setSingleStep(0.5);
+    m_sigma->setValue(source->sigma());
+
+    QFormLayout* layout = new QFormLayout;
+    layout->addRow("Amount", m_amount);
+    layout->addRow("Threshold", m_threshold);
+    layout->addRow("Sigma", m_sigma);
+    setLayout(layout);
+  }
+
+  void applyChangesToOperator() override
+  {
+    if (m_operator) {
+      m_operator->setAmount(m_amount->value());
+      m_operator->setThreshold(m_threshold->value());
+      m_operator->setSigma(m_sigma->value());
+    }
+  }
+
+private:
+  QPointer<UnsharpMaskOperator> m_operator;
+  QDoubleSpinBox* m_amount;
+  QDoubleSpinBox* m_threshold;
+  QDoubleSpinBox* m_sigma;
+};
+
+template <typename T>
+bool unsharpMask(vtkDataArray* array, const int dims[3], const double sigma[3],
+                 double amount, double threshold,
+                 const std::function<bool()>& canceled)
+{
+  return tomviz::NeighborhoodFilters::eachComponent(
+    static_cast<T*>(array->GetVoidPointer(0)), dims,
+    array->GetNumberOfComponents(), [&](T* component) {
+      return tomviz::NeighborhoodFilters::unsharpMask(
+        component, dims, sigma, amount, threshold, canceled);
+    });
+}
+} // namespace
+
+#include "UnsharpMaskOperator.moc"
+
+namespace tomviz {
+
+UnsharpMaskOperator::UnsharpMaskOperator(QObject* p) : Operator(p)
+{
+  setSupportsCancel(true);
+}
+
+QIcon UnsharpMaskOperator::icon() const
+{
+  return QIcon();
+}
+
+bool UnsharpMaskOperator::applyTransform(vtkDataObject* data)
+{
+  vtkImageData* image = vtkImageData::SafeDownCast(data);
+  if (!image) {
+    return false;
+  }
+  vtkDataArray* scalars = image->GetPointData()->GetScalars();
+  if (!scalars) {
+    return false;
+  }
+  // The scalars are filtered in place.
+  CopyOnWrite::detach(scalars);
+
+  int dims[3];
+  double spacing[3];
+  double sigma[3];
+  image->GetDimensions(dims);
+  image->GetSpacing(spacing);
+  for (int i = 0; i < 3; ++i) {
+    sigma[i] = spacing[i] > 0.0 ? m_sigma / spacing[i] : m_sigma;
+  }
+  auto canceled = [this]() { return isCanceled(); };
+  bool completed = false;
+  switch (scalars->GetDataType()) {
+    vtkTemplateMacro(completed = unsharpMask<VTK_TT>(
+                       scalars, dims, sigma, m_amount, m_threshold, canceled));
+  }
+  scalars->Modified();
+  return completed;
+}
+
+Operator* UnsharpMaskOperator::clone() const
+{
+  auto other = new UnsharpMaskOperator();
+  other->setAmount(m_amount);
+  other->setThreshold(m_threshold);
+  other->setSigma(m_sigma);
+  return initializeClone(other);
+}
+
+QJsonObject UnsharpMaskOperator::serialize() const
+{
+  auto json = Operator::serialize();
+  json["amount"] = m_amount;
+  json["threshold"] = m_threshold;
+  json["sigma"] = m_sigma;
+  return json;
+}
+
+bool UnsharpMaskOperator::deserialize(const QJsonObject& json)
+{
+  if (json.contains("amount")) {
+    m_amount = json["amount"].toDouble(0.5);
+  }
+  if (json.contains("threshold")) {
+    m_threshold = std::max(json["threshold"].toDouble(), 0.0);
+  }
+  if (json.contains("sigma")) {
+    m_sigma = std::max(json["sigma"].toDouble(1.0), 0.0);
+  }
+  return true;
+}
+
+EditOperatorWidget* UnsharpMaskOperator::getEditorContents(QWidget* p)
+{
+  return new UnsharpMaskWidget(this, p);
+}
+
+void UnsharpMaskOperator::setAmount(double amount)
+{
+  m_amount = amount;
+  emit transformModified();
+}
+
+void UnsharpMaskOperator::setThreshold(double threshold)
+{
+  m_threshold = std::max(threshold, 0.0);
+  emit transformModified();
+}
+
+void UnsharpMaskOperator::setSigma(double sigma)
+{
+  m_sigma = std::max(sigma, 0.0);
+  emit transformModified();
+}
+} // namespace tomviz
@@ -0,0 +1,53 @@
+/* This source file is part of the Tomviz project, https://tomviz.org/.
+   It is released under the 3-Clause BSD License, see "LICENSE". */
+
+#ifndef tomvizUnsharpMaskOperator_h
+#define tomvizUnsharpMaskOperator_h
+
+#include "Operator.h"
+
+namespace tomviz {
+
+/// Native unsharp mask, replacing the Unsharp Mask Python operator with the
+/// definition of ITK's UnsharpMaskImageFilter. As in ITK, sigma is in the
+/// units of the spacing.
+class UnsharpMaskOperator : public Operator
+{
+  Q_OBJECT
+
+public:
+  UnsharpMaskOperator(QObject* parent = nullptr);
+
+  QString label() const override { return "Unsharp Mask"; }
+  QIcon icon() const override;
+  Operator* clone() const override;
+  bool supportsAllArrays() const override { return true; }
+  bool isReentrant() const override { return true; }
+
+  QJsonObject serialize() const override;
+  bool deserialize(const QJsonObject& json) override;
+
+  EditOperatorWidget* getEditorContents(QWidget* parent) override;
+  bool hasCustomUI() const override { return true; }
+
+  void setAmount(double amount);
+  double amount() const { return m_amount; }
+
+  void setThreshold(double threshold);
+  double threshold() const { return m_threshold; }
+
+  void setSigma(double sigma);
+  double sigma() const { return m_sigma; }
+
+protected:
+  bool applyTransform(vtkDataObject* data) override;
+
+private:
+  double m_amount = 0.5;
+  double m_threshold = 0.0;
+  double m_sigma = 1.0;
+  Q_DISABLE_COPY(UnsharpMaskOperator)
+};
+} // namespace tomviz
+
+#endif
@@ -9,15 +9,21 @@
 #include "vtkImageData.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
+#include "vtkSMPTools.h"
 #include "vtkSmartPointer.h"
 #include "vtkStringArray.h"
 
 #include "vtksys/SystemTools.hxx"
 #include "vtk_pugixml.h"
 
+
 #include <sys/stat.h>
 #include <string>
 #include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
 
 extern "C" {
 #include "vtk_tiff.h"
@@ -133,6 +139,21 @@ bool ReadTemplatedImage(T* out, Flip flip,
   }
   return true;
 }
+
+// The strips or tiles of a page, the units decoded in one call. Pages of a
+// volume share their layout.
+struct PageLayout
+{
+  bool Tiled;
+  unsigned int Width;
+  unsigned int Height;
+  unsigned int UnitWidth;
+  unsigned int UnitHeight;
+  unsigned int UnitsAcross;
+  unsigned int UnitsPerPage;
+  tsize_t UnitSize;
+  bool Flip;
+};
 }
 
 //-------------------------------------------------------------------------
@@ -178,6 +199,9 @@ public:
   unsigned int OmeSizeT;
   unsigned int OmeSizeC;
   std::string OmeDimOrder;
+  // Directory offsets of the pages holding slices, in order, so a page can
+  // be reached without walking the directories before it.
+  std::vector<toff_t> SliceOffsets;
   double OmePhysicalPixelSize[3];
   std::string OmePhysicalPixelUnits[3];
   bool OmeBigEndian;
@@ -259,6 +283,7 @@ void vtkOMETiffReader::vtkOMETiffReaderInternal::Clean()
   this->OmeSizeT = 0;
   this->OmeSizeC = 0;
   this->OmeDimOrder = "";
+  this->SliceOffsets.clear();
   this->OmePhysicalPixelSize[0] = this->OmePhysicalPixelSize[1] =
     this->OmePhysicalPixelSize[2] = 1;
   this->OmePhysicalPixelUnits[0] = this->OmePhysicalPixelUnits[1] =
@@ -319,13 +344,18 @@ bool vtkOMETiffReader::vtkOMETiffReaderInternal::Initialize()
       }
     }
 
-    // Checking if the TIFF contains subfiles
+    // Checking if the TIFF contains subfiles, indexing the pages as we go
+    this->SliceOffsets.clear();
     if (this->NumberOfPages > 1)
     {
       this->SubFiles = 0;
 
+      std::vector<toff_t> offsets;
+      std::vector<bool> reduced;
       for (unsigned int page = 0; page<this->NumberOfPages; ++page)
       {
+        offsets.push_back(TIFFCurrentDirOffset(this->Image));
+        reduced.push_back(false);
         long subfiletype = 6;
         if (TIFFGetField(this->Image, TIFFTAG_SUBFILETYPE, &subfiletype))
         {
@@ -333,13 +363,28 @@ bool vtkOMETiffReader::vtkOMETiffReaderInternal::Initialize()
           {
             this->SubFiles += 1;
           }
+          reduced.back() = subfiletype != 0;
         }
         TIFFReadDirectory(this->Image);
       }
 
+      // As when reading, pages of other subfile types are skipped when the
+      // file has subfiles.
+      for (size_t page = 0; page < offsets.size(); ++page)
+      {
+        if (this->SubFiles == 0 || !reduced[page])
+        {
+          this->SliceOffsets.push_back(offsets[page]);
+        }
+      }
+
       // Set the directory to the first image
       TIFFSetDirectory(this->Image, 0);
     }
+    else
+    {
+      this->SliceOffsets.push_back(TIFFCurrentDirOffset(this->Image));
+    }
 
     this->OmeXmlRaw = new char*[255];
     if (!TIFFGetField(this->Image, TIFFTAG_IMAGEDESCRIPTION, this->OmeXmlRaw))
@@ -614,6 +659,17 @@ void vtkOMETiffReader::Process2(OT *outPtr, int *)
 template <class OT>
 void vtkOMETiffReader::Process(OT *outPtr, int outExtent[6], vtkIdType outIncr[3])
 {
+  // multiple pages or a tiled image, decoded on every core when possible
+  if ((this->InternalImage->NumberOfPages > 1 ||
+       this->InternalImage->NumberOfTiles > 0) &&
+      this->CanReadPagesConcurrently(sizeof(OT)))
+  {
+    this->ReadPagesConcurrently(outPtr);
+    // close the TIFF file
+    this->InternalImage->Clean();
+    return;
+  }
+
   // multiple number of pages
   if (this->InternalImage->NumberOfPages > 1)
   {
@@ -921,6 +977,199 @@ void vtkOMETiffReader::ReadVolume(T* buffer)
   }
 }
 
+//-------------------------------------------------------------------------
+bool vtkOMETiffReader::CanReadPagesConcurrently(size_t scalarSize)
+{
+  vtkOMETiffReaderInternal* internal = this->InternalImage;
+  if (!internal->CanRead() || !this->InternalFileName ||
+      scalarSize * 8 != internal->BitsPerSample)
+  {
+    return false;
+  }
+  const unsigned int format = this->GetFormat();
+  if (format != vtkOMETiffReader::GRAYSCALE &&
+      format != vtkOMETiffReader::RGB)
+  {
+    return false;
+  }
+  // Pages are decoded as interleaved samples, pages storing each sample in a
+  // plane of its own are read by the serial path.
+  if (internal->PlanarConfig != PLANARCONFIG_CONTIG)
+  {
+    return false;
+  }
+
+  // Whole slices, every one of which has a page.
+  return internal->Width == internal->OmeSizeX &&
+         internal->Height == internal->OmeSizeY &&
+         this->OutputExtent[0] == 0 &&
+         this->OutputExtent[1] == static_cast<int>(internal->Width) - 1 &&
+         this->OutputExtent[2] == 0 &&
+         this->OutputExtent[3] == static_cast<int>(internal->Height) - 1 &&
+         this->OutputExtent[4] >= 0 &&
+         this->OutputExtent[5] <
+           static_cast<int>(internal->SliceOffsets.size());
+}
+
+//-------------------------------------------------------------------------
+template<typename T>
+void vtkOMETiffReader::ReadPagesConcurrently(T* buffer)
+{
+  vtkOMETiffReaderInternal* internal = this->InternalImage;
+  const std::vector<toff_t>& offsets = internal->SliceOffsets;
+  const int firstSlice = this->OutputExtent[4];
+  const int numberOfSlices = this->OutputExtent[5] - firstSlice + 1;
+  const int samplesPerPixel = internal->SamplesPerPixel;
+  const vtkIdType pixelIncrement = this->OutputIncrements[0];
+  const vtkIdType rowIncrement = this->OutputIncrements[1];
+  const vtkIdType sliceIncrement = this->OutputIncrements[2];
+
+  // The layout of the first page describes them all.
+  TIFF* image = internal->Image;
+  if (!TIFFSetSubDirectory(image, offsets[firstSlice]))
+  {
+    vtkErrorMacro(<< "Cannot read the first page of the volume.");
+    return;
+  }
+  PageLayout layout;
+  layout.Tiled = TIFFIsTiled(image) != 0;
+  layout.Width = internal->Width;
+  layout.Height = internal->Height;
+  layout.Flip = internal->Orientation != ORIENTATION_TOPLEFT;
+  if (layout.Tiled)
+  {
+    TIFFGetField(image, TIFFTAG_TILEWIDTH, &layout.UnitWidth);
+    TIFFGetField(image, TIFFTAG_TILELENGTH, &layout.UnitHeight);
+    layout.UnitSize = TIFFTileSize(image);
+  }
+  else
+  {
+    unsigned int rowsPerStrip = layout.Height;
+    TIFFGetFieldDefaulted(image, TIFFTAG_ROWSPERSTRIP, &rowsPerStrip);
+    layout.UnitWidth = layout.Width;
+    layout.UnitHeight = std::max(std::min(rowsPerStrip, layout.Height), 1u);
+    layout.UnitSize = TIFFStripSize(image);
+  }
+  if (layout.UnitWidth == 0 || layout.UnitHeight == 0)
+  {
+    vtkErrorMacro(<< "Cannot read the strip or tile size of the volume.");
+    return;
+  }
+  layout.UnitsAcross = (layout.Width + layout.UnitWidth - 1) / layout.UnitWidth;
+  layout.UnitsPerPage = layout.UnitsAcross *
+    ((layout.Height + layout.UnitHeight - 1) / layout.UnitHeight);
+
+  // Rows the file stores as the output does are copied, or for unflipped
+  // strips decoded, straight into the output. Others go through
+  // EvaluateImageAt() a pixel at a time.
+  const unsigned int format = this->GetFormat();
+  const bool direct =
+    ((format == vtkOMETiffReader::GRAYSCALE &&
+      internal->Photometrics == PHOTOMETRIC_MINISBLACK &&
+      samplesPerPixel == 1) ||
+     (format == vtkOMETiffReader::RGB && samplesPerPixel == 3)) &&
+    pixelIncrement == samplesPerPixel &&
+    rowIncrement == static_cast<vtkIdType>(layout.Width) * samplesPerPixel;
+
+  auto readUnit = [&](TIFF* handle, unsigned int unit, T* slice,
+                      std::vector<unsigned char>& decoded) {
+    const unsigned int x0 = (unit % layout.UnitsAcross) * layout.UnitWidth;
+    const unsigned int y0 = (unit / layout.UnitsAcross) * layout.UnitHeight;
+    const unsigned int columns = std::min(layout.UnitWidth, layout.Width - x0);
+    const unsigned int rows = std::min(layout.UnitHeight, layout.Height - y0);
+    if (direct && !layout.Tiled && !layout.Flip)
+    {
+      const tsize_t size = static_cast<tsize_t>(rows) * rowIncrement *
+                           static_cast<tsize_t>(sizeof(T));
+      return TIFFReadEncodedStrip(handle, unit, slice + y0 * rowIncrement,
+                                  size) >= 0;
+    }
+
+    const tsize_t read = layout.Tiled
+      ? TIFFReadEncodedTile(handle, unit, decoded.data(), layout.UnitSize)
+      : TIFFReadEncodedStrip(handle, unit, decoded.data(), layout.UnitSize);
+    if (read < 0)
+    {
+      return false;
+    }
+    T* source = reinterpret_cast<T*>(decoded.data());
+    for (unsigned int r = 0; r < rows; ++r)
+    {
+      const unsigned int fileRow = y0 + r;
+      const unsigned int row =
+        layout.Flip ? layout.Height - fileRow - 1 : fileRow;
+      T* out = slice + row * rowIncrement + x0 * pixelIncrement;
+      T* in = source +
+        static_cast<size_t>(r) * layout.UnitWidth * samplesPerPixel;
+      if (direct)
+      {
+        memcpy(out, in, sizeof(T) * columns * samplesPerPixel);
+        continue;
+      }
+      for (unsigned int c = 0; c < columns; ++c)
+      {
+        this->EvaluateImageAt(out, in + c * samplesPerPixel);
+        out += pixelIncrement;
+      }
+    }
+    return true;
+  };
+
+  // Each sub-range of units gets its own handle, libtiff handles cannot be
+  // shared between threads, and spans at least a page so handles are not
+  // opened for every strip. Progress is reported from this thread only.
+  const std::string fileName = this->InternalFileName;
+  const vtkIdType numberOfUnits =
+    static_cast<vtkIdType>(numberOfSlices) * layout.UnitsPerPage;
+  const std::thread::id caller = std::this_thread::get_id();
+  std::atomic<vtkIdType> unitsRead(0);
+  std::atomic<bool> failed(false);
+  auto readUnits = [&](vtkIdType begin, vtkIdType end) {
+    TIFF* handle = TIFFOpen(fileName.c_str(), "r");
+    if (!handle)
+    {
+      failed = true;
+      return;
+    }
+    std::vector<unsigned char> decoded(layout.UnitSize);
+    vtkIdType page = -1;
+    for (vtkIdType unit = begin; unit < end && !failed; ++unit)
+    {
+      const vtkIdType slice = unit / layout.UnitsPerPage;
+      if (slice != page)
+      {
+        if (!TIFFSetSubDirectory(handle, offsets[firstSlice + slice]))
+        {
+          failed = true;
+          break;
+        }
+        page = slice;
+      }
+      if (!readUnit(handle,
+                    static_cast<unsigned int>(unit % layout.UnitsPerPage),
+                    buffer + slice * sliceIncrement, decoded))
+      {
+        failed = true;
+        break;
+      }
+      const vtkIdType count = ++unitsRead;
+      if (std::this_thread::get_id() == caller)
+      {
+        this->UpdateProgress(static_cast<double>(count) / numberOfUnits);
+      }
+    }
+    TIFFClose(handle);
+  };
+  vtkSMPTools::For(0, numberOfUnits, layout.UnitsPerPage, readUnits);
+
+  if (failed)
+  {
+    vtkErrorMacro(<< "Problem reading the pages of the volume in TIFF file.");
+    return;
+  }
+  this->UpdateProgress(1.0);
+}
+
 /** Read a tiled tiff */
 void vtkOMETiffReader::ReadTiles(void* buffer)
 {
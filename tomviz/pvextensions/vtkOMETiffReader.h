@@ -89,6 +89,21 @@ private:
   template<typename T>
   void ReadVolume(T* buffer);
 
+  /**
+   * Whether the slices of the output extent can be read by
+   * ReadPagesConcurrently() for scalars of the given size.
+   */
+  bool CanReadPagesConcurrently(size_t scalarSize);
+
+  /**
+   * Reads 3D data from multi-page or tiled tiff using the page offsets
+   * indexed when the file was opened. Strips or tiles of different pages are
+   * decoded concurrently, each thread with its own TIFF handle, straight
+   * into the output buffer. Covers grayscale, RGB and two sample images.
+   */
+  template<typename T>
+  void ReadPagesConcurrently(T* buffer);
+
   /**
    * Reads 3D data from tiled tiff
    */
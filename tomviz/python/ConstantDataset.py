@@ -1,2 +1,6 @@
 def generate_dataset(array, CONSTANT=0.0):
     array.fill(CONSTANT)
+
+
+def generate_slab(array, shape, z_begin, CONSTANT=0.0):
+    array.fill(CONSTANT)
@@ -1,9 +1,16 @@
 
 
-def generate_dataset(array, voltage=300.0, alpha_max=30.0, Nxy=256, Nz=512,
-                     dxy=0.1, df_min=-50.0, df_max=100.0, c3=0.20, f_a2=0.0,
-                     phi_a2=0.0, f_a3=0.0, phi_a3=0.0, f_c3=1500.0, phi_c3=0.0):
+def generate_dataset(array, **kwargs):
     """Generate STEM probe function"""
+    generate_slab(array, array.shape, 0, **kwargs)
+
+
+def generate_slab(array, shape, z_begin, voltage=300.0, alpha_max=30.0,
+                  Nxy=256, Nz=512, dxy=0.1, df_min=-50.0, df_max=100.0,
+                  c3=0.20, f_a2=0.0, phi_a2=0.0, f_a3=0.0, phi_a3=0.0,
+                  f_c3=1500.0, phi_c3=0.0):
+    """Generate the slices of the STEM probe function starting at z_begin,
+    one per defocus"""
 
     import numpy as np
 
@@ -29,8 +36,8 @@ def generate_dataset(array, voltage=300.0, alpha_max=30.0, Nxy=256, Nz=512,
     phi = np.arctan2(kY, kX)
     df = np.linspace(df_min, df_max, Nz)
 
-    for i in range(0, Nz):
-        defocus = df[i]
+    for i in range(0, array.shape[2]):
+        defocus = df[z_begin + i]
         chi = (-np.pi * wavelength * kR**2 * defocus + np.pi / 2 * c3 *
                wavelength**3 * kR**4 + np.pi * f_a2 * wavelength * kR**2 *
                np.sin(2 * (phi - phi_a2)) + f_a3 * wavelength**2 * kR**3 *
@@ -363,7 +363,9 @@ class SegmentPores(tomviz.operators.CancelableOperator):
             label_buffer = label_buffer.copy()
             label_map_dataset = vtkImageData()
             label_map_dataset.CopyStructure(dataset)
-            utils.set_array(label_map_dataset, label_buffer, isFortran=False)
+            utils.set_array(label_map_dataset,
+                            utils.compact_label_array(label_buffer),
+                            isFortran=False)
 
             # Set up dictionary to return operator results
             returnValues = {}
@@ -169,6 +169,32 @@ def make_child_dataset(reference_dataset):
     return new_child
 
 
+def compact_label_array(array):
+    """Returns the label array stored in the smallest unsigned integer type
+    that holds all of its labels, so that label maps of a few objects take one
+    byte per voxel instead of the four or eight bytes of the data they were
+    computed from. Arrays with negative or fractional values are returned
+    unchanged.
+    """
+    if array.size == 0:
+        return array
+
+    minimum = array.min()
+    maximum = array.max()
+    if minimum < 0:
+        return array
+    if not np.issubdtype(array.dtype, np.integer) and \
+            not np.array_equal(array, np.floor(array)):
+        return array
+
+    for dtype in (np.uint8, np.uint16, np.uint32):
+        if maximum <= np.iinfo(dtype).max:
+            if array.dtype == dtype:
+                return array
+            return array.astype(dtype)
+    return array
+
+
 def connected_components(dataset, background_value=0, progress_callback=None):
     try:
         import itk
@@ -256,7 +282,7 @@ def connected_components(dataset, background_value=0, progress_callback=None):
         gt_zero = label_buffer > 0
         label_buffer[gt_zero] = minimum - label_buffer[gt_zero] + maximum
 
-        set_array(dataset, label_buffer, isFortran=False)
+        set_array(dataset, compact_label_array(label_buffer), isFortran=False)
     except Exception as exc:
         print("Problem encountered while running ConnectedComponents")
         raise exc
@@ -303,6 +329,18 @@ def make_dataset(x, y, z, dataset, generate_data_function, **kwargs):
     dataset.GetPointData().SetScalars(vtkarray)
 
 
+def make_slab(x, y, z, z_begin, dataset, generate_slab_function, **kwargs):
+    """Fill the scalars of dataset, the slices of a generated volume of shape
+    (x, y, z) starting at z_begin, in place. The slices are passed to
+    generate_slab_function as a view of the scalars, generators write into it
+    rather than replacing it. Generated slabs are cached, so they must depend
+    only on the arguments, random generators take a seed."""
+    dims = dataset.GetDimensions()
+    scalars = dataset.GetPointData().GetScalars()
+    array = np_s.vtk_to_numpy(scalars).reshape(dims, order='F')
+    generate_slab_function(array, (x, y, z), z_begin, **kwargs)
+
+
 def mark_as_volume(dataobject):
     from vtk import vtkTypeInt8Array
     fd = dataobject.GetFieldData()